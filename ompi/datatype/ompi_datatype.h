@@ -166,9 +166,31 @@ ompi_datatype_is_monotonic( ompi_datatype_t * type ) {
     return type->super.flags & OMPI_DATATYPE_FLAG_MONOTONIC;
 }
 
+/**
+ * Number of committed datatype descriptions kept to speed up the commit
+ * of the identical datatypes created later (mpi_ddt_commit_cache_size
+ * MCA parameter). 0 disables the cache.
+ */
+OMPI_DECLSPEC extern int ompi_datatype_commit_cache_size;
+
+/* Register the MCA parameters of the datatype engine */
+int ompi_datatype_register_params( void );
+
+/**
+ * Commit a datatype built with its construction arguments, reusing the
+ * optimized description of a previously committed datatype with the
+ * same arguments when there is one.
+ */
+OMPI_DECLSPEC int32_t ompi_datatype_commit_cached( ompi_datatype_t* type );
+int32_t ompi_datatype_commit_cache_init( void );
+int32_t ompi_datatype_commit_cache_fini( void );
+
 static inline int32_t
 ompi_datatype_commit( ompi_datatype_t ** type )
 {
+    if( (0 < ompi_datatype_commit_cache_size) && (NULL != (*type)->args) ) {
+        return ompi_datatype_commit_cached( *type );
+    }
     return opal_datatype_commit ( (opal_datatype_t*)*type );
 }
 
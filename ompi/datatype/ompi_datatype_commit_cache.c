@@ -0,0 +1,185 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Cache of the committed datatype descriptions.  Applications (and
+ * ompio) often create, commit and free the same derived datatypes over
+ * and over.  The packed description of the construction arguments (see
+ * ompi_datatype_args.c) identifies the datatypes built the same way, so
+ * the commit of such a datatype copies the optimized description and
+ * the specialized pack functions of the first one instead of optimizing
+ * the description again.
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/class/opal_hash_table.h"
+#include "opal/class/opal_list.h"
+#include "opal/mca/base/mca_base_var.h"
+#include "opal/mca/threads/mutex.h"
+#include "opal/datatype/opal_datatype.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+
+int ompi_datatype_commit_cache_size = 64;
+
+typedef struct {
+    opal_list_item_t super;
+    opal_datatype_t* model;   /**< private committed copy of the datatype */
+    void* key;                /**< packed description of the datatype */
+    size_t key_length;
+} ompi_datatype_cache_entry_t;
+
+static void ompi_datatype_cache_entry_construct( ompi_datatype_cache_entry_t* entry )
+{
+    entry->model = NULL;
+    entry->key = NULL;
+    entry->key_length = 0;
+}
+
+static void ompi_datatype_cache_entry_destruct( ompi_datatype_cache_entry_t* entry )
+{
+    if( NULL != entry->model ) {
+        OBJ_RELEASE( entry->model );
+    }
+    free( entry->key );
+}
+
+static OBJ_CLASS_INSTANCE( ompi_datatype_cache_entry_t, opal_list_item_t,
+                           ompi_datatype_cache_entry_construct,
+                           ompi_datatype_cache_entry_destruct );
+
+static bool ompi_datatype_commit_cache_initialized = false;
+static opal_hash_table_t ompi_datatype_commit_cache;
+static opal_list_t ompi_datatype_commit_cache_lru;  /* least recently used first */
+static opal_mutex_t ompi_datatype_commit_cache_lock;
+
+int ompi_datatype_register_params( void )
+{
+    int ret;
+
+    ret = mca_base_var_register( "ompi", "mpi", NULL, "ddt_commit_cache_size",
+                                 "Number of committed datatype descriptions kept to speed up the commit "
+                                 "of the datatypes created later with the same arguments (0 = disabled)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_5,
+                                 MCA_BASE_VAR_SCOPE_LOCAL,
+                                 &ompi_datatype_commit_cache_size );
+    return (0 > ret) ? ret : OMPI_SUCCESS;
+}
+
+int32_t ompi_datatype_commit_cache_init( void )
+{
+    OBJ_CONSTRUCT( &ompi_datatype_commit_cache, opal_hash_table_t );
+    OBJ_CONSTRUCT( &ompi_datatype_commit_cache_lru, opal_list_t );
+    OBJ_CONSTRUCT( &ompi_datatype_commit_cache_lock, opal_mutex_t );
+    if( OPAL_SUCCESS != opal_hash_table_init( &ompi_datatype_commit_cache, 64 ) ) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    ompi_datatype_commit_cache_initialized = true;
+    return OMPI_SUCCESS;
+}
+
+int32_t ompi_datatype_commit_cache_fini( void )
+{
+    if( !ompi_datatype_commit_cache_initialized ) {
+        return OMPI_SUCCESS;
+    }
+    ompi_datatype_commit_cache_initialized = false;
+    OPAL_LIST_DESTRUCT( &ompi_datatype_commit_cache_lru );
+    OBJ_DESTRUCT( &ompi_datatype_commit_cache );
+    OBJ_DESTRUCT( &ompi_datatype_commit_cache_lock );
+    return OMPI_SUCCESS;
+}
+
+/* Called with the lock held */
+static void ompi_datatype_commit_cache_insert( ompi_datatype_t* type, const void* key,
+                                               size_t key_length )
+{
+    ompi_datatype_cache_entry_t* entry;
+
+    /* Another thread may have committed the same datatype meanwhile */
+    if( (0 >= ompi_datatype_commit_cache_size) ||
+        OPAL_SUCCESS == opal_hash_table_get_value_ptr( &ompi_datatype_commit_cache, key,
+                                                       key_length, (void**)&entry ) ) {
+        return;
+    }
+
+    while( opal_list_get_size( &ompi_datatype_commit_cache_lru ) >= (size_t)ompi_datatype_commit_cache_size ) {
+        entry = (ompi_datatype_cache_entry_t*)opal_list_remove_first( &ompi_datatype_commit_cache_lru );
+        (void) opal_hash_table_remove_value_ptr( &ompi_datatype_commit_cache, entry->key,
+                                                 entry->key_length );
+        OBJ_RELEASE( entry );
+    }
+
+    entry = OBJ_NEW( ompi_datatype_cache_entry_t );
+    entry->key = malloc( key_length );
+    entry->model = opal_datatype_create( type->super.desc.used + 2 );
+    if( NULL == entry->key || NULL == entry->model ) {
+        OBJ_RELEASE( entry );
+        return;
+    }
+    memcpy( entry->key, key, key_length );
+    entry->key_length = key_length;
+    opal_datatype_clone( &type->super, entry->model );
+
+    opal_list_append( &ompi_datatype_commit_cache_lru, &entry->super );
+    (void) opal_hash_table_set_value_ptr( &ompi_datatype_commit_cache, entry->key,
+                                          entry->key_length, entry );
+}
+
+int32_t ompi_datatype_commit_cached( ompi_datatype_t* type )
+{
+    ompi_datatype_cache_entry_t* entry;
+    const void* key;
+    size_t key_length;
+    int32_t rc;
+
+    if( ompi_datatype_is_committed( type ) ) {
+        return OMPI_SUCCESS;
+    }
+    if( !ompi_datatype_commit_cache_initialized ||
+        (OMPI_SUCCESS != ompi_datatype_get_pack_description( type, &key )) ) {
+        return opal_datatype_commit( &type->super );
+    }
+    key_length = ompi_datatype_pack_description_length( type );
+
+    OPAL_THREAD_LOCK( &ompi_datatype_commit_cache_lock );
+    if( OPAL_SUCCESS == opal_hash_table_get_value_ptr( &ompi_datatype_commit_cache, key,
+                                                       key_length, (void**)&entry ) ) {
+        /* Same arguments, hence same description. Better safe than sorry. */
+        if( (entry->model->size == type->super.size) &&
+            (entry->model->lb == type->super.lb) && (entry->model->ub == type->super.ub) &&
+            (entry->model->desc.used == type->super.desc.used) ) {
+            rc = opal_datatype_commit_as( &type->super, entry->model );
+            if( OPAL_SUCCESS == rc ) {
+                opal_list_remove_item( &ompi_datatype_commit_cache_lru, &entry->super );
+                opal_list_append( &ompi_datatype_commit_cache_lru, &entry->super );
+                OPAL_THREAD_UNLOCK( &ompi_datatype_commit_cache_lock );
+                return OMPI_SUCCESS;
+            }
+        }
+    }
+    OPAL_THREAD_UNLOCK( &ompi_datatype_commit_cache_lock );
+
+    rc = opal_datatype_commit( &type->super );
+    if( OPAL_SUCCESS != rc ) {
+        return rc;
+    }
+
+    OPAL_THREAD_LOCK( &ompi_datatype_commit_cache_lock );
+    ompi_datatype_commit_cache_insert( type, key, key_length );
+    OPAL_THREAD_UNLOCK( &ompi_datatype_commit_cache_lock );
+    return OMPI_SUCCESS;
+}
@@ -663,7 +663,7 @@ int32_t ompi_datatype_init( void )
         }
     }
     ompi_datatype_default_convertors_init();
-    return OMPI_SUCCESS;
+    return ompi_datatype_commit_cache_init();
 }
 
 
@@ -687,6 +687,8 @@ int32_t ompi_datatype_finalize( void )
     /* release the local convertors (external32 and local) */
     ompi_datatype_default_convertors_fini();
 
+    ompi_datatype_commit_cache_fini();
+
     /* don't call opal_datatype_finalize () as it no longer exists. the function will be called
      * opal_finalize_util (). */
 
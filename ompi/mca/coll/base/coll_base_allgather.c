@@ -594,6 +594,133 @@ ompi_coll_base_allgather_intra_neighborexchange(const void *sbuf, int scount,
     return err;
 }
 
+/*
+ * ompi_coll_base_allgather_intra_recursivemultiplying
+ *
+ * Function:     allgather using O(log_k(N)) steps.
+ * Accepts:      Same arguments as MPI_Allgather, plus the radix k (>= 2)
+ * Returns:      MPI_SUCCESS or error code
+ *
+ * Description:  Generalization of the recursive doubling allgather to groups
+ *               of up to k processes. The communicator size is factored into
+ *               N = k_0 * k_1 * ... with every k_j <= k; at step j each
+ *               process exchanges the contiguous range of blocks it has
+ *               gathered so far with the k_j - 1 processes differing from it
+ *               only in the j-th digit of its rank (in the mixed radix
+ *               k_0, k_1, ...), so the range grows k_j times.
+ *               If N has a prime factor larger than k the bruck algorithm
+ *               is used instead.
+ *
+ * Example on 6 nodes, k = 3 (N = 3 * 2):
+ *   Step 0: exchange with the ranks in the same triplet {0,1,2}, {3,4,5}
+ *    #     0      1      2      3      4      5
+ *         [0]    [0]    [0]    [ ]    [ ]    [ ]
+ *         [1]    [1]    [1]    [ ]    [ ]    [ ]
+ *         [2]    [2]    [2]    [ ]    [ ]    [ ]
+ *         [ ]    [ ]    [ ]    [3]    [3]    [3]
+ *         [ ]    [ ]    [ ]    [4]    [4]    [4]
+ *         [ ]    [ ]    [ ]    [5]    [5]    [5]
+ *   Step 1: exchange 3 blocks with rank +/- 3
+ *    #     0      1      2      3      4      5
+ *         [0]    [0]    [0]    [0]    [0]    [0]
+ *         ...
+ *         [5]    [5]    [5]    [5]    [5]    [5]
+ *
+ * Memory requirements:  none, the blocks are exchanged in place in rbuf.
+ */
+int
+ompi_coll_base_allgather_intra_recursivemultiplying(const void *sbuf, int scount,
+                                                    struct ompi_datatype_t *sdtype,
+                                                    void* rbuf, int rcount,
+                                                    struct ompi_datatype_t *rdtype,
+                                                    struct ompi_communicator_t *comm,
+                                                    mca_coll_base_module_t *module,
+                                                    int radix)
+{
+    int line = -1, rank, size, err, nfactors = 0, nreqs = 0, n;
+    int factors[32];
+    ompi_request_t **reqs = NULL;
+    ptrdiff_t rlb, rext;
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+    if (radix > size) radix = size;
+    if (radix < 2) radix = 2;
+
+    /* split size in factors no larger than the radix, the largest first */
+    for (n = size; n > 1; n /= factors[nfactors++]) {
+        int k = radix;
+        while (k > 1 && 0 != n % k) k--;
+        if (k < 2) {
+            OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                         "coll:base:allgather_intra_recursivemultiplying WARNING: %d has a prime factor larger than radix %d. Switching to bruck algorithm.",
+                         size, radix));
+            return ompi_coll_base_allgather_intra_bruck(sbuf, scount, sdtype,
+                                                        rbuf, rcount, rdtype,
+                                                        comm, module);
+        }
+        factors[nfactors] = k;
+    }
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:allgather_intra_recursivemultiplying rank %d radix %d steps %d",
+                 rank, radix, nfactors));
+
+    err = ompi_datatype_get_extent (rdtype, &rlb, &rext);
+    if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+    /* Initialization step:
+       - if send buffer is not MPI_IN_PLACE, copy send buffer to block rank of
+       the receive buffer
+    */
+    if (MPI_IN_PLACE != sbuf) {
+        err = ompi_datatype_sndrcv((char*)sbuf, scount, sdtype,
+                                   (char*)rbuf + (ptrdiff_t)rank * (ptrdiff_t)rcount * rext,
+                                   rcount, rdtype);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl;  }
+    }
+    if (1 == size) return MPI_SUCCESS;
+
+    reqs = ompi_coll_base_comm_get_reqs(module->base_data, 2 * (radix - 1));
+    if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+
+    for (int step = 0, distance = 1; step < nfactors; distance *= factors[step++]) {
+        int k = factors[step];
+        int digit = (rank / distance) % k;
+        int base = rank - rank % distance;  /* first block gathered so far */
+        char *tmpsend = (char*)rbuf + (ptrdiff_t)base * (ptrdiff_t)rcount * rext;
+
+        nreqs = 0;
+        for (int i = 0; i < k; i++) {
+            int peer = rank + (i - digit) * distance;
+            char *tmprecv;
+
+            if (i == digit) continue;
+            tmprecv = (char*)rbuf + (ptrdiff_t)(base + (i - digit) * distance) * (ptrdiff_t)rcount * rext;
+            err = MCA_PML_CALL(irecv(tmprecv, (ptrdiff_t)distance * (ptrdiff_t)rcount, rdtype,
+                                     peer, MCA_COLL_BASE_TAG_ALLGATHER, comm, &reqs[nreqs++]));
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+            err = MCA_PML_CALL(isend(tmpsend, (ptrdiff_t)distance * (ptrdiff_t)rcount, rdtype,
+                                     peer, MCA_COLL_BASE_TAG_ALLGATHER,
+                                     MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs++]));
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    return OMPI_SUCCESS;
+
+ err_hndl:
+    if (NULL != reqs)
+        ompi_coll_base_free_reqs(reqs, nreqs);
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,  "%s:%4d\tError occurred %d, rank %2d",
+                 __FILE__, line, err, rank));
+    (void)line;  // silence compiler warning
+    return err;
+}
+
 
 int ompi_coll_base_allgather_intra_two_procs(const void *sbuf, int scount,
                                               struct ompi_datatype_t *sdtype,
@@ -967,10 +967,130 @@ ompi_coll_base_allreduce_intra_basic_linear(const void *sbuf, void *rbuf, int co
  * Memory requirements (per process):
  *   count * typesize + 4 * \log_2(p) * sizeof(int) = O(count)
  */
+static int allreduce_redscat_allgather(
+    const void *sbuf, void *rbuf, int count, struct ompi_datatype_t *dtype,
+    struct ompi_op_t *op, struct ompi_communicator_t *comm,
+    mca_coll_base_module_t *module, int segcount);
+
 int ompi_coll_base_allreduce_intra_redscat_allgather(
     const void *sbuf, void *rbuf, int count, struct ompi_datatype_t *dtype,
     struct ompi_op_t *op, struct ompi_communicator_t *comm,
     mca_coll_base_module_t *module)
+{
+    return allreduce_redscat_allgather(sbuf, rbuf, count, dtype, op, comm, module, 0);
+}
+
+/*
+ * ompi_coll_base_allreduce_intra_redscat_allgather_segmented
+ *
+ * Function:  Allreduce using Rabenseifner's algorithm with segmentation.
+ * Accepts:   Same arguments as MPI_Allreduce, plus the segment size
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: same algorithm as ompi_coll_base_allreduce_intra_redscat_allgather,
+ *   but the exchanges of the reduce-scatter are split into segments of
+ *   segsize bytes: the next segment is received while the current one is
+ *   reduced, so the reductions overlap with the transfers instead of
+ *   following them. A segment size of 0 disables the segmentation.
+ *
+ * Limitations:
+ *   count >= 2^{\floor{\log_2 p}}
+ *   commutative operations only
+ *   intra-communicators only
+ */
+int ompi_coll_base_allreduce_intra_redscat_allgather_segmented(
+    const void *sbuf, void *rbuf, int count, struct ompi_datatype_t *dtype,
+    struct ompi_op_t *op, struct ompi_communicator_t *comm,
+    mca_coll_base_module_t *module, uint32_t segsize)
+{
+    size_t typelng;
+    int segcount = count;
+
+    ompi_datatype_type_size(dtype, &typelng);
+    COLL_BASE_COMPUTED_SEGCOUNT(segsize, typelng, segcount);
+
+    return allreduce_redscat_allgather(sbuf, rbuf, count, dtype, op, comm, module,
+                                       segcount);
+}
+
+/*
+ * Exchanges a part of the vector with a peer: sends scount elements from
+ * sbuf, receives rcount elements into tmpbuf and reduces them into rbuf
+ * (rbuf[] = tmpbuf[] <op> rbuf[]). With a segcount smaller than the counts,
+ * the exchange is pipelined: the next segment is on the wire while the
+ * current one is reduced. Both peers have to use the same segcount.
+ */
+static int allreduce_sendrecv_reduce(
+    char *sbuf, int scount, char *tmpbuf, char *rbuf, int rcount,
+    struct ompi_datatype_t *dtype, struct ompi_op_t *op, ptrdiff_t extent,
+    int segcount, int peer, struct ompi_communicator_t *comm, int rank)
+{
+    ompi_request_t *rreqs[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    ompi_request_t *sreqs[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+    int err, nrsegs, nssegs;
+
+    if (0 >= segcount || (rcount <= segcount && scount <= segcount)) {
+        err = ompi_coll_base_sendrecv(sbuf, scount, dtype, peer,
+                                      MCA_COLL_BASE_TAG_ALLREDUCE,
+                                      tmpbuf, rcount, dtype, peer,
+                                      MCA_COLL_BASE_TAG_ALLREDUCE, comm,
+                                      MPI_STATUS_IGNORE, rank);
+        if (MPI_SUCCESS != err) { return err; }
+        ompi_op_reduce(op, tmpbuf, rbuf, rcount, dtype);
+        return MPI_SUCCESS;
+    }
+
+    nrsegs = (rcount + segcount - 1) / segcount;
+    nssegs = (scount + segcount - 1) / segcount;
+
+    /* Keep the segment seg + 1 in flight while the segment seg is reduced */
+    for (int seg = -1; seg < nrsegs || seg < nssegs; seg++) {
+        int next = seg + 1, n;
+
+        if (next < nrsegs) {
+            n = rcount - next * segcount;
+            if (n > segcount) n = segcount;
+            err = MCA_PML_CALL(irecv(tmpbuf + (ptrdiff_t)next * segcount * extent,
+                                     n, dtype, peer, MCA_COLL_BASE_TAG_ALLREDUCE,
+                                     comm, &rreqs[next % 2]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+        }
+        if (next < nssegs) {
+            n = scount - next * segcount;
+            if (n > segcount) n = segcount;
+            /* the request of the segment next - 2 is reused */
+            err = ompi_request_wait(&sreqs[next % 2], MPI_STATUS_IGNORE);
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+            err = MCA_PML_CALL(isend(sbuf + (ptrdiff_t)next * segcount * extent,
+                                     n, dtype, peer, MCA_COLL_BASE_TAG_ALLREDUCE,
+                                     MCA_PML_BASE_SEND_STANDARD, comm,
+                                     &sreqs[next % 2]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+        }
+        if (0 <= seg && seg < nrsegs) {
+            n = rcount - seg * segcount;
+            if (n > segcount) n = segcount;
+            err = ompi_request_wait(&rreqs[seg % 2], MPI_STATUS_IGNORE);
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+            ompi_op_reduce(op, tmpbuf + (ptrdiff_t)seg * segcount * extent,
+                           rbuf + (ptrdiff_t)seg * segcount * extent, n, dtype);
+        }
+    }
+
+    err = ompi_request_wait_all(2, sreqs, MPI_STATUSES_IGNORE);
+    if (MPI_SUCCESS != err) { goto error_hndl; }
+    return MPI_SUCCESS;
+
+  error_hndl:
+    ompi_coll_base_free_reqs(rreqs, 2);
+    ompi_coll_base_free_reqs(sreqs, 2);
+    return err;
+}
+
+static int allreduce_redscat_allgather(
+    const void *sbuf, void *rbuf, int count, struct ompi_datatype_t *dtype,
+    struct ompi_op_t *op, struct ompi_communicator_t *comm,
+    mca_coll_base_module_t *module, int segcount)
 {
     int *rindex = NULL, *rcount = NULL, *sindex = NULL, *scount = NULL;
 
@@ -1042,18 +1162,14 @@ int ompi_coll_base_allreduce_intra_redscat_allgather(
              * Send the left half of the input vector to the left neighbor,
              * Recv the right half of the input vector from the left neighbor
              */
-            err = ompi_coll_base_sendrecv(rbuf, count_lhalf, dtype, rank - 1,
-                                          MCA_COLL_BASE_TAG_ALLREDUCE,
-                                          (char *)tmp_buf + (ptrdiff_t)count_lhalf * extent,
-                                          count_rhalf, dtype, rank - 1,
-                                          MCA_COLL_BASE_TAG_ALLREDUCE, comm,
-                                          MPI_STATUS_IGNORE, rank);
+            /* and reduce on the right half of the buffers (result in rbuf) */
+            err = allreduce_sendrecv_reduce(rbuf, count_lhalf,
+                                            (char *)tmp_buf + (ptrdiff_t)count_lhalf * extent,
+                                            (char *)rbuf + (ptrdiff_t)count_lhalf * extent,
+                                            count_rhalf, dtype, op, extent, segcount,
+                                            rank - 1, comm, rank);
             if (MPI_SUCCESS != err) { goto cleanup_and_return; }
 
-            /* Reduce on the right half of the buffers (result in rbuf) */
-            ompi_op_reduce(op, (char *)tmp_buf + (ptrdiff_t)count_lhalf * extent,
-                           (char *)rbuf + count_lhalf * extent, count_rhalf, dtype);
-
             /* Send the right half to the left neighbor */
             err = MCA_PML_CALL(send((char *)rbuf + (ptrdiff_t)count_lhalf * extent,
                                     count_rhalf, dtype, rank - 1,
@@ -1070,17 +1186,13 @@ int ompi_coll_base_allreduce_intra_redscat_allgather(
              * Send the right half of the input vector to the right neighbor,
              * Recv the left half of the input vector from the right neighbor
              */
-            err = ompi_coll_base_sendrecv((char *)rbuf + (ptrdiff_t)count_lhalf * extent,
-                                          count_rhalf, dtype, rank + 1,
-                                          MCA_COLL_BASE_TAG_ALLREDUCE,
-                                          tmp_buf, count_lhalf, dtype, rank + 1,
-                                          MCA_COLL_BASE_TAG_ALLREDUCE, comm,
-                                          MPI_STATUS_IGNORE, rank);
+            /* and reduce on the left half of the buffers (result in rbuf) */
+            err = allreduce_sendrecv_reduce((char *)rbuf + (ptrdiff_t)count_lhalf * extent,
+                                            count_rhalf, tmp_buf, rbuf, count_lhalf,
+                                            dtype, op, extent, segcount,
+                                            rank + 1, comm, rank);
             if (MPI_SUCCESS != err) { goto cleanup_and_return; }
 
-            /* Reduce on the right half of the buffers (result in rbuf) */
-            ompi_op_reduce(op, tmp_buf, rbuf, count_lhalf, dtype);
-
             /* Recv the right half from the right neighbor */
             err = MCA_PML_CALL(recv((char *)rbuf + (ptrdiff_t)count_lhalf * extent,
                                     count_rhalf, dtype, rank + 1,
@@ -1149,21 +1261,18 @@ int ompi_coll_base_allreduce_intra_redscat_allgather(
                 rindex[step] = sindex[step] + scount[step];
             }
 
-            /* Send part of data from the rbuf, recv into the tmp_buf */
-            err = ompi_coll_base_sendrecv((char *)rbuf + (ptrdiff_t)sindex[step] * extent,
-                                          scount[step], dtype, dest,
-                                          MCA_COLL_BASE_TAG_ALLREDUCE,
-                                          (char *)tmp_buf + (ptrdiff_t)rindex[step] * extent,
-                                          rcount[step], dtype, dest,
-                                          MCA_COLL_BASE_TAG_ALLREDUCE, comm,
-                                          MPI_STATUS_IGNORE, rank);
+            /*
+             * Send part of data from the rbuf, recv into the tmp_buf and
+             * local reduce: rbuf[] = tmp_buf[] <op> rbuf[]
+             */
+            err = allreduce_sendrecv_reduce((char *)rbuf + (ptrdiff_t)sindex[step] * extent,
+                                            scount[step],
+                                            (char *)tmp_buf + (ptrdiff_t)rindex[step] * extent,
+                                            (char *)rbuf + (ptrdiff_t)rindex[step] * extent,
+                                            rcount[step], dtype, op, extent, segcount,
+                                            dest, comm, rank);
             if (MPI_SUCCESS != err) { goto cleanup_and_return; }
 
-            /* Local reduce: rbuf[] = tmp_buf[] <op> rbuf[] */
-            ompi_op_reduce(op, (char *)tmp_buf + (ptrdiff_t)rindex[step] * extent,
-                           (char *)rbuf + (ptrdiff_t)rindex[step] * extent,
-                           rcount[step], dtype);
-
             /* Move the current window to the received message */
             if (step + 1 < nsteps) {
                 rindex[step + 1] = rindex[step];
@@ -1243,3 +1352,486 @@ int ompi_coll_base_allreduce_intra_redscat_allgather(
 }
 
 /* copied function (with appropriate renaming) ends here */
+
+/*
+ * Links of a position in the binary tree used by the double binary tree:
+ * a position whose lowest set bit is b has its children at +/- b/2, and
+ * the root is at position 0 with a single child. Positions without parent
+ * or child are set to -1.
+ */
+static void allreduce_btree_links(int size, int pos, int *parent, int links[2])
+{
+    int bit, lowbit;
+
+    for (bit = 1; bit < size; bit <<= 1) {
+        if (bit & pos) break;
+    }
+    if (0 == pos) {
+        *parent = -1;
+        links[0] = -1;
+        links[1] = (size > 1) ? (bit >> 1) : -1;
+        return;
+    }
+    *parent = (pos ^ bit) | (bit << 1);
+    if (*parent >= size) {
+        *parent = pos ^ bit;
+    }
+    lowbit = bit >> 1;
+    links[0] = (0 == lowbit) ? -1 : pos - lowbit;
+    /* the right subtree is cut by the end of the communicator */
+    for (links[1] = -1; lowbit > 0; lowbit >>= 1) {
+        if (pos + lowbit < size) {
+            links[1] = pos + lowbit;
+            break;
+        }
+    }
+}
+
+/* one of the two trees, reducing and broadcasting one half of the vector */
+typedef struct {
+    int tag;
+    int parent, child[2];
+    int count, nsegs;           /* elements and segments of the half */
+    char *buf;                  /* the half in rbuf */
+    char *cbuf[2][2];           /* per child, double buffered segments */
+    ompi_request_t *creqs[2][2], *dreqs[2][2], *preqs[2], *ureq;
+} allreduce_dbtree_half_t;
+
+static int allreduce_dbtree_segcount(allreduce_dbtree_half_t *half, int seg, int segcount)
+{
+    int n = half->count - seg * segcount;
+    return (n > segcount) ? segcount : n;
+}
+
+/* sends the final segment seg to the children of the tree */
+static int allreduce_dbtree_forward(allreduce_dbtree_half_t *half, int seg, int segcount,
+                                    struct ompi_datatype_t *dtype, ptrdiff_t extent,
+                                    struct ompi_communicator_t *comm)
+{
+    int err;
+
+    for (int c = 0; c < 2; c++) {
+        if (half->child[c] < 0) continue;
+        /* the request of the segment seg - 2 is reused */
+        err = ompi_request_wait(&half->dreqs[c][seg % 2], MPI_STATUS_IGNORE);
+        if (MPI_SUCCESS != err) { return err; }
+        err = MCA_PML_CALL(isend(half->buf + (ptrdiff_t)seg * segcount * extent,
+                                 allreduce_dbtree_segcount(half, seg, segcount),
+                                 dtype, half->child[c], half->tag,
+                                 MCA_PML_BASE_SEND_STANDARD, comm,
+                                 &half->dreqs[c][seg % 2]));
+        if (MPI_SUCCESS != err) { return err; }
+    }
+    return MPI_SUCCESS;
+}
+
+/*
+ * Step it of the pipeline of one tree:
+ * - reduce the segment it received from the children and send it up
+ *   (the receptions of the segment it + 1 are already posted),
+ * - once the segment it - 1 left for the parent, post the reception of
+ *   its final value in place,
+ * - forward the final segment it - 2 to the children.
+ * The root forwards a segment as soon as it is reduced.
+ */
+static int allreduce_dbtree_step(allreduce_dbtree_half_t *half, int it, int segcount,
+                                 struct ompi_datatype_t *dtype, struct ompi_op_t *op,
+                                 ptrdiff_t extent, struct ompi_communicator_t *comm)
+{
+    int err, c;
+
+    if (it < half->nsegs) {
+        char *seg = half->buf + (ptrdiff_t)it * segcount * extent;
+        int n = allreduce_dbtree_segcount(half, it, segcount);
+
+        if (it + 1 < half->nsegs) {
+            for (c = 0; c < 2; c++) {
+                if (half->child[c] < 0) continue;
+                err = MCA_PML_CALL(irecv(half->cbuf[c][(it + 1) % 2],
+                                         allreduce_dbtree_segcount(half, it + 1, segcount),
+                                         dtype, half->child[c], half->tag, comm,
+                                         &half->creqs[c][(it + 1) % 2]));
+                if (MPI_SUCCESS != err) { return err; }
+            }
+        }
+        for (c = 0; c < 2; c++) {
+            if (half->child[c] < 0) continue;
+            err = ompi_request_wait(&half->creqs[c][it % 2], MPI_STATUS_IGNORE);
+            if (MPI_SUCCESS != err) { return err; }
+            ompi_op_reduce(op, half->cbuf[c][it % 2], seg, n, dtype);
+        }
+
+        if (half->parent < 0) {
+            return allreduce_dbtree_forward(half, it, segcount, dtype, extent, comm);
+        }
+    }
+    if (half->parent < 0) {
+        return MPI_SUCCESS;
+    }
+
+    /* the segment it - 1 has to be out of the buffer before its final value comes back */
+    err = ompi_request_wait(&half->ureq, MPI_STATUS_IGNORE);
+    if (MPI_SUCCESS != err) { return err; }
+    if (it < half->nsegs) {
+        err = MCA_PML_CALL(isend(half->buf + (ptrdiff_t)it * segcount * extent,
+                                 allreduce_dbtree_segcount(half, it, segcount),
+                                 dtype, half->parent, half->tag,
+                                 MCA_PML_BASE_SEND_STANDARD, comm, &half->ureq));
+        if (MPI_SUCCESS != err) { return err; }
+    }
+    if (1 <= it && it <= half->nsegs) {
+        err = MCA_PML_CALL(irecv(half->buf + (ptrdiff_t)(it - 1) * segcount * extent,
+                                 allreduce_dbtree_segcount(half, it - 1, segcount),
+                                 dtype, half->parent, half->tag, comm,
+                                 &half->preqs[(it - 1) % 2]));
+        if (MPI_SUCCESS != err) { return err; }
+    }
+    if (2 <= it && it <= half->nsegs + 1) {
+        err = ompi_request_wait(&half->preqs[(it - 2) % 2], MPI_STATUS_IGNORE);
+        if (MPI_SUCCESS != err) { return err; }
+        return allreduce_dbtree_forward(half, it - 2, segcount, dtype, extent, comm);
+    }
+    return MPI_SUCCESS;
+}
+
+/*
+ * ompi_coll_base_allreduce_intra_dbtree
+ *
+ * Function:  Allreduce using a double binary tree.
+ * Accepts:   Same arguments as MPI_Allreduce, plus the segment size
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: each half of the vector is reduced up a binary tree and
+ *   broadcast back down the same tree, both pipelined by segments of
+ *   segsize bytes. The second tree is the first one shifted by one rank
+ *   (odd number of processes) or mirrored (even number of processes), so
+ *   the leaves of one tree are inner nodes of the other one and every
+ *   process sends and receives about as much data in both trees. The two
+ *   trees progress together, and the reduction of a segment overlaps with
+ *   the transfers of the segments posted before and after it.
+ *
+ * Limitations:
+ *   commutative operations only
+ *   intra-communicators only
+ *
+ * Memory requirements (per process):
+ *   8 segments
+ */
+int
+ompi_coll_base_allreduce_intra_dbtree(const void *sbuf, void *rbuf, int count,
+                                      struct ompi_datatype_t *dtype,
+                                      struct ompi_op_t *op,
+                                      struct ompi_communicator_t *comm,
+                                      mca_coll_base_module_t *module,
+                                      uint32_t segsize)
+{
+    allreduce_dbtree_half_t halves[2];
+    int err = MPI_SUCCESS, t, c, pos, parent, links[2], segcount, nsegs;
+    int size = ompi_comm_size(comm), rank = ompi_comm_rank(comm);
+    ptrdiff_t lb, extent, gap = 0, segspan;
+    char *tmp_buf_raw = NULL;
+    size_t typelng;
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:allreduce_intra_dbtree rank %d/%d, count %d",
+                 rank, size, count));
+
+    if (size < 2 || count < 2 || !ompi_op_is_commute(op)) {
+        return ompi_coll_base_allreduce_intra_recursivedoubling(sbuf, rbuf, count, dtype,
+                                                                op, comm, module);
+    }
+
+    ompi_datatype_get_extent(dtype, &lb, &extent);
+    ompi_datatype_type_size(dtype, &typelng);
+    segcount = count - count / 2;
+    COLL_BASE_COMPUTED_SEGCOUNT(segsize, typelng, segcount);
+    segspan = opal_datatype_span(&dtype->super, segcount, &gap);
+
+    if (MPI_IN_PLACE != sbuf) {
+        err = ompi_datatype_copy_content_same_ddt(dtype, count, (char *)rbuf, (char *)sbuf);
+        if (MPI_SUCCESS != err) { return err; }
+    }
+
+    tmp_buf_raw = (char *)malloc(8 * segspan);
+    if (NULL == tmp_buf_raw) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    nsegs = 0;
+    for (t = 0; t < 2; t++) {
+        allreduce_dbtree_half_t *half = &halves[t];
+
+        /* the second tree is shifted for odd sizes and mirrored for even sizes */
+        if (0 == t) {
+            pos = rank;
+        } else {
+            pos = (size % 2) ? (rank - 1 + size) % size : size - 1 - rank;
+        }
+        allreduce_btree_links(size, pos, &parent, links);
+#define DBTREE_RANK(P)                                                  \
+        ((P) < 0 ? -1 : (0 == t ? (P) : ((size % 2) ? ((P) + 1) % size : size - 1 - (P))))
+        half->parent = DBTREE_RANK(parent);
+        half->child[0] = DBTREE_RANK(links[0]);
+        half->child[1] = DBTREE_RANK(links[1]);
+#undef DBTREE_RANK
+        /* a pair of processes can be linked in both trees */
+        half->tag = (0 == t) ? MCA_COLL_BASE_TAG_ALLREDUCE : MCA_COLL_BASE_TAG_REDUCE;
+        half->count = (0 == t) ? count / 2 : count - count / 2;
+        half->buf = (char *)rbuf + ((0 == t) ? 0 : (ptrdiff_t)(count / 2) * extent);
+        half->nsegs = (half->count + segcount - 1) / segcount;
+        if (half->nsegs > nsegs) nsegs = half->nsegs;
+        half->ureq = MPI_REQUEST_NULL;
+        half->preqs[0] = half->preqs[1] = MPI_REQUEST_NULL;
+        for (c = 0; c < 2; c++) {
+            half->cbuf[c][0] = tmp_buf_raw + (4 * t + 2 * c) * segspan - gap;
+            half->cbuf[c][1] = tmp_buf_raw + (4 * t + 2 * c + 1) * segspan - gap;
+            half->creqs[c][0] = half->creqs[c][1] = MPI_REQUEST_NULL;
+            half->dreqs[c][0] = half->dreqs[c][1] = MPI_REQUEST_NULL;
+        }
+    }
+
+    /* First segment from the children, the next ones are posted by the steps */
+    for (t = 0; t < 2; t++) {
+        for (c = 0; c < 2; c++) {
+            if (halves[t].child[c] < 0) continue;
+            err = MCA_PML_CALL(irecv(halves[t].cbuf[c][0],
+                                     allreduce_dbtree_segcount(&halves[t], 0, segcount),
+                                     dtype, halves[t].child[c], halves[t].tag, comm,
+                                     &halves[t].creqs[c][0]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+        }
+    }
+
+    for (int it = 0; it < nsegs + 2; it++) {
+        for (t = 0; t < 2; t++) {
+            err = allreduce_dbtree_step(&halves[t], it, segcount, dtype, op, extent, comm);
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+        }
+    }
+
+    for (t = 0; t < 2; t++) {
+        err = ompi_request_wait_all(4, &halves[t].dreqs[0][0], MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { goto error_hndl; }
+    }
+
+    free(tmp_buf_raw);
+    return MPI_SUCCESS;
+
+  error_hndl:
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output, "%s:%4d\tRank %d Error occurred %d\n",
+                 __FILE__, __LINE__, rank, err));
+    for (t = 0; t < 2; t++) {
+        ompi_coll_base_free_reqs(&halves[t].creqs[0][0], 4);
+        ompi_coll_base_free_reqs(&halves[t].dreqs[0][0], 4);
+        ompi_coll_base_free_reqs(halves[t].preqs, 2);
+        ompi_coll_base_free_reqs(&halves[t].ureq, 1);
+    }
+    free(tmp_buf_raw);
+    return err;
+}
+
+/*
+ * ompi_coll_base_allreduce_intra_kary_redscat_allgather
+ *
+ * Function:  Allreduce using a radix-k reduce-scatter followed by an allgather.
+ * Accepts:   Same arguments as MPI_Allreduce, plus the radix
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: generalization of Rabenseifner's algorithm to a radix k.
+ *
+ * Step 1. If the number of processes is not a power of k, the processes
+ * p' = k^{\floor{\log_k p}} and above send their vector to the process
+ * rank % p', which reduces it into its own.
+ *
+ * Step 2. Reduce-scatter in \log_k(p') steps: at step j the processes whose
+ * ranks only differ by their j-th digit in base k form a group of k
+ * processes, split their current window of the vector in k parts and each
+ * one reduces the part indexed by its digit, receiving it from the k - 1
+ * other processes of the group. The parts are reduced in a fixed order to
+ * keep the result reproducible, each one as soon as it arrived while the
+ * next ones are still on the wire.
+ *
+ * Step 3. Allgather in the reverse order: at each step the processes of a
+ * group exchange the parts of their windows they own.
+ *
+ * Step 4. The result is sent back to the processes removed at step 1.
+ *
+ * With k = 2 this is the communication pattern of Rabenseifner's algorithm.
+ *
+ * Limitations:
+ *   count >= k^{\floor{\log_k p}}
+ *   commutative operations only
+ *   intra-communicators only
+ *
+ * Memory requirements (per process):
+ *   count * typesize
+ */
+int
+ompi_coll_base_allreduce_intra_kary_redscat_allgather(const void *sbuf, void *rbuf, int count,
+                                                      struct ompi_datatype_t *dtype,
+                                                      struct ompi_op_t *op,
+                                                      struct ompi_communicator_t *comm,
+                                                      mca_coll_base_module_t *module,
+                                                      int radix)
+{
+    int err = MPI_SUCCESS, size, rank, nsteps, nprocs_pofk, split, early, late;
+    int step, dist, wsize, wstart, sub, digit, peer, nreqs, i, n;
+    ptrdiff_t lb, extent, gap = 0, slotspan, dsize;
+    ompi_request_t **reqs = NULL;
+    char *tmp_buf = NULL, *tmp_buf_raw = NULL;
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:allreduce_intra_kary_redscat_allgather rank %d/%d, radix %d",
+                 rank, size, radix));
+
+    if (radix > size) radix = size;
+    if (radix < 2) radix = 2;
+
+    /* Find the largest power of the radix less than or equal to comm_size */
+    for (nsteps = 0, nprocs_pofk = 1; nprocs_pofk <= size / radix; nsteps++) {
+        nprocs_pofk *= radix;
+    }
+
+    if (size < 2 || count < nprocs_pofk || !ompi_op_is_commute(op)) {
+        OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                     "coll:base:allreduce_intra_kary_redscat_allgather rank %d/%d "
+                     "count %d switching to recursive doubling allreduce",
+                     rank, size, count));
+        return ompi_coll_base_allreduce_intra_recursivedoubling(sbuf, rbuf, count, dtype,
+                                                                op, comm, module);
+    }
+
+    ompi_datatype_get_extent(dtype, &lb, &extent);
+    COLL_BASE_COMPUTE_BLOCKCOUNT(count, nprocs_pofk, split, early, late);
+#define KARY_BLOCK_OFFSET(B)                                            \
+    ((B) < split ? (ptrdiff_t)(B) * early : (ptrdiff_t)(B) * late + split)
+
+    /* k - 1 parts of the first window, or a whole vector to fold */
+    slotspan = opal_datatype_span(&dtype->super, (size_t)(nprocs_pofk / radix) * early, &gap);
+    dsize = opal_datatype_span(&dtype->super, count, &gap);
+    if (dsize < (radix - 1) * slotspan) {
+        dsize = (radix - 1) * slotspan;
+    }
+    tmp_buf_raw = (char *)malloc(dsize);
+    if (NULL == tmp_buf_raw) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    tmp_buf = tmp_buf_raw - gap;
+
+    reqs = ompi_coll_base_comm_get_reqs(module->base_data, 2 * (radix - 1));
+    if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; goto cleanup_and_return; }
+
+    if (MPI_IN_PLACE != sbuf) {
+        err = ompi_datatype_copy_content_same_ddt(dtype, count, (char *)rbuf, (char *)sbuf);
+        if (MPI_SUCCESS != err) { goto cleanup_and_return; }
+    }
+
+    /* Step 1. Fold the processes above p' */
+    if (rank >= nprocs_pofk) {
+        err = MCA_PML_CALL(send(rbuf, count, dtype, rank % nprocs_pofk,
+                                MCA_COLL_BASE_TAG_ALLREDUCE,
+                                MCA_PML_BASE_SEND_STANDARD, comm));
+        if (MPI_SUCCESS != err) { goto cleanup_and_return; }
+        err = MCA_PML_CALL(recv(rbuf, count, dtype, rank % nprocs_pofk,
+                                MCA_COLL_BASE_TAG_ALLREDUCE, comm, MPI_STATUS_IGNORE));
+        goto cleanup_and_return;
+    }
+    for (peer = rank + nprocs_pofk; peer < size; peer += nprocs_pofk) {
+        err = MCA_PML_CALL(recv(tmp_buf, count, dtype, peer,
+                                MCA_COLL_BASE_TAG_ALLREDUCE, comm, MPI_STATUS_IGNORE));
+        if (MPI_SUCCESS != err) { goto cleanup_and_return; }
+        ompi_op_reduce(op, tmp_buf, rbuf, count, dtype);
+    }
+
+    /*
+     * Step 2. Reduce-scatter. The window [wstart, wstart + wsize) is in
+     * blocks of the vector, one block per process.
+     */
+    wstart = 0;
+    wsize = nprocs_pofk;
+    for (step = 0, dist = 1; step < nsteps; step++, dist *= radix) {
+        sub = wsize / radix;
+        digit = (rank / dist) % radix;
+        n = (int)(KARY_BLOCK_OFFSET(wstart + (digit + 1) * sub) -
+                  KARY_BLOCK_OFFSET(wstart + digit * sub));
+
+        for (i = 0, nreqs = 0; i < radix; i++) {
+            if (i == digit) continue;
+            peer = rank + (i - digit) * dist;
+            err = MCA_PML_CALL(irecv(tmp_buf + (ptrdiff_t)nreqs * slotspan, n, dtype, peer,
+                                     MCA_COLL_BASE_TAG_ALLREDUCE, comm, &reqs[nreqs]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+            err = MCA_PML_CALL(isend((char *)rbuf + KARY_BLOCK_OFFSET(wstart + i * sub) * extent,
+                                     (int)(KARY_BLOCK_OFFSET(wstart + (i + 1) * sub) -
+                                           KARY_BLOCK_OFFSET(wstart + i * sub)),
+                                     dtype, peer, MCA_COLL_BASE_TAG_ALLREDUCE,
+                                     MCA_PML_BASE_SEND_STANDARD, comm,
+                                     &reqs[radix - 1 + nreqs]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+            nreqs++;
+        }
+
+        for (i = 0; i < radix - 1; i++) {
+            err = ompi_request_wait(&reqs[i], MPI_STATUS_IGNORE);
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+            ompi_op_reduce(op, tmp_buf + (ptrdiff_t)i * slotspan,
+                           (char *)rbuf + KARY_BLOCK_OFFSET(wstart + digit * sub) * extent,
+                           n, dtype);
+        }
+        err = ompi_request_wait_all(radix - 1, reqs + radix - 1, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { goto error_hndl; }
+
+        wstart += digit * sub;
+        wsize = sub;
+    }
+
+    /* Step 3. Allgather, in the reverse order of the reduce-scatter */
+    for (step = nsteps - 1, dist = nprocs_pofk / radix; step >= 0; step--, dist /= radix) {
+        sub = wsize;
+        digit = (rank / dist) % radix;
+        wstart -= digit * sub;
+        wsize = sub * radix;
+
+        for (i = 0, nreqs = 0; i < radix; i++) {
+            if (i == digit) continue;
+            peer = rank + (i - digit) * dist;
+            err = MCA_PML_CALL(irecv((char *)rbuf + KARY_BLOCK_OFFSET(wstart + i * sub) * extent,
+                                     (int)(KARY_BLOCK_OFFSET(wstart + (i + 1) * sub) -
+                                           KARY_BLOCK_OFFSET(wstart + i * sub)),
+                                     dtype, peer, MCA_COLL_BASE_TAG_ALLREDUCE, comm,
+                                     &reqs[nreqs++]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+            err = MCA_PML_CALL(isend((char *)rbuf + KARY_BLOCK_OFFSET(wstart + digit * sub) * extent,
+                                     (int)(KARY_BLOCK_OFFSET(wstart + (digit + 1) * sub) -
+                                           KARY_BLOCK_OFFSET(wstart + digit * sub)),
+                                     dtype, peer, MCA_COLL_BASE_TAG_ALLREDUCE,
+                                     MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs++]));
+            if (MPI_SUCCESS != err) { goto error_hndl; }
+        }
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { goto error_hndl; }
+    }
+#undef KARY_BLOCK_OFFSET
+
+    /* Step 4. Send the result to the folded processes */
+    for (peer = rank + nprocs_pofk; peer < size; peer += nprocs_pofk) {
+        err = MCA_PML_CALL(send(rbuf, count, dtype, peer,
+                                MCA_COLL_BASE_TAG_ALLREDUCE,
+                                MCA_PML_BASE_SEND_STANDARD, comm));
+        if (MPI_SUCCESS != err) { goto cleanup_and_return; }
+    }
+
+  cleanup_and_return:
+    free(tmp_buf_raw);
+    return err;
+
+  error_hndl:
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output, "%s:%4d\tRank %d Error occurred %d\n",
+                 __FILE__, __LINE__, rank, err));
+    ompi_coll_base_free_reqs(reqs, 2 * (radix - 1));
+    free(tmp_buf_raw);
+    return err;
+}
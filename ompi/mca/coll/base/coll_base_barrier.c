@@ -284,6 +284,59 @@ int ompi_coll_base_barrier_intra_bruck(struct ompi_communicator_t *comm,
 }
 
 
+/*
+ * k-dissemination barrier, the generalization of the bruck barrier to
+ * radix - 1 concurrent peers per round: in each of the ceil(log_radix(size))
+ * rounds every process notifies rank + i * distance and waits for
+ * rank - i * distance, for i = 1 .. radix - 1.
+ */
+
+int ompi_coll_base_barrier_intra_kdissemination(struct ompi_communicator_t *comm,
+                                                mca_coll_base_module_t *module,
+                                                int radix)
+{
+    int rank, size, distance, nreqs = 0, err, line = 0;
+    ompi_request_t **reqs = NULL;
+
+    size = ompi_comm_size(comm);
+    if( 1 == size )
+        return MPI_SUCCESS;
+    rank = ompi_comm_rank(comm);
+    if (radix > size) radix = size;
+    if (radix < 2) radix = 2;
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "ompi_coll_base_barrier_intra_kdissemination rank %d radix %d", rank, radix));
+
+    reqs = ompi_coll_base_comm_get_reqs(module->base_data, 2 * (radix - 1));
+    if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+
+    for (distance = 1; distance < size; distance *= radix) {
+        nreqs = 0;
+        for (int i = 1; i < radix && i * distance < size; i++) {
+            err = MCA_PML_CALL(irecv(NULL, 0, MPI_BYTE, (rank + size - i * distance) % size,
+                                     MCA_COLL_BASE_TAG_BARRIER, comm, &reqs[nreqs++]));
+            if (err != MPI_SUCCESS) { line = __LINE__; goto err_hndl;}
+
+            err = MCA_PML_CALL(isend(NULL, 0, MPI_BYTE, (rank + i * distance) % size,
+                                     MCA_COLL_BASE_TAG_BARRIER,
+                                     MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs++]));
+            if (err != MPI_SUCCESS) { line = __LINE__; goto err_hndl;}
+        }
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (err != MPI_SUCCESS) { line = __LINE__; goto err_hndl;}
+    }
+
+    return MPI_SUCCESS;
+
+ err_hndl:
+    if (NULL != reqs)
+        ompi_coll_base_free_reqs(reqs, nreqs);
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,"%s:%4d\tError occurred %d, rank %2d",
+                 __FILE__, line, err, rank));
+    (void)line;  // silence compiler warning
+    return err;
+}
+
 /*
  * To make synchronous, uses sync sends and sync sendrecvs
  */
@@ -189,6 +189,7 @@ BEGIN_C_DECLS
 /* All Gather */
 int ompi_coll_base_allgather_intra_bruck(ALLGATHER_ARGS);
 int ompi_coll_base_allgather_intra_recursivedoubling(ALLGATHER_ARGS);
+int ompi_coll_base_allgather_intra_recursivemultiplying(ALLGATHER_ARGS, int radix);
 int ompi_coll_base_allgather_intra_ring(ALLGATHER_ARGS);
 int ompi_coll_base_allgather_intra_neighborexchange(ALLGATHER_ARGS);
 int ompi_coll_base_allgather_intra_basic_linear(ALLGATHER_ARGS);
@@ -208,6 +209,9 @@ int ompi_coll_base_allreduce_intra_ring(ALLREDUCE_ARGS);
 int ompi_coll_base_allreduce_intra_ring_segmented(ALLREDUCE_ARGS, uint32_t segsize);
 int ompi_coll_base_allreduce_intra_basic_linear(ALLREDUCE_ARGS);
 int ompi_coll_base_allreduce_intra_redscat_allgather(ALLREDUCE_ARGS);
+int ompi_coll_base_allreduce_intra_redscat_allgather_segmented(ALLREDUCE_ARGS, uint32_t segsize);
+int ompi_coll_base_allreduce_intra_dbtree(ALLREDUCE_ARGS, uint32_t segsize);
+int ompi_coll_base_allreduce_intra_kary_redscat_allgather(ALLREDUCE_ARGS, int radix);
 
 /* AlltoAll */
 int ompi_coll_base_alltoall_intra_pairwise(ALLTOALL_ARGS);
@@ -234,6 +238,7 @@ int mca_coll_base_alltoallv_intra_basic_inplace(const void *rbuf, const int *rco
 int ompi_coll_base_barrier_intra_doublering(BARRIER_ARGS);
 int ompi_coll_base_barrier_intra_recursivedoubling(BARRIER_ARGS);
 int ompi_coll_base_barrier_intra_bruck(BARRIER_ARGS);
+int ompi_coll_base_barrier_intra_kdissemination(BARRIER_ARGS, int radix);
 int ompi_coll_base_barrier_intra_two_procs(BARRIER_ARGS);
 int ompi_coll_base_barrier_intra_tree(BARRIER_ARGS);
 int ompi_coll_base_barrier_intra_basic_linear(BARRIER_ARGS);
@@ -258,6 +263,7 @@ int ompi_coll_base_exscan_intra_recursivedoubling(EXSCAN_ARGS);
 /* Gather */
 int ompi_coll_base_gather_intra_basic_linear(GATHER_ARGS);
 int ompi_coll_base_gather_intra_binomial(GATHER_ARGS);
+int ompi_coll_base_gather_intra_knomial(GATHER_ARGS, int radix);
 int ompi_coll_base_gather_intra_linear_sync(GATHER_ARGS, int first_segment_size);
 
 /* GatherV */
@@ -270,6 +276,7 @@ int ompi_coll_base_reduce_intra_pipeline(REDUCE_ARGS, uint32_t segsize, int max_
 int ompi_coll_base_reduce_intra_binary(REDUCE_ARGS, uint32_t segsize, int max_outstanding_reqs );
 int ompi_coll_base_reduce_intra_binomial(REDUCE_ARGS, uint32_t segsize, int max_outstanding_reqs );
 int ompi_coll_base_reduce_intra_in_order_binary(REDUCE_ARGS, uint32_t segsize, int max_outstanding_reqs );
+int ompi_coll_base_reduce_intra_knomial(REDUCE_ARGS, uint32_t segsize, int max_outstanding_reqs, int radix);
 int ompi_coll_base_reduce_intra_redscat_gather(REDUCE_ARGS);
 
 /* Reduce_scatter */
@@ -292,6 +299,7 @@ int ompi_coll_base_scan_intra_recursivedoubling(SCAN_ARGS);
 /* Scatter */
 int ompi_coll_base_scatter_intra_basic_linear(SCATTER_ARGS);
 int ompi_coll_base_scatter_intra_binomial(SCATTER_ARGS);
+int ompi_coll_base_scatter_intra_knomial(SCATTER_ARGS, int radix);
 int ompi_coll_base_scatter_intra_linear_nb(SCATTER_ARGS, int max_reqs);
 
 /* ScatterV */
@@ -197,6 +197,148 @@ ompi_coll_base_gather_intra_binomial(const void *sbuf, int scount,
     return err;
 }
 
+/*
+ * ompi_coll_base_gather_intra_knomial
+ *
+ * Function:  Gather using a k-nomial tree.
+ * Accepts:   Same arguments as MPI_Gather, plus the tree radix (>= 2)
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: generalization of the binomial gather to the k-nomial tree
+ *   of ompi_coll_base_topo_build_kmtree. Relative to the root, the subtree
+ *   of the virtual rank v spans the virtual ranks [v, v + m), m being the
+ *   largest power of the radix dividing v (the whole communicator for the
+ *   root). Each inner process receives the subtrees of all its children at
+ *   once, directly at their place in its buffer, and sends its whole
+ *   subtree to its parent in a single message.
+ *
+ * Memory requirements (per process):
+ *   the blocks of the subtree on inner processes, rcount * size on the
+ *   root if the root is not 0.
+ */
+int
+ompi_coll_base_gather_intra_knomial(const void *sbuf, int scount,
+                                    struct ompi_datatype_t *sdtype,
+                                    void *rbuf, int rcount,
+                                    struct ompi_datatype_t *rdtype,
+                                    int root,
+                                    struct ompi_communicator_t *comm,
+                                    mca_coll_base_module_t *module,
+                                    int radix)
+{
+    int line = -1, rank, vrank, size, mask, subtree, nreqs = 0, count, err;
+    char *ptmp = NULL, *tempbuf = NULL;
+    ompi_request_t **reqs = NULL;
+    struct ompi_datatype_t *dtype;
+    ptrdiff_t extent, gap = 0, span;
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+    if (radix < 2) radix = 2;
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "ompi_coll_base_gather_intra_knomial rank %d radix %d", rank, radix));
+
+    /* the children are below the lowest non-zero digit of vrank in base radix */
+    vrank = (rank - root + size) % size;
+    for (mask = 1; mask < size && 0 == vrank % (radix * mask); mask *= radix);
+    subtree = (mask < size - vrank) ? mask : size - vrank;
+
+    /* rdtype, rcount are ignored on non-root processes */
+    dtype = (rank == root) ? rdtype : sdtype;
+    count = (rank == root) ? rcount : scount;
+    ompi_datatype_type_extent(dtype, &extent);
+
+    if (rank == root && 0 == root) {
+        /* root on 0, just use the recv buffer */
+        ptmp = (char *) rbuf;
+        if (sbuf != MPI_IN_PLACE) {
+            err = ompi_datatype_sndrcv((void *)sbuf, scount, sdtype,
+                                       ptmp, rcount, rdtype);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+    } else if (subtree > 1) {
+        /* root not on 0 (data rotated at the end) and other inner processes */
+        span = opal_datatype_span(&dtype->super, (int64_t)count * subtree, &gap);
+        tempbuf = (char *) malloc(span);
+        if (NULL == tempbuf) {
+            err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl;
+        }
+        ptmp = tempbuf - gap;
+        if (sbuf != MPI_IN_PLACE) {
+            err = ompi_datatype_sndrcv((void *)sbuf, scount, sdtype,
+                                       ptmp, count, dtype);
+        } else {
+            err = ompi_datatype_copy_content_same_ddt(rdtype, rcount, ptmp,
+                                                      (char *)rbuf + (ptrdiff_t)rank * extent * (ptrdiff_t)rcount);
+        }
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    } else {
+        /* leaf, no temp buffer needed */
+        ptmp = (char *) sbuf;
+    }
+
+    if (subtree > 1) {
+        nreqs = 0;
+        for (int m = 1; m < mask; m *= radix) {
+            for (int r = 1; r < radix && vrank + r * m < size; r++) {
+                nreqs++;
+            }
+        }
+        reqs = ompi_coll_base_comm_get_reqs(module->base_data, nreqs);
+        if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+
+        nreqs = 0;
+        for (int m = 1; m < mask; m *= radix) {
+            for (int r = 1; r < radix && vrank + r * m < size; r++) {
+                int vkid = vrank + r * m;
+                int kidcount = (m < size - vkid) ? m : size - vkid;
+
+                err = MCA_PML_CALL(irecv(ptmp + (ptrdiff_t)(vkid - vrank) * (ptrdiff_t)count * extent,
+                                         (ptrdiff_t)kidcount * (ptrdiff_t)count, dtype,
+                                         (vkid + root) % size, MCA_COLL_BASE_TAG_GATHER,
+                                         comm, &reqs[nreqs++]));
+                if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            }
+        }
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    if (rank != root) {
+        /* all processes except root send their subtree to their parent */
+        err = MCA_PML_CALL(send(ptmp, (ptrdiff_t)subtree * (ptrdiff_t)count, dtype,
+                                (vrank - vrank % (radix * mask) + root) % size,
+                                MCA_COLL_BASE_TAG_GATHER,
+                                MCA_PML_BASE_SEND_STANDARD, comm));
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    } else if (0 != root) {
+        /* rotate received data on root if root != 0 */
+        err = ompi_datatype_copy_content_same_ddt(rdtype, (ptrdiff_t)rcount * (ptrdiff_t)(size - root),
+                                                  (char *)rbuf + extent * (ptrdiff_t)root * (ptrdiff_t)rcount, ptmp);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        err = ompi_datatype_copy_content_same_ddt(rdtype, (ptrdiff_t)rcount * (ptrdiff_t)root,
+                                                  (char *) rbuf, ptmp + extent * (ptrdiff_t)rcount * (ptrdiff_t)(size-root));
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    if (NULL != tempbuf)
+        free(tempbuf);
+    return MPI_SUCCESS;
+
+ err_hndl:
+    if (NULL != reqs)
+        ompi_coll_base_free_reqs(reqs, nreqs);
+    if (NULL != tempbuf)
+        free(tempbuf);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,  "%s:%4d\tError occurred %d, rank %2d",
+                 __FILE__, line, err, rank));
+    (void)line;  // silence compiler warning
+    return err;
+}
+
 /*
  *	gather_intra_linear_sync
  *
@@ -499,6 +499,65 @@ int ompi_coll_base_reduce_intra_binomial( const void *sendbuf, void *recvbuf,
                                            segcount, max_outstanding_reqs );
 }
 
+/*
+ * reduce_intra_knomial
+ *
+ * Function:      Logarithmic reduce operation along a k-nomial tree.
+ * Accepts:       same as MPI_Reduce(), plus the tree radix (>= 2)
+ * Returns:       MPI_SUCCESS or error code
+ *
+ * The tree is the one of ompi_coll_base_bcast_intra_knomial: with a larger
+ * radix, the depth of the tree (and so the number of steps on the critical
+ * path) decreases while each inner process reduces more children.
+ * Non-commutative operations use the in-order binary tree.
+ */
+int ompi_coll_base_reduce_intra_knomial( const void *sendbuf, void *recvbuf,
+                                         int count, ompi_datatype_t* datatype,
+                                         ompi_op_t* op, int root,
+                                         ompi_communicator_t* comm,
+                                         mca_coll_base_module_t *module,
+                                         uint32_t segsize,
+                                         int max_outstanding_reqs,
+                                         int radix )
+{
+    int segcount = count;
+    size_t typelng;
+    mca_coll_base_module_t *base_module = (mca_coll_base_module_t*) module;
+    mca_coll_base_comm_t *data = base_module->base_data;
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,"coll:base:reduce_intra_knomial rank %d ss %5d radix %d",
+                 ompi_comm_rank(comm), segsize, radix));
+
+    if( !ompi_op_is_commute(op) ) {
+        return ompi_coll_base_reduce_intra_in_order_binary( sendbuf, recvbuf, count, datatype,
+                                                            op, root, comm, module,
+                                                            segsize, max_outstanding_reqs );
+    }
+    if( radix < 2 ) {
+        radix = 2;
+    }
+
+    COLL_BASE_UPDATE_KMTREE( comm, base_module, root, radix );
+    if( NULL == data->cached_kmtree ) {
+        /* Failed to build k-nomial tree for given radix */
+        return ompi_coll_base_reduce_intra_binomial( sendbuf, recvbuf, count, datatype,
+                                                     op, root, comm, module,
+                                                     segsize, max_outstanding_reqs );
+    }
+
+    /**
+     * Determine number of segments and number of elements
+     * sent per operation
+     */
+    ompi_datatype_type_size( datatype, &typelng );
+    COLL_BASE_COMPUTED_SEGCOUNT( segsize, typelng, segcount );
+
+    return ompi_coll_base_reduce_generic( sendbuf, recvbuf, count, datatype,
+                                           op, root, comm, module,
+                                           data->cached_kmtree,
+                                           segcount, max_outstanding_reqs );
+}
+
 /*
  * reduce_intra_in_order_binary
  *
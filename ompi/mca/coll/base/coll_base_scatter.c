@@ -194,6 +194,148 @@ ompi_coll_base_scatter_intra_binomial(
     return err;
 }
 
+/*
+ * ompi_coll_base_scatter_intra_knomial
+ *
+ * Function:  Scatter using a k-nomial tree.
+ * Accepts:   Same arguments as MPI_Scatter, plus the tree radix (>= 2)
+ * Returns:   MPI_SUCCESS or error code
+ *
+ * Description: generalization of the binomial scatter to the k-nomial tree
+ *   of ompi_coll_base_topo_build_kmtree, the reverse of
+ *   ompi_coll_base_gather_intra_knomial: each inner process receives the
+ *   blocks of its whole subtree from its parent in a single message and
+ *   sends the subtrees of all its children at once, the largest first.
+ *
+ * Memory requirements (per process):
+ *   the blocks of the subtree on inner processes, scount * size on the
+ *   root if the root is not 0.
+ */
+int
+ompi_coll_base_scatter_intra_knomial(
+    const void *sbuf, int scount, struct ompi_datatype_t *sdtype,
+    void *rbuf, int rcount, struct ompi_datatype_t *rdtype,
+    int root, struct ompi_communicator_t *comm,
+    mca_coll_base_module_t *module, int radix)
+{
+    int line = -1, rank, vrank, size, mask, subtree, nreqs = 0, count, err;
+    char *ptmp, *tempbuf = NULL;
+    ompi_request_t **reqs = NULL;
+    struct ompi_datatype_t *dtype;
+    ptrdiff_t extent, gap = 0, span;
+
+    size = ompi_comm_size(comm);
+    rank = ompi_comm_rank(comm);
+    if (radix < 2) radix = 2;
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,
+                 "coll:base:scatter_intra_knomial rank %d/%d radix %d", rank, size, radix));
+
+    /* the children are below the lowest non-zero digit of vrank in base radix */
+    vrank = (rank - root + size) % size;
+    for (mask = 1; mask < size && 0 == vrank % (radix * mask); mask *= radix);
+    subtree = (mask < size - vrank) ? mask : size - vrank;
+
+    /* sdtype, scount are ignored on non-root processes */
+    dtype = (rank == root) ? sdtype : rdtype;
+    count = (rank == root) ? scount : rcount;
+    ompi_datatype_type_extent(dtype, &extent);
+    ptmp = (char *)rbuf;  /* by default suppose leaf nodes, just use rbuf */
+
+    if (rank == root) {
+        if (0 == root) {
+            /* root on 0, just use the send buffer */
+            ptmp = (char *)sbuf;
+        } else {
+            /* root is not on 0, allocate temp buffer for send */
+            span = opal_datatype_span(&sdtype->super, (int64_t)scount * size, &gap);
+            tempbuf = (char *)malloc(span);
+            if (NULL == tempbuf) {
+                err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl;
+            }
+            ptmp = tempbuf - gap;
+
+            /* and rotate data so they will eventually in the right place */
+            err = ompi_datatype_copy_content_same_ddt(sdtype, (ptrdiff_t)scount * (ptrdiff_t)(size - root),
+                                                      ptmp, (char *) sbuf + extent * (ptrdiff_t)root * (ptrdiff_t)scount);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+            err = ompi_datatype_copy_content_same_ddt(sdtype, (ptrdiff_t)scount * (ptrdiff_t)root,
+                                                      ptmp + extent * (ptrdiff_t)scount * (ptrdiff_t)(size - root), (char *)sbuf);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+        if (rbuf != MPI_IN_PLACE) {
+            /* local copy to rbuf */
+            err = ompi_datatype_sndrcv(ptmp, scount, sdtype,
+                                       rbuf, rcount, rdtype);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+    } else {
+        if (subtree > 1) {
+            /* inner nodes, allocate temp buffer for the subtree */
+            span = opal_datatype_span(&rdtype->super, (int64_t)rcount * subtree, &gap);
+            tempbuf = (char *)malloc(span);
+            if (NULL == tempbuf) {
+                err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl;
+            }
+            ptmp = tempbuf - gap;
+        }
+        /* recv the subtree from parent */
+        err = MCA_PML_CALL(recv(ptmp, (ptrdiff_t)rcount * (ptrdiff_t)subtree, rdtype,
+                                (vrank - vrank % (radix * mask) + root) % size,
+                                MCA_COLL_BASE_TAG_SCATTER, comm, MPI_STATUS_IGNORE));
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+
+        if (subtree > 1) {
+            /* local copy to rbuf */
+            err = ompi_datatype_copy_content_same_ddt(rdtype, rcount, rbuf, ptmp);
+            if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+        }
+    }
+
+    if (subtree > 1) {
+        for (int m = 1; m < mask; m *= radix) {
+            for (int r = 1; r < radix && vrank + r * m < size; r++) {
+                nreqs++;
+            }
+        }
+        reqs = ompi_coll_base_comm_get_reqs(module->base_data, nreqs);
+        if (NULL == reqs) { err = OMPI_ERR_OUT_OF_RESOURCE; line = __LINE__; goto err_hndl; }
+
+        nreqs = 0;
+        for (int m = mask / radix; m > 0; m /= radix) {
+            for (int r = radix - 1; r > 0; r--) {
+                int vkid = vrank + r * m, kidcount;
+
+                if (vkid >= size) continue;
+                kidcount = (m < size - vkid) ? m : size - vkid;
+                err = MCA_PML_CALL(isend(ptmp + (ptrdiff_t)(vkid - vrank) * (ptrdiff_t)count * extent,
+                                         (ptrdiff_t)kidcount * (ptrdiff_t)count, dtype,
+                                         (vkid + root) % size, MCA_COLL_BASE_TAG_SCATTER,
+                                         MCA_PML_BASE_SEND_STANDARD, comm, &reqs[nreqs++]));
+                if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+            }
+        }
+        err = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+        if (MPI_SUCCESS != err) { line = __LINE__; goto err_hndl; }
+    }
+
+    if (NULL != tempbuf)
+        free(tempbuf);
+    return MPI_SUCCESS;
+
+ err_hndl:
+    if (NULL != reqs)
+        ompi_coll_base_free_reqs(reqs, nreqs);
+    if (NULL != tempbuf)
+        free(tempbuf);
+
+    OPAL_OUTPUT((ompi_coll_base_framework.framework_output,  "%s:%4d\tError occurred %d, rank %2d",
+                 __FILE__, line, err, rank));
+    (void)line;  // silence compiler warning
+    return err;
+}
+
 /*
  * Linear functions are copied from the BASIC coll module
  * they do not segment the message and are simple implementations
@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file
+ *
+ * Hierarchical (node-aware) collectives.
+ *
+ * The communicator is split in a node-local communicator and a
+ * communicator of the node leaders (the lowest rank of each node).
+ * Collectives run an on-node phase with the collectives selected on
+ * the node-local communicator (e.g., coll/sm) and an inter-node phase
+ * with the ompi_coll_base algorithms on the leader communicator.  For
+ * large messages, bcast, reduce and allreduce are cut in segments and
+ * the on-node phase of a segment (non-blocking) overlaps with the
+ * inter-node phase of the next one.  Gather and scatter cut the blocks
+ * of a node in segments of whole blocks, allgather and allgatherv
+ * broadcast each segment on the node as soon as it arrives from the
+ * other leaders.
+ *
+ * The sub-communicators are created on the first collective, like the
+ * shared memory of coll/sm, and cached in the module.  Collectives
+ * issued while they are created, and all the collectives of
+ * communicators with a single process per node, go to the prior
+ * layer.
+ */
+
+#ifndef MCA_COLL_HIER_EXPORT_H
+#define MCA_COLL_HIER_EXPORT_H
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+
+#include "opal/class/opal_object.h"
+#include "opal/mca/mca.h"
+
+#include "ompi/constants.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/request/request.h"
+
+BEGIN_C_DECLS
+
+/* Types */
+/* Component */
+
+typedef struct mca_coll_hier_component_t {
+    mca_coll_base_component_2_0_0_t super;
+
+    /* Priority of this component */
+    int priority;
+
+    /* Size (in bytes) of the segments of pipelined collectives (0 to
+       disable pipelining) */
+    size_t segsize;
+} mca_coll_hier_component_t;
+
+/* Module */
+
+typedef struct mca_coll_hier_module_t {
+    mca_coll_base_module_t super;
+
+    /* Pointers to all the "real" collective functions */
+    mca_coll_base_comm_coll_t c_coll;
+
+    /* The sub-communicators have been set up */
+    bool enabled;
+
+    /* The sub-communicators are being set up, use c_coll */
+    bool in_setup;
+
+    /* A single process per node (or the setup failed), use c_coll */
+    bool flat;
+
+    /* Processes of my node, ordered by rank */
+    struct ompi_communicator_t *local_comm;
+
+    /* Node leaders, ordered by rank (NULL if I am not a leader).  The
+       rank of a leader in this communicator is the number of its
+       node. */
+    struct ompi_communicator_t *leader_comm;
+
+    /* Module holding the cached topologies of the ompi_coll_base
+       algorithms on leader_comm */
+    mca_coll_base_module_t *leader_module;
+
+    /* Number of nodes and my node */
+    int num_nodes;
+    int my_node;
+
+    /* Node and local rank of each process */
+    int *node_of;
+    int *local_rank_of;
+
+    /* Number of processes on each node, index of the first one in
+       node order, and ranks in node order */
+    int *node_sizes;
+    int *node_disps;
+    int *ranks_by_node;
+
+    /* Node order is the rank order (every node holds consecutive
+       ranks) */
+    bool is_block;
+} mca_coll_hier_module_t;
+
+OBJ_CLASS_DECLARATION(mca_coll_hier_module_t);
+
+/* Globally exported variables */
+
+OMPI_MODULE_DECLSPEC extern mca_coll_hier_component_t mca_coll_hier_component;
+
+/* API functions */
+
+int mca_coll_hier_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads);
+mca_coll_base_module_t
+*mca_coll_hier_comm_query(struct ompi_communicator_t *comm,
+                          int *priority);
+
+int mca_coll_hier_module_enable(mca_coll_base_module_t *module,
+                                struct ompi_communicator_t *comm);
+
+int mca_coll_hier_lazy_enable(mca_coll_hier_module_t *module,
+                              struct ompi_communicator_t *comm);
+
+int mca_coll_hier_allgather(const void *sbuf, int scount,
+                            struct ompi_datatype_t *sdtype,
+                            void *rbuf, int rcount,
+                            struct ompi_datatype_t *rdtype,
+                            struct ompi_communicator_t *comm,
+                            mca_coll_base_module_t *module);
+
+int mca_coll_hier_allgatherv(const void *sbuf, int scount,
+                             struct ompi_datatype_t *sdtype,
+                             void *rbuf, const int *rcounts, const int *disps,
+                             struct ompi_datatype_t *rdtype,
+                             struct ompi_communicator_t *comm,
+                             mca_coll_base_module_t *module);
+
+int mca_coll_hier_allgatherv_nodes(const void *sbuf, int scount,
+                                   struct ompi_datatype_t *sdtype,
+                                   void *rbuf, const int *rcounts, const int *disps,
+                                   struct ompi_datatype_t *rdtype,
+                                   struct ompi_communicator_t *comm,
+                                   mca_coll_hier_module_t *m);
+
+int mca_coll_hier_allreduce(const void *sbuf, void *rbuf, int count,
+                            struct ompi_datatype_t *dtype,
+                            struct ompi_op_t *op,
+                            struct ompi_communicator_t *comm,
+                            mca_coll_base_module_t *module);
+
+int mca_coll_hier_bcast(void *buff, int count,
+                        struct ompi_datatype_t *datatype,
+                        int root,
+                        struct ompi_communicator_t *comm,
+                        mca_coll_base_module_t *module);
+
+int mca_coll_hier_gather(const void *sbuf, int scount,
+                         struct ompi_datatype_t *sdtype,
+                         void *rbuf, int rcount,
+                         struct ompi_datatype_t *rdtype,
+                         int root,
+                         struct ompi_communicator_t *comm,
+                         mca_coll_base_module_t *module);
+
+int mca_coll_hier_reduce(const void *sbuf, void *rbuf, int count,
+                         struct ompi_datatype_t *dtype,
+                         struct ompi_op_t *op,
+                         int root,
+                         struct ompi_communicator_t *comm,
+                         mca_coll_base_module_t *module);
+
+int mca_coll_hier_scatter(const void *sbuf, int scount,
+                          struct ompi_datatype_t *sdtype,
+                          void *rbuf, int rcount,
+                          struct ompi_datatype_t *rdtype,
+                          int root,
+                          struct ompi_communicator_t *comm,
+                          mca_coll_base_module_t *module);
+
+int mca_coll_hier_ft_event(int status);
+
+/* Helpers */
+
+/*
+ * Whether to run the hierarchical algorithms on this communicator,
+ * setting up the sub-communicators the first time.
+ */
+static inline bool mca_coll_hier_use(mca_coll_hier_module_t *m,
+                                     struct ompi_communicator_t *comm)
+{
+    if (OPAL_UNLIKELY(!m->enabled)) {
+        if (m->in_setup) {
+            return false;
+        }
+        (void) mca_coll_hier_lazy_enable(m, comm);
+    }
+    return !m->flat;
+}
+
+/*
+ * Number of elements of dtype per segment of a pipelined collective of
+ * count elements, or count if the collective is not pipelined
+ */
+static inline int mca_coll_hier_segment_count(struct ompi_datatype_t *dtype,
+                                              int count)
+{
+    size_t type_size, seg_count;
+
+    ompi_datatype_type_size(dtype, &type_size);
+    if (0 == mca_coll_hier_component.segsize || 0 == type_size ||
+        (size_t) count * type_size <= mca_coll_hier_component.segsize) {
+        return count;
+    }
+    seg_count = mca_coll_hier_component.segsize / type_size;
+    return (0 == seg_count) ? 1 : (int) seg_count;
+}
+
+/*
+ * Number of blocks of count elements of dtype per segment of the
+ * pipelined gather and scatter, or 0 if they are not pipelined.  The
+ * processes only agree on the type signature of a block, not on its
+ * datatype, so the segments hold whole blocks.
+ */
+static inline int mca_coll_hier_segment_blocks(struct ompi_datatype_t *dtype,
+                                               int count)
+{
+    size_t type_size, block_size;
+
+    ompi_datatype_type_size(dtype, &type_size);
+    block_size = type_size * (size_t) count;
+    if (0 == mca_coll_hier_component.segsize || 0 == block_size) {
+        return 0;
+    }
+    if (block_size >= mca_coll_hier_component.segsize) {
+        return 1;
+    }
+    return (int) (mca_coll_hier_component.segsize / block_size);
+}
+
+/*
+ * Number of segments of the blocks of a node, with seg_blocks blocks
+ * per segment (all of them in one segment if seg_blocks is 0)
+ */
+static inline int mca_coll_hier_node_segs(mca_coll_hier_module_t *m, int node,
+                                          int seg_blocks)
+{
+    if (0 == seg_blocks) {
+        return 1;
+    }
+    return (m->node_sizes[node] + seg_blocks - 1) / seg_blocks;
+}
+
+/*
+ * Complete a pending on-node request, if any.  Returns the first error:
+ * ret if it is already one, the error of the request otherwise.
+ */
+static inline int mca_coll_hier_wait(ompi_request_t **request, int ret)
+{
+    if (MPI_REQUEST_NULL != *request) {
+        int err = ompi_request_wait(request, MPI_STATUS_IGNORE);
+        *request = MPI_REQUEST_NULL;
+        if (OMPI_SUCCESS == ret) {
+            ret = err;
+        }
+    }
+    return ret;
+}
+
+END_C_DECLS
+
+#endif /* MCA_COLL_HIER_EXPORT_H */
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "coll_hier.h"
+
+
+/*
+ *	allgather
+ *
+ *	Function:	- allgatherv with equal blocks in rank order
+ *	Accepts:	- same as MPI_Allgather()
+ *	Returns:	- MPI_SUCCESS or error code
+ */
+int mca_coll_hier_allgather(const void *sbuf, int scount,
+                            struct ompi_datatype_t *sdtype,
+                            void *rbuf, int rcount,
+                            struct ompi_datatype_t *rdtype,
+                            struct ompi_communicator_t *comm,
+                            mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+    int i, ret, size, *rcounts;
+
+    if (!mca_coll_hier_use(m, comm) || 0 == rcount) {
+        return m->c_coll.coll_allgather(sbuf, scount, sdtype, rbuf, rcount,
+                                        rdtype, comm,
+                                        m->c_coll.coll_allgather_module);
+    }
+
+    size = ompi_comm_size(comm);
+    rcounts = (int*) malloc(2 * size * sizeof(int));
+    if (NULL == rcounts) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    for (i = 0; i < size; ++i) {
+        rcounts[i] = rcount;
+        rcounts[size + i] = i * rcount;
+    }
+
+    ret = mca_coll_hier_allgatherv_nodes(sbuf, scount, sdtype, rbuf, rcounts,
+                                         rcounts + size, rdtype, comm, m);
+
+    free(rcounts);
+    return ret;
+}
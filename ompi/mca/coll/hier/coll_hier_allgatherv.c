@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/mca/coll/base/coll_tags.h"
+#include "ompi/mca/pml/pml.h"
+#include "coll_hier.h"
+
+
+/*
+ *	allgatherv
+ *
+ *	Function:	- on-node gatherv to the leaders, allgatherv
+ *			  between the leaders, then on-node bcast
+ *	Accepts:	- same as MPI_Allgatherv()
+ *	Returns:	- MPI_SUCCESS or error code
+ */
+int mca_coll_hier_allgatherv(const void *sbuf, int scount,
+                             struct ompi_datatype_t *sdtype,
+                             void *rbuf, const int *rcounts, const int *disps,
+                             struct ompi_datatype_t *rdtype,
+                             struct ompi_communicator_t *comm,
+                             mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+
+    if (!mca_coll_hier_use(m, comm)) {
+        return m->c_coll.coll_allgatherv(sbuf, scount, sdtype, rbuf, rcounts,
+                                         disps, rdtype, comm,
+                                         m->c_coll.coll_allgatherv_module);
+    }
+
+    return mca_coll_hier_allgatherv_nodes(sbuf, scount, sdtype, rbuf, rcounts,
+                                          disps, rdtype, comm, m);
+}
+
+/*
+ * Exchange of the node blocks between the leaders and on-node bcast,
+ * pipelined: the leaders pass the blocks of the nodes around a ring in
+ * segments of seg_count elements, and start the on-node bcast of a
+ * segment as soon as it arrives, while the next ones are exchanged.
+ * The processes of a node start the same bcasts in the same order:
+ * the blocks of their node, then the ones received at each step of the
+ * ring.
+ */
+static int hier_allgatherv_pipelined(mca_coll_hier_module_t *m, char *all_blocks,
+                                     const int *node_counts, const int *node_offsets,
+                                     struct ompi_datatype_t *rdtype, ptrdiff_t extent,
+                                     int seg_count)
+{
+    struct ompi_communicator_t *local_comm = m->local_comm;
+    int ret = OMPI_SUCCESS, err, nodes = m->num_nodes, me = m->my_node;
+    int left = (me + nodes - 1) % nodes, right = (me + 1) % nodes;
+    int step, seg, node, num_segs, max_segs = 0, nbcasts = 0, nrecvs = 0, nsends = 0;
+    ompi_request_t **bcasts, **recvs, **sends;
+
+    for (node = 0; node < nodes; ++node) {
+        num_segs = (node_counts[node] + seg_count - 1) / seg_count;
+        nbcasts += num_segs;
+        max_segs = (num_segs > max_segs) ? num_segs : max_segs;
+    }
+    bcasts = (ompi_request_t**) malloc((nbcasts + 2 * max_segs) * sizeof(ompi_request_t*));
+    if (NULL == bcasts) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    recvs = bcasts + nbcasts;
+    sends = recvs + max_segs;
+    nbcasts = 0;
+
+    /* Step -1 is my own node, the leader already has its blocks */
+    for (step = -1; step < nodes - 1 && OMPI_SUCCESS == ret; ++step) {
+        int rnode = (me - step - 1 + nodes) % nodes, snode = (me - step + nodes) % nodes;
+        bool exchange = (0 <= step && NULL != m->leader_comm);
+
+        nrecvs = nsends = 0;
+        num_segs = (node_counts[rnode] + seg_count - 1) / seg_count;
+        for (seg = 0; exchange && seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+            int n = (seg == num_segs - 1) ? node_counts[rnode] - seg * seg_count : seg_count;
+
+            ret = MCA_PML_CALL(irecv(all_blocks + (ptrdiff_t) (node_offsets[rnode] +
+                                                               seg * seg_count) * extent,
+                                     n, rdtype, left, MCA_COLL_BASE_TAG_ALLGATHERV,
+                                     m->leader_comm, &recvs[nrecvs]));
+            nrecvs += (OMPI_SUCCESS == ret);
+        }
+        for (seg = 0; exchange && seg * seg_count < node_counts[snode] && OMPI_SUCCESS == ret; ++seg) {
+            int n = (node_counts[snode] - seg * seg_count < seg_count) ?
+                node_counts[snode] - seg * seg_count : seg_count;
+
+            ret = MCA_PML_CALL(isend(all_blocks + (ptrdiff_t) (node_offsets[snode] +
+                                                               seg * seg_count) * extent,
+                                     n, rdtype, right, MCA_COLL_BASE_TAG_ALLGATHERV,
+                                     MCA_PML_BASE_SEND_STANDARD, m->leader_comm,
+                                     &sends[nsends]));
+            nsends += (OMPI_SUCCESS == ret);
+        }
+
+        for (seg = 0; seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+            int n = (seg == num_segs - 1) ? node_counts[rnode] - seg * seg_count : seg_count;
+
+            if (exchange) {
+                ret = ompi_request_wait(&recvs[seg], MPI_STATUS_IGNORE);
+                if (OMPI_SUCCESS != ret) {
+                    break;
+                }
+            }
+            ret = local_comm->c_coll->coll_ibcast(all_blocks + (ptrdiff_t) (node_offsets[rnode] +
+                                                                            seg * seg_count) * extent,
+                                                  n, rdtype, 0, local_comm, &bcasts[nbcasts],
+                                                  local_comm->c_coll->coll_ibcast_module);
+            nbcasts += (OMPI_SUCCESS == ret);
+        }
+        if (OMPI_SUCCESS == ret) {
+            ret = ompi_request_wait_all(nsends, sends, MPI_STATUSES_IGNORE);
+        }
+    }
+    if (OMPI_SUCCESS != ret) {
+        ompi_coll_base_free_reqs(recvs, nrecvs);
+        ompi_coll_base_free_reqs(sends, nsends);
+    }
+
+    err = ompi_request_wait_all(nbcasts, bcasts, MPI_STATUSES_IGNORE);
+    if (OMPI_SUCCESS == ret) {
+        ret = err;
+    }
+    free(bcasts);
+    return ret;
+}
+
+/*
+ * The blocks are gathered in node order: each leader gathers the
+ * blocks of its node, the leaders exchange the blocks of their nodes,
+ * and each leader broadcasts all the blocks on its node.  When the
+ * nodes hold consecutive ranks and the blocks are contiguous in rbuf,
+ * node order is rank order and everything happens in rbuf; otherwise
+ * the blocks go through a temporary buffer and are copied to rbuf at
+ * the end.  When the blocks add up to more than coll_hier_segsize and
+ * the on-node communicator has a non-blocking bcast, the exchange
+ * between the leaders and the on-node bcast are pipelined.
+ */
+int mca_coll_hier_allgatherv_nodes(const void *sbuf, int scount,
+                                   struct ompi_datatype_t *sdtype,
+                                   void *rbuf, const int *rcounts, const int *disps,
+                                   struct ompi_datatype_t *rdtype,
+                                   struct ompi_communicator_t *comm,
+                                   mca_coll_hier_module_t *m)
+{
+    struct ompi_communicator_t *local_comm = m->local_comm;
+    int i, ret, rank, size, local_size, total, node, first, seg_count;
+    int *offsets = NULL, *local_counts = NULL, *local_disps = NULL;
+    int *node_counts = NULL, *node_offsets = NULL;
+    char *free_buffer = NULL, *all_blocks;
+    ptrdiff_t lb, extent, gap;
+    bool in_rbuf;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+    local_size = m->node_sizes[m->my_node];
+    first = m->node_disps[m->my_node];
+
+    /* Offset (in elements of rdtype) of each block in node order */
+    offsets = (int*) malloc((size + 2 * local_size + 2 * m->num_nodes) * sizeof(int));
+    if (NULL == offsets) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    local_counts = offsets + size;
+    local_disps = local_counts + local_size;
+    node_counts = local_disps + local_size;
+    node_offsets = node_counts + m->num_nodes;
+
+    in_rbuf = m->is_block;
+    for (i = 0, total = 0; i < size; ++i) {
+        offsets[i] = total;
+        total += rcounts[m->ranks_by_node[i]];
+        if (disps[m->ranks_by_node[i]] != offsets[i]) {
+            in_rbuf = false;
+        }
+    }
+    if (0 == total) {
+        free(offsets);
+        return OMPI_SUCCESS;
+    }
+
+    for (i = 0; i < local_size; ++i) {
+        local_counts[i] = rcounts[m->ranks_by_node[first + i]];
+        local_disps[i] = offsets[first + i] - offsets[first];
+    }
+    for (node = 0; node < m->num_nodes; ++node) {
+        node_offsets[node] = offsets[m->node_disps[node]];
+        node_counts[node] = ((node == m->num_nodes - 1) ? total :
+                             offsets[m->node_disps[node + 1]]) - node_offsets[node];
+    }
+
+    ompi_datatype_get_extent(rdtype, &lb, &extent);
+    if (in_rbuf) {
+        all_blocks = (char*) rbuf;
+    } else {
+        free_buffer = (char*) malloc(opal_datatype_span(&rdtype->super, total, &gap));
+        if (NULL == free_buffer) {
+            free(offsets);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        all_blocks = free_buffer - gap;
+    }
+
+    /* With MPI_IN_PLACE my block is in rbuf, and already at its place
+       in node order if the blocks are gathered in rbuf */
+    if (MPI_IN_PLACE == sbuf && !(in_rbuf && NULL != m->leader_comm)) {
+        sbuf = (char*) rbuf + (ptrdiff_t) disps[rank] * extent;
+        scount = rcounts[rank];
+        sdtype = rdtype;
+    }
+
+    ret = local_comm->c_coll->coll_gatherv(sbuf, scount, sdtype,
+                                           all_blocks + (ptrdiff_t) offsets[first] * extent,
+                                           local_counts, local_disps, rdtype, 0,
+                                           local_comm,
+                                           local_comm->c_coll->coll_gatherv_module);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+
+    seg_count = mca_coll_hier_segment_count(rdtype, total);
+    if (seg_count < total && NULL != local_comm->c_coll->coll_ibcast) {
+        ret = hier_allgatherv_pipelined(m, all_blocks, node_counts, node_offsets,
+                                        rdtype, extent, seg_count);
+    } else {
+        if (NULL != m->leader_comm) {
+            ret = ompi_coll_base_allgatherv_intra_ring(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+                                                       all_blocks, node_counts, node_offsets,
+                                                       rdtype, m->leader_comm,
+                                                       m->leader_module);
+            if (OMPI_SUCCESS != ret) {
+                goto exit;
+            }
+        }
+
+        ret = local_comm->c_coll->coll_bcast(all_blocks, total, rdtype, 0, local_comm,
+                                             local_comm->c_coll->coll_bcast_module);
+    }
+    if (OMPI_SUCCESS != ret || in_rbuf) {
+        goto exit;
+    }
+
+    /* Copy the blocks from node order to their place in rbuf */
+    for (i = 0; i < size; ++i) {
+        int peer = m->ranks_by_node[i];
+
+        ret = ompi_datatype_copy_content_same_ddt(rdtype, rcounts[peer],
+                                                  (char*) rbuf + (ptrdiff_t) disps[peer] * extent,
+                                                  all_blocks + (ptrdiff_t) offsets[i] * extent);
+        if (OMPI_SUCCESS != ret) {
+            break;
+        }
+    }
+
+ exit:
+    free(free_buffer);
+    free(offsets);
+    return ret;
+}
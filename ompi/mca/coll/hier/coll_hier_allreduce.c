@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/op/op.h"
+#include "coll_hier.h"
+
+
+/*
+ *	allreduce
+ *
+ *	Function:	- on-node reduce to the leaders, allreduce
+ *			  between the leaders, then on-node bcast
+ *	Accepts:	- same as MPI_Allreduce()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ * The order of the operands changes, so non-commutative operations go
+ * to the prior layer.  Large messages are cut in segments: the on-node
+ * reduce of the next segment and the on-node bcast of the previous one
+ * run while the leaders exchange the current one.  All the processes
+ * of a node post the on-node operations in the same order: reduce of
+ * segment 0, then reduce of segment k + 1 and bcast of segment k.
+ */
+int mca_coll_hier_allreduce(const void *sbuf, void *rbuf, int count,
+                            struct ompi_datatype_t *dtype,
+                            struct ompi_op_t *op,
+                            struct ompi_communicator_t *comm,
+                            mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+    struct ompi_communicator_t *local_comm;
+    ompi_request_t *reduce_req = MPI_REQUEST_NULL, *bcast_req = MPI_REQUEST_NULL;
+    int ret = OMPI_SUCCESS, seg, num_segs, seg_count;
+    bool pipelined, leader;
+    ptrdiff_t lb, extent;
+
+    if (!mca_coll_hier_use(m, comm) || !ompi_op_is_commute(op) || 0 == count) {
+        return m->c_coll.coll_allreduce(sbuf, rbuf, count, dtype, op, comm,
+                                        m->c_coll.coll_allreduce_module);
+    }
+
+    local_comm = m->local_comm;
+    leader = (NULL != m->leader_comm);
+
+    ompi_datatype_get_extent(dtype, &lb, &extent);
+    seg_count = mca_coll_hier_segment_count(dtype, count);
+    pipelined = (seg_count < count &&
+                 NULL != local_comm->c_coll->coll_ireduce &&
+                 NULL != local_comm->c_coll->coll_ibcast);
+    if (!pipelined) {
+        seg_count = count;
+    }
+    num_segs = (count + seg_count - 1) / seg_count;
+
+    /* Only the leader receives the on-node reduce, the contribution of
+       the others is in rbuf with MPI_IN_PLACE */
+    if (MPI_IN_PLACE == sbuf && !leader) {
+        sbuf = rbuf;
+    }
+
+    for (seg = 0; seg <= num_segs && OMPI_SUCCESS == ret; ++seg) {
+        ptrdiff_t offset = (ptrdiff_t) seg * seg_count * extent;
+
+        /* The reduce of segment seg - 1 is complete */
+        ret = mca_coll_hier_wait(&reduce_req, ret);
+        ret = mca_coll_hier_wait(&bcast_req, ret);
+        if (OMPI_SUCCESS != ret) {
+            break;
+        }
+
+        /* Reduce of segment seg on my node (segment 0 is posted alone
+           in the first iteration) */
+        if (seg < num_segs) {
+            int n = (seg == num_segs - 1) ? count - seg * seg_count : seg_count;
+            const void *lsbuf = (MPI_IN_PLACE == sbuf) ? MPI_IN_PLACE :
+                (const char*) sbuf + offset;
+
+            if (pipelined) {
+                ret = local_comm->c_coll->coll_ireduce(lsbuf, leader ? (char*) rbuf + offset : NULL,
+                                                       n, dtype, op, 0, local_comm, &reduce_req,
+                                                       local_comm->c_coll->coll_ireduce_module);
+            } else {
+                ret = local_comm->c_coll->coll_reduce(lsbuf, leader ? (char*) rbuf + offset : NULL,
+                                                      n, dtype, op, 0, local_comm,
+                                                      local_comm->c_coll->coll_reduce_module);
+            }
+            if (OMPI_SUCCESS != ret) {
+                break;
+            }
+        }
+        if (0 == seg) {
+            continue;
+        }
+
+        /* Allreduce of segment seg - 1 between the leaders, then bcast
+           on my node */
+        {
+            int n = (seg == num_segs) ? count - (seg - 1) * seg_count : seg_count;
+            char *ptr = (char*) rbuf + offset - (ptrdiff_t) seg_count * extent;
+
+            if (leader) {
+                ret = ompi_coll_base_allreduce_intra_recursivedoubling(MPI_IN_PLACE, ptr, n,
+                                                                       dtype, op,
+                                                                       m->leader_comm,
+                                                                       m->leader_module);
+                if (OMPI_SUCCESS != ret) {
+                    break;
+                }
+            }
+            if (pipelined) {
+                ret = local_comm->c_coll->coll_ibcast(ptr, n, dtype, 0, local_comm,
+                                                      &bcast_req,
+                                                      local_comm->c_coll->coll_ibcast_module);
+            } else {
+                ret = local_comm->c_coll->coll_bcast(ptr, n, dtype, 0, local_comm,
+                                                     local_comm->c_coll->coll_bcast_module);
+            }
+        }
+    }
+    ret = mca_coll_hier_wait(&reduce_req, ret);
+    ret = mca_coll_hier_wait(&bcast_req, ret);
+
+    return ret;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "coll_hier.h"
+
+
+/*
+ * On-node bcast of a segment, non-blocking if the collective is
+ * pipelined
+ */
+static inline int hier_local_bcast(mca_coll_hier_module_t *m, void *buff,
+                                   int count, struct ompi_datatype_t *dtype,
+                                   int root, bool pipelined,
+                                   ompi_request_t **request)
+{
+    struct ompi_communicator_t *local_comm = m->local_comm;
+
+    if (pipelined) {
+        return local_comm->c_coll->coll_ibcast(buff, count, dtype, root,
+                                               local_comm, request,
+                                               local_comm->c_coll->coll_ibcast_module);
+    }
+    *request = MPI_REQUEST_NULL;
+    return local_comm->c_coll->coll_bcast(buff, count, dtype, root, local_comm,
+                                          local_comm->c_coll->coll_bcast_module);
+}
+
+/*
+ *	bcast
+ *
+ *	Function:	- on-node bcast on the node of the root, bcast
+ *			  between the leaders, then on-node bcast on the
+ *			  other nodes
+ *	Accepts:	- same as MPI_Bcast()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ * Large messages are cut in segments: a leader forwards a segment on
+ * the other side while the previous (or next) one moves on its node.
+ */
+int mca_coll_hier_bcast(void *buff, int count,
+                        struct ompi_datatype_t *datatype,
+                        int root,
+                        struct ompi_communicator_t *comm,
+                        mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+    ompi_request_t *request = MPI_REQUEST_NULL;
+    int ret = OMPI_SUCCESS, seg, num_segs, seg_count, local_root, root_node;
+    bool pipelined, root_node_first;
+    ptrdiff_t lb, extent;
+
+    if (!mca_coll_hier_use(m, comm) || 0 == count) {
+        return m->c_coll.coll_bcast(buff, count, datatype, root, comm,
+                                    m->c_coll.coll_bcast_module);
+    }
+
+    ompi_datatype_get_extent(datatype, &lb, &extent);
+    seg_count = mca_coll_hier_segment_count(datatype, count);
+    pipelined = (seg_count < count &&
+                 NULL != m->local_comm->c_coll->coll_ibcast);
+    if (!pipelined) {
+        seg_count = count;
+    }
+    num_segs = (count + seg_count - 1) / seg_count;
+
+    root_node = m->node_of[root];
+    local_root = (root_node == m->my_node) ? m->local_rank_of[root] : 0;
+
+    /* The data enters the leader communicator from the node of the
+       root, through its leader.  If the root is not the leader, the
+       on-node phase comes first on its node. */
+    root_node_first = (0 != local_root);
+
+    if (NULL == m->leader_comm) {
+        /* Not a leader: the on-node phase only */
+        for (seg = 0; seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+            int n = (seg == num_segs - 1) ? count - seg * seg_count : seg_count;
+            ret = hier_local_bcast(m, (char*) buff + (ptrdiff_t) seg * seg_count * extent,
+                                   n, datatype, local_root, pipelined, &request);
+            ret = mca_coll_hier_wait(&request, ret);
+        }
+        return ret;
+    }
+
+    if (root_node_first) {
+        /* Leader of the node of a non-leader root: start the on-node
+           phase of the next segment before forwarding the current one
+           to the other leaders */
+        ret = hier_local_bcast(m, buff, (1 == num_segs) ? count : seg_count,
+                               datatype, local_root, pipelined, &request);
+        for (seg = 0; seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+            int n = (seg == num_segs - 1) ? count - seg * seg_count : seg_count;
+            char *ptr = (char*) buff + (ptrdiff_t) seg * seg_count * extent;
+
+            ret = mca_coll_hier_wait(&request, ret);
+            if (OMPI_SUCCESS != ret) {
+                break;
+            }
+            if (seg + 1 < num_segs) {
+                int next = (seg + 1 == num_segs - 1) ? count - (seg + 1) * seg_count : seg_count;
+                ret = hier_local_bcast(m, ptr + (ptrdiff_t) seg_count * extent, next,
+                                       datatype, local_root, pipelined, &request);
+                if (OMPI_SUCCESS != ret) {
+                    break;
+                }
+            }
+            ret = ompi_coll_base_bcast_intra_binomial(ptr, n, datatype, root_node,
+                                                      m->leader_comm,
+                                                      m->leader_module, 0);
+        }
+    } else {
+        /* Get a segment from the other leaders, then pass it on my
+           node while getting the next one */
+        for (seg = 0; seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+            int n = (seg == num_segs - 1) ? count - seg * seg_count : seg_count;
+            char *ptr = (char*) buff + (ptrdiff_t) seg * seg_count * extent;
+
+            ret = ompi_coll_base_bcast_intra_binomial(ptr, n, datatype, root_node,
+                                                      m->leader_comm,
+                                                      m->leader_module, 0);
+            ret = mca_coll_hier_wait(&request, ret);
+            if (OMPI_SUCCESS == ret) {
+                ret = hier_local_bcast(m, ptr, n, datatype, 0, pipelined, &request);
+            }
+        }
+    }
+    ret = mca_coll_hier_wait(&request, ret);
+
+    return ret;
+}
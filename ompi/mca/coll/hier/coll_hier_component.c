@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "coll_hier.h"
+
+/*
+ * Public string showing the coll ompi_hier component version number
+ */
+const char *mca_coll_hier_component_version_string =
+    "Open MPI hier collective MCA component version " OMPI_VERSION;
+
+/*
+ * Local function
+ */
+static int hier_register(void);
+
+/*
+ * Instantiate the public struct with all of our public information
+ * and pointers to our public functions in it
+ */
+
+mca_coll_hier_component_t mca_coll_hier_component = {
+    {
+        /* First, the mca_component_t struct containing meta information
+         * about the component itself */
+
+        .collm_version = {
+            MCA_COLL_BASE_VERSION_2_0_0,
+
+            /* Component name and version */
+            .mca_component_name = "hier",
+            MCA_BASE_MAKE_VERSION(component, OMPI_MAJOR_VERSION, OMPI_MINOR_VERSION,
+                                  OMPI_RELEASE_VERSION),
+
+            /* Component open and close functions */
+            .mca_register_component_params = hier_register
+        },
+        .collm_data = {
+            /* The component is not checkpoint ready */
+            MCA_BASE_METADATA_PARAM_NONE
+        },
+
+        /* Initialization / querying functions */
+
+        .collm_init_query = mca_coll_hier_init_query,
+        .collm_comm_query = mca_coll_hier_comm_query
+    },
+};
+
+
+static int hier_register(void)
+{
+    mca_base_component_t *c = &mca_coll_hier_component.super.collm_version;
+
+    mca_coll_hier_component.priority = 0;
+    (void) mca_base_component_var_register(c, "priority",
+                                           "Priority of the hier coll component (only used on communicators spanning several nodes)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_coll_hier_component.priority);
+
+    mca_coll_hier_component.segsize = 65536;
+    (void) mca_base_component_var_register(c, "segsize",
+                                           "Size (in bytes) of the segments of bcast, reduce and allreduce above which the on-node and inter-node phases are pipelined (0 = no pipelining)",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &mca_coll_hier_component.segsize);
+
+    return OMPI_SUCCESS;
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/mca/coll/base/coll_tags.h"
+#include "ompi/mca/pml/pml.h"
+#include "coll_hier.h"
+
+
+/*
+ * Leader of a node other than the one of the root, when the blocks of
+ * the node span several segments: receive the blocks of the other
+ * processes of the node, and send each segment to the leader of the
+ * node of the root as soon as its blocks are in, while the next ones
+ * arrive.
+ */
+static int hier_gather_pipelined(mca_coll_hier_module_t *m, const void *sbuf,
+                                 int scount, struct ompi_datatype_t *sdtype,
+                                 char *blocks, int ucount,
+                                 struct ompi_datatype_t *udtype, ptrdiff_t uextent,
+                                 int root_node, int seg_blocks)
+{
+    int i, ret, nblocks = m->node_sizes[m->my_node];
+    ompi_request_t **reqs;
+
+    reqs = ompi_coll_base_comm_get_reqs(m->leader_module->base_data, nblocks);
+    if (NULL == reqs) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    reqs[0] = MPI_REQUEST_NULL;
+    for (i = 1; i < nblocks; ++i) {
+        ret = MCA_PML_CALL(irecv(blocks + (ptrdiff_t) i * ucount * uextent, ucount,
+                                 udtype, i, MCA_COLL_BASE_TAG_GATHER, m->local_comm,
+                                 &reqs[i]));
+        if (OMPI_SUCCESS != ret) {
+            ompi_coll_base_free_reqs(reqs, i);
+            return ret;
+        }
+    }
+    ret = ompi_datatype_sndrcv(sbuf, scount, sdtype, blocks, ucount, udtype);
+
+    for (i = 0; i < nblocks && OMPI_SUCCESS == ret; i += seg_blocks) {
+        int n = (nblocks - i < seg_blocks) ? nblocks - i : seg_blocks;
+
+        ret = ompi_request_wait_all(n, reqs + i, MPI_STATUSES_IGNORE);
+        if (OMPI_SUCCESS == ret) {
+            ret = MCA_PML_CALL(send(blocks + (ptrdiff_t) i * ucount * uextent,
+                                    n * ucount, udtype, root_node,
+                                    MCA_COLL_BASE_TAG_GATHER,
+                                    MCA_PML_BASE_SEND_STANDARD, m->leader_comm));
+        }
+    }
+    if (OMPI_SUCCESS != ret) {
+        ompi_coll_base_free_reqs(reqs, nblocks);
+    }
+    return ret;
+}
+
+/*
+ *	gather
+ *
+ *	Function:	- on-node gather to the leaders, linear gather
+ *			  of the node blocks to the leader of the node
+ *			  of the root, then send to the root if it is not
+ *			  the leader
+ *	Accepts:	- same as MPI_Gather()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ * The blocks travel in node order.  The root receives them directly in
+ * rbuf when the nodes hold consecutive ranks, they are reordered
+ * through a temporary buffer otherwise.  The processes other than the
+ * root only know scount and sdtype, so the leaders use them for the
+ * blocks they hold (and the root rcount and rdtype).
+ *
+ * The blocks of a node larger than coll_hier_segsize go to the leader
+ * of the node of the root in segments of whole blocks.  The leaders of
+ * the other nodes then receive the blocks of their node point to point
+ * instead of the on-node gather, and forward a segment while the
+ * blocks of the next ones arrive.  The leader of the node of the root
+ * posts all the receives before gathering its own node.
+ */
+int mca_coll_hier_gather(const void *sbuf, int scount,
+                         struct ompi_datatype_t *sdtype,
+                         void *rbuf, int rcount,
+                         struct ompi_datatype_t *rdtype,
+                         int root,
+                         struct ompi_communicator_t *comm,
+                         mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+    struct ompi_datatype_t *udtype;
+    ompi_request_t **reqs = NULL;
+    int i, ret = OMPI_SUCCESS, rank, size, ucount, root_node, nblocks, node;
+    int seg, seg_blocks, nreqs = 0;
+    bool in_place = (MPI_IN_PLACE == sbuf);
+    char *free_buffer = NULL, *blocks;
+    ptrdiff_t lb, uextent, gap;
+
+    rank = ompi_comm_rank(comm);
+
+    /* Count and datatype of a block on this process */
+    ucount = (rank == root) ? rcount : scount;
+    udtype = (rank == root) ? rdtype : sdtype;
+
+    if (!mca_coll_hier_use(m, comm) || 0 == ucount) {
+        return m->c_coll.coll_gather(sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                     root, comm, m->c_coll.coll_gather_module);
+    }
+
+    size = ompi_comm_size(comm);
+    root_node = m->node_of[root];
+    ompi_datatype_get_extent(udtype, &lb, &uextent);
+    seg_blocks = mca_coll_hier_segment_blocks(udtype, ucount);
+
+    /* The contribution of the root is in rbuf with MPI_IN_PLACE */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = (char*) rbuf + (ptrdiff_t) rank * rcount * uextent;
+        scount = rcount;
+        sdtype = rdtype;
+    }
+
+    if (NULL == m->leader_comm) {
+        if (m->my_node != root_node &&
+            1 < mca_coll_hier_node_segs(m, m->my_node, seg_blocks)) {
+            /* My leader receives the blocks of the node one by one */
+            return MCA_PML_CALL(send(sbuf, scount, sdtype, 0, MCA_COLL_BASE_TAG_GATHER,
+                                     MCA_PML_BASE_SEND_STANDARD, m->local_comm));
+        }
+        ret = m->local_comm->c_coll->coll_gather(sbuf, scount, sdtype, NULL, 0,
+                                                 MPI_DATATYPE_NULL, 0, m->local_comm,
+                                                 m->local_comm->c_coll->coll_gather_module);
+        if (OMPI_SUCCESS != ret || rank != root) {
+            return ret;
+        }
+
+        /* I am the root: my leader sends me all the blocks */
+        if (m->is_block) {
+            return MCA_PML_CALL(recv(rbuf, size * rcount, rdtype, 0,
+                                     MCA_COLL_BASE_TAG_GATHER, m->local_comm,
+                                     MPI_STATUS_IGNORE));
+        }
+        nblocks = size;
+    } else {
+        nblocks = (m->my_node == root_node) ? size : m->node_sizes[m->my_node];
+    }
+
+    /* Buffer of the blocks in node order */
+    if (rank == root && m->is_block) {
+        blocks = (char*) rbuf;
+    } else {
+        free_buffer = (char*) malloc(opal_datatype_span(&udtype->super,
+                                                        (size_t) nblocks * ucount,
+                                                        &gap));
+        if (NULL == free_buffer) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        blocks = free_buffer - gap;
+    }
+
+    if (NULL == m->leader_comm) {
+        ret = MCA_PML_CALL(recv(blocks, size * ucount, udtype, 0,
+                                MCA_COLL_BASE_TAG_GATHER, m->local_comm,
+                                MPI_STATUS_IGNORE));
+        goto reorder;
+    }
+
+    if (m->my_node != root_node &&
+        1 < mca_coll_hier_node_segs(m, m->my_node, seg_blocks)) {
+        ret = hier_gather_pipelined(m, sbuf, scount, sdtype, blocks, ucount, udtype,
+                                    uextent, root_node, seg_blocks);
+        goto exit;
+    }
+
+    /* Leader of the node of the root: post the receives of the blocks
+       of the other nodes, by segment */
+    if (m->my_node == root_node) {
+        for (nreqs = 0, node = 0; node < m->num_nodes; ++node) {
+            nreqs += (node == root_node) ? 0 : mca_coll_hier_node_segs(m, node, seg_blocks);
+        }
+        reqs = ompi_coll_base_comm_get_reqs(m->leader_module->base_data, nreqs);
+        if (NULL == reqs) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        for (nreqs = 0, node = 0; node < m->num_nodes; ++node) {
+            int num_segs = mca_coll_hier_node_segs(m, node, seg_blocks);
+            int per_seg = (1 == num_segs) ? m->node_sizes[node] : seg_blocks;
+
+            for (seg = 0; node != root_node && seg < num_segs; ++seg) {
+                int first = seg * per_seg;
+                int n = (m->node_sizes[node] - first < per_seg) ?
+                    m->node_sizes[node] - first : per_seg;
+
+                ret = MCA_PML_CALL(irecv(blocks + (ptrdiff_t) (m->node_disps[node] + first) *
+                                         ucount * uextent,
+                                         n * ucount, udtype, node,
+                                         MCA_COLL_BASE_TAG_GATHER, m->leader_comm,
+                                         &reqs[nreqs]));
+                if (OMPI_SUCCESS != ret) {
+                    ompi_coll_base_free_reqs(reqs, nreqs);
+                    goto exit;
+                }
+                ++nreqs;
+            }
+        }
+    }
+
+    /* Gather the blocks of my node.  A root leader gathers in place in
+       rbuf, its own block is then at rank in rbuf */
+    if (rank == root && m->is_block && !in_place) {
+        ret = ompi_datatype_sndrcv(sbuf, scount, sdtype,
+                                   (char*) rbuf + (ptrdiff_t) rank * rcount * uextent,
+                                   rcount, rdtype);
+    }
+    if (OMPI_SUCCESS == ret) {
+        ret = m->local_comm->c_coll->coll_gather((rank == root && m->is_block) ? MPI_IN_PLACE : sbuf,
+                                                 scount, sdtype,
+                                                 blocks + (ptrdiff_t) ((m->my_node == root_node) ?
+                                                                       m->node_disps[m->my_node] : 0) *
+                                                 ucount * uextent,
+                                                 ucount, udtype, 0, m->local_comm,
+                                                 m->local_comm->c_coll->coll_gather_module);
+    }
+
+    if (m->my_node != root_node) {
+        if (OMPI_SUCCESS == ret) {
+            ret = MCA_PML_CALL(send(blocks, nblocks * ucount, udtype, root_node,
+                                    MCA_COLL_BASE_TAG_GATHER,
+                                    MCA_PML_BASE_SEND_STANDARD, m->leader_comm));
+        }
+        goto exit;
+    }
+
+    if (OMPI_SUCCESS != ret) {
+        ompi_coll_base_free_reqs(reqs, nreqs);
+        goto exit;
+    }
+    ret = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+
+    if (rank != root) {
+        ret = MCA_PML_CALL(send(blocks, size * ucount, udtype, m->local_rank_of[root],
+                                MCA_COLL_BASE_TAG_GATHER,
+                                MCA_PML_BASE_SEND_STANDARD, m->local_comm));
+        goto exit;
+    }
+
+ reorder:
+    /* I am the root: copy the blocks from node order to rank order */
+    for (i = 0; OMPI_SUCCESS == ret && blocks != (char*) rbuf && i < size; ++i) {
+        ret = ompi_datatype_copy_content_same_ddt(rdtype, rcount,
+                                                  (char*) rbuf + (ptrdiff_t) m->ranks_by_node[i] *
+                                                  rcount * uextent,
+                                                  blocks + (ptrdiff_t) i * rcount * uextent);
+    }
+
+ exit:
+    free(free_buffer);
+    return ret;
+}
@@ -0,0 +1,322 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+
+#include "opal/util/output.h"
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/group/group.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/mca/coll/base/base.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "coll_hier.h"
+
+
+static void mca_coll_hier_module_construct(mca_coll_hier_module_t *module)
+{
+    memset(&(module->c_coll), 0, sizeof(module->c_coll));
+    module->enabled = false;
+    module->in_setup = false;
+    module->flat = false;
+    module->local_comm = NULL;
+    module->leader_comm = NULL;
+    module->leader_module = NULL;
+    module->num_nodes = 0;
+    module->my_node = 0;
+    module->node_of = NULL;
+    module->local_rank_of = NULL;
+    module->node_sizes = NULL;
+    module->node_disps = NULL;
+    module->ranks_by_node = NULL;
+    module->is_block = false;
+}
+
+static void mca_coll_hier_module_destruct(mca_coll_hier_module_t *module)
+{
+    if (NULL != module->local_comm) {
+        ompi_comm_free(&module->local_comm);
+    }
+    if (NULL != module->leader_comm) {
+        ompi_comm_free(&module->leader_comm);
+    }
+    if (NULL != module->leader_module) {
+        OBJ_RELEASE(module->leader_module);
+    }
+    free(module->node_of);
+    free(module->local_rank_of);
+    free(module->node_sizes);
+    free(module->node_disps);
+    free(module->ranks_by_node);
+
+    /* The prior layer was saved (and retained) in module_enable */
+    if (NULL != module->c_coll.coll_bcast_module) {
+        OBJ_RELEASE(module->c_coll.coll_allgather_module);
+        OBJ_RELEASE(module->c_coll.coll_allgatherv_module);
+        OBJ_RELEASE(module->c_coll.coll_allreduce_module);
+        OBJ_RELEASE(module->c_coll.coll_bcast_module);
+        OBJ_RELEASE(module->c_coll.coll_gather_module);
+        OBJ_RELEASE(module->c_coll.coll_reduce_module);
+        OBJ_RELEASE(module->c_coll.coll_scatter_module);
+    }
+}
+
+OBJ_CLASS_INSTANCE(mca_coll_hier_module_t, mca_coll_base_module_t,
+                   mca_coll_hier_module_construct,
+                   mca_coll_hier_module_destruct);
+
+
+/*
+ * Initial query function that is invoked during MPI_INIT, allowing
+ * this component to disqualify itself if it doesn't support the
+ * required level of thread support.
+ */
+int mca_coll_hier_init_query(bool enable_progress_threads,
+                             bool enable_mpi_threads)
+{
+    /* Nothing to do */
+    return OMPI_SUCCESS;
+}
+
+
+/*
+ * Invoked when there's a new communicator that has been created.
+ * Look at the communicator and decide which set of functions and
+ * priority we want to return.
+ */
+mca_coll_base_module_t *
+mca_coll_hier_comm_query(struct ompi_communicator_t *comm,
+                         int *priority)
+{
+    mca_coll_hier_module_t *hier_module;
+
+    /* Only intracommunicators spanning several nodes.  Every process
+       has a remote peer if one of them has, so all the processes make
+       the same decision. */
+    if (OMPI_COMM_IS_INTER(comm) || ompi_comm_size(comm) < 2 ||
+        !ompi_group_have_remote_peers(comm->c_local_group)) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:comm_query (%d/%s): intercomm, comm is too small, or all peers local; disqualifying myself",
+                            comm->c_contextid, comm->c_name);
+        return NULL;
+    }
+
+    *priority = mca_coll_hier_component.priority;
+    if (mca_coll_hier_component.priority <= 0) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:comm_query (%d/%s): priority too low; disqualifying myself",
+                            comm->c_contextid, comm->c_name);
+        return NULL;
+    }
+
+    hier_module = OBJ_NEW(mca_coll_hier_module_t);
+    if (NULL == hier_module) {
+        return NULL;
+    }
+
+    hier_module->super.coll_module_enable = mca_coll_hier_module_enable;
+    hier_module->super.ft_event = mca_coll_hier_ft_event;
+
+    hier_module->super.coll_allgather  = mca_coll_hier_allgather;
+    hier_module->super.coll_allgatherv = mca_coll_hier_allgatherv;
+    hier_module->super.coll_allreduce  = mca_coll_hier_allreduce;
+    hier_module->super.coll_alltoall   = NULL;
+    hier_module->super.coll_alltoallv  = NULL;
+    hier_module->super.coll_alltoallw  = NULL;
+    hier_module->super.coll_barrier    = NULL;
+    hier_module->super.coll_bcast      = mca_coll_hier_bcast;
+    hier_module->super.coll_exscan     = NULL;
+    hier_module->super.coll_gather     = mca_coll_hier_gather;
+    hier_module->super.coll_gatherv    = NULL;
+    hier_module->super.coll_reduce     = mca_coll_hier_reduce;
+    hier_module->super.coll_reduce_scatter = NULL;
+    hier_module->super.coll_scan       = NULL;
+    hier_module->super.coll_scatter    = mca_coll_hier_scatter;
+    hier_module->super.coll_scatterv   = NULL;
+
+    return &(hier_module->super);
+}
+
+
+/*
+ * Init module on the communicator
+ */
+int mca_coll_hier_module_enable(mca_coll_base_module_t *module,
+                                struct ompi_communicator_t *comm)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+
+    /* Save the prior layer of coll functions: they are used while the
+       sub-communicators are set up and when they are useless */
+    if (NULL == comm->c_coll->coll_allgather_module ||
+        NULL == comm->c_coll->coll_allgatherv_module ||
+        NULL == comm->c_coll->coll_allreduce_module ||
+        NULL == comm->c_coll->coll_bcast_module ||
+        NULL == comm->c_coll->coll_gather_module ||
+        NULL == comm->c_coll->coll_reduce_module ||
+        NULL == comm->c_coll->coll_scatter_module) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:enable (%d/%s): missing underlying collective; disqualifying myself",
+                            comm->c_contextid, comm->c_name);
+        return OMPI_ERR_NOT_FOUND;
+    }
+    m->c_coll = *comm->c_coll;
+    OBJ_RETAIN(m->c_coll.coll_allgather_module);
+    OBJ_RETAIN(m->c_coll.coll_allgatherv_module);
+    OBJ_RETAIN(m->c_coll.coll_allreduce_module);
+    OBJ_RETAIN(m->c_coll.coll_bcast_module);
+    OBJ_RETAIN(m->c_coll.coll_gather_module);
+    OBJ_RETAIN(m->c_coll.coll_reduce_module);
+    OBJ_RETAIN(m->c_coll.coll_scatter_module);
+
+    /* We set up the sub-communicators lazily in
+       mca_coll_hier_lazy_enable() */
+    return OMPI_SUCCESS;
+}
+
+
+/*
+ * Split the communicator in node-local and leader communicators and
+ * exchange the node of every process.  The collectives issued on comm
+ * meanwhile go to the prior layer.
+ */
+int mca_coll_hier_lazy_enable(mca_coll_hier_module_t *m,
+                              struct ompi_communicator_t *comm)
+{
+    int i, ret, rank, size, local_rank, node, prev, info[2], *all_info = NULL;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    m->in_setup = true;
+
+    ret = ompi_comm_split_type(comm, MPI_COMM_TYPE_SHARED, 0, NULL,
+                               &m->local_comm);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+    local_rank = ompi_comm_rank(m->local_comm);
+
+    ret = ompi_comm_split(comm, (0 == local_rank) ? 0 : MPI_UNDEFINED, rank,
+                          &m->leader_comm, false);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+    if (MPI_COMM_NULL == m->leader_comm) {
+        m->leader_comm = NULL;
+    }
+
+    /* My node is the rank of my leader in the leader communicator */
+    if (NULL != m->leader_comm) {
+        m->my_node = ompi_comm_rank(m->leader_comm);
+    }
+    ret = m->local_comm->c_coll->coll_bcast(&m->my_node, 1, MPI_INT, 0,
+                                            m->local_comm,
+                                            m->local_comm->c_coll->coll_bcast_module);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+
+    all_info = (int*) malloc(2 * size * sizeof(int));
+    m->node_of = (int*) malloc(size * sizeof(int));
+    m->local_rank_of = (int*) malloc(size * sizeof(int));
+    m->ranks_by_node = (int*) malloc(size * sizeof(int));
+    if (NULL == all_info || NULL == m->node_of || NULL == m->local_rank_of ||
+        NULL == m->ranks_by_node) {
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    info[0] = m->my_node;
+    info[1] = local_rank;
+    ret = m->c_coll.coll_allgather(info, 2, MPI_INT, all_info, 2, MPI_INT,
+                                   comm, m->c_coll.coll_allgather_module);
+    if (OMPI_SUCCESS != ret) {
+        goto exit;
+    }
+
+    m->num_nodes = 0;
+    for (i = 0; i < size; ++i) {
+        m->node_of[i] = all_info[2 * i];
+        m->local_rank_of[i] = all_info[2 * i + 1];
+        if (m->node_of[i] >= m->num_nodes) {
+            m->num_nodes = m->node_of[i] + 1;
+        }
+    }
+
+    m->node_sizes = (int*) calloc(m->num_nodes, sizeof(int));
+    m->node_disps = (int*) malloc(m->num_nodes * sizeof(int));
+    if (NULL == m->node_sizes || NULL == m->node_disps) {
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    for (i = 0; i < size; ++i) {
+        ++m->node_sizes[m->node_of[i]];
+    }
+    for (node = 0, prev = 0; node < m->num_nodes; ++node) {
+        m->node_disps[node] = prev;
+        prev += m->node_sizes[node];
+    }
+
+    m->is_block = true;
+    for (i = 0; i < size; ++i) {
+        int index = m->node_disps[m->node_of[i]] + m->local_rank_of[i];
+        m->ranks_by_node[index] = i;
+        if (index != i) {
+            m->is_block = false;
+        }
+    }
+
+    /* Nothing to gain with a single process per node */
+    m->flat = (m->num_nodes == size);
+
+    if (NULL != m->leader_comm) {
+        m->leader_module = OBJ_NEW(mca_coll_base_module_t);
+        if (NULL == m->leader_module) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+        m->leader_module->base_data = OBJ_NEW(mca_coll_base_comm_t);
+        if (NULL == m->leader_module->base_data) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto exit;
+        }
+    }
+
+    opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                        "coll:hier:enable (%d/%s): %d nodes, %s placement%s",
+                        comm->c_contextid, comm->c_name, m->num_nodes,
+                        m->is_block ? "block" : "non-block",
+                        m->flat ? ", single process per node: using the prior layer" : "");
+
+ exit:
+    free(all_info);
+    if (OMPI_SUCCESS != ret) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:hier:enable (%d/%s): setup failed (%d), using the prior layer",
+                            comm->c_contextid, comm->c_name, ret);
+        m->flat = true;
+    }
+    m->enabled = true;
+    m->in_setup = false;
+
+    return ret;
+}
+
+
+int mca_coll_hier_ft_event(int state)
+{
+    return OMPI_SUCCESS;
+}
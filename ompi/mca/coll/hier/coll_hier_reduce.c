@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/mca/coll/base/coll_tags.h"
+#include "ompi/mca/pml/pml.h"
+#include "ompi/op/op.h"
+#include "coll_hier.h"
+
+
+/*
+ * On-node reduce of a segment to the leader, non-blocking if the
+ * collective is pipelined
+ */
+static inline int hier_local_reduce(mca_coll_hier_module_t *m,
+                                    const void *sbuf, void *rbuf, int count,
+                                    struct ompi_datatype_t *dtype,
+                                    struct ompi_op_t *op, bool pipelined,
+                                    ompi_request_t **request)
+{
+    struct ompi_communicator_t *local_comm = m->local_comm;
+
+    if (pipelined) {
+        return local_comm->c_coll->coll_ireduce(sbuf, rbuf, count, dtype, op, 0,
+                                                local_comm, request,
+                                                local_comm->c_coll->coll_ireduce_module);
+    }
+    *request = MPI_REQUEST_NULL;
+    return local_comm->c_coll->coll_reduce(sbuf, rbuf, count, dtype, op, 0,
+                                           local_comm,
+                                           local_comm->c_coll->coll_reduce_module);
+}
+
+/*
+ *	reduce
+ *
+ *	Function:	- on-node reduce to the leaders, reduce between
+ *			  the leaders to the leader of the node of the
+ *			  root, then send to the root if it is not the
+ *			  leader
+ *	Accepts:	- same as MPI_Reduce()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ * The order of the operands changes, so non-commutative operations go
+ * to the prior layer.  Large messages are cut in segments: the leaders
+ * reduce a segment with the other leaders while the next one is
+ * reduced on their node.
+ */
+int mca_coll_hier_reduce(const void *sbuf, void *rbuf, int count,
+                         struct ompi_datatype_t *dtype,
+                         struct ompi_op_t *op,
+                         int root,
+                         struct ompi_communicator_t *comm,
+                         mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+    ompi_request_t *request = MPI_REQUEST_NULL;
+    int ret = OMPI_SUCCESS, rank, seg, num_segs, seg_count, root_node;
+    char *free_buffer = NULL, *target;
+    ptrdiff_t lb, extent, gap;
+    bool pipelined;
+
+    if (!mca_coll_hier_use(m, comm) || !ompi_op_is_commute(op) || 0 == count) {
+        return m->c_coll.coll_reduce(sbuf, rbuf, count, dtype, op, root, comm,
+                                     m->c_coll.coll_reduce_module);
+    }
+
+    rank = ompi_comm_rank(comm);
+    ompi_datatype_get_extent(dtype, &lb, &extent);
+    seg_count = mca_coll_hier_segment_count(dtype, count);
+    pipelined = (seg_count < count &&
+                 NULL != m->local_comm->c_coll->coll_ireduce);
+    if (!pipelined) {
+        seg_count = count;
+    }
+    num_segs = (count + seg_count - 1) / seg_count;
+    root_node = m->node_of[root];
+
+    /* Only the root can use MPI_IN_PLACE, its contribution is in rbuf */
+    if (MPI_IN_PLACE == sbuf && NULL == m->leader_comm) {
+        sbuf = rbuf;
+    }
+
+    if (NULL == m->leader_comm) {
+        /* Not a leader: the on-node phase only */
+        for (seg = 0; seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+            int n = (seg == num_segs - 1) ? count - seg * seg_count : seg_count;
+            ret = hier_local_reduce(m, (char*) sbuf + (ptrdiff_t) seg * seg_count * extent,
+                                    NULL, n, dtype, op, pipelined, &request);
+            ret = mca_coll_hier_wait(&request, ret);
+        }
+
+        /* The result goes through my leader if I am the root */
+        if (OMPI_SUCCESS == ret && root == rank) {
+            ret = MCA_PML_CALL(recv(rbuf, count, dtype, 0, MCA_COLL_BASE_TAG_REDUCE,
+                                    m->local_comm, MPI_STATUS_IGNORE));
+        }
+        return ret;
+    }
+
+    /* Leader: the partial results of my node go to rbuf if I am the
+       root, to a temporary buffer otherwise */
+    if (root == rank) {
+        target = (char*) rbuf;
+    } else {
+        free_buffer = (char*) malloc(opal_datatype_span(&dtype->super, count, &gap));
+        if (NULL == free_buffer) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        target = free_buffer - gap;
+    }
+
+    ret = hier_local_reduce(m, sbuf, target, (1 == num_segs) ? count : seg_count,
+                            dtype, op, pipelined, &request);
+    for (seg = 0; seg < num_segs && OMPI_SUCCESS == ret; ++seg) {
+        int n = (seg == num_segs - 1) ? count - seg * seg_count : seg_count;
+        ptrdiff_t offset = (ptrdiff_t) seg * seg_count * extent;
+
+        ret = mca_coll_hier_wait(&request, ret);
+        if (OMPI_SUCCESS != ret) {
+            break;
+        }
+        if (seg + 1 < num_segs) {
+            int next = (seg + 1 == num_segs - 1) ? count - (seg + 1) * seg_count : seg_count;
+            ret = hier_local_reduce(m, (MPI_IN_PLACE == sbuf) ? MPI_IN_PLACE :
+                                    (char*) sbuf + offset + (ptrdiff_t) seg_count * extent,
+                                    target + offset + (ptrdiff_t) seg_count * extent,
+                                    next, dtype, op, pipelined, &request);
+            if (OMPI_SUCCESS != ret) {
+                break;
+            }
+        }
+
+        /* The leader of the node of the root reduces in place */
+        if (root_node == m->my_node) {
+            ret = ompi_coll_base_reduce_intra_binomial(MPI_IN_PLACE, target + offset,
+                                                       n, dtype, op, root_node,
+                                                       m->leader_comm,
+                                                       m->leader_module, 0, 0);
+        } else {
+            ret = ompi_coll_base_reduce_intra_binomial(target + offset, NULL,
+                                                       n, dtype, op, root_node,
+                                                       m->leader_comm,
+                                                       m->leader_module, 0, 0);
+        }
+    }
+    ret = mca_coll_hier_wait(&request, ret);
+
+    if (OMPI_SUCCESS == ret && root_node == m->my_node && root != rank) {
+        ret = MCA_PML_CALL(send(target, count, dtype, m->local_rank_of[root],
+                                MCA_COLL_BASE_TAG_REDUCE,
+                                MCA_PML_BASE_SEND_STANDARD, m->local_comm));
+    }
+
+    free(free_buffer);
+    return ret;
+}
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "ompi/mca/coll/base/coll_tags.h"
+#include "ompi/mca/pml/pml.h"
+#include "coll_hier.h"
+
+
+/*
+ * Leader of a node other than the one of the root, when the blocks of
+ * the node span several segments: receive each segment from the leader
+ * of the node of the root and send its blocks to the other processes
+ * of the node while receiving the next one.
+ */
+static int hier_scatter_pipelined(mca_coll_hier_module_t *m, char *blocks,
+                                  int ucount, struct ompi_datatype_t *udtype,
+                                  ptrdiff_t uextent, void *rbuf, int rcount,
+                                  struct ompi_datatype_t *rdtype,
+                                  int root_node, int seg_blocks)
+{
+    int i, j, ret = OMPI_SUCCESS, nblocks = m->node_sizes[m->my_node];
+    ompi_request_t **reqs;
+
+    reqs = ompi_coll_base_comm_get_reqs(m->leader_module->base_data, nblocks);
+    if (NULL == reqs) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    for (i = 0; i < nblocks; ++i) {
+        reqs[i] = MPI_REQUEST_NULL;
+    }
+
+    for (i = 0; i < nblocks && OMPI_SUCCESS == ret; i += seg_blocks) {
+        int n = (nblocks - i < seg_blocks) ? nblocks - i : seg_blocks;
+
+        ret = MCA_PML_CALL(recv(blocks + (ptrdiff_t) i * ucount * uextent,
+                                n * ucount, udtype, root_node,
+                                MCA_COLL_BASE_TAG_SCATTER, m->leader_comm,
+                                MPI_STATUS_IGNORE));
+        for (j = i; j < i + n && OMPI_SUCCESS == ret; ++j) {
+            if (0 == j) {
+                ret = ompi_datatype_sndrcv(blocks, ucount, udtype, rbuf, rcount, rdtype);
+                continue;
+            }
+            ret = MCA_PML_CALL(isend(blocks + (ptrdiff_t) j * ucount * uextent,
+                                     ucount, udtype, j, MCA_COLL_BASE_TAG_SCATTER,
+                                     MCA_PML_BASE_SEND_STANDARD, m->local_comm,
+                                     &reqs[j]));
+        }
+    }
+    if (OMPI_SUCCESS != ret) {
+        ompi_coll_base_free_reqs(reqs, nblocks);
+        return ret;
+    }
+    return ompi_request_wait_all(nblocks, reqs, MPI_STATUSES_IGNORE);
+}
+
+/*
+ *	scatter
+ *
+ *	Function:	- send to the leader of the node of the root if
+ *			  the root is not the leader, linear scatter of
+ *			  the node blocks to the leaders, then on-node
+ *			  scatter
+ *	Accepts:	- same as MPI_Scatter()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ * The mirror of gather: the blocks travel in node order, the root
+ * sends them directly from sbuf when the nodes hold consecutive ranks
+ * and reorders them in a temporary buffer otherwise.
+ *
+ * The blocks of a node larger than coll_hier_segsize leave the leader
+ * of the node of the root in segments of whole blocks.  The leaders of
+ * the other nodes then send the blocks of a segment to their node
+ * point to point, instead of the on-node scatter, while receiving the
+ * next one.  The leader of the node of the root scatters its own node
+ * while its sends to the other leaders progress.
+ */
+int mca_coll_hier_scatter(const void *sbuf, int scount,
+                          struct ompi_datatype_t *sdtype,
+                          void *rbuf, int rcount,
+                          struct ompi_datatype_t *rdtype,
+                          int root,
+                          struct ompi_communicator_t *comm,
+                          mca_coll_base_module_t *module)
+{
+    mca_coll_hier_module_t *m = (mca_coll_hier_module_t*) module;
+    struct ompi_datatype_t *udtype;
+    ompi_request_t **reqs;
+    int i, ret = OMPI_SUCCESS, rank, size, ucount, root_node, nblocks, node;
+    int seg, seg_blocks, nreqs;
+    char *free_buffer = NULL, *blocks;
+    ptrdiff_t lb, uextent, gap;
+
+    rank = ompi_comm_rank(comm);
+
+    /* Count and datatype of a block on this process */
+    ucount = (rank == root) ? scount : rcount;
+    udtype = (rank == root) ? sdtype : rdtype;
+
+    if (!mca_coll_hier_use(m, comm) || 0 == ucount) {
+        return m->c_coll.coll_scatter(sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                      root, comm, m->c_coll.coll_scatter_module);
+    }
+
+    size = ompi_comm_size(comm);
+    root_node = m->node_of[root];
+    ompi_datatype_get_extent(udtype, &lb, &uextent);
+    seg_blocks = mca_coll_hier_segment_blocks(udtype, ucount);
+
+    if (NULL == m->leader_comm && m->my_node != root_node &&
+        1 < mca_coll_hier_node_segs(m, m->my_node, seg_blocks)) {
+        /* My leader sends the blocks of the node one by one */
+        return MCA_PML_CALL(recv(rbuf, rcount, rdtype, 0, MCA_COLL_BASE_TAG_SCATTER,
+                                 m->local_comm, MPI_STATUS_IGNORE));
+    }
+
+    if (NULL == m->leader_comm) {
+        nblocks = (rank == root && !m->is_block) ? size : 0;
+    } else {
+        nblocks = (m->my_node == root_node) ? size : m->node_sizes[m->my_node];
+        if (rank == root && m->is_block) {
+            nblocks = 0;
+        }
+    }
+
+    /* Buffer of the blocks in node order */
+    if (0 != nblocks) {
+        free_buffer = (char*) malloc(opal_datatype_span(&udtype->super,
+                                                        (size_t) nblocks * ucount, &gap));
+        if (NULL == free_buffer) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        blocks = free_buffer - gap;
+    } else {
+        blocks = (char*) sbuf;
+    }
+
+    /* The root reorders the blocks from rank order to node order */
+    for (i = 0; rank == root && blocks != (char*) sbuf && i < size; ++i) {
+        ret = ompi_datatype_copy_content_same_ddt(sdtype, scount,
+                                                  blocks + (ptrdiff_t) i * scount * uextent,
+                                                  (char*) sbuf + (ptrdiff_t) m->ranks_by_node[i] *
+                                                  scount * uextent);
+        if (OMPI_SUCCESS != ret) {
+            goto exit;
+        }
+    }
+
+    if (NULL == m->leader_comm) {
+        if (rank == root) {
+            ret = MCA_PML_CALL(send(blocks, size * scount, sdtype, 0,
+                                    MCA_COLL_BASE_TAG_SCATTER,
+                                    MCA_PML_BASE_SEND_STANDARD, m->local_comm));
+            if (OMPI_SUCCESS != ret) {
+                goto exit;
+            }
+            /* My block stays in sbuf with MPI_IN_PLACE, receive it
+               in a temporary buffer */
+            if (MPI_IN_PLACE == rbuf) {
+                if (NULL == free_buffer) {
+                    free_buffer = (char*) malloc(opal_datatype_span(&sdtype->super,
+                                                                    scount, &gap));
+                    if (NULL == free_buffer) {
+                        return OMPI_ERR_OUT_OF_RESOURCE;
+                    }
+                    blocks = free_buffer - gap;
+                }
+                rbuf = blocks;
+                rcount = scount;
+                rdtype = sdtype;
+            }
+        }
+        ret = m->local_comm->c_coll->coll_scatter(NULL, 0, MPI_DATATYPE_NULL,
+                                                  rbuf, rcount, rdtype, 0, m->local_comm,
+                                                  m->local_comm->c_coll->coll_scatter_module);
+        goto exit;
+    }
+
+    if (m->my_node != root_node) {
+        if (1 < mca_coll_hier_node_segs(m, m->my_node, seg_blocks)) {
+            ret = hier_scatter_pipelined(m, blocks, ucount, udtype, uextent,
+                                         rbuf, rcount, rdtype, root_node, seg_blocks);
+            goto exit;
+        }
+        ret = MCA_PML_CALL(recv(blocks, nblocks * ucount, udtype, root_node,
+                                MCA_COLL_BASE_TAG_SCATTER, m->leader_comm,
+                                MPI_STATUS_IGNORE));
+        if (OMPI_SUCCESS == ret) {
+            ret = m->local_comm->c_coll->coll_scatter(blocks, ucount, udtype,
+                                                      rbuf, rcount, rdtype, 0, m->local_comm,
+                                                      m->local_comm->c_coll->coll_scatter_module);
+        }
+        goto exit;
+    }
+
+    /* Leader of the node of the root: get the blocks from the root,
+       send the blocks of the other nodes by segment, and scatter the
+       blocks of my node while the sends progress */
+    if (rank != root) {
+        ret = MCA_PML_CALL(recv(blocks, size * ucount, udtype, m->local_rank_of[root],
+                                MCA_COLL_BASE_TAG_SCATTER, m->local_comm,
+                                MPI_STATUS_IGNORE));
+        if (OMPI_SUCCESS != ret) {
+            goto exit;
+        }
+    }
+
+    for (nreqs = 0, node = 0; node < m->num_nodes; ++node) {
+        nreqs += (node == root_node) ? 0 : mca_coll_hier_node_segs(m, node, seg_blocks);
+    }
+    reqs = ompi_coll_base_comm_get_reqs(m->leader_module->base_data, nreqs);
+    if (NULL == reqs) {
+        ret = OMPI_ERR_OUT_OF_RESOURCE;
+        goto exit;
+    }
+    for (nreqs = 0, node = 0; node < m->num_nodes; ++node) {
+        int num_segs = mca_coll_hier_node_segs(m, node, seg_blocks);
+        int per_seg = (1 == num_segs) ? m->node_sizes[node] : seg_blocks;
+
+        for (seg = 0; node != root_node && seg < num_segs; ++seg) {
+            int first = seg * per_seg;
+            int n = (m->node_sizes[node] - first < per_seg) ?
+                m->node_sizes[node] - first : per_seg;
+
+            ret = MCA_PML_CALL(isend(blocks + (ptrdiff_t) (m->node_disps[node] + first) *
+                                     ucount * uextent,
+                                     n * ucount, udtype, node,
+                                     MCA_COLL_BASE_TAG_SCATTER,
+                                     MCA_PML_BASE_SEND_STANDARD, m->leader_comm,
+                                     &reqs[nreqs]));
+            if (OMPI_SUCCESS != ret) {
+                ompi_coll_base_free_reqs(reqs, nreqs);
+                goto exit;
+            }
+            ++nreqs;
+        }
+    }
+
+    ret = m->local_comm->c_coll->coll_scatter(blocks + (ptrdiff_t) m->node_disps[m->my_node] *
+                                              ucount * uextent, ucount, udtype,
+                                              rbuf, rcount, rdtype, 0, m->local_comm,
+                                              m->local_comm->c_coll->coll_scatter_module);
+    if (OMPI_SUCCESS != ret) {
+        ompi_coll_base_free_reqs(reqs, nreqs);
+        goto exit;
+    }
+    ret = ompi_request_wait_all(nreqs, reqs, MPI_STATUSES_IGNORE);
+
+ exit:
+    free(free_buffer);
+    return ret;
+}
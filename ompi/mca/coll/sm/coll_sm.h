@@ -25,6 +25,10 @@
 
 #include "ompi_config.h"
 
+#ifdef HAVE_SYS_TYPES_H
+#include <sys/types.h>
+#endif
+
 #include "mpi.h"
 #include "ompi/mca/mca.h"
 #include "opal/datatype/opal_convertor.h"
@@ -81,6 +85,10 @@ BEGIN_C_DECLS
             calculation of the "info" MCA parameter */
         int sm_info_comm_size;
 
+        /** MCA parameter: Minimum size of the messages transferred
+            with a single copy (0 if disabled) */
+        size_t sm_single_copy_threshold;
+
         /******* end of MCA params ********/
 
         /** How many fragment segments are protected by a single
@@ -117,8 +125,20 @@ BEGIN_C_DECLS
         opal_atomic_uint32_t mcsiuf_num_procs_using;
         /** Must match data->mcb_count */
         volatile uint32_t mcsiuf_operation_count;
+        /** Number of fragments of the current operation, published by
+            the process claiming the flag for the processes that cannot
+            compute it (e.g., non-root processes of gatherv) */
+        volatile uint64_t mcsiuf_num_frags;
     } mca_coll_sm_in_use_flag_t;
 
+    /**
+     * Offset in the control_size area of each in-use flag of the
+     * slots (one size_t per process) in which the processes give the
+     * claiming process their number of fragments (see
+     * mca_coll_sm_flag_acquire_max()), on their own cache line
+     */
+#define MCA_COLL_SM_FLAG_SLOTS_OFFSET 64
+
     /**
      * Structure containing pointers to various arrays of data in the
      * per-communicator shmem data segment (one of these indexes a
@@ -134,6 +154,37 @@ BEGIN_C_DECLS
         char *mcbmi_data;
     } mca_coll_sm_data_index_t;
 
+    /**
+     * Stream of bytes packed to or unpacked from the fragments of the
+     * shared segments.  The flat collectives (gather, scatter,
+     * allgather, alltoall, scan and their variants) use one stream per
+     * peer, fragments of each stream are passed in order through
+     * consecutive segments.
+     */
+    typedef struct mca_coll_sm_stream_t {
+        /** Convertor from / to the user buffer */
+        opal_convertor_t mcss_convertor;
+        /** Number of bytes left to be packed / unpacked */
+        size_t mcss_remaining;
+        /** Number of bytes packed per fragment (at most the fragment
+            size, defaults to it) */
+        size_t mcss_frag_len;
+    } mca_coll_sm_stream_t;
+
+    /**
+     * Location of a buffer exposed to the other processes for single
+     * copy transfers, written in the slot of the exposing process
+     */
+    typedef struct mca_coll_sm_cma_desc_t {
+        /** Process exposing the buffer */
+        pid_t mcscd_pid;
+        /** Address of the (packed) data in that process */
+        uint64_t mcscd_addr;
+        /** OMPI_SUCCESS, or the error that prevented exposing the
+            buffer (the readers return it and still notify the sender) */
+        int32_t mcscd_error;
+    } mca_coll_sm_cma_desc_t;
+
     /**
      * Structure for the sm coll module to hang off the communicator.
      * Contains communicator-specific information, including pointers
@@ -195,6 +246,13 @@ BEGIN_C_DECLS
         /* Underlying reduce function and module */
 	mca_coll_base_module_reduce_fn_t previous_reduce;
 	mca_coll_base_module_t *previous_reduce_module;
+
+        /* Underlying scan / exscan functions and modules, used for
+           datatypes larger than a fragment */
+	mca_coll_base_module_scan_fn_t previous_scan;
+	mca_coll_base_module_t *previous_scan_module;
+	mca_coll_base_module_exscan_fn_t previous_exscan;
+	mca_coll_base_module_t *previous_exscan_module;
     } mca_coll_sm_module_t;
     OBJ_CLASS_DECLARATION(mca_coll_sm_module_t);
 
@@ -217,6 +275,28 @@ BEGIN_C_DECLS
     int ompi_coll_sm_lazy_enable(mca_coll_base_module_t *module,
                                  struct ompi_communicator_t *comm);
 
+    /* Helpers for the flat collectives (coll_sm_stream.c) */
+    int mca_coll_sm_stream_init_send(mca_coll_sm_stream_t *stream,
+                                     struct ompi_datatype_t *dtype,
+                                     size_t count, const void *buf);
+    int mca_coll_sm_stream_init_recv(mca_coll_sm_stream_t *stream,
+                                     struct ompi_datatype_t *dtype,
+                                     size_t count, void *buf);
+    void mca_coll_sm_stream_fini(mca_coll_sm_stream_t *stream);
+    size_t mca_coll_sm_stream_pack(mca_coll_sm_stream_t *stream,
+                                   mca_coll_sm_data_index_t *index,
+                                   int slot);
+    void mca_coll_sm_stream_unpack(mca_coll_sm_stream_t *stream,
+                                   mca_coll_sm_data_index_t *index,
+                                   int slot, size_t len);
+    mca_coll_sm_in_use_flag_t *
+    mca_coll_sm_flag_acquire(mca_coll_sm_comm_t *data, int claimer,
+                             int rank, int size, uint64_t *num_frags,
+                             int *segment_num);
+    mca_coll_sm_in_use_flag_t *
+    mca_coll_sm_flag_acquire_max(mca_coll_sm_comm_t *data, int rank, int size,
+                                 uint64_t *num_frags, int *segment_num);
+
     int mca_coll_sm_allgather_intra(const void *sbuf, int scount,
 				    struct ompi_datatype_t *sdtype,
 				    void *rbuf, int rcount,
@@ -270,14 +350,14 @@ BEGIN_C_DECLS
 				 struct ompi_op_t *op,
 				 struct ompi_communicator_t *comm,
 				 mca_coll_base_module_t *module);
-    int mca_coll_sm_gather_intra(void *sbuf, int scount,
+    int mca_coll_sm_gather_intra(const void *sbuf, int scount,
 				 struct ompi_datatype_t *sdtype, void *rbuf,
 				 int rcount, struct ompi_datatype_t *rdtype,
 				 int root, struct ompi_communicator_t *comm,
 				 mca_coll_base_module_t *module);
-    int mca_coll_sm_gatherv_intra(void *sbuf, int scount,
+    int mca_coll_sm_gatherv_intra(const void *sbuf, int scount,
 				  struct ompi_datatype_t *sdtype, void *rbuf,
-				  int *rcounts, int *disps,
+				  const int *rcounts, const int *disps,
 				  struct ompi_datatype_t *rdtype, int root,
 				  struct ompi_communicator_t *comm,
 				  mca_coll_base_module_t *module);
@@ -294,11 +374,17 @@ BEGIN_C_DECLS
 				     struct ompi_communicator_t *comm,
 				     mca_coll_base_module_t *module);
     int mca_coll_sm_reduce_scatter_intra(const void *sbuf, void *rbuf,
-					 int *rcounts,
+					 const int *rcounts,
 					 struct ompi_datatype_t *dtype,
 					 struct ompi_op_t *op,
 					 struct ompi_communicator_t *comm,
 					 mca_coll_base_module_t *module);
+    int mca_coll_sm_reduce_scatter_block_intra(const void *sbuf, void *rbuf,
+					       int rcount,
+					       struct ompi_datatype_t *dtype,
+					       struct ompi_op_t *op,
+					       struct ompi_communicator_t *comm,
+					       mca_coll_base_module_t *module);
     int mca_coll_sm_scan_intra(const void *sbuf, void *rbuf, int count,
 			       struct ompi_datatype_t *dtype,
 			       struct ompi_op_t *op,
@@ -316,6 +402,51 @@ BEGIN_C_DECLS
 				   struct ompi_communicator_t *comm,
 				   mca_coll_base_module_t *module);
 
+    /* alltoallw with displacements in bytes and a known upper bound
+       of the number of bytes exchanged between any two processes
+       (SIZE_MAX if unknown) */
+    int mca_coll_sm_alltoallw_bounded(const void *sbuf, const int *scounts, const ptrdiff_t *sdisps,
+                                      struct ompi_datatype_t * const *sdtypes,
+                                      void *rbuf, const int *rcounts, const ptrdiff_t *rdisps,
+                                      struct ompi_datatype_t * const *rdtypes,
+                                      size_t max_bytes,
+                                      struct ompi_communicator_t *comm,
+                                      mca_coll_base_module_t *module);
+
+    /* scan (exclusive == false) and exscan (exclusive == true) of
+       datatypes fitting in a fragment */
+    int mca_coll_sm_scan_flat(const void *sbuf, void *rbuf, int count,
+                              struct ompi_datatype_t *dtype,
+                              struct ompi_op_t *op, bool exclusive,
+                              struct ompi_communicator_t *comm,
+                              mca_coll_base_module_t *module);
+
+    /* reduce_scatter of datatypes fitting in a fragment with a
+       commutative operation */
+    int mca_coll_sm_reduce_scatter_ring(const void *sbuf, void *rbuf,
+                                        const int *rcounts,
+                                        struct ompi_datatype_t *dtype,
+                                        struct ompi_op_t *op,
+                                        struct ompi_communicator_t *comm,
+                                        mca_coll_base_module_t *module);
+
+#if OMPI_COLL_SM_HAVE_CMA
+    /* Single copy transfers of large messages (coll_sm_cma.c) */
+    bool mca_coll_sm_cma_init(void);
+    int mca_coll_sm_bcast_single_copy(void *buff, int count,
+                                      struct ompi_datatype_t *datatype,
+                                      int root,
+                                      struct ompi_communicator_t *comm,
+                                      mca_coll_base_module_t *module);
+    int mca_coll_sm_allgatherv_single_copy(const void *sbuf, int scount,
+                                           struct ompi_datatype_t *sdtype,
+                                           void *rbuf, const int *rcounts,
+                                           const int *disps,
+                                           struct ompi_datatype_t *rdtype,
+                                           struct ompi_communicator_t *comm,
+                                           mca_coll_base_module_t *module);
+#endif
+
     int mca_coll_sm_ft_event(int state);
 
 /**
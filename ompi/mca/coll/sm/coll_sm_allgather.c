@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,16 +22,18 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
 #include "coll_sm.h"
 
 
-/*
- *	allgather
+/**
+ * Shared memory allgather.
  *
- *	Function:	- allgather
- *	Accepts:	- same as MPI_Allgather()
- *	Returns:	- MPI_SUCCESS or error code
+ * Allgather is an allgatherv where all the processes send the same
+ * amount of data (see coll_sm_allgatherv.c).
  */
 int mca_coll_sm_allgather_intra(const void *sbuf, int scount,
                                 struct ompi_datatype_t *sdtype, void *rbuf,
@@ -37,5 +41,22 @@ int mca_coll_sm_allgather_intra(const void *sbuf, int scount,
                                 struct ompi_communicator_t *comm,
                                 mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, size = ompi_comm_size(comm);
+    int *rcounts, *disps;
+
+    rcounts = (int*) malloc(2 * size * sizeof(int));
+    if (NULL == rcounts) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    disps = rcounts + size;
+    for (i = 0; i < size; ++i) {
+        rcounts[i] = rcount;
+        disps[i] = i * rcount;
+    }
+
+    ret = mca_coll_sm_allgatherv_intra(sbuf, scount, sdtype, rbuf, rcounts,
+                                       disps, rdtype, comm, module);
+
+    free(rcounts);
+    return ret;
 }
@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,23 +22,155 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
-/*
- *	allgatherv_intra
+/**
+ * Shared memory allgatherv.
  *
- *	Function:	- allgatherv
- *	Accepts:	- same as MPI_Allgatherv()
- *	Returns:	- MPI_SUCCESS or error code
+ * Flat algorithm (see coll_sm_stream.c): every process packs the
+ * fragments of its buffer in its own slot of consecutive segments and
+ * notifies all the other processes, which unpack them straight from
+ * the slot to their receive buffer.  All the processes know the counts
+ * of the others, rank 0 claims the sets of segments.
+ *
+ * Blocks larger than the single_copy_threshold MCA parameter are read
+ * directly from the buffers of the other processes instead (see
+ * coll_sm_cma.c).
  */
 int mca_coll_sm_allgatherv_intra(const void *sbuf, int scount,
                                  struct ompi_datatype_t *sdtype,
                                  void * rbuf, const int *rcounts, const int *disps,
                                  struct ompi_datatype_t *rdtype,
                                  struct ompi_communicator_t *comm,
-                                mca_coll_base_module_t *module)
+                                 mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_stream_t *streams;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_data_index_t *index;
+    mca_coll_sm_comm_t *data;
+    int i, ret, rank, size, peer, segment_num, max_segment_num;
+    uint64_t frag = 0, num_frags;
+    size_t len, type_size, max_bytes = 0;
+    ptrdiff_t lb, extent;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    ompi_datatype_get_extent(rdtype, &lb, &extent);
+    ompi_datatype_type_size(rdtype, &type_size);
+    for (peer = 0; peer < size; ++peer) {
+        if (max_bytes < rcounts[peer] * type_size) {
+            max_bytes = rcounts[peer] * type_size;
+        }
+    }
+
+#if OMPI_COLL_SM_HAVE_CMA
+    /* Large blocks are read directly from the buffers of the others */
+    if (0 != mca_coll_sm_component.sm_single_copy_threshold &&
+        max_bytes >= mca_coll_sm_component.sm_single_copy_threshold) {
+        return mca_coll_sm_allgatherv_single_copy(sbuf, scount, sdtype, rbuf,
+                                                  rcounts, disps, rdtype,
+                                                  comm, module);
+    }
+#endif
+
+    streams = (mca_coll_sm_stream_t*) malloc(size * sizeof(mca_coll_sm_stream_t));
+    if (NULL == streams) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    /* My own data is sent from my block of the receive buffer with
+       MPI_IN_PLACE, copied there otherwise */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = (char*) rbuf + disps[rank] * extent;
+        scount = rcounts[rank];
+        sdtype = rdtype;
+    } else {
+        ret = ompi_datatype_sndrcv(sbuf, scount, sdtype,
+                                   (char*) rbuf + disps[rank] * extent,
+                                   rcounts[rank], rdtype);
+        if (MPI_SUCCESS != ret) {
+            free(streams);
+            return ret;
+        }
+    }
+
+    /* One send stream for me, one receive stream for each of the
+       others */
+    for (peer = 0; peer < size; ++peer) {
+        if (peer == rank) {
+            mca_coll_sm_stream_init_send(&streams[peer], sdtype, scount, sbuf);
+        } else {
+            mca_coll_sm_stream_init_recv(&streams[peer], rdtype, rcounts[peer],
+                                         (char*) rbuf + disps[peer] * extent);
+        }
+    }
+    num_frags = (max_bytes + mca_coll_sm_component.sm_fragment_size - 1) /
+        mca_coll_sm_component.sm_fragment_size;
+
+    /* Main loop over the sets of segments */
+
+    do {
+        flag = mca_coll_sm_flag_acquire(data, 0, rank, size, &num_frags,
+                                        &segment_num);
+        max_segment_num = segment_num +
+            mca_coll_sm_component.sm_segs_per_inuse_flag;
+
+        for ( ; frag < num_frags && segment_num < max_segment_num;
+              ++frag, ++segment_num) {
+            index = &(data->mcb_data_index[segment_num]);
+
+            /* Copy my next fragment in my slot and tell everybody
+               that it is ready */
+            if (0 != (len = mca_coll_sm_stream_pack(&streams[rank], index, rank))) {
+                opal_atomic_wmb();
+                for (i = 1; i < size; ++i) {
+                    CHILD_NOTIFY_PARENT(rank, (rank + i) % size, index, len);
+                }
+            }
+
+            /* Copy the fragments of the others to my output buffer,
+               starting with my right neighbor to spread the load */
+            for (i = 1; i < size; ++i) {
+                peer = (rank + i) % size;
+                if (0 == streams[peer].mcss_remaining) {
+                    continue;
+                }
+                PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, rank, index, len,
+                                                allgatherv_label);
+                opal_atomic_rmb();
+                mca_coll_sm_stream_unpack(&streams[peer], index, peer, len);
+            }
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    } while (frag < num_frags);
+
+    for (peer = 0; peer < size; ++peer) {
+        mca_coll_sm_stream_fini(&streams[peer]);
+    }
+    free(streams);
+
+    return OMPI_SUCCESS;
 }
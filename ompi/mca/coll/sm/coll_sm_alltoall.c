@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,22 +22,66 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
 #include "coll_sm.h"
 
 
-/*
- *	alltoall_intra
+/**
+ * Shared memory alltoall.
  *
- *	Function:	- MPI_Alltoall
- *	Accepts:	- same as MPI_Alltoall()
- *	Returns:	- MPI_SUCCESS or an MPI error code
+ * Converted to an alltoallw (see coll_sm_alltoallw.c); all the
+ * processes know the amount of data exchanged between any two of
+ * them, so the steps are sized without exchanging anything.
  */
 int mca_coll_sm_alltoall_intra(const void *sbuf, int scount,
-                               struct ompi_datatype_t *sdtype, void *rbuf,
-                               int rcount, struct ompi_datatype_t *rdtype,
+                               struct ompi_datatype_t *sdtype,
+                               void* rbuf, int rcount,
+                               struct ompi_datatype_t *rdtype,
                                struct ompi_communicator_t *comm,
-                                mca_coll_base_module_t *module)
+                               mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, size = ompi_comm_size(comm);
+    struct ompi_datatype_t **dtypes;
+    ptrdiff_t lb, sextent, rextent, *disps;
+    size_t type_size;
+    int *counts;
+
+    counts = (int*) malloc(2 * size * sizeof(int));
+    disps = (ptrdiff_t*) malloc(2 * size * sizeof(ptrdiff_t));
+    dtypes = (struct ompi_datatype_t**) malloc(2 * size * sizeof(struct ompi_datatype_t*));
+    if (NULL == counts || NULL == disps || NULL == dtypes) {
+        free(counts);
+        free(disps);
+        free(dtypes);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    if (MPI_IN_PLACE == sbuf) {
+        sdtype = rdtype;
+        scount = rcount;
+    }
+    ompi_datatype_get_extent(sdtype, &lb, &sextent);
+    ompi_datatype_get_extent(rdtype, &lb, &rextent);
+    for (i = 0; i < size; ++i) {
+        counts[i] = scount;
+        counts[size + i] = rcount;
+        disps[i] = (ptrdiff_t) i * scount * sextent;
+        disps[size + i] = (ptrdiff_t) i * rcount * rextent;
+        dtypes[i] = sdtype;
+        dtypes[size + i] = rdtype;
+    }
+    ompi_datatype_type_size(rdtype, &type_size);
+
+    ret = mca_coll_sm_alltoallw_bounded(sbuf, counts, disps, dtypes,
+                                        rbuf, counts + size, disps + size, dtypes + size,
+                                        rcount * type_size, comm, module);
+
+    free(counts);
+    free(disps);
+    free(dtypes);
+    return ret;
 }
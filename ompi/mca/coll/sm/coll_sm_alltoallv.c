@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,16 +22,18 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
 #include "coll_sm.h"
 
 
-/*
- *	alltoallv_intra
+/**
+ * Shared memory alltoallv.
  *
- *	Function:	- MPI_Alltoallv
- *	Accepts:	- same as MPI_Alltoallv()
- *	Returns:	- MPI_SUCCESS or an MPI error code
+ * Converted to an alltoallw (see coll_sm_alltoallw.c).
  */
 int mca_coll_sm_alltoallv_intra(const void *sbuf, const int *scounts, const int *sdisps,
                                 struct ompi_datatype_t *sdtype,
@@ -38,5 +42,34 @@ int mca_coll_sm_alltoallv_intra(const void *sbuf, const int *scounts, const int
                                 struct ompi_communicator_t *comm,
                                 mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, size = ompi_comm_size(comm);
+    struct ompi_datatype_t **dtypes;
+    ptrdiff_t lb, sextent, rextent, *disps;
+
+    disps = (ptrdiff_t*) malloc(2 * size * sizeof(ptrdiff_t));
+    dtypes = (struct ompi_datatype_t**) malloc(2 * size * sizeof(struct ompi_datatype_t*));
+    if (NULL == disps || NULL == dtypes) {
+        free(disps);
+        free(dtypes);
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+
+    ompi_datatype_get_extent(rdtype, &lb, &rextent);
+    if (MPI_IN_PLACE != sbuf) {
+        ompi_datatype_get_extent(sdtype, &lb, &sextent);
+    }
+    for (i = 0; i < size; ++i) {
+        disps[i] = (MPI_IN_PLACE == sbuf) ? 0 : (ptrdiff_t) sdisps[i] * sextent;
+        disps[size + i] = (ptrdiff_t) rdisps[i] * rextent;
+        dtypes[i] = sdtype;
+        dtypes[size + i] = rdtype;
+    }
+
+    ret = mca_coll_sm_alltoallw_bounded(sbuf, scounts, disps, dtypes,
+                                        rbuf, rcounts, disps + size, dtypes + size,
+                                        SIZE_MAX, comm, module);
+
+    free(disps);
+    free(dtypes);
+    return ret;
 }
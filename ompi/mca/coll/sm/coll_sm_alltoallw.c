@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,16 +22,210 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
+#include "mpi.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
+/**
+ * Shared memory alltoallw.
+ *
+ * Flat algorithm (see coll_sm_stream.c) in size - 1 steps: at step k,
+ * each process packs the fragments destined to process (rank + k) in
+ * the slot of that process in consecutive segments, and unpacks the
+ * fragments sent by process (rank - k) from its own slot.  Every step
+ * uses the same number of fragments, computed from the largest amount
+ * of data exchanged between any two processes.  When the caller cannot
+ * provide it, each process gives the number of fragments it needs to
+ * rank 0 through the first in-use flag of the operation, and rank 0
+ * publishes the largest one along with the set of segments (see
+ * mca_coll_sm_flag_acquire_max()), which is much cheaper than an
+ * allreduce.  Rank 0 claims the sets of segments.
+ *
+ * With MPI_IN_PLACE, the blocks destined to the other processes are
+ * first copied to a temporary buffer as they would otherwise be
+ * overwritten before being sent.
+ */
+int mca_coll_sm_alltoallw_bounded(const void *sbuf, const int *scounts, const ptrdiff_t *sdisps,
+                                  struct ompi_datatype_t * const *sdtypes,
+                                  void *rbuf, const int *rcounts, const ptrdiff_t *rdisps,
+                                  struct ompi_datatype_t * const *rdtypes,
+                                  size_t max_bytes,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module)
+{
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_stream_t send_stream, recv_stream;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_data_index_t *index;
+    mca_coll_sm_comm_t *data;
+    int ret, rank, size, step = 0, dst = 0, src = 0;
+    int segment_num, max_segment_num;
+    uint64_t frag = 0, num_frags, step_frags;
+    ptrdiff_t *inplace_disps = NULL;
+    char *inplace_buf = NULL;
+    size_t len, type_size;
+    bool agree;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    if (MPI_IN_PLACE == sbuf) {
+        ptrdiff_t gap, total = 0;
+
+        inplace_disps = (ptrdiff_t*) malloc(size * sizeof(ptrdiff_t));
+        if (NULL == inplace_disps) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (dst = 0; dst < size; ++dst) {
+            inplace_disps[dst] = total;
+            if (dst != rank) {
+                total += opal_datatype_span(&rdtypes[dst]->super, rcounts[dst], &gap);
+            }
+        }
+        inplace_buf = (char*) malloc(total);
+        if (NULL == inplace_buf && 0 != total) {
+            free(inplace_disps);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (dst = 0; dst < size; ++dst) {
+            if (dst == rank) {
+                continue;
+            }
+            (void) opal_datatype_span(&rdtypes[dst]->super, rcounts[dst], &gap);
+            inplace_disps[dst] -= gap;
+            ompi_datatype_copy_content_same_ddt(rdtypes[dst], rcounts[dst],
+                                                inplace_buf + inplace_disps[dst],
+                                                (char*) rbuf + rdisps[dst]);
+        }
+        sbuf = inplace_buf;
+        scounts = rcounts;
+        sdisps = inplace_disps;
+        sdtypes = rdtypes;
+    } else {
+        /* Copy my own data */
+        ret = ompi_datatype_sndrcv((char*) sbuf + sdisps[rank], scounts[rank],
+                                   sdtypes[rank], (char*) rbuf + rdisps[rank],
+                                   rcounts[rank], rdtypes[rank]);
+        if (MPI_SUCCESS != ret) {
+            return ret;
+        }
+    }
+
+    /* All the steps use the same number of fragments; without a bound
+       from the caller, start from the largest amount of data I
+       exchange and agree on the largest one when claiming the first
+       set of segments */
+    agree = (SIZE_MAX == max_bytes);
+    if (agree) {
+        max_bytes = 0;
+        for (dst = 0; dst < size; ++dst) {
+            if (dst == rank) {
+                continue;
+            }
+            ompi_datatype_type_size(sdtypes[dst], &type_size);
+            if (max_bytes < scounts[dst] * type_size) {
+                max_bytes = scounts[dst] * type_size;
+            }
+            ompi_datatype_type_size(rdtypes[dst], &type_size);
+            if (max_bytes < rcounts[dst] * type_size) {
+                max_bytes = rcounts[dst] * type_size;
+            }
+        }
+    }
+    step_frags = (max_bytes + mca_coll_sm_component.sm_fragment_size - 1) /
+        mca_coll_sm_component.sm_fragment_size;
+    num_frags = step_frags * (size - 1);
+
+    /* Main loop over the sets of segments */
+
+    do {
+        if (agree) {
+            flag = mca_coll_sm_flag_acquire_max(data, rank, size, &num_frags,
+                                                &segment_num);
+            step_frags = num_frags / (size - 1);
+            agree = false;
+        } else {
+            flag = mca_coll_sm_flag_acquire(data, 0, rank, size, &num_frags,
+                                            &segment_num);
+        }
+        max_segment_num = segment_num +
+            mca_coll_sm_component.sm_segs_per_inuse_flag;
+
+        for ( ; frag < num_frags && segment_num < max_segment_num;
+              ++frag, ++segment_num) {
+            index = &(data->mcb_data_index[segment_num]);
+
+            /* Switch to the peers of the next step */
+            if (0 == frag % step_frags) {
+                if (0 != step) {
+                    mca_coll_sm_stream_fini(&send_stream);
+                    mca_coll_sm_stream_fini(&recv_stream);
+                }
+                ++step;
+                dst = (rank + step) % size;
+                src = (rank - step + size) % size;
+                mca_coll_sm_stream_init_send(&send_stream, sdtypes[dst], scounts[dst],
+                                             (char*) sbuf + sdisps[dst]);
+                mca_coll_sm_stream_init_recv(&recv_stream, rdtypes[src], rcounts[src],
+                                             (char*) rbuf + rdisps[src]);
+            }
+
+            /* Copy my next fragment for dst in its slot and tell it
+               that it is ready */
+            if (0 != (len = mca_coll_sm_stream_pack(&send_stream, index, dst))) {
+                opal_atomic_wmb();
+                CHILD_NOTIFY_PARENT(rank, dst, index, len);
+            }
+
+            /* Copy the fragment of src to my output buffer */
+            if (0 != recv_stream.mcss_remaining) {
+                PARENT_WAIT_FOR_NOTIFY_SPECIFIC(src, rank, index, len,
+                                                alltoallw_label);
+                opal_atomic_rmb();
+                mca_coll_sm_stream_unpack(&recv_stream, index, rank, len);
+            }
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    } while (frag < num_frags);
+
+    if (0 != step) {
+        mca_coll_sm_stream_fini(&send_stream);
+        mca_coll_sm_stream_fini(&recv_stream);
+    }
+    ret = OMPI_SUCCESS;
+
+    free(inplace_buf);
+    free(inplace_disps);
+
+    return ret;
+}
+
 /*
- *	alltoallw_intra
+ *	alltoallw
  *
- *	Function:	- MPI_Alltoallw
+ *	Function:	- alltoallw
  *	Accepts:	- same as MPI_Alltoallw()
- *	Returns:	- MPI_SUCCESS or an MPI error code
+ *	Returns:	- MPI_SUCCESS or error code
  */
 int mca_coll_sm_alltoallw_intra(const void *sbuf, const int *scounts, const int *sdisps,
                                 struct ompi_datatype_t * const *sdtypes,
@@ -38,5 +234,22 @@ int mca_coll_sm_alltoallw_intra(const void *sbuf, const int *scounts, const int
                                 struct ompi_communicator_t *comm,
                                 mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, size = ompi_comm_size(comm);
+    ptrdiff_t *disps;
+
+    disps = (ptrdiff_t*) malloc(2 * size * sizeof(ptrdiff_t));
+    if (NULL == disps) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    for (i = 0; i < size; ++i) {
+        disps[i] = (MPI_IN_PLACE == sbuf) ? 0 : sdisps[i];
+        disps[size + i] = rdisps[i];
+    }
+
+    ret = mca_coll_sm_alltoallw_bounded(sbuf, scounts, disps, sdtypes,
+                                        rbuf, rcounts, disps + size, rdtypes,
+                                        SIZE_MAX, comm, module);
+
+    free(disps);
+    return ret;
 }
@@ -52,6 +52,9 @@
  * repeated until all fragments have been received.  If they do not
  * have children, they copy the data directly from the parent's shared
  * data segment into the user's output buffer.
+ *
+ * Messages larger than the single_copy_threshold MCA parameter are
+ * read directly from the root's buffer instead (see coll_sm_cma.c).
  */
 int mca_coll_sm_bcast_intra(void *buff, int count,
                             struct ompi_datatype_t *datatype, int root,
@@ -84,6 +87,17 @@ int mca_coll_sm_bcast_intra(void *buff, int count,
     rank = ompi_comm_rank(comm);
     size = ompi_comm_size(comm);
 
+#if OMPI_COLL_SM_HAVE_CMA
+    /* Large messages are read directly from the root's buffer */
+    if (0 != mca_coll_sm_component.sm_single_copy_threshold) {
+        ompi_datatype_type_size(datatype, &total_size);
+        if (total_size * count >= mca_coll_sm_component.sm_single_copy_threshold) {
+            return mca_coll_sm_bcast_single_copy(buff, count, datatype, root,
+                                                 comm, module);
+        }
+    }
+#endif
+
     OBJ_CONSTRUCT(&convertor, opal_convertor_t);
     iov.iov_len = mca_coll_sm_component.sm_fragment_size;
     bytes = 0;
@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file
+ *
+ * Single copy transfers of large messages.
+ *
+ * Passing large messages through the fragments of the shared segments
+ * costs two copies (to and from the segments) and, for bcast, one more
+ * per level of the tree.  Above the single_copy_threshold MCA
+ * parameter, bcast and allgather(v) instead expose the (packed) user
+ * buffer of the sending process(es): its address is written in the
+ * slot of the sender in the first segment of a set, and the receivers
+ * read it with process_vm_readv (Linux Cross Memory Attach).  Each
+ * receiver then notifies the sender in the second segment of the set
+ * that it is done with its buffer.
+ *
+ * The handshake always completes: a sender that cannot expose its
+ * buffer publishes the error instead of the address, and the receivers
+ * still notify it.
+ */
+
+#include "ompi_config.h"
+
+#if OMPI_COLL_SM_HAVE_CMA
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/uio.h>
+#ifdef HAVE_SYS_PRCTL_H
+#include <sys/prctl.h>
+#endif
+
+#if OPAL_CMA_NEED_SYSCALL_DEFS
+#include "opal/sys/cma.h"
+#endif /* OPAL_CMA_NEED_SYSCALL_DEFS */
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
+#include "opal/util/output.h"
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/base/base.h"
+#include "coll_sm.h"
+
+
+/*
+ * Allow the other processes to read our memory (see the same check in
+ * btl/sm).  Returns false if they cannot.
+ */
+bool mca_coll_sm_cma_init(void)
+{
+    char buffer = '0';
+    int fd;
+
+    /* ptrace scope 0 allows an attach from any of the processes of
+       the owner */
+    fd = open("/proc/sys/kernel/yama/ptrace_scope", O_RDONLY);
+    if (0 <= fd) {
+        if (1 != read(fd, &buffer, 1)) {
+            buffer = '0';
+        }
+        close(fd);
+    }
+    if ('0' == buffer) {
+        return true;
+    }
+
+#if defined PR_SET_PTRACER
+    /* try setting the ptrace scope to allow attach */
+    if (0 == prctl(PR_SET_PTRACER, PR_SET_PTRACER_ANY, 0, 0, 0)) {
+        return true;
+    }
+#endif
+
+    return false;
+}
+
+/*
+ * Read len bytes at remote_address in process pid.  process_vm_readv
+ * may return less than requested (see btl_sm_get.c), so loop, but a
+ * read of nothing would loop forever and is an error.
+ */
+static int cma_read(pid_t pid, void *local_address, uint64_t remote_address,
+                    size_t len)
+{
+    struct iovec src_iov = {.iov_base = (void *)(intptr_t) remote_address, .iov_len = len};
+    struct iovec dst_iov = {.iov_base = local_address, .iov_len = len};
+    ssize_t ret;
+
+    while (0 < src_iov.iov_len) {
+        ret = process_vm_readv(pid, &dst_iov, 1, &src_iov, 1, 0);
+        if (0 >= ret) {
+            opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                                "coll:sm: read %ld, expected %lu, errno = %d\n",
+                                (long) ret, (unsigned long) src_iov.iov_len, errno);
+            return OMPI_ERROR;
+        }
+        src_iov.iov_base = (void *)((char *) src_iov.iov_base + ret);
+        src_iov.iov_len -= ret;
+        dst_iov.iov_base = (void *)((char *) dst_iov.iov_base + ret);
+        dst_iov.iov_len -= ret;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Get a contiguous copy of count elements of dtype at buf to expose to
+ * the other processes: buf itself if the datatype is contiguous, a
+ * temporary buffer (returned in free_buffer) otherwise.
+ */
+static int cma_expose(struct ompi_datatype_t *dtype, size_t count,
+                      const void *buf, char **base, char **free_buffer)
+{
+    opal_convertor_t convertor;
+    ptrdiff_t true_lb, true_extent;
+    struct iovec iov;
+    uint32_t iov_count = 1;
+    size_t max_data;
+    int ret;
+
+    *free_buffer = NULL;
+    if (ompi_datatype_is_contiguous_memory_layout(dtype, count)) {
+        ompi_datatype_get_true_extent(dtype, &true_lb, &true_extent);
+        *base = (char*) buf + true_lb;
+        return OMPI_SUCCESS;
+    }
+
+    OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+    ret = opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor,
+                                                   &(dtype->super), count,
+                                                   buf, 0, &convertor);
+    if (OMPI_SUCCESS == ret) {
+        opal_convertor_get_packed_size(&convertor, &max_data);
+        *free_buffer = (char*) malloc(max_data);
+        if (NULL == *free_buffer) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+        } else {
+            iov.iov_base = *free_buffer;
+            iov.iov_len = max_data;
+            opal_convertor_pack(&convertor, &iov, &iov_count, &max_data);
+            *base = *free_buffer;
+        }
+    }
+    OBJ_DESTRUCT(&convertor);
+
+    return ret;
+}
+
+/*
+ * Read count elements of dtype exposed by another process to buf,
+ * directly if the datatype is contiguous, through a temporary buffer
+ * otherwise.
+ */
+static int cma_pull(const mca_coll_sm_cma_desc_t *desc,
+                    struct ompi_datatype_t *dtype, size_t count, void *buf)
+{
+    opal_convertor_t convertor;
+    ptrdiff_t true_lb, true_extent;
+    struct iovec iov;
+    uint32_t iov_count = 1;
+    size_t max_data;
+    char *free_buffer;
+    int ret;
+
+    if (OMPI_SUCCESS != desc->mcscd_error) {
+        return desc->mcscd_error;
+    }
+
+    ompi_datatype_type_size(dtype, &max_data);
+    max_data *= count;
+    if (0 == max_data) {
+        return OMPI_SUCCESS;
+    }
+
+    if (ompi_datatype_is_contiguous_memory_layout(dtype, count)) {
+        ompi_datatype_get_true_extent(dtype, &true_lb, &true_extent);
+        return cma_read(desc->mcscd_pid, (char*) buf + true_lb,
+                        desc->mcscd_addr, max_data);
+    }
+
+    free_buffer = (char*) malloc(max_data);
+    if (NULL == free_buffer) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    ret = cma_read(desc->mcscd_pid, free_buffer, desc->mcscd_addr, max_data);
+    if (OMPI_SUCCESS == ret) {
+        OBJ_CONSTRUCT(&convertor, opal_convertor_t);
+        ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                       &(dtype->super), count,
+                                                       buf, 0, &convertor);
+        if (OMPI_SUCCESS == ret) {
+            iov.iov_base = free_buffer;
+            iov.iov_len = max_data;
+            opal_convertor_unpack(&convertor, &iov, &iov_count, &max_data);
+        }
+        OBJ_DESTRUCT(&convertor);
+    }
+    free(free_buffer);
+
+    return ret;
+}
+
+static inline mca_coll_sm_cma_desc_t *
+cma_desc(mca_coll_sm_data_index_t *index, int rank)
+{
+    return (mca_coll_sm_cma_desc_t*)
+        (index->mcbmi_data + (rank * mca_coll_sm_component.sm_fragment_size));
+}
+
+/**
+ * Single copy broadcast: the root exposes its buffer and every other
+ * process reads it.
+ */
+int mca_coll_sm_bcast_single_copy(void *buff, int count,
+                                  struct ompi_datatype_t *datatype,
+                                  int root,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module)
+{
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data = sm_module->sm_comm_data;
+    mca_coll_sm_data_index_t *ready, *done;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_cma_desc_t *desc;
+    char *base = NULL, *free_buffer = NULL;
+    int ret = OMPI_SUCCESS, rank, size, peer, segment_num;
+    uint64_t num_frags = 1;
+    size_t len;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    /* On failure, the error is published instead of the buffer */
+    if (root == rank) {
+        ret = cma_expose(datatype, count, buff, &base, &free_buffer);
+    }
+
+    flag = mca_coll_sm_flag_acquire(data, root, rank, size, &num_frags,
+                                    &segment_num);
+    ready = &(data->mcb_data_index[segment_num]);
+    done = &(data->mcb_data_index[segment_num + 1]);
+
+    if (root == rank) {
+        desc = cma_desc(ready, root);
+        desc->mcscd_pid = getpid();
+        desc->mcscd_addr = (uint64_t)(uintptr_t) base;
+        desc->mcscd_error = ret;
+        opal_atomic_wmb();
+        for (peer = 0; peer < size; ++peer) {
+            if (peer != root) {
+                CHILD_NOTIFY_PARENT(root, peer, ready, 1);
+            }
+        }
+
+        /* Keep the buffer until everyone has read it */
+        for (peer = 0; peer < size; ++peer) {
+            if (peer != root) {
+                PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, root, done, len,
+                                                bcast_single_copy_done_label);
+            }
+        }
+        free(free_buffer);
+    } else {
+        PARENT_WAIT_FOR_NOTIFY_SPECIFIC(root, rank, ready, len,
+                                        bcast_single_copy_ready_label);
+        opal_atomic_rmb();
+        ret = cma_pull(cma_desc(ready, root), datatype, count, buff);
+
+        /* Tell the root even if the read failed so that it does not
+           hang */
+        CHILD_NOTIFY_PARENT(rank, root, done, 1);
+    }
+
+    opal_atomic_wmb();
+    FLAG_RELEASE(flag);
+
+    return ret;
+}
+
+/**
+ * Single copy allgatherv: every process exposes its buffer and reads
+ * the buffers of the others, starting with the next rank to spread
+ * the reads.
+ */
+int mca_coll_sm_allgatherv_single_copy(const void *sbuf, int scount,
+                                       struct ompi_datatype_t *sdtype,
+                                       void *rbuf, const int *rcounts,
+                                       const int *disps,
+                                       struct ompi_datatype_t *rdtype,
+                                       struct ompi_communicator_t *comm,
+                                       mca_coll_base_module_t *module)
+{
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_comm_t *data = sm_module->sm_comm_data;
+    mca_coll_sm_data_index_t *ready, *done;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_cma_desc_t *desc;
+    char *base = NULL, *free_buffer = NULL;
+    int i, ret, rank, size, peer, segment_num;
+    uint64_t num_frags = 1;
+    ptrdiff_t lb, extent;
+    size_t len;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+    ompi_datatype_get_extent(rdtype, &lb, &extent);
+
+    /* My own data is exposed from my block of the receive buffer with
+       MPI_IN_PLACE, copied there otherwise.  On failure, the error is
+       published instead of the buffer. */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = (char*) rbuf + disps[rank] * extent;
+        scount = rcounts[rank];
+        sdtype = rdtype;
+        ret = MPI_SUCCESS;
+    } else {
+        ret = ompi_datatype_sndrcv(sbuf, scount, sdtype,
+                                   (char*) rbuf + disps[rank] * extent,
+                                   rcounts[rank], rdtype);
+    }
+    if (MPI_SUCCESS == ret) {
+        ret = cma_expose(sdtype, scount, sbuf, &base, &free_buffer);
+    }
+
+    flag = mca_coll_sm_flag_acquire(data, 0, rank, size, &num_frags,
+                                    &segment_num);
+    ready = &(data->mcb_data_index[segment_num]);
+    done = &(data->mcb_data_index[segment_num + 1]);
+
+    desc = cma_desc(ready, rank);
+    desc->mcscd_pid = getpid();
+    desc->mcscd_addr = (uint64_t)(uintptr_t) base;
+    desc->mcscd_error = ret;
+    opal_atomic_wmb();
+    for (peer = 0; peer < size; ++peer) {
+        if (peer != rank) {
+            CHILD_NOTIFY_PARENT(rank, peer, ready, 1);
+        }
+    }
+
+    for (i = 1; i < size; ++i) {
+        int err;
+
+        peer = (rank + i) % size;
+        PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, rank, ready, len,
+                                        allgatherv_single_copy_ready_label);
+        opal_atomic_rmb();
+        err = cma_pull(cma_desc(ready, peer), rdtype, rcounts[peer],
+                       (char*) rbuf + disps[peer] * extent);
+        if (OMPI_SUCCESS == ret) {
+            ret = err;
+        }
+        CHILD_NOTIFY_PARENT(rank, peer, done, 1);
+    }
+
+    /* Keep my buffer until everyone has read it */
+    for (peer = 0; peer < size; ++peer) {
+        if (peer != rank) {
+            PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, rank, done, len,
+                                            allgatherv_single_copy_done_label);
+        }
+    }
+    free(free_buffer);
+
+    opal_atomic_wmb();
+    FLAG_RELEASE(flag);
+
+    return ret;
+}
+
+#endif /* OMPI_COLL_SM_HAVE_CMA */
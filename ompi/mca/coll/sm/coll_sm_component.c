@@ -152,6 +152,11 @@ static int sm_verify_mca_variables(void)
     cs->sm_segs_per_inuse_flag =
         cs->sm_comm_num_segments / cs->sm_comm_num_in_use_flags;
 
+    /* Single copy transfers use two segments of a set */
+    if (cs->sm_segs_per_inuse_flag < 2) {
+        cs->sm_single_copy_threshold = 0;
+    }
+
     if (cs->sm_tree_degree > cs->sm_control_size) {
         opal_show_help("help-mpi-coll-sm.txt",
                        "tree-degree-larger-than-control", true,
@@ -231,6 +236,16 @@ static int sm_register(void)
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &cs->sm_tree_degree);
 
+#if OMPI_COLL_SM_HAVE_CMA
+    cs->sm_single_copy_threshold = 1048576;
+    (void) mca_base_component_var_register(c, "single_copy_threshold",
+                                           "Minimum size (in bytes) of the messages of bcast and of the largest block of allgather(v) read directly from the buffer of the sending process with Linux Cross Memory Attach instead of going through the shared memory fragments (0 = disabled)",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &cs->sm_single_copy_threshold);
+#endif
+
     /* INFO: Calculate how much space we need in the per-communicator
        shmem data segment.  This formula taken directly from
        coll_sm_module.c. */
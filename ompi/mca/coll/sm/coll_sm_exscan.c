@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -21,15 +23,12 @@
 #include "ompi_config.h"
 
 #include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
 #include "coll_sm.h"
 
 
-/*
- *	exscan_intra
- *
- *	Function:	- basic exscan operation
- *	Accepts:	- same arguments as MPI_Exscan()
- *	Returns:	- MPI_SUCCESS or error code
+/**
+ * Shared memory exscan (see coll_sm_scan.c).
  */
 int mca_coll_sm_exscan_intra(const void *sbuf, void *rbuf, int count,
                              struct ompi_datatype_t *dtype,
@@ -37,5 +36,20 @@ int mca_coll_sm_exscan_intra(const void *sbuf, void *rbuf, int count,
                              struct ompi_communicator_t *comm,
                              mca_coll_base_module_t *module)
 {
-  return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    size_t size;
+
+    /* Fall back to the underlying module if the datatype is larger
+       than a fragment */
+    ompi_datatype_type_size(dtype, &size);
+    if (0 == size || size > (size_t) mca_coll_sm_component.sm_fragment_size) {
+        if (NULL == sm_module->previous_exscan) {
+            return OMPI_ERR_NOT_SUPPORTED;
+        }
+        return sm_module->previous_exscan(sbuf, rbuf, count, dtype, op, comm,
+                                          sm_module->previous_exscan_module);
+    }
+
+    return mca_coll_sm_scan_flat(sbuf, rbuf, count, dtype, op, true,
+                                 comm, module);
 }
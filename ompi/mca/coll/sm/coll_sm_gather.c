@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,16 +22,18 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
 #include "coll_sm.h"
 
 
-/*
- *      gather
+/**
+ * Shared memory gather.
  *
- *      Function:       - shared memory gather
- *      Accepts:        - same as MPI_Gather()
- *      Returns:        - MPI_SUCCESS or error code
+ * Gather is a gatherv where all the processes send the same amount of
+ * data (see coll_sm_gatherv.c).
  */
 int mca_coll_sm_gather_intra(const void *sbuf, int scount,
                              struct ompi_datatype_t *sdtype, void *rbuf,
@@ -37,5 +41,25 @@ int mca_coll_sm_gather_intra(const void *sbuf, int scount,
                              int root, struct ompi_communicator_t *comm,
                              mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, size = ompi_comm_size(comm);
+    int *rcounts = NULL, *disps = NULL;
+
+    /* Only the root uses the counts and displacements */
+    if (root == ompi_comm_rank(comm)) {
+        rcounts = (int*) malloc(2 * size * sizeof(int));
+        if (NULL == rcounts) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        disps = rcounts + size;
+        for (i = 0; i < size; ++i) {
+            rcounts[i] = rcount;
+            disps[i] = i * rcount;
+        }
+    }
+
+    ret = mca_coll_sm_gatherv_intra(sbuf, scount, sdtype, rbuf, rcounts,
+                                    disps, rdtype, root, comm, module);
+
+    free(rcounts);
+    return ret;
 }
@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,23 +22,155 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
 #include "coll_sm.h"
 
 
-/*
- *	gatherv_intra
+/**
+ * Shared memory gatherv.
  *
- *	Function:	- basic gatherv operation
- *	Accepts:	- same arguments as MPI_Gatherb()
- *	Returns:	- MPI_SUCCESS or error code
+ * Flat algorithm (see coll_sm_stream.c): every non-root process packs
+ * the fragments of its buffer in its own slot of consecutive segments
+ * and notifies the root, which unpacks them straight from the slots
+ * to its receive buffer.  The root claims the sets of segments and
+ * publishes the number of fragments, computed from the largest count
+ * it receives, so that the non-root processes do not need to know
+ * the counts of the others.
  */
 int mca_coll_sm_gatherv_intra(const void *sbuf, int scount,
-                              struct ompi_datatype_t *sdtype,
-                              void *rbuf, const int *rcounts, const int *disps,
+                              struct ompi_datatype_t *sdtype, void *rbuf,
+                              const int *rcounts, const int *disps,
                               struct ompi_datatype_t *rdtype, int root,
                               struct ompi_communicator_t *comm,
                               mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_stream_t *streams = NULL, stream;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_data_index_t *index;
+    mca_coll_sm_comm_t *data;
+    int i, ret, rank, size, peer, segment_num, max_segment_num;
+    uint64_t frag = 0, num_frags = 0;
+    size_t len;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    /* The root needs a receive convertor for each of the other
+       processes, the others a single send convertor */
+
+    if (root == rank) {
+        size_t type_size, max_bytes = 0;
+        ptrdiff_t lb, extent;
+
+        streams = (mca_coll_sm_stream_t*)
+            malloc(size * sizeof(mca_coll_sm_stream_t));
+        if (NULL == streams) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        ompi_datatype_get_extent(rdtype, &lb, &extent);
+        ompi_datatype_type_size(rdtype, &type_size);
+
+        for (peer = 0; peer < size; ++peer) {
+            if (peer == root) {
+                continue;
+            }
+            mca_coll_sm_stream_init_recv(&streams[peer], rdtype, rcounts[peer],
+                                         (char*) rbuf + disps[peer] * extent);
+            if (max_bytes < rcounts[peer] * type_size) {
+                max_bytes = rcounts[peer] * type_size;
+            }
+        }
+        num_frags = (max_bytes + mca_coll_sm_component.sm_fragment_size - 1) /
+            mca_coll_sm_component.sm_fragment_size;
+
+        /* Copy my own data */
+        if (MPI_IN_PLACE != sbuf) {
+            ret = ompi_datatype_sndrcv(sbuf, scount, sdtype,
+                                       (char*) rbuf + disps[rank] * extent,
+                                       rcounts[rank], rdtype);
+            if (MPI_SUCCESS != ret) {
+                goto cleanup;
+            }
+        }
+    } else {
+        ret = mca_coll_sm_stream_init_send(&stream, sdtype, scount, sbuf);
+        if (OMPI_SUCCESS != ret) {
+            mca_coll_sm_stream_fini(&stream);
+            return ret;
+        }
+    }
+
+    /* Main loop over the sets of segments (there is at least one,
+       non-root processes only know the number of fragments once they
+       got one) */
+
+    do {
+        flag = mca_coll_sm_flag_acquire(data, root, rank, size, &num_frags,
+                                        &segment_num);
+        max_segment_num = segment_num +
+            mca_coll_sm_component.sm_segs_per_inuse_flag;
+
+        for ( ; frag < num_frags && segment_num < max_segment_num;
+              ++frag, ++segment_num) {
+            index = &(data->mcb_data_index[segment_num]);
+
+            if (root == rank) {
+                /* Copy the fragments of the processes still sending
+                   data to my output buffer */
+                for (i = 1; i < size; ++i) {
+                    peer = (root + i) % size;
+                    if (0 == streams[peer].mcss_remaining) {
+                        continue;
+                    }
+                    PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, root, index, len,
+                                                    gatherv_root_label);
+                    opal_atomic_rmb();
+                    mca_coll_sm_stream_unpack(&streams[peer], index, peer, len);
+                }
+            } else if (0 != (len = mca_coll_sm_stream_pack(&stream, index, rank))) {
+                /* Wait for the write to absolutely complete */
+                opal_atomic_wmb();
+
+                /* Tell the root that this fragment is ready */
+                CHILD_NOTIFY_PARENT(rank, root, index, len);
+            }
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    } while (frag < num_frags);
+
+    ret = OMPI_SUCCESS;
+
+ cleanup:
+    if (root == rank) {
+        for (peer = 0; peer < size; ++peer) {
+            if (peer != root) {
+                mca_coll_sm_stream_fini(&streams[peer]);
+            }
+        }
+        free(streams);
+    } else {
+        mca_coll_sm_stream_fini(&stream);
+    }
+
+    return ret;
 }
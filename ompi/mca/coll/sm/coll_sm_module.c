@@ -90,6 +90,10 @@ static void mca_coll_sm_module_construct(mca_coll_sm_module_t *module)
     module->sm_comm_data = NULL;
     module->previous_reduce = NULL;
     module->previous_reduce_module = NULL;
+    module->previous_scan = NULL;
+    module->previous_scan_module = NULL;
+    module->previous_exscan = NULL;
+    module->previous_exscan_module = NULL;
     module->super.coll_module_disable = mca_coll_sm_module_disable;
 }
 
@@ -115,6 +119,12 @@ static void mca_coll_sm_module_destruct(mca_coll_sm_module_t *module)
     if (NULL != module->previous_reduce_module) {
         OBJ_RELEASE(module->previous_reduce_module);
     }
+    if (NULL != module->previous_scan_module) {
+        OBJ_RELEASE(module->previous_scan_module);
+    }
+    if (NULL != module->previous_exscan_module) {
+        OBJ_RELEASE(module->previous_exscan_module);
+    }
 
     module->enabled = false;
 }
@@ -130,6 +140,16 @@ static int mca_coll_sm_module_disable(mca_coll_base_module_t *module, struct omp
         OBJ_RELEASE(sm_module->previous_reduce_module);
 	sm_module->previous_reduce_module = NULL;
     }
+    if (NULL != sm_module->previous_scan_module) {
+        sm_module->previous_scan = NULL;
+        OBJ_RELEASE(sm_module->previous_scan_module);
+        sm_module->previous_scan_module = NULL;
+    }
+    if (NULL != sm_module->previous_exscan_module) {
+        sm_module->previous_exscan = NULL;
+        OBJ_RELEASE(sm_module->previous_exscan_module);
+        sm_module->previous_exscan_module = NULL;
+    }
     return OMPI_SUCCESS;
 }
 
@@ -152,6 +172,17 @@ int mca_coll_sm_init_query(bool enable_progress_threads,
     if (NULL == ompi_process_info.job_session_dir) {
         return OMPI_ERR_OUT_OF_RESOURCE;
     }
+
+#if OMPI_COLL_SM_HAVE_CMA
+    /* Make sure that the other processes can read our buffers */
+    if (0 != mca_coll_sm_component.sm_single_copy_threshold &&
+        !mca_coll_sm_cma_init()) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:sm:init_query: cannot allow the other processes to read my memory; disabling single copy transfers");
+        mca_coll_sm_component.sm_single_copy_threshold = 0;
+    }
+#endif
+
     /* Don't do much here because we don't really want to allocate any
        shared memory until this component is selected to be used. */
     opal_output_verbose(10, ompi_coll_base_framework.framework_output,
@@ -196,22 +227,35 @@ mca_coll_sm_comm_query(struct ompi_communicator_t *comm, int *priority)
     /* All is good -- return a module */
     sm_module->super.coll_module_enable = sm_module_enable;
     sm_module->super.ft_event        = mca_coll_sm_ft_event;
-    sm_module->super.coll_allgather  = NULL;
-    sm_module->super.coll_allgatherv = NULL;
     sm_module->super.coll_allreduce  = mca_coll_sm_allreduce_intra;
-    sm_module->super.coll_alltoall   = NULL;
-    sm_module->super.coll_alltoallv  = NULL;
-    sm_module->super.coll_alltoallw  = NULL;
     sm_module->super.coll_barrier    = mca_coll_sm_barrier_intra;
     sm_module->super.coll_bcast      = mca_coll_sm_bcast_intra;
-    sm_module->super.coll_exscan     = NULL;
-    sm_module->super.coll_gather     = NULL;
-    sm_module->super.coll_gatherv    = NULL;
     sm_module->super.coll_reduce     = mca_coll_sm_reduce_intra;
-    sm_module->super.coll_reduce_scatter = NULL;
-    sm_module->super.coll_scan       = NULL;
-    sm_module->super.coll_scatter    = NULL;
-    sm_module->super.coll_scatterv   = NULL;
+
+    /* The flat collectives notify the consumers of a fragment through
+       one slot per process in their control buffers (and alltoallv/w
+       agree on their number of fragments through the slots after the
+       in-use flags).  Leave them to the other components if the
+       communicator is too large for the control size. */
+    if (MCA_COLL_SM_FLAG_SLOTS_OFFSET + ompi_comm_size(comm) * sizeof(size_t) >
+        (size_t) mca_coll_sm_component.sm_control_size) {
+        opal_output_verbose(10, ompi_coll_base_framework.framework_output,
+                            "coll:sm:comm_query (%d/%s): comm is too large for the control size; only providing barrier, bcast, reduce and allreduce", comm->c_contextid, comm->c_name);
+    } else {
+        sm_module->super.coll_allgather  = mca_coll_sm_allgather_intra;
+        sm_module->super.coll_allgatherv = mca_coll_sm_allgatherv_intra;
+        sm_module->super.coll_alltoall   = mca_coll_sm_alltoall_intra;
+        sm_module->super.coll_alltoallv  = mca_coll_sm_alltoallv_intra;
+        sm_module->super.coll_alltoallw  = mca_coll_sm_alltoallw_intra;
+        sm_module->super.coll_exscan     = mca_coll_sm_exscan_intra;
+        sm_module->super.coll_gather     = mca_coll_sm_gather_intra;
+        sm_module->super.coll_gatherv    = mca_coll_sm_gatherv_intra;
+        sm_module->super.coll_reduce_scatter = mca_coll_sm_reduce_scatter_intra;
+        sm_module->super.coll_reduce_scatter_block = mca_coll_sm_reduce_scatter_block_intra;
+        sm_module->super.coll_scan       = mca_coll_sm_scan_intra;
+        sm_module->super.coll_scatter    = mca_coll_sm_scatter_intra;
+        sm_module->super.coll_scatterv   = mca_coll_sm_scatterv_intra;
+    }
 
     opal_output_verbose(10, ompi_coll_base_framework.framework_output,
                         "coll:sm:comm_query (%d/%s): pick me! pick me!",
@@ -226,6 +270,8 @@ mca_coll_sm_comm_query(struct ompi_communicator_t *comm, int *priority)
 static int sm_module_enable(mca_coll_base_module_t *module,
                             struct ompi_communicator_t *comm)
 {
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+
     if (NULL == comm->c_coll->coll_reduce ||
         NULL == comm->c_coll->coll_reduce_module) {
         opal_output_verbose(10, ompi_coll_base_framework.framework_output,
@@ -234,6 +280,24 @@ static int sm_module_enable(mca_coll_base_module_t *module,
         return OMPI_ERROR;
     }
 
+    /* Save the previous component's reduce, scan and exscan now: once
+       we are enabled, the communicator points to our own functions.
+       Scan and exscan only use them for datatypes larger than a
+       fragment, so they are optional. */
+    sm_module->previous_reduce = comm->c_coll->coll_reduce;
+    sm_module->previous_reduce_module = comm->c_coll->coll_reduce_module;
+    OBJ_RETAIN(sm_module->previous_reduce_module);
+    sm_module->previous_scan = comm->c_coll->coll_scan;
+    sm_module->previous_scan_module = comm->c_coll->coll_scan_module;
+    if (NULL != sm_module->previous_scan_module) {
+        OBJ_RETAIN(sm_module->previous_scan_module);
+    }
+    sm_module->previous_exscan = comm->c_coll->coll_exscan;
+    sm_module->previous_exscan_module = comm->c_coll->coll_exscan_module;
+    if (NULL != sm_module->previous_exscan_module) {
+        OBJ_RETAIN(sm_module->previous_exscan_module);
+    }
+
     /* We do everything lazily in ompi_coll_sm_enable() */
     return OMPI_SUCCESS;
 }
@@ -459,11 +523,6 @@ int ompi_coll_sm_lazy_enable(mca_coll_base_module_t *module,
                c->sm_control_size);
     }
 
-    /* Save previous component's reduce information */
-    sm_module->previous_reduce = comm->c_coll->coll_reduce;
-    sm_module->previous_reduce_module = comm->c_coll->coll_reduce_module;
-    OBJ_RETAIN(sm_module->previous_reduce_module);
-
     /* Indicate that we have successfully attached and setup */
     opal_atomic_add (&(data->sm_bootstrap_meta->module_seg->seg_inited), 1);
 
@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,16 +22,233 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/op/op.h"
 #include "coll_sm.h"
 
 
+/**
+ * Shared memory reduce_scatter, ring algorithm.
+ *
+ * Each process reduces in a temporary copy of its input vector.  In
+ * size - 1 steps, at step k, each process packs the fragments of its
+ * partial result for block (rank - k - 1) in the slot of process
+ * (rank + 1) in consecutive segments, and reduces the fragments of
+ * block (rank - k - 2) sent by process (rank - 1) into its own partial
+ * result as they arrive, so after the last step it holds the complete
+ * reduction of its block.  Fragments are made of an integer number of
+ * datatypes, reduced directly from the segments when the datatype is
+ * the same packed as it is unpacked (through a temporary buffer
+ * otherwise, see coll_sm_scan.c).  Fragments flow through the ring as
+ * soon as they are ready, so each process moves one block at a time
+ * instead of the whole vector going through rank 0.  All the steps use
+ * the number of fragments of the largest block, which every process
+ * knows from rcounts.  Rank 0 claims the sets of segments.
+ *
+ * The blocks are combined in ring order starting after their owner,
+ * so the operation must be commutative.
+ */
+int mca_coll_sm_reduce_scatter_ring(const void *sbuf, void *rbuf, const int *rcounts,
+                                    struct ompi_datatype_t *dtype,
+                                    struct ompi_op_t *op,
+                                    struct ompi_communicator_t *comm,
+                                    mca_coll_base_module_t *module)
+{
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_stream_t send_stream;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_data_index_t *index;
+    mca_coll_sm_comm_t *data;
+    opal_convertor_t rtb_convertor;
+    char *accum = NULL, *free_accum = NULL, *reduce_temp_buffer = NULL;
+    char *free_buffer = NULL, *reduce_target;
+    int i, ret, rank, size, dst, src, step = 0, recv_block = 0;
+    int segment_num, max_segment_num;
+    uint64_t frag = 0, num_frags, step_frags, step_frag;
+    size_t len, ddt_size, segment_ddt_count, count = 0, max_count = 0;
+    size_t count_left, zero = 0;
+    ptrdiff_t extent, gap, *disps;
+    struct iovec iov;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+    dst = (rank + 1) % size;
+    src = (rank - 1 + size) % size;
+
+    ompi_datatype_type_size(dtype, &ddt_size);
+    ompi_datatype_type_extent(dtype, &extent);
+    segment_ddt_count = mca_coll_sm_component.sm_fragment_size / ddt_size;
+
+    disps = (ptrdiff_t*) malloc(size * sizeof(ptrdiff_t));
+    if (NULL == disps) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    for (i = 0; i < size; ++i) {
+        disps[i] = (ptrdiff_t) count * extent;
+        count += rcounts[i];
+        if (max_count < (size_t) rcounts[i]) {
+            max_count = rcounts[i];
+        }
+    }
+    step_frags = (max_count + segment_ddt_count - 1) / segment_ddt_count;
+    num_frags = step_frags * (size - 1);
+
+    /* With MPI_IN_PLACE the contribution of every process is in its
+       receive buffer, it is only overwritten once all the blocks are
+       reduced */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+    }
+    if (0 != count) {
+        free_accum = (char*) malloc(opal_datatype_span(&dtype->super, count, &gap));
+        if (NULL == free_accum) {
+            free(disps);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        accum = free_accum - gap;
+        ret = ompi_datatype_copy_content_same_ddt(dtype, count, accum, (char*) sbuf);
+        if (MPI_SUCCESS != ret) {
+            free(free_accum);
+            free(disps);
+            return ret;
+        }
+    }
+
+    OBJ_CONSTRUCT(&rtb_convertor, opal_convertor_t);
+
+    /* If the datatype is not the same packed as it is unpacked, unpack
+       the fragments to a temporary buffer before reducing them (see
+       the comments in coll_sm_reduce.c) */
+    if (!ompi_datatype_is_contiguous_memory_layout(dtype, max_count)) {
+        free_buffer = (char*) malloc(opal_datatype_span(&dtype->super, segment_ddt_count, &gap));
+        if (NULL == free_buffer) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto cleanup;
+        }
+        reduce_temp_buffer = free_buffer - gap;
+        ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                       &(dtype->super),
+                                                       segment_ddt_count,
+                                                       reduce_temp_buffer, 0,
+                                                       &rtb_convertor);
+        if (OMPI_SUCCESS != ret) {
+            goto cleanup;
+        }
+    }
+
+    /* Main loop over the sets of segments */
+
+    do {
+        flag = mca_coll_sm_flag_acquire(data, 0, rank, size, &num_frags,
+                                        &segment_num);
+        max_segment_num = segment_num +
+            mca_coll_sm_component.sm_segs_per_inuse_flag;
+
+        for ( ; frag < num_frags && segment_num < max_segment_num;
+              ++frag, ++segment_num) {
+            index = &(data->mcb_data_index[segment_num]);
+            step_frag = frag % step_frags;
+
+            /* Switch to the blocks of the next step: send the block
+               completed during the previous one */
+            if (0 == step_frag) {
+                int send_block = (rank - step - 1 + size) % size;
+
+                if (0 != step) {
+                    mca_coll_sm_stream_fini(&send_stream);
+                }
+                mca_coll_sm_stream_init_send(&send_stream, dtype, rcounts[send_block],
+                                             accum + disps[send_block]);
+                send_stream.mcss_frag_len = segment_ddt_count * ddt_size;
+                recv_block = (rank - step - 2 + 2 * size) % size;
+                ++step;
+            }
+
+            /* Copy my next fragment for dst in its slot and tell it
+               that it is ready */
+            if (0 != (len = mca_coll_sm_stream_pack(&send_stream, index, dst))) {
+                opal_atomic_wmb();
+                CHILD_NOTIFY_PARENT(rank, dst, index, len);
+            }
+
+            /* Reduce the fragment of src into my partial result */
+            if ((size_t) rcounts[recv_block] <= step_frag * segment_ddt_count) {
+                continue;
+            }
+            count_left = rcounts[recv_block] - step_frag * segment_ddt_count;
+            if (count_left > segment_ddt_count) {
+                count_left = segment_ddt_count;
+            }
+            reduce_target = accum + disps[recv_block] +
+                (ptrdiff_t) (step_frag * segment_ddt_count) * extent;
+
+            PARENT_WAIT_FOR_NOTIFY_SPECIFIC(src, rank, index, len,
+                                            reduce_scatter_label);
+            opal_atomic_rmb();
+            if (NULL == free_buffer) {
+                ompi_op_reduce(op, index->mcbmi_data +
+                               (rank * mca_coll_sm_component.sm_fragment_size),
+                               reduce_target, count_left, dtype);
+            } else {
+                COPY_FRAGMENT_OUT(rtb_convertor, rank, index, iov, len);
+                opal_convertor_set_position(&rtb_convertor, &zero);
+                ompi_op_reduce(op, reduce_temp_buffer, reduce_target,
+                               count_left, dtype);
+            }
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    } while (frag < num_frags);
+
+    if (0 != step) {
+        mca_coll_sm_stream_fini(&send_stream);
+    }
+
+    ret = OMPI_SUCCESS;
+    if (0 != rcounts[rank]) {
+        ret = ompi_datatype_copy_content_same_ddt(dtype, rcounts[rank], (char*) rbuf,
+                                                  accum + disps[rank]);
+    }
+
+ cleanup:
+    OBJ_DESTRUCT(&rtb_convertor);
+    free(free_buffer);
+    free(free_accum);
+    free(disps);
+
+    return ret;
+}
+
 /*
  *	reduce_scatter
  *
  *	Function:	- reduce then scatter
  *	Accepts:	- same as MPI_Reduce_scatter()
  *	Returns:	- MPI_SUCCESS or error code
+ *
+ * Ring algorithm above for commutative operations on datatypes fitting
+ * in a fragment.  Otherwise, reduce to root==0 in a temporary buffer
+ * (the reduce combines the contributions in rank order) and then
+ * scatterv, like allreduce.
  */
 int mca_coll_sm_reduce_scatter_intra(const void *sbuf, void *rbuf, const int *rcounts,
                                      struct ompi_datatype_t *dtype,
@@ -37,5 +256,60 @@ int mca_coll_sm_reduce_scatter_intra(const void *sbuf, void *rbuf, const int *rc
                                      struct ompi_communicator_t *comm,
                                      mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, rank, size, count = 0, *disps = NULL;
+    char *free_buffer = NULL, *tmp_buffer = NULL;
+    size_t ddt_size;
+    ptrdiff_t gap;
+
+    ompi_datatype_type_size(dtype, &ddt_size);
+    if (ompi_op_is_commute(op) && 0 != ddt_size &&
+        ddt_size <= (size_t) mca_coll_sm_component.sm_fragment_size) {
+        return mca_coll_sm_reduce_scatter_ring(sbuf, rbuf, rcounts, dtype, op,
+                                               comm, module);
+    }
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    /* With MPI_IN_PLACE the contribution of every process is in its
+       receive buffer; none of them reduces in place since the result
+       goes to a temporary buffer. */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+    }
+
+    if (0 == rank) {
+        disps = (int*) malloc(size * sizeof(int));
+        if (NULL == disps) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (i = 0; i < size; ++i) {
+            disps[i] = count;
+            count += rcounts[i];
+        }
+        if (0 != count) {
+            free_buffer = (char*) malloc(opal_datatype_span(&dtype->super, count, &gap));
+            if (NULL == free_buffer) {
+                free(disps);
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+            tmp_buffer = free_buffer - gap;
+        }
+    } else {
+        for (i = 0; i < size; ++i) {
+            count += rcounts[i];
+        }
+    }
+
+    ret = mca_coll_sm_reduce_intra(sbuf, tmp_buffer, count, dtype, op, 0,
+                                   comm, module);
+    if (OMPI_SUCCESS == ret) {
+        ret = mca_coll_sm_scatterv_intra(tmp_buffer, rcounts, disps, dtype,
+                                         rbuf, rcounts[rank], dtype, 0,
+                                         comm, module);
+    }
+
+    free(free_buffer);
+    free(disps);
+    return ret;
 }
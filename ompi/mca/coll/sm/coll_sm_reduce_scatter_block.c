@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <stdlib.h>
+
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
+#include "coll_sm.h"
+
+
+/*
+ *	reduce_scatter_block
+ *
+ *	Function:	- reduce then scatter
+ *	Accepts:	- same as MPI_Reduce_scatter_block()
+ *	Returns:	- MPI_SUCCESS or error code
+ *
+ * Same as reduce_scatter (see coll_sm_reduce_scatter.c): ring
+ * algorithm for commutative operations on datatypes fitting in a
+ * fragment, reduce to root==0 in a temporary buffer and then scatter
+ * otherwise.
+ */
+int mca_coll_sm_reduce_scatter_block_intra(const void *sbuf, void *rbuf, int rcount,
+                                           struct ompi_datatype_t *dtype,
+                                           struct ompi_op_t *op,
+                                           struct ompi_communicator_t *comm,
+                                           mca_coll_base_module_t *module)
+{
+    int i, ret, size = ompi_comm_size(comm), count = rcount * size, *rcounts;
+    char *free_buffer = NULL, *tmp_buffer = NULL;
+    size_t ddt_size;
+    ptrdiff_t gap;
+
+    ompi_datatype_type_size(dtype, &ddt_size);
+    if (ompi_op_is_commute(op) && 0 != ddt_size &&
+        ddt_size <= (size_t) mca_coll_sm_component.sm_fragment_size) {
+        rcounts = (int*) malloc(size * sizeof(int));
+        if (NULL == rcounts) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (i = 0; i < size; ++i) {
+            rcounts[i] = rcount;
+        }
+        ret = mca_coll_sm_reduce_scatter_ring(sbuf, rbuf, rcounts, dtype, op,
+                                              comm, module);
+        free(rcounts);
+        return ret;
+    }
+
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+    }
+
+    if (0 == ompi_comm_rank(comm) && 0 != count) {
+        free_buffer = (char*) malloc(opal_datatype_span(&dtype->super, count, &gap));
+        if (NULL == free_buffer) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        tmp_buffer = free_buffer - gap;
+    }
+
+    ret = mca_coll_sm_reduce_intra(sbuf, tmp_buffer, count, dtype, op, 0,
+                                   comm, module);
+    if (OMPI_SUCCESS == ret) {
+        ret = mca_coll_sm_scatter_intra(tmp_buffer, rcount, dtype,
+                                        rbuf, rcount, dtype, 0,
+                                        comm, module);
+    }
+
+    free(free_buffer);
+    return ret;
+}
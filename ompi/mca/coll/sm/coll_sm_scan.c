@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,15 +22,204 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
+#include "ompi/op/op.h"
 #include "coll_sm.h"
 
 
+/**
+ * Shared memory (exclusive) scan.
+ *
+ * Flat algorithm (see coll_sm_stream.c): every process packs the
+ * fragments of its buffer in its own slot of consecutive segments and
+ * notifies all the processes with a higher rank.  Fragments are made
+ * of an integer number of datatypes (the caller checked that the
+ * datatype fits in a fragment), so that each process can combine the
+ * fragments of the lower ranks in order -- (0 operation (1 operation
+ * (... operation rank))) -- into the same fragment of its receive
+ * buffer, directly from the shared memory segments if the datatype is
+ * the same packed as it is unpacked, through a temporary buffer
+ * otherwise.  Rank 0 claims the sets of segments.
+ */
+int mca_coll_sm_scan_flat(const void *sbuf, void *rbuf, int count,
+                          struct ompi_datatype_t *dtype,
+                          struct ompi_op_t *op, bool exclusive,
+                          struct ompi_communicator_t *comm,
+                          mca_coll_base_module_t *module)
+{
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    mca_coll_sm_stream_t send_stream, first_stream;
+    mca_coll_sm_in_use_flag_t *flag;
+    mca_coll_sm_data_index_t *index;
+    mca_coll_sm_comm_t *data;
+    opal_convertor_t rtb_convertor;
+    char *reduce_temp_buffer = NULL, *free_buffer = NULL, *reduce_target;
+    int i, ret, rank, size, peer, segment_num, max_segment_num;
+    uint64_t frag = 0, num_frags;
+    size_t len, ddt_size, segment_ddt_count, count_left, zero = 0;
+    ptrdiff_t extent, gap;
+    struct iovec iov;
+
+    /* Lazily enable the module the first time we invoke a collective
+       on it */
+    if (!sm_module->enabled) {
+        if (OMPI_SUCCESS != (ret = ompi_coll_sm_lazy_enable(module, comm))) {
+            return ret;
+        }
+    }
+    data = sm_module->sm_comm_data;
+
+    rank = ompi_comm_rank(comm);
+    size = ompi_comm_size(comm);
+
+    ompi_datatype_type_size(dtype, &ddt_size);
+    ompi_datatype_type_extent(dtype, &extent);
+    segment_ddt_count = mca_coll_sm_component.sm_fragment_size / ddt_size;
+    num_frags = (count + segment_ddt_count - 1) / segment_ddt_count;
+
+    OBJ_CONSTRUCT(&rtb_convertor, opal_convertor_t);
+
+    /* My contribution is in my receive buffer with MPI_IN_PLACE.  For
+       scan it is the first operand of my result, so start from it. */
+    if (MPI_IN_PLACE == sbuf) {
+        sbuf = rbuf;
+    } else if (!exclusive) {
+        ret = ompi_datatype_copy_content_same_ddt(dtype, count, (char*) rbuf,
+                                                  (char*) sbuf);
+        if (MPI_SUCCESS != ret) {
+            OBJ_DESTRUCT(&rtb_convertor);
+            return ret;
+        }
+    }
+
+    /* Streams of my contribution (only needed if some process has a
+       higher rank) and, for exscan, of the contribution of (rank - 1)
+       which is the first operand of my result */
+    if (size - 1 != rank) {
+        ret = mca_coll_sm_stream_init_send(&send_stream, dtype, count, sbuf);
+        if (OMPI_SUCCESS != ret) {
+            mca_coll_sm_stream_fini(&send_stream);
+            OBJ_DESTRUCT(&rtb_convertor);
+            return ret;
+        }
+        send_stream.mcss_frag_len = segment_ddt_count * ddt_size;
+    }
+    if (exclusive && 0 != rank) {
+        ret = mca_coll_sm_stream_init_recv(&first_stream, dtype, count, rbuf);
+        if (OMPI_SUCCESS != ret) {
+            goto cleanup;
+        }
+    }
+
+    /* If the datatype is not the same packed as it is unpacked, unpack
+       the fragments to a temporary buffer before combining them (see
+       the comments in coll_sm_reduce.c) */
+    if (!ompi_datatype_is_contiguous_memory_layout(dtype, count)) {
+        free_buffer = (char*) malloc(opal_datatype_span(&dtype->super, segment_ddt_count, &gap));
+        if (NULL == free_buffer) {
+            ret = OMPI_ERR_OUT_OF_RESOURCE;
+            goto cleanup;
+        }
+        reduce_temp_buffer = free_buffer - gap;
+        ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                       &(dtype->super),
+                                                       segment_ddt_count,
+                                                       reduce_temp_buffer, 0,
+                                                       &rtb_convertor);
+        if (OMPI_SUCCESS != ret) {
+            goto cleanup;
+        }
+    }
+
+    /* Main loop over the sets of segments */
+
+    do {
+        flag = mca_coll_sm_flag_acquire(data, 0, rank, size, &num_frags,
+                                        &segment_num);
+        max_segment_num = segment_num +
+            mca_coll_sm_component.sm_segs_per_inuse_flag;
+
+        for ( ; frag < num_frags && segment_num < max_segment_num;
+              ++frag, ++segment_num) {
+            index = &(data->mcb_data_index[segment_num]);
+
+            /* Copy my next fragment in my slot and tell the higher
+               ranks that it is ready */
+            if (size - 1 != rank &&
+                0 != (len = mca_coll_sm_stream_pack(&send_stream, index, rank))) {
+                opal_atomic_wmb();
+                for (i = rank + 1; i < size; ++i) {
+                    CHILD_NOTIFY_PARENT(rank, i, index, len);
+                }
+            }
+
+            count_left = count - frag * segment_ddt_count;
+            if (count_left > segment_ddt_count) {
+                count_left = segment_ddt_count;
+            }
+            reduce_target = (char*) rbuf + frag * segment_ddt_count * extent;
+
+            peer = rank - 1;
+            if (exclusive && 0 != rank) {
+                /* The fragment of (rank - 1) is the first operand */
+                PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, rank, index, len,
+                                                scan_first_label);
+                opal_atomic_rmb();
+                mca_coll_sm_stream_unpack(&first_stream, index, peer, len);
+                --peer;
+            }
+
+            /* Combine the fragments of the lower ranks in order */
+            for ( ; peer >= 0; --peer) {
+                PARENT_WAIT_FOR_NOTIFY_SPECIFIC(peer, rank, index, len,
+                                                scan_reduce_label);
+                opal_atomic_rmb();
+                if (NULL == free_buffer) {
+                    ompi_op_reduce(op, index->mcbmi_data +
+                                   (peer * mca_coll_sm_component.sm_fragment_size),
+                                   reduce_target, count_left, dtype);
+                } else {
+                    COPY_FRAGMENT_OUT(rtb_convertor, peer, index, iov, len);
+                    opal_convertor_set_position(&rtb_convertor, &zero);
+                    ompi_op_reduce(op, reduce_temp_buffer, reduce_target,
+                                   count_left, dtype);
+                }
+            }
+        }
+
+        /* Wait for all copy-out writes to complete before I say I'm
+           done with the segments */
+        opal_atomic_wmb();
+        FLAG_RELEASE(flag);
+    } while (frag < num_frags);
+
+    ret = OMPI_SUCCESS;
+
+ cleanup:
+    OBJ_DESTRUCT(&rtb_convertor);
+    free(free_buffer);
+    if (exclusive && 0 != rank) {
+        mca_coll_sm_stream_fini(&first_stream);
+    }
+    if (size - 1 != rank) {
+        mca_coll_sm_stream_fini(&send_stream);
+    }
+
+    return ret;
+}
+
 /*
  *	scan
  *
- *	Function:	- basic scan operation
- *	Accepts:	- same arguments as MPI_Scan()
+ *	Function:	- scan
+ *	Accepts:	- same as MPI_Scan()
  *	Returns:	- MPI_SUCCESS or error code
  */
 int mca_coll_sm_scan_intra(const void *sbuf, void *rbuf, int count,
@@ -37,5 +228,20 @@ int mca_coll_sm_scan_intra(const void *sbuf, void *rbuf, int count,
                            struct ompi_communicator_t *comm,
                            mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    mca_coll_sm_module_t *sm_module = (mca_coll_sm_module_t*) module;
+    size_t size;
+
+    /* Fall back to the underlying module if the datatype is larger
+       than a fragment */
+    ompi_datatype_type_size(dtype, &size);
+    if (0 == size || size > (size_t) mca_coll_sm_component.sm_fragment_size) {
+        if (NULL == sm_module->previous_scan) {
+            return OMPI_ERR_NOT_SUPPORTED;
+        }
+        return sm_module->previous_scan(sbuf, rbuf, count, dtype, op, comm,
+                                        sm_module->previous_scan_module);
+    }
+
+    return mca_coll_sm_scan_flat(sbuf, rbuf, count, dtype, op, false,
+                                 comm, module);
 }
@@ -11,6 +11,8 @@
  *                         All rights reserved.
  * Copyright (c) 2015      Research Organization for Information Science
  *                         and Technology (RIST). All rights reserved.
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
  * $COPYRIGHT$
  *
  * Additional copyrights may follow
@@ -20,16 +22,18 @@
 
 #include "ompi_config.h"
 
+#include <stdlib.h>
+
 #include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
 #include "coll_sm.h"
 
 
-/*
- *      scatter
+/**
+ * Shared memory scatter.
  *
- *      Function:       - shared memory reduce
- *      Accepts:        - same as MPI_Scatter()
- *      Returns:        - MPI_SUCCESS or error code
+ * Scatter is a scatterv where all the processes receive the same
+ * amount of data (see coll_sm_scatterv.c).
  */
 int mca_coll_sm_scatter_intra(const void *sbuf, int scount,
                               struct ompi_datatype_t *sdtype, void *rbuf,
@@ -37,5 +41,25 @@ int mca_coll_sm_scatter_intra(const void *sbuf, int scount,
                               int root, struct ompi_communicator_t *comm,
                               mca_coll_base_module_t *module)
 {
-    return OMPI_ERR_NOT_IMPLEMENTED;
+    int i, ret, size = ompi_comm_size(comm);
+    int *scounts = NULL, *disps = NULL;
+
+    /* Only the root uses the counts and displacements */
+    if (root == ompi_comm_rank(comm)) {
+        scounts = (int*) malloc(2 * size * sizeof(int));
+        if (NULL == scounts) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        disps = scounts + size;
+        for (i = 0; i < size; ++i) {
+            scounts[i] = scount;
+            disps[i] = i * scount;
+        }
+    }
+
+    ret = mca_coll_sm_scatterv_intra(sbuf, scounts, disps, sdtype, rbuf,
+                                     rcount, rdtype, root, comm, module);
+
+    free(scounts);
+    return ret;
 }
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file
+ *
+ * Helpers shared by the flat shared memory collectives.
+ *
+ * The flat collectives (gather, scatter, allgather, alltoall, scan and
+ * their variants) do not use the tree: every process packs the
+ * fragments of its contribution into a slot of the shared segments and
+ * notifies the processes consuming them through their control buffers
+ * (CHILD_NOTIFY_PARENT / PARENT_WAIT_FOR_NOTIFY_SPECIFIC, the producer
+ * being the "child" and the consumer the "parent").  Consumers unpack
+ * the fragments directly from the slots of the producers.
+ *
+ * Each set of segments is claimed by a single process (the root, or
+ * rank 0 for the other collectives) and used by all the
+ * processes of the communicator, so that all of them go through the
+ * same number of sets and keep their operation counts in sync.  The
+ * number of fragments of the operation is published in the in-use
+ * flag by the claiming process, processes that cannot compute it
+ * (e.g., the non-root processes of gatherv) read it from there.
+ */
+
+#include "ompi_config.h"
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/sys/atomic.h"
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/mca/coll/coll.h"
+#include "coll_sm.h"
+
+
+/*
+ * Prepare a stream packing count elements of dtype from buf
+ */
+int mca_coll_sm_stream_init_send(mca_coll_sm_stream_t *stream,
+                                 struct ompi_datatype_t *dtype,
+                                 size_t count, const void *buf)
+{
+    int ret;
+
+    OBJ_CONSTRUCT(&stream->mcss_convertor, opal_convertor_t);
+    stream->mcss_frag_len = mca_coll_sm_component.sm_fragment_size;
+    ret = opal_convertor_copy_and_prepare_for_send(ompi_mpi_local_convertor,
+                                                   &(dtype->super), count,
+                                                   buf, 0,
+                                                   &stream->mcss_convertor);
+    if (OMPI_SUCCESS != ret) {
+        stream->mcss_remaining = 0;
+        return ret;
+    }
+    opal_convertor_get_packed_size(&stream->mcss_convertor,
+                                   &stream->mcss_remaining);
+
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Prepare a stream unpacking count elements of dtype to buf
+ */
+int mca_coll_sm_stream_init_recv(mca_coll_sm_stream_t *stream,
+                                 struct ompi_datatype_t *dtype,
+                                 size_t count, void *buf)
+{
+    int ret;
+
+    OBJ_CONSTRUCT(&stream->mcss_convertor, opal_convertor_t);
+    stream->mcss_frag_len = mca_coll_sm_component.sm_fragment_size;
+    ret = opal_convertor_copy_and_prepare_for_recv(ompi_mpi_local_convertor,
+                                                   &(dtype->super), count,
+                                                   buf, 0,
+                                                   &stream->mcss_convertor);
+    if (OMPI_SUCCESS != ret) {
+        stream->mcss_remaining = 0;
+        return ret;
+    }
+    opal_convertor_get_packed_size(&stream->mcss_convertor,
+                                   &stream->mcss_remaining);
+
+    return OMPI_SUCCESS;
+}
+
+void mca_coll_sm_stream_fini(mca_coll_sm_stream_t *stream)
+{
+    OBJ_DESTRUCT(&stream->mcss_convertor);
+}
+
+/*
+ * Pack the next fragment of a stream in a slot of a segment.  Returns
+ * the number of bytes packed (0 if the stream is complete).
+ */
+size_t mca_coll_sm_stream_pack(mca_coll_sm_stream_t *stream,
+                               mca_coll_sm_data_index_t *index,
+                               int slot)
+{
+    struct iovec iov;
+    size_t max_data = stream->mcss_frag_len;
+
+    if (0 == stream->mcss_remaining) {
+        return 0;
+    }
+
+    COPY_FRAGMENT_IN(stream->mcss_convertor, index, slot, iov, max_data);
+    stream->mcss_remaining -= max_data;
+
+    return max_data;
+}
+
+/*
+ * Unpack len bytes of a stream from a slot of a segment
+ */
+void mca_coll_sm_stream_unpack(mca_coll_sm_stream_t *stream,
+                               mca_coll_sm_data_index_t *index,
+                               int slot, size_t len)
+{
+    struct iovec iov;
+
+    COPY_FRAGMENT_OUT(stream->mcss_convertor, slot, index, iov, len);
+    stream->mcss_remaining -= len;
+}
+
+/*
+ * Acquire the next set of segments.  The claiming process waits for
+ * the set to be idle, publishes the number of fragments of the
+ * operation and marks the set as used by all the processes of the
+ * communicator; the others wait for the set to be marked and read the
+ * number of fragments.  Every process must release the set
+ * (FLAG_RELEASE) once it is done with all its segments.
+ */
+mca_coll_sm_in_use_flag_t *
+mca_coll_sm_flag_acquire(mca_coll_sm_comm_t *data, int claimer,
+                         int rank, int size, uint64_t *num_frags,
+                         int *segment_num)
+{
+    mca_coll_sm_in_use_flag_t *flag;
+    int flag_num = (data->mcb_operation_count %
+                    mca_coll_sm_component.sm_comm_num_in_use_flags);
+
+    FLAG_SETUP(flag_num, flag, data);
+    if (claimer == rank) {
+        FLAG_WAIT_FOR_IDLE(flag, flag_acquire_claimer_label);
+        flag->mcsiuf_num_frags = *num_frags;
+        flag->mcsiuf_num_procs_using = size;
+        /* Everything must be visible before the operation count */
+        opal_atomic_wmb();
+        flag->mcsiuf_operation_count = data->mcb_operation_count;
+    } else {
+        FLAG_WAIT_FOR_OP(flag, data->mcb_operation_count, flag_acquire_label);
+        opal_atomic_rmb();
+        *num_frags = flag->mcsiuf_num_frags;
+    }
+    ++data->mcb_operation_count;
+
+    *segment_num = flag_num * mca_coll_sm_component.sm_segs_per_inuse_flag;
+    return flag;
+}
+
+/*
+ * Same as mca_coll_sm_flag_acquire() with rank 0 claiming the set, for
+ * the operations whose number of fragments is the maximum of a value
+ * computed by each process (e.g., alltoallv, where each process only
+ * knows the amounts of data it exchanges).  Every process writes its
+ * value (plus one, so that 0 means "not written yet") in its slot
+ * after the in-use flag; rank 0 waits for all the slots, clears them
+ * and publishes the maximum as the number of fragments.  A process can
+ * only write its slot for a later operation on the same flag once rank
+ * 0 has published this one, so a single slot per process is enough.
+ */
+mca_coll_sm_in_use_flag_t *
+mca_coll_sm_flag_acquire_max(mca_coll_sm_comm_t *data, int rank, int size,
+                             uint64_t *num_frags, int *segment_num)
+{
+    mca_coll_sm_in_use_flag_t *flag;
+    size_t volatile *slots;
+    int peer, flag_num = (data->mcb_operation_count %
+                          mca_coll_sm_component.sm_comm_num_in_use_flags);
+
+    FLAG_SETUP(flag_num, flag, data);
+    slots = (size_t volatile *) ((char *) flag + MCA_COLL_SM_FLAG_SLOTS_OFFSET);
+
+    if (0 != rank) {
+        slots[rank] = (size_t) *num_frags + 1;
+    } else {
+        for (peer = 1; peer < size; ++peer) {
+            SPIN_CONDITION(0 != slots[peer], flag_acquire_max_label);
+            if (*num_frags < slots[peer] - 1) {
+                *num_frags = slots[peer] - 1;
+            }
+            slots[peer] = 0;
+        }
+    }
+
+    return mca_coll_sm_flag_acquire(data, 0, rank, size, num_frags, segment_num);
+}
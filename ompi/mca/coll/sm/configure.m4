@@ -0,0 +1,30 @@
+# -*- shell-script -*-
+#
+# Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+#                         reserved.
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+# MCA_coll_sm_CONFIG([action-if-can-compile],
+#                    [action-if-cant-compile])
+# ------------------------------------------------
+AC_DEFUN([MCA_ompi_coll_sm_CONFIG],[
+    AC_CONFIG_FILES([ompi/mca/coll/sm/Makefile])
+
+    OPAL_VAR_SCOPE_PUSH([coll_sm_cma_happy])
+
+    # Single-copy transfers of large messages
+    OPAL_CHECK_CMA([coll_sm], [AC_CHECK_HEADER([sys/prctl.h]) coll_sm_cma_happy=1], [coll_sm_cma_happy=0])
+
+    AC_DEFINE_UNQUOTED([OMPI_COLL_SM_HAVE_CMA], [$coll_sm_cma_happy],
+        [If CMA support can be enabled within coll sm])
+
+    OPAL_VAR_SCOPE_POP
+
+    # always happy
+    [$1]
+])dnl
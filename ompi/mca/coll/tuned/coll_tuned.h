@@ -26,6 +26,7 @@
 
 /* also need the dynamic rule structures */
 #include "coll_tuned_dynamic_rules.h"
+#include "coll_tuned_online.h"
 
 BEGIN_C_DECLS
 
@@ -34,6 +35,8 @@ extern int   ompi_coll_tuned_stream;
 extern int   ompi_coll_tuned_priority;
 extern bool  ompi_coll_tuned_use_dynamic_rules;
 extern char* ompi_coll_tuned_dynamic_rules_filename;
+extern int   ompi_coll_tuned_online_samples;
+extern char* ompi_coll_tuned_online_cache_filename;
 extern int   ompi_coll_tuned_init_tree_fanout;
 extern int   ompi_coll_tuned_init_chain_fanout;
 extern int   ompi_coll_tuned_init_max_requests;
@@ -184,6 +187,12 @@ int ompi_coll_tuned_scan_intra_check_forced_init (coll_tuned_force_algorithm_mca
 
 int mca_coll_tuned_ft_event(int state);
 
+struct mca_coll_tuned_module_t;
+int ompi_coll_tuned_comm_layout(struct mca_coll_tuned_module_t *tuned_module,
+                                struct ompi_communicator_t *comm);
+void ompi_coll_tuned_compile_pending_tables(struct mca_coll_tuned_module_t *tuned_module,
+                                            struct ompi_communicator_t *comm);
+
 struct mca_coll_tuned_component_t {
 	/** Base coll component */
 	mca_coll_base_component_2_0_0_t super;
@@ -197,6 +206,10 @@ struct mca_coll_tuned_component_t {
 
 	/* cached decision table stuff (moved from MCW module) */
 	ompi_coll_alg_rule_t *all_base_rules;
+
+	/* rules of a rules file in the list format */
+	ompi_coll_list_rule_t *list_rules;
+	int n_list_rules;
 };
 /**
  * Convenience typedef
@@ -217,6 +230,17 @@ struct mca_coll_tuned_module_t {
 
     /* the communicator rules for each MPI collective for ONLY my comsize */
     ompi_coll_com_rule_t *com_rules[COLLCOUNT];
+
+    /* the rules compiled for this communicator, and whether some still
+     * need the number of processes per node to be compiled */
+    ompi_coll_decision_table_t *decision_tables[COLLCOUNT];
+    bool decision_tables_pending;
+
+    /* number of processes per node, 0 until agreed on */
+    int ppn_min, ppn_max;
+
+    /* the online selection state of each MPI collective, NULL if not used */
+    ompi_coll_tuned_online_t *online[COLLCOUNT];
 };
 typedef struct mca_coll_tuned_module_t mca_coll_tuned_module_t;
 OBJ_CLASS_DECLARATION(mca_coll_tuned_module_t);
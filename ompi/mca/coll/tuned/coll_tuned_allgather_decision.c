@@ -29,6 +29,8 @@ static int coll_tuned_allgather_forced_algorithm = 0;
 static int coll_tuned_allgather_segment_size = 0;
 static int coll_tuned_allgather_tree_fanout;
 static int coll_tuned_allgather_chain_fanout;
+/* group size of the recursive multiplying algorithm (>= 2) */
+static int coll_tuned_allgather_radix = 4;
 
 /* valid values for coll_tuned_allgather_forced_algorithm */
 static mca_base_var_enum_value_t allgather_algorithms[] = {
@@ -39,6 +41,7 @@ static mca_base_var_enum_value_t allgather_algorithms[] = {
     {4, "ring"},
     {5, "neighbor"},
     {6, "two_proc"},
+    {7, "recursive_multiplying"},
     {0, NULL}
 };
 
@@ -77,7 +80,7 @@ ompi_coll_tuned_allgather_intra_check_forced_init(coll_tuned_force_algorithm_mca
     mca_param_indices->algorithm_param_index =
         mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
                                         "allgather_algorithm",
-                                        "Which allallgather algorithm is used. Can be locked down to choice of: 0 ignore, 1 basic linear, 2 bruck, 3 recursive doubling, 4 ring, 5 neighbor exchange, 6: two proc only.",
+                                        "Which allallgather algorithm is used. Can be locked down to choice of: 0 ignore, 1 basic linear, 2 bruck, 3 recursive doubling, 4 ring, 5 neighbor exchange, 6: two proc only, 7 recursive multiplying.",
                                         MCA_BASE_VAR_TYPE_INT, new_enum, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                         OPAL_INFO_LVL_5,
                                         MCA_BASE_VAR_SCOPE_ALL,
@@ -117,6 +120,14 @@ ompi_coll_tuned_allgather_intra_check_forced_init(coll_tuned_force_algorithm_mca
                                       MCA_BASE_VAR_SCOPE_ALL,
                                       &coll_tuned_allgather_chain_fanout);
 
+    coll_tuned_allgather_radix = 4;
+    mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                    "allgather_algorithm_radix",
+                                    "Largest group of processes exchanging data at each step of the recursive multiplying allgather algorithm (radix > 1). Only used when the rules file or the forced tree fanout gives none (0).",
+                                    MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                    OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_ALL,
+                                    &coll_tuned_allgather_radix);
+
     return (MPI_SUCCESS);
 }
 
@@ -161,6 +172,11 @@ int ompi_coll_tuned_allgather_intra_do_this(const void *sbuf, int scount,
         return ompi_coll_base_allgather_intra_two_procs(sbuf, scount, sdtype,
                                                         rbuf, rcount, rdtype,
                                                         comm, module);
+    case (7):
+        return ompi_coll_base_allgather_intra_recursivemultiplying(sbuf, scount, sdtype,
+                                                                   rbuf, rcount, rdtype,
+                                                                   comm, module,
+                                                                   (0 != faninout) ? faninout : coll_tuned_allgather_radix);
     } /* switch */
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "coll:tuned:allgather_intra_do_this attempt to select algorithm %d when only 0-%d is valid?",
@@ -25,6 +25,8 @@
 
 /* barrier algorithm variables */
 static int coll_tuned_barrier_forced_algorithm = 0;
+/* number of processes signaled per round by the k-dissemination algorithm, plus one (>= 2) */
+static int coll_tuned_barrier_radix = 4;
 
 /* valid values for coll_tuned_barrier_forced_algorithm */
 static mca_base_var_enum_value_t barrier_algorithms[] = {
@@ -35,6 +37,7 @@ static mca_base_var_enum_value_t barrier_algorithms[] = {
     {4, "bruck"},
     {5, "two_proc"},
     {6, "tree"},
+    {7, "kdissemination"},
     {0, NULL}
 };
 
@@ -72,7 +75,7 @@ int ompi_coll_tuned_barrier_intra_check_forced_init (coll_tuned_force_algorithm_
     mca_param_indices->algorithm_param_index =
         mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
                                         "barrier_algorithm",
-                                        "Which barrier algorithm is used. Can be locked down to choice of: 0 ignore, 1 linear, 2 double ring, 3: recursive doubling 4: bruck, 5: two proc only, 6: tree",
+                                        "Which barrier algorithm is used. Can be locked down to choice of: 0 ignore, 1 linear, 2 double ring, 3: recursive doubling 4: bruck, 5: two proc only, 6: tree, 7: k-dissemination",
                                         MCA_BASE_VAR_TYPE_INT, new_enum, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                         OPAL_INFO_LVL_5,
                                         MCA_BASE_VAR_SCOPE_ALL,
@@ -82,6 +85,14 @@ int ompi_coll_tuned_barrier_intra_check_forced_init (coll_tuned_force_algorithm_
         return mca_param_indices->algorithm_param_index;
     }
 
+    coll_tuned_barrier_radix = 4;
+    mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                    "barrier_algorithm_radix",
+                                    "Radix of the k-dissemination barrier algorithm, each round signals radix - 1 processes (radix > 1). Only used when the rules file or the forced tree fanout gives none (0).",
+                                    MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                    OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_ALL,
+                                    &coll_tuned_barrier_radix);
+
     return (MPI_SUCCESS);
 }
 
@@ -101,6 +112,8 @@ int ompi_coll_tuned_barrier_intra_do_this (struct ompi_communicator_t *comm,
     case (4):   return ompi_coll_base_barrier_intra_bruck(comm, module);
     case (5):   return ompi_coll_base_barrier_intra_two_procs(comm, module);
     case (6):   return ompi_coll_base_barrier_intra_tree(comm, module);
+    case (7):   return ompi_coll_base_barrier_intra_kdissemination(comm, module,
+                                                                   (0 != faninout) ? faninout : coll_tuned_barrier_radix);
     } /* switch */
     OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned:barrier_intra_do_this attempt to select algorithm %d when only 0-%d is valid?",
                  algorithm, ompi_coll_tuned_forced_max_algorithms[BARRIER]));
@@ -52,6 +52,8 @@ int   ompi_coll_tuned_stream = -1;
 int   ompi_coll_tuned_priority = 30;
 bool  ompi_coll_tuned_use_dynamic_rules = false;
 char* ompi_coll_tuned_dynamic_rules_filename = (char*) NULL;
+int   ompi_coll_tuned_online_samples = 0;
+char* ompi_coll_tuned_online_cache_filename = (char*) NULL;
 int   ompi_coll_tuned_init_tree_fanout = 4;
 int   ompi_coll_tuned_init_chain_fanout = 4;
 int   ompi_coll_tuned_init_max_requests = 128;
@@ -185,12 +187,30 @@ static int tuned_register(void)
     ompi_coll_tuned_dynamic_rules_filename = NULL;
     (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
                                            "dynamic_rules_filename",
-                                           "Filename of configuration file that contains the dynamic (@runtime) decision function rules",
+                                           "Filename of configuration file that contains the dynamic (@runtime) decision function rules, either in the numeric format or as a list of \"<collective> key=value ...\" rules",
                                            MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
                                            OPAL_INFO_LVL_6,
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &ompi_coll_tuned_dynamic_rules_filename);
 
+    ompi_coll_tuned_online_samples = 0;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "online_samples",
+                                           "Number of timed invocations of each algorithm before the fastest is locked in, for each communicator and range of message sizes (power of two). Only used with the dynamic rules, by the allgather, allreduce, alltoall, barrier, bcast and reduce without file based rules or forced algorithm. 0 disables the online selection",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_online_samples);
+
+    ompi_coll_tuned_online_cache_filename = NULL;
+    (void) mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                           "online_cache_filename",
+                                           "Filename of the cache of the algorithms selected online, keyed on the collective, the communicator size and the number of processes per node. It is read at startup and updated at the end of the run",
+                                           MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                           OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_READONLY,
+                                           &ompi_coll_tuned_online_cache_filename);
+
     /* register forced params */
     ompi_coll_tuned_allreduce_intra_check_forced_init(&ompi_coll_tuned_forced_params[ALLREDUCE]);
     ompi_coll_tuned_alltoall_intra_check_forced_init(&ompi_coll_tuned_forced_params[ALLTOALL]);
@@ -242,8 +262,14 @@ static int tuned_open(void)
         if( ompi_coll_tuned_dynamic_rules_filename ) {
             OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned:component_open Reading collective rules file [%s]",
                          ompi_coll_tuned_dynamic_rules_filename));
-            rc = ompi_coll_tuned_read_rules_config_file( ompi_coll_tuned_dynamic_rules_filename,
-                                                         &(mca_coll_tuned_component.all_base_rules), COLLCOUNT);
+            if( ompi_coll_tuned_rules_file_is_list( ompi_coll_tuned_dynamic_rules_filename ) ) {
+                rc = ompi_coll_tuned_read_rules_list_file( ompi_coll_tuned_dynamic_rules_filename,
+                                                           &(mca_coll_tuned_component.list_rules) );
+                mca_coll_tuned_component.n_list_rules = (rc > 0) ? rc : 0;
+            } else {
+                rc = ompi_coll_tuned_read_rules_config_file( ompi_coll_tuned_dynamic_rules_filename,
+                                                             &(mca_coll_tuned_component.all_base_rules), COLLCOUNT);
+            }
             if( rc >= 0 ) {
                 OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned:module_open Read %d valid rules\n", rc));
             } else {
@@ -251,6 +277,9 @@ static int tuned_open(void)
                 mca_coll_tuned_component.all_base_rules = NULL;
             }
         }
+        if( ompi_coll_tuned_online_samples > 0 ) {
+            ompi_coll_tuned_online_init();
+        }
     }
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:component_open: done!"));
@@ -273,6 +302,10 @@ static int tuned_close(void)
         ompi_coll_tuned_free_all_rules(mca_coll_tuned_component.all_base_rules, COLLCOUNT);
         mca_coll_tuned_component.all_base_rules = NULL;
     }
+    free(mca_coll_tuned_component.list_rules);
+    mca_coll_tuned_component.list_rules = NULL;
+    mca_coll_tuned_component.n_list_rules = 0;
+    ompi_coll_tuned_online_fini();
 
     return OMPI_SUCCESS;
 }
@@ -285,8 +318,21 @@ mca_coll_tuned_module_construct(mca_coll_tuned_module_t *module)
     for( int i = 0; i < COLLCOUNT; i++ ) {
         tuned_module->user_forced[i].algorithm = 0;
         tuned_module->com_rules[i] = NULL;
+        tuned_module->online[i] = NULL;
+        tuned_module->decision_tables[i] = NULL;
+    }
+    tuned_module->decision_tables_pending = false;
+    tuned_module->ppn_min = tuned_module->ppn_max = 0;
+}
+
+static void
+mca_coll_tuned_module_destruct(mca_coll_tuned_module_t *module)
+{
+    for( int i = 0; i < COLLCOUNT; i++ ) {
+        ompi_coll_tuned_online_free(module->online[i]);
+        ompi_coll_tuned_free_decision_table(module->decision_tables[i]);
     }
 }
 
 OBJ_CLASS_INSTANCE(mca_coll_tuned_module_t, mca_coll_base_module_t,
-                   mca_coll_tuned_module_construct, NULL);
+                   mca_coll_tuned_module_construct, mca_coll_tuned_module_destruct);
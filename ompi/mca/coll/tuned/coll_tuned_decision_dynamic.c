@@ -30,6 +30,7 @@
 #include "ompi/mca/coll/base/base.h"
 #include "ompi/mca/coll/coll.h"
 #include "ompi/mca/coll/base/coll_tags.h"
+#include "ompi/op/op.h"
 #include "coll_tuned.h"
 
 /*
@@ -40,6 +41,8 @@
  * Else
  *      use forced rules (-coll_tuned_dynamic_ALG_intra_algorithm = algorithm-number)
  * Else
+ *      use the online selection (-coll_tuned_online_samples = number of samples)
+ * Else
  *      use fixed (compiled) rule set (or nested ifs)
  *
  */
@@ -62,8 +65,12 @@ ompi_coll_tuned_allreduce_intra_dec_dynamic (const void *sbuf, void *rbuf, int c
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "ompi_coll_tuned_allreduce_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[ALLREDUCE]) {
+    if (tuned_module->decision_tables[ALLREDUCE]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
         int alg, faninout, segsize, ignoreme;
         size_t dsize;
@@ -71,14 +78,15 @@ ompi_coll_tuned_allreduce_intra_dec_dynamic (const void *sbuf, void *rbuf, int c
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLREDUCE],
-                                                        dsize, &faninout, &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[ALLREDUCE],
+                                                                   dsize, dtype, ompi_op_is_commute(op),
+                                                                   &faninout, &segsize, &ignoreme);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
             return ompi_coll_tuned_allreduce_intra_do_this (sbuf, rbuf, count, dtype, op,
-                                                            comm, module,
-                                                            alg, faninout, segsize);
+                                                                            comm, module,
+                                                                            alg, faninout, segsize);
         } /* found a method */
     } /*end if any com rules to check */
 
@@ -88,6 +96,23 @@ ompi_coll_tuned_allreduce_intra_dec_dynamic (const void *sbuf, void *rbuf, int c
                                                        tuned_module->user_forced[ALLREDUCE].tree_fanout,
                                                        tuned_module->user_forced[ALLREDUCE].segsize);
     }
+    if (tuned_module->online[ALLREDUCE] && ompi_op_is_commute(op)) {
+        /* online selection, timing the candidate algorithms on the first calls */
+        ompi_coll_tuned_online_sample_t sample;
+        int alg, err;
+        size_t dsize;
+
+        ompi_datatype_type_size (dtype, &dsize);
+        alg = ompi_coll_tuned_online_begin (tuned_module->online[ALLREDUCE], comm, module,
+                                            dsize * count, &sample);
+        if (alg) {
+            err = ompi_coll_tuned_allreduce_intra_do_this (sbuf, rbuf, count, dtype, op, comm, module, alg,
+                                                                   tuned_module->user_forced[ALLREDUCE].tree_fanout,
+                                                                   tuned_module->user_forced[ALLREDUCE].segsize);
+            return ompi_coll_tuned_online_end (tuned_module->online[ALLREDUCE], comm, module,
+                                               &sample, err);
+        }
+    }
     return ompi_coll_tuned_allreduce_intra_dec_fixed (sbuf, rbuf, count, dtype, op,
                                                       comm, module);
 }
@@ -111,8 +136,12 @@ int ompi_coll_tuned_alltoall_intra_dec_dynamic(const void *sbuf, int scount,
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "ompi_coll_tuned_alltoall_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[ALLTOALL]) {
+    if (tuned_module->decision_tables[ALLTOALL]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
         int comsize;
         int alg, faninout, segsize, max_requests;
@@ -122,15 +151,16 @@ int ompi_coll_tuned_alltoall_intra_dec_dynamic(const void *sbuf, int scount,
         comsize = ompi_comm_size(comm);
         dsize *= (ptrdiff_t)comsize * (ptrdiff_t)scount;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLTOALL],
-                                                        dsize, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[ALLTOALL],
+                                                                   dsize, sdtype, true,
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
             return ompi_coll_tuned_alltoall_intra_do_this (sbuf, scount, sdtype,
-                                                           rbuf, rcount, rdtype,
-                                                           comm, module,
-                                                           alg, faninout, segsize, max_requests);
+                                                                   rbuf, rcount, rdtype,
+                                                                   comm, module,
+                                                                   alg, faninout, segsize, max_requests);
         } /* found a method */
     } /*end if any com rules to check */
 
@@ -143,6 +173,26 @@ int ompi_coll_tuned_alltoall_intra_dec_dynamic(const void *sbuf, int scount,
                                                       tuned_module->user_forced[ALLTOALL].segsize,
                                                       tuned_module->user_forced[ALLTOALL].max_requests);
     }
+    if (tuned_module->online[ALLTOALL]) {
+        /* online selection, timing the candidate algorithms on the first calls */
+        ompi_coll_tuned_online_sample_t sample;
+        int alg, err;
+        size_t dsize;
+
+        /* the receive side is valid on all processes, even in place */
+        ompi_datatype_type_size (rdtype, &dsize);
+        alg = ompi_coll_tuned_online_begin (tuned_module->online[ALLTOALL], comm, module,
+                                            dsize * (ptrdiff_t)ompi_comm_size(comm) * (ptrdiff_t)rcount, &sample);
+        if (alg) {
+            err = ompi_coll_tuned_alltoall_intra_do_this (sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                                          comm, module, alg,
+                                                          tuned_module->user_forced[ALLTOALL].tree_fanout,
+                                                          tuned_module->user_forced[ALLTOALL].segsize,
+                                                          tuned_module->user_forced[ALLTOALL].max_requests);
+            return ompi_coll_tuned_online_end (tuned_module->online[ALLTOALL], comm, module,
+                                               &sample, err);
+        }
+    }
     return ompi_coll_tuned_alltoall_intra_dec_fixed (sbuf, scount, sdtype,
                                                      rbuf, rcount, rdtype,
                                                      comm, module);
@@ -165,24 +215,29 @@ int ompi_coll_tuned_alltoallv_intra_dec_dynamic(const void *sbuf, const int *sco
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "ompi_coll_tuned_alltoallv_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /**
      * check to see if we have some filebased rules. As we don't have global
      * knowledge about the total amount of data, use the first available rule.
      * This allow the users to specify the alltoallv algorithm to be used only
      * based on the communicator size.
      */
-    if (tuned_module->com_rules[ALLTOALLV]) {
+    if (tuned_module->decision_tables[ALLTOALLV]) {
         int alg, faninout, segsize, max_requests;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLTOALLV],
-                                                        0, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[ALLTOALLV],
+                                                                   0, sdtype, true,
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
             return ompi_coll_tuned_alltoallv_intra_do_this (sbuf, scounts, sdisps, sdtype,
-                                                            rbuf, rcounts, rdisps, rdtype,
-                                                            comm, module,
-                                                            alg);
+                                                                            rbuf, rcounts, rdisps, rdtype,
+                                                                            comm, module,
+                                                                            alg);
         } /* found a method */
     } /*end if any com rules to check */
 
@@ -211,13 +266,18 @@ int ompi_coll_tuned_barrier_intra_dec_dynamic(struct ompi_communicator_t *comm,
 
     OPAL_OUTPUT((ompi_coll_tuned_stream,"ompi_coll_tuned_barrier_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[BARRIER]) {
+    if (tuned_module->decision_tables[BARRIER]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
         int alg, faninout, segsize, ignoreme;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[BARRIER],
-                                                        0, &faninout, &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[BARRIER],
+                                                                   0, NULL, true,
+                                                                   &faninout, &segsize, &ignoreme);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
@@ -232,6 +292,21 @@ int ompi_coll_tuned_barrier_intra_dec_dynamic(struct ompi_communicator_t *comm,
                                                      tuned_module->user_forced[BARRIER].tree_fanout,
                                                      tuned_module->user_forced[BARRIER].segsize);
     }
+    if (tuned_module->online[BARRIER]) {
+        /* online selection, timing the candidate algorithms on the first calls */
+        ompi_coll_tuned_online_sample_t sample;
+        int alg, err;
+
+        alg = ompi_coll_tuned_online_begin (tuned_module->online[BARRIER], comm, module,
+                                            0, &sample);
+        if (alg) {
+            err = ompi_coll_tuned_barrier_intra_do_this (comm, module, alg,
+                                                         tuned_module->user_forced[BARRIER].tree_fanout,
+                                                         tuned_module->user_forced[BARRIER].segsize);
+            return ompi_coll_tuned_online_end (tuned_module->online[BARRIER], comm, module,
+                                               &sample, err);
+        }
+    }
     return ompi_coll_tuned_barrier_intra_dec_fixed (comm, module);
 }
 
@@ -251,8 +326,12 @@ int ompi_coll_tuned_bcast_intra_dec_dynamic(void *buf, int count,
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:bcast_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[BCAST]) {
+    if (tuned_module->decision_tables[BCAST]) {
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
         int alg, faninout, segsize, ignoreme;
         size_t dsize;
@@ -260,8 +339,9 @@ int ompi_coll_tuned_bcast_intra_dec_dynamic(void *buf, int count,
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[BCAST],
-                                                        dsize, &faninout, &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[BCAST],
+                                                                   dsize, dtype, true,
+                                                                   &faninout, &segsize, &ignoreme);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
@@ -279,6 +359,23 @@ int ompi_coll_tuned_bcast_intra_dec_dynamic(void *buf, int count,
                                                    tuned_module->user_forced[BCAST].chain_fanout,
                                                    tuned_module->user_forced[BCAST].segsize);
     }
+    if (tuned_module->online[BCAST]) {
+        /* online selection, timing the candidate algorithms on the first calls */
+        ompi_coll_tuned_online_sample_t sample;
+        int alg, err;
+        size_t dsize;
+
+        ompi_datatype_type_size (dtype, &dsize);
+        alg = ompi_coll_tuned_online_begin (tuned_module->online[BCAST], comm, module,
+                                            dsize * count, &sample);
+        if (alg) {
+            err = ompi_coll_tuned_bcast_intra_do_this (buf, count, dtype, root, comm, module, alg,
+                                                       tuned_module->user_forced[BCAST].chain_fanout,
+                                                       tuned_module->user_forced[BCAST].segsize);
+            return ompi_coll_tuned_online_end (tuned_module->online[BCAST], comm, module,
+                                               &sample, err);
+        }
+    }
     return ompi_coll_tuned_bcast_intra_dec_fixed (buf, count, dtype, root,
                                                   comm, module);
 }
@@ -301,8 +398,12 @@ int ompi_coll_tuned_reduce_intra_dec_dynamic( const void *sbuf, void *rbuf,
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:reduce_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[REDUCE]) {
+    if (tuned_module->decision_tables[REDUCE]) {
 
         /* we do, so calc the message size or what ever we need and use this for the evaluation */
         int alg, faninout, segsize, max_requests;
@@ -311,8 +412,9 @@ int ompi_coll_tuned_reduce_intra_dec_dynamic( const void *sbuf, void *rbuf,
         ompi_datatype_type_size(dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[REDUCE],
-                                                        dsize, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[REDUCE],
+                                                                   dsize, dtype, ompi_op_is_commute(op),
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
@@ -331,6 +433,24 @@ int ompi_coll_tuned_reduce_intra_dec_dynamic( const void *sbuf, void *rbuf,
                                                     tuned_module->user_forced[REDUCE].segsize,
                                                     tuned_module->user_forced[REDUCE].max_requests);
     }
+    if (tuned_module->online[REDUCE] && ompi_op_is_commute(op)) {
+        /* online selection, timing the candidate algorithms on the first calls */
+        ompi_coll_tuned_online_sample_t sample;
+        int alg, err;
+        size_t dsize;
+
+        ompi_datatype_type_size (dtype, &dsize);
+        alg = ompi_coll_tuned_online_begin (tuned_module->online[REDUCE], comm, module,
+                                            dsize * count, &sample);
+        if (alg) {
+            err = ompi_coll_tuned_reduce_intra_do_this (sbuf, rbuf, count, dtype, op, root, comm, module, alg,
+                                                        tuned_module->user_forced[REDUCE].chain_fanout,
+                                                        tuned_module->user_forced[REDUCE].segsize,
+                                                        tuned_module->user_forced[REDUCE].max_requests);
+            return ompi_coll_tuned_online_end (tuned_module->online[REDUCE], comm, module,
+                                               &sample, err);
+        }
+    }
     return ompi_coll_tuned_reduce_intra_dec_fixed (sbuf, rbuf, count, dtype,
                                                    op, root, comm, module);
 }
@@ -355,8 +475,12 @@ int ompi_coll_tuned_reduce_scatter_intra_dec_dynamic(const void *sbuf, void *rbu
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:reduce_scatter_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[REDUCESCATTER]) {
+    if (tuned_module->decision_tables[REDUCESCATTER]) {
         /* we do, so calc the message size or what ever we need and use
            this for the evaluation */
         int alg, faninout, segsize, ignoreme, i, count, size;
@@ -366,26 +490,26 @@ int ompi_coll_tuned_reduce_scatter_intra_dec_dynamic(const void *sbuf, void *rbu
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= count;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[REDUCESCATTER],
-                                                        dsize, &faninout,
-                                                        &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[REDUCESCATTER],
+                                                                   dsize, dtype, ompi_op_is_commute(op),
+                                                                   &faninout, &segsize, &ignoreme);
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
             return  ompi_coll_tuned_reduce_scatter_intra_do_this (sbuf, rbuf, rcounts, dtype,
-                                                                  op, comm, module,
-                                                                  alg, faninout, segsize);
+                                                                                  op, comm, module,
+                                                                                  alg, faninout, segsize);
         } /* found a method */
     } /*end if any com rules to check */
 
     if (tuned_module->user_forced[REDUCESCATTER].algorithm) {
         return ompi_coll_tuned_reduce_scatter_intra_do_this(sbuf, rbuf, rcounts, dtype,
-                                                            op, comm, module,
-                                                            tuned_module->user_forced[REDUCESCATTER].algorithm,
-                                                            tuned_module->user_forced[REDUCESCATTER].chain_fanout,
-                                                            tuned_module->user_forced[REDUCESCATTER].segsize);
+                                                                            op, comm, module,
+                                                                            tuned_module->user_forced[REDUCESCATTER].algorithm,
+                                                                            tuned_module->user_forced[REDUCESCATTER].chain_fanout,
+                                                                            tuned_module->user_forced[REDUCESCATTER].segsize);
     }
     return ompi_coll_tuned_reduce_scatter_intra_dec_fixed (sbuf, rbuf, rcounts,
-                                                           dtype, op, comm, module);
+                                                                   dtype, op, comm, module);
 }
 
 /*
@@ -398,18 +522,22 @@ int ompi_coll_tuned_reduce_scatter_intra_dec_dynamic(const void *sbuf, void *rbu
  *
  */
 int ompi_coll_tuned_reduce_scatter_block_intra_dec_dynamic(const void *sbuf, void *rbuf,
-                                                           int rcount,
-                                                           struct ompi_datatype_t *dtype,
-                                                           struct ompi_op_t *op,
-                                                           struct ompi_communicator_t *comm,
-                                                           mca_coll_base_module_t *module)
+                                                                   int rcount,
+                                                                   struct ompi_datatype_t *dtype,
+                                                                   struct ompi_op_t *op,
+                                                                   struct ompi_communicator_t *comm,
+                                                                   mca_coll_base_module_t *module)
 {
     mca_coll_tuned_module_t *tuned_module = (mca_coll_tuned_module_t*) module;
 
     OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:reduce_scatter_block_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /* check to see if we have some filebased rules */
-    if (tuned_module->com_rules[REDUCESCATTERBLOCK]) {
+    if (tuned_module->decision_tables[REDUCESCATTERBLOCK]) {
         /* we do, so calc the message size or what ever we need and use
            this for the evaluation */
         int alg, faninout, segsize, ignoreme, size;
@@ -418,26 +546,26 @@ int ompi_coll_tuned_reduce_scatter_block_intra_dec_dynamic(const void *sbuf, voi
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= rcount * size;
 
-        alg = ompi_coll_tuned_get_target_method_params(tuned_module->com_rules[REDUCESCATTERBLOCK],
-                                                       dsize, &faninout,
-                                                       &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[REDUCESCATTERBLOCK],
+                                                                   dsize, dtype, ompi_op_is_commute(op),
+                                                                   &faninout, &segsize, &ignoreme);
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
             return  ompi_coll_tuned_reduce_scatter_block_intra_do_this (sbuf, rbuf, rcount, dtype,
-                                                                        op, comm, module,
-                                                                        alg, faninout, segsize);
+                                                                                        op, comm, module,
+                                                                                        alg, faninout, segsize);
         } /* found a method */
     } /* end if any com rules to check */
 
     if (tuned_module->user_forced[REDUCESCATTERBLOCK].algorithm) {
         return ompi_coll_tuned_reduce_scatter_block_intra_do_this(sbuf, rbuf, rcount, dtype,
-                                                                  op, comm, module,
-                                                                  tuned_module->user_forced[REDUCESCATTERBLOCK].algorithm,
-                                                                  tuned_module->user_forced[REDUCESCATTERBLOCK].chain_fanout,
-                                                                  tuned_module->user_forced[REDUCESCATTERBLOCK].segsize);
+                                                                                  op, comm, module,
+                                                                                  tuned_module->user_forced[REDUCESCATTERBLOCK].algorithm,
+                                                                                  tuned_module->user_forced[REDUCESCATTERBLOCK].chain_fanout,
+                                                                                  tuned_module->user_forced[REDUCESCATTERBLOCK].segsize);
     }
     return ompi_coll_tuned_reduce_scatter_block_intra_dec_fixed (sbuf, rbuf, rcount,
-                                                                 dtype, op, comm, module);
+                                                                                 dtype, op, comm, module);
 }
 
 /*
@@ -461,7 +589,11 @@ int ompi_coll_tuned_allgather_intra_dec_dynamic(const void *sbuf, int scount,
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "ompi_coll_tuned_allgather_intra_dec_dynamic"));
 
-    if (tuned_module->com_rules[ALLGATHER]) {
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
+    if (tuned_module->decision_tables[ALLGATHER]) {
         /* We have file based rules:
            - calculate message size and other necessary information */
         int comsize;
@@ -472,15 +604,16 @@ int ompi_coll_tuned_allgather_intra_dec_dynamic(const void *sbuf, int scount,
         comsize = ompi_comm_size(comm);
         dsize *= (ptrdiff_t)comsize * (ptrdiff_t)scount;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLGATHER],
-                                                        dsize, &faninout, &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[ALLGATHER],
+                                                                   dsize, sdtype, true,
+                                                                   &faninout, &segsize, &ignoreme);
         if (alg) {
             /* we have found a valid choice from the file based rules for
                this message size */
             return ompi_coll_tuned_allgather_intra_do_this (sbuf, scount, sdtype,
-                                                            rbuf, rcount, rdtype,
-                                                            comm, module,
-                                                            alg, faninout, segsize);
+                                                                            rbuf, rcount, rdtype,
+                                                                            comm, module,
+                                                                            alg, faninout, segsize);
         }
     }
 
@@ -495,6 +628,25 @@ int ompi_coll_tuned_allgather_intra_dec_dynamic(const void *sbuf, int scount,
                                                        tuned_module->user_forced[ALLGATHER].segsize);
     }
 
+    if (tuned_module->online[ALLGATHER]) {
+        /* online selection, timing the candidate algorithms on the first calls */
+        ompi_coll_tuned_online_sample_t sample;
+        int alg, err;
+        size_t dsize;
+
+        /* the receive side is valid on all processes, even in place */
+        ompi_datatype_type_size (rdtype, &dsize);
+        alg = ompi_coll_tuned_online_begin (tuned_module->online[ALLGATHER], comm, module,
+                                            dsize * (ptrdiff_t)ompi_comm_size(comm) * (ptrdiff_t)rcount, &sample);
+        if (alg) {
+            err = ompi_coll_tuned_allgather_intra_do_this (sbuf, scount, sdtype, rbuf, rcount, rdtype,
+                                                                   comm, module, alg,
+                                                                   tuned_module->user_forced[ALLGATHER].tree_fanout,
+                                                                   tuned_module->user_forced[ALLGATHER].segsize);
+            return ompi_coll_tuned_online_end (tuned_module->online[ALLGATHER], comm, module,
+                                               &sample, err);
+        }
+    }
     /* Use default decision */
     return ompi_coll_tuned_allgather_intra_dec_fixed (sbuf, scount, sdtype,
                                                       rbuf, rcount, rdtype,
@@ -523,7 +675,11 @@ int ompi_coll_tuned_allgatherv_intra_dec_dynamic(const void *sbuf, int scount,
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "ompi_coll_tuned_allgatherv_intra_dec_dynamic"));
 
-    if (tuned_module->com_rules[ALLGATHERV]) {
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
+    if (tuned_module->decision_tables[ALLGATHERV]) {
         /* We have file based rules:
            - calculate message size and other necessary information */
         int comsize, i;
@@ -535,16 +691,17 @@ int ompi_coll_tuned_allgatherv_intra_dec_dynamic(const void *sbuf, int scount,
         total_size = 0;
         for (i = 0; i < comsize; i++) { total_size += dsize * rcounts[i]; }
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[ALLGATHERV],
-                                                        total_size, &faninout, &segsize, &ignoreme);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[ALLGATHERV],
+                                                                   total_size, sdtype, true,
+                                                                   &faninout, &segsize, &ignoreme);
         if (alg) {
             /* we have found a valid choice from the file based rules for
                this message size */
             return ompi_coll_tuned_allgatherv_intra_do_this (sbuf, scount, sdtype,
-                                                             rbuf, rcounts,
-                                                             rdispls, rdtype,
-                                                             comm, module,
-                                                             alg, faninout, segsize);
+                                                                             rbuf, rcounts,
+                                                                             rdispls, rdtype,
+                                                                             comm, module,
+                                                                             alg, faninout, segsize);
         }
     }
 
@@ -579,10 +736,14 @@ int ompi_coll_tuned_gather_intra_dec_dynamic(const void *sbuf, int scount,
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "ompi_coll_tuned_gather_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /**
      * check to see if we have some filebased rules.
      */
-    if (tuned_module->com_rules[GATHER]) {
+    if (tuned_module->decision_tables[GATHER]) {
         int comsize, alg, faninout, segsize, max_requests;
         size_t dsize;
 
@@ -590,8 +751,9 @@ int ompi_coll_tuned_gather_intra_dec_dynamic(const void *sbuf, int scount,
         ompi_datatype_type_size (sdtype, &dsize);
         dsize *= scount * comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[GATHER],
-                                                        dsize, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[GATHER],
+                                                                   dsize, sdtype, true,
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
@@ -628,10 +790,14 @@ int ompi_coll_tuned_scatter_intra_dec_dynamic(const void *sbuf, int scount,
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "ompi_coll_tuned_scatter_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /**
      * check to see if we have some filebased rules.
      */
-    if (tuned_module->com_rules[SCATTER]) {
+    if (tuned_module->decision_tables[SCATTER]) {
         int comsize, alg, faninout, segsize, max_requests;
         size_t dsize;
 
@@ -639,8 +805,9 @@ int ompi_coll_tuned_scatter_intra_dec_dynamic(const void *sbuf, int scount,
         ompi_datatype_type_size (sdtype, &dsize);
         dsize *= scount * comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[SCATTER],
-                                                        dsize, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[SCATTER],
+                                                                   dsize, sdtype, true,
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
@@ -676,10 +843,14 @@ int ompi_coll_tuned_exscan_intra_dec_dynamic(const void *sbuf, void* rbuf, int c
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "ompi_coll_tuned_exscan_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /**
      * check to see if we have some filebased rules.
      */
-    if (tuned_module->com_rules[EXSCAN]) {
+    if (tuned_module->decision_tables[EXSCAN]) {
         int comsize, alg, faninout, segsize, max_requests;
         size_t dsize;
 
@@ -687,8 +858,9 @@ int ompi_coll_tuned_exscan_intra_dec_dynamic(const void *sbuf, void* rbuf, int c
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[EXSCAN],
-                                                        dsize, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[EXSCAN],
+                                                                   dsize, dtype, ompi_op_is_commute(op),
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
@@ -719,10 +891,14 @@ int ompi_coll_tuned_scan_intra_dec_dynamic(const void *sbuf, void* rbuf, int cou
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "ompi_coll_tuned_scan_intra_dec_dynamic"));
 
+    if (OPAL_UNLIKELY(tuned_module->decision_tables_pending)) {
+        ompi_coll_tuned_compile_pending_tables (tuned_module, comm);
+    }
+
     /**
      * check to see if we have some filebased rules.
      */
-    if (tuned_module->com_rules[SCAN]) {
+    if (tuned_module->decision_tables[SCAN]) {
         int comsize, alg, faninout, segsize, max_requests;
         size_t dsize;
 
@@ -730,8 +906,9 @@ int ompi_coll_tuned_scan_intra_dec_dynamic(const void *sbuf, void* rbuf, int cou
         ompi_datatype_type_size (dtype, &dsize);
         dsize *= comsize;
 
-        alg = ompi_coll_tuned_get_target_method_params (tuned_module->com_rules[SCAN],
-                                                        dsize, &faninout, &segsize, &max_requests);
+        alg = ompi_coll_tuned_get_target_method_params_from_table (tuned_module->decision_tables[SCAN],
+                                                                   dsize, dtype, ompi_op_is_commute(op),
+                                                                   &faninout, &segsize, &max_requests);
 
         if (alg) {
             /* we have found a valid choice from the file based rules for this message size */
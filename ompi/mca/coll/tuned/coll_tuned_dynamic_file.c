@@ -19,8 +19,12 @@
  */
 
 #include "ompi_config.h"
+#include <ctype.h>
+#include <limits.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "mpi.h"
 #include "ompi/mca/mca.h"
@@ -262,6 +266,265 @@ int ompi_coll_tuned_read_rules_config_file (char *fname, ompi_coll_alg_rule_t**
 }
 
 
+/*
+ * List format: one rule per line, the first rule matching a call gives
+ * the algorithm. A rule starts with the name of the collective, followed
+ * by key=value pairs:
+ *
+ *   comm_size=R     communicator sizes
+ *   ppn=R           processes per node (all the nodes of the communicator)
+ *   dtsize=R        datatype sizes, by powers of two: a bound N stands for
+ *                   the sizes from N to 2N-1 (0 and 1 for 0 and 1, 128 for
+ *                   128 and more), other bounds are rejected
+ *   commute=yes|no  commutativity of the operation (reductions only)
+ *   msg=R           message sizes, as in the numeric format
+ *   alg=N           algorithm (required), as the forced algorithm values
+ *   faninout=N segsize=N max_requests=N
+ *
+ * where the ranges R are N, N-M or N- and the sizes accept the k, m and
+ * g suffixes, e.g.
+ *
+ *   allreduce comm_size=2-16 msg=0-8k alg=3
+ *   allreduce ppn=8- commute=yes msg=8k- alg=6
+ *   bcast msg=1m- alg=6 segsize=128k
+ */
+
+static const char *list_coll_names[COLLCOUNT] = {
+    [ALLGATHER] = "allgather", [ALLGATHERV] = "allgatherv", [ALLREDUCE] = "allreduce",
+    [ALLTOALL] = "alltoall", [ALLTOALLV] = "alltoallv", [ALLTOALLW] = "alltoallw",
+    [BARRIER] = "barrier", [BCAST] = "bcast", [EXSCAN] = "exscan", [GATHER] = "gather",
+    [GATHERV] = "gatherv", [REDUCE] = "reduce", [REDUCESCATTER] = "reduce_scatter",
+    [REDUCESCATTERBLOCK] = "reduce_scatter_block", [SCAN] = "scan",
+    [SCATTER] = "scatter", [SCATTERV] = "scatterv",
+};
+
+/* first token of the file, to tell the list format from the numeric one */
+int ompi_coll_tuned_rules_file_is_list (char *fname)
+{
+    char line[1024], *p;
+    FILE *fptr;
+    int is_list = 0;
+
+    fptr = fopen (fname, "r");
+    if (NULL == fptr) {
+        return 0;
+    }
+    while (NULL != fgets (line, sizeof (line), fptr)) {
+        for (p = line; isspace ((unsigned char)*p); p++);
+        if (('\0' == *p) || ('#' == *p)) {
+            continue;
+        }
+        is_list = isalpha ((unsigned char)*p);
+        break;
+    }
+    fclose (fptr);
+    return is_list;
+}
+
+static int list_parse_size (const char *str, char **end, size_t *value)
+{
+    unsigned long long v;
+
+    if (!isdigit ((unsigned char)*str)) {
+        return -1;
+    }
+    v = strtoull (str, end, 10);
+    switch (**end) {
+    case 'g': case 'G': v <<= 10;  /* fall through */
+    case 'm': case 'M': v <<= 10;  /* fall through */
+    case 'k': case 'K': v <<= 10; (*end)++; break;
+    default: break;
+    }
+    *value = (size_t)v;
+    return 0;
+}
+
+static int list_parse_range (const char *str, size_t *min, size_t *max)
+{
+    char *end;
+
+    if (0 != list_parse_size (str, &end, min)) {
+        return -1;
+    }
+    if ('\0' == *end) {
+        *max = *min;
+        return 0;
+    }
+    if ('-' != *end) {
+        return -1;
+    }
+    if ('\0' == *(++end)) {
+        *max = SIZE_MAX;
+        return 0;
+    }
+    if ((0 != list_parse_size (end, &end, max)) || ('\0' != *end) || (*max < *min)) {
+        return -1;
+    }
+    return 0;
+}
+
+static int list_parse_int_range (const char *str, int *min, int *max)
+{
+    size_t smin, smax;
+
+    if ((0 != list_parse_range (str, &smin, &smax)) || (smin > INT_MAX)) {
+        return -1;
+    }
+    *min = (int)smin;
+    *max = (smax > INT_MAX) ? INT_MAX : (int)smax;
+    return 0;
+}
+
+/*
+ * datatype size range, as size classes: the bounds are 0 or powers of two
+ * up to the smallest size of the last class
+ */
+static int list_parse_dtsize_range (const char *str, int *min, int *max)
+{
+    size_t smin, smax, last = (size_t)1 << (COLL_TUNED_DT_CLASSES - 1);
+
+    if ((0 != list_parse_range (str, &smin, &smax)) ||
+        (0 != (smin & (smin - 1))) || (smin > last) ||
+        ((SIZE_MAX != smax) && ((0 != (smax & (smax - 1))) || (smax > last)))) {
+        return -1;
+    }
+    *min = COLL_TUNED_DT_CLASS(smin);
+    *max = COLL_TUNED_DT_CLASS(smax);
+    return 0;
+}
+
+static int list_parse_int (const char *str, int *value)
+{
+    size_t v;
+    char *end;
+
+    if ((0 != list_parse_size (str, &end, &v)) || ('\0' != *end) || (v > INT_MAX)) {
+        return -1;
+    }
+    *value = (int)v;
+    return 0;
+}
+
+static int list_parse_rule (char *line, ompi_coll_list_rule_t *rule)
+{
+    char *token, *value, *save = NULL;
+    bool has_alg = false;
+    int i;
+
+    token = strtok_r (line, " \t\r\n", &save);
+    for (i = 0; i < COLLCOUNT; i++) {
+        if ((NULL != list_coll_names[i]) && (0 == strcmp (token, list_coll_names[i]))) {
+            break;
+        }
+    }
+    if (COLLCOUNT == i) {
+        OPAL_OUTPUT((ompi_coll_tuned_stream, "Unknown collective %s at line %d\n", token, fileline));
+        return -1;
+    }
+    *rule = (ompi_coll_list_rule_t) {
+        .coll = i, .comsize_min = 0, .comsize_max = INT_MAX, .ppn_min = 0, .ppn_max = 0,
+        .dtclass_min = 0, .dtclass_max = COLL_TUNED_DT_CLASSES - 1, .commute = -1, .msg_min = 0, .msg_max = SIZE_MAX,
+    };
+
+    while (NULL != (token = strtok_r (NULL, " \t\r\n", &save))) {
+        int rc = -1;
+
+        value = strchr (token, '=');
+        if (NULL != value) {
+            *(value++) = '\0';
+            if (0 == strcmp (token, "comm_size")) {
+                rc = list_parse_int_range (value, &rule->comsize_min, &rule->comsize_max);
+            } else if (0 == strcmp (token, "ppn")) {
+                rc = list_parse_int_range (value, &rule->ppn_min, &rule->ppn_max);
+            } else if (0 == strcmp (token, "dtsize")) {
+                rc = list_parse_dtsize_range (value, &rule->dtclass_min, &rule->dtclass_max);
+            } else if (0 == strcmp (token, "msg")) {
+                rc = list_parse_range (value, &rule->msg_min, &rule->msg_max);
+            } else if (0 == strcmp (token, "commute")) {
+                rc = 0;
+                if (0 == strcmp (value, "yes")) rule->commute = 1;
+                else if (0 == strcmp (value, "no")) rule->commute = 0;
+                else if (0 != strcmp (value, "any")) rc = -1;
+            } else if (0 == strcmp (token, "alg")) {
+                rc = list_parse_int (value, &rule->result_alg);
+                has_alg = true;
+            } else if (0 == strcmp (token, "faninout")) {
+                rc = list_parse_int (value, &rule->result_topo_faninout);
+            } else if (0 == strcmp (token, "segsize")) {
+                rc = list_parse_int (value, &rule->result_segsize);
+            } else if (0 == strcmp (token, "max_requests")) {
+                rc = list_parse_int (value, &rule->result_max_requests);
+            }
+        }
+        if (0 != rc) {
+            OPAL_OUTPUT((ompi_coll_tuned_stream, "Invalid %s at line %d\n", token, fileline));
+            return -1;
+        }
+    }
+    if (!has_alg) {
+        OPAL_OUTPUT((ompi_coll_tuned_stream, "Missing algorithm at line %d\n", fileline));
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Reads a rule file of the list format, with the same policy as the
+ * numeric format: any error discards the whole file.
+ *
+ * Returns the number of rules read, or -1
+ */
+int ompi_coll_tuned_read_rules_list_file (char *fname, ompi_coll_list_rule_t** rules)
+{
+    ompi_coll_list_rule_t *list = NULL, *tmp;
+    int n_rules = 0, max_rules = 0;
+    char line[1024], *p;
+    FILE *fptr;
+
+    *rules = NULL;
+    fptr = fopen (fname, "r");
+    if (NULL == fptr) {
+        OPAL_OUTPUT((ompi_coll_tuned_stream,"Cannot read rules file [%s]\n", fname));
+        return -1;
+    }
+    fileline = 0;
+    while (NULL != fgets (line, sizeof (line), fptr)) {
+        fileline++;
+        if (NULL != (p = strchr (line, '#'))) {
+            *p = '\0';
+        }
+        for (p = line; isspace ((unsigned char)*p); p++);
+        if ('\0' == *p) {
+            continue;
+        }
+        if (n_rules == max_rules) {
+            max_rules = (0 == max_rules) ? 16 : 2 * max_rules;
+            tmp = (ompi_coll_list_rule_t*) realloc (list, max_rules * sizeof (ompi_coll_list_rule_t));
+            if (NULL == tmp) {
+                goto on_file_error;
+            }
+            list = tmp;
+        }
+        if (0 != list_parse_rule (p, &list[n_rules])) {
+            goto on_file_error;
+        }
+        n_rules++;
+    }
+    fclose (fptr);
+
+    OPAL_OUTPUT((ompi_coll_tuned_stream,"Read %d rules from [%s]\n", n_rules, fname));
+    *rules = list;
+    return n_rules;
+
+ on_file_error:
+    OPAL_OUTPUT((ompi_coll_tuned_stream,"read_rules_list_file: bad configure file [%s]. Read afar as line %d\n", fname, fileline));
+    OPAL_OUTPUT((ompi_coll_tuned_stream,"Ignoring user supplied tuned collectives configuration decision file.\n"));
+    free (list);
+    fclose (fptr);
+    return -1;
+}
+
+
 static void skiptonewline (FILE *fptr)
 {
     char val;
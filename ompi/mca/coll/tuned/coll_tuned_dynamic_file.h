@@ -29,6 +29,10 @@ BEGIN_C_DECLS
 
 int ompi_coll_tuned_read_rules_config_file (char *fname, ompi_coll_alg_rule_t** rules, int n_collectives);
 
+/* list format, see coll_tuned_dynamic_file.c */
+int ompi_coll_tuned_rules_file_is_list (char *fname);
+int ompi_coll_tuned_read_rules_list_file (char *fname, ompi_coll_list_rule_t** rules);
+
 
 END_C_DECLS
 #endif /* MCA_COLL_TUNED_DYNAMIC_FILE_H_HAS_BEEN_INCLUDED */
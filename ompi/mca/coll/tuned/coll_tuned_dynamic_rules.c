@@ -32,8 +32,11 @@
 /* also need the dynamic rule structures */
 #include "coll_tuned_dynamic_rules.h"
 
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "ompi/mca/coll/base/coll_base_util.h"
 
@@ -389,3 +392,249 @@ int ompi_coll_tuned_get_target_method_params (ompi_coll_com_rule_t* base_com_rul
     /* return the algorithm/method to use */
     return (best_msg_p->result_alg);
 }
+
+/*
+ * Compilation of the rules of a communicator in decision tables
+ */
+
+static bool list_rule_matches (const ompi_coll_list_rule_t* rule, int dt_class, int commute,
+                               size_t msg_size)
+{
+    return (rule->dtclass_min <= dt_class) && (dt_class <= rule->dtclass_max) &&
+        ((-1 == rule->commute) || (commute == rule->commute)) &&
+        (rule->msg_min <= msg_size) && (msg_size <= rule->msg_max);
+}
+
+static bool list_rule_applies (const ompi_coll_list_rule_t* rule, int coll, int mpi_comsize,
+                               int ppn_min, int ppn_max)
+{
+    return (rule->coll == coll) &&
+        (rule->comsize_min <= mpi_comsize) && (mpi_comsize <= rule->comsize_max) &&
+        ((0 == rule->ppn_max) ||
+         ((rule->ppn_min <= ppn_min) && (ppn_max <= rule->ppn_max)));
+}
+
+static int compare_sizes (const void *a, const void *b)
+{
+    size_t sa = *(const size_t*)a, sb = *(const size_t*)b;
+    return (sa < sb) ? -1 : ((sa > sb) ? 1 : 0);
+}
+
+/* index of the first range of each power of two of message size */
+static void decision_ranges_index (ompi_coll_decision_ranges_t* ranges)
+{
+    int b, i = 0;
+
+    for( b = 0; b < COLL_TUNED_MSG_BUCKETS; b++ ) {
+        size_t bucket_size = (0 == b) ? 0 : ((size_t)1 << (b - 1));
+        while( (i + 1) < ranges->n_entries && ranges->entries[i + 1].msg_size <= bucket_size ) {
+            i++;
+        }
+        ranges->first[b] = (unsigned short)i;
+    }
+}
+
+static ompi_coll_decision_table_t* decision_table_alloc (int n_ranges)
+{
+    ompi_coll_decision_table_t* table;
+
+    table = (ompi_coll_decision_table_t*) calloc (1, sizeof (ompi_coll_decision_table_t));
+    if (NULL == table) {
+        return NULL;
+    }
+    table->ranges = (ompi_coll_decision_ranges_t*) calloc (n_ranges, sizeof (ompi_coll_decision_ranges_t));
+    if (NULL == table->ranges) {
+        free (table);
+        return NULL;
+    }
+    return table;
+}
+
+void ompi_coll_tuned_free_decision_table (ompi_coll_decision_table_t* table)
+{
+    if (NULL == table) {
+        return;
+    }
+    for (int i = 0; i < table->n_ranges; i++) {
+        free (table->ranges[i].entries);
+    }
+    free (table->ranges);
+    free (table);
+}
+
+/*
+ * The message rules of the communicator size selected in the rules file.
+ * The linear search takes the first rule, then the following ones as long
+ * as their size is not larger than the message size: rule i is selected
+ * from the largest size of rules 0 to i, and among rules with the same
+ * such size the last one wins. The ranges start at these running maxima.
+ */
+ompi_coll_decision_table_t* ompi_coll_tuned_mk_decision_table_from_com_rule (ompi_coll_com_rule_t* com_p)
+{
+    ompi_coll_decision_table_t* table;
+    ompi_coll_decision_ranges_t* ranges;
+    size_t max_size = 0;
+    int i, n;
+
+    if ((NULL == com_p) || (0 == com_p->n_msg_sizes)) {
+        return NULL;
+    }
+    table = decision_table_alloc (1);
+    if (NULL == table) {
+        return NULL;
+    }
+    table->n_ranges = 1;
+    ranges = &table->ranges[0];
+    ranges->entries = (ompi_coll_decision_entry_t*) calloc (com_p->n_msg_sizes,
+                                                            sizeof (ompi_coll_decision_entry_t));
+    if (NULL == ranges->entries) {
+        ompi_coll_tuned_free_decision_table (table);
+        return NULL;
+    }
+    for (i = n = 0; i < com_p->n_msg_sizes; i++) {
+        ompi_coll_msg_rule_t* msg_p = &com_p->msg_rules[i];
+        ompi_coll_decision_entry_t* entry;
+
+        if (msg_p->msg_size > max_size) {
+            max_size = msg_p->msg_size;
+        }
+        /* the first rule also applies below its size */
+        if ((0 == n) || (max_size != ranges->entries[n - 1].msg_size)) {
+            n++;
+        }
+        entry = &ranges->entries[n - 1];
+        entry->msg_size = (0 == i) ? 0 : max_size;
+        entry->result_alg = msg_p->result_alg;
+        entry->result_topo_faninout = msg_p->result_topo_faninout;
+        entry->result_segsize = (int)msg_p->result_segsize;
+        entry->result_max_requests = msg_p->result_max_requests;
+    }
+    ranges->n_entries = n;
+    decision_ranges_index (ranges);
+    return table;
+}
+
+/*
+ * The list rules applying to a communicator: for each datatype size class
+ * and commutativity, the message size ranges between the bounds of the
+ * rules, with the first matching rule of each range. Identical tables are
+ * shared.
+ */
+ompi_coll_decision_table_t* ompi_coll_tuned_mk_decision_table (ompi_coll_list_rule_t* rules, int n_rules,
+                                                               int coll, int mpi_comsize,
+                                                               int ppn_min, int ppn_max)
+{
+    ompi_coll_decision_table_t* table = NULL;
+    ompi_coll_list_rule_t** applying = NULL;
+    size_t* bounds = NULL;
+    int i, j, k, n_applying = 0, n_bounds = 0, dt_class, commute;
+    bool found = false;
+
+    applying = (ompi_coll_list_rule_t**) malloc (n_rules * sizeof (ompi_coll_list_rule_t*));
+    bounds = (size_t*) malloc ((2 * n_rules + 1) * sizeof (size_t));
+    table = decision_table_alloc (2 * COLL_TUNED_DT_CLASSES);
+    if ((NULL == applying) || (NULL == bounds) || (NULL == table)) {
+        goto error;
+    }
+
+    bounds[n_bounds++] = 0;
+    for (i = 0; i < n_rules; i++) {
+        if (!list_rule_applies (&rules[i], coll, mpi_comsize, ppn_min, ppn_max)) {
+            continue;
+        }
+        applying[n_applying++] = &rules[i];
+        bounds[n_bounds++] = rules[i].msg_min;
+        if (rules[i].msg_max < SIZE_MAX) {
+            bounds[n_bounds++] = rules[i].msg_max + 1;
+        }
+    }
+    if (0 == n_applying) {
+        goto error;
+    }
+    qsort (bounds, n_bounds, sizeof (size_t), compare_sizes);
+    for (i = j = 1; i < n_bounds; i++) {
+        if (bounds[i] != bounds[j - 1]) {
+            bounds[j++] = bounds[i];
+        }
+    }
+    n_bounds = j;
+
+    for (dt_class = 0; dt_class < COLL_TUNED_DT_CLASSES; dt_class++) {
+        for (commute = 0; commute < 2; commute++) {
+            ompi_coll_decision_ranges_t* ranges = &table->ranges[table->n_ranges];
+            ranges->entries = (ompi_coll_decision_entry_t*) calloc (n_bounds, sizeof (ompi_coll_decision_entry_t));
+            if (NULL == ranges->entries) {
+                goto error;
+            }
+            for (i = 0; i < n_bounds; i++) {
+                ompi_coll_decision_entry_t entry = { .msg_size = bounds[i] };
+                for (k = 0; k < n_applying; k++) {
+                    if (list_rule_matches (applying[k], dt_class, commute, bounds[i])) {
+                        entry.result_alg = applying[k]->result_alg;
+                        entry.result_topo_faninout = applying[k]->result_topo_faninout;
+                        entry.result_segsize = applying[k]->result_segsize;
+                        entry.result_max_requests = applying[k]->result_max_requests;
+                        found = true;
+                        break;
+                    }
+                }
+                /* merge the consecutive ranges with the same decision */
+                if ((ranges->n_entries > 0) &&
+                    (0 == memcmp (&ranges->entries[ranges->n_entries - 1].result_alg, &entry.result_alg,
+                                  sizeof (entry) - offsetof (ompi_coll_decision_entry_t, result_alg)))) {
+                    continue;
+                }
+                ranges->entries[ranges->n_entries++] = entry;
+            }
+            decision_ranges_index (ranges);
+
+            for (k = 0; k < table->n_ranges; k++) {
+                if ((table->ranges[k].n_entries == ranges->n_entries) &&
+                    (0 == memcmp (table->ranges[k].entries, ranges->entries,
+                                  ranges->n_entries * sizeof (ompi_coll_decision_entry_t)))) {
+                    break;
+                }
+            }
+            table->index[dt_class][commute] = (unsigned char)k;
+            if (k == table->n_ranges) {
+                table->n_ranges++;
+            } else {
+                free (ranges->entries);
+                memset (ranges, 0, sizeof (ompi_coll_decision_ranges_t));
+            }
+        }
+    }
+    free (applying);
+    free (bounds);
+    if (!found) {  /* no rule for any message size */
+        ompi_coll_tuned_free_decision_table (table);
+        return NULL;
+    }
+    return table;
+
+ error:
+    free (applying);
+    free (bounds);
+    ompi_coll_tuned_free_decision_table (table);
+    return NULL;
+}
+
+bool ompi_coll_tuned_list_rules_have_coll (ompi_coll_list_rule_t* rules, int n_rules, int coll)
+{
+    for (int i = 0; i < n_rules; i++) {
+        if (rules[i].coll == coll) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ompi_coll_tuned_list_rules_need_layout (ompi_coll_list_rule_t* rules, int n_rules, int coll)
+{
+    for (int i = 0; i < n_rules; i++) {
+        if ((rules[i].coll == coll) && (0 != rules[i].ppn_max)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -23,6 +23,8 @@
 
 #include "ompi_config.h"
 
+#include "ompi/datatype/ompi_datatype.h"
+
 BEGIN_C_DECLS
 
 
@@ -71,6 +73,60 @@ typedef struct alg_rule_s {
 
 } ompi_coll_alg_rule_t;
 
+/*
+ * Rule of the list format of the rules file: the first rule of the file
+ * matching the communicator, the datatype size, the commutativity and the
+ * message size of a call gives the algorithm. The bounds are inclusive;
+ * the datatype sizes are matched by size class (see
+ * COLL_TUNED_DT_CLASSES), the datatype size bounds of the file being
+ * validated to stand for whole classes.
+ */
+typedef struct ompi_coll_list_rule_s {
+    int coll;
+    int comsize_min, comsize_max;
+    int ppn_min, ppn_max;          /* processes per node, ppn_max == 0 for any */
+    int dtclass_min, dtclass_max;  /* datatype size classes */
+    int commute;                   /* -1 for any */
+    size_t msg_min, msg_max;
+
+    int result_alg;
+    int result_topo_faninout;
+    int result_segsize;
+    int result_max_requests;
+} ompi_coll_list_rule_t;
+
+/*
+ * Rules of one collective compiled for a communicator, so that the
+ * decision of a call is found in constant time: one table per datatype
+ * size class (powers of two) and commutativity, made of message size
+ * ranges, with the first range of each power of two of message size.
+ */
+#define COLL_TUNED_DT_CLASSES      8   /* [0,1] [2,3] ... [64,127] [128,...] */
+#define COLL_TUNED_DT_CLASS(dtsize) \
+    ((ompi_coll_tuned_size_bucket((dtsize) >> 1) < COLL_TUNED_DT_CLASSES) ? \
+     ompi_coll_tuned_size_bucket((dtsize) >> 1) : (COLL_TUNED_DT_CLASSES - 1))
+#define COLL_TUNED_MSG_BUCKETS     (8 * (int)sizeof(size_t) + 1)
+
+typedef struct ompi_coll_decision_entry_s {
+    size_t msg_size;               /* smallest message size of the range */
+    int result_alg;
+    int result_topo_faninout;
+    int result_segsize;
+    int result_max_requests;
+} ompi_coll_decision_entry_t;
+
+typedef struct ompi_coll_decision_ranges_s {
+    int n_entries;
+    ompi_coll_decision_entry_t *entries;
+    unsigned short first[COLL_TUNED_MSG_BUCKETS];
+} ompi_coll_decision_ranges_t;
+
+typedef struct ompi_coll_decision_table_s {
+    unsigned char index[COLL_TUNED_DT_CLASSES][2];
+    int n_ranges;
+    ompi_coll_decision_ranges_t *ranges;
+} ompi_coll_decision_table_t;
+
 /* function prototypes */
 
 /* these are used to build the rule tables (by the read file routines) */
@@ -98,6 +154,66 @@ int ompi_coll_tuned_get_target_method_params (ompi_coll_com_rule_t* base_com_rul
                                               int* result_topo_faninout, int* result_segsize,
                                               int* max_requests);
 
+/* compile the rules applying to a communicator, NULL if there are none */
+ompi_coll_decision_table_t* ompi_coll_tuned_mk_decision_table_from_com_rule (ompi_coll_com_rule_t* com_p);
+ompi_coll_decision_table_t* ompi_coll_tuned_mk_decision_table (ompi_coll_list_rule_t* rules, int n_rules,
+                                                               int coll, int mpi_comsize,
+                                                               int ppn_min, int ppn_max);
+void ompi_coll_tuned_free_decision_table (ompi_coll_decision_table_t* table);
+
+/* whether the list rules have rules for the collective, and depend on the processes per node */
+bool ompi_coll_tuned_list_rules_have_coll (ompi_coll_list_rule_t* rules, int n_rules, int coll);
+bool ompi_coll_tuned_list_rules_need_layout (ompi_coll_list_rule_t* rules, int n_rules, int coll);
+
+/* bucket of a size: 0 for 0, else 1 + the index of its highest bit */
+static inline int ompi_coll_tuned_size_bucket (size_t size)
+{
+#if OPAL_C_HAVE_BUILTIN_CLZ
+    return (0 == size) ? 0 : (int)(8 * sizeof(unsigned long long)) - __builtin_clzll((unsigned long long)size);
+#else
+    int bucket = 0;
+    for( ; size > 0; size >>= 1 ) {
+        bucket++;
+    }
+    return bucket;
+#endif  /* OPAL_C_HAVE_BUILTIN_CLZ */
+}
+
+/*
+ * Constant time replacement of ompi_coll_tuned_get_target_method_params.
+ * dtype is the datatype giving the datatype size (NULL for none) and
+ * commute the commutativity of the operation (true without operation).
+ */
+static inline int
+ompi_coll_tuned_get_target_method_params_from_table (const ompi_coll_decision_table_t* table,
+                                                     size_t mpi_msgsize,
+                                                     const struct ompi_datatype_t* dtype, bool commute,
+                                                     int* result_topo_faninout, int* result_segsize,
+                                                     int* max_requests)
+{
+    const ompi_coll_decision_ranges_t *ranges;
+    const ompi_coll_decision_entry_t *entry;
+    int dt_class = 0, i;
+
+    if( table->n_ranges > 1 && NULL != dtype ) {
+        size_t dtsize;
+        ompi_datatype_type_size(dtype, &dtsize);
+        dt_class = COLL_TUNED_DT_CLASS(dtsize);
+    }
+    ranges = &table->ranges[table->index[dt_class][commute ? 1 : 0]];
+
+    /* at most the ranges starting within the power of two of the message size */
+    i = ranges->first[ompi_coll_tuned_size_bucket(mpi_msgsize)];
+    while( (i + 1) < ranges->n_entries && ranges->entries[i + 1].msg_size <= mpi_msgsize ) {
+        i++;
+    }
+    entry = &ranges->entries[i];
+    *result_topo_faninout = entry->result_topo_faninout;
+    *result_segsize = entry->result_segsize;
+    *max_requests = entry->result_max_requests;
+    return entry->result_alg;
+}
+
 
 END_C_DECLS
 #endif /* MCA_COLL_TUNED_DYNAMIC_RULES_H_HAS_BEEN_INCLUDED */
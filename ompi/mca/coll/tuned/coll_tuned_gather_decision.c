@@ -30,6 +30,8 @@ static int coll_tuned_gather_forced_algorithm = 0;
 static int coll_tuned_gather_segment_size = 0;
 static int coll_tuned_gather_tree_fanout;
 static int coll_tuned_gather_chain_fanout;
+/* k-nomial tree radix for the gather algorithm (>= 2) */
+static int coll_tuned_gather_knomial_radix = 4;
 
 /* valid values for coll_tuned_gather_forced_algorithm */
 static mca_base_var_enum_value_t gather_algorithms[] = {
@@ -37,6 +39,7 @@ static mca_base_var_enum_value_t gather_algorithms[] = {
     {1, "basic_linear"},
     {2, "binomial"},
     {3, "linear_sync"},
+    {4, "knomial"},
     {0, NULL}
 };
 
@@ -75,7 +78,7 @@ ompi_coll_tuned_gather_intra_check_forced_init(coll_tuned_force_algorithm_mca_pa
     mca_param_indices->algorithm_param_index =
         mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
                                         "gather_algorithm",
-                                        "Which gather algorithm is used. Can be locked down to choice of: 0 ignore, 1 basic linear, 2 binomial, 3 linear with synchronization.",
+                                        "Which gather algorithm is used. Can be locked down to choice of: 0 ignore, 1 basic linear, 2 binomial, 3 linear with synchronization, 4 knomial.",
                                         MCA_BASE_VAR_TYPE_INT, new_enum, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                         OPAL_INFO_LVL_5,
                                         MCA_BASE_VAR_SCOPE_ALL,
@@ -115,6 +118,14 @@ ompi_coll_tuned_gather_intra_check_forced_init(coll_tuned_force_algorithm_mca_pa
                                       MCA_BASE_VAR_SCOPE_ALL,
                                       &coll_tuned_gather_chain_fanout);
 
+    coll_tuned_gather_knomial_radix = 4;
+    mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                    "gather_algorithm_knomial_radix",
+                                    "k-nomial tree radix for the gather algorithm (radix > 1). Only used when the rules file or the forced tree fanout gives none (0).",
+                                    MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                    OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_ALL,
+                                    &coll_tuned_gather_knomial_radix);
+
     return (MPI_SUCCESS);
 }
 
@@ -150,6 +161,11 @@ ompi_coll_tuned_gather_intra_do_this(const void *sbuf, int scount,
                                                        rbuf, rcount, rdtype,
                                                        root, comm, module,
                                                        segsize);
+    case (4):
+        return ompi_coll_base_gather_intra_knomial(sbuf, scount, sdtype,
+                                                   rbuf, rcount, rdtype,
+                                                   root, comm, module,
+                                                   (0 != faninout) ? faninout : coll_tuned_gather_knomial_radix);
     } /* switch */
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "coll:tuned:gather_intra_do_this attempt to select algorithm %d when only 0-%d is valid?",
@@ -27,6 +27,8 @@
 
 #include "mpi.h"
 #include "ompi/communicator/communicator.h"
+#include "ompi/group/group.h"
+#include "ompi/proc/proc.h"
 #include "ompi/mca/coll/coll.h"
 #include "ompi/mca/coll/base/base.h"
 #include "ompi/mca/coll/base/coll_base_topo.h"
@@ -165,12 +167,102 @@ ompi_coll_tuned_forced_getvalues( enum COLLTYPE type,
                 need_dynamic_decision = 1;                              \
             }                                                           \
         }                                                               \
+        if( ompi_coll_tuned_list_rules_have_coll( mca_coll_tuned_component.list_rules, \
+                                                  mca_coll_tuned_component.n_list_rules, (TYPE) ) ) { \
+            if( ompi_coll_tuned_list_rules_need_layout( mca_coll_tuned_component.list_rules, \
+                                                        mca_coll_tuned_component.n_list_rules, (TYPE) ) ) { \
+                (TMOD)->decision_tables_pending = true;                 \
+                need_dynamic_decision = 1;                              \
+            } else {                                                    \
+                (TMOD)->decision_tables[(TYPE)]                         \
+                    = ompi_coll_tuned_mk_decision_table( mca_coll_tuned_component.list_rules, \
+                                                         mca_coll_tuned_component.n_list_rules, \
+                                                         (TYPE), size, 0, 0 ); \
+            }                                                           \
+        } else {                                                        \
+            (TMOD)->decision_tables[(TYPE)]                             \
+                = ompi_coll_tuned_mk_decision_table_from_com_rule( (TMOD)->com_rules[(TYPE)] ); \
+        }                                                               \
+        if( NULL != (TMOD)->decision_tables[(TYPE)] ) {                 \
+            need_dynamic_decision = 1;                                  \
+        }                                                               \
+        if( NULL != (TMOD)->online[(TYPE)] ) {                          \
+            need_dynamic_decision = 1;                                  \
+        }                                                               \
         if( 1 == need_dynamic_decision ) {                              \
             OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned: enable dynamic selection for "#TYPE)); \
             EXECUTE;                                                    \
         }                                                               \
     }
 
+/*
+ * Number of processes per node of the communicator: the processes agree on
+ * the smallest and largest number, on the first call needing them.
+ */
+int ompi_coll_tuned_comm_layout(mca_coll_tuned_module_t *tuned_module,
+                                struct ompi_communicator_t *comm)
+{
+    ompi_group_t *group = comm->c_local_group;
+    int values[2], nlocal = 0, rc;
+
+    if (0 != tuned_module->ppn_max) {
+        return OMPI_SUCCESS;
+    }
+    for (int i = 0; i < group->grp_proc_count; i++) {
+        ompi_proc_t *proc;
+        if (i == ompi_comm_rank(comm)) {
+            nlocal++;
+            continue;
+        }
+#if OMPI_GROUP_SPARSE
+        proc = ompi_group_peer_lookup(group, i);
+#else
+        proc = ompi_group_get_proc_ptr_raw(group, i);
+        if (ompi_proc_is_sentinel(proc)) {
+            continue;  /* not instantiated, hence not local (see ompi_group_have_remote_peers) */
+        }
+#endif
+        if (OPAL_PROC_ON_LOCAL_NODE(proc->super.proc_flags)) {
+            nlocal++;
+        }
+    }
+
+    values[0] = nlocal;
+    values[1] = -nlocal;
+    rc = ompi_coll_base_allreduce_intra_recursivedoubling(MPI_IN_PLACE, values, 2, MPI_INT, MPI_MAX,
+                                                          comm, &tuned_module->super);
+    if (OMPI_SUCCESS != rc) {
+        return rc;
+    }
+    tuned_module->ppn_max = values[0];
+    tuned_module->ppn_min = -values[1];
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Compile the list rules depending on the number of processes per node,
+ * on the first call of a collective with dynamic rules (hence on all the
+ * processes of the communicator at the same time).
+ */
+void ompi_coll_tuned_compile_pending_tables(mca_coll_tuned_module_t *tuned_module,
+                                            struct ompi_communicator_t *comm)
+{
+    tuned_module->decision_tables_pending = false;
+    if (OMPI_SUCCESS != ompi_coll_tuned_comm_layout(tuned_module, comm)) {
+        return;
+    }
+    for (int i = 0; i < COLLCOUNT; i++) {
+        if (ompi_coll_tuned_list_rules_need_layout(mca_coll_tuned_component.list_rules,
+                                                   mca_coll_tuned_component.n_list_rules, i)) {
+            tuned_module->decision_tables[i] =
+                ompi_coll_tuned_mk_decision_table(mca_coll_tuned_component.list_rules,
+                                                  mca_coll_tuned_component.n_list_rules, i,
+                                                  ompi_comm_size(comm),
+                                                  tuned_module->ppn_min, tuned_module->ppn_max);
+        }
+    }
+}
+
 /*
  * Init module on the communicator
  */
@@ -211,6 +303,13 @@ tuned_module_enable( mca_coll_base_module_t *module,
     if (ompi_coll_tuned_use_dynamic_rules) {
         OPAL_OUTPUT((ompi_coll_tuned_stream,"coll:tuned:module_init MCW & Dynamic"));
 
+        /* online selection, for the collectives without file based rules or forced algorithm */
+        if( ompi_coll_tuned_online_samples > 0 && OMPI_COMM_IS_INTRA(comm) ) {
+            for( int i = 0; i < COLLCOUNT; i++ ) {
+                tuned_module->online[i] = ompi_coll_tuned_online_create(i, comm);
+            }
+        }
+
         /**
          * next dynamic state, recheck all forced rules as well
          * warning, we should check to make sure this is really an INTRA comm here...
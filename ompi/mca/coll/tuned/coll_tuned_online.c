@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Online selection of the algorithms.
+ *
+ * For each communicator, collective and message size range (power of
+ * two), the first invocations cycle through the candidate algorithms of
+ * the collective: one untimed round to warm up, then
+ * coll_tuned_online_samples timed rounds. The accumulated times are then
+ * reduced (max over the processes) so that all processes lock in the same
+ * fastest algorithm for the rest of the run.
+ *
+ * The decisions are kept in coll_tuned_online_cache_filename between
+ * runs, keyed on the collective, the communicator size and the number of
+ * processes per node. On the first use of a collective on a communicator
+ * the processes agree on the node layout and on the cached decisions, and
+ * only the message size ranges without a decision common to all of them
+ * are sampled.
+ */
+
+#include "ompi_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mpi.h"
+#include "opal/mca/threads/mutex.h"
+#include "opal/mca/timer/base/base.h"
+#include "opal/util/output.h"
+#include "ompi/constants.h"
+#include "ompi/communicator/communicator.h"
+#include "ompi/mca/coll/base/coll_base_functions.h"
+#include "coll_tuned.h"
+#include "coll_tuned_online.h"
+
+/* message sizes 0, 1, [2,4), [4,8) ... */
+#define COLL_TUNED_ONLINE_NBUCKETS COLL_TUNED_MSG_BUCKETS
+#define COLL_TUNED_ONLINE_MAX_CANDIDATES 16
+
+typedef struct {
+    int algorithm;    /* selected algorithm, 0 while sampling */
+    int calls;        /* invocations since the sampling started */
+    double *times;    /* accumulated time of each candidate */
+} ompi_coll_tuned_online_bucket_t;
+
+struct ompi_coll_tuned_online_t {
+    int coll;
+    int samples;
+    int ncandidates;
+    int candidates[COLL_TUNED_ONLINE_MAX_CANDIDATES];
+    bool agreed;      /* node layout and cached decisions agreed on */
+    int ppn_min, ppn_max;
+    ompi_coll_tuned_online_bucket_t buckets[COLL_TUNED_ONLINE_NBUCKETS];
+};
+
+/* one line of the decision cache */
+typedef struct {
+    int coll, comm_size, ppn_min, ppn_max, bucket, algorithm;
+} ompi_coll_tuned_online_decision_t;
+
+static ompi_coll_tuned_online_decision_t *online_decisions = NULL;
+static int online_ndecisions = 0, online_max_decisions = 0;
+static bool online_updated = false;
+static bool online_initialized = false;
+static opal_mutex_t online_lock;
+
+/* the collectives with a message size known to all processes */
+static const bool online_supported[COLLCOUNT] = {
+    [ALLGATHER] = true, [ALLREDUCE] = true, [ALLTOALL] = true,
+    [BARRIER] = true, [BCAST] = true, [REDUCE] = true,
+};
+/* algorithms only working with two processes */
+static const int online_two_procs[COLLCOUNT] = {
+    [ALLGATHER] = 6, [ALLTOALL] = 5, [BARRIER] = 5,
+};
+
+static size_t online_bucket_size (int bucket)
+{
+    return (0 == bucket) ? 0 : ((size_t)1 << (bucket - 1));
+}
+
+/* called with the lock held */
+static ompi_coll_tuned_online_decision_t*
+online_find_decision (int coll, int comm_size, int ppn_min, int ppn_max, int bucket)
+{
+    for( int i = 0; i < online_ndecisions; i++ ) {
+        ompi_coll_tuned_online_decision_t *d = &online_decisions[i];
+        if( d->coll == coll && d->comm_size == comm_size && d->ppn_min == ppn_min &&
+            d->ppn_max == ppn_max && d->bucket == bucket ) {
+            return d;
+        }
+    }
+    return NULL;
+}
+
+/* called with the lock held */
+static void online_set_decision (const ompi_coll_tuned_online_decision_t *decision, bool overwrite)
+{
+    ompi_coll_tuned_online_decision_t *d;
+
+    d = online_find_decision(decision->coll, decision->comm_size, decision->ppn_min,
+                             decision->ppn_max, decision->bucket);
+    if( NULL != d ) {
+        if( overwrite ) {
+            d->algorithm = decision->algorithm;
+        }
+        return;
+    }
+    if( online_ndecisions == online_max_decisions ) {
+        int max = (0 == online_max_decisions) ? 64 : 2 * online_max_decisions;
+        d = (ompi_coll_tuned_online_decision_t*)realloc(online_decisions, max * sizeof(*d));
+        if( NULL == d ) {
+            return;
+        }
+        online_decisions = d;
+        online_max_decisions = max;
+    }
+    online_decisions[online_ndecisions++] = *decision;
+}
+
+/*
+ * One decision per line: collective id, communicator size, min and max
+ * number of processes per node, smallest message size of the range and
+ * algorithm. Everything after a # is a comment.
+ */
+static int online_read_cache (const char *fname, bool overwrite)
+{
+    ompi_coll_tuned_online_decision_t decision;
+    char line[256];
+    size_t msg_size;
+    FILE *fptr;
+    int n = 0;
+
+    fptr = fopen(fname, "r");
+    if( NULL == fptr ) {
+        return 0;
+    }
+    while( NULL != fgets(line, sizeof(line), fptr) ) {
+        char *comment = strchr(line, '#');
+        if( NULL != comment ) {
+            *comment = '\0';
+        }
+        if( 6 != sscanf(line, "%d %d %d %d %zu %d", &decision.coll, &decision.comm_size,
+                        &decision.ppn_min, &decision.ppn_max, &msg_size, &decision.algorithm) ||
+            decision.coll < 0 || decision.coll >= COLLCOUNT || decision.algorithm <= 0 ) {
+            continue;
+        }
+        decision.bucket = ompi_coll_tuned_size_bucket(msg_size);
+        online_set_decision(&decision, overwrite);
+        n++;
+    }
+    fclose(fptr);
+    return n;
+}
+
+int ompi_coll_tuned_online_init (void)
+{
+    OBJ_CONSTRUCT(&online_lock, opal_mutex_t);
+    online_initialized = true;
+    if( NULL != ompi_coll_tuned_online_cache_filename ) {
+        int n = online_read_cache(ompi_coll_tuned_online_cache_filename, true);
+        OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:online read %d decisions from %s",
+                     n, ompi_coll_tuned_online_cache_filename));
+    }
+    return OMPI_SUCCESS;
+}
+
+/*
+ * The processes which locked in new decisions merge them with the
+ * current content of the file, and replace it atomically.
+ */
+int ompi_coll_tuned_online_fini (void)
+{
+    char *tmpname = NULL;
+    FILE *fptr;
+
+    if( !online_initialized ) {
+        return OMPI_SUCCESS;
+    }
+    if( online_updated && NULL != ompi_coll_tuned_online_cache_filename ) {
+        (void) online_read_cache(ompi_coll_tuned_online_cache_filename, false);
+        if( 0 > asprintf(&tmpname, "%s.%d", ompi_coll_tuned_online_cache_filename, (int)getpid()) ) {
+            tmpname = NULL;
+        }
+        if( NULL != tmpname && NULL != (fptr = fopen(tmpname, "w")) ) {
+            fprintf(fptr, "# coll/tuned online decisions\n"
+                    "# collective comm_size ppn_min ppn_max msg_size algorithm\n");
+            for( int i = 0; i < online_ndecisions; i++ ) {
+                ompi_coll_tuned_online_decision_t *d = &online_decisions[i];
+                fprintf(fptr, "%d %d %d %d %zu %d\n", d->coll, d->comm_size, d->ppn_min,
+                        d->ppn_max, online_bucket_size(d->bucket), d->algorithm);
+            }
+            fclose(fptr);
+            if( 0 != rename(tmpname, ompi_coll_tuned_online_cache_filename) ) {
+                unlink(tmpname);
+            }
+        }
+        free(tmpname);
+    }
+    free(online_decisions);
+    online_decisions = NULL;
+    online_ndecisions = online_max_decisions = 0;
+    online_updated = false;
+    online_initialized = false;
+    OBJ_DESTRUCT(&online_lock);
+    return OMPI_SUCCESS;
+}
+
+ompi_coll_tuned_online_t*
+ompi_coll_tuned_online_create (int coll, struct ompi_communicator_t *comm)
+{
+    ompi_coll_tuned_online_t *online;
+    double *times;
+    int alg, b;
+
+    if( !online_supported[coll] ) {
+        return NULL;
+    }
+    online = (ompi_coll_tuned_online_t*)calloc(1, sizeof(ompi_coll_tuned_online_t));
+    if( NULL == online ) {
+        return NULL;
+    }
+    online->coll = coll;
+    online->samples = ompi_coll_tuned_online_samples;
+    for( alg = 1; alg < ompi_coll_tuned_forced_max_algorithms[coll] &&
+             online->ncandidates < COLL_TUNED_ONLINE_MAX_CANDIDATES; alg++ ) {
+        if( alg == online_two_procs[coll] && 2 != ompi_comm_size(comm) ) {
+            continue;
+        }
+        online->candidates[online->ncandidates++] = alg;
+    }
+    times = (double*)calloc(COLL_TUNED_ONLINE_NBUCKETS * online->ncandidates, sizeof(double));
+    if( NULL == times ) {
+        free(online);
+        return NULL;
+    }
+    for( b = 0; b < COLL_TUNED_ONLINE_NBUCKETS; b++ ) {
+        online->buckets[b].times = times + b * online->ncandidates;
+    }
+    return online;
+}
+
+void ompi_coll_tuned_online_free (ompi_coll_tuned_online_t *online)
+{
+    if( NULL != online ) {
+        free(online->buckets[0].times);
+        free(online);
+    }
+}
+
+static int online_is_candidate (ompi_coll_tuned_online_t *online, int alg)
+{
+    for( int i = 0; i < online->ncandidates; i++ ) {
+        if( online->candidates[i] == alg ) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Agree on the number of processes per node, then on the cached
+ * decisions for this layout.
+ */
+static int online_agree (ompi_coll_tuned_online_t *online,
+                         struct ompi_communicator_t *comm,
+                         mca_coll_base_module_t *module)
+{
+    mca_coll_tuned_module_t *tuned_module = (mca_coll_tuned_module_t*)module;
+    int values[2 * COLL_TUNED_ONLINE_NBUCKETS], comm_size = ompi_comm_size(comm), b, rc;
+    int nb = COLL_TUNED_ONLINE_NBUCKETS;
+
+    rc = ompi_coll_tuned_comm_layout(tuned_module, comm);
+    if( OMPI_SUCCESS != rc ) {
+        return rc;
+    }
+    online->ppn_max = tuned_module->ppn_max;
+    online->ppn_min = tuned_module->ppn_min;
+
+    if( NULL == ompi_coll_tuned_online_cache_filename ) {
+        return OMPI_SUCCESS;
+    }
+    OPAL_THREAD_LOCK(&online_lock);
+    for( b = 0; b < nb; b++ ) {
+        ompi_coll_tuned_online_decision_t *d;
+        d = online_find_decision(online->coll, comm_size, online->ppn_min, online->ppn_max, b);
+        values[b] = (NULL != d) ? d->algorithm : 0;
+        values[nb + b] = -values[b];
+    }
+    OPAL_THREAD_UNLOCK(&online_lock);
+    rc = ompi_coll_base_allreduce_intra_recursivedoubling(MPI_IN_PLACE, values, 2 * nb, MPI_INT,
+                                                          MPI_MAX, comm, module);
+    if( OMPI_SUCCESS != rc ) {
+        return rc;
+    }
+    for( b = 0; b < nb; b++ ) {
+        if( values[b] == -values[nb + b] && online_is_candidate(online, values[b]) ) {
+            online->buckets[b].algorithm = values[b];
+        }
+    }
+    return OMPI_SUCCESS;
+}
+
+int ompi_coll_tuned_online_begin (ompi_coll_tuned_online_t *online,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module,
+                                  size_t msg_size,
+                                  ompi_coll_tuned_online_sample_t *sample)
+{
+    ompi_coll_tuned_online_bucket_t *bucket;
+    int b = ompi_coll_tuned_size_bucket(msg_size);
+
+    sample->bucket = -1;
+    if( !online->agreed ) {
+        online->agreed = true;
+        if( OMPI_SUCCESS != online_agree(online, comm, module) ) {
+            online->ncandidates = 0;  /* stick to the fixed decision */
+        }
+    }
+    if( 0 == online->ncandidates ) {
+        return 0;
+    }
+    bucket = &online->buckets[b];
+    if( 0 != bucket->algorithm ) {
+        return bucket->algorithm;
+    }
+    sample->bucket = b;
+    sample->candidate = bucket->calls % online->ncandidates;
+    sample->start = opal_timer_base_get_usec();
+    return online->candidates[sample->candidate];
+}
+
+int ompi_coll_tuned_online_end (ompi_coll_tuned_online_t *online,
+                                struct ompi_communicator_t *comm,
+                                mca_coll_base_module_t *module,
+                                ompi_coll_tuned_online_sample_t *sample, int err)
+{
+    ompi_coll_tuned_online_bucket_t *bucket;
+    int best, i, rc;
+
+    if( sample->bucket < 0 ) {
+        return err;
+    }
+    bucket = &online->buckets[sample->bucket];
+    if( bucket->calls >= online->ncandidates ) {  /* the first round warms up */
+        bucket->times[sample->candidate] += (double)(opal_timer_base_get_usec() - sample->start) * 1e-6;
+    }
+    if( ++bucket->calls < (online->samples + 1) * online->ncandidates ) {
+        return err;
+    }
+
+    rc = ompi_coll_base_allreduce_intra_recursivedoubling(MPI_IN_PLACE, bucket->times,
+                                                          online->ncandidates, MPI_DOUBLE,
+                                                          MPI_MAX, comm, module);
+    if( OMPI_SUCCESS != rc ) {
+        /* sample again */
+        bucket->calls = 0;
+        memset(bucket->times, 0, online->ncandidates * sizeof(double));
+        return err;
+    }
+    for( best = 0, i = 1; i < online->ncandidates; i++ ) {
+        if( bucket->times[i] < bucket->times[best] ) {
+            best = i;
+        }
+    }
+    bucket->algorithm = online->candidates[best];
+    OPAL_OUTPUT((ompi_coll_tuned_stream, "coll:tuned:online collective %d comm %s messages from %"
+                 PRIsize_t " bytes: algorithm %d (%g s per call)", online->coll, comm->c_name,
+                 online_bucket_size(sample->bucket), bucket->algorithm,
+                 bucket->times[best] / online->samples));
+
+    if( 0 == ompi_comm_rank(comm) && NULL != ompi_coll_tuned_online_cache_filename ) {
+        ompi_coll_tuned_online_decision_t decision = {
+            .coll = online->coll, .comm_size = ompi_comm_size(comm),
+            .ppn_min = online->ppn_min, .ppn_max = online->ppn_max,
+            .bucket = sample->bucket, .algorithm = bucket->algorithm
+        };
+        OPAL_THREAD_LOCK(&online_lock);
+        online_set_decision(&decision, true);
+        online_updated = true;
+        OPAL_THREAD_UNLOCK(&online_lock);
+    }
+    return err;
+}
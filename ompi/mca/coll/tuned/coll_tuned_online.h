@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef MCA_COLL_TUNED_ONLINE_H_HAS_BEEN_INCLUDED
+#define MCA_COLL_TUNED_ONLINE_H_HAS_BEEN_INCLUDED
+
+#include "ompi_config.h"
+
+#include <stdint.h>
+
+#include "ompi/mca/coll/coll.h"
+
+BEGIN_C_DECLS
+
+/* online selection state of one collective on one communicator */
+typedef struct ompi_coll_tuned_online_t ompi_coll_tuned_online_t;
+
+/* one timed invocation, between the begin and end calls */
+typedef struct ompi_coll_tuned_online_sample_t {
+    int bucket;       /* message size range, -1 when not sampling */
+    int candidate;    /* index of the algorithm in the candidates */
+    uint64_t start;   /* usec */
+} ompi_coll_tuned_online_sample_t;
+
+/* decision cache file, read at component open and updated at close */
+int ompi_coll_tuned_online_init (void);
+int ompi_coll_tuned_online_fini (void);
+
+/* NULL if the online selection does not support this collective */
+ompi_coll_tuned_online_t* ompi_coll_tuned_online_create (int coll, struct ompi_communicator_t *comm);
+void ompi_coll_tuned_online_free (ompi_coll_tuned_online_t *online);
+
+/*
+ * Algorithm to run for a message size (0 to use the fixed decision). The
+ * result of the algorithm has to be passed to ompi_coll_tuned_online_end.
+ */
+int ompi_coll_tuned_online_begin (ompi_coll_tuned_online_t *online,
+                                  struct ompi_communicator_t *comm,
+                                  mca_coll_base_module_t *module,
+                                  size_t msg_size,
+                                  ompi_coll_tuned_online_sample_t *sample);
+int ompi_coll_tuned_online_end (ompi_coll_tuned_online_t *online,
+                                struct ompi_communicator_t *comm,
+                                mca_coll_base_module_t *module,
+                                ompi_coll_tuned_online_sample_t *sample, int err);
+
+END_C_DECLS
+#endif /* MCA_COLL_TUNED_ONLINE_H_HAS_BEEN_INCLUDED */
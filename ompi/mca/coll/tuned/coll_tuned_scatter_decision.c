@@ -31,6 +31,8 @@ static int coll_tuned_scatter_forced_algorithm = 0;
 static int coll_tuned_scatter_segment_size = 0;
 static int coll_tuned_scatter_tree_fanout;
 static int coll_tuned_scatter_chain_fanout;
+/* k-nomial tree radix for the scatter algorithm (>= 2) */
+static int coll_tuned_scatter_knomial_radix = 4;
 
 /* valid values for coll_tuned_scatter_forced_algorithm */
 static mca_base_var_enum_value_t scatter_algorithms[] = {
@@ -38,6 +40,7 @@ static mca_base_var_enum_value_t scatter_algorithms[] = {
     {1, "basic_linear"},
     {2, "binomial"},
     {3, "linear_nb"},
+    {4, "knomial"},
     {0, NULL}
 };
 
@@ -76,7 +79,7 @@ ompi_coll_tuned_scatter_intra_check_forced_init(coll_tuned_force_algorithm_mca_p
     mca_param_indices->algorithm_param_index =
         mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
                                         "scatter_algorithm",
-                                        "Which scatter algorithm is used. Can be locked down to choice of: 0 ignore, 1 basic linear, 2 binomial, 3 non-blocking linear.",
+                                        "Which scatter algorithm is used. Can be locked down to choice of: 0 ignore, 1 basic linear, 2 binomial, 3 non-blocking linear, 4 knomial.",
                                         MCA_BASE_VAR_TYPE_INT, new_enum, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                         OPAL_INFO_LVL_5,
                                         MCA_BASE_VAR_SCOPE_ALL,
@@ -148,6 +151,14 @@ ompi_coll_tuned_scatter_intra_check_forced_init(coll_tuned_force_algorithm_mca_p
                                            MCA_BASE_VAR_SCOPE_READONLY,
                                            &ompi_coll_tuned_scatter_large_msg);
 
+    coll_tuned_scatter_knomial_radix = 4;
+    mca_base_component_var_register(&mca_coll_tuned_component.super.collm_version,
+                                    "scatter_algorithm_knomial_radix",
+                                    "k-nomial tree radix for the scatter algorithm (radix > 1). Only used when the rules file or the forced tree fanout gives none (0).",
+                                    MCA_BASE_VAR_TYPE_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                    OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_ALL,
+                                    &coll_tuned_scatter_knomial_radix);
+
     return (MPI_SUCCESS);
 }
 
@@ -183,6 +194,11 @@ ompi_coll_tuned_scatter_intra_do_this(const void *sbuf, int scount,
                                                       rbuf, rcount, rdtype,
                                                       root, comm, module,
                                                       ompi_coll_tuned_scatter_blocking_send_ratio);
+    case (4):
+        return ompi_coll_base_scatter_intra_knomial(sbuf, scount, sdtype,
+                                                    rbuf, rcount, rdtype,
+                                                    root, comm, module,
+                                                    (0 != faninout) ? faninout : coll_tuned_scatter_knomial_radix);
     } /* switch */
     OPAL_OUTPUT((ompi_coll_tuned_stream,
                  "coll:tuned:scatter_intra_do_this attempt to select algorithm %d when only 0-%d is valid?",
@@ -27,6 +27,7 @@ AC_DEFUN([MCA_ompi_op_avx_CONFIG],[
     op_avx_support=0
     op_avx2_support=0
     op_avx512_support=0
+    op_f16c_support=0
     OPAL_VAR_SCOPE_PUSH([op_avx_cflags_save])
 
     AS_IF([test "$opal_cv_asm_arch" = "X86_64"],
@@ -132,6 +133,56 @@ AC_DEFUN([MCA_ompi_op_avx_CONFIG],[
                   CFLAGS="$op_avx_cflags_save"
                  ])
            #
+           # The short float operations convert to and from single precision with
+           # the F16C instructions, which are not part of AVX2 (but are implied by
+           # -march=skylake-avx512). Add the flag if needed.
+           #
+           AS_IF([test $op_avx2_support -eq 1],
+                 [AC_MSG_CHECKING([for F16C support])
+                  op_avx_cflags_save="$CFLAGS"
+                  CFLAGS="$CFLAGS $MCA_BUILD_OP_AVX2_FLAGS"
+                  AC_LINK_IFELSE(
+                      [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                               [[
+    __m128i vA;
+    __m256 vB = _mm256_cvtph_ps(vA)
+                               ]])],
+                      [op_f16c_support=1
+                       AC_MSG_RESULT([yes])],
+                      [AC_MSG_RESULT([no])])
+                  AS_IF([test $op_f16c_support -eq 0],
+                        [AC_MSG_CHECKING([for F16C support (with -mf16c)])
+                         CFLAGS="$CFLAGS -mf16c"
+                         AC_LINK_IFELSE(
+                             [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                      [[
+    __m128i vA;
+    __m256 vB = _mm256_cvtph_ps(vA)
+                                      ]])],
+                             [op_f16c_support=1
+                              MCA_BUILD_OP_AVX2_FLAGS="$MCA_BUILD_OP_AVX2_FLAGS -mf16c"
+                              AC_MSG_RESULT([yes])],
+                             [AC_MSG_RESULT([no])])
+                        ])
+                  CFLAGS="$op_avx_cflags_save"
+                 ])
+           # The AVX512 flavor uses both the 256 and 512 bits conversions
+           AS_IF([test $op_f16c_support -eq 1 && test $op_avx512_support -eq 1],
+                 [AC_MSG_CHECKING([for F16C support with AVX512])
+                  op_avx_cflags_save="$CFLAGS"
+                  CFLAGS="$CFLAGS $MCA_BUILD_OP_AVX512_FLAGS"
+                  AC_LINK_IFELSE(
+                      [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                               [[
+    __m128i vA;
+    __m256 vB = _mm256_cvtph_ps(vA)
+                               ]])],
+                      [AC_MSG_RESULT([yes])],
+                      [MCA_BUILD_OP_AVX512_FLAGS="$MCA_BUILD_OP_AVX512_FLAGS -mf16c"
+                       AC_MSG_RESULT([no, adding -mf16c])])
+                  CFLAGS="$op_avx_cflags_save"
+                 ])
+           #
            # What about early AVX support. The rest of the logic is slightly different as
            # we need to include some of the SSE4.1 and SSE3 instructions. So, we first check
            # if we can compile AVX code without a flag, then we validate that we have support
@@ -232,6 +283,9 @@ AC_DEFUN([MCA_ompi_op_avx_CONFIG],[
     AC_DEFINE_UNQUOTED([OMPI_MCA_OP_HAVE_AVX2],
                        [$op_avx2_support],
                        [AVX2 supported in the current build])
+    AC_DEFINE_UNQUOTED([OMPI_MCA_OP_HAVE_F16C],
+                       [$op_f16c_support],
+                       [F16C supported in the current build])
     AC_DEFINE_UNQUOTED([OMPI_MCA_OP_HAVE_AVX],
                        [$op_avx_support],
                        [AVX supported in the current build])
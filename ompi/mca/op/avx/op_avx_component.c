@@ -19,6 +19,8 @@
 
 #include "ompi_config.h"
 
+#include <string.h>
+
 #include "opal/util/printf.h"
 
 #include "ompi/constants.h"
@@ -33,6 +35,8 @@ static int avx_component_init_query(bool enable_progress_threads,
                                     bool enable_mpi_thread_multiple);
 static struct ompi_op_base_module_1_0_0_t *
     avx_component_op_query(struct ompi_op_t *op, int *priority);
+static struct ompi_op_base_module_1_0_0_t *
+    avx_component_op_query_variant(struct ompi_op_t *op, const char *variant);
 static int avx_component_register(void);
 
 /**
@@ -50,6 +54,7 @@ static uint32_t has_intel_AVX_features(void)
     flags |= _may_i_use_cpu_feature(_FEATURE_AVX512F)  ? OMPI_OP_AVX_HAS_AVX512F_FLAG   : 0;
     flags |= _may_i_use_cpu_feature(_FEATURE_AVX512BW) ? OMPI_OP_AVX_HAS_AVX512BW_FLAG : 0;
     flags |= _may_i_use_cpu_feature(_FEATURE_AVX2)     ? OMPI_OP_AVX_HAS_AVX2_FLAG      : 0;
+    flags |= _may_i_use_cpu_feature(_FEATURE_F16C)     ? OMPI_OP_AVX_HAS_F16C_FLAG      : 0;
     flags |= _may_i_use_cpu_feature(_FEATURE_AVX)      ? OMPI_OP_AVX_HAS_AVX_FLAG       : 0;
     flags |= _may_i_use_cpu_feature(_FEATURE_SSE4_1)   ? OMPI_OP_AVX_HAS_SSE4_1_FLAG    : 0;
     flags |= _may_i_use_cpu_feature(_FEATURE_SSE3)     ? OMPI_OP_AVX_HAS_SSE3_FLAG      : 0;
@@ -87,6 +92,7 @@ static uint32_t has_intel_AVX_features(void)
     const uint32_t avx512f_mask   = (1U << 16);  // AVX512F   (EAX = 7, ECX = 0) : EBX
     const uint32_t avx512_bw_mask = (1U << 30);  // AVX512BW  (EAX = 7, ECX = 0) : EBX
     const uint32_t avx2_mask      = (1U << 5);   // AVX2      (EAX = 7, ECX = 0) : EBX
+    const uint32_t f16c_mask      = (1U << 29);  // F16C      (EAX = 1, ECX = 0) : ECX
     const uint32_t avx_mask       = (1U << 28);  // AVX       (EAX = 1, ECX = 0) : ECX
     const uint32_t sse4_1_mask    = (1U << 19);  // SSE4.1    (EAX = 1, ECX = 0) : ECX
     const uint32_t sse3_mask      = (1U << 0);   // SSE3      (EAX = 1, ECX = 0) : ECX
@@ -95,6 +101,7 @@ static uint32_t has_intel_AVX_features(void)
     uint32_t flags = 0, abcd[4];
 
     run_cpuid( 1, 0, abcd );
+    flags |= (abcd[2] & f16c_mask)      ? OMPI_OP_AVX_HAS_F16C_FLAG     : 0;
     flags |= (abcd[2] & avx_mask)       ? OMPI_OP_AVX_HAS_AVX_FLAG      : 0;
     flags |= (abcd[2] & sse4_1_mask)    ? OMPI_OP_AVX_HAS_SSE4_1_FLAG   : 0;
     flags |= (abcd[2] & sse3_mask)      ? OMPI_OP_AVX_HAS_SSE3_FLAG     : 0;
@@ -134,6 +141,7 @@ ompi_op_avx_component_t mca_op_avx_component = {
 
         .opc_init_query = avx_component_init_query,
         .opc_op_query = avx_component_op_query,
+        .opc_op_query_variant = avx_component_op_query_variant,
     },
 };
 
@@ -180,7 +188,7 @@ avx_component_register(void)
     int32_t requested_flags = mca_op_avx_component.flags = has_intel_AVX_features();
     (void) mca_base_component_var_register(&mca_op_avx_component.super.opc_version,
                                            "support",
-                                           "Level of SSE/MMX/AVX support to be used (combination of processor capabilities as follow SSE 0x01, SSE2 0x02, SSE3 0x04, SSE4.1 0x08, AVX 0x010, AVX2 0x020, AVX512F 0x100, AVX512BW 0x200) capped by the local architecture capabilities",
+                                           "Level of SSE/MMX/AVX support to be used (combination of processor capabilities as follow SSE 0x01, SSE2 0x02, SSE3 0x04, SSE4.1 0x08, AVX 0x010, AVX2 0x020, F16C 0x040, AVX512F 0x100, AVX512BW 0x200) capped by the local architecture capabilities",
                                            MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
                                            OPAL_INFO_LVL_6,
                                            MCA_BASE_VAR_SCOPE_LOCAL,
@@ -214,10 +222,10 @@ avx_component_init_query(bool enable_progress_threads,
  extern ompi_op_base_3buff_handler_fn_t ompi_op_avx_3buff_functions_avx[OMPI_OP_BASE_FORTRAN_OP_MAX][OMPI_OP_BASE_TYPE_MAX];
 #endif
 /*
- * Query whether this component can be used for a specific op
+ * Build a module with the best functions allowed by flags
  */
-static struct ompi_op_base_module_1_0_0_t*
-avx_component_op_query(struct ompi_op_t *op, int *priority)
+static ompi_op_base_module_t*
+avx_component_op_module(struct ompi_op_t *op, uint32_t flags)
 {
     ompi_op_base_module_t *module = NULL;
     /* Sanity check -- although the framework should never invoke the
@@ -235,16 +243,21 @@ avx_component_op_query(struct ompi_op_t *op, int *priority)
     case OMPI_OP_BASE_FORTRAN_BOR:
     case OMPI_OP_BASE_FORTRAN_BAND:
     case OMPI_OP_BASE_FORTRAN_BXOR:
+    case OMPI_OP_BASE_FORTRAN_LAND:
+    case OMPI_OP_BASE_FORTRAN_LOR:
+    case OMPI_OP_BASE_FORTRAN_LXOR:
+    case OMPI_OP_BASE_FORTRAN_MAXLOC:
+    case OMPI_OP_BASE_FORTRAN_MINLOC:
         module = OBJ_NEW(ompi_op_base_module_t);
         for (int i = 0; i < OMPI_OP_BASE_TYPE_MAX; ++i) {
 #if OMPI_MCA_OP_HAVE_AVX512
-            if( mca_op_avx_component.flags & OMPI_OP_AVX_HAS_AVX512F_FLAG ) {
+            if( flags & OMPI_OP_AVX_HAS_AVX512F_FLAG ) {
                 module->opm_fns[i] = ompi_op_avx_functions_avx512[op->o_f_to_c_index][i];
                 module->opm_3buff_fns[i] = ompi_op_avx_3buff_functions_avx512[op->o_f_to_c_index][i];
             }
 #endif
 #if OMPI_MCA_OP_HAVE_AVX2
-            if( mca_op_avx_component.flags & OMPI_OP_AVX_HAS_AVX2_FLAG ) {
+            if( flags & OMPI_OP_AVX_HAS_AVX2_FLAG ) {
                 if( NULL == module->opm_fns[i] ) {
                     module->opm_fns[i] = ompi_op_avx_functions_avx2[op->o_f_to_c_index][i];
                 }
@@ -254,7 +267,7 @@ avx_component_op_query(struct ompi_op_t *op, int *priority)
             }
 #endif
 #if OMPI_MCA_OP_HAVE_AVX
-            if( mca_op_avx_component.flags & OMPI_OP_AVX_HAS_AVX_FLAG ) {
+            if( flags & OMPI_OP_AVX_HAS_AVX_FLAG ) {
                 if( NULL == module->opm_fns[i] ) {
                     module->opm_fns[i] = ompi_op_avx_functions_avx[op->o_f_to_c_index][i];
                 }
@@ -271,15 +284,21 @@ avx_component_op_query(struct ompi_op_t *op, int *priority)
             }
         }
         break;
-    case OMPI_OP_BASE_FORTRAN_LAND:
-    case OMPI_OP_BASE_FORTRAN_LOR:
-    case OMPI_OP_BASE_FORTRAN_LXOR:
-    case OMPI_OP_BASE_FORTRAN_MAXLOC:
-    case OMPI_OP_BASE_FORTRAN_MINLOC:
     case OMPI_OP_BASE_FORTRAN_REPLACE:
     default:
         break;
     }
+    return module;
+}
+
+/*
+ * Query whether this component can be used for a specific op
+ */
+static struct ompi_op_base_module_1_0_0_t*
+avx_component_op_query(struct ompi_op_t *op, int *priority)
+{
+    ompi_op_base_module_t *module = avx_component_op_module(op, mca_op_avx_component.flags);
+
     /* If we got a module from above, we'll return it.  Otherwise,
        we'll return NULL, indicating that this component does not want
        to be considered for selection for this MPI_Op.  Note that the
@@ -293,3 +312,35 @@ avx_component_op_query(struct ompi_op_t *op, int *priority)
     }
     return (ompi_op_base_module_1_0_0_t *) module;
 }
+
+/*
+ * Query a module limited to one flavor ("avx512", "avx2" or "avx") of
+ * the functions, for the selection table of the op base.  The flavor
+ * must be supported by the processor and allowed by the support
+ * parameter.
+ */
+static struct ompi_op_base_module_1_0_0_t*
+avx_component_op_query_variant(struct ompi_op_t *op, const char *variant)
+{
+    uint32_t flags = mca_op_avx_component.flags;
+
+    if (0 == strcmp(variant, "avx512")) {
+        if (!(flags & OMPI_OP_AVX_HAS_AVX512F_FLAG)) {
+            return NULL;
+        }
+    } else if (0 == strcmp(variant, "avx2")) {
+        if (!(flags & OMPI_OP_AVX_HAS_AVX2_FLAG)) {
+            return NULL;
+        }
+        flags &= ~(OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG);
+    } else if (0 == strcmp(variant, "avx")) {
+        if (!(flags & OMPI_OP_AVX_HAS_AVX_FLAG)) {
+            return NULL;
+        }
+        flags &= ~(OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG |
+                   OMPI_OP_AVX_HAS_AVX2_FLAG);
+    } else {
+        return NULL;
+    }
+    return (ompi_op_base_module_1_0_0_t *) avx_component_op_module(op, flags);
+}
@@ -16,6 +16,8 @@
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
 #endif
+#include <limits.h>
+#include <string.h>
 #include "opal/util/output.h"
 
 #include "ompi/op/op.h"
@@ -575,6 +577,580 @@ static void OP_CONCAT(ompi_op_avx_2buff_##op##_double,PREPEND)(const void *_in,
     // not defined - OP_AVX_FLOAT_FUNC(xor)
     // not defined - OP_AVX_DOUBLE_FUNC(xor)
 
+/*
+ * The logical operators and the MINLOC/MAXLOC pair types have no vector
+ * counterpart in SSE/AVX, they are only provided when AVX2 (or better)
+ * is available.
+ */
+#if defined(GENERATE_AVX2_CODE) && defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2)
+
+/*
+ * Logical operators: every element is first normalized to 0 or 1, and the
+ * normalized values are combined with the corresponding bitwise operation.
+ *
+ *  Support ops: land, lor, lxor for signed/unsigned 8,16,32,64
+ */
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_LOGICAL_FUNC(name, type_size, type, op)           \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG) ) { \
+        const __m512i one = _mm512_set1_epi##type_size(1);              \
+        types_per_step = (512 / 8) / sizeof(type);                      \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512i vecA =  _mm512_loadu_si512((__m512i*)in);           \
+            in += types_per_step;                                       \
+            __m512i vecB =  _mm512_loadu_si512((__m512i*)out);          \
+            vecA = _mm512_maskz_mov_epi##type_size(_mm512_test_epi##type_size##_mask(vecA, vecA), one); \
+            vecB = _mm512_maskz_mov_epi##type_size(_mm512_test_epi##type_size##_mask(vecB, vecB), one); \
+            __m512i res = _mm512_##op##_si512(vecA, vecB);              \
+            _mm512_storeu_si512((__m512i*)out, res);                    \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_LOGICAL_FUNC(name, type_size, type, op) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+/* The non-zero elements are all ones after the comparison, 0 - x turns
+ * them into 1 whatever the size of the elements */
+#define OP_AVX_AVX2_LOGICAL_FUNC(name, type_size, type, op)             \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX2_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        const __m256i zero = _mm256_setzero_si256();                    \
+        const __m256i ones = _mm256_set1_epi32(-1);                     \
+        types_per_step = (256 / 8) / sizeof(type);                      \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256i vecA = _mm256_loadu_si256((__m256i*)in);            \
+            in += types_per_step;                                       \
+            __m256i vecB = _mm256_loadu_si256((__m256i*)out);           \
+            vecA = _mm256_andnot_si256(_mm256_cmpeq_epi##type_size(vecA, zero), ones); \
+            vecB = _mm256_andnot_si256(_mm256_cmpeq_epi##type_size(vecB, zero), ones); \
+            __m256i res = _mm256_##op##_si256(vecA, vecB);              \
+            _mm256_storeu_si256((__m256i*)out, _mm256_sub_epi##type_size(zero, res)); \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+
+#define OP_AVX_LOGICAL_FUNC(name, type_size, type, op)                  \
+static void OP_CONCAT(ompi_op_avx_2buff_##name##_##type,PREPEND)(const void *_in, void *_out, int *count, \
+                                                       struct ompi_datatype_t **dtype, \
+                                                       struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    type *in = (type*)_in, *out = (type*)_out;                          \
+    OP_AVX_AVX512_LOGICAL_FUNC(name, type_size, type, op);              \
+    OP_AVX_AVX2_LOGICAL_FUNC(name, type_size, type, op);                \
+    while( left_over > 0 ) {                                            \
+        int how_much = (left_over > 8) ? 8 : left_over;                 \
+        switch(how_much) {                                              \
+        case 8: out[7] = current_func(out[7], in[7]);                   \
+        case 7: out[6] = current_func(out[6], in[6]);                   \
+        case 6: out[5] = current_func(out[5], in[5]);                   \
+        case 5: out[4] = current_func(out[4], in[4]);                   \
+        case 4: out[3] = current_func(out[3], in[3]);                   \
+        case 3: out[2] = current_func(out[2], in[2]);                   \
+        case 2: out[1] = current_func(out[1], in[1]);                   \
+        case 1: out[0] = current_func(out[0], in[0]);                   \
+        }                                                               \
+        left_over -= how_much;                                          \
+        out += how_much;                                                \
+        in += how_much;                                                 \
+    }                                                                   \
+}
+
+/*
+ * MINLOC and MAXLOC on the (value, index) pairs, with the same layout as
+ * the base component.  Each pair is either kept or replaced as a whole:
+ * the comparison of the values and the comparison of the indexes (for
+ * equal values, the lowest index wins) are broadcast to all the 32 bits
+ * words of the pair with a shuffle, and the pairs are then blended.  A
+ * pair with an equal value keeps its value, only the index may change,
+ * so that the result is the same as in the base component, down to the
+ * sign of the zeros.
+ *
+ *  Support types: 2int, float_int, double_int
+ */
+#define OP_AVX_LOC_STRUCT(type_name, type1, type2)                      \
+    typedef struct {                                                    \
+        type1 v;                                                        \
+        type2 k;                                                        \
+    } ompi_op_avx_##type_name##_t;
+
+OP_AVX_LOC_STRUCT(2int, int, int)
+OP_AVX_LOC_STRUCT(float_int, float, int)
+OP_AVX_LOC_STRUCT(double_int, double, int)
+
+/* Shuffles broadcasting the value (V) and the index (K) words of each pair
+ * to the whole pair, and the 64 bits patterns of the index words in each
+ * 128 bits lane (high, low) */
+#define OP_AVX_LOC_VSHUF_2int        _MM_SHUFFLE(2, 2, 0, 0)
+#define OP_AVX_LOC_KSHUF_2int        _MM_SHUFFLE(3, 3, 1, 1)
+#define OP_AVX_LOC_KSLOT_2int        (long long)0xffffffff00000000ULL, (long long)0xffffffff00000000ULL
+#define OP_AVX_LOC_VSHUF_float_int   _MM_SHUFFLE(2, 2, 0, 0)
+#define OP_AVX_LOC_KSHUF_float_int   _MM_SHUFFLE(3, 3, 1, 1)
+#define OP_AVX_LOC_KSLOT_float_int   (long long)0xffffffff00000000ULL, (long long)0xffffffff00000000ULL
+#define OP_AVX_LOC_VSHUF_double_int  _MM_SHUFFLE(1, 0, 1, 0)
+#define OP_AVX_LOC_KSHUF_double_int  _MM_SHUFFLE(2, 2, 2, 2)
+#define OP_AVX_LOC_KSLOT_double_int  (long long)0x00000000ffffffffULL, 0LL
+
+/* Comparison of the values: maxloc takes the greater, minloc the lower */
+#define OP_AVX_LOC_BETTER_maxloc(GT, a, b) GT(a, b)
+#define OP_AVX_LOC_BETTER_minloc(GT, a, b) GT(b, a)
+
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_LOC_MASK(mask)    _mm512_maskz_mov_epi32((mask), _mm512_set1_epi32(-1))
+#define OP_AVX_AVX512_LOC_MASK64(mask)  _mm512_maskz_mov_epi64((mask), _mm512_set1_epi32(-1))
+#define OP_AVX_AVX512_LOC_GT_2int(a, b)        OP_AVX_AVX512_LOC_MASK(_mm512_cmpgt_epi32_mask(a, b))
+#define OP_AVX_AVX512_LOC_EQ_2int(a, b)        OP_AVX_AVX512_LOC_MASK(_mm512_cmpeq_epi32_mask(a, b))
+#define OP_AVX_AVX512_LOC_GT_float_int(a, b)   \
+    OP_AVX_AVX512_LOC_MASK(_mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_GT_OQ))
+#define OP_AVX_AVX512_LOC_EQ_float_int(a, b)   \
+    OP_AVX_AVX512_LOC_MASK(_mm512_cmp_ps_mask(_mm512_castsi512_ps(a), _mm512_castsi512_ps(b), _CMP_EQ_OQ))
+#define OP_AVX_AVX512_LOC_GT_double_int(a, b)  \
+    OP_AVX_AVX512_LOC_MASK64(_mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_GT_OQ))
+#define OP_AVX_AVX512_LOC_EQ_double_int(a, b)  \
+    OP_AVX_AVX512_LOC_MASK64(_mm512_cmp_pd_mask(_mm512_castsi512_pd(a), _mm512_castsi512_pd(b), _CMP_EQ_OQ))
+
+#define OP_AVX_AVX512_LOC_FUNC(name, type_name)                         \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        const __m512i kslot = _mm512_set4_epi64(OP_AVX_LOC_KSLOT_##type_name, OP_AVX_LOC_KSLOT_##type_name); \
+        types_per_step = (512 / 8) / sizeof(ompi_op_avx_##type_name##_t); \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512i vecA =  _mm512_loadu_si512((__m512i*)in);           \
+            in += types_per_step;                                       \
+            __m512i vecB =  _mm512_loadu_si512((__m512i*)out);          \
+            __m512i better = _mm512_shuffle_epi32(OP_AVX_LOC_BETTER_##name(OP_AVX_AVX512_LOC_GT_##type_name, vecA, vecB), \
+                                                  OP_AVX_LOC_VSHUF_##type_name); \
+            __m512i equal = _mm512_shuffle_epi32(OP_AVX_AVX512_LOC_EQ_##type_name(vecA, vecB), \
+                                                 OP_AVX_LOC_VSHUF_##type_name); \
+            __m512i lower = _mm512_shuffle_epi32(OP_AVX_AVX512_LOC_GT_2int(vecB, vecA), \
+                                                 OP_AVX_LOC_KSHUF_##type_name); \
+            __m512i take = _mm512_or_si512(better, _mm512_and_si512(equal, _mm512_and_si512(lower, kslot))); \
+            __m512i res = _mm512_mask_blend_epi32(_mm512_test_epi32_mask(take, take), vecB, vecA); \
+            _mm512_storeu_si512((__m512i*)out, res);                    \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_LOC_FUNC(name, type_name) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#define OP_AVX_AVX2_LOC_GT_2int(a, b)        _mm256_cmpgt_epi32(a, b)
+#define OP_AVX_AVX2_LOC_EQ_2int(a, b)        _mm256_cmpeq_epi32(a, b)
+#define OP_AVX_AVX2_LOC_GT_float_int(a, b)   \
+    _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_GT_OQ))
+#define OP_AVX_AVX2_LOC_EQ_float_int(a, b)   \
+    _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ))
+#define OP_AVX_AVX2_LOC_GT_double_int(a, b)  \
+    _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_GT_OQ))
+#define OP_AVX_AVX2_LOC_EQ_double_int(a, b)  \
+    _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ))
+
+#define OP_AVX_AVX2_LOC_FUNC(name, type_name)                           \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX2_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        const __m256i kslot = _mm256_set_epi64x(OP_AVX_LOC_KSLOT_##type_name, OP_AVX_LOC_KSLOT_##type_name); \
+        types_per_step = (256 / 8) / sizeof(ompi_op_avx_##type_name##_t); \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256i vecA = _mm256_loadu_si256((__m256i*)in);            \
+            in += types_per_step;                                       \
+            __m256i vecB = _mm256_loadu_si256((__m256i*)out);           \
+            __m256i better = _mm256_shuffle_epi32(OP_AVX_LOC_BETTER_##name(OP_AVX_AVX2_LOC_GT_##type_name, vecA, vecB), \
+                                                  OP_AVX_LOC_VSHUF_##type_name); \
+            __m256i equal = _mm256_shuffle_epi32(OP_AVX_AVX2_LOC_EQ_##type_name(vecA, vecB), \
+                                                 OP_AVX_LOC_VSHUF_##type_name); \
+            __m256i lower = _mm256_shuffle_epi32(_mm256_cmpgt_epi32(vecB, vecA), \
+                                                 OP_AVX_LOC_KSHUF_##type_name); \
+            __m256i take = _mm256_or_si256(better, _mm256_and_si256(equal, _mm256_and_si256(lower, kslot))); \
+            _mm256_storeu_si256((__m256i*)out, _mm256_blendv_epi8(vecB, vecA, take)); \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+
+#define OP_AVX_LOC_FUNC(name, type_name)                                \
+static void OP_CONCAT(ompi_op_avx_2buff_##name##_##type_name,PREPEND)(const void *_in, void *_out, int *count, \
+                                                            struct ompi_datatype_t **dtype, \
+                                                            struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    ompi_op_avx_##type_name##_t *in = (ompi_op_avx_##type_name##_t*)_in, \
+        *out = (ompi_op_avx_##type_name##_t*)_out;                      \
+    OP_AVX_AVX512_LOC_FUNC(name, type_name);                            \
+    OP_AVX_AVX2_LOC_FUNC(name, type_name);                              \
+    for( ; left_over > 0; --left_over, ++in, ++out ) {                  \
+        if( current_func(in->v, out->v) ) {                             \
+            out->v = in->v;                                             \
+            out->k = in->k;                                             \
+        } else if( in->v == out->v ) {                                  \
+            out->k = (out->k < in->k ? out->k : in->k);                 \
+        }                                                               \
+    }                                                                   \
+}
+
+/*************************************************************************
+ * Logical AND
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) && (b))
+    OP_AVX_LOGICAL_FUNC(land, 8,    int8_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 8,   uint8_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 16,  int16_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 16, uint16_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 32,  int32_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 32, uint32_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 64,  int64_t, and)
+    OP_AVX_LOGICAL_FUNC(land, 64, uint64_t, and)
+
+/*************************************************************************
+ * Logical OR
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) || (b))
+    OP_AVX_LOGICAL_FUNC(lor, 8,    int8_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 8,   uint8_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 16,  int16_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 16, uint16_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 32,  int32_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 32, uint32_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 64,  int64_t, or)
+    OP_AVX_LOGICAL_FUNC(lor, 64, uint64_t, or)
+
+/*************************************************************************
+ * Logical XOR
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a ? 1 : 0) ^ (b ? 1: 0))
+    OP_AVX_LOGICAL_FUNC(lxor, 8,    int8_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 8,   uint8_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 16,  int16_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 16, uint16_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 32,  int32_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 32, uint32_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 64,  int64_t, xor)
+    OP_AVX_LOGICAL_FUNC(lxor, 64, uint64_t, xor)
+
+/*************************************************************************
+ * Max location
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) > (b))
+    OP_AVX_LOC_FUNC(maxloc, 2int)
+    OP_AVX_LOC_FUNC(maxloc, float_int)
+    OP_AVX_LOC_FUNC(maxloc, double_int)
+
+/*************************************************************************
+ * Min location
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) < (b))
+    OP_AVX_LOC_FUNC(minloc, 2int)
+    OP_AVX_LOC_FUNC(minloc, float_int)
+    OP_AVX_LOC_FUNC(minloc, double_int)
+
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2) */
+
+/*
+ * Complex numbers: the real and imaginary parts are stored next to each
+ * other, the sum is the sum of the underlying reals over twice as many
+ * elements.  The product (a, b) * (c, d) = (a*c - b*d, b*c + a*d) is
+ * computed by multiplying the first operand by the duplicated real parts
+ * and its swapped parts by the duplicated imaginary parts of the second
+ * one, the two products being then subtracted on the real parts and
+ * added on the imaginary parts.  Like the scalar version there is no
+ * special handling of the infinities and NaNs (C99 Annex G).
+ *
+ *  Support ops: sum, prod for C float complex, C double complex
+ */
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+static inline __m512 ompi_op_avx512_cmul_ps(__m512 vecA, __m512 vecB)
+{
+    __m512 re = _mm512_mul_ps(vecA, _mm512_moveldup_ps(vecB));
+    __m512 im = _mm512_mul_ps(_mm512_permute_ps(vecA, 0xB1), _mm512_movehdup_ps(vecB));
+    return _mm512_mask_add_ps(_mm512_sub_ps(re, im), 0xAAAA, re, im);
+}
+
+static inline __m512d ompi_op_avx512_cmul_pd(__m512d vecA, __m512d vecB)
+{
+    __m512d re = _mm512_mul_pd(vecA, _mm512_movedup_pd(vecB));
+    __m512d im = _mm512_mul_pd(_mm512_permute_pd(vecA, 0x55), _mm512_permute_pd(vecB, 0xFF));
+    return _mm512_mask_add_pd(_mm512_sub_pd(re, im), 0xAA, re, im);
+}
+
+#define OP_AVX_AVX512_COMPLEX_PROD_FUNC(type, sfx)                      \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        types_per_step = (512 / 8) / (2 * sizeof(type));                \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            _mm512_storeu_##sfx(out, ompi_op_avx512_cmul_##sfx(_mm512_loadu_##sfx(in), \
+                                                               _mm512_loadu_##sfx(out))); \
+            in += 2 * types_per_step;                                   \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_COMPLEX_PROD_FUNC(type, sfx) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#if defined(GENERATE_AVX2_CODE) && defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2)
+static inline __m256 ompi_op_avx_cmul_ps(__m256 vecA, __m256 vecB)
+{
+    __m256 re = _mm256_mul_ps(vecA, _mm256_moveldup_ps(vecB));
+    __m256 im = _mm256_mul_ps(_mm256_permute_ps(vecA, 0xB1), _mm256_movehdup_ps(vecB));
+    return _mm256_addsub_ps(re, im);
+}
+
+static inline __m256d ompi_op_avx_cmul_pd(__m256d vecA, __m256d vecB)
+{
+    __m256d re = _mm256_mul_pd(vecA, _mm256_movedup_pd(vecB));
+    __m256d im = _mm256_mul_pd(_mm256_permute_pd(vecA, 0x5), _mm256_permute_pd(vecB, 0xF));
+    return _mm256_addsub_pd(re, im);
+}
+
+#define OP_AVX_AVX_COMPLEX_PROD_FUNC(type, sfx)                         \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX_FLAG) ) {             \
+        types_per_step = (256 / 8) / (2 * sizeof(type));                \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            _mm256_storeu_##sfx(out, ompi_op_avx_cmul_##sfx(_mm256_loadu_##sfx(in), \
+                                                            _mm256_loadu_##sfx(out))); \
+            in += 2 * types_per_step;                                   \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX_COMPLEX_PROD_FUNC(type, sfx) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2) */
+
+#if defined(GENERATE_SSE3_CODE) && defined(OMPI_MCA_OP_HAVE_AVX) && (1 == OMPI_MCA_OP_HAVE_AVX)
+static inline __m128 ompi_op_sse3_cmul_ps(__m128 vecA, __m128 vecB)
+{
+    __m128 re = _mm_mul_ps(vecA, _mm_moveldup_ps(vecB));
+    __m128 im = _mm_mul_ps(_mm_shuffle_ps(vecA, vecA, 0xB1), _mm_movehdup_ps(vecB));
+    return _mm_addsub_ps(re, im);
+}
+
+static inline __m128d ompi_op_sse3_cmul_pd(__m128d vecA, __m128d vecB)
+{
+    __m128d re = _mm_mul_pd(vecA, _mm_movedup_pd(vecB));
+    __m128d im = _mm_mul_pd(_mm_shuffle_pd(vecA, vecA, 0x1), _mm_unpackhi_pd(vecB, vecB));
+    return _mm_addsub_pd(re, im);
+}
+
+/* A single float complex can be left, use the lower half of the vectors
+ * instead of the scalar code, which the compiler could contract in FMAs */
+#define OP_AVX_SSE3_COMPLEX_PROD_TAIL_ps(a, b, o)                       \
+        if( 0 != left_over ) {                                          \
+            __m128 res = ompi_op_sse3_cmul_ps(_mm_castpd_ps(_mm_load_sd((double*)(a))), \
+                                              _mm_castpd_ps(_mm_load_sd((double*)(b)))); \
+            _mm_store_sd((double*)(o), _mm_castps_pd(res));             \
+            return;                                                     \
+        }
+#define OP_AVX_SSE3_COMPLEX_PROD_TAIL_pd(a, b, o)
+
+#define OP_AVX_SSE3_COMPLEX_PROD_FUNC(type, sfx)                        \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_SSE3_FLAG) ) {            \
+        types_per_step = (128 / 8) / (2 * sizeof(type));                \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            _mm_storeu_##sfx(out, ompi_op_sse3_cmul_##sfx(_mm_loadu_##sfx(in), \
+                                                          _mm_loadu_##sfx(out))); \
+            in += 2 * types_per_step;                                   \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        OP_AVX_SSE3_COMPLEX_PROD_TAIL_##sfx(in, out, out)               \
+    }
+#else
+#define OP_AVX_SSE3_COMPLEX_PROD_FUNC(type, sfx) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX) && (1 == OMPI_MCA_OP_HAVE_AVX) */
+
+#define OP_AVX_COMPLEX_PROD_FUNC(type_name, type, sfx)                  \
+static void OP_CONCAT(ompi_op_avx_2buff_prod_##type_name,PREPEND)(const void *_in, void *_out, int *count, \
+                                                                  struct ompi_datatype_t **dtype, \
+                                                                  struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    type *in = (type*)_in, *out = (type*)_out;                          \
+    OP_AVX_AVX512_COMPLEX_PROD_FUNC(type, sfx);                         \
+    OP_AVX_AVX_COMPLEX_PROD_FUNC(type, sfx);                            \
+    OP_AVX_SSE3_COMPLEX_PROD_FUNC(type, sfx);                           \
+    for( ; left_over > 0; --left_over, in += 2, out += 2 ) {            \
+        type re = in[0] * out[0] - in[1] * out[1];                      \
+        out[1] = in[1] * out[0] + in[0] * out[1];                       \
+        out[0] = re;                                                    \
+    }                                                                   \
+}
+
+/* The count of reals must fit in an int */
+#define OP_AVX_COMPLEX_SUM_FUNC(type_name, type, real_name)             \
+static void OP_CONCAT(ompi_op_avx_2buff_sum_##type_name,PREPEND)(const void *_in, void *_out, int *count, \
+                                                                 struct ompi_datatype_t **dtype, \
+                                                                 struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int left_over = *count;                                             \
+    type *in = (type*)_in, *out = (type*)_out;                          \
+    while( left_over > 0 ) {                                            \
+        int how_much = (left_over > (INT_MAX / 2)) ? (INT_MAX / 2) : left_over; \
+        int num_reals = 2 * how_much;                                   \
+        OP_CONCAT(ompi_op_avx_2buff_add_##real_name,PREPEND)(in, out, &num_reals, dtype, module); \
+        left_over -= how_much;                                          \
+        in += num_reals;                                                \
+        out += num_reals;                                               \
+    }                                                                   \
+}
+
+/*
+ * Short float: the values are converted to single precision (F16C or
+ * AVX512F), combined and rounded back to half precision, which gives the
+ * same result as the half precision operation for a single sum, product,
+ * max or min.  Only available when opal_short_float_t is the 16 bits
+ * IEEE 754 type.
+ *
+ *  Support ops: max, min, sum, prod for short float
+ *               sum, prod for C short float complex
+ */
+#if defined(GENERATE_AVX2_CODE) && defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2) && \
+    defined(OMPI_MCA_OP_HAVE_F16C) && (1 == OMPI_MCA_OP_HAVE_F16C) &&  \
+    defined(HAVE_OPAL_SHORT_FLOAT_T) && (2 == SIZEOF_OPAL_SHORT_FLOAT_T)
+#define OP_AVX_HAVE_SHORT_FLOAT 1
+
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_LOAD_PH(p)  _mm512_cvtph_ps(_mm256_loadu_si256((__m256i*)(p)))
+#define OP_AVX_AVX512_STORE_PH(p, v) \
+    _mm256_storeu_si256((__m256i*)(p), _mm512_cvtps_ph((v), _MM_FROUND_TO_NEAREST_INT))
+
+#define OP_AVX_AVX512_SHORT_FLOAT_FUNC(op)                              \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        types_per_step = (512 / 8) / sizeof(float);                     \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512 res = _mm512_##op##_ps(OP_AVX_AVX512_LOAD_PH(in), OP_AVX_AVX512_LOAD_PH(out)); \
+            OP_AVX_AVX512_STORE_PH(out, res);                           \
+            in += types_per_step;                                       \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+
+#define OP_AVX_AVX512_SHORT_FLOAT_COMPLEX_PROD_FUNC                     \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        types_per_step = (512 / 8) / (2 * sizeof(float));               \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512 res = ompi_op_avx512_cmul_ps(OP_AVX_AVX512_LOAD_PH(in), OP_AVX_AVX512_LOAD_PH(out)); \
+            OP_AVX_AVX512_STORE_PH(out, res);                           \
+            in += 2 * types_per_step;                                   \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_SHORT_FLOAT_FUNC(op) {}
+#define OP_AVX_AVX512_SHORT_FLOAT_COMPLEX_PROD_FUNC {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#define OP_AVX_F16C_LOAD_PH(p)  _mm256_cvtph_ps(_mm_loadu_si128((__m128i*)(p)))
+#define OP_AVX_F16C_STORE_PH(p, v) \
+    _mm_storeu_si128((__m128i*)(p), _mm256_cvtps_ph((v), _MM_FROUND_TO_NEAREST_INT))
+
+#define OP_AVX_F16C_SHORT_FLOAT_FUNC(op)                                \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_F16C_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        types_per_step = (256 / 8) / sizeof(float);                     \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256 res = _mm256_##op##_ps(OP_AVX_F16C_LOAD_PH(in), OP_AVX_F16C_LOAD_PH(out)); \
+            OP_AVX_F16C_STORE_PH(out, res);                             \
+            in += types_per_step;                                       \
+            out += types_per_step;                                      \
+        }                                                               \
+    }
+
+/* The last complex are padded to a full vector */
+#define OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_TAIL(a, b, o)              \
+        if( 0 != left_over ) {                                          \
+            opal_short_float_t tmp_a[8] = {0}, tmp_b[8] = {0};          \
+            memcpy(tmp_a, (a), 2 * left_over * sizeof(opal_short_float_t)); \
+            memcpy(tmp_b, (b), 2 * left_over * sizeof(opal_short_float_t)); \
+            OP_AVX_F16C_STORE_PH(tmp_b, ompi_op_avx_cmul_ps(OP_AVX_F16C_LOAD_PH(tmp_a), \
+                                                            OP_AVX_F16C_LOAD_PH(tmp_b))); \
+            memcpy((o), tmp_b, 2 * left_over * sizeof(opal_short_float_t)); \
+            return;                                                     \
+        }
+
+#define OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_FUNC                       \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_F16C_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        types_per_step = (256 / 8) / (2 * sizeof(float));               \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256 res = ompi_op_avx_cmul_ps(OP_AVX_F16C_LOAD_PH(in), OP_AVX_F16C_LOAD_PH(out)); \
+            OP_AVX_F16C_STORE_PH(out, res);                             \
+            in += 2 * types_per_step;                                   \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_TAIL(in, out, out)         \
+    }
+
+#define OP_AVX_SHORT_FLOAT_FUNC(op)                                     \
+static void OP_CONCAT(ompi_op_avx_2buff_##op##_short_float,PREPEND)(const void *_in, void *_out, int *count, \
+                                                                    struct ompi_datatype_t **dtype, \
+                                                                    struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    opal_short_float_t *in = (opal_short_float_t*)_in, *out = (opal_short_float_t*)_out; \
+    OP_AVX_AVX512_SHORT_FLOAT_FUNC(op);                                 \
+    OP_AVX_F16C_SHORT_FLOAT_FUNC(op);                                   \
+    for( ; left_over > 0; --left_over, ++in, ++out ) {                  \
+        *out = current_func(*out, *in);                                 \
+    }                                                                   \
+}
+
+#define OP_AVX_SHORT_FLOAT_COMPLEX_PROD_FUNC                            \
+static void OP_CONCAT(ompi_op_avx_2buff_prod_c_short_float_complex,PREPEND)(const void *_in, void *_out, int *count, \
+                                                                            struct ompi_datatype_t **dtype, \
+                                                                            struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    opal_short_float_t *in = (opal_short_float_t*)_in, *out = (opal_short_float_t*)_out; \
+    OP_AVX_AVX512_SHORT_FLOAT_COMPLEX_PROD_FUNC;                        \
+    OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_FUNC;                          \
+    for( ; left_over > 0; --left_over, in += 2, out += 2 ) {            \
+        float re = (float)in[0] * (float)out[0] - (float)in[1] * (float)out[1]; \
+        float im = (float)in[1] * (float)out[0] + (float)in[0] * (float)out[1]; \
+        out[0] = (opal_short_float_t)re;                                \
+        out[1] = (opal_short_float_t)im;                                \
+    }                                                                   \
+}
+#else
+#define OP_AVX_HAVE_SHORT_FLOAT 0
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2) && F16C && short float */
+
+/*************************************************************************
+ * Complex sum
+ *************************************************************************/
+    OP_AVX_COMPLEX_SUM_FUNC(c_float_complex, float, float)
+    OP_AVX_COMPLEX_SUM_FUNC(c_double_complex, double, double)
+
+/*************************************************************************
+ * Complex product
+ *************************************************************************/
+    OP_AVX_COMPLEX_PROD_FUNC(c_float_complex, float, ps)
+    OP_AVX_COMPLEX_PROD_FUNC(c_double_complex, double, pd)
+
+#if OP_AVX_HAVE_SHORT_FLOAT
+/*************************************************************************
+ * Short float max, min, sum, product
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) > (b) ? (a) : (b))
+    OP_AVX_SHORT_FLOAT_FUNC(max)
+#undef current_func
+#define current_func(a, b) ((a) < (b) ? (a) : (b))
+    OP_AVX_SHORT_FLOAT_FUNC(min)
+#undef current_func
+#define current_func(a, b) ((a) + (b))
+    OP_AVX_SHORT_FLOAT_FUNC(add)
+    OP_AVX_COMPLEX_SUM_FUNC(c_short_float_complex, opal_short_float_t, short_float)
+#undef current_func
+#define current_func(a, b) ((a) * (b))
+    OP_AVX_SHORT_FLOAT_FUNC(mul)
+    OP_AVX_SHORT_FLOAT_COMPLEX_PROD_FUNC
+#endif  /* OP_AVX_HAVE_SHORT_FLOAT */
+
 /*
  *  This is a three buffer (2 input and 1 output) version of the reduction
  *  routines, needed for some optimizations.
@@ -1111,6 +1687,432 @@ static void OP_CONCAT(ompi_op_avx_3buff_##op##_double,PREPEND)(const void *_in1,
     // not defined - OP_AVX_FLOAT_FUNC_3(xor)
     // not defined - OP_AVX_DOUBLE_FUNC_3(xor)
 
+#if defined(GENERATE_AVX2_CODE) && defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2)
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_LOGICAL_FUNC_3(name, type_size, type, op)         \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG | OMPI_OP_AVX_HAS_AVX512BW_FLAG) ) { \
+        const __m512i one = _mm512_set1_epi##type_size(1);              \
+        types_per_step = (512 / 8) / sizeof(type);                      \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512i vecA =  _mm512_loadu_si512(in1);                    \
+            __m512i vecB =  _mm512_loadu_si512(in2);                    \
+            in1 += types_per_step;                                      \
+            in2 += types_per_step;                                      \
+            vecA = _mm512_maskz_mov_epi##type_size(_mm512_test_epi##type_size##_mask(vecA, vecA), one); \
+            vecB = _mm512_maskz_mov_epi##type_size(_mm512_test_epi##type_size##_mask(vecB, vecB), one); \
+            __m512i res = _mm512_##op##_si512(vecA, vecB);              \
+            _mm512_storeu_si512(out, res);                              \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_LOGICAL_FUNC_3(name, type_size, type, op) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#define OP_AVX_AVX2_LOGICAL_FUNC_3(name, type_size, type, op)           \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX2_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        const __m256i zero = _mm256_setzero_si256();                    \
+        const __m256i ones = _mm256_set1_epi32(-1);                     \
+        types_per_step = (256 / 8) / sizeof(type);                      \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256i vecA = _mm256_loadu_si256((__m256i*)in1);           \
+            __m256i vecB = _mm256_loadu_si256((__m256i*)in2);           \
+            in1 += types_per_step;                                      \
+            in2 += types_per_step;                                      \
+            vecA = _mm256_andnot_si256(_mm256_cmpeq_epi##type_size(vecA, zero), ones); \
+            vecB = _mm256_andnot_si256(_mm256_cmpeq_epi##type_size(vecB, zero), ones); \
+            __m256i res = _mm256_##op##_si256(vecA, vecB);              \
+            _mm256_storeu_si256((__m256i*)out, _mm256_sub_epi##type_size(zero, res)); \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+
+#define OP_AVX_LOGICAL_FUNC_3(name, type_size, type, op)                \
+static void OP_CONCAT(ompi_op_avx_3buff_##name##_##type,PREPEND)(const void *_in1, const void *_in2, \
+                                                               void *_out, int *count, \
+                                                               struct ompi_datatype_t **dtype, \
+                                                               struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    type *in1 = (type*)_in1, *in2 = (type*)_in2, *out = (type*)_out;    \
+    OP_AVX_AVX512_LOGICAL_FUNC_3(name, type_size, type, op);            \
+    OP_AVX_AVX2_LOGICAL_FUNC_3(name, type_size, type, op);              \
+    while( left_over > 0 ) {                                            \
+        int how_much = (left_over > 8) ? 8 : left_over;                 \
+        switch(how_much) {                                              \
+        case 8: out[7] = current_func(in1[7], in2[7]);                  \
+        case 7: out[6] = current_func(in1[6], in2[6]);                  \
+        case 6: out[5] = current_func(in1[5], in2[5]);                  \
+        case 5: out[4] = current_func(in1[4], in2[4]);                  \
+        case 4: out[3] = current_func(in1[3], in2[3]);                  \
+        case 3: out[2] = current_func(in1[2], in2[2]);                  \
+        case 2: out[1] = current_func(in1[1], in2[1]);                  \
+        case 1: out[0] = current_func(in1[0], in2[0]);                  \
+        }                                                               \
+        left_over -= how_much;                                          \
+        out += how_much;                                                \
+        in1 += how_much;                                                \
+        in2 += how_much;                                                \
+    }                                                                   \
+}
+
+/*
+ * With three buffers the pair of the first input is taken for equal
+ * values, unless the second input has a lower index.
+ */
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_LOC_FUNC_3(name, type_name)                       \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        const __m512i kslot = _mm512_set4_epi64(OP_AVX_LOC_KSLOT_##type_name, OP_AVX_LOC_KSLOT_##type_name); \
+        types_per_step = (512 / 8) / sizeof(ompi_op_avx_##type_name##_t); \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512i vecA =  _mm512_loadu_si512(in1);                    \
+            __m512i vecB =  _mm512_loadu_si512(in2);                    \
+            in1 += types_per_step;                                      \
+            in2 += types_per_step;                                      \
+            __m512i better = _mm512_shuffle_epi32(OP_AVX_LOC_BETTER_##name(OP_AVX_AVX512_LOC_GT_##type_name, vecA, vecB), \
+                                                  OP_AVX_LOC_VSHUF_##type_name); \
+            __m512i equal = _mm512_shuffle_epi32(OP_AVX_AVX512_LOC_EQ_##type_name(vecA, vecB), \
+                                                 OP_AVX_LOC_VSHUF_##type_name); \
+            __m512i higher = _mm512_shuffle_epi32(OP_AVX_AVX512_LOC_GT_2int(vecA, vecB), \
+                                                  OP_AVX_LOC_KSHUF_##type_name); \
+            __m512i take = _mm512_or_si512(better, _mm512_andnot_si512(_mm512_and_si512(higher, kslot), equal)); \
+            __m512i res = _mm512_mask_blend_epi32(_mm512_test_epi32_mask(take, take), vecB, vecA); \
+            _mm512_storeu_si512(out, res);                              \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_LOC_FUNC_3(name, type_name) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#define OP_AVX_AVX2_LOC_FUNC_3(name, type_name)                         \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX2_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        const __m256i kslot = _mm256_set_epi64x(OP_AVX_LOC_KSLOT_##type_name, OP_AVX_LOC_KSLOT_##type_name); \
+        types_per_step = (256 / 8) / sizeof(ompi_op_avx_##type_name##_t); \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256i vecA = _mm256_loadu_si256((__m256i*)in1);           \
+            __m256i vecB = _mm256_loadu_si256((__m256i*)in2);           \
+            in1 += types_per_step;                                      \
+            in2 += types_per_step;                                      \
+            __m256i better = _mm256_shuffle_epi32(OP_AVX_LOC_BETTER_##name(OP_AVX_AVX2_LOC_GT_##type_name, vecA, vecB), \
+                                                  OP_AVX_LOC_VSHUF_##type_name); \
+            __m256i equal = _mm256_shuffle_epi32(OP_AVX_AVX2_LOC_EQ_##type_name(vecA, vecB), \
+                                                 OP_AVX_LOC_VSHUF_##type_name); \
+            __m256i higher = _mm256_shuffle_epi32(_mm256_cmpgt_epi32(vecA, vecB), \
+                                                  OP_AVX_LOC_KSHUF_##type_name); \
+            __m256i take = _mm256_or_si256(better, _mm256_andnot_si256(_mm256_and_si256(higher, kslot), equal)); \
+            _mm256_storeu_si256((__m256i*)out, _mm256_blendv_epi8(vecB, vecA, take)); \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+
+#define OP_AVX_LOC_FUNC_3(name, type_name)                              \
+static void OP_CONCAT(ompi_op_avx_3buff_##name##_##type_name,PREPEND)(const void *_in1, const void *_in2, \
+                                                            void *_out, int *count, \
+                                                            struct ompi_datatype_t **dtype, \
+                                                            struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    ompi_op_avx_##type_name##_t *in1 = (ompi_op_avx_##type_name##_t*)_in1, \
+        *in2 = (ompi_op_avx_##type_name##_t*)_in2,                      \
+        *out = (ompi_op_avx_##type_name##_t*)_out;                      \
+    OP_AVX_AVX512_LOC_FUNC_3(name, type_name);                          \
+    OP_AVX_AVX2_LOC_FUNC_3(name, type_name);                            \
+    for( ; left_over > 0; --left_over, ++in1, ++in2, ++out ) {          \
+        if( current_func(in1->v, in2->v) ) {                           \
+            out->v = in1->v;                                            \
+            out->k = in1->k;                                            \
+        } else if( in1->v == in2->v ) {                                 \
+            out->v = in1->v;                                            \
+            out->k = (in2->k < in1->k ? in2->k : in1->k);               \
+        } else {                                                        \
+            out->v = in2->v;                                            \
+            out->k = in2->k;                                            \
+        }                                                               \
+    }                                                                   \
+}
+
+/*************************************************************************
+ * Logical AND
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) && (b))
+    OP_AVX_LOGICAL_FUNC_3(land, 8,    int8_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 8,   uint8_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 16,  int16_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 16, uint16_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 32,  int32_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 32, uint32_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 64,  int64_t, and)
+    OP_AVX_LOGICAL_FUNC_3(land, 64, uint64_t, and)
+
+/*************************************************************************
+ * Logical OR
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) || (b))
+    OP_AVX_LOGICAL_FUNC_3(lor, 8,    int8_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 8,   uint8_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 16,  int16_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 16, uint16_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 32,  int32_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 32, uint32_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 64,  int64_t, or)
+    OP_AVX_LOGICAL_FUNC_3(lor, 64, uint64_t, or)
+
+/*************************************************************************
+ * Logical XOR
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a ? 1 : 0) ^ (b ? 1: 0))
+    OP_AVX_LOGICAL_FUNC_3(lxor, 8,    int8_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 8,   uint8_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 16,  int16_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 16, uint16_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 32,  int32_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 32, uint32_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 64,  int64_t, xor)
+    OP_AVX_LOGICAL_FUNC_3(lxor, 64, uint64_t, xor)
+
+/*************************************************************************
+ * Max location
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) > (b))
+    OP_AVX_LOC_FUNC_3(maxloc, 2int)
+    OP_AVX_LOC_FUNC_3(maxloc, float_int)
+    OP_AVX_LOC_FUNC_3(maxloc, double_int)
+
+/*************************************************************************
+ * Min location
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) < (b))
+    OP_AVX_LOC_FUNC_3(minloc, 2int)
+    OP_AVX_LOC_FUNC_3(minloc, float_int)
+    OP_AVX_LOC_FUNC_3(minloc, double_int)
+
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2) */
+
+/*
+ * Three buffer versions of the complex and short float operations, see
+ * the two buffer versions above.
+ */
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_COMPLEX_PROD_FUNC_3(type, sfx)                    \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        types_per_step = (512 / 8) / (2 * sizeof(type));                \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            _mm512_storeu_##sfx(out, ompi_op_avx512_cmul_##sfx(_mm512_loadu_##sfx(in1), \
+                                                               _mm512_loadu_##sfx(in2))); \
+            in1 += 2 * types_per_step;                                  \
+            in2 += 2 * types_per_step;                                  \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_COMPLEX_PROD_FUNC_3(type, sfx) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#if defined(GENERATE_AVX2_CODE) && defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2)
+#define OP_AVX_AVX_COMPLEX_PROD_FUNC_3(type, sfx)                       \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX_FLAG) ) {             \
+        types_per_step = (256 / 8) / (2 * sizeof(type));                \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            _mm256_storeu_##sfx(out, ompi_op_avx_cmul_##sfx(_mm256_loadu_##sfx(in1), \
+                                                            _mm256_loadu_##sfx(in2))); \
+            in1 += 2 * types_per_step;                                  \
+            in2 += 2 * types_per_step;                                  \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX_COMPLEX_PROD_FUNC_3(type, sfx) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2) */
+
+#if defined(GENERATE_SSE3_CODE) && defined(OMPI_MCA_OP_HAVE_AVX) && (1 == OMPI_MCA_OP_HAVE_AVX)
+#define OP_AVX_SSE3_COMPLEX_PROD_FUNC_3(type, sfx)                      \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_SSE3_FLAG) ) {            \
+        types_per_step = (128 / 8) / (2 * sizeof(type));                \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            _mm_storeu_##sfx(out, ompi_op_sse3_cmul_##sfx(_mm_loadu_##sfx(in1), \
+                                                          _mm_loadu_##sfx(in2))); \
+            in1 += 2 * types_per_step;                                  \
+            in2 += 2 * types_per_step;                                  \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        OP_AVX_SSE3_COMPLEX_PROD_TAIL_##sfx(in1, in2, out)              \
+    }
+#else
+#define OP_AVX_SSE3_COMPLEX_PROD_FUNC_3(type, sfx) {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX) && (1 == OMPI_MCA_OP_HAVE_AVX) */
+
+#define OP_AVX_COMPLEX_PROD_FUNC_3(type_name, type, sfx)                \
+static void OP_CONCAT(ompi_op_avx_3buff_prod_##type_name,PREPEND)(const void *_in1, const void *_in2, \
+                                                                  void *_out, int *count, \
+                                                                  struct ompi_datatype_t **dtype, \
+                                                                  struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    type *in1 = (type*)_in1, *in2 = (type*)_in2, *out = (type*)_out;    \
+    OP_AVX_AVX512_COMPLEX_PROD_FUNC_3(type, sfx);                       \
+    OP_AVX_AVX_COMPLEX_PROD_FUNC_3(type, sfx);                          \
+    OP_AVX_SSE3_COMPLEX_PROD_FUNC_3(type, sfx);                         \
+    for( ; left_over > 0; --left_over, in1 += 2, in2 += 2, out += 2 ) { \
+        out[0] = in1[0] * in2[0] - in1[1] * in2[1];                     \
+        out[1] = in1[1] * in2[0] + in1[0] * in2[1];                     \
+    }                                                                   \
+}
+
+#define OP_AVX_COMPLEX_SUM_FUNC_3(type_name, type, real_name)           \
+static void OP_CONCAT(ompi_op_avx_3buff_sum_##type_name,PREPEND)(const void *_in1, const void *_in2, \
+                                                                 void *_out, int *count, \
+                                                                 struct ompi_datatype_t **dtype, \
+                                                                 struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int left_over = *count;                                             \
+    type *in1 = (type*)_in1, *in2 = (type*)_in2, *out = (type*)_out;    \
+    while( left_over > 0 ) {                                            \
+        int how_much = (left_over > (INT_MAX / 2)) ? (INT_MAX / 2) : left_over; \
+        int num_reals = 2 * how_much;                                   \
+        OP_CONCAT(ompi_op_avx_3buff_add_##real_name,PREPEND)(in1, in2, out, &num_reals, dtype, module); \
+        left_over -= how_much;                                          \
+        in1 += num_reals;                                               \
+        in2 += num_reals;                                               \
+        out += num_reals;                                               \
+    }                                                                   \
+}
+
+#if OP_AVX_HAVE_SHORT_FLOAT
+#if defined(GENERATE_AVX512_CODE) && defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512)
+#define OP_AVX_AVX512_SHORT_FLOAT_FUNC_3(op)                            \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        types_per_step = (512 / 8) / sizeof(float);                     \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512 res = _mm512_##op##_ps(OP_AVX_AVX512_LOAD_PH(in1), OP_AVX_AVX512_LOAD_PH(in2)); \
+            OP_AVX_AVX512_STORE_PH(out, res);                           \
+            in1 += types_per_step;                                      \
+            in2 += types_per_step;                                      \
+            out += types_per_step;                                      \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+
+#define OP_AVX_AVX512_SHORT_FLOAT_COMPLEX_PROD_FUNC_3                   \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_AVX512F_FLAG) ) {         \
+        types_per_step = (512 / 8) / (2 * sizeof(float));               \
+        for (; left_over >= types_per_step; left_over -= types_per_step) { \
+            __m512 res = ompi_op_avx512_cmul_ps(OP_AVX_AVX512_LOAD_PH(in1), OP_AVX_AVX512_LOAD_PH(in2)); \
+            OP_AVX_AVX512_STORE_PH(out, res);                           \
+            in1 += 2 * types_per_step;                                  \
+            in2 += 2 * types_per_step;                                  \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        if( 0 == left_over ) return;                                    \
+    }
+#else
+#define OP_AVX_AVX512_SHORT_FLOAT_FUNC_3(op) {}
+#define OP_AVX_AVX512_SHORT_FLOAT_COMPLEX_PROD_FUNC_3 {}
+#endif  /* defined(OMPI_MCA_OP_HAVE_AVX512) && (1 == OMPI_MCA_OP_HAVE_AVX512) */
+
+#define OP_AVX_F16C_SHORT_FLOAT_FUNC_3(op)                              \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_F16C_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        types_per_step = (256 / 8) / sizeof(float);                     \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256 res = _mm256_##op##_ps(OP_AVX_F16C_LOAD_PH(in1), OP_AVX_F16C_LOAD_PH(in2)); \
+            OP_AVX_F16C_STORE_PH(out, res);                             \
+            in1 += types_per_step;                                      \
+            in2 += types_per_step;                                      \
+            out += types_per_step;                                      \
+        }                                                               \
+    }
+
+#define OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_FUNC_3                     \
+    if( OMPI_OP_AVX_HAS_FLAGS(OMPI_OP_AVX_HAS_F16C_FLAG | OMPI_OP_AVX_HAS_AVX_FLAG) ) { \
+        types_per_step = (256 / 8) / (2 * sizeof(float));               \
+        for( ; left_over >= types_per_step; left_over -= types_per_step ) { \
+            __m256 res = ompi_op_avx_cmul_ps(OP_AVX_F16C_LOAD_PH(in1), OP_AVX_F16C_LOAD_PH(in2)); \
+            OP_AVX_F16C_STORE_PH(out, res);                             \
+            in1 += 2 * types_per_step;                                  \
+            in2 += 2 * types_per_step;                                  \
+            out += 2 * types_per_step;                                  \
+        }                                                               \
+        OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_TAIL(in1, in2, out)        \
+    }
+
+#define OP_AVX_SHORT_FLOAT_FUNC_3(op)                                   \
+static void OP_CONCAT(ompi_op_avx_3buff_##op##_short_float,PREPEND)(const void *_in1, const void *_in2, \
+                                                                    void *_out, int *count, \
+                                                                    struct ompi_datatype_t **dtype, \
+                                                                    struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    opal_short_float_t *in1 = (opal_short_float_t*)_in1, *in2 = (opal_short_float_t*)_in2, \
+        *out = (opal_short_float_t*)_out;                               \
+    OP_AVX_AVX512_SHORT_FLOAT_FUNC_3(op);                               \
+    OP_AVX_F16C_SHORT_FLOAT_FUNC_3(op);                                 \
+    for( ; left_over > 0; --left_over, ++in1, ++in2, ++out ) {          \
+        *out = current_func(*in1, *in2);                                \
+    }                                                                   \
+}
+
+#define OP_AVX_SHORT_FLOAT_COMPLEX_PROD_FUNC_3                          \
+static void OP_CONCAT(ompi_op_avx_3buff_prod_c_short_float_complex,PREPEND)(const void *_in1, const void *_in2, \
+                                                                            void *_out, int *count, \
+                                                                            struct ompi_datatype_t **dtype, \
+                                                                            struct ompi_op_base_module_1_0_0_t *module) \
+{                                                                       \
+    int types_per_step, left_over = *count;                             \
+    opal_short_float_t *in1 = (opal_short_float_t*)_in1, *in2 = (opal_short_float_t*)_in2, \
+        *out = (opal_short_float_t*)_out;                               \
+    OP_AVX_AVX512_SHORT_FLOAT_COMPLEX_PROD_FUNC_3;                      \
+    OP_AVX_F16C_SHORT_FLOAT_COMPLEX_PROD_FUNC_3;                        \
+    for( ; left_over > 0; --left_over, in1 += 2, in2 += 2, out += 2 ) { \
+        out[0] = (opal_short_float_t)((float)in1[0] * (float)in2[0] - (float)in1[1] * (float)in2[1]); \
+        out[1] = (opal_short_float_t)((float)in1[1] * (float)in2[0] + (float)in1[0] * (float)in2[1]); \
+    }                                                                   \
+}
+#endif  /* OP_AVX_HAVE_SHORT_FLOAT */
+
+/*************************************************************************
+ * Complex sum
+ *************************************************************************/
+    OP_AVX_COMPLEX_SUM_FUNC_3(c_float_complex, float, float)
+    OP_AVX_COMPLEX_SUM_FUNC_3(c_double_complex, double, double)
+
+/*************************************************************************
+ * Complex product
+ *************************************************************************/
+    OP_AVX_COMPLEX_PROD_FUNC_3(c_float_complex, float, ps)
+    OP_AVX_COMPLEX_PROD_FUNC_3(c_double_complex, double, pd)
+
+#if OP_AVX_HAVE_SHORT_FLOAT
+/*************************************************************************
+ * Short float max, min, sum, product
+ *************************************************************************/
+#undef current_func
+#define current_func(a, b) ((a) > (b) ? (a) : (b))
+    OP_AVX_SHORT_FLOAT_FUNC_3(max)
+#undef current_func
+#define current_func(a, b) ((a) < (b) ? (a) : (b))
+    OP_AVX_SHORT_FLOAT_FUNC_3(min)
+#undef current_func
+#define current_func(a, b) ((a) + (b))
+    OP_AVX_SHORT_FLOAT_FUNC_3(add)
+    OP_AVX_COMPLEX_SUM_FUNC_3(c_short_float_complex, opal_short_float_t, short_float)
+#undef current_func
+#define current_func(a, b) ((a) * (b))
+    OP_AVX_SHORT_FLOAT_FUNC_3(mul)
+    OP_AVX_SHORT_FLOAT_COMPLEX_PROD_FUNC_3
+#endif  /* OP_AVX_HAVE_SHORT_FLOAT */
+
 /** C integer ***********************************************************/
 #define C_INTEGER_8_16_32(name, ftype)                                                         \
     [OMPI_OP_BASE_TYPE_INT8_T]   = OP_CONCAT(ompi_op_avx_##ftype##_##name##_int8_t,PREPEND),   \
@@ -1140,10 +2142,37 @@ static void OP_CONCAT(ompi_op_avx_3buff_##op##_double,PREPEND)(const void *_in1,
 #define DOUBLE(name, ftype) OP_CONCAT(ompi_op_avx_##ftype##_##name##_double,PREPEND)
 
 #define FLOATING_POINT(name, ftype)                                         \
-    [OMPI_OP_BASE_TYPE_SHORT_FLOAT] = NULL,                                 \
+    [OMPI_OP_BASE_TYPE_SHORT_FLOAT] = SHORT_FLOAT(name, ftype),             \
     [OMPI_OP_BASE_TYPE_FLOAT] = FLOAT(name, ftype),                         \
     [OMPI_OP_BASE_TYPE_DOUBLE] = DOUBLE(name, ftype)
 
+/** Short float and complex *********************************************/
+#if OP_AVX_HAVE_SHORT_FLOAT
+#define SHORT_FLOAT(name, ftype) OP_CONCAT(ompi_op_avx_##ftype##_##name##_short_float,PREPEND)
+#define SHORT_FLOAT_COMPLEX(name, ftype) OP_CONCAT(ompi_op_avx_##ftype##_##name##_c_short_float_complex,PREPEND)
+#else
+#define SHORT_FLOAT(name, ftype) NULL
+#define SHORT_FLOAT_COMPLEX(name, ftype) NULL
+#endif  /* OP_AVX_HAVE_SHORT_FLOAT */
+
+#define COMPLEX(name, ftype)                                                                       \
+    [OMPI_OP_BASE_TYPE_C_SHORT_FLOAT_COMPLEX] = SHORT_FLOAT_COMPLEX(name, ftype),                  \
+    [OMPI_OP_BASE_TYPE_C_FLOAT_COMPLEX] = OP_CONCAT(ompi_op_avx_##ftype##_##name##_c_float_complex,PREPEND), \
+    [OMPI_OP_BASE_TYPE_C_DOUBLE_COMPLEX] = OP_CONCAT(ompi_op_avx_##ftype##_##name##_c_double_complex,PREPEND)
+
+/** Logical operators and pair types (AVX2 and AVX512 only) *************/
+#if defined(GENERATE_AVX2_CODE) && defined(OMPI_MCA_OP_HAVE_AVX2) && (1 == OMPI_MCA_OP_HAVE_AVX2)
+#define C_INTEGER_LOGICAL(name, ftype) C_INTEGER(name, ftype)
+
+#define TWOLOC(name, ftype)                                                                     \
+    [OMPI_OP_BASE_TYPE_FLOAT_INT] = OP_CONCAT(ompi_op_avx_##ftype##_##name##_float_int,PREPEND),   \
+    [OMPI_OP_BASE_TYPE_DOUBLE_INT] = OP_CONCAT(ompi_op_avx_##ftype##_##name##_double_int,PREPEND), \
+    [OMPI_OP_BASE_TYPE_2INT] = OP_CONCAT(ompi_op_avx_##ftype##_##name##_2int,PREPEND)
+#else
+#define C_INTEGER_LOGICAL(name, ftype) NULL
+#define TWOLOC(name, ftype) NULL
+#endif
+
 /*
  * MPI_OP_NULL
  * All types
@@ -1175,15 +2204,17 @@ ompi_op_base_handler_fn_t OP_CONCAT(ompi_op_avx_functions, PREPEND)[OMPI_OP_BASE
     [OMPI_OP_BASE_FORTRAN_SUM] = {
         C_INTEGER(sum, 2buff),
         FLOATING_POINT(add, 2buff),
+        COMPLEX(sum, 2buff),
     },
     /* Corresponds to MPI_PROD */
     [OMPI_OP_BASE_FORTRAN_PROD] = {
         C_INTEGER_OPTIONAL(prod, 2buff),
         FLOATING_POINT(mul, 2buff),
+        COMPLEX(prod, 2buff),
     },
     /* Corresponds to MPI_LAND */
     [OMPI_OP_BASE_FORTRAN_LAND] = {
-        NULL,
+        C_INTEGER_LOGICAL(land, 2buff),
     },
     /* Corresponds to MPI_BAND */
     [OMPI_OP_BASE_FORTRAN_BAND] = {
@@ -1191,7 +2222,7 @@ ompi_op_base_handler_fn_t OP_CONCAT(ompi_op_avx_functions, PREPEND)[OMPI_OP_BASE
     },
     /* Corresponds to MPI_LOR */
     [OMPI_OP_BASE_FORTRAN_LOR] = {
-        NULL,
+        C_INTEGER_LOGICAL(lor, 2buff),
     },
     /* Corresponds to MPI_BOR */
     [OMPI_OP_BASE_FORTRAN_BOR] = {
@@ -1199,12 +2230,20 @@ ompi_op_base_handler_fn_t OP_CONCAT(ompi_op_avx_functions, PREPEND)[OMPI_OP_BASE
     },
     /* Corresponds to MPI_LXOR */
     [OMPI_OP_BASE_FORTRAN_LXOR] = {
-        NULL,
+        C_INTEGER_LOGICAL(lxor, 2buff),
     },
     /* Corresponds to MPI_BXOR */
     [OMPI_OP_BASE_FORTRAN_BXOR] = {
         C_INTEGER(bxor, 2buff),
     },
+    /* Corresponds to MPI_MAXLOC */
+    [OMPI_OP_BASE_FORTRAN_MAXLOC] = {
+        TWOLOC(maxloc, 2buff),
+    },
+    /* Corresponds to MPI_MINLOC */
+    [OMPI_OP_BASE_FORTRAN_MINLOC] = {
+        TWOLOC(minloc, 2buff),
+    },
     /* Corresponds to MPI_REPLACE */
     [OMPI_OP_BASE_FORTRAN_REPLACE] = {
         /* (MPI_ACCUMULATE is handled differently than the other
@@ -1238,15 +2277,17 @@ ompi_op_base_3buff_handler_fn_t OP_CONCAT(ompi_op_avx_3buff_functions, PREPEND)[
     [OMPI_OP_BASE_FORTRAN_SUM] = {
         C_INTEGER(sum, 3buff),
         FLOATING_POINT(add, 3buff),
+        COMPLEX(sum, 3buff),
     },
     /* Corresponds to MPI_PROD */
     [OMPI_OP_BASE_FORTRAN_PROD] = {
         C_INTEGER_OPTIONAL(prod, 3buff),
         FLOATING_POINT(mul, 3buff),
+        COMPLEX(prod, 3buff),
     },
     /* Corresponds to MPI_LAND */
-    [OMPI_OP_BASE_FORTRAN_LAND] ={
-        NULL,
+    [OMPI_OP_BASE_FORTRAN_LAND] = {
+        C_INTEGER_LOGICAL(land, 3buff),
     },
     /* Corresponds to MPI_BAND */
     [OMPI_OP_BASE_FORTRAN_BAND] = {
@@ -1254,7 +2295,7 @@ ompi_op_base_3buff_handler_fn_t OP_CONCAT(ompi_op_avx_3buff_functions, PREPEND)[
     },
     /* Corresponds to MPI_LOR */
     [OMPI_OP_BASE_FORTRAN_LOR] = {
-        NULL,
+        C_INTEGER_LOGICAL(lor, 3buff),
     },
     /* Corresponds to MPI_BOR */
     [OMPI_OP_BASE_FORTRAN_BOR] = {
@@ -1262,12 +2303,20 @@ ompi_op_base_3buff_handler_fn_t OP_CONCAT(ompi_op_avx_3buff_functions, PREPEND)[
     },
     /* Corresponds to MPI_LXOR */
     [OMPI_OP_BASE_FORTRAN_LXOR] = {
-        NULL,
+        C_INTEGER_LOGICAL(lxor, 3buff),
     },
     /* Corresponds to MPI_BXOR */
     [OMPI_OP_BASE_FORTRAN_BXOR] = {
         C_INTEGER(xor, 3buff),
     },
+    /* Corresponds to MPI_MAXLOC */
+    [OMPI_OP_BASE_FORTRAN_MAXLOC] = {
+        TWOLOC(maxloc, 3buff),
+    },
+    /* Corresponds to MPI_MINLOC */
+    [OMPI_OP_BASE_FORTRAN_MINLOC] = {
+        TWOLOC(minloc, 3buff),
+    },
     /* Corresponds to MPI_REPLACE */
     [OMPI_OP_BASE_FORTRAN_REPLACE] = {
         /* MPI_ACCUMULATE is handled differently than the other
@@ -95,5 +95,103 @@ OMPI_DECLSPEC int ompi_op_base_op_unselect(struct ompi_op_t *op);
 
 OMPI_DECLSPEC extern mca_base_framework_t ompi_op_base_framework;
 
+/**
+ * Number of helper threads used for the large local reductions (0
+ * disables the multi-threaded reductions), minimal size in bytes of
+ * the reductions split across the threads, and size in bytes of the
+ * blocks handed to the threads.
+ */
+OMPI_DECLSPEC extern int ompi_op_base_reduce_threads;
+OMPI_DECLSPEC extern size_t ompi_op_base_reduce_thread_threshold;
+OMPI_DECLSPEC extern size_t ompi_op_base_reduce_thread_block_size;
+
+/**
+ * Reduce count elements of the predefined datatype dtype with the
+ * helper threads of the op base (see ompi_op_threaded_reduce(), the
+ * entry point of ompi/op/op.h).
+ *
+ * @param fn Two buffers function (used if source2 is NULL)
+ * @param fn_3buff Three buffers function
+ * @param module Module of the function
+ * @param source1 First source buffer
+ * @param source2 Second source buffer, NULL for a two buffers reduction
+ * @param target Target buffer
+ * @param count Number of elements
+ * @param dtype Datatype of the elements
+ *
+ * @retval OMPI_SUCCESS The reduction is complete.
+ * @retval OMPI_ERR_NOT_SUPPORTED The reduction is too small, the
+ *         datatype not predefined or the threads could not be started.
+ * @retval OMPI_ERR_TEMP_OUT_OF_RESOURCE The threads are busy with
+ *         another reduction.
+ *
+ * Nothing has been done when the function fails, the caller has to
+ * reduce the buffers itself.
+ */
+OMPI_DECLSPEC int ompi_op_base_threaded_reduce(ompi_op_base_handler_fn_t fn,
+                                               ompi_op_base_3buff_handler_fn_t fn_3buff,
+                                               struct ompi_op_base_module_1_0_0_t *module,
+                                               const void *source1, const void *source2,
+                                               void *target, int count,
+                                               struct ompi_datatype_t *dtype);
+
+/**
+ * Stop the helper threads of the multi-threaded reductions.
+ */
+void ompi_op_base_threads_fini(void);
+
+/**
+ * Names of the intrinsic operations (indexed by
+ * OMPI_OP_BASE_FORTRAN_*) and of the datatypes (indexed by
+ * OMPI_OP_BASE_TYPE_*) in the selection table.
+ */
+OMPI_DECLSPEC extern const char *ompi_op_base_op_names[OMPI_OP_BASE_FORTRAN_OP_MAX];
+OMPI_DECLSPEC extern const char *ompi_op_base_type_names[OMPI_OP_BASE_TYPE_MAX];
+
+/**
+ * Name of the selection table file (op_base_select_table MCA
+ * parameter), NULL if none.
+ */
+OMPI_DECLSPEC extern char *ompi_op_base_select_table;
+
+/**
+ * Read the selection table file.  A missing or invalid file is
+ * reported and ignored (the priorities of the components decide
+ * alone).
+ */
+int ompi_op_base_select_table_load(void);
+
+/**
+ * Release the selection table.
+ */
+void ompi_op_base_select_table_fini(void);
+
+/**
+ * Override the functions chosen for an intrinsic MPI_Op by the
+ * priorities of the components with the kernels named in the
+ * selection table, for the long and the short reductions.
+ *
+ * @param op MPI_Op whose components have just been selected
+ *
+ * @retval OMPI_SUCCESS Always (the kernels not available are ignored)
+ */
+int ompi_op_base_select_table_apply(struct ompi_op_t *op);
+
+/**
+ * Get a module of the kernel kernel for an intrinsic MPI_Op.
+ *
+ * @param op Intrinsic MPI_Op
+ * @param kernel "base" for the base functions, the name of a
+ *        component, or "component:variant" for a variant of the
+ *        component (see opc_op_query_variant)
+ * @param module The module (OUT), enabled for op, to OBJ_RELEASE
+ *
+ * @retval OMPI_SUCCESS The module has been found.
+ * @retval OMPI_ERR_NOT_FOUND The kernel is unknown or not available
+ *         for this MPI_Op.
+ */
+OMPI_DECLSPEC int ompi_op_base_kernel_query(struct ompi_op_t *op, const char *kernel,
+                                            ompi_op_base_module_t **module);
+
 END_C_DECLS
 #endif /* MCA_OP_BASE_H */
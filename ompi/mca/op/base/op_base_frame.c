@@ -59,5 +59,62 @@ OBJ_CLASS_INSTANCE(ompi_op_base_module_t, opal_object_t,
 OBJ_CLASS_INSTANCE(ompi_op_base_module_1_0_0_t, opal_object_t,
                    module_constructor_1_0_0, NULL);
 
-MCA_BASE_FRAMEWORK_DECLARE(ompi, op, NULL, NULL, NULL, NULL,
+static int ompi_op_base_register(mca_base_register_flag_t flags)
+{
+    ompi_op_base_reduce_threads = 0;
+    (void) mca_base_var_register("ompi", "op", "base", "reduce_threads",
+                                 "Number of helper threads used for the local reductions larger than op_base_reduce_thread_threshold (0 = reductions done by the calling thread only)",
+                                 MCA_BASE_VAR_TYPE_INT, NULL, 0, 0,
+                                 OPAL_INFO_LVL_6,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_op_base_reduce_threads);
+
+    ompi_op_base_reduce_thread_threshold = 16 * 1024 * 1024;
+    (void) mca_base_var_register("ompi", "op", "base", "reduce_thread_threshold",
+                                 "Size in bytes above which the local reductions are split across the helper threads",
+                                 MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                 OPAL_INFO_LVL_6,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_op_base_reduce_thread_threshold);
+
+    ompi_op_base_reduce_thread_block_size = 128 * 1024;
+    (void) mca_base_var_register("ompi", "op", "base", "reduce_thread_block_size",
+                                 "Size in bytes of the blocks of a multi-threaded reduction (should let the sources and the target of a block fit in the L2 cache)",
+                                 MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                 OPAL_INFO_LVL_6,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_op_base_reduce_thread_block_size);
+    if (0 == ompi_op_base_reduce_thread_block_size) {
+        ompi_op_base_reduce_thread_block_size = 128 * 1024;
+    }
+
+    ompi_op_base_select_table = NULL;
+    (void) mca_base_var_register("ompi", "op", "base", "select_table",
+                                 "File naming the reduction kernels to use for each operation, datatype and size class (see test/datatype/reduce_tune)",
+                                 MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0,
+                                 OPAL_INFO_LVL_6,
+                                 MCA_BASE_VAR_SCOPE_READONLY,
+                                 &ompi_op_base_select_table);
+
+    return OMPI_SUCCESS;
+}
+
+static int ompi_op_base_open(mca_base_open_flag_t flags)
+{
+    /* Not fatal: the priorities of the components decide without it */
+    (void) ompi_op_base_select_table_load();
+
+    return mca_base_framework_components_open(&ompi_op_base_framework, flags);
+}
+
+static int ompi_op_base_close(void)
+{
+    ompi_op_base_threads_fini();
+    ompi_op_base_select_table_fini();
+
+    return mca_base_framework_components_close(&ompi_op_base_framework, NULL);
+}
+
+MCA_BASE_FRAMEWORK_DECLARE(ompi, op, "OMPI Op", ompi_op_base_register,
+                           ompi_op_base_open, ompi_op_base_close,
                            mca_op_base_static_components, 0);
@@ -202,7 +202,9 @@ int ompi_op_base_op_select(ompi_op_t *op)
         }
     }
 
-    return OMPI_SUCCESS;
+    /* The selection table may prefer other kernels, depending on the
+       length of the reductions */
+    return ompi_op_base_select_table_apply(op);
 }
 
 static int avail_op_compare(opal_list_item_t **itema,
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file
+ *
+ * Selection table of the reduction kernels.
+ *
+ * The priorities of the components pick a single function per
+ * (MPI_Op, datatype), whatever the length of the reduction.  The
+ * selection table (op_base_select_table MCA parameter), usually
+ * written by test/datatype/reduce_tune on the target machine, names
+ * the fastest kernel for the long reductions and, optionally, another
+ * one for the reductions shorter than a given number of bytes (e.g.,
+ * to avoid the frequency drop of AVX-512 on short vectors).
+ *
+ * Each line of the file holds
+ *
+ *   <op> <datatype> <short limit> <short kernel> <long kernel>
+ *
+ * where op and datatype are names from ompi_op_base_op_names and
+ * ompi_op_base_type_names, and the kernels are "base", the name of a
+ * component, or "component:variant".  A short limit of 0 (and a "-"
+ * short kernel) means that the long kernel is used for all lengths.
+ * Everything after a '#' is a comment.
+ */
+
+#include "ompi_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal_stdint.h"
+#include "opal/util/output.h"
+#include "opal/class/opal_list.h"
+#include "opal/mca/base/base.h"
+
+#include "ompi/constants.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/op/op.h"
+#include "ompi/mca/op/base/base.h"
+#include "ompi/mca/op/base/functions.h"
+
+typedef struct ompi_op_base_select_entry_t {
+    int op;
+    int type;
+    size_t short_limit;
+    char short_kernel[64];
+    char long_kernel[64];
+} ompi_op_base_select_entry_t;
+
+const char *ompi_op_base_op_names[OMPI_OP_BASE_FORTRAN_OP_MAX] = {
+    [OMPI_OP_BASE_FORTRAN_NULL] = "null",
+    [OMPI_OP_BASE_FORTRAN_MAX] = "max",
+    [OMPI_OP_BASE_FORTRAN_MIN] = "min",
+    [OMPI_OP_BASE_FORTRAN_SUM] = "sum",
+    [OMPI_OP_BASE_FORTRAN_PROD] = "prod",
+    [OMPI_OP_BASE_FORTRAN_LAND] = "land",
+    [OMPI_OP_BASE_FORTRAN_BAND] = "band",
+    [OMPI_OP_BASE_FORTRAN_LOR] = "lor",
+    [OMPI_OP_BASE_FORTRAN_BOR] = "bor",
+    [OMPI_OP_BASE_FORTRAN_LXOR] = "lxor",
+    [OMPI_OP_BASE_FORTRAN_BXOR] = "bxor",
+    [OMPI_OP_BASE_FORTRAN_MAXLOC] = "maxloc",
+    [OMPI_OP_BASE_FORTRAN_MINLOC] = "minloc",
+    [OMPI_OP_BASE_FORTRAN_REPLACE] = "replace",
+    [OMPI_OP_BASE_FORTRAN_NO_OP] = "no_op",
+};
+
+const char *ompi_op_base_type_names[OMPI_OP_BASE_TYPE_MAX] = {
+    [OMPI_OP_BASE_TYPE_INT8_T] = "int8_t",
+    [OMPI_OP_BASE_TYPE_UINT8_T] = "uint8_t",
+    [OMPI_OP_BASE_TYPE_INT16_T] = "int16_t",
+    [OMPI_OP_BASE_TYPE_UINT16_T] = "uint16_t",
+    [OMPI_OP_BASE_TYPE_INT32_T] = "int32_t",
+    [OMPI_OP_BASE_TYPE_UINT32_T] = "uint32_t",
+    [OMPI_OP_BASE_TYPE_INT64_T] = "int64_t",
+    [OMPI_OP_BASE_TYPE_UINT64_T] = "uint64_t",
+    [OMPI_OP_BASE_TYPE_INTEGER] = "integer",
+    [OMPI_OP_BASE_TYPE_INTEGER1] = "integer1",
+    [OMPI_OP_BASE_TYPE_INTEGER2] = "integer2",
+    [OMPI_OP_BASE_TYPE_INTEGER4] = "integer4",
+    [OMPI_OP_BASE_TYPE_INTEGER8] = "integer8",
+    [OMPI_OP_BASE_TYPE_INTEGER16] = "integer16",
+    [OMPI_OP_BASE_TYPE_SHORT_FLOAT] = "short_float",
+    [OMPI_OP_BASE_TYPE_FLOAT] = "float",
+    [OMPI_OP_BASE_TYPE_DOUBLE] = "double",
+    [OMPI_OP_BASE_TYPE_REAL] = "real",
+    [OMPI_OP_BASE_TYPE_REAL2] = "real2",
+    [OMPI_OP_BASE_TYPE_REAL4] = "real4",
+    [OMPI_OP_BASE_TYPE_REAL8] = "real8",
+    [OMPI_OP_BASE_TYPE_REAL16] = "real16",
+    [OMPI_OP_BASE_TYPE_DOUBLE_PRECISION] = "double_precision",
+    [OMPI_OP_BASE_TYPE_LONG_DOUBLE] = "long_double",
+    [OMPI_OP_BASE_TYPE_LOGICAL] = "logical",
+    [OMPI_OP_BASE_TYPE_BOOL] = "bool",
+    [OMPI_OP_BASE_TYPE_C_SHORT_FLOAT_COMPLEX] = "c_short_float_complex",
+    [OMPI_OP_BASE_TYPE_C_FLOAT_COMPLEX] = "c_float_complex",
+    [OMPI_OP_BASE_TYPE_C_DOUBLE_COMPLEX] = "c_double_complex",
+    [OMPI_OP_BASE_TYPE_C_LONG_DOUBLE_COMPLEX] = "c_long_double_complex",
+    [OMPI_OP_BASE_TYPE_BYTE] = "byte",
+    [OMPI_OP_BASE_TYPE_2REAL] = "2real",
+    [OMPI_OP_BASE_TYPE_2DOUBLE_PRECISION] = "2double_precision",
+    [OMPI_OP_BASE_TYPE_2INTEGER] = "2integer",
+    [OMPI_OP_BASE_TYPE_FLOAT_INT] = "float_int",
+    [OMPI_OP_BASE_TYPE_DOUBLE_INT] = "double_int",
+    [OMPI_OP_BASE_TYPE_LONG_INT] = "long_int",
+    [OMPI_OP_BASE_TYPE_2INT] = "2int",
+    [OMPI_OP_BASE_TYPE_SHORT_INT] = "short_int",
+    [OMPI_OP_BASE_TYPE_LONG_DOUBLE_INT] = "long_double_int",
+    [OMPI_OP_BASE_TYPE_WCHAR] = "wchar",
+};
+
+char *ompi_op_base_select_table = NULL;
+
+static ompi_op_base_select_entry_t *select_entries = NULL;
+static int select_num_entries = 0;
+
+static int op_base_name_lookup(const char **names, int num_names, const char *name)
+{
+    int i;
+
+    for (i = 0; i < num_names; ++i) {
+        if (NULL != names[i] && 0 == strcmp(names[i], name)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int ompi_op_base_select_table_load(void)
+{
+    ompi_op_base_select_entry_t entry, *tmp;
+    char line[512], op_name[32], type_name[32], *comment;
+    int fileline = 0, max_entries = 0;
+    FILE *fptr;
+
+    if (NULL == ompi_op_base_select_table || '\0' == ompi_op_base_select_table[0]) {
+        return OMPI_SUCCESS;
+    }
+
+    fptr = fopen(ompi_op_base_select_table, "r");
+    if (NULL == fptr) {
+        opal_output(0, "op:base: cannot read the selection table %s, ignoring it",
+                    ompi_op_base_select_table);
+        return OMPI_ERR_NOT_FOUND;
+    }
+
+    while (NULL != fgets(line, sizeof(line), fptr)) {
+        ++fileline;
+        if (NULL != (comment = strchr(line, '#'))) {
+            *comment = '\0';
+        }
+        if (EOF == sscanf(line, "%31s", op_name)) {
+            continue;  /* empty line */
+        }
+        if (5 != sscanf(line, "%31s %31s %zu %63s %63s", op_name, type_name,
+                        &entry.short_limit, entry.short_kernel, entry.long_kernel) ||
+            0 > (entry.op = op_base_name_lookup(ompi_op_base_op_names,
+                                                OMPI_OP_BASE_FORTRAN_OP_MAX, op_name)) ||
+            0 > (entry.type = op_base_name_lookup(ompi_op_base_type_names,
+                                                  OMPI_OP_BASE_TYPE_MAX, type_name))) {
+            opal_output(0, "op:base: invalid line %d in the selection table %s, ignoring it",
+                        fileline, ompi_op_base_select_table);
+            continue;
+        }
+
+        if (select_num_entries == max_entries) {
+            max_entries = (0 == max_entries) ? 32 : 2 * max_entries;
+            tmp = (ompi_op_base_select_entry_t*) realloc(select_entries,
+                                                         max_entries * sizeof(entry));
+            if (NULL == tmp) {
+                fclose(fptr);
+                ompi_op_base_select_table_fini();
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
+            select_entries = tmp;
+        }
+        select_entries[select_num_entries++] = entry;
+    }
+    fclose(fptr);
+
+    opal_output_verbose(10, ompi_op_base_framework.framework_output,
+                        "op:base: %d entries in the selection table %s",
+                        select_num_entries, ompi_op_base_select_table);
+    return OMPI_SUCCESS;
+}
+
+void ompi_op_base_select_table_fini(void)
+{
+    free(select_entries);
+    select_entries = NULL;
+    select_num_entries = 0;
+}
+
+int ompi_op_base_kernel_query(ompi_op_t *op, const char *kernel,
+                              ompi_op_base_module_t **module)
+{
+    mca_base_component_list_item_t *cli;
+    const ompi_op_base_component_t *component;
+    ompi_op_base_module_t *m = NULL;
+    const char *variant;
+    size_t len;
+    int i, priority;
+
+    *module = NULL;
+
+    if (0 == strcmp(kernel, "base")) {
+        m = OBJ_NEW(ompi_op_base_module_t);
+        if (NULL == m) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        for (i = 0; i < OMPI_OP_BASE_TYPE_MAX; ++i) {
+            m->opm_fns[i] = ompi_op_base_functions[op->o_f_to_c_index][i];
+            m->opm_3buff_fns[i] = ompi_op_base_3buff_functions[op->o_f_to_c_index][i];
+        }
+        *module = m;
+        return OMPI_SUCCESS;
+    }
+
+    variant = strchr(kernel, ':');
+    len = (NULL == variant) ? strlen(kernel) : (size_t)(variant - kernel);
+    OPAL_LIST_FOREACH(cli, &ompi_op_base_framework.framework_components,
+                      mca_base_component_list_item_t) {
+        component = (const ompi_op_base_component_t *) cli->cli_component;
+        if (len != strlen(component->opc_version.mca_component_name) ||
+            0 != strncmp(component->opc_version.mca_component_name, kernel, len)) {
+            continue;
+        }
+        if (NULL == variant) {
+            m = component->opc_op_query(op, &priority);
+        } else if (NULL != component->opc_op_query_variant) {
+            m = component->opc_op_query_variant(op, variant + 1);
+        }
+        break;
+    }
+    if (NULL == m) {
+        return OMPI_ERR_NOT_FOUND;
+    }
+
+    if (NULL != m->opm_enable && OMPI_SUCCESS != m->opm_enable(m, op)) {
+        OBJ_RELEASE(m);
+        return OMPI_ERR_NOT_FOUND;
+    }
+    *module = m;
+    return OMPI_SUCCESS;
+}
+
+/*
+ * Use the functions of module for the datatype type
+ */
+static void op_base_set_kernel(ompi_op_base_op_fns_t *fns,
+                               ompi_op_base_op_3buff_fns_t *fns_3buff,
+                               int type, ompi_op_base_module_t *module)
+{
+    if (NULL != module->opm_fns[type]) {
+        if (NULL != fns->modules[type]) {
+            OBJ_RELEASE(fns->modules[type]);
+        }
+        fns->fns[type] = module->opm_fns[type];
+        fns->modules[type] = module;
+        OBJ_RETAIN(module);
+    }
+    if (NULL != module->opm_3buff_fns[type]) {
+        if (NULL != fns_3buff->modules[type]) {
+            OBJ_RELEASE(fns_3buff->modules[type]);
+        }
+        fns_3buff->fns[type] = module->opm_3buff_fns[type];
+        fns_3buff->modules[type] = module;
+        OBJ_RETAIN(module);
+    }
+}
+
+int ompi_op_base_select_table_apply(ompi_op_t *op)
+{
+    ompi_op_base_select_entry_t *entry;
+    ompi_op_base_module_t *module;
+    int i, t;
+
+    for (i = 0; i < select_num_entries; ++i) {
+        entry = &select_entries[i];
+        t = entry->type;
+        /* Only the functions the op already has */
+        if (entry->op != op->o_f_to_c_index || NULL == op->o_func.intrinsic.fns[t]) {
+            continue;
+        }
+
+        if (OMPI_SUCCESS == ompi_op_base_kernel_query(op, entry->long_kernel, &module)) {
+            op_base_set_kernel(&op->o_func.intrinsic, &op->o_3buff_intrinsic, t, module);
+            OBJ_RELEASE(module);
+        } else {
+            opal_output_verbose(10, ompi_op_base_framework.framework_output,
+                                "op:base:select_table: kernel %s not available for %s/%s",
+                                entry->long_kernel, op->o_name, ompi_op_base_type_names[t]);
+        }
+
+        if (0 == entry->short_limit) {
+            continue;
+        }
+        if (OMPI_SUCCESS != ompi_op_base_kernel_query(op, entry->short_kernel, &module)) {
+            opal_output_verbose(10, ompi_op_base_framework.framework_output,
+                                "op:base:select_table: kernel %s not available for %s/%s",
+                                entry->short_kernel, op->o_name, ompi_op_base_type_names[t]);
+            continue;
+        }
+        /* Start from the long functions, in case the short kernel
+           misses one of them */
+        if (0 == op->o_short_limit[t]) {
+            op->o_short_intrinsic.fns[t] = op->o_func.intrinsic.fns[t];
+            op->o_short_intrinsic.modules[t] = op->o_func.intrinsic.modules[t];
+            OBJ_RETAIN(op->o_short_intrinsic.modules[t]);
+            op->o_3buff_short_intrinsic.fns[t] = op->o_3buff_intrinsic.fns[t];
+            op->o_3buff_short_intrinsic.modules[t] = op->o_3buff_intrinsic.modules[t];
+            if (NULL != op->o_3buff_short_intrinsic.modules[t]) {
+                OBJ_RETAIN(op->o_3buff_short_intrinsic.modules[t]);
+            }
+        }
+        op_base_set_kernel(&op->o_short_intrinsic, &op->o_3buff_short_intrinsic, t, module);
+        op->o_short_limit[t] = entry->short_limit;
+        OBJ_RELEASE(module);
+
+        opal_output_verbose(10, ompi_op_base_framework.framework_output,
+                            "op:base:select_table: %s/%s: %s below %" PRIsize_t " bytes, %s above",
+                            op->o_name, ompi_op_base_type_names[t], entry->short_kernel,
+                            entry->short_limit, entry->long_kernel);
+    }
+
+    return OMPI_SUCCESS;
+}
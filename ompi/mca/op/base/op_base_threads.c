@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+/** @file
+ *
+ * Multi-threaded local reductions.
+ *
+ * When enabled (op_base_reduce_threads > 0), the reductions of
+ * intrinsic operations on predefined datatypes larger than
+ * op_base_reduce_thread_threshold bytes are split in blocks of
+ * op_base_reduce_thread_block_size bytes, processed by the calling
+ * thread and a pool of helper threads.  The blocks are small enough
+ * for the source and target of a block to stay in the L2 cache.
+ *
+ * The pool handles a single reduction at a time: a reduction issued
+ * while another one is in progress (MPI_THREAD_MULTIPLE) is done by
+ * its calling thread alone.
+ *
+ * The blocks are claimed through a 64 bits ticket holding the
+ * generation of the reduction (upper 32 bits) and the index of the
+ * next block (lower 32 bits).  A helper only claims blocks of the
+ * generation it has read the description of, so a helper late to
+ * notice the end of a reduction cannot take blocks of the next one.
+ * The helper threads never call opal_progress, they spin for a while
+ * after a reduction and then sleep with an increasing delay.  The
+ * calling thread waits for the blocks taken by the helpers the same
+ * way, with a shorter longest sleep.
+ *
+ * The blocks are cut and addressed by the extent of the datatype,
+ * which is larger than its size for the pair types of MINLOC/MAXLOC.
+ */
+
+#include "ompi_config.h"
+
+#include <time.h>
+
+#include "opal/sys/atomic.h"
+#include "opal/mca/threads/threads.h"
+#include "opal/util/output.h"
+
+#include "ompi/constants.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/op/op.h"
+#include "ompi/mca/op/base/base.h"
+
+/* The lower half of the ticket while the reduction is being described */
+#define OP_BASE_TICKET_NOT_READY 0xffffffffU
+/* Number of empty polls before sleeping, and longest sleep (ns) */
+#define OP_BASE_HELPER_SPINS     10000
+#define OP_BASE_HELPER_MAX_SLEEP 1000000
+/* Same for the calling thread waiting for the helpers */
+#define OP_BASE_MASTER_SPINS     1000
+#define OP_BASE_MASTER_MAX_SLEEP 10000
+
+typedef struct ompi_op_base_thread_job_t {
+    ompi_op_base_handler_fn_t fn;
+    ompi_op_base_3buff_handler_fn_t fn_3buff;
+    struct ompi_op_base_module_1_0_0_t *module;
+    const char *source1;
+    const char *source2;
+    char *target;
+    ompi_datatype_t *dtype;
+    ptrdiff_t extent;
+    int count;
+    int block_count;
+    uint32_t num_blocks;
+} ompi_op_base_thread_job_t;
+
+int ompi_op_base_reduce_threads = 0;
+size_t ompi_op_base_reduce_thread_threshold = 16 * 1024 * 1024;
+size_t ompi_op_base_reduce_thread_block_size = 128 * 1024;
+
+#if OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_64
+
+static opal_mutex_t pool_lock = OPAL_MUTEX_STATIC_INIT;
+static opal_thread_t *pool_threads = NULL;
+static int pool_num_threads = 0;
+static bool pool_failed = false;
+static volatile bool pool_shutdown = false;
+static uint32_t pool_generation = 0;
+
+static ompi_op_base_thread_job_t pool_job;
+static opal_atomic_int64_t pool_ticket = 0;
+static opal_atomic_int32_t pool_done = 0;
+
+/*
+ * Back off after an empty poll: spin up to spins polls, then sleep
+ * for a delay doubling up to max_sleep ns
+ */
+static inline void op_base_thread_backoff(int *idle, struct timespec *delay,
+                                          int spins, long max_sleep)
+{
+    if (++*idle <= spins) {
+        return;
+    }
+    delay->tv_nsec = (0 == delay->tv_nsec) ? 1000 : 2 * delay->tv_nsec;
+    if (delay->tv_nsec > max_sleep) {
+        delay->tv_nsec = max_sleep;
+    }
+    nanosleep(delay, NULL);
+}
+
+/*
+ * Claim and reduce the blocks of the reduction of generation gen
+ * described by job, until there are no more.
+ */
+static void op_base_thread_do_blocks(const ompi_op_base_thread_job_t *job,
+                                     uint32_t gen)
+{
+    int64_t ticket = pool_ticket;
+    uint32_t block;
+    ptrdiff_t offset;
+    int count;
+
+    for (;;) {
+        if ((uint32_t)(ticket >> 32) != gen) {
+            return;
+        }
+        block = (uint32_t)ticket;
+        if (block >= job->num_blocks) {
+            return;
+        }
+        if (!opal_atomic_compare_exchange_strong_64(&pool_ticket, &ticket, ticket + 1)) {
+            continue;  /* ticket has been updated */
+        }
+
+        offset = (ptrdiff_t)block * job->block_count * job->extent;
+        count = job->count - (int)block * job->block_count;
+        if (count > job->block_count) {
+            count = job->block_count;
+        }
+        if (NULL == job->source2) {
+            job->fn((void*)(job->source1 + offset), job->target + offset,
+                    &count, (struct ompi_datatype_t**)&job->dtype, job->module);
+        } else {
+            job->fn_3buff((void*)(job->source1 + offset), (void*)(job->source2 + offset),
+                          job->target + offset, &count,
+                          (struct ompi_datatype_t**)&job->dtype, job->module);
+        }
+        /* The results must be visible before the block is accounted */
+        opal_atomic_wmb();
+        (void)opal_atomic_add_fetch_32(&pool_done, 1);
+        ticket = pool_ticket;
+    }
+}
+
+static void *op_base_thread_helper(opal_object_t *obj)
+{
+    ompi_op_base_thread_job_t job;
+    uint32_t gen, last_gen = 0;
+    struct timespec delay = {0, 0};
+    int idle = 0;
+    int64_t ticket;
+
+    while (!pool_shutdown) {
+        ticket = pool_ticket;
+        gen = (uint32_t)(ticket >> 32);
+        if (gen == last_gen || OP_BASE_TICKET_NOT_READY == (uint32_t)ticket) {
+            /* Nothing to do for a while, sleep longer and longer */
+            op_base_thread_backoff(&idle, &delay, OP_BASE_HELPER_SPINS,
+                                   OP_BASE_HELPER_MAX_SLEEP);
+            continue;
+        }
+        idle = 0;
+        delay.tv_nsec = 0;
+        last_gen = gen;
+
+        opal_atomic_rmb();
+        job = pool_job;
+        opal_atomic_rmb();
+        op_base_thread_do_blocks(&job, gen);
+    }
+
+    return NULL;
+}
+
+/*
+ * Start the helper threads, pool_lock held
+ */
+static int op_base_thread_pool_start(void)
+{
+    int i, ret = OMPI_ERROR;
+
+    pool_threads = (opal_thread_t*) malloc(ompi_op_base_reduce_threads *
+                                           sizeof(opal_thread_t));
+    if (NULL == pool_threads) {
+        return OMPI_ERR_OUT_OF_RESOURCE;
+    }
+    pool_shutdown = false;
+    for (i = 0; i < ompi_op_base_reduce_threads; ++i) {
+        OBJ_CONSTRUCT(&pool_threads[i], opal_thread_t);
+        pool_threads[i].t_run = op_base_thread_helper;
+        pool_threads[i].t_arg = NULL;
+        if (OPAL_SUCCESS != (ret = opal_thread_start(&pool_threads[i]))) {
+            OBJ_DESTRUCT(&pool_threads[i]);
+            break;
+        }
+    }
+    pool_num_threads = i;
+    if (0 == pool_num_threads) {
+        free(pool_threads);
+        pool_threads = NULL;
+        return ret;
+    }
+
+    opal_output_verbose(10, ompi_op_base_framework.framework_output,
+                        "op:base: started %d reduction helper threads",
+                        pool_num_threads);
+    return OMPI_SUCCESS;
+}
+
+int ompi_op_base_threaded_reduce(ompi_op_base_handler_fn_t fn,
+                                 ompi_op_base_3buff_handler_fn_t fn_3buff,
+                                 struct ompi_op_base_module_1_0_0_t *module,
+                                 const void *source1, const void *source2,
+                                 void *target, int count,
+                                 struct ompi_datatype_t *dtype)
+{
+    struct timespec delay = {0, 0};
+    ptrdiff_t extent;
+    int block_count, idle = 0;
+    uint32_t gen, num_blocks;
+
+    if (!ompi_datatype_is_predefined(dtype)) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+    ompi_datatype_type_extent(dtype, &extent);
+    if (0 >= extent) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+    block_count = (int)(ompi_op_base_reduce_thread_block_size / (size_t)extent);
+    if (block_count < 1) {
+        block_count = 1;
+    }
+    num_blocks = (uint32_t)((count + (size_t)block_count - 1) / block_count);
+    if (num_blocks < 2) {
+        return OMPI_ERR_NOT_SUPPORTED;
+    }
+
+    /* Somebody else is using the pool */
+    if (0 != opal_mutex_trylock(&pool_lock)) {
+        return OMPI_ERR_TEMP_OUT_OF_RESOURCE;
+    }
+    if (NULL == pool_threads) {
+        if (pool_failed || OMPI_SUCCESS != op_base_thread_pool_start()) {
+            pool_failed = true;
+            opal_mutex_unlock(&pool_lock);
+            return OMPI_ERR_NOT_SUPPORTED;
+        }
+    }
+
+    /* Generation 0 is the initial state of the ticket */
+    if (0 == (gen = ++pool_generation)) {
+        gen = ++pool_generation;
+    }
+
+    /* Invalidate the ticket before changing the description */
+    pool_ticket = ((int64_t)gen << 32) | OP_BASE_TICKET_NOT_READY;
+    opal_atomic_wmb();
+    pool_job.fn = fn;
+    pool_job.fn_3buff = fn_3buff;
+    pool_job.module = module;
+    pool_job.source1 = (const char*)source1;
+    pool_job.source2 = (const char*)source2;
+    pool_job.target = (char*)target;
+    pool_job.dtype = dtype;
+    pool_job.extent = extent;
+    pool_job.count = count;
+    pool_job.block_count = block_count;
+    pool_job.num_blocks = num_blocks;
+    pool_done = 0;
+    opal_atomic_wmb();
+    pool_ticket = (int64_t)gen << 32;
+
+    op_base_thread_do_blocks(&pool_job, gen);
+
+    /* Wait for the blocks taken by the helpers */
+    while ((uint32_t)pool_done != num_blocks) {
+        op_base_thread_backoff(&idle, &delay, OP_BASE_MASTER_SPINS,
+                               OP_BASE_MASTER_MAX_SLEEP);
+    }
+    opal_atomic_rmb();
+
+    opal_mutex_unlock(&pool_lock);
+    return OMPI_SUCCESS;
+}
+
+void ompi_op_base_threads_fini(void)
+{
+    int i;
+
+    if (NULL == pool_threads) {
+        return;
+    }
+    pool_shutdown = true;
+    opal_atomic_wmb();
+    for (i = 0; i < pool_num_threads; ++i) {
+        opal_thread_join(&pool_threads[i], NULL);
+        OBJ_DESTRUCT(&pool_threads[i]);
+    }
+    free(pool_threads);
+    pool_threads = NULL;
+    pool_num_threads = 0;
+}
+
+#else
+
+int ompi_op_base_threaded_reduce(ompi_op_base_handler_fn_t fn,
+                                 ompi_op_base_3buff_handler_fn_t fn_3buff,
+                                 struct ompi_op_base_module_1_0_0_t *module,
+                                 const void *source1, const void *source2,
+                                 void *target, int count,
+                                 struct ompi_datatype_t *dtype)
+{
+    return OMPI_ERR_NOT_SUPPORTED;
+}
+
+void ompi_op_base_threads_fini(void)
+{
+}
+
+#endif  /* OPAL_HAVE_ATOMIC_COMPARE_EXCHANGE_64 */
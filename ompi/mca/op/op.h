@@ -321,6 +321,27 @@ typedef struct ompi_op_base_module_1_0_0_t *
   (*ompi_op_base_component_op_query_1_0_0_fn_t)
     (struct ompi_op_t *op, int *priority);
 
+/**
+ * Query a module restricted to a variant of the component.
+ *
+ * Components providing several implementations of their functions
+ * (e.g., for different instruction sets) may let the selection table
+ * of the op base (see op_base_select_table) pick one of them by name.
+ * The returned module follows the same rules as the one returned by
+ * op_query().
+ *
+ * This function may be NULL if the component has a single variant.
+ *
+ * @param[in] op          The MPI_Op being created
+ * @param[in] variant     Name of the variant
+ *
+ * @returns An initialized module structure, or NULL if the variant is
+ * unknown or not available on this process.
+ */
+typedef struct ompi_op_base_module_1_0_0_t *
+  (*ompi_op_base_component_op_query_variant_1_0_0_fn_t)
+    (struct ompi_op_t *op, const char *variant);
+
 /**
  * Op component interface.
  *
@@ -338,6 +359,9 @@ typedef struct ompi_op_base_component_1_0_0_t {
     ompi_op_base_component_init_query_fn_t opc_init_query;
     /** Query whether component is useable for given op */
     ompi_op_base_component_op_query_1_0_0_fn_t opc_op_query;
+    /** Query a module for a named variant of the component (may be
+        NULL) */
+    ompi_op_base_component_op_query_variant_1_0_0_fn_t opc_op_query_variant;
 } ompi_op_base_component_1_0_0_t;
 
 
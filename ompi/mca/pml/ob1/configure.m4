@@ -22,10 +22,11 @@ AC_DEFUN([MCA_ompi_pml_ob1_POST_CONFIG], [
 # ------------------------------------------------
 # We can always build, unless we were explicitly disabled.
 AC_DEFUN([MCA_ompi_pml_ob1_CONFIG],[
-    OPAL_VAR_SCOPE_PUSH([pml_ob1_matching_engine])
+    OPAL_VAR_SCOPE_PUSH([pml_ob1_matching_engine pml_ob1_match_avx512_support pml_ob1_cflags_save])
     AC_ARG_WITH([pml-ob1-matching], [AC_HELP_STRING([--with-pml-ob1-matching=type],
-                                                    [Configure pml/ob1 to use an alternate matching engine. Only valid on x86_64 systems.
-                                                     Valid values are: none, default, arrays, fuzzy-byte, fuzzy-short, fuzzy-word, vector (default: none)])])
+                                                    [Select the default matching engine of pml/ob1 (can be changed at runtime with the pml_ob1_matching_engine MCA parameter).
+                                                     The fuzzy and vector engines are only available on x86_64 systems with AVX512 support.
+                                                     Valid values are: none, default, arrays, hash, fuzzy-byte, fuzzy-short, fuzzy-word, vector (default: none)])])
 
     pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_NONE
 
@@ -40,6 +41,9 @@ AC_DEFUN([MCA_ompi_pml_ob1_CONFIG],[
             arrays)
                 pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_ARRAYS
                 ;;
+            hash)
+                pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_HASH
+                ;;
             fuzzy-byte)
                 pml_ob1_matching_engine=MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE
                 ;;
@@ -58,7 +62,55 @@ AC_DEFUN([MCA_ompi_pml_ob1_CONFIG],[
         esac
     fi
 
-    AC_DEFINE_UNQUOTED([MCA_PML_OB1_CUSTOM_MATCHING], [$pml_ob1_matching_engine], [Custom matching engine to use in pml/ob1])
+    AC_DEFINE_UNQUOTED([MCA_PML_OB1_CUSTOM_MATCHING], [$pml_ob1_matching_engine], [Default matching engine to use in pml/ob1])
+
+    #
+    # The fuzzy and vector matching engines are built with AVX512 support
+    # whenever the compiler allows it, and are only selected at runtime on
+    # processors that support these instructions.
+    #
+    MCA_BUILD_PML_OB1_MATCH_AVX512_FLAGS=""
+    pml_ob1_match_avx512_support=0
+    AS_IF([test "$opal_cv_asm_arch" = "X86_64"],
+          [AC_LANG_PUSH([C])
+           AC_MSG_CHECKING([for AVX512BW support in pml/ob1 (no additional flags)])
+           AC_LINK_IFELSE(
+               [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                [[
+    __m512i vA = _mm512_set1_epi8(1), vB = _mm512_set1_epi16(2);
+    return (int) _mm512_cmpeq_epi8_mask(_mm512_and_epi32(vA, vB), vA)
+                                ]])],
+               [pml_ob1_match_avx512_support=1
+                AC_MSG_RESULT([yes])],
+               [AC_MSG_RESULT([no])])
+
+           AS_IF([test $pml_ob1_match_avx512_support -eq 0],
+                 [AC_MSG_CHECKING([for AVX512BW support in pml/ob1 (with -mavx512f -mavx512bw)])
+                  pml_ob1_cflags_save="$CFLAGS"
+                  CFLAGS="$CFLAGS -mavx512f -mavx512bw"
+                  AC_LINK_IFELSE(
+                      [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                       [[
+    __m512i vA = _mm512_set1_epi8(1), vB = _mm512_set1_epi16(2);
+    return (int) _mm512_cmpeq_epi8_mask(_mm512_and_epi32(vA, vB), vA)
+                                       ]])],
+                      [pml_ob1_match_avx512_support=1
+                       MCA_BUILD_PML_OB1_MATCH_AVX512_FLAGS="-mavx512f -mavx512bw"
+                       AC_MSG_RESULT([yes])],
+                      [AC_MSG_RESULT([no])])
+                  CFLAGS="$pml_ob1_cflags_save"
+                 ])
+           AC_LANG_POP([C])
+          ])
+
+    AC_DEFINE_UNQUOTED([OMPI_PML_OB1_MATCH_HAVE_AVX512],
+                       [$pml_ob1_match_avx512_support],
+                       [Whether the AVX512 matching engines of pml/ob1 are built])
+    AM_CONDITIONAL([MCA_BUILD_ompi_pml_ob1_match_avx512],
+                   [test "$pml_ob1_match_avx512_support" = "1"])
+    AC_SUBST(MCA_BUILD_PML_OB1_MATCH_AVX512_FLAGS)
+
+    OPAL_VAR_SCOPE_POP
 
     AC_CONFIG_FILES([ompi/mca/pml/ob1/Makefile])
     [$1]
@@ -0,0 +1,134 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * Copyright (c) 2018      Sandia National Laboratories.  All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include <string.h>
+
+#include "opal/mca/base/mca_base_var_enum.h"
+
+#include "pml_ob1_custom_match.h"
+
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_linkedlist;
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_arrays;
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_hash;
+#if OMPI_PML_OB1_MATCH_HAVE_AVX512
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_fuzzy_byte;
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_fuzzy_short;
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_fuzzy_word;
+extern const mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_vectors;
+#endif
+
+/* indexed by MCA_PML_OB1_CUSTOM_MATCHING_*. engines that were not compiled in
+ * are left NULL */
+static const mca_pml_ob1_custom_match_engine_t *custom_match_engines[MCA_PML_OB1_CUSTOM_MATCHING_MAX] = {
+    [MCA_PML_OB1_CUSTOM_MATCHING_LINKEDLIST] = &mca_pml_ob1_custom_match_linkedlist,
+    [MCA_PML_OB1_CUSTOM_MATCHING_ARRAYS] = &mca_pml_ob1_custom_match_arrays,
+    [MCA_PML_OB1_CUSTOM_MATCHING_HASH] = &mca_pml_ob1_custom_match_hash,
+#if OMPI_PML_OB1_MATCH_HAVE_AVX512
+    [MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE] = &mca_pml_ob1_custom_match_fuzzy_byte,
+    [MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_SHORT] = &mca_pml_ob1_custom_match_fuzzy_short,
+    [MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_WORD] = &mca_pml_ob1_custom_match_fuzzy_word,
+    [MCA_PML_OB1_CUSTOM_MATCHING_VECTOR] = &mca_pml_ob1_custom_match_vectors,
+#endif
+};
+
+/* names of all the engines, including the ones that were not compiled in so
+ * the values of the MCA parameter do not depend on the build */
+static const mca_base_var_enum_value_t custom_match_engine_names[] = {
+    {MCA_PML_OB1_CUSTOM_MATCHING_NONE, "none"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_LINKEDLIST, "linkedlist"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_ARRAYS, "arrays"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE, "fuzzy-byte"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_SHORT, "fuzzy-short"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_WORD, "fuzzy-word"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_VECTOR, "vector"},
+    {MCA_PML_OB1_CUSTOM_MATCHING_HASH, "hash"},
+    {0, NULL},
+};
+
+#if OMPI_PML_OB1_MATCH_HAVE_AVX512
+static void custom_match_run_cpuid (uint32_t eax, uint32_t ecx, uint32_t *abcd)
+{
+    uint32_t ebx = 0, edx = 0;
+#if defined(__i386__) && defined(__PIC__)
+    /* in case of PIC under 32-bit EBX cannot be clobbered */
+    __asm__ ("movl %%ebx, %%edi \n\t cpuid \n\t xchgl %%ebx, %%edi" : "=D" (ebx),
+#else
+    __asm__ ("cpuid" : "+b" (ebx),
+#endif  /* defined(__i386__) && defined(__PIC__) */
+             "+a" (eax), "+c" (ecx), "=d" (edx));
+    abcd[0] = eax; abcd[1] = ebx; abcd[2] = ecx; abcd[3] = edx;
+}
+#endif
+
+static uint32_t custom_match_cpu_features (void)
+{
+    static int32_t features = -1;
+
+    if (features < 0) {
+        uint32_t flags = 0;
+#if OMPI_PML_OB1_MATCH_HAVE_AVX512
+        const uint32_t osxsave_mask = (1U << 27);  /* OSXSAVE (EAX = 1) : ECX */
+        uint32_t abcd[4], xcr0_lo, xcr0_hi;
+
+        custom_match_run_cpuid (1, 0, abcd);
+        if (abcd[2] & osxsave_mask) {
+            /* The OS saves the SSE, AVX, opmask and ZMM registers */
+            __asm__ ("xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0));
+            if ((xcr0_lo & 0xe6) == 0xe6) {
+                /* AVX512F: EBX bit 16, AVX512BW: EBX bit 30 (EAX = 7, ECX = 0) */
+                custom_match_run_cpuid (7, 0, abcd);
+                flags |= (abcd[1] & (1U << 16)) ? MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_AVX512F : 0;
+                flags |= (abcd[1] & (1U << 30)) ? MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_AVX512BW : 0;
+            }
+        }
+#endif
+        features = (int32_t) flags;
+    }
+
+    return (uint32_t) features;
+}
+
+const mca_pml_ob1_custom_match_engine_t *mca_pml_ob1_custom_match_engine_get (int id)
+{
+    const mca_pml_ob1_custom_match_engine_t *engine;
+
+    if (id <= MCA_PML_OB1_CUSTOM_MATCHING_NONE || id >= MCA_PML_OB1_CUSTOM_MATCHING_MAX) {
+        return NULL;
+    }
+
+    engine = custom_match_engines[id];
+    if (NULL == engine || (engine->requires & custom_match_cpu_features ()) != engine->requires) {
+        return NULL;
+    }
+
+    return engine;
+}
+
+const mca_pml_ob1_custom_match_engine_t *mca_pml_ob1_custom_match_engine_find (const char *name)
+{
+    for (int i = 0 ; NULL != custom_match_engine_names[i].string ; ++i) {
+        if (0 == strcasecmp (name, custom_match_engine_names[i].string)) {
+            return mca_pml_ob1_custom_match_engine_get (custom_match_engine_names[i].value);
+        }
+    }
+
+    return NULL;
+}
+
+int mca_pml_ob1_custom_match_engine_enum_create (mca_base_var_enum_t **enumerator)
+{
+    return mca_base_var_enum_create ("pml_ob1_matching_engines", custom_match_engine_names,
+                                     enumerator);
+}
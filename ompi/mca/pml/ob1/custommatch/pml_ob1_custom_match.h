@@ -15,10 +15,15 @@
 #define PML_OB1_CUSTOM_MATCH_H
 
 #include "ompi_config.h"
-#include "ompi/mca/pml/ob1/pml_ob1.h"
 
-#define CUSTOM_MATCH_DEBUG         1
-#define CUSTOM_MATCH_DEBUG_VERBOSE 1
+#ifndef CUSTOM_MATCH_DEBUG
+#define CUSTOM_MATCH_DEBUG         0
+#endif
+#ifndef CUSTOM_MATCH_DEBUG_VERBOSE
+#define CUSTOM_MATCH_DEBUG_VERBOSE 0
+#endif
+
+BEGIN_C_DECLS
 
 /**
  * Custom match types
@@ -30,29 +35,87 @@
 #define MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_SHORT 4
 #define MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_WORD  5
 #define MCA_PML_OB1_CUSTOM_MATCHING_VECTOR      6
+#define MCA_PML_OB1_CUSTOM_MATCHING_HASH        7
+#define MCA_PML_OB1_CUSTOM_MATCHING_MAX         8
 
-#if MCA_PML_OB1_CUSTOM_MATCHING != MCA_PML_OB1_CUSTOM_MATCHING_NONE
-
-#define MCA_PML_OB1_CUSTOM_MATCH 1
-
-#if MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_LINKEDLIST
-#include "pml_ob1_custom_match_linkedlist.h"
-#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_ARRAYS
-#include "pml_ob1_custom_match_arrays.h"
-#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE
-#include "pml_ob1_custom_match_fuzzy512-byte.h"
-#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_SHORT
-#include "pml_ob1_custom_match_fuzzy512-short.h"
-#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_WORD
-#include "pml_ob1_custom_match_fuzzy512-word.h"
-#elif MCA_PML_OB1_CUSTOM_MATCHING == MCA_PML_OB1_CUSTOM_MATCHING_VECTOR
-#include "pml_ob1_custom_match_vectors.h"
-#endif
+/**
+ * Processor features an engine needs in order to be selected.
+ */
+#define MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_AVX512F  0x1
+#define MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_AVX512BW 0x2
 
-#else
+/**
+ * Position of an unexpected fragment inside the unexpected queue of an
+ * engine. Filled in by umq_find_verify_hold() and consumed by
+ * umq_remove_hold() so the fragment can be dequeued without searching
+ * the queue a second time.
+ */
+struct mca_pml_ob1_custom_match_hold_t {
+    void *prev;
+    void *elem;
+    int   index;
+};
+typedef struct mca_pml_ob1_custom_match_hold_t mca_pml_ob1_custom_match_hold_t;
 
-#define MCA_PML_OB1_CUSTOM_MATCH 0
+/**
+ * Callback invoked for every element removed from a queue by the drain
+ * functions of an engine.
+ */
+typedef void (*mca_pml_ob1_custom_match_drain_fn_t) (void *item, void *ctx);
 
-#endif
+/**
+ * Matching engine. A communicator using an engine keeps all its posted
+ * receives (prq) and unexpected fragments (umq) in the engine, instead
+ * of the per-peer opal_list_t queues.
+ */
+struct mca_pml_ob1_custom_match_engine_t {
+    /** engine name, as accepted by the MCA parameter and the info key */
+    const char *name;
+    /** engine identifier (MCA_PML_OB1_CUSTOM_MATCHING_*) */
+    int id;
+    /** processor features required (MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_*) */
+    uint32_t requires;
+
+    void *(*prq_init) (void);
+    void  (*prq_destroy) (void *prq);
+    /** returns OMPI_ERR_OUT_OF_RESOURCE if the engine cannot grow */
+    int   (*prq_append) (void *prq, void *req, int tag, int source);
+    int   (*prq_cancel) (void *prq, void *req);
+    void *(*prq_find_dequeue_verify) (void *prq, int tag, int source);
+    int   (*prq_size) (void *prq);
+    void  (*prq_dump) (void *prq);
+    /** remove all the posted receives, in any order. optional, engines
+     * without drain functions cannot be migrated to or from */
+    void  (*prq_drain) (void *prq, mca_pml_ob1_custom_match_drain_fn_t cb, void *ctx);
+
+    void *(*umq_init) (void);
+    void  (*umq_destroy) (void *umq);
+    /** returns OMPI_ERR_OUT_OF_RESOURCE if the engine cannot grow */
+    int   (*umq_append) (void *umq, int tag, int source, void *frag);
+    void *(*umq_find_verify_hold) (void *umq, int tag, int source,
+                                   mca_pml_ob1_custom_match_hold_t *hold);
+    void  (*umq_remove_hold) (void *umq, mca_pml_ob1_custom_match_hold_t *hold);
+    int   (*umq_size) (void *umq);
+    void  (*umq_dump) (void *umq);
+    /** remove all the unexpected fragments, in arrival order (optional) */
+    void  (*umq_drain) (void *umq, mca_pml_ob1_custom_match_drain_fn_t cb, void *ctx);
+};
+typedef struct mca_pml_ob1_custom_match_engine_t mca_pml_ob1_custom_match_engine_t;
+
+/**
+ * Look up a matching engine by identifier or by name.
+ *
+ * @returns NULL for MCA_PML_OB1_CUSTOM_MATCHING_NONE ("none"), or if the
+ *          engine was not compiled in or cannot run on this processor.
+ */
+const mca_pml_ob1_custom_match_engine_t *mca_pml_ob1_custom_match_engine_get (int id);
+const mca_pml_ob1_custom_match_engine_t *mca_pml_ob1_custom_match_engine_find (const char *name);
+
+/**
+ * Enumerator listing the engine names (for MCA parameter registration).
+ */
+int mca_pml_ob1_custom_match_engine_enum_create (struct mca_base_var_enum_t **enumerator);
+
+END_C_DECLS
 
 #endif
@@ -14,8 +14,6 @@
 #ifndef PML_OB1_CUSTOM_MATCH_ARRAYS_H
 #define PML_OB1_CUSTOM_MATCH_ARRAYS_H
 
-#include <immintrin.h>
-
 #include "../pml_ob1_recvreq.h"
 #include "../pml_ob1_recvfrag.h"
 
@@ -180,7 +178,7 @@ static inline void* custom_match_prq_find_dequeue_verify(custom_match_prq* list,
 }
 
 
-static inline void custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
+static inline int custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
 {
     int32_t mask_tag, mask_src;
     if(source == OMPI_ANY_SOURCE)
@@ -215,6 +213,10 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
         else
         {
             elem = malloc(sizeof(custom_match_prq_node));
+            if(OPAL_UNLIKELY(NULL == elem))
+            {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
         elem->next = 0;
         elem->start = 0;
@@ -251,6 +253,7 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
 #if CUSTOM_MATCH_DEBUG
     printf("Exiting custom_match_prq_append\n");
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline int custom_match_prq_size(custom_match_prq* list)
@@ -453,7 +456,7 @@ static inline void custom_match_umq_remove_hold(custom_match_umq* list, custom_m
     list->size--;
 }
 
-static inline void custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
+static inline int custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
 {
 #if CUSTOM_MATCH_DEBUG
     printf("custom_match_umq_append list: %x payload: %x tag: %d src: %d\n", list, payload, tag, source);
@@ -477,6 +480,10 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
             printf("Make a new element\n");
 #endif
             elem = malloc(sizeof(custom_match_umq_node));
+            if(OPAL_UNLIKELY(NULL == elem))
+            {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
         elem->next = 0;
         elem->start = 0;
@@ -509,6 +516,7 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     custom_match_umq_dump(list);
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline custom_match_umq* custom_match_umq_init()
@@ -0,0 +1,149 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * Copyright (c) 2018      Sandia National Laboratories.  All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Instantiate a mca_pml_ob1_custom_match_engine_t out of the static
+ * inline custom_match_* functions of one engine header. This file is
+ * meant to be included once, right after the engine header, by the
+ * source file of each engine, with the following macros defined:
+ *
+ *   CUSTOM_MATCH_ENGINE_SYMBOL   name of the exported engine structure
+ *   CUSTOM_MATCH_ENGINE_NAME     name of the engine (string)
+ *   CUSTOM_MATCH_ENGINE_ID       MCA_PML_OB1_CUSTOM_MATCHING_* value
+ *   CUSTOM_MATCH_ENGINE_REQUIRES MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_* mask
+ *
+ * Engines providing custom_match_prq_drain() and custom_match_umq_drain()
+ * also define CUSTOM_MATCH_ENGINE_HAS_DRAIN to 1.
+ */
+
+#if !defined(CUSTOM_MATCH_ENGINE_SYMBOL) || !defined(CUSTOM_MATCH_ENGINE_NAME) || \
+    !defined(CUSTOM_MATCH_ENGINE_ID) || !defined(CUSTOM_MATCH_ENGINE_REQUIRES)
+#error "the custom match engine description is incomplete"
+#endif
+
+static void *engine_prq_init (void)
+{
+    return (void *) custom_match_prq_init ();
+}
+
+static void engine_prq_destroy (void *prq)
+{
+    custom_match_prq_destroy ((custom_match_prq *) prq);
+}
+
+static int engine_prq_append (void *prq, void *req, int tag, int source)
+{
+    return custom_match_prq_append ((custom_match_prq *) prq, req, tag, source);
+}
+
+static int engine_prq_cancel (void *prq, void *req)
+{
+    return custom_match_prq_cancel ((custom_match_prq *) prq, req);
+}
+
+static void *engine_prq_find_dequeue_verify (void *prq, int tag, int source)
+{
+    return custom_match_prq_find_dequeue_verify ((custom_match_prq *) prq, tag, source);
+}
+
+static int engine_prq_size (void *prq)
+{
+    return custom_match_prq_size ((custom_match_prq *) prq);
+}
+
+static void engine_prq_dump (void *prq)
+{
+    custom_match_prq_dump ((custom_match_prq *) prq);
+}
+
+static void *engine_umq_init (void)
+{
+    return (void *) custom_match_umq_init ();
+}
+
+static void engine_umq_destroy (void *umq)
+{
+    custom_match_umq_destroy ((custom_match_umq *) umq);
+}
+
+static int engine_umq_append (void *umq, int tag, int source, void *frag)
+{
+    return custom_match_umq_append ((custom_match_umq *) umq, tag, source, frag);
+}
+
+static void *engine_umq_find_verify_hold (void *umq, int tag, int source,
+                                          mca_pml_ob1_custom_match_hold_t *hold)
+{
+    custom_match_umq_node *prev = NULL, *elem = NULL;
+    void *frag;
+
+    frag = custom_match_umq_find_verify_hold ((custom_match_umq *) umq, tag, source,
+                                              &prev, &elem, &hold->index);
+    hold->prev = (void *) prev;
+    hold->elem = (void *) elem;
+
+    return frag;
+}
+
+static void engine_umq_remove_hold (void *umq, mca_pml_ob1_custom_match_hold_t *hold)
+{
+    custom_match_umq_remove_hold ((custom_match_umq *) umq, (custom_match_umq_node *) hold->prev,
+                                  (custom_match_umq_node *) hold->elem, hold->index);
+}
+
+static int engine_umq_size (void *umq)
+{
+    return custom_match_umq_size ((custom_match_umq *) umq);
+}
+
+static void engine_umq_dump (void *umq)
+{
+    custom_match_umq_dump ((custom_match_umq *) umq);
+}
+
+#if CUSTOM_MATCH_ENGINE_HAS_DRAIN
+static void engine_prq_drain (void *prq, mca_pml_ob1_custom_match_drain_fn_t cb, void *ctx)
+{
+    custom_match_prq_drain ((custom_match_prq *) prq, cb, ctx);
+}
+
+static void engine_umq_drain (void *umq, mca_pml_ob1_custom_match_drain_fn_t cb, void *ctx)
+{
+    custom_match_umq_drain ((custom_match_umq *) umq, cb, ctx);
+}
+#else
+#define engine_prq_drain NULL
+#define engine_umq_drain NULL
+#endif
+
+const mca_pml_ob1_custom_match_engine_t CUSTOM_MATCH_ENGINE_SYMBOL = {
+    .name = CUSTOM_MATCH_ENGINE_NAME,
+    .id = CUSTOM_MATCH_ENGINE_ID,
+    .requires = CUSTOM_MATCH_ENGINE_REQUIRES,
+    .prq_init = engine_prq_init,
+    .prq_destroy = engine_prq_destroy,
+    .prq_append = engine_prq_append,
+    .prq_cancel = engine_prq_cancel,
+    .prq_find_dequeue_verify = engine_prq_find_dequeue_verify,
+    .prq_size = engine_prq_size,
+    .prq_dump = engine_prq_dump,
+    .prq_drain = engine_prq_drain,
+    .umq_init = engine_umq_init,
+    .umq_destroy = engine_umq_destroy,
+    .umq_append = engine_umq_append,
+    .umq_find_verify_hold = engine_umq_find_verify_hold,
+    .umq_remove_hold = engine_umq_remove_hold,
+    .umq_size = engine_umq_size,
+    .umq_dump = engine_umq_dump,
+    .umq_drain = engine_umq_drain,
+};
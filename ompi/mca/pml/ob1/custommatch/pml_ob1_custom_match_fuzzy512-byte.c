@@ -0,0 +1,24 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * Copyright (c) 2018      Sandia National Laboratories.  All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+
+#include "pml_ob1_custom_match.h"
+#include "pml_ob1_custom_match_fuzzy512-byte.h"
+
+#define CUSTOM_MATCH_ENGINE_SYMBOL   mca_pml_ob1_custom_match_fuzzy_byte
+#define CUSTOM_MATCH_ENGINE_NAME     "fuzzy-byte"
+#define CUSTOM_MATCH_ENGINE_ID       MCA_PML_OB1_CUSTOM_MATCHING_FUZZY_BYTE
+#define CUSTOM_MATCH_ENGINE_REQUIRES (MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_AVX512F | MCA_PML_OB1_CUSTOM_MATCH_REQUIRES_AVX512BW)
+
+#include "pml_ob1_custom_match_engine.h"
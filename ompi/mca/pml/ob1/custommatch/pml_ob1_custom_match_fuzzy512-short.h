@@ -193,7 +193,7 @@ static inline void* custom_match_prq_find_dequeue_verify(custom_match_prq* list,
 }
 
 
-static inline void custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
+static inline int custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
 {
     int16_t key, mask;
     key = source ^ tag;
@@ -221,6 +221,10 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
         else
         {
             elem = _mm_malloc(sizeof(custom_match_prq_node),64);
+            if(OPAL_UNLIKELY(NULL == elem))
+            {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
         elem->keys = _mm512_set1_epi16(~0);
         elem->mask = _mm512_set1_epi16(~0);
@@ -249,6 +253,7 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     printf("Exiting custom_match_prq_append\n");
 #endif
+    return OMPI_SUCCESS;
 }
 
 
@@ -451,7 +456,7 @@ static inline void custom_match_umq_remove_hold(custom_match_umq* list, custom_m
     list->size--;
 }
 
-static inline void custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
+static inline int custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
 {
     int16_t key = source ^ tag;
 #if CUSTOM_MATCH_DEBUG_VERBOSE
@@ -478,6 +483,10 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
             printf("Make a new element\n");
 #endif
             elem = _mm_malloc(sizeof(custom_match_umq_node),64);
+            if(OPAL_UNLIKELY(NULL == elem))
+            {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
         elem->keys = _mm512_set1_epi16(~0); // TODO: we may only have to do this type of initialization for freshly malloc'd entries.
         elem->next = 0;
@@ -509,6 +518,7 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     custom_match_umq_dump(list);
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline custom_match_umq* custom_match_umq_init()
@@ -193,7 +193,7 @@ static inline void* custom_match_prq_find_dequeue_verify(custom_match_prq* list,
 }
 
 
-static inline void custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
+static inline int custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
 {
     int32_t key, mask;
     if(source == OMPI_ANY_SOURCE)
@@ -232,6 +232,10 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
         else
         {
             elem = _mm_malloc(sizeof(custom_match_prq_node),64);
+            if(OPAL_UNLIKELY(NULL == elem))
+            {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
         elem->keys = _mm512_set1_epi32(~0);
         elem->mask = _mm512_set1_epi32(~0);
@@ -260,6 +264,7 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     printf("Exiting custom_match_prq_append\n");
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline int custom_match_prq_size(custom_match_prq* list)
@@ -469,7 +474,7 @@ static inline void custom_match_umq_remove_hold(custom_match_umq* list, custom_m
     list->size--;
 }
 
-static inline void custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
+static inline int custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
 {
     int32_t key = source;
     ((int8_t*)&key)[3] = (int8_t) tag; // MGFD TODO verify this set higer order bits...
@@ -496,6 +501,10 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
             printf("Make a new element\n");
 #endif
             elem = _mm_malloc(sizeof(custom_match_umq_node),64);
+            if(OPAL_UNLIKELY(NULL == elem))
+            {
+                return OMPI_ERR_OUT_OF_RESOURCE;
+            }
         }
         elem->keys = _mm512_set1_epi32(~0); // TODO: we only have to do this type of initialization for freshly malloc'd entries.
         elem->next = 0;
@@ -527,6 +536,7 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     custom_match_umq_dump(list);
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline custom_match_umq* custom_match_umq_init()
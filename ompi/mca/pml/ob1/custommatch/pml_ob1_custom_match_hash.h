@@ -0,0 +1,476 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * Copyright (c) 2018      Sandia National Laboratories.  All rights reserved.
+ *
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Hash based matching engine.
+ *
+ * Posted receives with both a source and a tag are stored in buckets hashed
+ * on (source, tag). Receives using MPI_ANY_SOURCE and/or MPI_ANY_TAG are kept
+ * in a separate list in posting order. Every posted receive is stamped with a
+ * sequence number so that, when both a bucket entry and a wildcard entry match
+ * an incoming fragment, the one posted first is selected. The wildcard list is
+ * only walked when it is not empty.
+ *
+ * Unexpected fragments are stored both in buckets hashed on (source, tag) and
+ * in a list in arrival order. Fully specified receives only search their
+ * bucket, receives using a wildcard walk the arrival list.
+ */
+
+#ifndef PML_OB1_CUSTOM_MATCH_HASH_H
+#define PML_OB1_CUSTOM_MATCH_HASH_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../pml_ob1_recvreq.h"
+#include "../pml_ob1_recvfrag.h"
+
+/* number of buckets of each queue (must be a power of two) */
+#define CUSTOM_MATCH_HASH_BUCKETS 256
+
+static inline uint32_t custom_match_hash (int tag, int source)
+{
+    uint32_t h = (uint32_t) tag * 2654435761U + (uint32_t) source;
+
+    h ^= h >> 16;
+    return h & (CUSTOM_MATCH_HASH_BUCKETS - 1);
+}
+
+static inline bool custom_match_hash_tag_matches (int req_tag, int frag_tag)
+{
+    return req_tag == frag_tag || (OMPI_ANY_TAG == req_tag && frag_tag >= 0);
+}
+
+/*
+ * Posted receive queue
+ */
+
+typedef struct custom_match_prq_node {
+    struct custom_match_prq_node *prev;
+    struct custom_match_prq_node *next;
+    uint64_t seq;
+    int tag;
+    int src;
+    void *value;
+} custom_match_prq_node;
+
+typedef struct custom_match_prq_list {
+    custom_match_prq_node *head;
+    custom_match_prq_node *tail;
+} custom_match_prq_list;
+
+typedef struct custom_match_prq {
+    custom_match_prq_list buckets[CUSTOM_MATCH_HASH_BUCKETS];
+    custom_match_prq_list wild;
+    custom_match_prq_node *pool;
+    uint64_t seq;
+    int size;
+} custom_match_prq;
+
+static inline void custom_match_prq_list_append (custom_match_prq_list *list, custom_match_prq_node *elem)
+{
+    elem->next = NULL;
+    elem->prev = list->tail;
+    if (list->tail) {
+        list->tail->next = elem;
+    } else {
+        list->head = elem;
+    }
+    list->tail = elem;
+}
+
+static inline void custom_match_prq_list_remove (custom_match_prq_list *list, custom_match_prq_node *elem)
+{
+    if (elem->prev) {
+        elem->prev->next = elem->next;
+    } else {
+        list->head = elem->next;
+    }
+    if (elem->next) {
+        elem->next->prev = elem->prev;
+    } else {
+        list->tail = elem->prev;
+    }
+}
+
+static inline custom_match_prq_list *custom_match_prq_list_get (custom_match_prq *prq, int tag, int source)
+{
+    if (OMPI_ANY_SOURCE == source || OMPI_ANY_TAG == tag) {
+        return &prq->wild;
+    }
+
+    return prq->buckets + custom_match_hash (tag, source);
+}
+
+static inline void custom_match_prq_release (custom_match_prq *prq, custom_match_prq_list *list,
+                                             custom_match_prq_node *elem)
+{
+    custom_match_prq_list_remove (list, elem);
+    elem->value = NULL;
+    elem->next = prq->pool;
+    prq->pool = elem;
+    prq->size--;
+}
+
+static inline custom_match_prq *custom_match_prq_init (void)
+{
+    return (custom_match_prq *) calloc (1, sizeof (custom_match_prq));
+}
+
+static inline void custom_match_prq_list_free (custom_match_prq_list *list)
+{
+    custom_match_prq_node *elem, *next;
+
+    for (elem = list->head ; elem ; elem = next) {
+        next = elem->next;
+        free (elem);
+    }
+}
+
+static inline void custom_match_prq_destroy (custom_match_prq *prq)
+{
+    custom_match_prq_node *elem, *next;
+
+    for (int i = 0 ; i < CUSTOM_MATCH_HASH_BUCKETS ; ++i) {
+        custom_match_prq_list_free (prq->buckets + i);
+    }
+    custom_match_prq_list_free (&prq->wild);
+
+    for (elem = prq->pool ; elem ; elem = next) {
+        next = elem->next;
+        free (elem);
+    }
+
+    free (prq);
+}
+
+static inline int custom_match_prq_append (custom_match_prq *prq, void *payload, int tag, int source)
+{
+    custom_match_prq_node *elem;
+
+    if (prq->pool) {
+        elem = prq->pool;
+        prq->pool = elem->next;
+    } else {
+        elem = (custom_match_prq_node *) malloc (sizeof (*elem));
+        if (OPAL_UNLIKELY(NULL == elem)) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+    }
+
+    elem->seq = prq->seq++;
+    elem->tag = tag;
+    elem->src = source;
+    elem->value = payload;
+    custom_match_prq_list_append (custom_match_prq_list_get (prq, tag, source), elem);
+    prq->size++;
+
+    return OMPI_SUCCESS;
+}
+
+static inline int custom_match_prq_cancel (custom_match_prq *prq, void *req)
+{
+    mca_pml_base_request_t *base_req = (mca_pml_base_request_t *) req;
+    custom_match_prq_list *list = custom_match_prq_list_get (prq, base_req->req_tag, base_req->req_peer);
+
+    for (custom_match_prq_node *elem = list->head ; elem ; elem = elem->next) {
+        if (elem->value == req) {
+            custom_match_prq_release (prq, list, elem);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static inline void *custom_match_prq_find_dequeue_verify (custom_match_prq *prq, int tag, int source)
+{
+    custom_match_prq_list *bucket = prq->buckets + custom_match_hash (tag, source);
+    custom_match_prq_node *elem, *match = NULL;
+    custom_match_prq_list *list = bucket;
+    void *payload;
+
+    for (elem = bucket->head ; elem ; elem = elem->next) {
+        if (elem->tag == tag && elem->src == source) {
+            match = elem;
+            break;
+        }
+    }
+
+    /* only search the wildcard receives posted before the matching
+     * specific receive */
+    for (elem = prq->wild.head ; elem && (NULL == match || elem->seq < match->seq) ; elem = elem->next) {
+        if ((OMPI_ANY_SOURCE == elem->src || elem->src == source) &&
+            custom_match_hash_tag_matches (elem->tag, tag)) {
+            match = elem;
+            list = &prq->wild;
+            break;
+        }
+    }
+
+    if (NULL == match) {
+        return NULL;
+    }
+
+    payload = match->value;
+    custom_match_prq_release (prq, list, match);
+
+    return payload;
+}
+
+static inline void custom_match_prq_drain (custom_match_prq *prq, void (*cb) (void *, void *), void *ctx)
+{
+    for (int i = 0 ; i <= CUSTOM_MATCH_HASH_BUCKETS ; ++i) {
+        custom_match_prq_list *list = (i < CUSTOM_MATCH_HASH_BUCKETS) ? prq->buckets + i : &prq->wild;
+
+        while (list->head) {
+            custom_match_prq_node *elem = list->head;
+            cb (elem->value, ctx);
+            custom_match_prq_release (prq, list, elem);
+        }
+    }
+}
+
+static inline int custom_match_prq_size (custom_match_prq *prq)
+{
+    return prq->size;
+}
+
+static inline void custom_match_prq_dump (custom_match_prq *prq)
+{
+    char cpeer[64], ctag[64];
+
+    opal_output (0, "hash posted receive queue: %d receives (%s wildcard)\n", prq->size,
+                 prq->wild.head ? "with" : "no");
+
+    for (int i = 0 ; i <= CUSTOM_MATCH_HASH_BUCKETS ; ++i) {
+        custom_match_prq_list *list = (i < CUSTOM_MATCH_HASH_BUCKETS) ? prq->buckets + i : &prq->wild;
+
+        for (custom_match_prq_node *elem = list->head ; elem ; elem = elem->next) {
+            mca_pml_base_request_t *req = (mca_pml_base_request_t *) elem->value;
+            if( OMPI_ANY_SOURCE == req->req_peer ) snprintf(cpeer, 64, "%s", "ANY_SOURCE");
+            else snprintf(cpeer, 64, "%d", req->req_peer);
+            if( OMPI_ANY_TAG == req->req_tag ) snprintf(ctag, 64, "%s", "ANY_TAG");
+            else snprintf(ctag, 64, "%d", req->req_tag);
+            opal_output(0, "req %p peer %s tag %s addr %p count %lu datatype %s [%p] [%s %s] req_seq %" PRIu64
+                        " match_seq %" PRIu64, (void*) req, cpeer, ctag,
+                        (void*) req->req_addr, req->req_count,
+                        (0 != req->req_count ? req->req_datatype->name : "N/A"),
+                        (void*) req->req_datatype,
+                        (req->req_pml_complete ? "pml_complete" : ""),
+                        (req->req_free_called ? "freed" : ""),
+                        req->req_sequence, elem->seq);
+        }
+    }
+}
+
+/*
+ * Unexpected message queue
+ */
+
+typedef struct custom_match_umq_node {
+    /* bucket links */
+    struct custom_match_umq_node *prev;
+    struct custom_match_umq_node *next;
+    /* arrival order links */
+    struct custom_match_umq_node *older;
+    struct custom_match_umq_node *newer;
+    int tag;
+    int src;
+    void *value;
+} custom_match_umq_node;
+
+typedef struct custom_match_umq_list {
+    custom_match_umq_node *head;
+    custom_match_umq_node *tail;
+} custom_match_umq_list;
+
+typedef struct custom_match_umq {
+    custom_match_umq_list buckets[CUSTOM_MATCH_HASH_BUCKETS];
+    /* all the fragments in arrival order */
+    custom_match_umq_node *oldest;
+    custom_match_umq_node *newest;
+    custom_match_umq_node *pool;
+    int size;
+} custom_match_umq;
+
+static inline custom_match_umq *custom_match_umq_init (void)
+{
+    return (custom_match_umq *) calloc (1, sizeof (custom_match_umq));
+}
+
+static inline void custom_match_umq_destroy (custom_match_umq *umq)
+{
+    custom_match_umq_node *elem, *next;
+
+    for (elem = umq->oldest ; elem ; elem = next) {
+        next = elem->newer;
+        free (elem);
+    }
+
+    for (elem = umq->pool ; elem ; elem = next) {
+        next = elem->next;
+        free (elem);
+    }
+
+    free (umq);
+}
+
+static inline int custom_match_umq_append (custom_match_umq *umq, int tag, int source, void *payload)
+{
+    custom_match_umq_list *bucket = umq->buckets + custom_match_hash (tag, source);
+    custom_match_umq_node *elem;
+
+    if (umq->pool) {
+        elem = umq->pool;
+        umq->pool = elem->next;
+    } else {
+        elem = (custom_match_umq_node *) malloc (sizeof (*elem));
+        if (OPAL_UNLIKELY(NULL == elem)) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+    }
+
+    elem->tag = tag;
+    elem->src = source;
+    elem->value = payload;
+
+    elem->next = NULL;
+    elem->prev = bucket->tail;
+    if (bucket->tail) {
+        bucket->tail->next = elem;
+    } else {
+        bucket->head = elem;
+    }
+    bucket->tail = elem;
+
+    elem->newer = NULL;
+    elem->older = umq->newest;
+    if (umq->newest) {
+        umq->newest->newer = elem;
+    } else {
+        umq->oldest = elem;
+    }
+    umq->newest = elem;
+
+    umq->size++;
+
+    return OMPI_SUCCESS;
+}
+
+static inline void *custom_match_umq_find_verify_hold (custom_match_umq *umq, int tag, int peer,
+                                                       custom_match_umq_node **hold_prev,
+                                                       custom_match_umq_node **hold_elem,
+                                                       int *hold_index)
+{
+    custom_match_umq_node *elem;
+
+    if (OMPI_ANY_SOURCE != peer && OMPI_ANY_TAG != tag) {
+        /* fragments with the same (source, tag) are in arrival order in the bucket */
+        for (elem = umq->buckets[custom_match_hash (tag, peer)].head ; elem ; elem = elem->next) {
+            if (elem->tag == tag && elem->src == peer) {
+                break;
+            }
+        }
+    } else {
+        for (elem = umq->oldest ; elem ; elem = elem->newer) {
+            if ((OMPI_ANY_SOURCE == peer || elem->src == peer) &&
+                custom_match_hash_tag_matches (tag, elem->tag)) {
+                break;
+            }
+        }
+    }
+
+    if (NULL == elem) {
+        return NULL;
+    }
+
+    *hold_prev = NULL;
+    *hold_elem = elem;
+    *hold_index = 0;
+
+    return elem->value;
+}
+
+static inline void custom_match_umq_remove_hold (custom_match_umq *umq, custom_match_umq_node *prev,
+                                                 custom_match_umq_node *elem, int i)
+{
+    custom_match_umq_list *bucket = umq->buckets + custom_match_hash (elem->tag, elem->src);
+
+    (void) prev;
+    (void) i;
+
+    if (elem->prev) {
+        elem->prev->next = elem->next;
+    } else {
+        bucket->head = elem->next;
+    }
+    if (elem->next) {
+        elem->next->prev = elem->prev;
+    } else {
+        bucket->tail = elem->prev;
+    }
+
+    if (elem->older) {
+        elem->older->newer = elem->newer;
+    } else {
+        umq->oldest = elem->newer;
+    }
+    if (elem->newer) {
+        elem->newer->older = elem->older;
+    } else {
+        umq->newest = elem->older;
+    }
+
+    elem->value = NULL;
+    elem->next = umq->pool;
+    umq->pool = elem;
+    umq->size--;
+}
+
+static inline void custom_match_umq_drain (custom_match_umq *umq, void (*cb) (void *, void *), void *ctx)
+{
+    custom_match_umq_node *elem;
+
+    while (NULL != (elem = umq->oldest)) {
+        umq->oldest = elem->newer;
+        cb (elem->value, ctx);
+        elem->value = NULL;
+        elem->next = umq->pool;
+        umq->pool = elem;
+    }
+
+    memset (umq->buckets, 0, sizeof (umq->buckets));
+    umq->newest = NULL;
+    umq->size = 0;
+}
+
+static inline int custom_match_umq_size (custom_match_umq *umq)
+{
+    return umq->size;
+}
+
+static inline void custom_match_umq_dump (custom_match_umq *umq)
+{
+    opal_output (0, "hash unexpected message queue: %d fragments\n", umq->size);
+
+    for (custom_match_umq_node *elem = umq->oldest ; elem ; elem = elem->newer) {
+        mca_pml_ob1_recv_frag_t *frag = (mca_pml_ob1_recv_frag_t *) elem->value;
+        opal_output (0, "frag %p peer %d tag %d seq %d bucket %u\n", (void *) frag,
+                     frag->hdr.hdr_match.hdr_src, frag->hdr.hdr_match.hdr_tag,
+                     (int) frag->hdr.hdr_match.hdr_seq, custom_match_hash (elem->tag, elem->src));
+    }
+}
+
+#endif
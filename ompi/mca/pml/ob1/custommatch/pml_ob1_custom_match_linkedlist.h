@@ -149,7 +149,7 @@ static inline void* custom_match_prq_find_dequeue_verify(custom_match_prq* list,
 }
 
 
-static inline void custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
+static inline int custom_match_prq_append(custom_match_prq* list, void* payload, int tag, int source)
 {
     int32_t mask_tag, mask_src;
     if(source == OMPI_ANY_SOURCE)
@@ -185,6 +185,10 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
     else
     {
         elem = malloc(sizeof(custom_match_prq_node));
+        if(OPAL_UNLIKELY(NULL == elem))
+        {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
     }
     elem->next = 0;
     if(list->tail)
@@ -208,6 +212,7 @@ static inline void custom_match_prq_append(custom_match_prq* list, void* payload
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     printf("Exiting custom_match_prq_append\n");
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline int custom_match_prq_size(custom_match_prq* list)
@@ -256,6 +261,22 @@ static inline void custom_match_prq_destroy(custom_match_prq* list)
 #endif
 }
 
+static inline void custom_match_prq_drain(custom_match_prq* list, void (*cb)(void*, void*), void* ctx)
+{
+    custom_match_prq_node* elem;
+    while(list->head)
+    {
+        elem = list->head;
+        list->head = elem->next;
+        cb(elem->value, ctx);
+        elem->value = 0;
+        elem->next = list->pool;
+        list->pool = elem;
+    }
+    list->tail = 0;
+    list->size = 0;
+}
+
 static inline void custom_match_print(custom_match_prq* list)
 {
     custom_match_prq_node* elem;
@@ -394,7 +415,7 @@ static inline void custom_match_umq_remove_hold(custom_match_umq* list, custom_m
     list->size--;
 }
 
-static inline void custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
+static inline int custom_match_umq_append(custom_match_umq* list, int tag, int source, void* payload)
 {
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     printf("custom_match_umq_append list: %x payload: %x tag: %d src: %d\n", list,  payload, tag, source);
@@ -416,6 +437,10 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
         printf("Make a new element\n");
 #endif
         elem = malloc(sizeof(custom_match_umq_node));
+        if(OPAL_UNLIKELY(NULL == elem))
+        {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
     }
     elem->next = 0;
     if(list->tail)
@@ -442,6 +467,7 @@ static inline void custom_match_umq_append(custom_match_umq* list, int tag, int
 #if CUSTOM_MATCH_DEBUG_VERBOSE
     custom_match_umq_dump(list);
 #endif
+    return OMPI_SUCCESS;
 }
 
 static inline custom_match_umq* custom_match_umq_init()
@@ -485,6 +511,22 @@ static inline void custom_match_umq_destroy(custom_match_umq* list)
 #endif
 }
 
+static inline void custom_match_umq_drain(custom_match_umq* list, void (*cb)(void*, void*), void* ctx)
+{
+    custom_match_umq_node* elem;
+    while(list->head)
+    {
+        elem = list->head;
+        list->head = elem->next;
+        cb(elem->value, ctx);
+        elem->value = 0;
+        elem->next = list->pool;
+        list->pool = elem;
+    }
+    list->tail = 0;
+    list->size = 0;
+}
+
 static inline int custom_match_umq_size(custom_match_umq* list)
 {
     return list->size;
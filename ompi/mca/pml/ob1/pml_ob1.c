@@ -47,6 +47,7 @@
 #include "ompi/mca/bml/base/base.h"
 #include "opal/mca/pmix/pmix-internal.h"
 #include "ompi/runtime/ompi_cr.h"
+#include "ompi/runtime/mpiruntime.h"
 
 #include "pml_ob1.h"
 #include "pml_ob1_component.h"
@@ -193,6 +194,65 @@ int mca_pml_ob1_enable(bool enable)
     return OMPI_SUCCESS;
 }
 
+static const mca_pml_ob1_custom_match_engine_t *
+mca_pml_ob1_default_match_engine (ompi_communicator_t *comm)
+{
+    if ((int) comm->c_remote_group->grp_proc_count < mca_pml_ob1.matching_engine_min_procs) {
+        return NULL;
+    }
+
+    return mca_pml_ob1_custom_match_engine_get (mca_pml_ob1.matching_engine);
+}
+
+/* info callback for the ompi_pml_ob1_matching_engine key. The value reported
+ * back is the name of the engine in use, kept by the communicator as the
+ * callback must return a modifiable string. Selecting an engine explicitly
+ * disables the adaptive selection on the communicator. */
+static char *mca_pml_ob1_set_match_engine_info (opal_infosubscriber_t *obj, char *key, char *value)
+{
+    ompi_communicator_t *comm = (ompi_communicator_t *) obj;
+    mca_pml_ob1_comm_t *pml_comm = comm->c_pml_comm;
+    const mca_pml_ob1_custom_match_engine_t *engine;
+    bool adaptive = false;
+    int rc;
+
+    if (pml_comm->match_per_peer) {
+        /* the engine of communicators using per-peer locks cannot change */
+        if (NULL != value && 0 != strcmp (value, "default") && 0 != strcmp (value, "none")) {
+            opal_output_verbose (10, mca_pml_ob1_output, "cannot use matching engine %s on communicator "
+                                 "%s: it matches under per-peer locks", value, comm->c_name);
+        }
+        engine = pml_comm->match_engine;
+    } else {
+        if (NULL == value || 0 == strcmp (value, "default")) {
+            engine = mca_pml_ob1_default_match_engine (comm);
+            adaptive = mca_pml_ob1.matching_adaptive;
+        } else {
+            engine = mca_pml_ob1_custom_match_engine_find (value);
+            if (NULL == engine && 0 != strcmp (value, "none")) {
+                opal_output_verbose (10, mca_pml_ob1_output, "matching engine %s is not available on "
+                                     "communicator %s, using the per-peer queues", value, comm->c_name);
+            }
+        }
+
+        OB1_MATCHING_LOCK(&pml_comm->matching_lock);
+        rc = mca_pml_ob1_comm_set_match_engine (pml_comm, engine);
+        pml_comm->match_adaptive = adaptive;
+        engine = pml_comm->match_engine;
+        OB1_MATCHING_UNLOCK(&pml_comm->matching_lock);
+
+        if (OMPI_SUCCESS != rc) {
+            opal_output_verbose (10, mca_pml_ob1_output, "cannot change the matching engine of "
+                                 "communicator %s: %d", comm->c_name, rc);
+        }
+    }
+
+    free (pml_comm->match_engine_info);
+    pml_comm->match_engine_info = strdup (engine ? engine->name : "none");
+
+    return pml_comm->match_engine_info;
+}
+
 int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
 {
     /* allocate pml specific comm data */
@@ -217,6 +277,21 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
     mca_pml_ob1_comm_init_size(pml_comm, comm->c_remote_group->grp_proc_count);
     comm->c_pml_comm = pml_comm;
 
+    /* select the matching engine while the queues are still empty */
+    opal_infosubscribe_subscribe (&comm->super, "ompi_pml_ob1_matching_engine", "default",
+                                  mca_pml_ob1_set_match_engine_info);
+
+    pml_comm->match_per_peer = mca_pml_ob1.matching_per_peer_locks && ompi_mpi_thread_multiple &&
+        NULL == pml_comm->match_engine && !pml_comm->match_adaptive;
+
+    /* mpi_assert_no_any_tag is only used by the per-peer queues, the
+     * matching engines always handle MPI_ANY_TAG. Only advertise it on the
+     * communicators starting (and staying unless the engine is changed
+     * through the info key) with the per-peer queues. */
+    if (NULL == pml_comm->match_engine && !pml_comm->match_adaptive) {
+        ompi_comm_assert_subscribe (comm, OMPI_COMM_ASSERT_NO_ANY_TAG);
+    }
+
     /* Grab all related messages from the non_existing_communicator pending queue */
     OPAL_LIST_FOREACH_SAFE(frag, next_frag, &mca_pml_ob1.non_existing_communicator_pending, mca_pml_ob1_recv_frag_t) {
         hdr = &frag->hdr.hdr_match;
@@ -249,11 +324,7 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
         pml_proc = mca_pml_ob1_peer_lookup(comm, hdr->hdr_src);
 
         if (OMPI_COMM_CHECK_ASSERT_ALLOW_OVERTAKE(comm)) {
-#if !MCA_PML_OB1_CUSTOM_MATCH
-            opal_list_append( &pml_proc->unexpected_frags, (opal_list_item_t*)frag );
-#else
-            custom_match_umq_append(pml_comm->umq, hdr->hdr_tag, hdr->hdr_src, frag);
-#endif
+            mca_pml_ob1_append_unexpected_frag (pml_comm, pml_proc, frag);
             PERUSE_TRACE_MSG_EVENT(PERUSE_COMM_MSG_INSERT_IN_UNEX_Q, comm,
                                    hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
             continue;
@@ -264,11 +335,7 @@ int mca_pml_ob1_add_comm(ompi_communicator_t* comm)
         add_fragment_to_unexpected:
             /* We're now expecting the next sequence number. */
             pml_proc->expected_sequence++;
-#if !MCA_PML_OB1_CUSTOM_MATCH
-            opal_list_append( &pml_proc->unexpected_frags, (opal_list_item_t*)frag );
-#else
-            custom_match_umq_append(pml_comm->umq, hdr->hdr_tag, hdr->hdr_src, frag);
-#endif
+            mca_pml_ob1_append_unexpected_frag (pml_comm, pml_proc, frag);
             PERUSE_TRACE_MSG_EVENT(PERUSE_COMM_MSG_INSERT_IN_UNEX_Q, comm,
                                    hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
             /* And now the ugly part. As some fragments can be inserted in the cant_match list,
@@ -540,7 +607,6 @@ static void mca_pml_ob1_dump_hdr(mca_pml_ob1_hdr_t* hdr)
                 header);
 }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
 static void mca_pml_ob1_dump_frag_list(opal_list_t* queue, bool is_req)
 {
     opal_list_item_t* item;
@@ -573,7 +639,6 @@ static void mca_pml_ob1_dump_frag_list(opal_list_t* queue, bool is_req)
         }
     }
 }
-#endif
 
 void mca_pml_ob1_dump_cant_match(mca_pml_ob1_recv_frag_t* queue)
 {
@@ -603,19 +668,16 @@ int mca_pml_ob1_dump(struct ompi_communicator_t* comm, int verbose)
                 comm->c_name, (void*) comm, comm->c_contextid, comm->c_my_rank,
                 pml_comm->recv_sequence, pml_comm->num_procs, pml_comm->last_probed);
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
-    if( opal_list_get_size(&pml_comm->wild_receives) ) {
+    if (NULL != pml_comm->match_engine) {
+        opal_output(0, "matching engine %s\n", pml_comm->match_engine->name);
+        opal_output(0, "expected receives\n");
+        pml_comm->match_engine->prq_dump(pml_comm->prq);
+        opal_output(0, "unexpected frag\n");
+        pml_comm->match_engine->umq_dump(pml_comm->umq);
+    } else if( opal_list_get_size(&pml_comm->wild_receives) ) {
         opal_output(0, "expected MPI_ANY_SOURCE fragments\n");
         mca_pml_ob1_dump_frag_list(&pml_comm->wild_receives, true);
     }
-#endif
-
-#if MCA_PML_OB1_CUSTOM_MATCH
-     opal_output(0, "expected receives\n");
-     custom_match_prq_dump(pml_comm->prq);
-     opal_output(0, "unexpected frag\n");
-     custom_match_umq_dump(pml_comm->umq);
-#endif
 
     /* iterate through all procs on communicator */
     for( i = 0; i < (int)pml_comm->num_procs; i++ ) {
@@ -633,22 +695,18 @@ int mca_pml_ob1_dump(struct ompi_communicator_t* comm, int verbose)
                     proc->send_sequence);
 
         /* dump all receive queues */
-#if !MCA_PML_OB1_CUSTOM_MATCH
-       if( opal_list_get_size(&proc->specific_receives) ) {
+        if( opal_list_get_size(&proc->specific_receives) ) {
             opal_output(0, "expected specific receives\n");
             mca_pml_ob1_dump_frag_list(&proc->specific_receives, true);
         }
-#endif
         if( NULL != proc->frags_cant_match ) {
             opal_output(0, "out of sequence\n");
             mca_pml_ob1_dump_cant_match(proc->frags_cant_match);
         }
-#if !MCA_PML_OB1_CUSTOM_MATCH
         if( opal_list_get_size(&proc->unexpected_frags) ) {
             opal_output(0, "unexpected frag\n");
             mca_pml_ob1_dump_frag_list(&proc->unexpected_frags, false);
         }
-#endif
         /* dump all btls used for eager messages */
         for( n = 0; n < ep->btl_eager.arr_size; n++ ) {
             mca_bml_base_btl_t* bml_btl = &ep->btl_eager.bml_btls[n];
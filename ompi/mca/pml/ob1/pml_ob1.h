@@ -41,6 +41,7 @@
 #include "ompi/mca/bml/base/base.h"
 #include "ompi/proc/proc.h"
 #include "opal/mca/allocator/base/base.h"
+#include "opal/mca/timer/base/base.h"
 
 BEGIN_C_DECLS
 
@@ -83,6 +84,32 @@ struct mca_pml_ob1_t {
     char* allocator_name;
     mca_allocator_base_module_t* allocator;
     unsigned int unexpected_limit;
+    /* default matching engine (MCA_PML_OB1_CUSTOM_MATCHING_*) */
+    int matching_engine;
+    /* communicators with fewer processes keep the per-peer opal_list_t queues */
+    int matching_engine_min_procs;
+    /* switch communicators between the per-peer queues and
+     * matching_adaptive_engine depending on the depth of their queues */
+    bool matching_adaptive;
+    int matching_adaptive_engine;
+    int matching_adaptive_window;
+    int matching_adaptive_high;
+    int matching_adaptive_low;
+    /* match communicators using the per-peer queues under the locks of
+     * the peers with MPI_THREAD_MULTIPLE */
+    bool matching_per_peer_locks;
+    /* pack the next fragment of the throttled non-contiguous sends
+     * while the fragments in the pipeline are transmitted */
+    bool pack_pipeline;
+    /* time (in timer cycles, converted to microseconds when read) spent
+     * packing and unpacking the large non-contiguous messages, exposed as
+     * MPI_T performance variables */
+    opal_atomic_int64_t pack_time;
+    opal_atomic_int64_t pack_time_max;
+    opal_atomic_int64_t pack_messages;
+    opal_atomic_int64_t unpack_time;
+    opal_atomic_int64_t unpack_time_max;
+    opal_atomic_int64_t unpack_messages;
 };
 typedef struct mca_pml_ob1_t mca_pml_ob1_t;
 
@@ -348,6 +375,21 @@ mca_pml_ob1_compute_segment_length_remote (size_t seg_size, const void *segments
     return length;
 }
 
+/*
+ * Account the time (in cycles) spent packing or unpacking one message in
+ * the pack_time* or unpack_time* performance variables
+ */
+static inline void
+mca_pml_ob1_account_convertor_time (opal_atomic_int64_t *total, opal_atomic_int64_t *max,
+                                    opal_atomic_int64_t *messages, int64_t cycles)
+{
+    OPAL_THREAD_ADD_FETCH64(total, cycles);
+    OPAL_THREAD_ADD_FETCH64(messages, 1);
+    if (cycles > *max) {
+        (void) opal_atomic_fetch_max_64 (max, cycles);
+    }
+}
+
 /* represent BTL chosen for sending request */
 struct mca_pml_ob1_com_btl_t {
     mca_bml_base_btl_t *bml_btl;
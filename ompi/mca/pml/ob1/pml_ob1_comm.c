@@ -24,6 +24,8 @@
 
 #include "pml_ob1.h"
 #include "pml_ob1_comm.h"
+#include "pml_ob1_recvreq.h"
+#include "pml_ob1_recvfrag.h"
 
 
 
@@ -33,20 +35,20 @@ static void mca_pml_ob1_comm_proc_construct(mca_pml_ob1_comm_proc_t* proc)
     proc->expected_sequence = 1;
     proc->send_sequence = 0;
     proc->frags_cant_match = NULL;
-#if !MCA_PML_OB1_CUSTOM_MATCH
     OBJ_CONSTRUCT(&proc->specific_receives, opal_list_t);
     OBJ_CONSTRUCT(&proc->unexpected_frags, opal_list_t);
-#endif
+    proc->match_posted = 0;
+    proc->match_unexpected = 0;
+    OBJ_CONSTRUCT(&proc->lock, opal_mutex_t);
 }
 
 
 static void mca_pml_ob1_comm_proc_destruct(mca_pml_ob1_comm_proc_t* proc)
 {
     assert(NULL == proc->frags_cant_match);
-#if !MCA_PML_OB1_CUSTOM_MATCH
     OBJ_DESTRUCT(&proc->specific_receives);
     OBJ_DESTRUCT(&proc->unexpected_frags);
-#endif
+    OBJ_DESTRUCT(&proc->lock);
     if (proc->ompi_proc) {
         OBJ_RELEASE(proc->ompi_proc);
     }
@@ -60,12 +62,18 @@ OBJ_CLASS_INSTANCE(mca_pml_ob1_comm_proc_t, opal_object_t,
 
 static void mca_pml_ob1_comm_construct(mca_pml_ob1_comm_t* comm)
 {
-#if !MCA_PML_OB1_CUSTOM_MATCH
     OBJ_CONSTRUCT(&comm->wild_receives, opal_list_t);
-#else
-    comm->prq = custom_match_prq_init();
-    comm->umq = custom_match_umq_init();
-#endif
+    comm->match_engine = NULL;
+    comm->prq = NULL;
+    comm->umq = NULL;
+    comm->match_engine_info = NULL;
+    comm->match_wild_posted = 0;
+    comm->match_adaptive = false;
+    comm->match_window_count = 0;
+    comm->match_window_depth = 0;
+    memset (comm->match_depth_histogram, 0, sizeof (comm->match_depth_histogram));
+    comm->match_migrations = 0;
+    comm->match_per_peer = false;
     OBJ_CONSTRUCT(&comm->matching_lock, opal_mutex_t);
     OBJ_CONSTRUCT(&comm->proc_lock, opal_mutex_t);
     comm->recv_sequence = 0;
@@ -87,12 +95,12 @@ static void mca_pml_ob1_comm_destruct(mca_pml_ob1_comm_t* comm)
         free(comm->procs);
     }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
     OBJ_DESTRUCT(&comm->wild_receives);
-#else
-    custom_match_prq_destroy(comm->prq);
-    custom_match_umq_destroy(comm->umq);
-#endif
+    if (NULL != comm->match_engine) {
+        comm->match_engine->prq_destroy(comm->prq);
+        comm->match_engine->umq_destroy(comm->umq);
+    }
+    free(comm->match_engine_info);
     OBJ_DESTRUCT(&comm->matching_lock);
     OBJ_DESTRUCT(&comm->proc_lock);
 }
@@ -116,4 +124,215 @@ int mca_pml_ob1_comm_init_size (mca_pml_ob1_comm_t* comm, size_t size)
     return OMPI_SUCCESS;
 }
 
+/* elements removed from the queues of a communicator while it changes
+ * matching engine */
+struct mca_pml_ob1_comm_drain_t {
+    void **items;
+    size_t count;
+};
+typedef struct mca_pml_ob1_comm_drain_t mca_pml_ob1_comm_drain_t;
+
+static void mca_pml_ob1_comm_drain_cb (void *item, void *ctx)
+{
+    mca_pml_ob1_comm_drain_t *drain = (mca_pml_ob1_comm_drain_t *) ctx;
+    drain->items[drain->count++] = item;
+}
+
+static int mca_pml_ob1_comm_recv_seq_cmp (const void *a, const void *b)
+{
+    const mca_pml_ob1_recv_request_t *req_a = *(mca_pml_ob1_recv_request_t * const *) a;
+    const mca_pml_ob1_recv_request_t *req_b = *(mca_pml_ob1_recv_request_t * const *) b;
+    mca_pml_sequence_t seq_a = req_a->req_recv.req_base.req_sequence;
+    mca_pml_sequence_t seq_b = req_b->req_recv.req_base.req_sequence;
+
+    return (seq_a > seq_b) - (seq_a < seq_b);
+}
+
+static inline bool mca_pml_ob1_comm_engine_can_migrate (const mca_pml_ob1_custom_match_engine_t *engine)
+{
+    return NULL == engine || (NULL != engine->prq_drain && NULL != engine->umq_drain);
+}
+
+static void mca_pml_ob1_comm_queues_count (mca_pml_ob1_comm_t *comm, size_t *posted, size_t *unexpected)
+{
+    if (NULL != comm->match_engine) {
+        *posted = comm->match_engine->prq_size(comm->prq);
+        *unexpected = comm->match_engine->umq_size(comm->umq);
+        return;
+    }
+
+    *posted = opal_list_get_size(&comm->wild_receives);
+    *unexpected = 0;
+    for (size_t i = 0; i < comm->num_procs; ++i) {
+        if (NULL != comm->procs[i]) {
+            *posted += opal_list_get_size(&comm->procs[i]->specific_receives);
+            *unexpected += opal_list_get_size(&comm->procs[i]->unexpected_frags);
+        }
+    }
+}
+
+/* remove all the posted receives and unexpected fragments from the current
+ * queues of the communicator. posted receives are returned in posting order
+ * and unexpected fragments in arrival order for each peer. */
+static void mca_pml_ob1_comm_queues_drain (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_drain_t *posted,
+                                           mca_pml_ob1_comm_drain_t *unexpected)
+{
+    opal_list_item_t *item;
+
+    if (NULL != comm->match_engine) {
+        comm->match_engine->prq_drain(comm->prq, mca_pml_ob1_comm_drain_cb, posted);
+        comm->match_engine->umq_drain(comm->umq, mca_pml_ob1_comm_drain_cb, unexpected);
+
+        comm->match_wild_posted = 0;
+        for (size_t i = 0; i < comm->num_procs; ++i) {
+            if (NULL != comm->procs[i]) {
+                comm->procs[i]->match_posted = 0;
+                comm->procs[i]->match_unexpected = 0;
+            }
+        }
+    } else {
+        while (NULL != (item = opal_list_remove_first(&comm->wild_receives))) {
+            posted->items[posted->count++] = item;
+        }
+
+        for (size_t i = 0; i < comm->num_procs; ++i) {
+            mca_pml_ob1_comm_proc_t *proc = comm->procs[i];
+
+            if (NULL == proc) {
+                continue;
+            }
+
+            while (NULL != (item = opal_list_remove_first(&proc->specific_receives))) {
+                posted->items[posted->count++] = item;
+            }
+            while (NULL != (item = opal_list_remove_first(&proc->unexpected_frags))) {
+                unexpected->items[unexpected->count++] = item;
+            }
+        }
+    }
+
+    qsort(posted->items, posted->count, sizeof(void *), mca_pml_ob1_comm_recv_seq_cmp);
+}
+
+static void mca_pml_ob1_comm_queues_fill (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_drain_t *posted,
+                                          mca_pml_ob1_comm_drain_t *unexpected)
+{
+    for (size_t i = 0; i < posted->count; ++i) {
+        mca_pml_ob1_recv_request_t *req = (mca_pml_ob1_recv_request_t *) posted->items[i];
+        int peer = req->req_recv.req_base.req_peer;
+
+        if (NULL != comm->match_engine) {
+            if (OPAL_UNLIKELY(OMPI_SUCCESS != comm->match_engine->prq_append(comm->prq, req,
+                                                                             req->req_recv.req_base.req_tag,
+                                                                             peer))) {
+                /* the receives were already removed from the previous queues */
+                OMPI_ERROR_LOG(OMPI_ERR_OUT_OF_RESOURCE);
+                ompi_rte_abort(-1, NULL);
+            }
+            mca_pml_ob1_comm_count_posted(comm, OMPI_ANY_SOURCE == peer ? NULL : comm->procs[peer], 1);
+        } else if (OMPI_ANY_SOURCE == peer) {
+            opal_list_append(&comm->wild_receives, (opal_list_item_t *) req);
+        } else {
+            opal_list_append(&comm->procs[peer]->specific_receives, (opal_list_item_t *) req);
+        }
+    }
+
+    for (size_t i = 0; i < unexpected->count; ++i) {
+        mca_pml_ob1_recv_frag_t *frag = (mca_pml_ob1_recv_frag_t *) unexpected->items[i];
+
+        mca_pml_ob1_append_unexpected_frag(comm, comm->procs[frag->hdr.hdr_match.hdr_src], frag);
+    }
+}
+
+int mca_pml_ob1_comm_set_match_engine (mca_pml_ob1_comm_t *comm,
+                                       const mca_pml_ob1_custom_match_engine_t *engine)
+{
+    mca_pml_ob1_comm_drain_t posted = {.items = NULL, .count = 0};
+    mca_pml_ob1_comm_drain_t unexpected = {.items = NULL, .count = 0};
+    size_t posted_size, unexpected_size;
+    void *prq = NULL, *umq = NULL;
+
+    if (engine == comm->match_engine) {
+        return OMPI_SUCCESS;
+    }
+
+    mca_pml_ob1_comm_queues_count(comm, &posted_size, &unexpected_size);
+    if (posted_size + unexpected_size) {
+        if (!mca_pml_ob1_comm_engine_can_migrate(comm->match_engine) ||
+            !mca_pml_ob1_comm_engine_can_migrate(engine)) {
+            return OMPI_ERR_RESOURCE_BUSY;
+        }
+
+        posted.items = (void **) malloc((posted_size + unexpected_size) * sizeof(void *));
+        if (OPAL_UNLIKELY(NULL == posted.items)) {
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+        unexpected.items = posted.items + posted_size;
+    }
+
+    if (NULL != engine) {
+        prq = engine->prq_init();
+        umq = engine->umq_init();
+        if (OPAL_UNLIKELY(NULL == prq || NULL == umq)) {
+            if (NULL != prq) {
+                engine->prq_destroy(prq);
+            }
+            if (NULL != umq) {
+                engine->umq_destroy(umq);
+            }
+            free(posted.items);
+            return OMPI_ERR_OUT_OF_RESOURCE;
+        }
+    }
+
+    if (NULL != posted.items) {
+        mca_pml_ob1_comm_queues_drain(comm, &posted, &unexpected);
+    }
+
+    if (NULL != comm->match_engine) {
+        comm->match_engine->prq_destroy(comm->prq);
+        comm->match_engine->umq_destroy(comm->umq);
+    }
+
+    comm->match_engine = engine;
+    comm->prq = prq;
+    comm->umq = umq;
+
+    if (NULL != posted.items) {
+        mca_pml_ob1_comm_queues_fill(comm, &posted, &unexpected);
+        free(posted.items);
+    }
+
+    return OMPI_SUCCESS;
+}
+
+void mca_pml_ob1_comm_match_adapt (mca_pml_ob1_comm_t *comm)
+{
+    const mca_pml_ob1_custom_match_engine_t *engine, *target;
+    uint64_t average;
+
+    average = comm->match_window_depth / comm->match_window_count;
+    comm->match_window_depth = 0;
+    comm->match_window_count = 0;
+
+    engine = mca_pml_ob1_custom_match_engine_get(mca_pml_ob1.matching_adaptive_engine);
+    if (NULL == engine || !mca_pml_ob1_comm_engine_can_migrate(engine)) {
+        /* the adaptive engine is not usable on this system */
+        comm->match_adaptive = false;
+        return;
+    }
+
+    if (NULL == comm->match_engine && average >= (uint64_t) mca_pml_ob1.matching_adaptive_high) {
+        target = engine;
+    } else if (engine == comm->match_engine && average <= (uint64_t) mca_pml_ob1.matching_adaptive_low) {
+        target = NULL;
+    } else {
+        return;
+    }
 
+    if (OMPI_SUCCESS == mca_pml_ob1_comm_set_match_engine(comm, target)) {
+        comm->match_migrations++;
+        opal_output_verbose(10, mca_pml_ob1_output, "average matching queue depth %" PRIu64
+                            " moved communicator queues to %s", average, target ? target->name : "none");
+    }
+}
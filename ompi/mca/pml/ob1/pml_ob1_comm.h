@@ -30,11 +30,14 @@
 #include "opal/class/opal_list.h"
 #include "ompi/proc/proc.h"
 #include "ompi/communicator/communicator.h"
+#include "pml_ob1.h"
 
-/* NTH: at some point we need to untangle the headers. this declaration is needed
- * for headers included by the custom match code. */
 typedef struct mca_pml_ob1_comm_proc_t mca_pml_ob1_comm_proc_t;
 
+/* number of bins of the queue depth histogram. bin i counts the matches
+ * done with a depth in [2^(i-1), 2^i), the last bin everything above */
+#define MCA_PML_OB1_MATCH_DEPTH_BINS 16
+
 #include "custommatch/pml_ob1_custom_match.h"
 
 BEGIN_C_DECLS
@@ -46,10 +49,11 @@ struct mca_pml_ob1_comm_proc_t {
     uint16_t expected_sequence;    /**< send message sequence number - receiver side */
     opal_atomic_int32_t send_sequence; /**< send side sequence number */
     struct mca_pml_ob1_recv_frag_t* frags_cant_match;  /**< out-of-order fragment queues */
-#if !MCA_PML_OB1_CUSTOM_MATCH
-    opal_list_t specific_receives; /**< queues of unmatched specific receives */
-    opal_list_t unexpected_frags;  /**< unexpected fragment queues */
-#endif
+    opal_list_t specific_receives; /**< queues of unmatched specific receives (unused with a matching engine) */
+    opal_list_t unexpected_frags;  /**< unexpected fragment queues (unused with a matching engine) */
+    size_t match_posted;           /**< specific receives of this peer in the matching engine */
+    size_t match_unexpected;       /**< unexpected fragments of this peer in the matching engine */
+    opal_mutex_t lock;             /**< protects the queues of this peer when the communicator uses per-peer locks */
 };
 
 OBJ_CLASS_DECLARATION(mca_pml_ob1_comm_proc_t);
@@ -62,22 +66,65 @@ struct mca_pml_comm_t {
     opal_object_t super;
     volatile uint32_t recv_sequence;  /**< recv request sequence number - receiver side */
     opal_mutex_t matching_lock;   /**< matching lock */
-#if !MCA_PML_OB1_CUSTOM_MATCH
     opal_list_t wild_receives;    /**< queue of unmatched wild (source process not specified) receives */
-#endif
     opal_mutex_t proc_lock;
     mca_pml_ob1_comm_proc_t **procs;
     size_t num_procs;
     size_t last_probed;
-#if MCA_PML_OB1_CUSTOM_MATCH
-    custom_match_prq* prq;
-    custom_match_umq* umq;
-#endif
+    /** matching engine holding the posted receives and unexpected fragments of
+     * this communicator. NULL when the per-peer opal_list_t queues are used. */
+    const mca_pml_ob1_custom_match_engine_t *match_engine;
+    void *prq;                    /**< engine posted receive queue */
+    void *umq;                    /**< engine unexpected message queue */
+    char *match_engine_info;      /**< value reported for the ompi_pml_ob1_matching_engine info key */
+    size_t match_wild_posted;     /**< wildcard receives in the matching engine */
+    bool match_adaptive;          /**< adapt the matching engine to the queue depth */
+    uint32_t match_window_count;  /**< matches in the current adaptation window */
+    uint64_t match_window_depth;  /**< sum of the peer queue depths in the current window */
+    uint64_t match_depth_histogram[MCA_PML_OB1_MATCH_DEPTH_BINS]; /**< queue depth seen by incoming fragments */
+    uint64_t match_migrations;    /**< number of times the queues changed engine */
+    bool match_per_peer;          /**< match under the locks of the peers (see mca_pml_ob1_match_lock_peer) */
 };
 typedef struct mca_pml_comm_t mca_pml_ob1_comm_t;
 
 OBJ_CLASS_DECLARATION(mca_pml_ob1_comm_t);
 
+/**
+ * Depth of the queues an incoming fragment from a peer is matched against
+ * with the per-peer queues: the specific receives posted for the peer, the
+ * wildcard receives and the unexpected fragments of the peer. With a
+ * matching engine the same depth is computed from the counters maintained
+ * next to the engine, so that both kinds of queues are measured alike. Must
+ * be called with the matching lock held.
+ */
+static inline size_t mca_pml_ob1_comm_peer_depth (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc)
+{
+    if (NULL != comm->match_engine) {
+        return proc->match_posted + comm->match_wild_posted + proc->match_unexpected;
+    }
+
+    return opal_list_get_size(&proc->specific_receives) + opal_list_get_size(&comm->wild_receives) +
+        opal_list_get_size(&proc->unexpected_frags);
+}
+
+/**
+ * Account a receive added to (delta = 1) or removed from (delta = -1) the
+ * posted receive queue of the matching engine.
+ *
+ * @param comm   communicator
+ * @param proc   peer of the receive (NULL for a wildcard receive)
+ * @param delta  change in the number of posted receives
+ */
+static inline void mca_pml_ob1_comm_count_posted (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc,
+                                                  int delta)
+{
+    if (NULL == proc) {
+        comm->match_wild_posted += delta;
+    } else {
+        proc->match_posted += delta;
+    }
+}
+
 static inline mca_pml_ob1_comm_proc_t *mca_pml_ob1_peer_lookup (struct ompi_communicator_t *comm, int rank)
 {
     mca_pml_ob1_comm_t *pml_comm = (mca_pml_ob1_comm_t *)comm->c_pml_comm;
@@ -107,6 +154,92 @@ static inline mca_pml_ob1_comm_proc_t *mca_pml_ob1_peer_lookup (struct ompi_comm
     return pml_comm->procs[rank];
 }
 
+/**
+ * Matching locks.
+ *
+ * By default all the matching of a communicator is serialized on its
+ * matching_lock. Communicators using the per-peer queues under
+ * MPI_THREAD_MULTIPLE with pml_ob1_matching_per_peer_locks set instead
+ * protect the specific receives, the unexpected and the out-of-sequence
+ * fragments of each peer with the lock of that peer. The matching_lock is
+ * then only needed for the wildcard receives: posting one requires the
+ * matching_lock and the locks of all the peers, removing one only the
+ * matching_lock. Locks are always acquired in that order: matching_lock,
+ * then the peers by increasing rank.
+ */
+
+/**
+ * Lock the matching of one peer.
+ *
+ * @param comm      communicator
+ * @param proc      peer (can be NULL if wildcard is true)
+ * @param wildcard  whether the wildcard receives have to be accessible
+ * @return          true if the matching_lock is held
+ */
+static inline bool mca_pml_ob1_match_lock_peer (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc,
+                                                bool wildcard)
+{
+    if (!comm->match_per_peer) {
+        OB1_MATCHING_LOCK(&comm->matching_lock);
+        return true;
+    }
+
+    if (NULL == proc) {
+        OB1_MATCHING_LOCK(&comm->matching_lock);
+        return true;
+    }
+
+    OB1_MATCHING_LOCK(&proc->lock);
+    /* no wildcard receive can be posted while the lock of the peer is held */
+    if (!wildcard || OPAL_LIKELY(0 == opal_list_get_size (&comm->wild_receives))) {
+        return false;
+    }
+
+    OB1_MATCHING_UNLOCK(&proc->lock);
+    OB1_MATCHING_LOCK(&comm->matching_lock);
+    OB1_MATCHING_LOCK(&proc->lock);
+    return true;
+}
+
+static inline void mca_pml_ob1_match_unlock_peer (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc,
+                                                  bool global)
+{
+    if (comm->match_per_peer && NULL != proc) {
+        OB1_MATCHING_UNLOCK(&proc->lock);
+    }
+    if (global) {
+        OB1_MATCHING_UNLOCK(&comm->matching_lock);
+    }
+}
+
+/**
+ * Lock the matching of all the peers of a communicator, as needed to post
+ * a wildcard receive.
+ */
+static inline void mca_pml_ob1_match_lock_all (struct ompi_communicator_t *comm)
+{
+    mca_pml_ob1_comm_t *pml_comm = comm->c_pml_comm;
+
+    OB1_MATCHING_LOCK(&pml_comm->matching_lock);
+    if (pml_comm->match_per_peer) {
+        /* create the missing peers, a fragment from a peer without a lock
+         * could otherwise be matched concurrently */
+        for (size_t i = 0 ; i < pml_comm->num_procs ; ++i) {
+            OB1_MATCHING_LOCK(&mca_pml_ob1_peer_lookup (comm, (int) i)->lock);
+        }
+    }
+}
+
+static inline void mca_pml_ob1_match_unlock_all (mca_pml_ob1_comm_t *comm)
+{
+    if (comm->match_per_peer) {
+        for (size_t i = comm->num_procs ; i > 0 ; --i) {
+            OB1_MATCHING_UNLOCK(&comm->procs[i - 1]->lock);
+        }
+    }
+    OB1_MATCHING_UNLOCK(&comm->matching_lock);
+}
+
 /**
  * Initialize an instance of mca_pml_ob1_comm_t based on the communicator size.
  *
@@ -117,6 +250,30 @@ static inline mca_pml_ob1_comm_proc_t *mca_pml_ob1_peer_lookup (struct ompi_comm
 
 extern int mca_pml_ob1_comm_init_size(mca_pml_ob1_comm_t* comm, size_t size);
 
+/**
+ * Change the matching engine used by a communicator.
+ *
+ * @param  comm   Instance of mca_pml_ob1_comm_t
+ * @param  engine Matching engine, or NULL for the per-peer opal_list_t queues
+ * @return        OMPI_SUCCESS, or OMPI_ERR_RESOURCE_BUSY if the queues of the
+ *                communicator are not empty and cannot be migrated (one
+ *                of the engines has no drain functions).
+ *
+ * The posted receives and unexpected fragments are moved to the new
+ * engine, preserving the posting and arrival orders. Must be called with
+ * the matching lock held.
+ */
+extern int mca_pml_ob1_comm_set_match_engine (mca_pml_ob1_comm_t *comm,
+                                              const mca_pml_ob1_custom_match_engine_t *engine);
+
+/**
+ * End of an adaptation window: move the queues to the adaptive engine if
+ * the average depth went over pml_ob1_matching_adaptive_high, or back to
+ * the per-peer queues if it went under pml_ob1_matching_adaptive_low.
+ * Must be called with the matching lock held.
+ */
+extern void mca_pml_ob1_comm_match_adapt (mca_pml_ob1_comm_t *comm);
+
 END_C_DECLS
 #endif
 
@@ -151,12 +151,11 @@ static int mca_pml_ob1_get_unex_msgq_size (const struct mca_base_pvar_t *pvar, v
     for (i = 0 ; i < comm_size ; ++i) {
         pml_proc = pml_comm->procs[i];
         if (pml_proc) {
-#if MCA_PML_OB1_CUSTOM_MATCH
-            values[i] = custom_match_umq_size(pml_comm->umq); // TODO: given the structure of custom match this does not make sense,
-                                                     //       as we only have one set of queues.
-#else
-            values[i] = opal_list_get_size (&pml_proc->unexpected_frags);
-#endif
+            if (NULL != pml_comm->match_engine) {
+                values[i] = pml_proc->match_unexpected;
+            } else {
+                values[i] = opal_list_get_size (&pml_proc->unexpected_frags);
+            }
         } else {
             values[i] = 0;
         }
@@ -178,12 +177,11 @@ static int mca_pml_ob1_get_posted_recvq_size (const struct mca_base_pvar_t *pvar
         pml_proc = pml_comm->procs[i];
 
         if (pml_proc) {
-#if MCA_PML_OB1_CUSTOM_MATCH
-            values[i] = custom_match_prq_size(pml_comm->prq); // TODO: given the structure of custom match this does not make sense,
-                                                     //       as we only have one set of queues.
-#else
-            values[i] = opal_list_get_size (&pml_proc->specific_receives);
-#endif
+            if (NULL != pml_comm->match_engine) {
+                values[i] = pml_proc->match_posted;
+            } else {
+                values[i] = opal_list_get_size (&pml_proc->specific_receives);
+            }
         } else {
             values[i] = 0;
         }
@@ -192,8 +190,75 @@ static int mca_pml_ob1_get_posted_recvq_size (const struct mca_base_pvar_t *pvar
     return OMPI_SUCCESS;
 }
 
+static int mca_pml_ob1_match_histogram_notify (mca_base_pvar_t *pvar, mca_base_pvar_event_t event, void *obj_handle, int *count)
+{
+    if (MCA_BASE_PVAR_HANDLE_BIND == event) {
+        *count = MCA_PML_OB1_MATCH_DEPTH_BINS;
+    }
+
+    return OMPI_SUCCESS;
+}
+
+static int mca_pml_ob1_get_match_histogram (const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
+{
+    ompi_communicator_t *comm = (ompi_communicator_t *) obj_handle;
+    mca_pml_ob1_comm_t *pml_comm = comm->c_pml_comm;
+    unsigned long long *values = (unsigned long long *) value;
+
+    if (NULL == pml_comm) {
+        return OMPI_ERROR;
+    }
+
+    for (int i = 0 ; i < MCA_PML_OB1_MATCH_DEPTH_BINS ; ++i) {
+        values[i] = pml_comm->match_depth_histogram[i];
+    }
+
+    return OMPI_SUCCESS;
+}
+
+static int mca_pml_ob1_get_match_migrations (const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
+{
+    ompi_communicator_t *comm = (ompi_communicator_t *) obj_handle;
+    mca_pml_ob1_comm_t *pml_comm = comm->c_pml_comm;
+
+    if (NULL == pml_comm) {
+        return OMPI_ERROR;
+    }
+
+    *(unsigned long long *) value = pml_comm->match_migrations;
+
+    return OMPI_SUCCESS;
+}
+
+/* the pack and unpack times are accumulated in cycles */
+static int mca_pml_ob1_get_convertor_time (const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
+{
+    uint64_t cycles = (uint64_t) *(opal_atomic_int64_t *) pvar->ctx;
+    uint64_t freq = (uint64_t) opal_timer_base_get_freq ();
+
+    *(unsigned long long *) value = (0 != freq) ? (cycles / freq) * 1000000 + (cycles % freq) * 1000000 / freq : 0;
+
+    return OMPI_SUCCESS;
+}
+
+static int mca_pml_ob1_get_match_engine (const struct mca_base_pvar_t *pvar, void *value, void *obj_handle)
+{
+    ompi_communicator_t *comm = (ompi_communicator_t *) obj_handle;
+    mca_pml_ob1_comm_t *pml_comm = comm->c_pml_comm;
+
+    if (NULL == pml_comm) {
+        return OMPI_ERROR;
+    }
+
+    *(int *) value = pml_comm->match_engine ? pml_comm->match_engine->id : MCA_PML_OB1_CUSTOM_MATCHING_NONE;
+
+    return OMPI_SUCCESS;
+}
+
 static int mca_pml_ob1_component_register(void)
 {
+    mca_base_var_enum_t *new_enum;
+
     mca_pml_ob1_param_register_int("verbose", 0, &mca_pml_ob1_verbose);
 
     mca_pml_ob1_param_register_int("free_list_num", 4, &mca_pml_ob1.free_list_num);
@@ -214,6 +279,88 @@ static int mca_pml_ob1_component_register(void)
 
     mca_pml_ob1_param_register_uint("unexpected_limit", 128, &mca_pml_ob1.unexpected_limit);
 
+    mca_pml_ob1.matching_engine = MCA_PML_OB1_CUSTOM_MATCHING;
+    (void) mca_pml_ob1_custom_match_engine_enum_create (&new_enum);
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_engine",
+                                           "Matching engine used by default for the posted receive and "
+                                           "unexpected message queues of communicators. \"none\" uses the "
+                                           "per-peer queues, the fuzzy and vector engines require AVX512 "
+                                           "support and fall back to \"none\" on other processors. Can be "
+                                           "overridden for a communicator with the \"ompi_pml_ob1_matching_engine\" "
+                                           "info key", MCA_BASE_VAR_TYPE_INT, new_enum, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_pml_ob1.matching_engine);
+    OBJ_RELEASE(new_enum);
+
+    mca_pml_ob1.matching_engine_min_procs = 0;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_engine_min_procs",
+                                           "Minimum size of a communicator for the default matching engine to "
+                                           "be used. Smaller communicators use the per-peer queues (default: 0)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.matching_engine_min_procs);
+
+    mca_pml_ob1.matching_adaptive = false;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_adaptive",
+                                           "Track the depth of the matching queues of the communicators that do "
+                                           "not select an engine with the \"ompi_pml_ob1_matching_engine\" info key, "
+                                           "and move their queues between the per-peer queues and "
+                                           "pml_ob1_matching_adaptive_engine depending on it (default: false)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.matching_adaptive);
+
+    mca_pml_ob1.matching_adaptive_engine = MCA_PML_OB1_CUSTOM_MATCHING_HASH;
+    (void) mca_pml_ob1_custom_match_engine_enum_create (&new_enum);
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_adaptive_engine",
+                                           "Matching engine used for deep queues when pml_ob1_matching_adaptive "
+                                           "is enabled. Only the linkedlist and hash engines support moving "
+                                           "queues (default: hash)", MCA_BASE_VAR_TYPE_INT, new_enum, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &mca_pml_ob1.matching_adaptive_engine);
+    OBJ_RELEASE(new_enum);
+
+    mca_pml_ob1.matching_adaptive_window = 1024;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_adaptive_window",
+                                           "Number of incoming messages over which the average depth of the "
+                                           "matching queues is computed (default: 1024)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.matching_adaptive_window);
+    if (mca_pml_ob1.matching_adaptive_window < 1) {
+        mca_pml_ob1.matching_adaptive_window = 1;
+    }
+
+    mca_pml_ob1.matching_adaptive_high = 64;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_adaptive_high",
+                                           "Average depth of the queues of the sending peers above which the queues of a communicator are "
+                                           "moved to pml_ob1_matching_adaptive_engine (default: 64)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.matching_adaptive_high);
+
+    mca_pml_ob1.matching_adaptive_low = 8;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_adaptive_low",
+                                           "Average depth of the queues of the sending peers below which the queues of a communicator are "
+                                           "moved back to the per-peer queues (default: 8)",
+                                           MCA_BASE_VAR_TYPE_INT, NULL, 0, 0, OPAL_INFO_LVL_6,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.matching_adaptive_low);
+
+    mca_pml_ob1.matching_per_peer_locks = false;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "matching_per_peer_locks",
+                                           "With MPI_THREAD_MULTIPLE, match the messages of communicators using "
+                                           "the per-peer queues under a lock per peer instead of a lock per "
+                                           "communicator. The communicator lock is still taken while MPI_ANY_SOURCE "
+                                           "receives are posted. Communicators using a matching engine or the "
+                                           "adaptive matching are not affected (default: false)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.matching_per_peer_locks);
+
+    mca_pml_ob1.pack_pipeline = false;
+    (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "pack_pipeline",
+                                           "When the pipeline of a large non-contiguous send sent by copy "
+                                           "in/out is full (see pml_ob1_send_pipeline_depth), pack the next "
+                                           "fragment right away so it is ready to be sent as soon as a "
+                                           "fragment completes (default: false)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                           MCA_BASE_VAR_SCOPE_LOCAL, &mca_pml_ob1.pack_pipeline);
+
     mca_pml_ob1.use_all_rdma = false;
     (void) mca_base_component_var_register(&mca_pml_ob1_component.pmlm_version, "use_all_rdma",
                                            "Use all available RDMA btls for the RDMA and RDMA pipeline protocols "
@@ -239,6 +386,82 @@ static int mca_pml_ob1_component_register(void)
                                            MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
                                            mca_pml_ob1_get_posted_recvq_size, NULL, mca_pml_ob1_comm_size_notify, NULL);
 
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "match_depth_histogram", "Histogram of the depth of the matching "
+                                           "queues seen by incoming messages when pml_ob1_matching_adaptive is "
+                                           "enabled. Bin 0 counts empty queues, bin i > 0 depths in "
+                                           "[2^(i-1), 2^i), the last bin all the deeper queues",
+                                           OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_COUNTER,
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_MPI_COMM,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_match_histogram, NULL,
+                                           mca_pml_ob1_match_histogram_notify, NULL);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "match_engine_migrations", "Number of times the matching queues of "
+                                           "a communicator were moved to another matching engine",
+                                           OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_COUNTER,
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_MPI_COMM,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_match_migrations, NULL, NULL, NULL);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "pack_time", "Time spent packing the large non-contiguous "
+                                           "messages sent (microseconds)", OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_TIMER,
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_NO_OBJECT,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_convertor_time, NULL, NULL,
+                                           (void *) &mca_pml_ob1.pack_time);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "pack_time_max", "Longest time spent packing a large "
+                                           "non-contiguous message (microseconds)", OPAL_INFO_LVL_4,
+                                           MPI_T_PVAR_CLASS_HIGHWATERMARK, MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG,
+                                           NULL, MPI_T_BIND_NO_OBJECT,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_convertor_time, NULL, NULL,
+                                           (void *) &mca_pml_ob1.pack_time_max);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "pack_messages", "Number of large non-contiguous messages "
+                                           "accounted in pack_time", OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_COUNTER,
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_NO_OBJECT,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           NULL, NULL, NULL, (void *) &mca_pml_ob1.pack_messages);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "unpack_time", "Time spent unpacking the large non-contiguous "
+                                           "messages received (microseconds)", OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_TIMER,
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_NO_OBJECT,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_convertor_time, NULL, NULL,
+                                           (void *) &mca_pml_ob1.unpack_time);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "unpack_time_max", "Longest time spent unpacking a large "
+                                           "non-contiguous message (microseconds)", OPAL_INFO_LVL_4,
+                                           MPI_T_PVAR_CLASS_HIGHWATERMARK, MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG,
+                                           NULL, MPI_T_BIND_NO_OBJECT,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_convertor_time, NULL, NULL,
+                                           (void *) &mca_pml_ob1.unpack_time_max);
+
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "unpack_messages", "Number of large non-contiguous messages "
+                                           "accounted in unpack_time", OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_COUNTER,
+                                           MCA_BASE_VAR_TYPE_UNSIGNED_LONG_LONG, NULL, MPI_T_BIND_NO_OBJECT,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           NULL, NULL, NULL, (void *) &mca_pml_ob1.unpack_messages);
+
+    (void) mca_pml_ob1_custom_match_engine_enum_create (&new_enum);
+    (void)mca_base_component_pvar_register(&mca_pml_ob1_component.pmlm_version,
+                                           "match_engine", "Matching engine currently used by a communicator",
+                                           OPAL_INFO_LVL_4, MPI_T_PVAR_CLASS_STATE,
+                                           MCA_BASE_VAR_TYPE_INT, new_enum, MPI_T_BIND_MPI_COMM,
+                                           MCA_BASE_PVAR_FLAG_READONLY | MCA_BASE_PVAR_FLAG_CONTINUOUS,
+                                           mca_pml_ob1_get_match_engine, NULL, NULL, NULL);
+    OBJ_RELEASE(new_enum);
+
     return OMPI_SUCCESS;
 }
 
@@ -247,6 +470,25 @@ static int mca_pml_ob1_component_open(void)
     mca_pml_ob1_output = opal_output_open(NULL);
     opal_output_set_verbosity(mca_pml_ob1_output, mca_pml_ob1_verbose);
 
+    /* the adaptive matching needs a gap between its thresholds, or the
+     * queues of a communicator would move back and forth on each window */
+    if (mca_pml_ob1.matching_adaptive_low < 0 ||
+        mca_pml_ob1.matching_adaptive_high <= mca_pml_ob1.matching_adaptive_low) {
+        int high = (mca_pml_ob1.matching_adaptive_high < 1) ? 1 : mca_pml_ob1.matching_adaptive_high;
+        int low = mca_pml_ob1.matching_adaptive_low;
+
+        if (low < 0) {
+            low = 0;
+        } else if (low >= high) {
+            low = high - 1;
+        }
+        opal_output(0, "mca_pml_ob1_component_open: pml_ob1_matching_adaptive_low (%d) and "
+                    "pml_ob1_matching_adaptive_high (%d) must satisfy 0 <= low < high, using %d and %d\n",
+                    mca_pml_ob1.matching_adaptive_low, mca_pml_ob1.matching_adaptive_high, low, high);
+        mca_pml_ob1.matching_adaptive_low = low;
+        mca_pml_ob1.matching_adaptive_high = high;
+    }
+
     mca_pml_ob1.enabled = false;
     return mca_base_framework_open(&ompi_bml_base_framework, 0);
 }
@@ -86,22 +86,19 @@ append_frag_to_list(opal_list_t *queue, mca_btl_base_module_t *btl,
     opal_list_append(queue, (opal_list_item_t*)frag);
 }
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-
 static void
-append_frag_to_umq(custom_match_umq *queue, mca_btl_base_module_t *btl,
-                   const mca_pml_ob1_match_hdr_t *hdr, const mca_btl_base_segment_t *segments,
-                   size_t num_segments, mca_pml_ob1_recv_frag_t* frag)
+append_frag_to_unexpected(mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc,
+                          mca_btl_base_module_t *btl, const mca_pml_ob1_match_hdr_t *hdr,
+                          const mca_btl_base_segment_t *segments, size_t num_segments,
+                          mca_pml_ob1_recv_frag_t* frag)
 {
-  if(NULL == frag) {
-    MCA_PML_OB1_RECV_FRAG_ALLOC(frag);
-    MCA_PML_OB1_RECV_FRAG_INIT(frag, hdr, segments, num_segments, btl);
-  }
-  custom_match_umq_append(queue, hdr->hdr_tag, hdr->hdr_src, frag);
+    if(NULL == frag) {
+        MCA_PML_OB1_RECV_FRAG_ALLOC(frag);
+        MCA_PML_OB1_RECV_FRAG_INIT(frag, hdr, segments, num_segments, btl);
+    }
+    mca_pml_ob1_append_unexpected_frag(comm, proc, frag);
 }
 
-#endif
-
 
 /**
  * Append an unexpected descriptor to an ordered queue.
@@ -308,6 +305,8 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
  * @param segments (IN)             Received recv_frag descriptor.
  * @param num_segments (IN)         Flag indicating wether a match was made.
  * @param type (IN)                 Type of the message header.
+ * @param global (IN)               Whether the matching_lock is held (see
+ *                                  mca_pml_ob1_match_lock_peer).
  * @return                          OMPI_SUCCESS or error status on failure.
  */
 static int
@@ -318,7 +317,8 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                                   const mca_btl_base_segment_t *segments,
                                   size_t num_segments,
                                   int type,
-                                  mca_pml_ob1_recv_frag_t *frag);
+                                  mca_pml_ob1_recv_frag_t *frag,
+                                  bool global);
 
 static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
                                               const mca_pml_ob1_match_hdr_t *hdr,
@@ -348,6 +348,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
     mca_pml_ob1_comm_proc_t *proc;
     size_t num_segments = descriptor->des_segment_count;
     size_t bytes_received = 0;
+    bool global;
 
     assert(num_segments <= MCA_BTL_DES_MAX_SEGMENTS);
 
@@ -391,7 +392,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
      * end points) from being processed, and potentially "loosing"
      * the fragment.
      */
-    OB1_MATCHING_LOCK(&comm->matching_lock);
+    global = mca_pml_ob1_match_lock_peer(comm, proc, true);
 
     if (!OMPI_COMM_CHECK_ASSERT_ALLOW_OVERTAKE(comm_ptr)) {
         /* get sequence number of next message that can be processed.
@@ -404,7 +405,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
             MCA_PML_OB1_RECV_FRAG_INIT(frag, hdr, segments, num_segments, btl);
             append_frag_to_ordered_list(&proc->frags_cant_match, frag, proc->expected_sequence);
             SPC_RECORD(OMPI_SPC_OUT_OF_SEQUENCE, 1);
-            OB1_MATCHING_UNLOCK(&comm->matching_lock);
+            mca_pml_ob1_match_unlock_peer(comm, proc, global);
             return;
         }
 
@@ -429,7 +430,7 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
                            hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
 
     /* release matching lock before processing fragment */
-    OB1_MATCHING_UNLOCK(&comm->matching_lock);
+    mca_pml_ob1_match_unlock_peer(comm, proc, global);
 
     if(OPAL_LIKELY(match)) {
         bytes_received = segments->seg_len - OMPI_PML_OB1_MATCH_HDR_LEN;
@@ -498,15 +499,16 @@ void mca_pml_ob1_recv_frag_callback_match (mca_btl_base_module_t *btl,
     if(NULL != proc->frags_cant_match) {
         mca_pml_ob1_recv_frag_t* frag;
 
-        OB1_MATCHING_LOCK(&comm->matching_lock);
+        global = mca_pml_ob1_match_lock_peer(comm, proc, true);
         if((frag = check_cantmatch_for_match(proc))) {
             /* mca_pml_ob1_recv_frag_match_proc() will release the lock. */
             mca_pml_ob1_recv_frag_match_proc(frag->btl, comm_ptr, proc,
                                              &frag->hdr.hdr_match,
                                              frag->segments, frag->num_segments,
-                                             frag->hdr.hdr_match.hdr_common.hdr_type, frag);
+                                             frag->hdr.hdr_match.hdr_common.hdr_type, frag,
+                                             global);
         } else {
-            OB1_MATCHING_UNLOCK(&comm->matching_lock);
+            mca_pml_ob1_match_unlock_peer(comm, proc, global);
         }
     }
 }
@@ -697,11 +699,20 @@ static mca_pml_ob1_recv_request_t *match_incomming(const mca_pml_ob1_match_hdr_t
                                                    mca_pml_ob1_comm_t *comm,
                                                    mca_pml_ob1_comm_proc_t *proc)
 {
-#if !MCA_PML_OB1_CUSTOM_MATCH
     mca_pml_ob1_recv_request_t *specific_recv, *wild_recv;
     mca_pml_sequence_t wild_recv_seq, specific_recv_seq;
     int tag = hdr->hdr_tag;
 
+    if (NULL != comm->match_engine) {
+        specific_recv = (mca_pml_ob1_recv_request_t *)
+            comm->match_engine->prq_find_dequeue_verify(comm->prq, hdr->hdr_tag, hdr->hdr_src);
+        if (NULL != specific_recv) {
+            mca_pml_ob1_comm_count_posted(comm, OMPI_ANY_SOURCE == specific_recv->req_recv.req_base.req_peer ?
+                                          NULL : proc, -1);
+        }
+        return specific_recv;
+    }
+
     specific_recv = get_posted_recv(&proc->specific_receives);
     wild_recv = get_posted_recv(&comm->wild_receives);
 
@@ -740,15 +751,17 @@ static mca_pml_ob1_recv_request_t *match_incomming(const mca_pml_ob1_match_hdr_t
     }
 
     return NULL;
-#else
-    return custom_match_prq_find_dequeue_verify(comm->prq, hdr->hdr_tag, hdr->hdr_src);
-#endif
 }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
-static mca_pml_ob1_recv_request_t *match_incomming_no_any_source (const mca_pml_ob1_match_hdr_t *hdr,
-                                                                  mca_pml_ob1_comm_t *comm,
-                                                                  mca_pml_ob1_comm_proc_t *proc)
+/**
+ * Match an incoming fragment against the specific receives of its peer only.
+ * Used when no wildcard receive can be posted for this peer, in which case the
+ * merge with the wildcard queue by sequence number is not needed. If any_tag
+ * is false (mpi_assert_no_any_tag) the tags are compared directly.
+ */
+static inline mca_pml_ob1_recv_request_t *match_incomming_no_any_source (const mca_pml_ob1_match_hdr_t *hdr,
+                                                                         mca_pml_ob1_comm_proc_t *proc,
+                                                                         bool any_tag)
 {
     mca_pml_ob1_recv_request_t *recv_req;
     int tag = hdr->hdr_tag;
@@ -756,7 +769,7 @@ static mca_pml_ob1_recv_request_t *match_incomming_no_any_source (const mca_pml_
     OPAL_LIST_FOREACH(recv_req, &proc->specific_receives, mca_pml_ob1_recv_request_t) {
         int req_tag = recv_req->req_recv.req_base.req_tag;
 
-        if (req_tag == tag || (req_tag == OMPI_ANY_TAG && tag >= 0)) {
+        if (req_tag == tag || (any_tag && req_tag == OMPI_ANY_TAG && tag >= 0)) {
             opal_list_remove_item (&proc->specific_receives, (opal_list_item_t *) recv_req);
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_REQ_REMOVE_FROM_POSTED_Q,
                     &(recv_req->req_recv.req_base), PERUSE_RECV);
@@ -766,7 +779,30 @@ static mca_pml_ob1_recv_request_t *match_incomming_no_any_source (const mca_pml_
 
     return NULL;
 }
-#endif
+
+/**
+ * Record the depth of the queues an incoming fragment is matched against in
+ * the histogram of the communicator, and give the communicator a chance to
+ * change matching engine at the end of each adaptation window. The depth is
+ * the one of the per-peer queues of the sender whatever the engine in use
+ * (see mca_pml_ob1_comm_peer_depth), so that the thresholds mean the same
+ * in both directions. Must be called with the matching lock held.
+ */
+static inline void match_record_depth (mca_pml_ob1_comm_t *comm, mca_pml_ob1_comm_proc_t *proc)
+{
+    size_t depth = mca_pml_ob1_comm_peer_depth(comm, proc);
+    int bin = 0;
+
+    for (size_t tmp = depth ; tmp && bin < MCA_PML_OB1_MATCH_DEPTH_BINS - 1 ; tmp >>= 1) {
+        ++bin;
+    }
+    comm->match_depth_histogram[bin]++;
+
+    comm->match_window_depth += depth;
+    if (++comm->match_window_count >= (uint32_t) mca_pml_ob1.matching_adaptive_window) {
+        mca_pml_ob1_comm_match_adapt(comm);
+    }
+}
 
 static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
                                               const mca_pml_ob1_match_hdr_t *hdr,
@@ -783,16 +819,19 @@ static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
     mca_pml_ob1_recv_request_t *match;
     mca_pml_ob1_comm_t *comm = (mca_pml_ob1_comm_t *)comm_ptr->c_pml_comm;
 
+    if (OPAL_UNLIKELY(comm->match_adaptive)) {
+        match_record_depth(comm, proc);
+    }
+
     do {
-#if MCA_PML_OB1_CUSTOM_MATCH
-        match = match_incomming(hdr, comm, proc);
-#else
-        if (!OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE (comm_ptr)) {
+        /* with per-peer locks, wildcard receives cannot be posted while the
+         * wildcard queue is empty and the lock of the peer is held */
+        if (NULL != comm->match_engine || (!OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE (comm_ptr) &&
+                                           !(comm->match_per_peer && 0 == opal_list_get_size(&comm->wild_receives)))) {
             match = match_incomming(hdr, comm, proc);
         } else {
-            match = match_incomming_no_any_source (hdr, comm, proc);
+            match = match_incomming_no_any_source (hdr, proc, !OMPI_COMM_CHECK_ASSERT_NO_ANY_TAG (comm_ptr));
         }
-#endif
 
         /* if match found, process data */
         if(OPAL_LIKELY(NULL != match)) {
@@ -832,13 +871,8 @@ static mca_pml_ob1_recv_request_t *match_one (mca_btl_base_module_t *btl,
         }
 
         /* if no match found, place on unexpected queue */
-#if MCA_PML_OB1_CUSTOM_MATCH
-        append_frag_to_umq(comm->umq, btl, hdr, segments,
-                            num_segments, frag);
-#else
-        append_frag_to_list(&proc->unexpected_frags, btl, hdr, segments,
-                            num_segments, frag);
-#endif
+        append_frag_to_unexpected(comm, proc, btl, hdr, segments,
+                                  num_segments, frag);
         SPC_RECORD(OMPI_SPC_UNEXPECTED, 1);
         SPC_RECORD(OMPI_SPC_UNEXPECTED_IN_QUEUE, 1);
         SPC_UPDATE_WATERMARK(OMPI_SPC_MAX_UNEXPECTED_IN_QUEUE, OMPI_SPC_UNEXPECTED_IN_QUEUE);
@@ -891,6 +925,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
     ompi_communicator_t *comm_ptr;
     mca_pml_ob1_comm_t *comm;
     mca_pml_ob1_comm_proc_t *proc;
+    bool global;
 
     /* communicator pointer */
     comm_ptr = ompi_comm_lookup(hdr->hdr_ctx);
@@ -927,7 +962,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
      * end points) from being processed, and potentially "loosing"
      * the fragment.
      */
-    OB1_MATCHING_LOCK(&comm->matching_lock);
+    global = mca_pml_ob1_match_lock_peer(comm, proc, true);
 
     frag_msg_seq = hdr->hdr_seq;
     next_msg_seq_expected = (uint16_t)proc->expected_sequence;
@@ -944,7 +979,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
             SPC_RECORD(OMPI_SPC_OOS_IN_QUEUE, 1);
             SPC_UPDATE_WATERMARK(OMPI_SPC_MAX_OOS_IN_QUEUE, OMPI_SPC_OOS_IN_QUEUE);
 
-            OB1_MATCHING_UNLOCK(&comm->matching_lock);
+            mca_pml_ob1_match_unlock_peer(comm, proc, global);
             return OMPI_SUCCESS;
         }
     }
@@ -952,7 +987,7 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
     /* mca_pml_ob1_recv_frag_match_proc() will release the lock. */
     return mca_pml_ob1_recv_frag_match_proc(btl, comm_ptr, proc, hdr,
                                             segments, num_segments,
-                                            type, NULL);
+                                            type, NULL, global);
 }
 
 
@@ -960,8 +995,9 @@ static int mca_pml_ob1_recv_frag_match (mca_btl_base_module_t *btl,
  * then try to match the next frag in sequence by looking into arrived
  * out of order frags in frags_cant_match list until it can't find one.
  *
- * ATTENTION: THIS FUNCTION MUST BE CALLED WITH COMMUNICATOR LOCK HELD.
- * THE LOCK WILL BE RELEASED UPON RETURN. USE WITH CARE. */
+ * ATTENTION: THIS FUNCTION MUST BE CALLED WITH THE MATCHING LOCK OF THE PEER
+ * HELD (mca_pml_ob1_match_lock_peer). THE LOCK WILL BE RELEASED UPON RETURN.
+ * USE WITH CARE. */
 static int
 mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                                   ompi_communicator_t* comm_ptr,
@@ -970,7 +1006,8 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                                   const mca_btl_base_segment_t *segments,
                                   size_t num_segments,
                                   int type,
-                                  mca_pml_ob1_recv_frag_t *frag)
+                                  mca_pml_ob1_recv_frag_t *frag,
+                                  bool global)
 {
     /* local variables */
     mca_pml_ob1_comm_t *comm = (mca_pml_ob1_comm_t *)comm_ptr->c_pml_comm;
@@ -1005,7 +1042,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
                            hdr->hdr_src, hdr->hdr_tag, PERUSE_RECV);
 
     /* release matching lock before processing fragment */
-    OB1_MATCHING_UNLOCK(&comm->matching_lock);
+    mca_pml_ob1_match_unlock_peer(comm, proc, global);
 
     if(OPAL_LIKELY(match)) {
         switch(type) {
@@ -1030,7 +1067,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
      * may now be used to form new matchs
      */
     if(OPAL_UNLIKELY(NULL != proc->frags_cant_match)) {
-        OB1_MATCHING_LOCK(&comm->matching_lock);
+        global = mca_pml_ob1_match_lock_peer(comm, proc, true);
         if((frag = check_cantmatch_for_match(proc))) {
             hdr = &frag->hdr.hdr_match;
             segments = frag->segments;
@@ -1039,7 +1076,7 @@ mca_pml_ob1_recv_frag_match_proc (mca_btl_base_module_t *btl,
             type = hdr->hdr_common.hdr_type;
             goto match_this_frag;
         }
-        OB1_MATCHING_UNLOCK(&comm->matching_lock);
+        mca_pml_ob1_match_unlock_peer(comm, proc, global);
     }
 
     return OMPI_SUCCESS;
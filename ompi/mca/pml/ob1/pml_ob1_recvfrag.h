@@ -29,6 +29,7 @@
 #define MCA_PML_OB1_RECVFRAG_H
 
 #include "pml_ob1_hdr.h"
+#include "pml_ob1_comm.h"
 
 BEGIN_C_DECLS
 
@@ -158,6 +159,29 @@ extern void mca_pml_ob1_recv_frag_callback_put (mca_btl_base_module_t *btl,
 extern void mca_pml_ob1_recv_frag_callback_fin (mca_btl_base_module_t *btl,
                                                 const mca_btl_base_receive_descriptor_t *descriptor);
 
+/**
+ * Append a fragment to the unexpected queue of a communicator: either the
+ * queue of the matching engine, or the unexpected queue of the peer. Must
+ * be called with the matching lock held.
+ */
+static inline void mca_pml_ob1_append_unexpected_frag (mca_pml_ob1_comm_t *comm,
+                                                       mca_pml_ob1_comm_proc_t *proc,
+                                                       mca_pml_ob1_recv_frag_t *frag)
+{
+    const mca_pml_ob1_match_hdr_t *hdr = &frag->hdr.hdr_match;
+
+    if (NULL != comm->match_engine) {
+        if (OPAL_UNLIKELY(OMPI_SUCCESS != comm->match_engine->umq_append (comm->umq, hdr->hdr_tag,
+                                                                          hdr->hdr_src, frag))) {
+            OMPI_ERROR_LOG(OMPI_ERR_OUT_OF_RESOURCE);
+            ompi_rte_abort(-1, NULL);
+        }
+        proc->match_unexpected++;
+    } else {
+        opal_list_append (&proc->unexpected_frags, (opal_list_item_t *) frag);
+    }
+}
+
 /**
  * Extract the next fragment from the cant_match ordered list. This fragment
  * will be the next in sequence.
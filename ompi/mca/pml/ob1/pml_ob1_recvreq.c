@@ -102,25 +102,29 @@ static int mca_pml_ob1_recv_request_cancel(struct ompi_request_t* ompi_request,
     mca_pml_ob1_recv_request_t* request = (mca_pml_ob1_recv_request_t*)ompi_request;
     ompi_communicator_t *comm = request->req_recv.req_base.req_comm;
     mca_pml_ob1_comm_t *ob1_comm = comm->c_pml_comm;
+    mca_pml_ob1_comm_proc_t *proc = NULL;
+    bool global;
+
+    if (OMPI_ANY_SOURCE != request->req_recv.req_base.req_peer) {
+        proc = mca_pml_ob1_peer_lookup (comm, request->req_recv.req_base.req_peer);
+    }
 
     /* The rest should be protected behind the match logic lock */
-    OB1_MATCHING_LOCK(&ob1_comm->matching_lock);
+    global = mca_pml_ob1_match_lock_peer(ob1_comm, proc, false);
     if( true == request->req_match_received ) { /* way to late to cancel this one */
-        OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+        mca_pml_ob1_match_unlock_peer(ob1_comm, proc, global);
         assert( OMPI_ANY_TAG != ompi_request->req_status.MPI_TAG ); /* not matched isn't it */
         return OMPI_SUCCESS;
     }
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-    custom_match_prq_cancel(ob1_comm->prq, request);
-#else
-    if( request->req_recv.req_base.req_peer == OMPI_ANY_SOURCE ) {
+    if (NULL != ob1_comm->match_engine) {
+        ob1_comm->match_engine->prq_cancel(ob1_comm->prq, request);
+        mca_pml_ob1_comm_count_posted(ob1_comm, proc, -1);
+    } else if( NULL == proc ) {
         opal_list_remove_item( &ob1_comm->wild_receives, (opal_list_item_t*)request );
     } else {
-        mca_pml_ob1_comm_proc_t* proc = mca_pml_ob1_peer_lookup (comm, request->req_recv.req_base.req_peer);
         opal_list_remove_item(&proc->specific_receives, (opal_list_item_t*)request);
     }
-#endif
     PERUSE_TRACE_COMM_EVENT( PERUSE_COMM_REQ_REMOVE_FROM_POSTED_Q,
                              &(request->req_recv.req_base), PERUSE_RECV );
     /**
@@ -128,7 +132,7 @@ static int mca_pml_ob1_recv_request_cancel(struct ompi_request_t* ompi_request,
      * to true. Otherwise, the request will never be freed.
      */
     request->req_recv.req_base.req_pml_complete = true;
-    OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+    mca_pml_ob1_match_unlock_peer(ob1_comm, proc, global);
 
     ompi_request->req_status._cancelled = true;
     /* This macro will set the req_complete to true so the MPI Test/Wait* functions
@@ -512,48 +516,69 @@ int mca_pml_ob1_recv_request_get_frag (mca_pml_ob1_rdma_frag_t *frag)
 
 
 /*
- * Update the recv request status to reflect the number of bytes
- * received and actually delivered to the application.
+ * Unpack a fragment of a large message at its own position in the
+ * convertor. The time spent unpacking the non-contiguous messages is
+ * accounted in req_unpack_time, atomically as the fragments of a request
+ * can be unpacked by several threads at once.
  */
-
-void mca_pml_ob1_recv_request_progress_frag( mca_pml_ob1_recv_request_t* recvreq,
-                                             mca_btl_base_module_t* btl,
-                                             const mca_btl_base_segment_t* segments,
-                                             size_t num_segments )
+static inline void
+mca_pml_ob1_recv_request_unpack_frag (mca_pml_ob1_recv_request_t *recvreq,
+                                      const mca_btl_base_segment_t *segments,
+                                      size_t num_segments, size_t hdr_len,
+                                      size_t data_offset, size_t bytes_received)
 {
-    size_t bytes_received, data_offset = 0;
     size_t bytes_delivered __opal_attribute_unused__; /* is being set to zero in MCA_PML_OB1_RECV_REQUEST_UNPACK */
-    mca_pml_ob1_hdr_t* hdr = (mca_pml_ob1_hdr_t*)segments->seg_addr.pval;
-
-    bytes_received = mca_pml_ob1_compute_segment_length_base (segments, num_segments,
-                                                              sizeof(mca_pml_ob1_frag_hdr_t));
-    data_offset     = hdr->hdr_frag.hdr_frag_offset;
+    opal_timer_t start = 0;
+    bool timed = opal_convertor_need_buffers (&recvreq->req_recv.req_base.req_convertor);
 
-    /*
-     *  Make user buffer accessible(defined) before unpacking.
-     */
     MEMCHECKER(
                memchecker_call(&opal_memchecker_base_mem_defined,
                                recvreq->req_recv.req_base.req_addr,
                                recvreq->req_recv.req_base.req_count,
                                recvreq->req_recv.req_base.req_datatype);
                );
+    if (timed) {
+        start = opal_timer_base_get_cycles ();
+    }
     MCA_PML_OB1_RECV_REQUEST_UNPACK( recvreq,
                                      segments,
                                      num_segments,
-                                     sizeof(mca_pml_ob1_frag_hdr_t),
+                                     hdr_len,
                                      data_offset,
                                      bytes_received,
                                      bytes_delivered );
-    /*
-     *  Unpacking finished, make the user buffer unaccessable again.
-     */
+    if (timed) {
+        OPAL_THREAD_ADD_FETCH64(&recvreq->req_unpack_time,
+                                (int64_t) (opal_timer_base_get_cycles () - start));
+    }
     MEMCHECKER(
                memchecker_call(&opal_memchecker_base_mem_noaccess,
                                recvreq->req_recv.req_base.req_addr,
                                recvreq->req_recv.req_base.req_count,
                                recvreq->req_recv.req_base.req_datatype);
                );
+}
+
+/*
+ * Update the recv request status to reflect the number of bytes
+ * received and actually delivered to the application.
+ */
+
+void mca_pml_ob1_recv_request_progress_frag( mca_pml_ob1_recv_request_t* recvreq,
+                                             mca_btl_base_module_t* btl,
+                                             const mca_btl_base_segment_t* segments,
+                                             size_t num_segments )
+{
+    size_t bytes_received, data_offset = 0;
+    mca_pml_ob1_hdr_t* hdr = (mca_pml_ob1_hdr_t*)segments->seg_addr.pval;
+
+    bytes_received = mca_pml_ob1_compute_segment_length_base (segments, num_segments,
+                                                              sizeof(mca_pml_ob1_frag_hdr_t));
+    data_offset     = hdr->hdr_frag.hdr_frag_offset;
+
+    mca_pml_ob1_recv_request_unpack_frag (recvreq, segments, num_segments,
+                                          sizeof(mca_pml_ob1_frag_hdr_t),
+                                          data_offset, bytes_received);
 
     OPAL_THREAD_ADD_FETCH_SIZE_T(&recvreq->req_bytes_received, bytes_received);
     SPC_USER_OR_MPI(recvreq->req_recv.req_base.req_ompi.req_status.MPI_TAG, (ompi_spc_value_t)bytes_received,
@@ -811,7 +836,6 @@ void mca_pml_ob1_recv_request_progress_rndv( mca_pml_ob1_recv_request_t* recvreq
                                              size_t num_segments )
 {
     size_t bytes_received = 0;
-    size_t bytes_delivered __opal_attribute_unused__; /* is being set to zero in MCA_PML_OB1_RECV_REQUEST_UNPACK */
     size_t data_offset = 0;
     mca_pml_ob1_hdr_t* hdr = (mca_pml_ob1_hdr_t*)segments->seg_addr.pval;
 
@@ -829,25 +853,9 @@ void mca_pml_ob1_recv_request_progress_rndv( mca_pml_ob1_recv_request_t* recvreq
      * unpack.
      */
     if( 0 < bytes_received ) {
-        MEMCHECKER(
-                   memchecker_call(&opal_memchecker_base_mem_defined,
-                                   recvreq->req_recv.req_base.req_addr,
-                                   recvreq->req_recv.req_base.req_count,
-                                   recvreq->req_recv.req_base.req_datatype);
-                   );
-        MCA_PML_OB1_RECV_REQUEST_UNPACK( recvreq,
-                                         segments,
-                                         num_segments,
-                                         sizeof(mca_pml_ob1_rendezvous_hdr_t),
-                                         data_offset,
-                                         bytes_received,
-                                         bytes_delivered );
-        MEMCHECKER(
-                   memchecker_call(&opal_memchecker_base_mem_noaccess,
-                                   recvreq->req_recv.req_base.req_addr,
-                                   recvreq->req_recv.req_base.req_count,
-                                   recvreq->req_recv.req_base.req_datatype);
-                   );
+        mca_pml_ob1_recv_request_unpack_frag (recvreq, segments, num_segments,
+                                              sizeof(mca_pml_ob1_rendezvous_hdr_t),
+                                              data_offset, bytes_received);
         OPAL_THREAD_ADD_FETCH_SIZE_T(&recvreq->req_bytes_received, bytes_received);
         SPC_USER_OR_MPI(recvreq->req_recv.req_base.req_ompi.req_status.MPI_TAG, (ompi_spc_value_t)bytes_received,
                         OMPI_SPC_BYTES_RECEIVED_USER, OMPI_SPC_BYTES_RECEIVED_MPI);
@@ -1104,33 +1112,34 @@ static inline void append_recv_req_to_queue(opal_list_t *queue,
  *  function has to be called with the communicator matching lock held.
 */
 
-#if MCA_PML_OB1_CUSTOM_MATCH
 static mca_pml_ob1_recv_frag_t*
 recv_req_match_specific_proc( const mca_pml_ob1_recv_request_t *req,
                               mca_pml_ob1_comm_proc_t *proc,
-                              custom_match_umq_node** hold_prev,
-                              custom_match_umq_node** hold_elem,
-                              int* hold_index)
-#else
-static mca_pml_ob1_recv_frag_t*
-recv_req_match_specific_proc( const mca_pml_ob1_recv_request_t *req,
-                              mca_pml_ob1_comm_proc_t *proc )
-#endif
+                              mca_pml_ob1_custom_match_hold_t *hold )
 {
+    mca_pml_ob1_comm_t *comm = req->req_recv.req_base.req_comm->c_pml_comm;
+    int tag = req->req_recv.req_base.req_tag;
+    opal_list_t* unexpected_frags;
+    mca_pml_ob1_recv_frag_t* frag;
+
     if (NULL == proc) {
         return NULL;
     }
 
-#if !MCA_PML_OB1_CUSTOM_MATCH
-    int tag = req->req_recv.req_base.req_tag;
-    opal_list_t* unexpected_frags = &proc->unexpected_frags;
-    mca_pml_ob1_recv_frag_t* frag;
+    if (NULL != comm->match_engine) {
+        return (mca_pml_ob1_recv_frag_t *)
+            comm->match_engine->umq_find_verify_hold(comm->umq, tag,
+                                                     req->req_recv.req_base.req_peer,
+                                                     hold);
+    }
 
+    unexpected_frags = &proc->unexpected_frags;
     if(opal_list_get_size(unexpected_frags) == 0) {
         return NULL;
     }
 
-    if( OMPI_ANY_TAG == tag ) {
+    /* no need to look for MPI_ANY_TAG with mpi_assert_no_any_tag */
+    if( OMPI_ANY_TAG == tag && !OMPI_COMM_CHECK_ASSERT_NO_ANY_TAG(req->req_recv.req_base.req_comm) ) {
         OPAL_LIST_FOREACH(frag, unexpected_frags, mca_pml_ob1_recv_frag_t) {
             if( frag->hdr.hdr_match.hdr_tag >= 0 )
                 return frag;
@@ -1142,51 +1151,38 @@ recv_req_match_specific_proc( const mca_pml_ob1_recv_request_t *req,
         }
     }
     return NULL;
-#else
-    return custom_match_umq_find_verify_hold(req->req_recv.req_base.req_comm->c_pml_comm->umq,
-                                             req->req_recv.req_base.req_tag,
-                                             req->req_recv.req_base.req_peer,
-                                             hold_prev, hold_elem, hold_index);
-#endif
 }
 
 /*
  * this routine is used to try and match a wild posted receive - where
  * wild is determined by the value assigned to the source process
 */
-#if MCA_PML_OB1_CUSTOM_MATCH
 static mca_pml_ob1_recv_frag_t*
 recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
                      mca_pml_ob1_comm_proc_t **p,
-                     custom_match_umq_node** hold_prev,
-                     custom_match_umq_node** hold_elem,
-                     int* hold_index)
-#else
-static mca_pml_ob1_recv_frag_t*
-recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
-                     mca_pml_ob1_comm_proc_t **p)
-#endif
+                     mca_pml_ob1_custom_match_hold_t *hold )
 {
     mca_pml_ob1_comm_t* comm = req->req_recv.req_base.req_comm->c_pml_comm;
     mca_pml_ob1_comm_proc_t **procp = comm->procs;
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-    mca_pml_ob1_recv_frag_t* frag;
-    frag = custom_match_umq_find_verify_hold (comm->umq, req->req_recv.req_base.req_tag,
-                                              req->req_recv.req_base.req_peer,
-                                              hold_prev, hold_elem, hold_index);
+    if (NULL != comm->match_engine) {
+        mca_pml_ob1_recv_frag_t* frag;
+        frag = (mca_pml_ob1_recv_frag_t *)
+            comm->match_engine->umq_find_verify_hold (comm->umq, req->req_recv.req_base.req_tag,
+                                                      req->req_recv.req_base.req_peer,
+                                                      hold);
+
+        if (frag) {
+            *p = procp[frag->hdr.hdr_match.hdr_src];
+            req->req_recv.req_base.req_proc = procp[frag->hdr.hdr_match.hdr_src]->ompi_proc;
+            prepare_recv_req_converter(req);
+        } else {
+            *p = NULL;
+        }
 
-    if (frag) {
-        *p = procp[frag->hdr.hdr_match.hdr_src];
-        req->req_recv.req_base.req_proc = procp[frag->hdr.hdr_match.hdr_src]->ompi_proc;
-        prepare_recv_req_converter(req);
-    } else {
-        *p = NULL;
+        return frag;
     }
 
-    return frag;
-#else
-
     /*
      * Loop over all the outstanding messages to find one that matches.
      * There is an outer loop over lists of messages from each
@@ -1199,7 +1195,7 @@ recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
         mca_pml_ob1_recv_frag_t* frag;
 
         /* loop over messages from the current proc */
-        if((frag = recv_req_match_specific_proc(req, procp[i]))) {
+        if((frag = recv_req_match_specific_proc(req, procp[i], hold))) {
             *p = procp[i];
             comm->last_probed = i;
             req->req_recv.req_base.req_proc = procp[i]->ompi_proc;
@@ -1211,7 +1207,7 @@ recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
         mca_pml_ob1_recv_frag_t* frag;
 
         /* loop over messages from the current proc */
-        if((frag = recv_req_match_specific_proc(req, procp[i]))) {
+        if((frag = recv_req_match_specific_proc(req, procp[i], hold))) {
             *p = procp[i];
             comm->last_probed = i;
             req->req_recv.req_base.req_proc = procp[i]->ompi_proc;
@@ -1222,9 +1218,44 @@ recv_req_match_wild( mca_pml_ob1_recv_request_t* req,
 
     *p = NULL;
     return NULL;
-#endif
 }
 
+/*
+ * remove a fragment found by recv_req_match_specific_proc or
+ * recv_req_match_wild from the unexpected queue. This function has to be
+ * called with the communicator matching lock held.
+ */
+static inline void
+recv_req_remove_unexpected( mca_pml_ob1_comm_t *comm,
+                            mca_pml_ob1_comm_proc_t *proc,
+                            mca_pml_ob1_recv_frag_t *frag,
+                            mca_pml_ob1_custom_match_hold_t *hold )
+{
+    if (NULL != comm->match_engine) {
+        comm->match_engine->umq_remove_hold(comm->umq, hold);
+        proc->match_unexpected--;
+    } else {
+        opal_list_remove_item(&proc->unexpected_frags,
+                              (opal_list_item_t*)frag);
+    }
+}
+
+
+/*
+ * release the locks taken by mca_pml_ob1_recv_req_start. locked_proc is NULL
+ * for wildcard receives, which lock all the peers.
+ */
+static inline void
+recv_req_match_unlock( mca_pml_ob1_comm_t *comm,
+                       mca_pml_ob1_comm_proc_t *locked_proc,
+                       bool global )
+{
+    if (NULL == locked_proc) {
+        mca_pml_ob1_match_unlock_all(comm);
+    } else {
+        mca_pml_ob1_match_unlock_peer(comm, locked_proc, global);
+    }
+}
 
 void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
 {
@@ -1233,19 +1264,17 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
     mca_pml_ob1_comm_proc_t* proc;
     mca_pml_ob1_recv_frag_t* frag;
     mca_pml_ob1_hdr_t* hdr;
-#if MCA_PML_OB1_CUSTOM_MATCH
-    custom_match_umq_node* hold_prev;
-    custom_match_umq_node* hold_elem;
-    int hold_index;
-#else
+    mca_pml_ob1_comm_proc_t *locked_proc = NULL;
+    mca_pml_ob1_custom_match_hold_t hold;
     opal_list_t *queue;
-#endif
+    bool global = true;
 
     /* init/re-init the request */
     req->req_lock = 0;
     req->req_pipeline_depth = 0;
     req->req_bytes_received = 0;
     req->req_bytes_expected = 0;
+    req->req_unpack_time = 0;
     /* What about req_rdma_cnt ? */
     req->req_rdma_idx = 0;
     req->req_pending = false;
@@ -1253,7 +1282,12 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
 
     MCA_PML_BASE_RECV_START(&req->req_recv);
 
-    OB1_MATCHING_LOCK(&ob1_comm->matching_lock);
+    if (OMPI_ANY_SOURCE == req->req_recv.req_base.req_peer) {
+        mca_pml_ob1_match_lock_all(comm);
+    } else {
+        locked_proc = mca_pml_ob1_peer_lookup (comm, req->req_recv.req_base.req_peer);
+        global = mca_pml_ob1_match_lock_peer(ob1_comm, locked_proc, false);
+    }
     /**
      * The laps of time between the ACTIVATE event and the SEARCH_UNEX one include
      * the cost of the request lock.
@@ -1261,17 +1295,22 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
     PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_SEARCH_UNEX_Q_BEGIN,
                             &(req->req_recv.req_base), PERUSE_RECV);
 
-    /* assign sequence number */
-    req->req_recv.req_base.req_sequence = ob1_comm->recv_sequence++;
+    /* assign sequence number. it only orders the specific receives with the
+     * wildcard ones, so the atomic update needed with per-peer locks can be
+     * skipped on communicators asserting mpi_assert_no_any_source */
+    if (!ob1_comm->match_per_peer) {
+        req->req_recv.req_base.req_sequence = ob1_comm->recv_sequence++;
+    } else if (!OMPI_COMM_CHECK_ASSERT_NO_ANY_SOURCE(comm)) {
+        req->req_recv.req_base.req_sequence =
+            (uint32_t) opal_atomic_fetch_add_32((opal_atomic_int32_t *) &ob1_comm->recv_sequence, 1);
+    } else {
+        req->req_recv.req_base.req_sequence = 0;
+    }
 
     /* attempt to match posted recv */
     if(req->req_recv.req_base.req_peer == OMPI_ANY_SOURCE) {
-#if MCA_PML_OB1_CUSTOM_MATCH
-        frag = recv_req_match_wild(req, &proc, &hold_prev, &hold_elem, &hold_index);
-#else
-        frag = recv_req_match_wild(req, &proc);
+        frag = recv_req_match_wild(req, &proc, &hold);
         queue = &ob1_comm->wild_receives;
-#endif
 #if !OPAL_ENABLE_HETEROGENEOUS_SUPPORT
         /* As we are in a homogeneous environment we know that all remote
          * architectures are exactly the same as the local one. Therefore,
@@ -1284,14 +1323,10 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
         }
 #endif  /* !OPAL_ENABLE_HETEROGENEOUS_SUPPORT */
     } else {
-        proc = mca_pml_ob1_peer_lookup (comm, req->req_recv.req_base.req_peer);
+        proc = locked_proc;
         req->req_recv.req_base.req_proc = proc->ompi_proc;
-#if MCA_PML_OB1_CUSTOM_MATCH
-        frag = recv_req_match_specific_proc(req, proc, &hold_prev, &hold_elem, &hold_index);
-#else
-        frag = recv_req_match_specific_proc(req, proc);
+        frag = recv_req_match_specific_proc(req, proc, &hold);
         queue = &proc->specific_receives;
-#endif
         /* wildcard recv will be prepared on match */
         prepare_recv_req_converter(req);
     }
@@ -1302,16 +1337,21 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
         /* We didn't find any matches.  Record this irecv so we can match
            it when the message comes in. */
         if(OPAL_LIKELY(req->req_recv.req_base.req_type != MCA_PML_REQUEST_IPROBE &&
-                       req->req_recv.req_base.req_type != MCA_PML_REQUEST_IMPROBE))
-#if MCA_PML_OB1_CUSTOM_MATCH
-            custom_match_prq_append(ob1_comm->prq, req,
-                                    req->req_recv.req_base.req_tag,
-                                    req->req_recv.req_base.req_peer);
-#else
-            append_recv_req_to_queue(queue, req);
-#endif
+                       req->req_recv.req_base.req_type != MCA_PML_REQUEST_IMPROBE)) {
+            if (NULL != ob1_comm->match_engine) {
+                if (OPAL_UNLIKELY(OMPI_SUCCESS != ob1_comm->match_engine->prq_append(ob1_comm->prq, req,
+                                                                                     req->req_recv.req_base.req_tag,
+                                                                                     req->req_recv.req_base.req_peer))) {
+                    OMPI_ERROR_LOG(OMPI_ERR_OUT_OF_RESOURCE);
+                    ompi_rte_abort(-1, NULL);
+                }
+                mca_pml_ob1_comm_count_posted(ob1_comm, proc, 1);
+            } else {
+                append_recv_req_to_queue(queue, req);
+            }
+        }
         req->req_match_received = false;
-        OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+        recv_req_match_unlock(ob1_comm, locked_proc, global);
     } else {
         if(OPAL_LIKELY(!IS_PROB_REQ(req))) {
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_REQ_MATCH_UNEX,
@@ -1327,14 +1367,9 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
             PERUSE_TRACE_COMM_EVENT(PERUSE_COMM_SEARCH_UNEX_Q_END,
                                     &(req->req_recv.req_base), PERUSE_RECV);
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-            custom_match_umq_remove_hold(req->req_recv.req_base.req_comm->c_pml_comm->umq, hold_prev, hold_elem, hold_index);
-#else
-            opal_list_remove_item(&proc->unexpected_frags,
-                                  (opal_list_item_t*)frag);
-#endif
+            recv_req_remove_unexpected(ob1_comm, proc, frag, &hold);
             SPC_RECORD(OMPI_SPC_UNEXPECTED_IN_QUEUE, -1);
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            recv_req_match_unlock(ob1_comm, locked_proc, global);
 
             switch(hdr->hdr_common.hdr_type) {
             case MCA_PML_OB1_HDR_TYPE_MATCH:
@@ -1363,21 +1398,16 @@ void mca_pml_ob1_recv_req_start(mca_pml_ob1_recv_request_t *req)
                "recreated" as a receive request, and the frag will be
                restarted with this request during mrecv */
 
-#if MCA_PML_OB1_CUSTOM_MATCH
-            custom_match_umq_remove_hold(req->req_recv.req_base.req_comm->c_pml_comm->umq, hold_prev, hold_elem, hold_index);
-#else
-            opal_list_remove_item(&proc->unexpected_frags,
-                                  (opal_list_item_t*)frag);
-#endif
+            recv_req_remove_unexpected(ob1_comm, proc, frag, &hold);
             SPC_RECORD(OMPI_SPC_UNEXPECTED_IN_QUEUE, -1);
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            recv_req_match_unlock(ob1_comm, locked_proc, global);
 
             req->req_recv.req_base.req_addr = frag;
             mca_pml_ob1_recv_request_matched_probe(req, frag->btl,
                                                    frag->segments, frag->num_segments);
 
         } else {
-            OB1_MATCHING_UNLOCK(&ob1_comm->matching_lock);
+            recv_req_match_unlock(ob1_comm, locked_proc, global);
             mca_pml_ob1_recv_request_matched_probe(req, frag->btl,
                                                    frag->segments, frag->num_segments);
         }
@@ -45,6 +45,7 @@ struct mca_pml_ob1_recv_request_t {
     opal_atomic_int32_t  req_lock;
     opal_atomic_int32_t  req_pipeline_depth;
     opal_atomic_size_t   req_bytes_received;  /**< amount of data transferred into the user buffer */
+    opal_atomic_int64_t  req_unpack_time;     /**< cycles spent unpacking a large non-contiguous message */
     size_t   req_bytes_expected; /**< local size of the data as suggested by the user */
     size_t   req_rdma_offset;
     size_t   req_send_offset;
@@ -176,6 +177,10 @@ recv_request_pml_complete(mca_pml_ob1_recv_request_t *recvreq)
         }
         recvreq->req_rdma_cnt = 0;
 
+        if (0 != recvreq->req_unpack_time) {
+            mca_pml_ob1_account_convertor_time (&mca_pml_ob1.unpack_time, &mca_pml_ob1.unpack_time_max,
+                                                &mca_pml_ob1.unpack_messages, recvreq->req_unpack_time);
+        }
 
         if(true == recvreq->req_recv.req_base.req_free_called) {
             if( MPI_SUCCESS != recvreq->req_recv.req_base.req_ompi.req_status.MPI_ERROR ) {
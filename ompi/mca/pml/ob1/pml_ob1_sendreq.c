@@ -43,6 +43,30 @@
 OBJ_CLASS_INSTANCE(mca_pml_ob1_send_range_t, opal_free_list_item_t,
         NULL, NULL);
 
+/**
+ * Prepare a descriptor for the next fragment of a send request. The time
+ * spent packing the large non-contiguous messages is accounted in
+ * req_pack_time, atomically like req_unpack_time although the fragments of
+ * a send request are only prepared by the thread scheduling it.
+ */
+static inline void
+mca_pml_ob1_send_request_prepare_src (mca_pml_ob1_send_request_t *sendreq, mca_bml_base_btl_t *bml_btl,
+                                      size_t reserve, size_t *size, uint32_t flags,
+                                      mca_btl_base_descriptor_t **des)
+{
+    opal_convertor_t *convertor = &sendreq->req_send.req_base.req_convertor;
+    opal_timer_t start;
+
+    if (!opal_convertor_need_buffers (convertor)) {
+        mca_bml_base_prepare_src (bml_btl, convertor, MCA_BTL_NO_ORDER, reserve, size, flags, des);
+        return;
+    }
+
+    start = opal_timer_base_get_cycles ();
+    mca_bml_base_prepare_src (bml_btl, convertor, MCA_BTL_NO_ORDER, reserve, size, flags, des);
+    OPAL_THREAD_ADD_FETCH64(&sendreq->req_pack_time, (int64_t) (opal_timer_base_get_cycles () - start));
+}
+
 void mca_pml_ob1_send_request_process_pending(mca_bml_base_btl_t *bml_btl)
 {
     int rc, i, s = opal_list_get_size(&mca_pml_ob1.send_pending);
@@ -138,6 +162,7 @@ static void mca_pml_ob1_send_request_construct(mca_pml_ob1_send_request_t* req)
     req->req_rdma_cnt = 0;
     req->req_throttle_sends = false;
     req->rdma_frag = NULL;
+    req->req_pack_ahead_des = NULL;
     OBJ_CONSTRUCT(&req->req_send_ranges, opal_list_t);
     OBJ_CONSTRUCT(&req->req_send_range_lock, opal_mutex_t);
 }
@@ -789,14 +814,12 @@ int mca_pml_ob1_send_request_start_rndv( mca_pml_ob1_send_request_t* sendreq,
                             sendreq->req_send.req_base.req_count,
                             sendreq->req_send.req_base.req_datatype);
         );
-        mca_bml_base_prepare_src( bml_btl,
-                                  &sendreq->req_send.req_base.req_convertor,
-                                  MCA_BTL_NO_ORDER,
-                                  sizeof(mca_pml_ob1_rendezvous_hdr_t),
-                                  &size,
-                                  MCA_BTL_DES_FLAGS_PRIORITY | MCA_BTL_DES_FLAGS_BTL_OWNERSHIP |
-                                  MCA_BTL_DES_FLAGS_SIGNAL,
-                                  &des );
+        mca_pml_ob1_send_request_prepare_src( sendreq, bml_btl,
+                                              sizeof(mca_pml_ob1_rendezvous_hdr_t),
+                                              &size,
+                                              MCA_BTL_DES_FLAGS_PRIORITY | MCA_BTL_DES_FLAGS_BTL_OWNERSHIP |
+                                              MCA_BTL_DES_FLAGS_SIGNAL,
+                                              &des );
         MEMCHECKER(
             memchecker_call(&opal_memchecker_base_mem_noaccess,
                             sendreq->req_send.req_base.req_addr,
@@ -922,6 +945,12 @@ get_next_send_range(mca_pml_ob1_send_request_t* sendreq,
  *  the rdma threshold is the end of the message. Otherwise, schedule
  *  fragments up to the threshold to overlap initial registration/setup
  *  costs of the rdma. Only one thread can be inside this function.
+ *
+ *  With pml_ob1_pack_pipeline, once the pipeline of a throttled
+ *  non-contiguous send is full, the next fragment is packed right away
+ *  and kept in req_pack_ahead_des, so packing fragment N+1 overlaps the
+ *  transmission of fragment N and the fragment is sent as soon as a
+ *  fragment of the pipeline completes.
  */
 
 int
@@ -930,6 +959,14 @@ mca_pml_ob1_send_request_schedule_once(mca_pml_ob1_send_request_t* sendreq)
     size_t prev_bytes_remaining = 0;
     mca_pml_ob1_send_range_t *range;
     int num_fail = 0;
+    bool pack_ahead = mca_pml_ob1.pack_pipeline &&
+        opal_convertor_need_buffers(&sendreq->req_send.req_base.req_convertor);
+
+#if OPAL_CUDA_SUPPORT
+    if (sendreq->req_send.req_base.req_convertor.flags & CONVERTOR_CUDA) {
+        pack_ahead = false;
+    }
+#endif /* OPAL_CUDA_SUPPORT */
 
     /* check pipeline_depth here before attempting to get any locks */
     if(true == sendreq->req_throttle_sends &&
@@ -939,15 +976,29 @@ mca_pml_ob1_send_request_schedule_once(mca_pml_ob1_send_request_t* sendreq)
     range = get_send_range(sendreq);
 
     while(range && (false == sendreq->req_throttle_sends ||
-          sendreq->req_pipeline_depth < mca_pml_ob1.send_pipeline_depth)) {
+          sendreq->req_pipeline_depth < mca_pml_ob1.send_pipeline_depth ||
+          (pack_ahead && NULL == sendreq->req_pack_ahead_des))) {
         mca_pml_ob1_frag_hdr_t* hdr;
         mca_btl_base_descriptor_t* des;
         int rc, btl_idx;
         size_t size, offset, data_remaining = 0;
         mca_bml_base_btl_t* bml_btl;
+        bool pipeline_full;
 
         assert(range->range_send_length != 0);
 
+        if (NULL != sendreq->req_pack_ahead_des) {
+            /* the fragment was packed while the pipeline was full */
+            des = sendreq->req_pack_ahead_des;
+            bml_btl = sendreq->req_pack_ahead_btl;
+            btl_idx = sendreq->req_pack_ahead_idx;
+            size = sendreq->req_pack_ahead_size;
+            sendreq->req_pack_ahead_des = NULL;
+            goto send_frag;
+        }
+        pipeline_full = (true == sendreq->req_throttle_sends &&
+                         sendreq->req_pipeline_depth >= mca_pml_ob1.send_pipeline_depth);
+
         if(prev_bytes_remaining == range->range_send_length)
             num_fail++;
         else
@@ -1009,10 +1060,9 @@ cannot_pack:
                             sendreq->req_send.req_base.req_count,
                             sendreq->req_send.req_base.req_datatype);
         );
-        mca_bml_base_prepare_src(bml_btl, &sendreq->req_send.req_base.req_convertor,
-                                 MCA_BTL_NO_ORDER, sizeof(mca_pml_ob1_frag_hdr_t),
-                                 &size, MCA_BTL_DES_FLAGS_BTL_OWNERSHIP | MCA_BTL_DES_SEND_ALWAYS_CALLBACK |
-                                 MCA_BTL_DES_FLAGS_SIGNAL, &des);
+        mca_pml_ob1_send_request_prepare_src(sendreq, bml_btl, sizeof(mca_pml_ob1_frag_hdr_t),
+                                             &size, MCA_BTL_DES_FLAGS_BTL_OWNERSHIP | MCA_BTL_DES_SEND_ALWAYS_CALLBACK |
+                                             MCA_BTL_DES_FLAGS_SIGNAL, &des);
         MEMCHECKER(
             memchecker_call(&opal_memchecker_base_mem_noaccess,
                             sendreq->req_send.req_base.req_addr,
@@ -1028,6 +1078,10 @@ cannot_pack:
                 range->range_btls[btl_idx].length -= data_remaining;
                 goto cannot_pack;
             }
+            if (pipeline_full) {
+                /* out of descriptors, retry when a fragment completes */
+                break;
+            }
             continue;
         }
 
@@ -1073,6 +1127,15 @@ cannot_pack:
         }
 #endif /* OPAL_CUDA_SUPPORT */
 
+        if (pipeline_full) {
+            sendreq->req_pack_ahead_des = des;
+            sendreq->req_pack_ahead_btl = bml_btl;
+            sendreq->req_pack_ahead_idx = btl_idx;
+            sendreq->req_pack_ahead_size = size;
+            break;
+        }
+
+    send_frag:
         /* initiate send - note that this may complete before the call returns */
         rc = mca_bml_base_send(bml_btl, des, MCA_PML_OB1_HDR_TYPE_FRAG);
         if( OPAL_LIKELY(rc >= 0) ) {
@@ -57,6 +57,13 @@ struct mca_pml_ob1_send_request_t {
     opal_mutex_t req_send_range_lock;
     opal_list_t req_send_ranges;
     mca_pml_ob1_rdma_frag_t *rdma_frag;
+    opal_atomic_int64_t req_pack_time;  /**< cycles spent packing a large non-contiguous message */
+    /* fragment packed by the pack pipeline (pml_ob1_pack_pipeline) while
+     * the pipeline was full, sent as soon as a fragment completes */
+    mca_btl_base_descriptor_t *req_pack_ahead_des;
+    mca_bml_base_btl_t *req_pack_ahead_btl;
+    size_t   req_pack_ahead_size;
+    int      req_pack_ahead_idx;
     /** The size of this array is set from mca_pml_ob1.max_rdma_per_request */
     mca_pml_ob1_com_btl_t req_rdma[];
 };
@@ -260,6 +267,12 @@ send_request_pml_complete(mca_pml_ob1_send_request_t *sendreq)
                                      &(sendreq->req_send.req_base), PERUSE_SEND);
         }
 
+        assert(NULL == sendreq->req_pack_ahead_des);
+        if (0 != sendreq->req_pack_time) {
+            mca_pml_ob1_account_convertor_time (&mca_pml_ob1.pack_time, &mca_pml_ob1.pack_time_max,
+                                                &mca_pml_ob1.pack_messages, sendreq->req_pack_time);
+        }
+
         /* return mpool resources */
         mca_pml_ob1_free_rdma_resources(sendreq);
 
@@ -463,6 +476,7 @@ mca_pml_ob1_send_request_start_seq (mca_pml_ob1_send_request_t* sendreq, mca_bml
     sendreq->req_lock = 0;
     sendreq->req_pipeline_depth = 0;
     sendreq->req_bytes_delivered = 0;
+    sendreq->req_pack_time = 0;
     sendreq->req_pending = MCA_PML_OB1_SEND_PENDING_NONE;
     sendreq->req_send.req_base.req_sequence = seqn;
 
@@ -499,13 +513,16 @@ mca_pml_ob1_send_request_start( mca_pml_ob1_send_request_t* sendreq )
     mca_bml_base_endpoint_t *endpoint = mca_bml_base_get_endpoint (sendreq->req_send.req_base.req_proc);
     ompi_communicator_t *comm = sendreq->req_send.req_base.req_comm;
     mca_pml_ob1_comm_proc_t *ob1_proc = mca_pml_ob1_peer_lookup (comm, sendreq->req_send.req_base.req_peer);
-    int32_t seqn;
+    int32_t seqn = 0;
 
     if (OPAL_UNLIKELY(NULL == endpoint)) {
         return OMPI_ERR_UNREACH;
     }
 
-    seqn = OPAL_THREAD_ADD_FETCH32(&ob1_proc->send_sequence, 1);
+    /* the receiver does not check the sequence if overtaking is allowed */
+    if (!OMPI_COMM_CHECK_ASSERT_ALLOW_OVERTAKE(comm)) {
+        seqn = OPAL_THREAD_ADD_FETCH32(&ob1_proc->send_sequence, 1);
+    }
 
     return mca_pml_ob1_send_request_start_seq (sendreq, endpoint, seqn);
 }
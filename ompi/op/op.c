@@ -101,6 +101,12 @@ ompi_predefined_op_t *ompi_mpi_op_no_op_addr = &ompi_mpi_op_no_op;
  */
 int ompi_op_ddt_map[OMPI_DATATYPE_MAX_PREDEFINED] = {0};
 
+/*
+ * Smallest reduction handed to the helper threads, set from the
+ * parameters of the op base in ompi_op_init
+ */
+size_t ompi_op_reduce_thread_threshold = SIZE_MAX;
+
 /* Get the c complex operator associated with a fortran complex type */
 #define FORTRAN_COMPLEX_OP_TYPE_X(type) OMPI_OP_BASE_TYPE_ ## type
 /* Preprocessor hack to ensure type gets expanded correctly */
@@ -119,6 +125,9 @@ int ompi_op_init(void)
 {
     int i;
 
+    ompi_op_reduce_thread_threshold = (0 < ompi_op_base_reduce_threads) ?
+        ompi_op_base_reduce_thread_threshold : SIZE_MAX;
+
   /* initialize ompi_op_f_to_c_table */
 
     ompi_op_f_to_c_table = OBJ_NEW(opal_pointer_array_t);
@@ -383,6 +392,18 @@ error:
 }
 
 
+int ompi_op_threaded_reduce(ompi_op_base_handler_fn_t fn,
+                            ompi_op_base_3buff_handler_fn_t fn_3buff,
+                            struct ompi_op_base_module_1_0_0_t *module,
+                            const void *source1, const void *source2,
+                            void *target, int count,
+                            struct ompi_datatype_t *dtype)
+{
+    return ompi_op_base_threaded_reduce(fn, fn_3buff, module, source1, source2,
+                                        target, count, dtype);
+}
+
+
 /*
  * See lengthy comment in mpi/cxx/intercepts.cc for how the C++ MPI::Op
  * callbacks work.
@@ -475,6 +496,11 @@ static void ompi_op_construct(ompi_op_t *new_op)
         new_op->o_func.intrinsic.modules[i] = NULL;
         new_op->o_3buff_intrinsic.fns[i] = NULL;
         new_op->o_3buff_intrinsic.modules[i] = NULL;
+        new_op->o_short_intrinsic.fns[i] = NULL;
+        new_op->o_short_intrinsic.modules[i] = NULL;
+        new_op->o_3buff_short_intrinsic.fns[i] = NULL;
+        new_op->o_3buff_short_intrinsic.modules[i] = NULL;
+        new_op->o_short_limit[i] = 0;
     }
 }
 
@@ -506,5 +532,16 @@ static void ompi_op_destruct(ompi_op_t *op)
             OBJ_RELEASE(op->o_3buff_intrinsic.modules[i]);
             op->o_3buff_intrinsic.modules[i] = NULL;
         }
+        op->o_short_limit[i] = 0;
+        op->o_short_intrinsic.fns[i] = NULL;
+        if( NULL != op->o_short_intrinsic.modules[i] ) {
+            OBJ_RELEASE(op->o_short_intrinsic.modules[i]);
+            op->o_short_intrinsic.modules[i] = NULL;
+        }
+        op->o_3buff_short_intrinsic.fns[i] = NULL;
+        if( NULL != op->o_3buff_short_intrinsic.modules[i] ) {
+            OBJ_RELEASE(op->o_3buff_short_intrinsic.modules[i]);
+            op->o_3buff_short_intrinsic.modules[i] = NULL;
+        }
     }
 }
@@ -192,6 +192,15 @@ struct ompi_op_t {
     /** 3-buffer functions, which is only for intrinsic ops.  No need
         for the C/C++/Fortran user-defined functions. */
     ompi_op_base_op_3buff_fns_t o_3buff_intrinsic;
+
+    /** Functions used instead of the ones above for the reductions
+        of less than o_short_limit bytes, only for intrinsic ops.  The
+        limits are 0 unless the selection table of the op base (see
+        op_base_select_table) has a short size class for the
+        datatype. */
+    ompi_op_base_op_fns_t o_short_intrinsic;
+    ompi_op_base_op_3buff_fns_t o_3buff_short_intrinsic;
+    size_t o_short_limit[OMPI_OP_BASE_TYPE_MAX];
 };
 
 /**
@@ -245,6 +254,13 @@ typedef struct ompi_predefined_op_t ompi_predefined_op_t;
  */
 OMPI_DECLSPEC extern int ompi_op_ddt_map[OMPI_DATATYPE_MAX_PREDEFINED];
 
+/**
+ * Size in bytes from which the reductions of intrinsic operations are
+ * split across the helper threads of the op framework, SIZE_MAX when
+ * there are no helper threads (op_base_reduce_threads = 0).
+ */
+OMPI_DECLSPEC extern size_t ompi_op_reduce_thread_threshold;
+
 /**
  * Global variable for MPI_OP_NULL (_addr flavor is for F03 bindings)
  */
@@ -362,6 +378,30 @@ int ompi_op_init(void);
  */
 int ompi_op_finalize(void);
 
+/**
+ * Reduce count elements of the predefined datatype dtype with the
+ * helper threads of the op framework.
+ *
+ * @param fn Two buffers function (used if source2 is NULL)
+ * @param fn_3buff Three buffers function
+ * @param module Module of the function
+ * @param source1 First source buffer
+ * @param source2 Second source buffer, NULL for a two buffers reduction
+ * @param target Target buffer
+ * @param count Number of elements
+ * @param dtype Datatype of the elements
+ *
+ * @returns OMPI_SUCCESS if the reduction is complete, an error code
+ * if nothing has been done and the caller has to reduce the buffers
+ * itself.
+ */
+OMPI_DECLSPEC int ompi_op_threaded_reduce(ompi_op_base_handler_fn_t fn,
+                                          ompi_op_base_3buff_handler_fn_t fn_3buff,
+                                          struct ompi_op_base_module_1_0_0_t *module,
+                                          const void *source1, const void *source2,
+                                          void *target, int count,
+                                          struct ompi_datatype_t *dtype);
+
 /**
  * Create a ompi_op_t with a user-defined callback (vs. creating an
  * intrinsic ompi_op_t).
@@ -582,6 +622,20 @@ static inline void ompi_op_reduce(ompi_op_t * op, void *source,
         } else {
             dtype_id = ompi_op_ddt_map[dtype->id];
         }
+        /* Short reductions may have their own function */
+        if (OPAL_UNLIKELY((size_t)count * dtype->super.size < op->o_short_limit[dtype_id])) {
+            op->o_short_intrinsic.fns[dtype_id](source, target,
+                                                &count, &dtype,
+                                                op->o_short_intrinsic.modules[dtype_id]);
+            return;
+        }
+        /* Very large reductions may be split across helper threads */
+        if (OPAL_UNLIKELY((size_t)count * dtype->super.size >= ompi_op_reduce_thread_threshold) &&
+            OMPI_SUCCESS == ompi_op_threaded_reduce(op->o_func.intrinsic.fns[dtype_id], NULL,
+                                                    op->o_func.intrinsic.modules[dtype_id],
+                                                    source, NULL, target, count, dtype)) {
+            return;
+        }
         op->o_func.intrinsic.fns[dtype_id](source, target,
                                            &count, &dtype,
                                            op->o_func.intrinsic.modules[dtype_id]);
@@ -651,10 +705,22 @@ static inline void ompi_3buff_op_reduce(ompi_op_t * op, void *source1,
     tgt = target;
 
     if (OPAL_LIKELY(ompi_op_is_intrinsic (op))) {
-        op->o_3buff_intrinsic.fns[ompi_op_ddt_map[dtype->id]](src1, src2,
-                                                              tgt, &count,
-                                                              &dtype,
-                                                              op->o_3buff_intrinsic.modules[ompi_op_ddt_map[dtype->id]]);
+        int dtype_id = ompi_op_ddt_map[dtype->id];
+        if (OPAL_UNLIKELY((size_t)count * dtype->super.size < op->o_short_limit[dtype_id])) {
+            op->o_3buff_short_intrinsic.fns[dtype_id](src1, src2, tgt, &count, &dtype,
+                                                      op->o_3buff_short_intrinsic.modules[dtype_id]);
+            return;
+        }
+        if (OPAL_UNLIKELY((size_t)count * dtype->super.size >= ompi_op_reduce_thread_threshold) &&
+            OMPI_SUCCESS == ompi_op_threaded_reduce(NULL, op->o_3buff_intrinsic.fns[dtype_id],
+                                                    op->o_3buff_intrinsic.modules[dtype_id],
+                                                    src1, src2, tgt, count, dtype)) {
+            return;
+        }
+        op->o_3buff_intrinsic.fns[dtype_id](src1, src2,
+                                            tgt, &count,
+                                            &dtype,
+                                            op->o_3buff_intrinsic.modules[dtype_id]);
     } else {
         ompi_3buff_op_user (op, src1, src2, tgt, count, dtype);
     }
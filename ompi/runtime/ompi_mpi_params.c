@@ -350,7 +350,8 @@ int ompi_mpi_register_params(void)
                                  MCA_BASE_VAR_SCOPE_READONLY,
                                  &ompi_mpi_spc_dump_enabled);
 
-    return OMPI_SUCCESS;
+    /* The ddt engine has a few parameters */
+    return ompi_datatype_register_params();
 }
 
 int ompi_show_all_mca_params(int32_t rank, int requested, char *nodename) {
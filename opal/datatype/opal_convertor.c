@@ -38,6 +38,7 @@
 #include "opal/datatype/opal_datatype_checksum.h"
 #include "opal/datatype/opal_datatype_prototypes.h"
 #include "opal/datatype/opal_convertor_internal.h"
+#include "opal/datatype/opal_datatype_strided.h"
 #if OPAL_CUDA_SUPPORT
 #include "opal/datatype/opal_datatype_cuda.h"
 #define MEMCPY_CUDA( DST, SRC, BLENGTH, CONVERTOR ) \
@@ -424,6 +425,11 @@ int32_t opal_convertor_set_position_nocheck( opal_convertor_t* convertor,
     if( OPAL_LIKELY(convertor->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS) ) {
         rc = opal_convertor_create_stack_with_pos_contig( convertor, (*position),
                                                           opal_datatype_local_sizes );
+    } else if( opal_convertor_is_strided(convertor) ) {
+        /* The strided functions only depend on the position */
+        convertor->bConverted = *position;
+        convertor->partial_length = 0;
+        rc = OPAL_SUCCESS;
     } else {
         if( (0 == (*position)) || ((*position) < convertor->bConverted) ) {
             rc = opal_convertor_create_stack_at_begining( convertor, opal_datatype_local_sizes );
@@ -597,6 +603,9 @@ int32_t opal_convertor_prepare_for_recv( opal_convertor_t* convertor,
         } else {
             if( convertor->pDesc->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS ) {
                 convertor->fAdvance = opal_unpack_homogeneous_contig;
+            } else if( (NULL != convertor->pDesc->strided) && opal_ddt_strided_pack &&
+                       !(convertor->flags & CONVERTOR_CUDA) ) {
+                convertor->fAdvance = opal_unpack_strided;
             } else {
                 convertor->fAdvance = opal_generic_simple_unpack;
             }
@@ -645,6 +654,9 @@ int32_t opal_convertor_prepare_for_send( opal_convertor_t* convertor,
                     convertor->fAdvance = opal_pack_homogeneous_contig;
                 else
                     convertor->fAdvance = opal_pack_homogeneous_contig_with_gaps;
+            } else if( (NULL != datatype->strided) && opal_ddt_strided_pack &&
+                       !(convertor->flags & CONVERTOR_CUDA) ) {
+                convertor->fAdvance = opal_pack_strided;
             } else {
                 convertor->fAdvance = opal_generic_simple_pack;
             }
@@ -20,6 +20,7 @@
 
 #include "opal/datatype/opal_convertor_internal.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_strided.h"
 #include "opal_stdint.h"
 
 #if OPAL_ENABLE_DEBUG
@@ -94,6 +95,10 @@ opal_convertor_raw( opal_convertor_t* pConvertor,
         *iov_count = 1;
         return 1;  /* we're done */
     }
+    if( opal_convertor_is_strided(pConvertor) ) {
+        /* The stack is not maintained by the strided functions */
+        return opal_datatype_strided_raw( pConvertor, iov, iov_count, length );
+    }
 
     DO_DEBUG( opal_output( 0, "opal_convertor_raw( %p, {%p, %" PRIu32 "}, %"PRIsize_t " )\n", (void*)pConvertor,
                            (void*)iov, *iov_count, *length ); );
@@ -30,6 +30,7 @@
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype_internal.h"
 #include "opal/datatype/opal_datatype_checksum.h"
+#include "opal/datatype/opal_datatype_memcpy.h"
 #include "opal/datatype/opal_convertor_internal.h"
 
 
@@ -52,19 +53,15 @@ opal_dt_swap_bytes(void *to_p, const void *from_p, const size_t size, size_t cou
     uint8_t *to = (uint8_t*) to_p;
     uint8_t *from = (uint8_t*) from_p;
 
-    /* Do the first element */
+    /* The arrays of elements go through the byte-swapping copy of the
+     * memcpy framework, vectorized when the processor allows it */
+    if (count > 1) {
+        opal_memcpy_swap(to_p, from_p, size, count);
+        return;
+    }
     for (i = 0 ; i < size ; i++, back_i--) {
         to[back_i] = from[i];
     }
-    /* Do all the others if any */
-    while(count > 1) {
-        to += size;
-        from += size;
-        count--;
-        for (i = 0, back_i = size - 1 ; i < size ; i++, back_i--) {
-            to[back_i] = from[i];
-        }
-    }
 }
 
 #ifdef HAVE_IEEE754_H
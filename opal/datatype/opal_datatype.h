@@ -125,6 +125,7 @@ struct opal_datatype_t {
     dt_type_desc_t     desc;     /**< the data description */
     dt_type_desc_t     opt_desc; /**< short description of the data used when conversion is useless
                                       or in the send case (without conversion) */
+    /* --- cacheline 3 boundary (192 bytes) --- */
 
     size_t             *ptypes;  /**< array of basic predefined types that facilitate the computing
                                       of the remote size in heterogeneous environments. The length of the
@@ -132,10 +133,14 @@ struct opal_datatype_t {
                                       all language interfaces (because Fortran is not known at the OPAL
                                       layer). This field should never be initialized in homogeneous
                                       environments */
-    /* --- cacheline 5 boundary (320 bytes) was 32-36 bytes ago --- */
-
-    /* size: 352, cachelines: 6, members: 15 */
-    /* last cacheline: 28-32 bytes */
+    struct opal_datatype_strided_t *strided; /**< regular layout used by the specialized pack and
+                                                  unpack functions, NULL if the datatype has none
+                                                  (see opal_datatype_strided.h) */
+
+    /* size: 208, cachelines: 4, members: 17 */
+    /* last cacheline: 16 bytes */
+    /* (LP64 without debug, OPAL_MAX_OBJECT_NAME of 64: name spans the
+       cacheline 2 boundary, ptypes and strided share the last one) */
 };
 
 typedef struct opal_datatype_t opal_datatype_t;
@@ -187,6 +192,12 @@ OPAL_DECLSPEC int32_t opal_datatype_init( void );
 OPAL_DECLSPEC opal_datatype_t* opal_datatype_create( int32_t expectedSize );
 OPAL_DECLSPEC int32_t opal_datatype_create_desc( opal_datatype_t * datatype, int32_t expectedSize );
 OPAL_DECLSPEC int32_t opal_datatype_commit( opal_datatype_t * pData );
+/**
+ * Commit a datatype with a copy of the optimized description (and
+ * specialized pack functions) of model, a committed datatype with the
+ * same description. This skips the optimization of the description.
+ */
+OPAL_DECLSPEC int32_t opal_datatype_commit_as( opal_datatype_t * pData, const opal_datatype_t * model );
 OPAL_DECLSPEC int32_t opal_datatype_destroy( opal_datatype_t** );
 OPAL_DECLSPEC int32_t opal_datatype_is_monotonic( opal_datatype_t* type);
 
@@ -25,6 +25,7 @@
 #include "opal/constants.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_strided.h"
 
 /*
  * As the new type has the same commit state as the old one, I have to copy the fake
@@ -45,6 +46,13 @@ int32_t opal_datatype_clone( const opal_datatype_t * src_type, opal_datatype_t *
     dest_type->flags &= (~OPAL_DATATYPE_FLAG_PREDEFINED);
     dest_type->ptypes = NULL;
     dest_type->desc.desc = temp;
+    dest_type->strided = NULL;
+    if( NULL != src_type->strided ) {
+        dest_type->strided = (opal_datatype_strided_t*)malloc( sizeof(opal_datatype_strided_t) );
+        if( NULL != dest_type->strided ) {
+            *dest_type->strided = *src_type->strided;
+        }
+    }
 
     /**
      * Allow duplication of MPI_UB and MPI_LB.
@@ -27,6 +27,7 @@
 #include "opal/constants.h"
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_strided.h"
 #include "limits.h"
 #include "opal/prefetch.h"
 
@@ -54,6 +55,7 @@ static void opal_datatype_construct( opal_datatype_t* pData )
     pData->opt_desc.used      = 0;
 
     pData->ptypes             = NULL;
+    pData->strided            = NULL;
     pData->loops              = 0;
 }
 
@@ -84,6 +86,9 @@ static void opal_datatype_destruct( opal_datatype_t* datatype )
         datatype->ptypes = NULL;
     }
 
+    free( datatype->strided );
+    datatype->strided = NULL;
+
     /* make sure the name is set to empty */
     datatype->name[0] = '\0';
 }
@@ -25,10 +25,12 @@
 
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "opal/datatype/opal_datatype.h"
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_strided.h"
 
 static int32_t
 opal_datatype_optimize_short( opal_datatype_t* pData,
@@ -258,24 +260,29 @@ opal_datatype_optimize_short( opal_datatype_t* pData,
     return OPAL_SUCCESS;
 }
 
-int32_t opal_datatype_commit( opal_datatype_t * pData )
+/*
+ * Mark the datatype as committed and add the fake OPAL_DATATYPE_END_LOOP
+ * at the end of its description. Return false if it was already
+ * committed.
+ */
+static bool opal_datatype_commit_desc( opal_datatype_t* pData, ptrdiff_t* first_elem_disp )
 {
     ddt_endloop_desc_t* pLast = &(pData->desc.desc[pData->desc.used].end_loop);
-    ptrdiff_t first_elem_disp = 0;
 
-    if( pData->flags & OPAL_DATATYPE_FLAG_COMMITTED ) return OPAL_SUCCESS;
+    if( pData->flags & OPAL_DATATYPE_FLAG_COMMITTED ) return false;
     pData->flags |= OPAL_DATATYPE_FLAG_COMMITTED;
 
     /* We have to compute the displacement of the first non loop item in the
      * description.
      */
+    *first_elem_disp = 0;
     if( 0 != pData->size ) {
         int index;
         dt_elem_desc_t* pElem = pData->desc.desc;
 
         index = GET_FIRST_NON_LOOP( pElem );
         assert( pElem[index].elem.common.flags & OPAL_DATATYPE_FLAG_DATA );
-        first_elem_disp = pElem[index].elem.disp;
+        *first_elem_disp = pElem[index].elem.disp;
     }
 
     /* let's add a fake element at the end just to avoid useless comparaisons
@@ -284,7 +291,7 @@ int32_t opal_datatype_commit( opal_datatype_t * pData )
     pLast->common.type     = OPAL_DATATYPE_END_LOOP;
     pLast->common.flags    = 0;
     pLast->items           = pData->desc.used;
-    pLast->first_elem_disp = first_elem_disp;
+    pLast->first_elem_disp = *first_elem_disp;
     pLast->size            = pData->size;
 
     /* If there is no datatype description how can we have an optimized description ? */
@@ -292,8 +299,17 @@ int32_t opal_datatype_commit( opal_datatype_t * pData )
         pData->opt_desc.length = 0;
         pData->opt_desc.desc   = NULL;
         pData->opt_desc.used   = 0;
-        return OPAL_SUCCESS;
+        return false;
     }
+    return true;
+}
+
+int32_t opal_datatype_commit( opal_datatype_t * pData )
+{
+    ddt_endloop_desc_t* pLast;
+    ptrdiff_t first_elem_disp;
+
+    if( !opal_datatype_commit_desc( pData, &first_elem_disp ) ) return OPAL_SUCCESS;
 
     /* If the data is contiguous is useless to generate an optimized version. */
     /*if( pData->size == (pData->true_ub - pData->true_lb) ) return OPAL_SUCCESS; */
@@ -309,6 +325,36 @@ int32_t opal_datatype_commit( opal_datatype_t * pData )
         pLast->items           = pData->opt_desc.used;
         pLast->first_elem_disp = first_elem_disp;
         pLast->size            = pData->size;
+
+        /* Regular layouts get specialized pack and unpack functions */
+        (void)opal_datatype_strided_commit( pData );
+    }
+    return OPAL_SUCCESS;
+}
+
+int32_t opal_datatype_commit_as( opal_datatype_t * pData, const opal_datatype_t * model )
+{
+    ptrdiff_t first_elem_disp;
+    size_t length;
+
+    if( !opal_datatype_commit_desc( pData, &first_elem_disp ) ) return OPAL_SUCCESS;
+
+    /* The optimized description, with its fake OPAL_DATATYPE_END_LOOP */
+    length = model->opt_desc.used + 1;
+    pData->opt_desc.desc = (dt_elem_desc_t*)malloc( sizeof(dt_elem_desc_t) * length );
+    if( NULL == pData->opt_desc.desc ) {
+        pData->flags &= ~OPAL_DATATYPE_FLAG_COMMITTED;
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    memcpy( pData->opt_desc.desc, model->opt_desc.desc, sizeof(dt_elem_desc_t) * length );
+    pData->opt_desc.length = length;
+    pData->opt_desc.used   = model->opt_desc.used;
+
+    if( NULL != model->strided ) {
+        pData->strided = (opal_datatype_strided_t*)malloc( sizeof(opal_datatype_strided_t) );
+        if( NULL != pData->strided ) {
+            *pData->strided = *model->strided;
+        }
     }
     return OPAL_SUCCESS;
 }
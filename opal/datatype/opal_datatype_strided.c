@@ -0,0 +1,357 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Specialized pack/unpack for the datatypes with a regular strided
+ * layout (see opal_datatype_strided_t).  The layout is recognized once
+ * at commit time, and the convertors then walk the blocks with a few
+ * nested counters instead of interpreting the description stack.  The
+ * block copies are generated for the most common block lengths so the
+ * compiler can inline them (hence plain memcpy rather than MEMCPY).
+ */
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/datatype/opal_convertor_internal.h"
+#include "opal/datatype/opal_datatype_internal.h"
+#include "opal/datatype/opal_datatype_memcpy.h"
+#include "opal/datatype/opal_datatype_strided.h"
+
+bool opal_ddt_strided_pack = true;
+
+#define OPAL_DATATYPE_STRIDED_FUNCTIONS(SUFFIX, BLOCK_LEN)                         \
+static void opal_datatype_strided_pack_##SUFFIX( unsigned char* packed,            \
+                                                 unsigned char* user,              \
+                                                 size_t nblocks, ptrdiff_t stride, \
+                                                 size_t block_len )                \
+{                                                                                  \
+    for( ; nblocks > 0; nblocks-- ) {                                              \
+        memcpy( packed, user, (BLOCK_LEN) );                                       \
+        packed += (BLOCK_LEN);                                                     \
+        user   += stride;                                                          \
+    }                                                                              \
+}                                                                                  \
+static void opal_datatype_strided_unpack_##SUFFIX( unsigned char* packed,          \
+                                                   unsigned char* user,            \
+                                                   size_t nblocks, ptrdiff_t stride, \
+                                                   size_t block_len )              \
+{                                                                                  \
+    for( ; nblocks > 0; nblocks-- ) {                                              \
+        memcpy( user, packed, (BLOCK_LEN) );                                       \
+        packed += (BLOCK_LEN);                                                     \
+        user   += stride;                                                          \
+    }                                                                              \
+}
+
+OPAL_DATATYPE_STRIDED_FUNCTIONS(4, 4)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(8, 8)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(12, 12)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(16, 16)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(24, 24)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(32, 32)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(64, 64)
+OPAL_DATATYPE_STRIDED_FUNCTIONS(any, block_len)
+
+static const struct {
+    size_t block_len;
+    opal_datatype_strided_fn_t pack;
+    opal_datatype_strided_fn_t unpack;
+} opal_datatype_strided_functions[] = {
+    { 4, opal_datatype_strided_pack_4, opal_datatype_strided_unpack_4 },
+    { 8, opal_datatype_strided_pack_8, opal_datatype_strided_unpack_8 },
+    { 12, opal_datatype_strided_pack_12, opal_datatype_strided_unpack_12 },
+    { 16, opal_datatype_strided_pack_16, opal_datatype_strided_unpack_16 },
+    { 24, opal_datatype_strided_pack_24, opal_datatype_strided_unpack_24 },
+    { 32, opal_datatype_strided_pack_32, opal_datatype_strided_unpack_32 },
+    { 64, opal_datatype_strided_pack_64, opal_datatype_strided_unpack_64 },
+    { 0, opal_datatype_strided_pack_any, opal_datatype_strided_unpack_any }
+};
+
+int32_t opal_datatype_strided_commit( opal_datatype_t* pData )
+{
+    dt_elem_desc_t* desc = pData->opt_desc.desc;
+    uint32_t used = pData->opt_desc.used, nloops, i, k;
+    opal_datatype_strided_t layout;
+    ddt_elem_desc_t* elem;
+    size_t total;
+
+    if( (pData->flags & OPAL_DATATYPE_FLAG_CONTIGUOUS) || (0 == pData->size) ||
+        (NULL != pData->strided) || (0 == (used & 1)) ) {
+        return OPAL_SUCCESS;
+    }
+
+    /* Only the blocks of a single basic element inside at most
+     * OPAL_DATATYPE_STRIDED_MAX_DIMS - 1 perfectly nested loops */
+    nloops = used / 2;
+    if( nloops >= OPAL_DATATYPE_STRIDED_MAX_DIMS ) {
+        return OPAL_SUCCESS;
+    }
+    for( i = 0; i < nloops; i++ ) {
+        if( (OPAL_DATATYPE_LOOP != desc[i].elem.common.type) ||
+            (OPAL_DATATYPE_END_LOOP != desc[used - 1 - i].elem.common.type) ) {
+            return OPAL_SUCCESS;
+        }
+    }
+    elem = &desc[nloops].elem;
+    if( !(elem->common.flags & OPAL_DATATYPE_FLAG_DATA) ||
+        (elem->common.type >= OPAL_DATATYPE_MAX_PREDEFINED) ) {
+        return OPAL_SUCCESS;
+    }
+
+    layout.block_len = elem->blocklen * opal_datatype_basicDatatypes[elem->common.type]->size;
+    layout.disp = elem->disp;
+    layout.ndims = 0;
+    layout.count[layout.ndims] = elem->count;
+    layout.stride[layout.ndims++] = elem->extent;
+    for( i = nloops; i > 0; i-- ) {
+        layout.count[layout.ndims] = desc[i - 1].loop.loops;
+        layout.stride[layout.ndims++] = desc[i - 1].loop.extent;
+    }
+
+    /* Drop the loops with a single iteration, merge the loops whose
+     * iterations are contiguous into the blocks, and the loops
+     * continuing each other */
+    for( i = 0; i < layout.ndims; ) {
+        if( 1 == layout.count[i] ) {
+            for( k = i + 1; k < layout.ndims; k++ ) {
+                layout.count[k - 1] = layout.count[k];
+                layout.stride[k - 1] = layout.stride[k];
+            }
+            layout.ndims--;
+        } else if( (0 == i) && (layout.stride[0] == (ptrdiff_t)layout.block_len) ) {
+            layout.block_len *= layout.count[0];
+            layout.count[0] = 1;
+        } else if( (0 < i) &&
+                   (layout.stride[i] == (ptrdiff_t)layout.count[i - 1] * layout.stride[i - 1]) ) {
+            layout.count[i - 1] *= layout.count[i];
+            layout.count[i] = 1;
+        } else {
+            i++;
+        }
+    }
+    if( 0 == layout.ndims ) {
+        return OPAL_SUCCESS;  /* contiguous, handled by the contiguous functions */
+    }
+
+    for( total = layout.block_len, i = 0; i < layout.ndims; i++ ) {
+        total *= layout.count[i];
+    }
+    if( total != pData->size ) {
+        return OPAL_SUCCESS;
+    }
+
+    for( i = 0; 0 != opal_datatype_strided_functions[i].block_len; i++ ) {
+        if( layout.block_len == opal_datatype_strided_functions[i].block_len ) {
+            break;
+        }
+    }
+    layout.pack = opal_datatype_strided_functions[i].pack;
+    layout.unpack = opal_datatype_strided_functions[i].unpack;
+
+    pData->strided = (opal_datatype_strided_t*)malloc(sizeof(opal_datatype_strided_t));
+    if( NULL == pData->strided ) {
+        return OPAL_ERR_OUT_OF_RESOURCE;
+    }
+    *pData->strided = layout;
+    return OPAL_SUCCESS;
+}
+
+/*
+ * Set up the loops of the layout, with the count of the convertor as
+ * the outermost one, and return the address in the user buffer of the
+ * block containing position.
+ */
+static unsigned char*
+opal_datatype_strided_locate( const opal_datatype_strided_t* layout,
+                              unsigned char* base, ptrdiff_t extent, size_t position,
+                              size_t* count, ptrdiff_t* stride, size_t* idx )
+{
+    size_t block = position / layout->block_len;
+    unsigned char* user = base + layout->disp;
+    uint32_t d;
+
+    for( d = 0; d < layout->ndims; d++ ) {
+        count[d] = layout->count[d];
+        stride[d] = layout->stride[d];
+    }
+    count[d] = SIZE_MAX;
+    stride[d] = extent;
+
+    for( d = 0; d <= layout->ndims; d++ ) {
+        idx[d] = block % count[d];
+        block /= count[d];
+        user += (ptrdiff_t)idx[d] * stride[d];
+    }
+    return user;
+}
+
+/*
+ * Copy length bytes of the packed representation starting at position
+ * between the user buffer and packed.
+ */
+static void
+opal_datatype_strided_copy( const opal_datatype_strided_t* layout,
+                            unsigned char* base, ptrdiff_t extent,
+                            size_t position, unsigned char* packed,
+                            size_t length, bool pack )
+{
+    size_t count[OPAL_DATATYPE_STRIDED_MAX_DIMS + 1], idx[OPAL_DATATYPE_STRIDED_MAX_DIMS + 1];
+    ptrdiff_t stride[OPAL_DATATYPE_STRIDED_MAX_DIMS + 1];
+    size_t block_len = layout->block_len, offset, n;
+    uint32_t d, ndims = layout->ndims + 1;
+    unsigned char* user;
+
+    user = opal_datatype_strided_locate( layout, base, extent, position, count, stride, idx );
+    offset = position % block_len;
+
+    n = 0;
+    if( 0 != offset ) {  /* end of a block left over by the previous call */
+        n = block_len - offset;
+        if( n > length ) n = length;
+        if( pack ) {
+            MEMCPY( packed, user + offset, n );
+        } else {
+            MEMCPY( user + offset, packed, n );
+        }
+        packed += n;
+        length -= n;
+        n = 1;
+    }
+
+    for( ;; ) {
+        /* Move forward by n blocks on the innermost loop */
+        idx[0] += n;
+        user += (ptrdiff_t)n * stride[0];
+        for( d = 0; (idx[d] == count[d]) && (d + 1 < ndims); d++ ) {
+            user -= (ptrdiff_t)count[d] * stride[d];
+            idx[d] = 0;
+            idx[d + 1]++;
+            user += stride[d + 1];
+        }
+        if( length < block_len ) break;
+
+        n = count[0] - idx[0];
+        if( n > length / block_len ) n = length / block_len;
+        if( pack ) {
+            layout->pack( packed, user, n, stride[0], block_len );
+        } else {
+            layout->unpack( packed, user, n, stride[0], block_len );
+        }
+        packed += n * block_len;
+        length -= n * block_len;
+    }
+
+    if( 0 != length ) {  /* beginning of a block */
+        if( pack ) {
+            MEMCPY( packed, user, length );
+        } else {
+            MEMCPY( user, packed, length );
+        }
+    }
+}
+
+int32_t
+opal_datatype_strided_raw( opal_convertor_t* pConv,
+                           struct iovec* iov, uint32_t* iov_count,
+                           size_t* length )
+{
+    const opal_datatype_t* pData = pConv->pDesc;
+    const opal_datatype_strided_t* layout = pData->strided;
+    size_t count[OPAL_DATATYPE_STRIDED_MAX_DIMS + 1], idx[OPAL_DATATYPE_STRIDED_MAX_DIMS + 1];
+    ptrdiff_t stride[OPAL_DATATYPE_STRIDED_MAX_DIMS + 1];
+    size_t offset, n, initial_bytes_converted = pConv->bConverted;
+    uint32_t d, ndims = layout->ndims + 1, index;
+    unsigned char* user;
+
+    user = opal_datatype_strided_locate( layout, pConv->pBaseBuf, pData->ub - pData->lb,
+                                         pConv->bConverted, count, stride, idx );
+    offset = pConv->bConverted % layout->block_len;
+
+    for( index = 0; (index < *iov_count) && (pConv->bConverted < pConv->local_size); index++ ) {
+        n = layout->block_len - offset;
+        if( n > pConv->local_size - pConv->bConverted ) {
+            n = pConv->local_size - pConv->bConverted;
+        }
+        iov[index].iov_base = (IOVBASE_TYPE*)(user + offset);
+        iov[index].iov_len = n;
+        pConv->bConverted += n;
+        offset = 0;
+
+        idx[0]++;
+        user += stride[0];
+        for( d = 0; (idx[d] == count[d]) && (d + 1 < ndims); d++ ) {
+            user -= (ptrdiff_t)count[d] * stride[d];
+            idx[d] = 0;
+            idx[d + 1]++;
+            user += stride[d + 1];
+        }
+    }
+    *iov_count = index;
+    *length = pConv->bConverted - initial_bytes_converted;
+
+    if( pConv->bConverted == pConv->local_size ) {
+        pConv->flags |= CONVERTOR_COMPLETED;
+        return 1;
+    }
+    return 0;
+}
+
+static inline int32_t
+opal_strided_advance( opal_convertor_t* pConv,
+                      struct iovec* iov, uint32_t* out_size,
+                      size_t* max_data, bool pack )
+{
+    const opal_datatype_t* pData = pConv->pDesc;
+    size_t length, initial_bytes_converted = pConv->bConverted;
+    uint32_t idx;
+
+    for( idx = 0; idx < (*out_size); idx++ ) {
+        length = pConv->local_size - pConv->bConverted;
+        if( 0 == length ) break;
+        if( length > iov[idx].iov_len ) {
+            length = iov[idx].iov_len;
+        }
+        opal_datatype_strided_copy( pData->strided, pConv->pBaseBuf, pData->ub - pData->lb,
+                                    pConv->bConverted, (unsigned char*)iov[idx].iov_base,
+                                    length, pack );
+        iov[idx].iov_len = length;
+        pConv->bConverted += length;
+    }
+    *max_data = pConv->bConverted - initial_bytes_converted;
+    *out_size = idx;
+
+    if( pConv->bConverted == pConv->local_size ) {
+        pConv->flags |= CONVERTOR_COMPLETED;
+        return 1;
+    }
+    return 0;
+}
+
+int32_t
+opal_pack_strided( opal_convertor_t* pConv,
+                   struct iovec* iov, uint32_t* out_size,
+                   size_t* max_data )
+{
+    return opal_strided_advance( pConv, iov, out_size, max_data, true );
+}
+
+int32_t
+opal_unpack_strided( opal_convertor_t* pConv,
+                     struct iovec* iov, uint32_t* out_size,
+                     size_t* max_data )
+{
+    return opal_strided_advance( pConv, iov, out_size, max_data, false );
+}
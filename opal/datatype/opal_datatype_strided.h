@@ -0,0 +1,100 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_DATATYPE_STRIDED_H_HAS_BEEN_INCLUDED
+#define OPAL_DATATYPE_STRIDED_H_HAS_BEEN_INCLUDED
+
+#include "opal_config.h"
+
+#include "opal/datatype/opal_datatype.h"
+#include "opal/datatype/opal_convertor.h"
+
+BEGIN_C_DECLS
+
+/* Number of nested loops of blocks a strided layout can describe */
+#define OPAL_DATATYPE_STRIDED_MAX_DIMS 3
+
+/**
+ * Copy nblocks blocks of block_len bytes between the packed buffer and
+ * the user buffer, the blocks being stride bytes apart in the user
+ * buffer.
+ */
+typedef void (*opal_datatype_strided_fn_t)( unsigned char* packed,
+                                            unsigned char* user,
+                                            size_t nblocks,
+                                            ptrdiff_t stride,
+                                            size_t block_len );
+
+/**
+ * Regular layout of a committed datatype: contiguous blocks of
+ * block_len bytes at disp + sum(i[k] * stride[k]) for all i[k] <
+ * count[k], in the order of the increasing indexes with the innermost
+ * loop first.  This covers the strided contiguous types, the vectors
+ * with fixed block lengths and the 2D/3D subarrays, once the loops
+ * that only append contiguous blocks are merged.
+ */
+typedef struct opal_datatype_strided_t {
+    size_t                     block_len;  /**< length in bytes of each block */
+    ptrdiff_t                  disp;       /**< displacement of the first block */
+    uint32_t                   ndims;      /**< number of loops */
+    size_t                     count[OPAL_DATATYPE_STRIDED_MAX_DIMS];   /**< iterations of the loops */
+    ptrdiff_t                  stride[OPAL_DATATYPE_STRIDED_MAX_DIMS];  /**< bytes between two iterations */
+    opal_datatype_strided_fn_t pack;       /**< block copy functions chosen for block_len */
+    opal_datatype_strided_fn_t unpack;
+} opal_datatype_strided_t;
+
+/**
+ * Whether the convertors use the strided functions (mpi_ddt_strided_pack
+ * MCA parameter).
+ */
+OPAL_DECLSPEC extern bool opal_ddt_strided_pack;
+
+/**
+ * Recognize a strided layout in the optimized description of a
+ * datatype being committed, and attach it to the datatype (pData->strided
+ * stays NULL otherwise).
+ */
+int32_t opal_datatype_strided_commit( opal_datatype_t* pData );
+
+/**
+ * Pack and unpack functions of the convertors for the homogeneous
+ * conversions of the datatypes with a strided layout.  They only
+ * depend on pConv->bConverted, not on the stack of the convertor.
+ */
+int32_t
+opal_pack_strided( opal_convertor_t* pConv,
+                   struct iovec* iov, uint32_t* out_size,
+                   size_t* max_data );
+int32_t
+opal_unpack_strided( opal_convertor_t* pConv,
+                     struct iovec* iov, uint32_t* out_size,
+                     size_t* max_data );
+
+/**
+ * opal_convertor_raw for the convertors using the strided functions:
+ * one iovec per block, starting at pConv->bConverted.
+ */
+int32_t
+opal_datatype_strided_raw( opal_convertor_t* pConv,
+                           struct iovec* iov, uint32_t* iov_count,
+                           size_t* length );
+
+/**
+ * True if the convertor uses the strided functions.
+ */
+static inline bool opal_convertor_is_strided( const opal_convertor_t* pConv )
+{
+    return (opal_pack_strided == pConv->fAdvance) || (opal_unpack_strided == pConv->fAdvance);
+}
+
+END_C_DECLS
+
+#endif  /* OPAL_DATATYPE_STRIDED_H_HAS_BEEN_INCLUDED */
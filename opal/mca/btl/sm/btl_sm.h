@@ -58,6 +58,7 @@
 #include "opal/mca/rcache/base/base.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 #include "opal/mca/mpool/base/base.h"
+#include "opal/mca/memcpy/base/base.h"
 #include "opal/util/proc.h"
 #include "btl_sm_endpoint.h"
 
@@ -134,6 +135,7 @@ struct mca_btl_sm_component_t {
     unsigned int fbox_threshold;            /**< number of sends required before we setup a send fast box for a peer */
     unsigned int fbox_max;                  /**< maximum number of send fast boxes to allocate */
     unsigned int fbox_size;                 /**< size of each peer fast box allocation */
+    bool fbox_doorbell;                     /**< only poll the fast boxes flagged in the doorbell */
 
     int single_copy_mechanism;              /**< single copy mechanism to use */
 
@@ -150,6 +152,12 @@ struct mca_btl_sm_component_t {
     opal_list_t pending_fragments;          /**< fragments pending remote completion */
 
     char *backing_directory;                /**< directory to place shared memory backing files */
+    char *mpool_hints;                      /**< hints for the memory pool of the segment (xpmem only) */
+    mca_mpool_base_module_t *segment_mpool; /**< memory pool my_segment was allocated from (NULL if mmapped) */
+    size_t segment_page_size;               /**< page size of my_segment */
+
+    bool numa_placement;                    /**< place fast boxes on the NUMA node of the receiver */
+    int my_numa_node;                       /**< NUMA node this process is bound to (-1 if unknown) */
 
     /* knem stuff */
 #if OPAL_BTL_SM_HAVE_KNEM
@@ -194,6 +202,14 @@ static inline void sm_memmove (void *dst, void *src, size_t size)
     }
 }
 
+/**
+ * Place a fast box on the NUMA node of the receiving peer.
+ *
+ * @param ep (IN)       endpoint of the receiving peer
+ * @param base (IN)     base address of the fast box
+ */
+void mca_btl_sm_fbox_place (mca_btl_base_endpoint_t *ep, void *base);
+
 /**
  * Initiate a send to the peer.
  *
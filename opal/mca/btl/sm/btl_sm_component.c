@@ -33,6 +33,8 @@
 #include "opal/util/output.h"
 #include "opal/util/show_help.h"
 #include "opal/util/printf.h"
+#include "opal/util/sys_limits.h"
+#include "opal/align.h"
 #include "opal/mca/threads/mutex.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 
@@ -49,6 +51,17 @@
 #include <sys/mman.h>
 #include <fcntl.h>
 
+#ifdef HAVE_SYS_VFS_H
+#include <sys/vfs.h>
+#endif
+#ifdef HAVE_SYS_STATFS_H
+#include <sys/statfs.h>
+#endif
+
+#ifndef HUGETLBFS_MAGIC
+#define HUGETLBFS_MAGIC 0x958458f6
+#endif
+
 #ifdef HAVE_SYS_PRCTL_H
 #include <sys/prctl.h>
 #endif
@@ -203,6 +216,14 @@ static int mca_btl_sm_component_register (void)
                                            MCA_BASE_VAR_TYPE_UNSIGNED_INT, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
                                            OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_sm_component.fbox_size);
 
+    mca_btl_sm_component.fbox_doorbell = false;
+    (void) mca_base_component_var_register(&mca_btl_sm_component.super.btl_version,
+                                           "fbox_doorbell", "Only poll the fast boxes of the peers "
+                                           "that flagged new data in the doorbell of this process "
+                                           "instead of polling all of them (default: false)",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, MCA_BASE_VAR_FLAG_SETTABLE,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL, &mca_btl_sm_component.fbox_doorbell);
+
     (void) mca_base_var_enum_create ("btl_sm_single_copy_mechanisms", single_copy_mechanisms, &new_enum);
 
     /* Default to the best available mechanism (see the enumerator for ordering) */
@@ -225,6 +246,23 @@ static int mca_btl_sm_component_register (void)
                                             MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_3,
                                             MCA_BASE_VAR_SCOPE_READONLY, &mca_btl_sm_component.backing_directory);
 
+    mca_btl_sm_component.mpool_hints = NULL;
+    (void) mca_base_component_var_register (&mca_btl_sm_component.super.btl_version, "mpool_hints",
+                                            "Hints to use when selecting the memory pool the shared memory "
+                                            "segment is allocated from when using xpmem, e.g. \"page_size=2M\" "
+                                            "to use huge pages. Other single copy mechanisms get huge pages by "
+                                            "placing the backing files on a hugetlbfs mount (see backing_directory) "
+                                            "(default: none, the segment is mmapped)",
+                                            MCA_BASE_VAR_TYPE_STRING, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_READONLY, &mca_btl_sm_component.mpool_hints);
+
+    mca_btl_sm_component.numa_placement = false;
+    (void) mca_base_component_var_register (&mca_btl_sm_component.super.btl_version, "numa_placement",
+                                            "Place the fast boxes on the NUMA node of the receiving process. "
+                                            "Ignored for segments backed by huge pages (default: false)",
+                                            MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0, OPAL_INFO_LVL_5,
+                                            MCA_BASE_VAR_SCOPE_READONLY, &mca_btl_sm_component.numa_placement);
+
 
 #if OPAL_BTL_SM_HAVE_KNEM
     /* Currently disabling DMA mode by default; it's not clear that this is useful in all applications and architectures. */
@@ -322,6 +360,19 @@ static int mca_btl_sm_component_open(void)
 }
 
 
+/* release an anonymous (xpmem) segment */
+static void mca_btl_sm_segment_release (void)
+{
+    mca_btl_sm_component_t *component = &mca_btl_sm_component;
+
+    if (NULL != component->segment_mpool) {
+        component->segment_mpool->mpool_free (component->segment_mpool, component->my_segment);
+        component->segment_mpool = NULL;
+    } else {
+        munmap (component->my_segment, component->segment_size);
+    }
+}
+
 /*
  * component cleanup - sanity checking of queue lengths
  */
@@ -338,7 +389,7 @@ static int mca_btl_sm_component_close(void)
 
     if (MCA_BTL_SM_XPMEM == mca_btl_sm_component.single_copy_mechanism &&
         NULL != mca_btl_sm_component.my_segment) {
-        munmap (mca_btl_sm_component.my_segment, mca_btl_sm_component.segment_size);
+        mca_btl_sm_segment_release ();
     }
 
     mca_btl_sm_component.my_segment = NULL;
@@ -551,6 +602,23 @@ static mca_btl_base_module_t **mca_btl_sm_component_init (int *num_btls,
         component->segment_size = (2 << 20);
     }
 
+    /* backing files on a hugetlbfs mount must be a multiple of the huge page size */
+    component->segment_page_size = opal_getpagesize ();
+#if defined(HAVE_STATFS) && defined(HAVE_STRUCT_STATFS_F_TYPE)
+    if (MCA_BTL_SM_XPMEM != component->single_copy_mechanism) {
+        struct statfs info;
+
+        /* f_bsize is the huge page size on hugetlbfs only, other file
+         * systems report their preferred I/O size */
+        if (0 == statfs (component->backing_directory, &info) &&
+            HUGETLBFS_MAGIC == (unsigned long) info.f_type &&
+            (size_t) info.f_bsize > component->segment_page_size) {
+            component->segment_page_size = info.f_bsize;
+            component->segment_size = OPAL_ALIGN(component->segment_size, info.f_bsize, size_t);
+        }
+    }
+#endif
+
     component->fbox_size = (component->fbox_size + MCA_BTL_SM_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
 
     if (component->segment_size > (1ul << MCA_BTL_SM_OFFSET_BITS)) {
@@ -589,16 +657,43 @@ static mca_btl_base_module_t **mca_btl_sm_component_init (int *num_btls,
             goto failed;
         }
     } else {
-        /* when using xpmem it is safe to use an anonymous segment */
-        component->my_segment = mmap (NULL, component->segment_size, PROT_READ |
-                                      PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
-        if ((void *)-1 == component->my_segment) {
-            BTL_VERBOSE(("Could not create anonymous memory segment"));
-            free (btls);
-            return NULL;
+        /* when using xpmem it is safe to use an anonymous segment. it can come from
+         * a memory pool (e.g., the huge pages of mpool/hugepage) */
+        if (NULL != component->mpool_hints) {
+            component->segment_mpool = mca_mpool_base_module_lookup (component->mpool_hints);
+            if (NULL != component->segment_mpool) {
+                component->my_segment = component->segment_mpool->mpool_alloc (component->segment_mpool,
+                                                                               component->segment_size,
+                                                                               opal_getpagesize (), 0);
+                if (NULL == component->my_segment) {
+                    BTL_VERBOSE(("Could not allocate the segment from the memory pool matching %s",
+                                 component->mpool_hints));
+                    component->segment_mpool = NULL;
+                }
+            }
+        }
+
+        if (NULL == component->segment_mpool) {
+            component->my_segment = mmap (NULL, component->segment_size, PROT_READ |
+                                          PROT_WRITE, MAP_ANONYMOUS | MAP_SHARED, -1, 0);
+            if ((void *)-1 == component->my_segment) {
+                BTL_VERBOSE(("Could not create anonymous memory segment"));
+                free (btls);
+                return NULL;
+            }
         }
     }
 
+    /* fast boxes can only be placed one page at a time */
+    if (component->numa_placement && (NULL != component->segment_mpool ||
+                                      component->segment_page_size > (size_t) opal_getpagesize ())) {
+        BTL_VERBOSE(("segment backed by huge pages. disabling NUMA placement of the fast boxes"));
+        component->numa_placement = false;
+    }
+    if (component->numa_placement) {
+        component->fbox_size = OPAL_ALIGN(component->fbox_size, opal_getpagesize (), unsigned int);
+    }
+
     /* initialize my fifo */
     sm_fifo_init ((struct sm_fifo_t *) component->my_segment);
 
@@ -620,7 +715,7 @@ static mca_btl_base_module_t **mca_btl_sm_component_init (int *num_btls,
  failed:
 #if OPAL_BTL_SM_HAVE_XPMEM
     if (MCA_BTL_SM_XPMEM == mca_btl_sm_component.single_copy_mechanism) {
-        munmap (component->my_segment, component->segment_size);
+        mca_btl_sm_segment_release ();
     } else
 #endif
         opal_shmem_unlink (&component->seg_ds);
@@ -666,6 +761,8 @@ void mca_btl_sm_poll_handle_frag (mca_btl_sm_hdr_t *hdr, struct mca_btl_base_end
     if (OPAL_UNLIKELY(MCA_BTL_SM_FLAG_SETUP_FBOX & hdr->flags)) {
         mca_btl_sm_endpoint_setup_fbox_recv (endpoint, relative2virtual(hdr->fbox_base));
         mca_btl_sm_component.fbox_in_endpoints[mca_btl_sm_component.num_fbox_in_endpoints++] = endpoint;
+        /* the peer may have rung the doorbell before the fast box was set up */
+        mca_btl_sm_fbox_ring_self (endpoint);
     }
 
     hdr->flags = MCA_BTL_SM_FLAG_COMPLETE;
@@ -91,6 +91,7 @@ typedef struct mca_btl_base_endpoint_t {
     opal_mutex_t pending_frags_lock; /**< protect pending_frags */
     opal_list_t pending_frags; /**< fragments pending fast box space */
     bool waiting;           /**< endpoint is on the component wait list */
+    int numa_node;          /**< NUMA node the peer is bound to (-1 if unknown) */
 } mca_btl_base_endpoint_t;
 
 typedef mca_btl_base_endpoint_t mca_btl_sm_endpoint_t;
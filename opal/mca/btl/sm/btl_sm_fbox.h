@@ -17,6 +17,10 @@
 
 #include "btl_sm.h"
 
+#ifdef HAVE_STRINGS_H
+#include <strings.h>
+#endif
+
 #define MCA_BTL_SM_POLL_COUNT 31
 
 typedef union mca_btl_sm_fbox_hdr_t {
@@ -54,6 +58,30 @@ typedef union mca_btl_sm_fbox_hdr_t {
 
 void mca_btl_sm_poll_handle_frag (mca_btl_sm_hdr_t *hdr, mca_btl_base_endpoint_t *ep);
 
+/* flag the fast box of this process to the peer of ep in the peer's doorbell */
+static inline void mca_btl_sm_fbox_ring (mca_btl_base_endpoint_t *ep)
+{
+    opal_atomic_int32_t *word = sm_fifo_doorbell (ep->fifo) + (MCA_BTL_SM_LOCAL_RANK >> 5);
+    const int32_t bit = (int32_t) (1u << (MCA_BTL_SM_LOCAL_RANK & 31));
+
+    /* the fast box header must be visible before the doorbell is read. the
+     * atomic is skipped if the peer has not cleared the bit yet: it will read
+     * the new header after clearing it. */
+    opal_atomic_mb ();
+    if (!(*word & bit)) {
+        (void) opal_atomic_fetch_or_32 (word, bit);
+    }
+}
+
+/* flag the fast box of the peer of ep in the doorbell of this process so that
+ * it is polled in the next call to mca_btl_sm_check_fboxes() */
+static inline void mca_btl_sm_fbox_ring_self (mca_btl_base_endpoint_t *ep)
+{
+    opal_atomic_int32_t *word = sm_fifo_doorbell (mca_btl_sm_component.my_fifo) + (ep->peer_smp_rank >> 5);
+
+    (void) opal_atomic_fetch_or_32 (word, (int32_t) (1u << (ep->peer_smp_rank & 31)));
+}
+
 static inline void mca_btl_sm_fbox_set_header (mca_btl_sm_fbox_hdr_t *hdr, uint16_t tag,
                                                uint16_t seq, uint32_t size)
 {
@@ -84,6 +112,7 @@ static inline bool mca_btl_sm_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned
     unsigned int start, end, buffer_free;
     size_t data_size = size;
     unsigned char *dst, *data;
+    struct iovec iov[2];
     bool hbs, hbm;
 
     /* don't try to use the per-peer buffer for messages that will fill up more than 25% of the buffer */
@@ -151,11 +180,13 @@ static inline bool mca_btl_sm_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned
 
     data = dst + sizeof (mca_btl_sm_fbox_hdr_t);
 
-    memcpy (data, header, header_size);
-    if (payload) {
-        /* inline sends are typically just pml headers (due to MCA_BTL_FLAGS_SEND_INPLACE) */
-        memcpy (data + header_size, payload, payload_size);
-    }
+    /* inline sends are typically just pml headers (due to MCA_BTL_FLAGS_SEND_INPLACE) so
+     * gather both pieces at once */
+    iov[0].iov_base = header;
+    iov[0].iov_len = header_size;
+    iov[1].iov_base = payload;
+    iov[1].iov_len = payload_size;
+    opal_memcpy_fromv (data, iov, payload ? 2 : 1);
 
     end += size;
 
@@ -176,80 +207,141 @@ static inline bool mca_btl_sm_fbox_sendi (mca_btl_base_endpoint_t *ep, unsigned
     opal_atomic_wmb ();
     OPAL_THREAD_UNLOCK(&ep->lock);
 
+    mca_btl_sm_fbox_ring (ep);
+
     return true;
 }
 
-static inline bool mca_btl_sm_check_fboxes (void)
+/* process up to MCA_BTL_SM_POLL_COUNT + 1 fragments from the fast box of ep.
+ * returns the number of fragments processed. */
+static inline int mca_btl_sm_fbox_drain (mca_btl_base_endpoint_t *ep)
 {
     const unsigned int fbox_size = mca_btl_sm_component.fbox_size;
+    unsigned int start = ep->fbox_in.start & MCA_BTL_SM_FBOX_OFFSET_MASK;
+
+    /* save the current high bit state */
+    bool hbs = MCA_BTL_SM_FBOX_OFFSET_HBS(ep->fbox_in.start);
+    int poll_count;
+
+    for (poll_count = 0 ; poll_count <= MCA_BTL_SM_POLL_COUNT ; ++poll_count) {
+        const mca_btl_sm_fbox_hdr_t hdr = mca_btl_sm_fbox_read_header (MCA_BTL_SM_FBOX_HDR(ep->fbox_in.buffer + start));
+
+        /* check for a valid tag a sequence number */
+        if (0 == hdr.data.tag || hdr.data.seq != ep->fbox_in.seq) {
+            break;
+        }
+
+        ++ep->fbox_in.seq;
+
+        /* force all prior reads to complete before continuing */
+        opal_atomic_rmb ();
+
+        BTL_VERBOSE(("got frag from %d with header {.tag = %d, .size = %d, .seq = %u} from offset %u",
+                     ep->peer_smp_rank, hdr.data.tag, hdr.data.size, hdr.data.seq, start));
+
+        /* the 0xff tag indicates we should skip the rest of the buffer */
+        if (OPAL_LIKELY((0xfe & hdr.data.tag) != 0xfe)) {
+            mca_btl_base_segment_t segment;
+            const mca_btl_active_message_callback_t *reg =
+                mca_btl_base_active_message_trigger + hdr.data.tag;
+            mca_btl_base_receive_descriptor_t desc = {.endpoint = ep, .des_segments = &segment,
+                                                      .des_segment_count = 1, .tag = hdr.data.tag,
+                                                      .cbdata = reg->cbdata};
+
+            /* fragment fits entirely in the remaining buffer space. some
+             * btl users do not handle fragmented data so we can't split
+             * the fragment without introducing another copy here. this
+             * limitation has not appeared to cause any performance
+             * degradation. */
+            segment.seg_len = hdr.data.size;
+            segment.seg_addr.pval = (void *) (ep->fbox_in.buffer + start + sizeof (hdr));
+
+            /* call the registered callback function */
+            reg->cbfunc(&mca_btl_sm.super, &desc);
+        } else if (OPAL_LIKELY(0xfe == hdr.data.tag)) {
+            /* process fragment header */
+            fifo_value_t *value = (fifo_value_t *)(ep->fbox_in.buffer + start + sizeof (hdr));
+            mca_btl_sm_hdr_t *hdr = relative2virtual(*value);
+            mca_btl_sm_poll_handle_frag (hdr, ep);
+        }
+
+        start = (start + hdr.data.size + sizeof (hdr) + MCA_BTL_SM_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
+        if (OPAL_UNLIKELY(fbox_size == start)) {
+            /* jump to the beginning of the buffer */
+            start = MCA_BTL_SM_FBOX_ALIGNMENT;
+            /* toggle the high bit */
+            hbs = !hbs;
+        }
+    }
+
+    if (poll_count) {
+        BTL_VERBOSE(("left off at offset %u (hbs: %d)", start, hbs));
+
+        /* save where we left off */
+        /* let the sender know where we stopped */
+        opal_atomic_mb ();
+        ep->fbox_in.start = ep->fbox_in.startp[0] = ((uint32_t) hbs << 31) | start;
+    }
+
+    return poll_count;
+}
+
+/* poll the fast boxes flagged in the doorbell of this process */
+static inline bool mca_btl_sm_check_doorbell (void)
+{
+    opal_atomic_int32_t *doorbell = sm_fifo_doorbell (mca_btl_sm_component.my_fifo);
+    const int num_words = (MCA_BTL_SM_NUM_LOCAL_PEERS + 32) / 32;
     bool processed = false;
 
-    for (unsigned int i = 0 ; i < mca_btl_sm_component.num_fbox_in_endpoints ; ++i) {
-        mca_btl_base_endpoint_t *ep = mca_btl_sm_component.fbox_in_endpoints[i];
-        unsigned int start = ep->fbox_in.start & MCA_BTL_SM_FBOX_OFFSET_MASK;
+    for (int i = 0 ; i < num_words ; ++i) {
+        uint32_t bits;
+
+        if (0 == doorbell[i]) {
+            continue;
+        }
 
-        /* save the current high bit state */
-        bool hbs = MCA_BTL_SM_FBOX_OFFSET_HBS(ep->fbox_in.start);
-        int poll_count;
+        /* clear the bits before reading the fast boxes: a peer writing after
+         * this point rings again. the clear must be visible before the fast
+         * box headers are read (a full barrier, the swap does not order the
+         * store before the later loads on all architectures), or a peer can
+         * see its bit still set and skip the ring while we read a stale
+         * header. */
+        bits = (uint32_t) opal_atomic_swap_32 (doorbell + i, 0);
+        opal_atomic_mb ();
 
-        for (poll_count = 0 ; poll_count <= MCA_BTL_SM_POLL_COUNT ; ++poll_count) {
-            const mca_btl_sm_fbox_hdr_t hdr = mca_btl_sm_fbox_read_header (MCA_BTL_SM_FBOX_HDR(ep->fbox_in.buffer + start));
+        while (bits) {
+            int bit = ffs ((int) bits) - 1;
+            mca_btl_base_endpoint_t *ep = mca_btl_sm_component.endpoints + i * 32 + bit;
 
-            /* check for a valid tag a sequence number */
-            if (0 == hdr.data.tag || hdr.data.seq != ep->fbox_in.seq) {
-                break;
-            }
+            bits &= bits - 1;
 
-            ++ep->fbox_in.seq;
-
-            /* force all prior reads to complete before continuing */
-            opal_atomic_rmb ();
-
-            BTL_VERBOSE(("got frag from %d with header {.tag = %d, .size = %d, .seq = %u} from offset %u",
-                         ep->peer_smp_rank, hdr.data.tag, hdr.data.size, hdr.data.seq, start));
-
-            /* the 0xff tag indicates we should skip the rest of the buffer */
-            if (OPAL_LIKELY((0xfe & hdr.data.tag) != 0xfe)) {
-                mca_btl_base_segment_t segment;
-                const mca_btl_active_message_callback_t *reg =
-                    mca_btl_base_active_message_trigger + hdr.data.tag;
-                mca_btl_base_receive_descriptor_t desc = {.endpoint = ep, .des_segments = &segment,
-                                                          .des_segment_count = 1, .tag = hdr.data.tag,
-                                                          .cbdata = reg->cbdata};
-
-                /* fragment fits entirely in the remaining buffer space. some
-                 * btl users do not handle fragmented data so we can't split
-                 * the fragment without introducing another copy here. this
-                 * limitation has not appeared to cause any performance
-                 * degradation. */
-                segment.seg_len = hdr.data.size;
-                segment.seg_addr.pval = (void *) (ep->fbox_in.buffer + start + sizeof (hdr));
-
-                /* call the registered callback function */
-                reg->cbfunc(&mca_btl_sm.super, &desc);
-            } else if (OPAL_LIKELY(0xfe == hdr.data.tag)) {
-                /* process fragment header */
-                fifo_value_t *value = (fifo_value_t *)(ep->fbox_in.buffer + start + sizeof (hdr));
-                mca_btl_sm_hdr_t *hdr = relative2virtual(*value);
-                mca_btl_sm_poll_handle_frag (hdr, ep);
+            /* the fast box is not set up yet. the bit is set again when it is. */
+            if (OPAL_UNLIKELY(NULL == ep->fbox_in.buffer)) {
+                continue;
             }
 
-            start = (start + hdr.data.size + sizeof (hdr) + MCA_BTL_SM_FBOX_ALIGNMENT_MASK) & ~MCA_BTL_SM_FBOX_ALIGNMENT_MASK;
-            if (OPAL_UNLIKELY(fbox_size == start)) {
-                /* jump to the beginning of the buffer */
-                start = MCA_BTL_SM_FBOX_ALIGNMENT;
-                /* toggle the high bit */
-                hbs = !hbs;
+            if (mca_btl_sm_fbox_drain (ep) > MCA_BTL_SM_POLL_COUNT) {
+                /* the batch is full, there may be more in this fast box */
+                mca_btl_sm_fbox_ring_self (ep);
             }
+
+            processed = true;
         }
+    }
+
+    return processed;
+}
+
+static inline bool mca_btl_sm_check_fboxes (void)
+{
+    bool processed = false;
 
-        if (poll_count) {
-            BTL_VERBOSE(("left off at offset %u (hbs: %d)", start, hbs));
+    if (mca_btl_sm_component.fbox_doorbell) {
+        return mca_btl_sm_check_doorbell ();
+    }
 
-            /* save where we left off */
-            /* let the sender know where we stopped */
-            opal_atomic_mb ();
-            ep->fbox_in.start = ep->fbox_in.startp[0] = ((uint32_t) hbs << 31) | start;
+    for (unsigned int i = 0 ; i < mca_btl_sm_component.num_fbox_in_endpoints ; ++i) {
+        if (mca_btl_sm_fbox_drain (mca_btl_sm_component.fbox_in_endpoints[i])) {
             processed = true;
         }
     }
@@ -269,6 +361,10 @@ static inline void mca_btl_sm_try_fbox_setup (mca_btl_base_endpoint_t *ep, mca_b
             opal_free_list_item_t *fbox = opal_free_list_get (&mca_btl_sm_component.sm_fboxes);
 
             if (NULL != fbox) {
+                if (mca_btl_sm_component.numa_placement) {
+                    mca_btl_sm_fbox_place (ep, fbox->ptr);
+                }
+
                 /* zero out the fast box */
                 memset (fbox->ptr, 0, mca_btl_sm_component.fbox_size);
                 mca_btl_sm_endpoint_setup_fbox_send (ep, fbox);
@@ -76,6 +76,18 @@ typedef struct sm_fifo_t {
 /* large enough to ensure the fifo is on its own cache line */
 #define MCA_BTL_SM_FIFO_SIZE 128
 
+/* the fast box doorbell follows the fifo in the segment. it holds one bit per
+ * local rank, set by a peer after it writes to its fast box to this process,
+ * so the receiver only polls the fast boxes that have data. the size is
+ * rounded up to keep the rest of the segment cache aligned. */
+#define MCA_BTL_SM_DOORBELL_SIZE(nprocs) \
+    ((((nprocs) + 31) / 32 * sizeof (int32_t) + MCA_BTL_SM_FIFO_SIZE - 1) & ~(MCA_BTL_SM_FIFO_SIZE - 1))
+
+static inline opal_atomic_int32_t *sm_fifo_doorbell (struct sm_fifo_t *fifo)
+{
+    return (opal_atomic_int32_t *) ((char *) fifo + MCA_BTL_SM_FIFO_SIZE);
+}
+
 /***
  * One or more FIFO components may be a pointer that must be
  * accessed by multiple processes.  Since the shared region may
@@ -161,6 +173,7 @@ static inline void sm_fifo_init (sm_fifo_t *fifo)
     fifo->fifo_head = SM_FIFO_FREE;
     fifo->fifo_tail = SM_FIFO_FREE;
     fifo->fbox_available = mca_btl_sm_component.fbox_max;
+    memset ((void *) sm_fifo_doorbell (fifo), 0, MCA_BTL_SM_DOORBELL_SIZE(MCA_BTL_SM_NUM_LOCAL_PEERS + 1));
     mca_btl_sm_component.my_fifo = fifo;
 }
 
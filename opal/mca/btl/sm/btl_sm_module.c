@@ -29,6 +29,8 @@
 
 #include "opal_config.h"
 #include "opal/util/show_help.h"
+#include "opal/util/sys_limits.h"
+#include "opal/mca/hwloc/base/base.h"
 
 #include "btl_sm.h"
 #include "btl_sm_endpoint.h"
@@ -106,6 +108,7 @@ static void sm_btl_exit(mca_btl_sm_t *btl)
 static int sm_btl_first_time_init(mca_btl_sm_t *sm_btl, int n)
 {
     mca_btl_sm_component_t *component = &mca_btl_sm_component;
+    size_t header_size;
     int rc;
 
     /* generate the endpoints */
@@ -121,16 +124,20 @@ static int sm_btl_first_time_init(mca_btl_sm_t *sm_btl, int n)
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
-    component->mpool = mca_mpool_basic_create ((void *) (component->my_segment + MCA_BTL_SM_FIFO_SIZE),
-                                               (unsigned long) (mca_btl_sm_component.segment_size - MCA_BTL_SM_FIFO_SIZE), 64);
+    /* the fifo and the fast box doorbell are at the beginning of the segment */
+    header_size = MCA_BTL_SM_FIFO_SIZE + MCA_BTL_SM_DOORBELL_SIZE(n);
+    component->mpool = mca_mpool_basic_create ((void *) (component->my_segment + header_size),
+                                               (unsigned long) (mca_btl_sm_component.segment_size - header_size), 64);
     if (NULL == component->mpool) {
         free (component->endpoints);
         return OPAL_ERR_OUT_OF_RESOURCE;
     }
 
+    /* fast boxes placed on the NUMA node of their receiver must not share pages */
     rc = opal_free_list_init (&component->sm_fboxes, sizeof (opal_free_list_item_t), 8,
                               OBJ_CLASS(opal_free_list_item_t), mca_btl_sm_component.fbox_size,
-                              opal_cache_line_size, 0, mca_btl_sm_component.fbox_max, 4,
+                              component->numa_placement ? opal_getpagesize () : opal_cache_line_size,
+                              0, mca_btl_sm_component.fbox_max, 4,
                               component->mpool, 0, NULL, NULL, NULL);
     if (OPAL_SUCCESS != rc) {
         return rc;
@@ -194,6 +201,51 @@ static int sm_btl_first_time_init(mca_btl_sm_t *sm_btl, int n)
 }
 
 
+/* NUMA node a process is bound to according to its locality string (-1 if
+ * unknown or bound to several nodes) */
+static int sm_proc_numa_node (opal_process_name_t *name)
+{
+    char *loc = NULL, *numa;
+    int rc, node = -1;
+
+    OPAL_MODEX_RECV_VALUE_OPTIONAL(rc, PMIX_LOCALITY_STRING, name, &loc, OPAL_STRING);
+    if (OPAL_SUCCESS != rc || NULL == loc) {
+        return -1;
+    }
+
+    numa = opal_hwloc_base_get_location (loc, HWLOC_OBJ_NODE, 0);
+    if (NULL != numa && NULL == strchr (numa, ',') && NULL == strchr (numa, '-')) {
+        node = strtol (numa, NULL, 10);
+    }
+
+    free (numa);
+    free (loc);
+
+    return node;
+}
+
+void mca_btl_sm_fbox_place (mca_btl_base_endpoint_t *ep, void *base)
+{
+    hwloc_obj_t obj;
+
+    if (ep->numa_node < 0 || ep->numa_node == mca_btl_sm_component.my_numa_node ||
+        OPAL_SUCCESS != opal_hwloc_base_get_topology ()) {
+        return;
+    }
+
+    obj = hwloc_get_obj_by_type (opal_hwloc_topology, HWLOC_OBJ_NODE, ep->numa_node);
+    if (NULL == obj) {
+        return;
+    }
+
+    /* the pages may have been touched by a previous user of this fast box */
+    if (0 != hwloc_set_area_membind (opal_hwloc_topology, base, mca_btl_sm_component.fbox_size,
+                                     obj->cpuset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_MIGRATE)) {
+        BTL_VERBOSE(("could not place the fast box to local rank %d on NUMA node %d",
+                     ep->peer_smp_rank, ep->numa_node));
+    }
+}
+
 static int init_sm_endpoint (struct mca_btl_base_endpoint_t *ep, struct opal_proc_t *proc, int remote_rank) {
     mca_btl_sm_component_t *component = &mca_btl_sm_component;
     union sm_modex_t *modex;
@@ -204,6 +256,7 @@ static int init_sm_endpoint (struct mca_btl_base_endpoint_t *ep, struct opal_pro
     OBJ_CONSTRUCT(ep, mca_btl_sm_endpoint_t);
 
     ep->peer_smp_rank = remote_rank;
+    ep->numa_node = component->numa_placement ? sm_proc_numa_node (&proc->proc_name) : -1;
 
     if (remote_rank != MCA_BTL_SM_LOCAL_RANK) {
         OPAL_MODEX_RECV_IMMEDIATE(rc, &component->super.btl_version,
@@ -339,6 +392,9 @@ static int sm_add_procs (struct mca_btl_base_module_t* btl,
 
 
     if (!sm_btl->btl_inited) {
+        component->my_numa_node = component->numa_placement ?
+            sm_proc_numa_node (&OPAL_PROC_MY_NAME) : -1;
+
         rc = sm_btl_first_time_init (sm_btl, 1 + MCA_BTL_SM_NUM_LOCAL_PEERS);
         if (rc != OPAL_SUCCESS) {
             return rc;
@@ -586,7 +642,7 @@ static struct mca_btl_base_descriptor_t *sm_prepare_src (struct mca_btl_base_mod
         } else {
 #endif
             /* NTH: the covertor adds some latency so we bypass it here */
-            memcpy ((void *)((uintptr_t)frag->segments[0].seg_addr.pval + reserve), data_ptr, *size);
+            opal_memcpy_shared ((void *)((uintptr_t)frag->segments[0].seg_addr.pval + reserve), data_ptr, *size);
             frag->segments[0].seg_len = total_size;
 #if OPAL_BTL_SM_HAVE_XPMEM
         }
@@ -98,10 +98,10 @@ static void mca_btl_sm_sc_emu_rdma (mca_btl_base_module_t *btl, mca_btl_base_tag
 
     switch (hdr->type) {
     case MCA_BTL_SM_OP_PUT:
-        memcpy ((void *) hdr->addr, data, size);
+        opal_memcpy_shared ((void *) hdr->addr, data, size);
         break;
     case MCA_BTL_SM_OP_GET:
-        memcpy (data, (void *) hdr->addr, size);
+        opal_memcpy_shared (data, (void *) hdr->addr, size);
         break;
 #if OPAL_HAVE_ATOMIC_MATH_64
     case MCA_BTL_SM_OP_ATOMIC:
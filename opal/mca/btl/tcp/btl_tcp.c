@@ -34,6 +34,7 @@
 #include "opal/mca/mpool/mpool.h"
 #include "opal/mca/btl/base/btl_base_error.h"
 #include "opal/opal_socket_errno.h"
+#include "opal/align.h"
 
 #include "btl_tcp.h"
 #include "btl_tcp_frag.h"
@@ -201,6 +202,7 @@ mca_btl_base_descriptor_t* mca_btl_tcp_alloc(
     frag->base.des_flags = flags;
     frag->base.order = MCA_BTL_NO_ORDER;
     frag->btl = (mca_btl_tcp_module_t*)btl;
+    frag->data_iov_cnt = 0;
     return (mca_btl_base_descriptor_t*)frag;
 }
 
@@ -218,6 +220,77 @@ int mca_btl_tcp_free(
     return OPAL_SUCCESS;
 }
 
+/**
+ * Describe the next *size bytes of a non-contiguous convertor with the
+ * raw memory layout of its datatype, so that the fragment is written
+ * directly from the user buffer instead of being packed.  The iovecs
+ * are stored in the unused payload of the fragment after the reserved
+ * header, two entries past its beginning to leave room for the TCP
+ * header and the reserved header (see mca_btl_tcp_send), and the second
+ * segment of the fragment only gives the length of the data.  Return false
+ * with the convertor untouched when the blocks of the datatype are too
+ * small on average to be worth an iovec each, and mark the convertor with
+ * CONVERTOR_NO_RAW_SEND so the next fragments of the message are packed
+ * without walking the datatype again (the flag is cleared when the
+ * convertor is prepared for another message).
+ */
+static bool mca_btl_tcp_prepare_raw( mca_btl_tcp_frag_t* frag,
+                                     struct opal_convertor_t* convertor,
+                                     size_t reserve, size_t* size )
+{
+    unsigned char* payload = (unsigned char*)(frag + 1);
+    size_t length, total, start = convertor->bConverted, position;
+    size_t max_data = *size, min_block = (size_t)mca_btl_tcp_component.tcp_raw_send_min_block;
+    opal_convertor_t raw_convertor;
+    struct iovec* iov;
+    uint32_t iov_count, i;
+    int32_t done;
+
+    iov = OPAL_ALIGN_PTR(payload + reserve, sizeof(void*), struct iovec*);
+    if( (unsigned char*)(iov + 3) > payload + frag->size ) {
+        return false;
+    }
+    iov_count = (uint32_t)((payload + frag->size - (unsigned char*)(iov + 2)) / sizeof(struct iovec));
+    if( iov_count > max_data / min_block + 1 ) {
+        iov_count = max_data / min_block + 1;
+    }
+    iov += 2;
+
+    /* The raw description stops at the end of the iovecs and not at
+     * max_data, so walk a copy of the convertor and move the real one
+     * forward afterward. */
+    OBJ_CONSTRUCT(&raw_convertor, opal_convertor_t);
+    opal_convertor_clone(convertor, &raw_convertor, 1);
+    done = opal_convertor_raw(&raw_convertor, iov, &iov_count, &length);
+    OBJ_DESTRUCT(&raw_convertor);
+    if( (done < 0) || ((length < max_data) && (0 == done)) ) {
+        convertor->flags |= CONVERTOR_NO_RAW_SEND;
+        return false;
+    }
+
+    position = start + (length < max_data ? length : max_data);
+    opal_convertor_set_position(convertor, &position);  /* can stop on an element boundary */
+    max_data = position - start;
+    if( 0 == max_data ) {  /* a single element does not fit in the fragment */
+        convertor->flags |= CONVERTOR_NO_RAW_SEND;
+        return false;
+    }
+    for( i = 0, total = 0; total < max_data; i++ ) {
+        if( iov[i].iov_len > max_data - total ) {
+            iov[i].iov_len = max_data - total;
+        }
+        total += iov[i].iov_len;
+    }
+    frag->data_iov = iov;
+    frag->data_iov_cnt = i;
+    /* the upper layer accounts the data with the segments */
+    frag->segments[1].seg_addr.pval = iov[0].iov_base;
+    frag->segments[1].seg_len = max_data;
+    frag->base.des_segment_count = 2;
+    *size = max_data;
+    return true;
+}
+
 /**
  * Pack data and return a descriptor that can be
  * used for send/put.
@@ -264,11 +337,23 @@ mca_btl_base_descriptor_t* mca_btl_tcp_prepare_src(
     frag->segments[0].seg_len = reserve;
 
     frag->base.des_segment_count = 1;
+    frag->data_iov_cnt = 0;
     if(opal_convertor_need_buffers(convertor)) {
 
         if (max_data + reserve > frag->size) {
             max_data = frag->size - reserve;
         }
+        /*
+         * large fragments of homogeneous non-contiguous data are sent from
+         * the user buffer with the raw description of the datatype
+         */
+        if( (0 != mca_btl_tcp_component.tcp_raw_send_min) &&
+            (max_data >= (size_t)mca_btl_tcp_component.tcp_raw_send_min) &&
+            (convertor->flags & CONVERTOR_HOMOGENEOUS) &&
+            !(convertor->flags & (CONVERTOR_WITH_CHECKSUM | CONVERTOR_CUDA | CONVERTOR_NO_RAW_SEND)) &&
+            mca_btl_tcp_prepare_raw(frag, convertor, reserve, &max_data) ) {
+            goto prepared;
+        }
         iov.iov_len = max_data;
         iov.iov_base = (IOVBASE_TYPE*)(((unsigned char*)(frag->segments[0].seg_addr.pval)) + reserve);
 
@@ -296,6 +381,7 @@ mca_btl_base_descriptor_t* mca_btl_tcp_prepare_src(
         frag->base.des_segment_count = 2;
     }
 
+ prepared:
     frag->base.des_segments = frag->segments;
     frag->base.des_flags = flags;
     frag->base.order = MCA_BTL_NO_ORDER;
@@ -319,6 +405,7 @@ int mca_btl_tcp_send( struct mca_btl_base_module_t* btl,
 {
     mca_btl_tcp_module_t* tcp_btl = (mca_btl_tcp_module_t*) btl;
     mca_btl_tcp_frag_t* frag = (mca_btl_tcp_frag_t*)descriptor;
+    struct iovec* iov = frag->iov;
     int i;
 
     frag->btl = tcp_btl;
@@ -326,16 +413,26 @@ int mca_btl_tcp_send( struct mca_btl_base_module_t* btl,
     frag->rc = 0;
     frag->iov_idx = 0;
     frag->iov_cnt = 1;
-    frag->iov_ptr = frag->iov;
-    frag->iov[0].iov_base = (IOVBASE_TYPE*)&frag->hdr;
-    frag->iov[0].iov_len = sizeof(frag->hdr);
     frag->hdr.size = 0;
-    for( i = 0; i < (int)frag->base.des_segment_count; i++) {
-        frag->hdr.size += frag->segments[i].seg_len;
-        frag->iov[i+1].iov_len = frag->segments[i].seg_len;
-        frag->iov[i+1].iov_base = (IOVBASE_TYPE*)frag->segments[i].seg_addr.pval;
-        frag->iov_cnt++;
+    if( 0 != frag->data_iov_cnt ) {
+        /* the second segment stands for the data described by data_iov,
+         * the two entries before being left for the headers */
+        iov = frag->data_iov - 2;
+        frag->hdr.size = frag->segments[0].seg_len + frag->segments[1].seg_len;
+        iov[1].iov_len = frag->segments[0].seg_len;
+        iov[1].iov_base = (IOVBASE_TYPE*)frag->segments[0].seg_addr.pval;
+        frag->iov_cnt += 1 + frag->data_iov_cnt;
+    } else {
+        for( i = 0; i < (int)frag->base.des_segment_count; i++) {
+            frag->hdr.size += frag->segments[i].seg_len;
+            iov[i+1].iov_len = frag->segments[i].seg_len;
+            iov[i+1].iov_base = (IOVBASE_TYPE*)frag->segments[i].seg_addr.pval;
+            frag->iov_cnt++;
+        }
     }
+    frag->iov_ptr = iov;
+    iov[0].iov_base = (IOVBASE_TYPE*)&frag->hdr;
+    iov[0].iov_len = sizeof(frag->hdr);
     frag->hdr.base.tag = tag;
     frag->hdr.type = MCA_BTL_TCP_HDR_TYPE_SEND;
     frag->hdr.count = 0;
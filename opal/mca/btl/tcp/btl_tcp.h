@@ -129,6 +129,8 @@ struct mca_btl_tcp_component_t {
     int    tcp_sndbuf;                      /**< socket sndbuf size */
     int    tcp_rcvbuf;                      /**< socket rcvbuf size */
     int    tcp_disable_family;              /**< disabled AF_family */
+    int    tcp_raw_send_min;                /**< minimum size of the non-contiguous fragments sent from the user buffer */
+    int    tcp_raw_send_min_block;          /**< minimum average block length for these fragments */
 
     /* free list of fragment descriptors */
     opal_free_list_t tcp_frag_eager;
@@ -277,6 +277,18 @@ static int mca_btl_tcp_component_register(void)
         " used to reduce the number of syscalls, by replacing them with memcpy."
         " Every read will read the expected data plus the amount of the"
                                     " endpoint_cache", 30*1024, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_endpoint_cache);
+    mca_btl_tcp_param_register_int ("raw_send_min",
+                                    "Minimum size of the fragments of non-contiguous data written directly"
+                                    " from the user buffer, following the memory layout of the datatype,"
+                                    " instead of being packed into the fragment (0 to always pack)",
+                                    32*1024, OPAL_INFO_LVL_5, &mca_btl_tcp_component.tcp_raw_send_min);
+    mca_btl_tcp_param_register_int ("raw_send_min_block",
+                                    "Minimum average length of the contiguous blocks of a non-contiguous"
+                                    " datatype for its fragments to be written directly from the user buffer",
+                                    512, OPAL_INFO_LVL_5, &mca_btl_tcp_component.tcp_raw_send_min_block);
+    if( mca_btl_tcp_component.tcp_raw_send_min_block < 1 ) {
+        mca_btl_tcp_component.tcp_raw_send_min_block = 1;
+    }
     mca_btl_tcp_param_register_int ("use_nagle", "Whether to use Nagle's algorithm or not (using Nagle's algorithm may increase short message latency)",
                                     0, OPAL_INFO_LVL_4, &mca_btl_tcp_component.tcp_not_use_nodelay);
     mca_btl_tcp_param_register_int( "port_min_v4",
@@ -58,18 +58,21 @@ static void mca_btl_tcp_frag_eager_constructor(mca_btl_tcp_frag_t* frag)
 {
     frag->size = mca_btl_tcp_module.super.btl_eager_limit;
     frag->my_list = &mca_btl_tcp_component.tcp_frag_eager;
+    frag->data_iov_cnt = 0;
 }
 
 static void mca_btl_tcp_frag_max_constructor(mca_btl_tcp_frag_t* frag)
 {
     frag->size = mca_btl_tcp_module.super.btl_max_send_size;
     frag->my_list = &mca_btl_tcp_component.tcp_frag_max;
+    frag->data_iov_cnt = 0;
 }
 
 static void mca_btl_tcp_frag_user_constructor(mca_btl_tcp_frag_t* frag)
 {
     frag->size = 0;
     frag->my_list = &mca_btl_tcp_component.tcp_frag_user;
+    frag->data_iov_cnt = 0;
 }
 
 
@@ -99,15 +102,16 @@ OBJ_CLASS_INSTANCE(
 
 size_t mca_btl_tcp_frag_dump(mca_btl_tcp_frag_t* frag, char* msg, char* buf, size_t length)
 {
+    struct iovec *iov = frag->iov_ptr - frag->iov_idx;  /* frag->iov, or the raw description */
     int i, used;
 
     used = snprintf(buf, length, "%s frag %p iov_cnt %d iov_idx %d size %lu\n",
                     msg, (void*)frag, (int)frag->iov_cnt, (int)frag->iov_idx, frag->size);
     if ((size_t)used >= length) return length;
-    for( i = 0; i < (int)frag->iov_cnt; i++ ) {
+    for( i = 0; i < (int)(frag->iov_idx + frag->iov_cnt); i++ ) {
         used += snprintf(&buf[used], length - used, "[%s%p:%lu] ",
                          (i < (int)frag->iov_idx ? "*" : ""),
-                         frag->iov[i].iov_base, frag->iov[i].iov_len);
+                         iov[i].iov_base, iov[i].iov_len);
         if ((size_t)used >= length) return length;
     }
     return used;
@@ -118,9 +122,16 @@ bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t* frag, int sd)
     ssize_t cnt;
     size_t i, num_vecs;
 
+ repeat:
+    /* the raw description of non-contiguous data can exceed IOV_MAX */
+    num_vecs = frag->iov_cnt;
+    if( num_vecs > MCA_BTL_TCP_IOV_MAX ) {
+        num_vecs = MCA_BTL_TCP_IOV_MAX;
+    }
+
     /* non-blocking write, but continue if interrupted */
     do {
-        cnt = writev(sd, frag->iov_ptr, frag->iov_cnt);
+        cnt = writev(sd, frag->iov_ptr, num_vecs);
         if(cnt < 0) {
             switch(opal_socket_errno) {
             case EINTR:
@@ -148,7 +159,6 @@ bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t* frag, int sd)
     } while(cnt < 0);
 
     /* if the write didn't complete - update the iovec state */
-    num_vecs = frag->iov_cnt;
     for( i = 0; i < num_vecs; i++) {
         if(cnt >= (ssize_t)frag->iov_ptr->iov_len) {
             cnt -= frag->iov_ptr->iov_len;
@@ -165,6 +175,9 @@ bool mca_btl_tcp_frag_send(mca_btl_tcp_frag_t* frag, int sd)
             break;
         }
     }
+    if( (i == num_vecs) && (0 != frag->iov_cnt) ) {
+        goto repeat;  /* all the iovecs given to writev are gone, write the next ones */
+    }
     return (frag->iov_cnt == 0);
 }
 
@@ -25,6 +25,7 @@
 
 #include "opal_config.h"
 
+#include <limits.h>
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
 #endif
@@ -42,6 +43,13 @@ BEGIN_C_DECLS
 
 #define MCA_BTL_TCP_FRAG_IOVEC_NUMBER  4
 
+/* Maximum number of iovecs given to a single writev */
+#if defined(IOV_MAX)
+#define MCA_BTL_TCP_IOV_MAX IOV_MAX
+#else
+#define MCA_BTL_TCP_IOV_MAX 1024
+#endif  /* defined(IOV_MAX) */
+
 /**
  * TCP fragment derived type.
  */
@@ -55,6 +63,8 @@ struct mca_btl_tcp_frag_t {
     struct iovec *iov_ptr;
     uint32_t iov_cnt;
     uint32_t iov_idx;
+    struct iovec *data_iov;   /**< raw description of the user data sent in place of segments[1] */
+    uint32_t data_iov_cnt;    /**< 0 unless the data is sent with its raw description */
     size_t size;
     uint16_t next_step;
     int rc;
@@ -12,8 +12,13 @@
 #ifndef OPAL_MCA_MEMCPY_BASE_MEMCPY_BASE_NULL_H
 #define OPAL_MCA_MEMCPY_BASE_MEMCPY_BASE_NULL_H
 
+#include <string.h>
+
 #define opal_memcpy( dst, src, length ) \
-    memcpy( (dst), (src), (length) );
+    memcpy( (dst), (src), (length) )
+
+#define opal_memcpy_shared( dst, src, length ) \
+    opal_memcpy( (dst), (src), (length) )
 
 #define opal_memcpy_tov( dst_iov, src, count )        \
     do {                                              \
@@ -39,4 +44,23 @@
         }                                               \
     } while (0)
 
+/*
+ * Copy count elements of size bytes reversing the order of the bytes
+ * of each element.
+ */
+#define opal_memcpy_swap( dst, src, size, count )                  \
+    do {                                                            \
+        size_t _i, _j, _size = (size);                              \
+        unsigned char* _dst = (unsigned char*)(dst);                \
+        const unsigned char* _src = (const unsigned char*)(src);    \
+                                                                    \
+        for( _i = 0; _i < (count); _i++ ) {                         \
+            for( _j = 0; _j < _size; _j++ ) {                       \
+                _dst[_size - 1 - _j] = _src[_j];                    \
+            }                                                       \
+            _dst += _size;                                          \
+            _src += _size;                                          \
+        }                                                           \
+    } while (0)
+
 #endif
@@ -0,0 +1,145 @@
+# -*- shell-script -*-
+#
+# Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+#                         reserved.
+# $COPYRIGHT$
+#
+# Additional copyrights may follow
+#
+# $HEADER$
+#
+
+AC_DEFUN([MCA_opal_memcpy_x86_PRIORITY], [30])
+
+AC_DEFUN([MCA_opal_memcpy_x86_COMPILE_MODE], [
+    AC_MSG_CHECKING([for MCA component $2:$3 compile mode])
+    $4="static"
+    AC_MSG_RESULT([$$4])
+])
+
+AC_DEFUN([MCA_opal_memcpy_x86_POST_CONFIG],[
+    AS_IF([test "$1" = "1"], [memcpy_base_include="x86/memcpy_x86.h"])
+])dnl
+
+# MCA_opal_memcpy_x86_CONFIG(action-if-can-compile,
+#                            [action-if-cant-compile])
+# ------------------------------------------------
+# The non-temporal copies only need SSE2, which is part of the x86_64
+# baseline. The SSSE3 flavor of the byte-swapping copies and the AVX2
+# flavor of all the copy functions are built when the compiler supports
+# them, and selected at runtime.
+AC_DEFUN([MCA_opal_memcpy_x86_CONFIG],[
+    AC_CONFIG_FILES([opal/mca/memcpy/x86/Makefile])
+
+    MCA_BUILD_MEMCPY_X86_SSSE3_FLAGS=""
+    MCA_BUILD_MEMCPY_X86_AVX2_FLAGS=""
+    memcpy_x86_happy=0
+    memcpy_x86_ssse3_support=0
+    memcpy_x86_avx2_support=0
+    OPAL_VAR_SCOPE_PUSH([memcpy_x86_cflags_save])
+
+    AS_IF([test "$opal_cv_asm_arch" = "X86_64"],
+          [AC_LANG_PUSH([C])
+
+           AC_MSG_CHECKING([for SSE2 non-temporal stores])
+           AC_LINK_IFELSE(
+               [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                [[
+    int A[4] = {0, 1, 2, 3};
+    __m128i vA = _mm_loadu_si128((__m128i*)&A);
+    _mm_stream_si128((__m128i*)&A, vA);
+    _mm_sfence()
+                                ]])],
+               [memcpy_x86_happy=1
+                AC_MSG_RESULT([yes])],
+               [AC_MSG_RESULT([no])])
+
+           AS_IF([test $memcpy_x86_happy -eq 1],
+                 [AC_MSG_CHECKING([for SSSE3 support (no additional flags)])
+                  AC_LINK_IFELSE(
+                      [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                       [[
+    int A[4] = {0, 1, 2, 3};
+    __m128i vA = _mm_loadu_si128((__m128i*)&A);
+    vA = _mm_shuffle_epi8(vA, vA);
+    _mm_storeu_si128((__m128i*)&A, vA)
+                                       ]])],
+                      [memcpy_x86_ssse3_support=1
+                       AC_MSG_RESULT([yes])],
+                      [AC_MSG_RESULT([no])])
+                  AS_IF([test $memcpy_x86_ssse3_support -eq 0],
+                        [AC_MSG_CHECKING([for SSSE3 support (with -mssse3)])
+                         memcpy_x86_cflags_save="$CFLAGS"
+                         CFLAGS="$CFLAGS -mssse3"
+                         AC_LINK_IFELSE(
+                             [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                              [[
+    int A[4] = {0, 1, 2, 3};
+    __m128i vA = _mm_loadu_si128((__m128i*)&A);
+    vA = _mm_shuffle_epi8(vA, vA);
+    _mm_storeu_si128((__m128i*)&A, vA)
+                                              ]])],
+                             [memcpy_x86_ssse3_support=1
+                              MCA_BUILD_MEMCPY_X86_SSSE3_FLAGS="-mssse3"
+                              AC_MSG_RESULT([yes])],
+                             [AC_MSG_RESULT([no])])
+                         CFLAGS="$memcpy_x86_cflags_save"
+                        ])
+                 ])
+
+           AS_IF([test $memcpy_x86_happy -eq 1],
+                 [AC_MSG_CHECKING([for AVX2 support (no additional flags)])
+                  AC_LINK_IFELSE(
+                      [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                       [[
+    int A[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    __m256i vA = _mm256_loadu_si256((__m256i*)&A);
+    vA = _mm256_shuffle_epi8(vA, vA);
+    _mm256_stream_si256((__m256i*)&A, vA)
+                                       ]])],
+                      [memcpy_x86_avx2_support=1
+                       AC_MSG_RESULT([yes])],
+                      [AC_MSG_RESULT([no])])
+                  AS_IF([test $memcpy_x86_avx2_support -eq 0],
+                        [AC_MSG_CHECKING([for AVX2 support (with -mavx2)])
+                         memcpy_x86_cflags_save="$CFLAGS"
+                         CFLAGS="$CFLAGS -mavx2"
+                         AC_LINK_IFELSE(
+                             [AC_LANG_PROGRAM([[#include <immintrin.h>]],
+                                              [[
+    int A[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+    __m256i vA = _mm256_loadu_si256((__m256i*)&A);
+    vA = _mm256_shuffle_epi8(vA, vA);
+    _mm256_stream_si256((__m256i*)&A, vA)
+                                              ]])],
+                             [memcpy_x86_avx2_support=1
+                              MCA_BUILD_MEMCPY_X86_AVX2_FLAGS="-mavx2"
+                              AC_MSG_RESULT([yes])],
+                             [AC_MSG_RESULT([no])])
+                         CFLAGS="$memcpy_x86_cflags_save"
+                        ])
+                 ])
+
+           AC_LANG_POP([C])
+          ])
+
+    AC_DEFINE_UNQUOTED([OPAL_MCA_MEMCPY_X86_HAVE_SSSE3],
+                       [$memcpy_x86_ssse3_support],
+                       [SSSE3 byte-swapping copies built in the memcpy x86 component])
+    AM_CONDITIONAL([MCA_BUILD_opal_memcpy_x86_has_ssse3_support],
+                   [test "$memcpy_x86_ssse3_support" = "1"])
+    AC_SUBST(MCA_BUILD_MEMCPY_X86_SSSE3_FLAGS)
+
+    AC_DEFINE_UNQUOTED([OPAL_MCA_MEMCPY_X86_HAVE_AVX2],
+                       [$memcpy_x86_avx2_support],
+                       [AVX2 copy functions built in the memcpy x86 component])
+    AM_CONDITIONAL([MCA_BUILD_opal_memcpy_x86_has_avx2_support],
+                   [test "$memcpy_x86_avx2_support" = "1"])
+    AC_SUBST(MCA_BUILD_MEMCPY_X86_AVX2_FLAGS)
+
+    OPAL_VAR_SCOPE_POP
+
+    AS_IF([test $memcpy_x86_happy -eq 1],
+          [$1],
+          [$2])
+])dnl
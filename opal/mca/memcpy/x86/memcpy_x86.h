@@ -0,0 +1,86 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#ifndef OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+#define OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+
+#include "opal_config.h"
+
+#include <stddef.h>
+#include <string.h>
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
+#include "opal/prefetch.h"
+
+BEGIN_C_DECLS
+
+/**
+ * Copies of at least this many bytes through opal_memcpy bypass the
+ * caches (memcpy_x86_stream_limit MCA parameter).
+ */
+OPAL_DECLSPEC extern size_t opal_memcpy_x86_stream_limit;
+
+/**
+ * Copies of at least this many bytes through opal_memcpy_shared bypass
+ * the caches of the caller (memcpy_x86_shared_limit MCA parameter).
+ */
+OPAL_DECLSPEC extern size_t opal_memcpy_x86_shared_limit;
+
+/**
+ * Longest iovec entry copied with the inlined vector moves by
+ * opal_memcpy_tov and opal_memcpy_fromv, the longer ones go through
+ * memcpy.
+ */
+#define OPAL_MEMCPY_X86_SMALL_LIMIT 64
+
+/*
+ * Copy functions matching the processor, selected when the component
+ * is opened (the SSE2 ones until then).
+ */
+OPAL_DECLSPEC extern void (*opal_memcpy_x86_stream)( void *dst, const void *src, size_t length );
+OPAL_DECLSPEC extern void (*opal_memcpy_x86_tov)( const struct iovec *dst_iov, const void *src, int count );
+OPAL_DECLSPEC extern void (*opal_memcpy_x86_fromv)( void *dst, const struct iovec *src_iov, int count );
+OPAL_DECLSPEC extern void (*opal_memcpy_x86_swap)( void *dst, const void *src, size_t size, size_t count );
+
+static inline void *opal_memcpy_x86( void *dst, const void *src, size_t length,
+                                     size_t stream_limit )
+{
+    if( OPAL_UNLIKELY(length >= stream_limit) ) {
+        opal_memcpy_x86_stream( dst, src, length );
+        return dst;
+    }
+    return memcpy( dst, src, length );
+}
+
+#define opal_memcpy( dst, src, length ) \
+    opal_memcpy_x86( (dst), (src), (length), opal_memcpy_x86_stream_limit )
+
+/**
+ * Copy to a buffer the caller will not read back, such as a fragment
+ * in the shared memory of another process.
+ */
+#define opal_memcpy_shared( dst, src, length ) \
+    opal_memcpy_x86( (dst), (src), (length), opal_memcpy_x86_shared_limit )
+
+#define opal_memcpy_tov( dst_iov, src, count ) \
+    opal_memcpy_x86_tov( (dst_iov), (src), (count) )
+
+#define opal_memcpy_fromv( dst, src_iov, count ) \
+    opal_memcpy_x86_fromv( (dst), (src_iov), (count) )
+
+#define opal_memcpy_swap( dst, src, size, count ) \
+    opal_memcpy_x86_swap( (dst), (src), (size), (count) )
+
+END_C_DECLS
+
+#endif  /* OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H */
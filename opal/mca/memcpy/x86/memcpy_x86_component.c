@@ -0,0 +1,158 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "opal_config.h"
+
+#include <stdint.h>
+
+#include "opal/constants.h"
+#include "opal/mca/memcpy/memcpy.h"
+#include "opal/mca/memcpy/base/base.h"
+#include "opal/mca/memcpy/x86/memcpy_x86.h"
+
+void opal_memcpy_x86_stream_sse2( void *dst, const void *src, size_t length );
+void opal_memcpy_x86_tov_sse2( const struct iovec *dst_iov, const void *src, int count );
+void opal_memcpy_x86_fromv_sse2( void *dst, const struct iovec *src_iov, int count );
+void opal_memcpy_x86_swap_sse2( void *dst, const void *src, size_t size, size_t count );
+#if OPAL_MCA_MEMCPY_X86_HAVE_SSSE3
+void opal_memcpy_x86_swap_ssse3( void *dst, const void *src, size_t size, size_t count );
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_SSSE3 */
+#if OPAL_MCA_MEMCPY_X86_HAVE_AVX2
+void opal_memcpy_x86_stream_avx2( void *dst, const void *src, size_t length );
+void opal_memcpy_x86_tov_avx2( const struct iovec *dst_iov, const void *src, int count );
+void opal_memcpy_x86_fromv_avx2( void *dst, const struct iovec *src_iov, int count );
+void opal_memcpy_x86_swap_avx2( void *dst, const void *src, size_t size, size_t count );
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_AVX2 */
+
+/* Beyond a few MB the destination does not stay in the caches anyway */
+size_t opal_memcpy_x86_stream_limit = 4 * 1024 * 1024;
+/* The fragments of the shared memory BTLs are read by the peer, not by us */
+size_t opal_memcpy_x86_shared_limit = 16 * 1024;
+
+void (*opal_memcpy_x86_stream)( void *dst, const void *src, size_t length ) =
+    opal_memcpy_x86_stream_sse2;
+void (*opal_memcpy_x86_tov)( const struct iovec *dst_iov, const void *src, int count ) =
+    opal_memcpy_x86_tov_sse2;
+void (*opal_memcpy_x86_fromv)( void *dst, const struct iovec *src_iov, int count ) =
+    opal_memcpy_x86_fromv_sse2;
+void (*opal_memcpy_x86_swap)( void *dst, const void *src, size_t size, size_t count ) =
+    opal_memcpy_x86_swap_sse2;
+
+static bool opal_memcpy_x86_use_avx2 = true;
+
+static int opal_memcpy_x86_register(void);
+static int opal_memcpy_x86_open(void);
+
+const opal_memcpy_base_component_2_0_0_t mca_memcpy_x86_component = {
+    /* First, the mca_component_t struct containing meta information
+       about the component itself */
+    .memcpyc_version = {
+        OPAL_MEMCPY_BASE_VERSION_2_0_0,
+
+        /* Component name and version */
+        .mca_component_name = "x86",
+        MCA_BASE_MAKE_VERSION(component, OPAL_MAJOR_VERSION, OPAL_MINOR_VERSION,
+                              OPAL_RELEASE_VERSION),
+
+        /* Component open and register functions */
+        .mca_open_component = opal_memcpy_x86_open,
+        .mca_register_component_params = opal_memcpy_x86_register,
+    },
+    .memcpyc_data = {
+        /* The component is checkpoint ready */
+        MCA_BASE_METADATA_PARAM_CHECKPOINT
+    },
+};
+
+static int opal_memcpy_x86_register(void)
+{
+    (void) mca_base_component_var_register(&mca_memcpy_x86_component.memcpyc_version,
+                                           "stream_limit",
+                                           "Length in bytes from which opal_memcpy uses non-temporal "
+                                           "stores, leaving the caches to the data in use",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &opal_memcpy_x86_stream_limit);
+    (void) mca_base_component_var_register(&mca_memcpy_x86_component.memcpyc_version,
+                                           "shared_limit",
+                                           "Length in bytes from which the copies to the shared memory "
+                                           "of another process (opal_memcpy_shared) use non-temporal stores",
+                                           MCA_BASE_VAR_TYPE_SIZE_T, NULL, 0, 0,
+                                           OPAL_INFO_LVL_5, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &opal_memcpy_x86_shared_limit);
+    (void) mca_base_component_var_register(&mca_memcpy_x86_component.memcpyc_version,
+                                           "use_avx2",
+                                           "Use the AVX2 copy functions when the processor supports them",
+                                           MCA_BASE_VAR_TYPE_BOOL, NULL, 0, 0,
+                                           OPAL_INFO_LVL_9, MCA_BASE_VAR_SCOPE_LOCAL,
+                                           &opal_memcpy_x86_use_avx2);
+    return OPAL_SUCCESS;
+}
+
+#if OPAL_MCA_MEMCPY_X86_HAVE_SSSE3 || OPAL_MCA_MEMCPY_X86_HAVE_AVX2
+static void run_cpuid(uint32_t eax, uint32_t ecx, uint32_t* abcd)
+{
+    uint32_t ebx = 0, edx = 0;
+    __asm__ ( "cpuid" : "+b" (ebx), "+a" (eax), "+c" (ecx), "=d" (edx) );
+    abcd[0] = eax; abcd[1] = ebx; abcd[2] = ecx; abcd[3] = edx;
+}
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_SSSE3 || OPAL_MCA_MEMCPY_X86_HAVE_AVX2 */
+
+#if OPAL_MCA_MEMCPY_X86_HAVE_SSSE3
+static bool has_ssse3(void)
+{
+    const uint32_t ssse3_mask = (1U << 9);  /* SSSE3 (EAX = 1) : ECX */
+    uint32_t abcd[4];
+
+    run_cpuid( 1, 0, abcd );
+    return 0 != (abcd[2] & ssse3_mask);
+}
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_SSSE3 */
+
+#if OPAL_MCA_MEMCPY_X86_HAVE_AVX2
+static bool has_avx2(void)
+{
+    const uint32_t osxsave_avx_mask = (1U << 27) | (1U << 28);  /* OSXSAVE, AVX (EAX = 1) : ECX */
+    const uint32_t avx2_mask        = (1U << 5);                /* AVX2 (EAX = 7, ECX = 0) : EBX */
+    uint32_t abcd[4], xcr0_lo, xcr0_hi;
+
+    run_cpuid( 1, 0, abcd );
+    if( (abcd[2] & osxsave_avx_mask) != osxsave_avx_mask ) {
+        return false;
+    }
+    /* The OS saves the YMM registers */
+    __asm__ ( "xgetbv" : "=a" (xcr0_lo), "=d" (xcr0_hi) : "c" (0) );
+    if( (xcr0_lo & 0x6) != 0x6 ) {
+        return false;
+    }
+    run_cpuid( 7, 0, abcd );
+    return 0 != (abcd[1] & avx2_mask);
+}
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_AVX2 */
+
+static int opal_memcpy_x86_open(void)
+{
+#if OPAL_MCA_MEMCPY_X86_HAVE_SSSE3
+    /* Only the byte-swapping copies have an SSSE3 flavor */
+    if( has_ssse3() ) {
+        opal_memcpy_x86_swap = opal_memcpy_x86_swap_ssse3;
+    }
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_SSSE3 */
+#if OPAL_MCA_MEMCPY_X86_HAVE_AVX2
+    if( opal_memcpy_x86_use_avx2 && has_avx2() ) {
+        opal_memcpy_x86_stream = opal_memcpy_x86_stream_avx2;
+        opal_memcpy_x86_tov    = opal_memcpy_x86_tov_avx2;
+        opal_memcpy_x86_fromv  = opal_memcpy_x86_fromv_avx2;
+        opal_memcpy_x86_swap   = opal_memcpy_x86_swap_avx2;
+    }
+#endif  /* OPAL_MCA_MEMCPY_X86_HAVE_AVX2 */
+    return OPAL_SUCCESS;
+}
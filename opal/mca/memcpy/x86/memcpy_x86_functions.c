@@ -0,0 +1,164 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Copy functions of the x86 memcpy component.  This file is built
+ * twice: for the x86_64 baseline (SSE2), and with the AVX2 flags and
+ * GENERATE_AVX2_CODE defined.
+ */
+
+#include "opal_config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "opal/mca/memcpy/x86/memcpy_x86.h"
+
+#if defined(GENERATE_AVX2_CODE)
+#define PREPEND(name) name##_avx2
+#define VECTOR_SIZE 32
+typedef __m256i vector_t;
+#define VECTOR_LOADU(src)         _mm256_loadu_si256((const __m256i*)(src))
+#define VECTOR_STREAM(dst, v)     _mm256_stream_si256((__m256i*)(dst), (v))
+#else
+#define PREPEND(name) name##_sse2
+#define VECTOR_SIZE 16
+typedef __m128i vector_t;
+#define VECTOR_LOADU(src)         _mm_loadu_si128((const __m128i*)(src))
+#define VECTOR_STREAM(dst, v)     _mm_stream_si128((__m128i*)(dst), (v))
+#endif  /* defined(GENERATE_AVX2_CODE) */
+
+/*
+ * Copy with non-temporal stores, 4 vectors at a time, the destination
+ * being aligned on the vector size.  The fence makes the data visible
+ * before any store issued after the copy (e.g. a ready flag).
+ */
+void PREPEND(opal_memcpy_x86_stream)( void *dst, const void *src, size_t length )
+{
+    unsigned char *d = (unsigned char*)dst;
+    const unsigned char *s = (const unsigned char*)src;
+    size_t head = (size_t)(-(uintptr_t)d) & (VECTOR_SIZE - 1);
+    vector_t v0, v1, v2, v3;
+
+    if( length < head + 4 * VECTOR_SIZE ) {
+        memcpy( d, s, length );
+        return;
+    }
+    memcpy( d, s, head );
+    d += head;
+    s += head;
+    length -= head;
+
+    for( ; length >= 4 * VECTOR_SIZE; length -= 4 * VECTOR_SIZE ) {
+        v0 = VECTOR_LOADU(s);
+        v1 = VECTOR_LOADU(s + VECTOR_SIZE);
+        v2 = VECTOR_LOADU(s + 2 * VECTOR_SIZE);
+        v3 = VECTOR_LOADU(s + 3 * VECTOR_SIZE);
+        VECTOR_STREAM(d, v0);
+        VECTOR_STREAM(d + VECTOR_SIZE, v1);
+        VECTOR_STREAM(d + 2 * VECTOR_SIZE, v2);
+        VECTOR_STREAM(d + 3 * VECTOR_SIZE, v3);
+        d += 4 * VECTOR_SIZE;
+        s += 4 * VECTOR_SIZE;
+    }
+    if( 0 != length ) {
+        memcpy( d, s, length );
+    }
+    _mm_sfence();
+}
+
+/*
+ * Copy up to OPAL_MEMCPY_X86_SMALL_LIMIT bytes with two possibly
+ * overlapping moves of the largest size not exceeding the length,
+ * instead of calling memcpy for each piece.
+ */
+static inline void opal_memcpy_x86_small( unsigned char *d, const unsigned char *s, size_t n )
+{
+#if defined(GENERATE_AVX2_CODE)
+    if( n >= 32 ) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)s);
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)(s + n - 32));
+        _mm256_storeu_si256((__m256i*)d, v0);
+        _mm256_storeu_si256((__m256i*)(d + n - 32), v1);
+        return;
+    }
+#else
+    if( n >= 32 ) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)s);
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(s + 16));
+        __m128i v2 = _mm_loadu_si128((const __m128i*)(s + n - 32));
+        __m128i v3 = _mm_loadu_si128((const __m128i*)(s + n - 16));
+        _mm_storeu_si128((__m128i*)d, v0);
+        _mm_storeu_si128((__m128i*)(d + 16), v1);
+        _mm_storeu_si128((__m128i*)(d + n - 32), v2);
+        _mm_storeu_si128((__m128i*)(d + n - 16), v3);
+        return;
+    }
+#endif  /* defined(GENERATE_AVX2_CODE) */
+    if( n >= 16 ) {
+        __m128i v0 = _mm_loadu_si128((const __m128i*)s);
+        __m128i v1 = _mm_loadu_si128((const __m128i*)(s + n - 16));
+        _mm_storeu_si128((__m128i*)d, v0);
+        _mm_storeu_si128((__m128i*)(d + n - 16), v1);
+    } else if( n >= 8 ) {
+        uint64_t a, b;
+        memcpy( &a, s, 8 );
+        memcpy( &b, s + n - 8, 8 );
+        memcpy( d, &a, 8 );
+        memcpy( d + n - 8, &b, 8 );
+    } else if( n >= 4 ) {
+        uint32_t a, b;
+        memcpy( &a, s, 4 );
+        memcpy( &b, s + n - 4, 4 );
+        memcpy( d, &a, 4 );
+        memcpy( d + n - 4, &b, 4 );
+    } else if( n > 0 ) {
+        unsigned char a = s[0], b = s[n - 1], c = s[n >> 1];
+        d[0] = a;
+        d[n >> 1] = c;
+        d[n - 1] = b;
+    }
+}
+
+void PREPEND(opal_memcpy_x86_tov)( const struct iovec *dst_iov, const void *src, int count )
+{
+    const unsigned char *s = (const unsigned char*)src;
+    size_t n;
+    int i;
+
+    for( i = 0; i < count; i++ ) {
+        n = dst_iov[i].iov_len;
+        if( n <= OPAL_MEMCPY_X86_SMALL_LIMIT ) {
+            opal_memcpy_x86_small( (unsigned char*)dst_iov[i].iov_base, s, n );
+        } else {
+            memcpy( dst_iov[i].iov_base, s, n );
+        }
+        s += n;
+    }
+}
+
+void PREPEND(opal_memcpy_x86_fromv)( void *dst, const struct iovec *src_iov, int count )
+{
+    unsigned char *d = (unsigned char*)dst;
+    size_t n;
+    int i;
+
+    for( i = 0; i < count; i++ ) {
+        n = src_iov[i].iov_len;
+        if( n <= OPAL_MEMCPY_X86_SMALL_LIMIT ) {
+            opal_memcpy_x86_small( d, (const unsigned char*)src_iov[i].iov_base, n );
+        } else {
+            memcpy( d, src_iov[i].iov_base, n );
+        }
+        d += n;
+    }
+}
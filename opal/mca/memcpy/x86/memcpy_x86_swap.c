@@ -0,0 +1,156 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Byte-swapping copies of the x86 memcpy component, used for the
+ * heterogeneous and external32 conversions.  This file is built three
+ * times: for the x86_64 baseline (SSE2, no byte shuffle, hence scalar
+ * swaps), with the SSSE3 flags and GENERATE_SSSE3_CODE defined (pshufb
+ * on 16 bytes), and with the AVX2 flags and GENERATE_AVX2_CODE defined
+ * (vpshufb on 32 bytes).
+ */
+
+#include "opal_config.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <immintrin.h>
+
+#include "opal/types.h"
+#include "opal/mca/memcpy/x86/memcpy_x86.h"
+
+#if defined(GENERATE_AVX2_CODE)
+#define PREPEND(name) name##_avx2
+#define VECTOR_SIZE 32
+typedef __m256i vector_t;
+#define VECTOR_LOADU(src)         _mm256_loadu_si256((const __m256i*)(src))
+#define VECTOR_STOREU(dst, v)     _mm256_storeu_si256((__m256i*)(dst), (v))
+#define VECTOR_SHUFFLE(v, mask)   _mm256_shuffle_epi8((v), (mask))
+#define VECTOR_MASK(m)            _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(m)))
+#elif defined(GENERATE_SSSE3_CODE)
+#define PREPEND(name) name##_ssse3
+#define VECTOR_SIZE 16
+typedef __m128i vector_t;
+#define VECTOR_LOADU(src)         _mm_loadu_si128((const __m128i*)(src))
+#define VECTOR_STOREU(dst, v)     _mm_storeu_si128((__m128i*)(dst), (v))
+#define VECTOR_SHUFFLE(v, mask)   _mm_shuffle_epi8((v), (mask))
+#define VECTOR_MASK(m)            _mm_loadu_si128((const __m128i*)(m))
+#else
+#define PREPEND(name) name##_sse2
+#endif  /* defined(GENERATE_AVX2_CODE) */
+
+/*
+ * Swap count elements of size bytes one at a time.
+ */
+static inline void opal_memcpy_x86_swap_scalar( unsigned char *d, const unsigned char *s,
+                                                size_t size, size_t count )
+{
+    size_t i, j;
+
+    switch( size ) {
+    case 2:
+        for( i = 0; i < count; i++, d += 2, s += 2 ) {
+            uint16_t v;
+            memcpy( &v, s, 2 );
+            v = opal_swap_bytes2( v );
+            memcpy( d, &v, 2 );
+        }
+        break;
+    case 4:
+        for( i = 0; i < count; i++, d += 4, s += 4 ) {
+            uint32_t v;
+            memcpy( &v, s, 4 );
+            v = opal_swap_bytes4( v );
+            memcpy( d, &v, 4 );
+        }
+        break;
+    case 8:
+        for( i = 0; i < count; i++, d += 8, s += 8 ) {
+            uint64_t v;
+            memcpy( &v, s, 8 );
+            v = opal_swap_bytes8( v );
+            memcpy( d, &v, 8 );
+        }
+        break;
+    case 16:
+        for( i = 0; i < count; i++, d += 16, s += 16 ) {
+            uint64_t lo, hi;
+            memcpy( &lo, s, 8 );
+            memcpy( &hi, s + 8, 8 );
+            lo = opal_swap_bytes8( lo );
+            hi = opal_swap_bytes8( hi );
+            memcpy( d, &hi, 8 );
+            memcpy( d + 8, &lo, 8 );
+        }
+        break;
+    default:
+        for( i = 0; i < count; i++, d += size, s += size ) {
+            for( j = 0; j < size; j++ ) {
+                d[size - 1 - j] = s[j];
+            }
+        }
+        break;
+    }
+}
+
+#if defined(VECTOR_SIZE)
+/* Byte shuffles reversing the elements of 2, 4, 8 and 16 bytes of a 16
+ * bytes lane */
+static const uint8_t opal_memcpy_x86_swap_masks[5][16] = {
+    { 0 },
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 },
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 },
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 },
+    { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 },
+};
+#endif  /* defined(VECTOR_SIZE) */
+
+void PREPEND(opal_memcpy_x86_swap)( void *dst, const void *src, size_t size, size_t count )
+{
+    unsigned char *d = (unsigned char*)dst;
+    const unsigned char *s = (const unsigned char*)src;
+#if defined(VECTOR_SIZE)
+    size_t length, mask_idx;
+    vector_t mask, v0, v1;
+
+    switch( size ) {
+    case 2:  mask_idx = 1; break;
+    case 4:  mask_idx = 2; break;
+    case 8:  mask_idx = 3; break;
+    case 16: mask_idx = 4; break;
+    default: mask_idx = 0; break;
+    }
+
+    if( 0 != mask_idx ) {
+        mask = VECTOR_MASK(opal_memcpy_x86_swap_masks[mask_idx]);
+        length = size * count;
+        /* The elements never straddle two vectors as the vector size
+         * is a multiple of the element size */
+        for( ; length >= 2 * VECTOR_SIZE; length -= 2 * VECTOR_SIZE ) {
+            v0 = VECTOR_LOADU(s);
+            v1 = VECTOR_LOADU(s + VECTOR_SIZE);
+            VECTOR_STOREU(d, VECTOR_SHUFFLE(v0, mask));
+            VECTOR_STOREU(d + VECTOR_SIZE, VECTOR_SHUFFLE(v1, mask));
+            d += 2 * VECTOR_SIZE;
+            s += 2 * VECTOR_SIZE;
+        }
+        if( length >= VECTOR_SIZE ) {
+            v0 = VECTOR_LOADU(s);
+            VECTOR_STOREU(d, VECTOR_SHUFFLE(v0, mask));
+            d += VECTOR_SIZE;
+            s += VECTOR_SIZE;
+            length -= VECTOR_SIZE;
+        }
+        count = length / size;
+    }
+#endif  /* defined(VECTOR_SIZE) */
+    opal_memcpy_x86_swap_scalar( d, s, size, count );
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Correctness of MPI_Gather through coll/hier.
+ *
+ * Gathers to every root, with and without MPI_IN_PLACE on the root, so
+ * that the roots which are the leader of their node (where the on-node
+ * gather is done in place in the receive buffer) are covered. Needs
+ * processes on several nodes, with the nodes holding consecutive ranks
+ * and not, e.g.:
+ *
+ *   mpirun -np 8 --map-by ppr:4:node --mca coll_hier_priority 100 ./coll_hier_gather
+ *   mpirun -np 8 --map-by node --mca coll_hier_priority 100 ./coll_hier_gather
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpi.h"
+
+static int rank, size;
+
+static int check_gather(int root, int count, int in_place)
+{
+    int *sbuf, *rbuf, errors = 0;
+
+    sbuf = (int*) malloc(count * sizeof(int));
+    rbuf = (int*) malloc((size_t) size * count * sizeof(int));
+    for (int i = 0 ; i < count ; ++i) {
+        sbuf[i] = rank * count + i;
+    }
+    for (int i = 0 ; i < size * count ; ++i) {
+        rbuf[i] = -1;
+    }
+    if (in_place && rank == root) {
+        memcpy(rbuf + rank * count, sbuf, count * sizeof(int));
+    }
+
+    MPI_Gather((in_place && rank == root) ? MPI_IN_PLACE : sbuf, count, MPI_INT,
+               rbuf, count, MPI_INT, root, MPI_COMM_WORLD);
+
+    if (rank == root) {
+        for (int i = 0 ; i < size * count ; ++i) {
+            if (rbuf[i] != i) {
+                fprintf(stderr, "gather root %d count %d%s: block %d has %d instead of %d\n",
+                        root, count, in_place ? " in place" : "", i / count, rbuf[i], i);
+                ++errors;
+                break;
+            }
+        }
+    }
+
+    free(sbuf);
+    free(rbuf);
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int counts[] = {1, 1000, 100000};
+    int errors = 0, all_errors;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    for (size_t c = 0 ; c < sizeof(counts) / sizeof(counts[0]) ; ++c) {
+        for (int root = 0 ; root < size ; ++root) {
+            errors += check_gather(root, counts[c], 0);
+            errors += check_gather(root, counts[c], 1);
+        }
+    }
+
+    MPI_Reduce(&errors, &all_errors, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (0 == rank) {
+        printf("coll_hier_gather: %s (%d errors)\n", all_errors ? "FAILED" : "OK", all_errors);
+    }
+
+    MPI_Finalize();
+    return (0 == rank && all_errors) ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Bandwidth of on-node bcast and allgather.
+ *
+ * Runs MPI_Bcast and MPI_Allgather for message sizes from -s to -S bytes
+ * (per process for allgather) and prints the average time and the
+ * bandwidth seen by each process. Compare the single copy path of coll/sm
+ * with the shared memory fragments by changing its threshold, e.g.:
+ *
+ *   mpirun -np 8 --mca coll_sm_priority 100 ./coll_sm_bw
+ *   mpirun -np 8 --mca coll_sm_priority 100 --mca coll_sm_single_copy_threshold 0 ./coll_sm_bw
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define MIN_SIZE_DEFAULT 1024
+#define MAX_SIZE_DEFAULT (16 * 1024 * 1024)
+#define NB_ITER          20
+
+static int rank, size;
+static int nb_iter = NB_ITER;
+
+static double bench_bcast(char *buffer, int len)
+{
+    double start, elapsed, max_elapsed;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    for (int iter = 0 ; iter < nb_iter ; ++iter) {
+        MPI_Bcast(buffer, len, MPI_BYTE, iter % size, MPI_COMM_WORLD);
+    }
+    elapsed = (MPI_Wtime() - start) / nb_iter;
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    return max_elapsed;
+}
+
+static double bench_allgather(char *sbuffer, char *rbuffer, int len)
+{
+    double start, elapsed, max_elapsed;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    for (int iter = 0 ; iter < nb_iter ; ++iter) {
+        MPI_Allgather(sbuffer, len, MPI_BYTE, rbuffer, len, MPI_BYTE, MPI_COMM_WORLD);
+    }
+    elapsed = (MPI_Wtime() - start) / nb_iter;
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    return max_elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    int min_size = MIN_SIZE_DEFAULT, max_size = MAX_SIZE_DEFAULT, opt;
+    char *sbuffer, *rbuffer;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    while (-1 != (opt = getopt(argc, argv, "s:S:i:"))) {
+        if ('s' == opt) {
+            min_size = atoi(optarg);
+        } else if ('S' == opt) {
+            max_size = atoi(optarg);
+        } else if ('i' == opt) {
+            nb_iter = atoi(optarg);
+        }
+    }
+
+    sbuffer = malloc(max_size);
+    rbuffer = malloc((size_t) max_size * size);
+    if (NULL == sbuffer || NULL == rbuffer || min_size < 1) {
+        fprintf(stderr, "ERROR: cannot allocate the buffers\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    memset(sbuffer, rank, max_size);
+
+    if (0 == rank) {
+        printf("# time in microseconds, bandwidth in MB/s per process\n");
+        printf("%12s %12s %12s %12s %12s\n", "bytes", "bcast", "bcast_bw",
+               "allgather", "allgather_bw");
+    }
+
+    /* warmup */
+    (void) bench_bcast(sbuffer, max_size);
+    (void) bench_allgather(sbuffer, rbuffer, max_size);
+
+    for (int len = min_size ; len <= max_size ; len *= 2) {
+        double bcast = bench_bcast(sbuffer, len);
+        double allgather = bench_allgather(sbuffer, rbuffer, len);
+        if (0 == rank) {
+            printf("%12d %12.1f %12.1f %12.1f %12.1f\n", len,
+                   bcast * 1e6, len / bcast / 1e6,
+                   allgather * 1e6, (double) len * (size - 1) / allgather / 1e6);
+        }
+    }
+
+    free(sbuffer);
+    free(rbuffer);
+
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
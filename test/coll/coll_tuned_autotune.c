@@ -0,0 +1,516 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Offline autotuner for the dynamic rules of coll/tuned.
+ *
+ * For each collective, communicator size and message size, times every
+ * algorithm coll/tuned can force (the algorithms of coll/base), with
+ * each of the given fan in/outs and segment sizes, picks the fastest,
+ * locates the crossover points between the consecutive winners and
+ * writes a rules file for coll_tuned_dynamic_rules_filename.  The
+ * algorithms are forced through the MPI_T control variables of
+ * coll/tuned on communicators created afterward, so the tuned component
+ * has to be selected with the dynamic rules enabled and no rules file:
+ *
+ *   mpirun -np 64 --mca coll_tuned_use_dynamic_rules 1 \
+ *       ./coll_tuned_autotune -o rules.conf
+ *   mpirun -np 64 --mca coll_tuned_use_dynamic_rules 1 \
+ *       --mca coll_tuned_dynamic_rules_filename rules.conf ./app
+ *
+ * Options:
+ *   -o file    output rules file (stdout by default)
+ *   -c list    comma separated collectives (all by default)
+ *   -p list    comma separated communicator sizes (powers of two and
+ *              the size of MPI_COMM_WORLD by default)
+ *   -s/-S n    smallest and largest message size in bytes, as defined
+ *              by the rules (total size for the gather/scatter family)
+ *   -f list    fan in/outs tried with each algorithm (default 2,4)
+ *   -g list    segment sizes tried with each algorithm (default 0,8192,65536)
+ *   -i n       iterations per measure (fewer for the large messages)
+ *   -t pct     a winner keeps its place until another algorithm is
+ *              faster by more than pct percent (default 5)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define MIN_SIZE_DEFAULT 8
+#define MAX_SIZE_DEFAULT (4 * 1024 * 1024)
+#define NB_ITER          10
+#define MAX_LIST         32
+#define MAX_SIZES        64
+
+/* How the message size of the rules is computed from the arguments of
+ * each collective (see coll_tuned_decision_dynamic.c) */
+enum {
+    TUNE_SIZE_TOTAL,      /* count * datatype size */
+    TUNE_SIZE_PER_PEER,   /* count per peer * datatype size * comm size */
+    TUNE_SIZE_NONE        /* the rules only depend on the comm size */
+};
+
+typedef struct {
+    const char *name;
+    int id;               /* COLLTYPE in ompi/mca/coll/base/coll_base_functions.h */
+    int size_kind;
+} tune_coll_t;
+
+static const tune_coll_t tune_colls[] = {
+    { "allgather",            0, TUNE_SIZE_PER_PEER },
+    { "allgatherv",           1, TUNE_SIZE_PER_PEER },
+    { "allreduce",            2, TUNE_SIZE_TOTAL },
+    { "alltoall",             3, TUNE_SIZE_PER_PEER },
+    { "alltoallv",            4, TUNE_SIZE_NONE },
+    { "barrier",              6, TUNE_SIZE_NONE },
+    { "bcast",                7, TUNE_SIZE_TOTAL },
+    { "exscan",               8, TUNE_SIZE_NONE },
+    { "gather",               9, TUNE_SIZE_PER_PEER },
+    { "reduce",              11, TUNE_SIZE_TOTAL },
+    { "reduce_scatter",      12, TUNE_SIZE_TOTAL },
+    { "reduce_scatter_block", 13, TUNE_SIZE_PER_PEER },
+    { "scan",                14, TUNE_SIZE_NONE },
+    { "scatter",             15, TUNE_SIZE_PER_PEER },
+};
+#define NB_COLLS ((int)(sizeof(tune_colls) / sizeof(tune_colls[0])))
+
+/* Message size used to rank the algorithms of the collectives whose
+ * rules do not depend on the message size */
+#define SIZE_NONE_MSG 4096
+
+typedef struct {
+    int alg, fanout, segsize;
+} tune_variant_t;
+
+typedef struct {
+    size_t msg_size;
+    tune_variant_t variant;
+} tune_rule_t;
+
+static int rank, world_size;
+static int nb_iter = NB_ITER;
+static int *counts, *displs;
+
+static int parse_list(const char *str, int *list)
+{
+    int n = 0;
+    char *copy = strdup(str), *tok, *save = NULL;
+
+    for (tok = strtok_r(copy, ",", &save); NULL != tok && n < MAX_LIST;
+         tok = strtok_r(NULL, ",", &save)) {
+        list[n++] = atoi(tok);
+    }
+    free(copy);
+    return n;
+}
+
+static int set_cvar(const char *name, int value)
+{
+    MPI_T_cvar_handle handle;
+    int index, count, rc;
+
+    rc = MPI_T_cvar_get_index(name, &index);
+    if (MPI_SUCCESS != rc) {
+        return rc;
+    }
+    rc = MPI_T_cvar_handle_alloc(index, NULL, &handle, &count);
+    if (MPI_SUCCESS != rc) {
+        return rc;
+    }
+    rc = MPI_T_cvar_write(handle, &value);
+    MPI_T_cvar_handle_free(&handle);
+    return rc;
+}
+
+static int get_cvar(const char *name, int *value)
+{
+    MPI_T_cvar_handle handle;
+    int index, count, rc;
+
+    rc = MPI_T_cvar_get_index(name, &index);
+    if (MPI_SUCCESS != rc) {
+        return rc;
+    }
+    rc = MPI_T_cvar_handle_alloc(index, NULL, &handle, &count);
+    if (MPI_SUCCESS != rc) {
+        return rc;
+    }
+    rc = MPI_T_cvar_read(handle, value);
+    MPI_T_cvar_handle_free(&handle);
+    return rc;
+}
+
+static int has_cvar(const char *name)
+{
+    int index;
+    return MPI_SUCCESS == MPI_T_cvar_get_index(name, &index);
+}
+
+/*
+ * Number of algorithms of a collective, from the enumerator of its
+ * algorithm variable (the first one, "ignore", is the fixed decision).
+ */
+static int get_algorithms(const tune_coll_t *coll, char names[][64])
+{
+    char name[256], desc[256];
+    int index, nlen, dlen, verbosity, bind, scope, num, value, i;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm", coll->name);
+    if (MPI_SUCCESS != MPI_T_cvar_get_index(name, &index)) {
+        return 0;
+    }
+    nlen = sizeof(name);
+    dlen = sizeof(desc);
+    if (MPI_SUCCESS != MPI_T_cvar_get_info(index, name, &nlen, &verbosity, &datatype,
+                                           &enumtype, desc, &dlen, &bind, &scope) ||
+        MPI_T_ENUM_NULL == enumtype) {
+        return 0;
+    }
+    nlen = sizeof(name);
+    MPI_T_enum_get_info(enumtype, &num, name, &nlen);
+    for (i = 0; i < num && i < MAX_LIST; i++) {
+        nlen = 64;
+        MPI_T_enum_get_item(enumtype, i, &value, names[i], &nlen);
+    }
+    return num < MAX_LIST ? num : MAX_LIST;
+}
+
+static void force_variant(const tune_coll_t *coll, const tune_variant_t *variant)
+{
+    char name[256];
+
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm", coll->name);
+    set_cvar(name, variant->alg);
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_segmentsize", coll->name);
+    set_cvar(name, variant->segsize);
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_tree_fanout", coll->name);
+    set_cvar(name, variant->fanout);
+    snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_chain_fanout", coll->name);
+    set_cvar(name, variant->fanout);
+}
+
+static int run_coll(const tune_coll_t *coll, MPI_Comm comm, int p, size_t msg,
+                    char *sbuf, char *rbuf)
+{
+    int n = (int)(msg / p), c = (int)(msg / sizeof(int)), i;
+
+    switch (coll->id) {
+    case 0:
+        return MPI_Allgather(sbuf, n, MPI_BYTE, rbuf, n, MPI_BYTE, comm);
+    case 1:
+        for (i = 0; i < p; i++) {
+            counts[i] = n;
+            displs[i] = i * n;
+        }
+        return MPI_Allgatherv(sbuf, n, MPI_BYTE, rbuf, counts, displs, MPI_BYTE, comm);
+    case 2:
+        return MPI_Allreduce(sbuf, rbuf, c, MPI_INT, MPI_SUM, comm);
+    case 3:
+        return MPI_Alltoall(sbuf, n, MPI_BYTE, rbuf, n, MPI_BYTE, comm);
+    case 4:
+        for (i = 0; i < p; i++) {
+            counts[i] = n;
+            displs[i] = i * n;
+        }
+        return MPI_Alltoallv(sbuf, counts, displs, MPI_BYTE, rbuf, counts, displs, MPI_BYTE, comm);
+    case 6:
+        return MPI_Barrier(comm);
+    case 7:
+        return MPI_Bcast(sbuf, (int)msg, MPI_BYTE, 0, comm);
+    case 8:
+        return MPI_Exscan(sbuf, rbuf, c, MPI_INT, MPI_SUM, comm);
+    case 9:
+        return MPI_Gather(sbuf, n, MPI_BYTE, rbuf, n, MPI_BYTE, 0, comm);
+    case 11:
+        return MPI_Reduce(sbuf, rbuf, c, MPI_INT, MPI_SUM, 0, comm);
+    case 12:
+        for (i = 0; i < p; i++) {
+            counts[i] = c / p + (0 == i ? c % p : 0);
+        }
+        return MPI_Reduce_scatter(sbuf, rbuf, counts, MPI_INT, MPI_SUM, comm);
+    case 13:
+        return MPI_Reduce_scatter_block(sbuf, rbuf, c / p, MPI_INT, MPI_SUM, comm);
+    case 14:
+        return MPI_Scan(sbuf, rbuf, c, MPI_INT, MPI_SUM, comm);
+    case 15:
+        return MPI_Scatter(sbuf, n, MPI_BYTE, rbuf, n, MPI_BYTE, 0, comm);
+    }
+    return MPI_ERR_OTHER;
+}
+
+/*
+ * Average time of the collective, the slowest process deciding, or a
+ * negative value if the algorithm failed on any process.
+ */
+static double time_coll(const tune_coll_t *coll, MPI_Comm comm, int p, size_t msg,
+                        char *sbuf, char *rbuf)
+{
+    double local[2], global[2], start;
+    int iters = nb_iter, rc, iter;
+
+    if (msg > 64 * 1024) {
+        iters = (int)((double)nb_iter * 64 * 1024 / msg);
+        if (iters < 2) iters = 2;
+    }
+    rc = run_coll(coll, comm, p, msg, sbuf, rbuf);  /* warmup */
+    MPI_Barrier(comm);
+    start = MPI_Wtime();
+    for (iter = 0; iter < iters && MPI_SUCCESS == rc; iter++) {
+        rc = run_coll(coll, comm, p, msg, sbuf, rbuf);
+    }
+    local[0] = (MPI_Wtime() - start) / iters;
+    local[1] = (MPI_SUCCESS == rc) ? 0.0 : 1.0;
+    MPI_Allreduce(local, global, 2, MPI_DOUBLE, MPI_MAX, comm);
+    return (0.0 != global[1]) ? -1.0 : global[0];
+}
+
+/*
+ * Message size where the time of next becomes lower than the time of
+ * current, interpolated between the two measured sizes (log scale).
+ */
+static size_t crossover(size_t prev_size, double prev_current, double prev_next,
+                        size_t size, double current, double next)
+{
+    double d0 = prev_next - prev_current, d1 = next - current, x;
+
+    if (d0 <= 0.0 || d1 >= 0.0 || 0 == prev_size) {
+        return size;
+    }
+    x = d0 / (d0 - d1);
+    return (size_t)(prev_size * pow((double)size / prev_size, x) + 0.5);
+}
+
+/*
+ * Build the rules of one communicator size from the measures: the best
+ * variant at the first message size applies from 0, and is replaced
+ * when another one is faster by more than the threshold.
+ */
+static int build_rules(double *times, int nb_sizes, int nb_variants, const size_t *sizes,
+                       const tune_variant_t *variants, double threshold, tune_rule_t *rules)
+{
+    int s, v, best, current = -1, nb_rules = 0;
+
+    for (s = 0; s < nb_sizes; s++) {
+        double *t = times + (size_t)s * nb_variants;
+        for (best = -1, v = 0; v < nb_variants; v++) {
+            if (t[v] >= 0.0 && (best < 0 || t[v] < t[best])) {
+                best = v;
+            }
+        }
+        if (best < 0) {
+            continue;  /* no algorithm could run this size */
+        }
+        if (current >= 0 && t[current] >= 0.0 && t[current] <= (1.0 + threshold) * t[best]) {
+            continue;
+        }
+        rules[nb_rules].variant = variants[best];
+        if (current < 0) {
+            rules[nb_rules].msg_size = 0;
+        } else {
+            double *pt = times + (size_t)(s - 1) * nb_variants;
+            rules[nb_rules].msg_size = crossover(sizes[s - 1], pt[current], pt[best],
+                                                 sizes[s], t[current], t[best]);
+        }
+        current = best;
+        nb_rules++;
+    }
+    return nb_rules;
+}
+
+int main(int argc, char *argv[])
+{
+    int fanouts[MAX_LIST] = { 2, 4 }, segsizes[MAX_LIST] = { 0, 8192, 65536 };
+    int comm_sizes[MAX_LIST], nb_fanouts = 2, nb_segsizes = 3, nb_comm_sizes = 0;
+    int selected[NB_COLLS], nb_selected = 0, provided, opt, c, i, dynamic = 0;
+    size_t min_size = MIN_SIZE_DEFAULT, max_size = MAX_SIZE_DEFAULT, sizes[MAX_SIZES];
+    double threshold = 0.05;
+    char *output = NULL, *sbuf, *rbuf;
+    FILE *out = stdout;
+
+    MPI_Init(&argc, &argv);
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &world_size);
+
+    for (c = 0; c < NB_COLLS; c++) {
+        selected[c] = 1;
+    }
+    while (-1 != (opt = getopt(argc, argv, "o:c:p:s:S:f:g:i:t:"))) {
+        switch (opt) {
+        case 'o': output = optarg; break;
+        case 'c': {
+            char *list = malloc(strlen(optarg) + 3), pattern[64];
+            sprintf(list, ",%s,", optarg);
+            for (c = 0; c < NB_COLLS; c++) {
+                snprintf(pattern, sizeof(pattern), ",%s,", tune_colls[c].name);
+                selected[c] = (NULL != strstr(list, pattern));
+            }
+            free(list);
+            break;
+        }
+        case 'p': nb_comm_sizes = parse_list(optarg, comm_sizes); break;
+        case 's': min_size = strtoul(optarg, NULL, 0); break;
+        case 'S': max_size = strtoul(optarg, NULL, 0); break;
+        case 'f': nb_fanouts = parse_list(optarg, fanouts); break;
+        case 'g': nb_segsizes = parse_list(optarg, segsizes); break;
+        case 'i': nb_iter = atoi(optarg); break;
+        case 't': threshold = atof(optarg) / 100.0; break;
+        }
+    }
+    if (0 == nb_comm_sizes) {
+        for (i = 2; i < world_size && nb_comm_sizes < MAX_LIST - 1; i *= 2) {
+            comm_sizes[nb_comm_sizes++] = i;
+        }
+        comm_sizes[nb_comm_sizes++] = world_size;
+    }
+    if (min_size < 1) min_size = 1;
+    if (max_size < SIZE_NONE_MSG) max_size = SIZE_NONE_MSG;
+
+    if (MPI_SUCCESS != get_cvar("coll_tuned_use_dynamic_rules", &dynamic) || !dynamic) {
+        if (0 == rank) {
+            fprintf(stderr, "ERROR: coll/tuned must be used with coll_tuned_use_dynamic_rules set to 1\n");
+        }
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    sbuf = malloc(max_size);
+    rbuf = malloc(max_size);
+    counts = malloc(world_size * sizeof(int));
+    displs = malloc(world_size * sizeof(int));
+    if (NULL == sbuf || NULL == rbuf || NULL == counts || NULL == displs) {
+        fprintf(stderr, "ERROR: cannot allocate the buffers\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    memset(sbuf, 1, max_size);
+
+    if (0 == rank && NULL != output) {
+        out = fopen(output, "w");
+        if (NULL == out) {
+            fprintf(stderr, "ERROR: cannot open %s\n", output);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    for (c = 0; c < NB_COLLS; c++) {
+        nb_selected += selected[c];
+    }
+    if (0 == rank) {
+        time_t now = time(NULL);
+        fprintf(out, "# coll/tuned dynamic rules generated by coll_tuned_autotune on %s", ctime(&now));
+        fprintf(out, "# %d processes, message sizes %zu to %zu bytes\n", world_size, min_size, max_size);
+        fprintf(out, "%d # number of collectives\n", nb_selected);
+    }
+
+    for (c = 0; c < NB_COLLS; c++) {
+        const tune_coll_t *coll = &tune_colls[c];
+        char names[MAX_LIST][64], name[256];
+        tune_variant_t variants[MAX_LIST * MAX_LIST * MAX_LIST / 8];
+        int nb_algs, nb_variants = 0, nb_sizes, a, f, g, p, has_fanout, has_segsize;
+
+        if (!selected[c]) continue;
+        nb_algs = get_algorithms(coll, names);
+        snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_tree_fanout", coll->name);
+        has_fanout = has_cvar(name);
+        snprintf(name, sizeof(name), "coll_tuned_%s_algorithm_segmentsize", coll->name);
+        has_segsize = has_cvar(name);
+        for (a = 1; a < nb_algs; a++) {
+            for (f = 0; f < (has_fanout ? nb_fanouts : 1); f++) {
+                for (g = 0; g < (has_segsize ? nb_segsizes : 1); g++) {
+                    if (nb_variants == (int)(sizeof(variants) / sizeof(variants[0]))) break;
+                    variants[nb_variants].alg = a;
+                    variants[nb_variants].fanout = has_fanout ? fanouts[f] : 0;
+                    variants[nb_variants].segsize = has_segsize ? segsizes[g] : 0;
+                    nb_variants++;
+                }
+            }
+        }
+
+        nb_sizes = 0;
+        if (TUNE_SIZE_NONE == coll->size_kind) {
+            sizes[nb_sizes++] = SIZE_NONE_MSG;
+        } else {
+            for (size_t s = min_size; s <= max_size && nb_sizes < MAX_SIZES; s *= 2) {
+                sizes[nb_sizes++] = s;
+            }
+        }
+
+        if (0 == rank) {
+            fprintf(out, "%d # collective id (%s)\n", coll->id, coll->name);
+            fprintf(out, "%d # number of communicator sizes\n", nb_comm_sizes);
+        }
+
+        for (p = 0; p < nb_comm_sizes; p++) {
+            int comm_size = comm_sizes[p], s, v, nb_rules = 0;
+            double *times = malloc((size_t)nb_sizes * nb_variants * sizeof(double));
+            tune_rule_t rules[MAX_SIZES];
+
+            for (v = 0; v < nb_variants; v++) {
+                MPI_Comm comm;
+
+                /* the tuned module reads the forced values when enabled on a new communicator */
+                force_variant(coll, &variants[v]);
+                MPI_Comm_split(MPI_COMM_WORLD, rank < comm_size ? 0 : MPI_UNDEFINED, rank, &comm);
+                if (MPI_COMM_NULL != comm) {
+                    MPI_Comm_set_errhandler(comm, MPI_ERRORS_RETURN);
+                    for (s = 0; s < nb_sizes; s++) {
+                        double *t = &times[(size_t)s * nb_variants + v];
+                        *t = -1.0;
+                        if (TUNE_SIZE_PER_PEER == coll->size_kind && sizes[s] < (size_t)comm_size) {
+                            continue;  /* less than a byte per process */
+                        }
+                        if (variants[v].segsize > 0 && (size_t)variants[v].segsize >= sizes[s]) {
+                            continue;  /* same as without segmentation */
+                        }
+                        *t = time_coll(coll, comm, comm_size, sizes[s], sbuf, rbuf);
+                    }
+                    MPI_Comm_free(&comm);
+                }
+            }
+            force_variant(coll, &(tune_variant_t){ 0, fanouts[0], 0 });
+
+            if (0 == rank) {
+                nb_rules = build_rules(times, nb_sizes, nb_variants, sizes, variants,
+                                       threshold, rules);
+                if (0 == nb_rules) {  /* nothing ran, keep the fixed decision */
+                    rules[0].msg_size = 0;
+                    rules[0].variant = (tune_variant_t){ 0, 0, 0 };
+                    nb_rules = 1;
+                }
+                fprintf(out, "%d # communicator size\n", comm_size);
+                fprintf(out, "%d # number of message sizes\n", nb_rules);
+                for (i = 0; i < nb_rules; i++) {
+                    const tune_variant_t *w = &rules[i].variant;
+                    fprintf(out, "%zu %d %d %d # from %zu bytes: %s, fan in/out %d, segment size %d\n",
+                            rules[i].msg_size, w->alg, w->fanout, w->segsize, rules[i].msg_size,
+                            w->alg < nb_algs ? names[w->alg] : "?", w->fanout, w->segsize);
+                }
+                fflush(out);
+            }
+            free(times);
+        }
+    }
+    if (0 == rank && stdout != out) {
+        fclose(out);
+    }
+
+    free(sbuf);
+    free(rbuf);
+    free(counts);
+    free(displs);
+    MPI_T_finalize();
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
@@ -21,7 +21,7 @@ verbose=0
 
 echo "=========Signed Integer type all operations & all sizes========"
 echo ""
-for op in max min sum prod band bor bxor; do
+for op in max min sum prod band bor bxor land lor lxor; do
     echo -e "\n===Operation  $op test==="
     for type_size in 8 16 32 64; do
         for size in 0 1 7 15 31 63 127 130; do
@@ -79,3 +79,30 @@ for op in max min sum prod; do
     done
 done
 
+echo "========Complex types SUM and PROD========="
+echo ""
+for op in sum prod; do
+    for type_size in 32 64; do
+        for size in 1024 127 130; do
+            foo=$((1024 * 1024 + $size))
+            echo -e "Test $Yellow __mm512 instruction for loop $NC Total_num_bits = $foo * 2 * $type_size"
+            cmd="$mpirun -np 1 reduce_local -l $foo -u $foo -t c -s $type_size -o $op"
+            if test $verbose -eq 1 ; then echo $cmd; fi
+            eval $cmd
+        done
+    done
+done
+
+echo "========Pair types MINLOC and MAXLOC========="
+echo ""
+for op in maxloc minloc; do
+    for type in i f d; do
+        for size in 1024 127 130; do
+            foo=$((1024 * 1024 + $size))
+            echo -e "Test $Yellow __mm512 instruction for loop $NC Total_num_pairs = $foo"
+            cmd="$mpirun -np 1 reduce_local -l $foo -u $foo -t $type -s 32 -o $op"
+            if test $verbose -eq 1 ; then echo $cmd; fi
+            eval $cmd
+        done
+    done
+done
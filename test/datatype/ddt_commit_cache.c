@@ -0,0 +1,236 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Create, commit and free the same datatypes over and over, with and
+ * without the commit cache (mpi_ddt_commit_cache_size), check that the
+ * datatypes committed from the cache have the same optimized
+ * description and pack the same data, and compare the time spent.
+ * For small datatypes, also compare the cost of the cache lookup
+ * (building and hashing the packed description of the arguments) to
+ * the cost of the commit it saves.
+ */
+
+#include "ompi_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "mpi.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/class/opal_hash_table.h"
+#include "opal/datatype/opal_datatype_internal.h"
+
+#define NUM_BLOCKS 4096
+#define REPEATS    100
+#define SMALL_REPEATS 10000
+
+static int displs[NUM_BLOCKS], blocklens[NUM_BLOCKS];
+
+static double get_time(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static MPI_Datatype create_type(int which)
+{
+    int sizes[3] = { 32, 24, 16 }, subsizes[3] = { 8, 12, 4 }, starts[3] = { 1, 2, 3 };
+    MPI_Datatype vector, type;
+
+    switch (which) {
+    case 0:
+        MPI_Type_vector(1000, 3, 7, MPI_INT, &type);
+        break;
+    case 1:
+        MPI_Type_indexed(NUM_BLOCKS, blocklens, displs, MPI_DOUBLE, &type);
+        break;
+    case 2:
+        MPI_Type_create_subarray(3, sizes, subsizes, starts, MPI_ORDER_C, MPI_FLOAT, &type);
+        break;
+    default:
+        MPI_Type_vector(10, 2, 4, MPI_SHORT, &vector);
+        MPI_Type_create_resized(vector, 0, 100, &type);
+        MPI_Type_free(&vector);
+        break;
+    }
+    MPI_Type_commit(&type);
+    return type;
+}
+#define NUM_TYPES 4
+
+/* Small datatypes, for which the lookup must stay cheaper than the commit */
+static MPI_Datatype build_small_type(int which)
+{
+    int lens[2] = { 2, 3 }, disps[2] = { 0, 5 };
+    MPI_Aint sdisps[2] = { 0, 8 };
+    MPI_Datatype types[2] = { MPI_INT, MPI_DOUBLE }, type;
+
+    switch (which) {
+    case 0:
+        MPI_Type_contiguous(4, MPI_INT, &type);
+        break;
+    case 1:
+        MPI_Type_vector(2, 1, 3, MPI_INT, &type);
+        break;
+    case 2:
+        MPI_Type_indexed(2, lens, disps, MPI_FLOAT, &type);
+        break;
+    default:
+        MPI_Type_create_struct(2, lens, sdisps, types, &type);
+        break;
+    }
+    return type;
+}
+#define NUM_SMALL_TYPES 4
+
+/*
+ * Time spent building and hashing the key of the cache, and time spent
+ * in the commit, on newly built (uncommitted) datatypes.
+ */
+static void time_small_type(int which, opal_hash_table_t *table,
+                            double *key_time, double *commit_time)
+{
+    MPI_Datatype type;
+    const void *key;
+    void *value;
+    double start;
+    int i;
+
+    *key_time = *commit_time = 0.0;
+    for (i = 0; i < SMALL_REPEATS; i++) {
+        type = build_small_type(which);
+        start = MPI_Wtime();
+        ompi_datatype_get_pack_description(type, &key);
+        (void) opal_hash_table_get_value_ptr(table, key,
+                                             ompi_datatype_pack_description_length(type),
+                                             &value);
+        *key_time += MPI_Wtime() - start;
+        MPI_Type_free(&type);
+
+        type = build_small_type(which);
+        start = MPI_Wtime();
+        opal_datatype_commit(&type->super);
+        *commit_time += MPI_Wtime() - start;
+        MPI_Type_free(&type);
+    }
+}
+
+static int compare_types(MPI_Datatype a, MPI_Datatype b)
+{
+    const opal_datatype_t *da = &a->super, *db = &b->super;
+
+    if (da->opt_desc.used != db->opt_desc.used ||
+        0 != memcmp(da->opt_desc.desc, db->opt_desc.desc,
+                    (da->opt_desc.used + 1) * sizeof(dt_elem_desc_t))) {
+        return 1;
+    }
+    if ((NULL == da->strided) != (NULL == db->strided)) {
+        return 1;
+    }
+    return 0;
+}
+
+static int compare_pack(MPI_Datatype a, MPI_Datatype b)
+{
+    MPI_Aint lb, extent;
+    int size, pa = 0, pb = 0, rc;
+    char *buf, *packa, *packb;
+    size_t i;
+
+    MPI_Type_get_extent(a, &lb, &extent);
+    MPI_Type_size(a, &size);
+    buf = malloc(lb + extent);
+    packa = malloc(size);
+    packb = malloc(size);
+    for (i = 0; i < (size_t)(lb + extent); i++) {
+        buf[i] = (char)i;
+    }
+    MPI_Pack(buf, 1, a, packa, size, &pa, MPI_COMM_SELF);
+    MPI_Pack(buf, 1, b, packb, size, &pb, MPI_COMM_SELF);
+    rc = (pa != pb) || (0 != memcmp(packa, packb, size));
+    free(buf); free(packa); free(packb);
+    return rc;
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Datatype reference, cached, type;
+    int cache_size, errors = 0, i, t;
+    double uncached_time, cached_time;
+
+    MPI_Init(&argc, &argv);
+
+    for (i = 0; i < NUM_BLOCKS; i++) {
+        blocklens[i] = 1 + (i % 3);
+        displs[i] = 5 * i + (i % 2);
+    }
+    cache_size = ompi_datatype_commit_cache_size;
+    if (0 >= cache_size) {
+        cache_size = 64;
+    }
+
+    for (t = 0; t < NUM_TYPES; t++) {
+        /* Reference commit, without the cache */
+        ompi_datatype_commit_cache_size = 0;
+        reference = create_type(t);
+        uncached_time = get_time();
+        for (i = 0; i < REPEATS; i++) {
+            type = create_type(t);
+            MPI_Type_free(&type);
+        }
+        uncached_time = get_time() - uncached_time;
+
+        /* The first commit fills the cache, the next ones hit it */
+        ompi_datatype_commit_cache_size = cache_size;
+        type = create_type(t);
+        cached = create_type(t);
+        cached_time = get_time();
+        for (i = 0; i < REPEATS; i++) {
+            MPI_Datatype temp = create_type(t);
+            MPI_Type_free(&temp);
+        }
+        cached_time = get_time() - cached_time;
+
+        if (compare_types(reference, cached) || compare_pack(reference, cached)) {
+            printf("type %d: the cached commit differs from the reference\n", t);
+            errors++;
+        }
+        printf("type %d: %8.2f us per create+commit+free without the cache, %8.2f us with\n",
+               t, 1e6 * uncached_time / REPEATS, 1e6 * cached_time / REPEATS);
+
+        MPI_Type_free(&reference);
+        MPI_Type_free(&cached);
+        MPI_Type_free(&type);
+    }
+
+    /* The timings are only reported: too noisy to fail the test */
+    {
+        opal_hash_table_t table;
+        double key_time, commit_time;
+
+        OBJ_CONSTRUCT(&table, opal_hash_table_t);
+        opal_hash_table_init(&table, 64);
+        for (t = 0; t < NUM_SMALL_TYPES; t++) {
+            time_small_type(t, &table, &key_time, &commit_time);
+            printf("small type %d: %8.3f us to build and hash the key, %8.3f us to commit%s\n",
+                   t, 1e6 * key_time / SMALL_REPEATS, 1e6 * commit_time / SMALL_REPEATS,
+                   (key_time < commit_time) ? "" : " (the lookup is not cheaper)");
+        }
+        OBJ_DESTRUCT(&table);
+    }
+
+    MPI_Finalize();
+    printf("Found %d errors\n", errors);
+    return (0 == errors) ? 0 : -1;
+}
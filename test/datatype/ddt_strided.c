@@ -0,0 +1,237 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+#include "ompi_config.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "opal/datatype/opal_convertor.h"
+#include "opal/datatype/opal_datatype_strided.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "opal/runtime/opal.h"
+
+/**
+ * Check the specialized pack and unpack functions of the strided
+ * datatypes against the generic ones.  The data is packed and unpacked
+ * in odd sized fragments spread over several iovecs, and the unpack
+ * goes through the fragments backward to exercise the positioning.
+ */
+
+#define NUM_IOVS 3
+#define MAX_FRAGMENT (1 << 20)
+
+static int fragment_sizes[] = { 1, 7, 113, 4096, MAX_FRAGMENT };
+
+static void
+pack_fragments( ompi_datatype_t* datatype, int count, void* buffer,
+                unsigned char* packed, size_t fragment, bool strided )
+{
+    opal_convertor_t* convertor;
+    struct iovec iov[NUM_IOVS];
+    size_t max_data, position = 0, total;
+    uint32_t iov_count, i;
+
+    opal_ddt_strided_pack = strided;
+    convertor = opal_convertor_create( opal_local_arch, 0 );
+    opal_convertor_prepare_for_send( convertor, &(datatype->super), count, buffer );
+    opal_convertor_get_packed_size( convertor, &total );
+
+    while( position < total ) {
+        for( i = 0; i < NUM_IOVS; i++ ) {
+            iov[i].iov_base = packed + position + i * fragment;
+            iov[i].iov_len = fragment;
+        }
+        iov_count = NUM_IOVS;
+        max_data = NUM_IOVS * fragment;
+        opal_convertor_pack( convertor, iov, &iov_count, &max_data );
+        position += max_data;
+    }
+    OBJ_RELEASE(convertor);
+}
+
+static void
+unpack_fragments( ompi_datatype_t* datatype, int count, void* buffer,
+                  unsigned char* packed, size_t fragment, bool strided )
+{
+    opal_convertor_t* convertor;
+    struct iovec iov;
+    size_t max_data, position, total;
+    uint32_t iov_count;
+
+    opal_ddt_strided_pack = strided;
+    convertor = opal_convertor_create( opal_local_arch, 0 );
+    opal_convertor_prepare_for_recv( convertor, &(datatype->super), count, buffer );
+    opal_convertor_get_packed_size( convertor, &total );
+
+    for( position = ((total - 1) / fragment) * fragment; ; position -= fragment ) {
+        size_t current = position;
+        opal_convertor_set_position( convertor, &current );
+        iov.iov_base = packed + position;
+        iov.iov_len = (total - position) < fragment ? (total - position) : fragment;
+        iov_count = 1;
+        max_data = iov.iov_len;
+        opal_convertor_unpack( convertor, &iov, &iov_count, &max_data );
+        if( 0 == position ) break;
+    }
+    OBJ_RELEASE(convertor);
+}
+
+/* Gather the raw description of the data from position on */
+static int
+check_raw( const char* name, ompi_datatype_t* datatype, int count, void* buffer,
+           unsigned char* reference, size_t position )
+{
+    opal_convertor_t* convertor;
+    struct iovec iov[NUM_IOVS];
+    size_t length, total, current = position;
+    uint32_t iov_count, i;
+    int done = 0, errors = 0;
+
+    convertor = opal_convertor_create( opal_local_arch, 0 );
+    opal_convertor_prepare_for_send( convertor, &(datatype->super), count, buffer );
+    opal_convertor_get_packed_size( convertor, &total );
+    if( position >= total ) {
+        OBJ_RELEASE(convertor);
+        return 0;
+    }
+    opal_convertor_set_position( convertor, &current );
+    while( !done ) {
+        iov_count = NUM_IOVS;
+        done = opal_convertor_raw( convertor, iov, &iov_count, &length );
+        for( i = 0; i < iov_count; i++ ) {
+            if( (current + iov[i].iov_len > total) ||
+                (0 != memcmp(reference + current, iov[i].iov_base, iov[i].iov_len)) ) {
+                errors++;
+                break;
+            }
+            current += iov[i].iov_len;
+        }
+        if( errors ) break;
+    }
+    if( (0 == errors) && (current != total) ) {
+        errors++;
+    }
+    if( errors ) {
+        printf("%s: raw description differs from position %zu\n", name, position);
+    }
+    OBJ_RELEASE(convertor);
+    return errors;
+}
+
+static int
+check_datatype( const char* name, ompi_datatype_t* datatype, int count, bool expect_strided )
+{
+    unsigned char *user, *packed, *reference, *recv, *recv_reference;
+    ptrdiff_t lb, extent;
+    size_t size, length, f;
+    int errors = 0;
+
+    if( expect_strided != (NULL != datatype->super.strided) ) {
+        printf("%s: the strided layout is %s\n", name,
+               expect_strided ? "missing" : "unexpected");
+        errors++;
+    }
+
+    ompi_datatype_get_extent( datatype, &lb, &extent );
+    ompi_datatype_type_size( datatype, &size );
+    length = lb + extent * count;
+    size *= count;
+
+    user = (unsigned char*)malloc(length);
+    recv = (unsigned char*)malloc(length);
+    recv_reference = (unsigned char*)malloc(length);
+    packed = (unsigned char*)malloc(size + NUM_IOVS * MAX_FRAGMENT);
+    reference = (unsigned char*)malloc(size + NUM_IOVS * MAX_FRAGMENT);
+    for( f = 0; f < length; f++ ) {
+        user[f] = (unsigned char)(f % 251);
+    }
+
+    for( f = 0; f < sizeof(fragment_sizes) / sizeof(fragment_sizes[0]); f++ ) {
+        pack_fragments( datatype, count, user, reference, fragment_sizes[f], false );
+        pack_fragments( datatype, count, user, packed, fragment_sizes[f], true );
+        if( 0 != memcmp(packed, reference, size) ) {
+            printf("%s: pack differs with fragments of %d bytes\n", name, fragment_sizes[f]);
+            errors++;
+        }
+
+        memset( recv_reference, 0xff, length );
+        memset( recv, 0xff, length );
+        unpack_fragments( datatype, count, recv_reference, reference, fragment_sizes[f], false );
+        unpack_fragments( datatype, count, recv, reference, fragment_sizes[f], true );
+        if( 0 != memcmp(recv, recv_reference, length) ) {
+            printf("%s: unpack differs with fragments of %d bytes\n", name, fragment_sizes[f]);
+            errors++;
+        }
+    }
+    opal_ddt_strided_pack = true;
+
+    /* the raw description of a strided convertor only depends on its position */
+    errors += check_raw( name, datatype, count, user, reference, 0 );
+    errors += check_raw( name, datatype, count, user, reference, 13 );
+    errors += check_raw( name, datatype, count, user, reference, size / 2 );
+
+    free(user); free(recv); free(recv_reference);
+    free(packed); free(reference);
+    printf("%s (count %d): %s\n", name, count, (0 == errors) ? "ok" : "failed");
+    return errors;
+}
+
+int main( int argc, char* argv[] )
+{
+    ompi_datatype_t *vector, *hvector, *triple, *vector3, *subarray2d, *subarray3d, *types[2], *structure;
+    int sizes[3] = { 17, 13, 11 }, subsizes[3] = { 5, 7, 3 }, starts[3] = { 2, 3, 4 };
+    int blocklens[2] = { 1, 1 }, errors = 0, count;
+    ptrdiff_t disps[2] = { 0, 12 };
+
+    opal_init_util (NULL, NULL);
+    ompi_datatype_init();
+
+    ompi_datatype_create_vector( 1000, 3, 7, MPI_INT, &vector );
+    ompi_datatype_commit( &vector );
+    ompi_datatype_create_hvector( 333, 2, 40, MPI_DOUBLE, &hvector );
+    ompi_datatype_commit( &hvector );
+    ompi_datatype_create_contiguous( 3, MPI_DOUBLE, &triple );
+    ompi_datatype_create_vector( 100, 1, 2, triple, &vector3 );
+    ompi_datatype_commit( &vector3 );
+    ompi_datatype_create_subarray( 2, sizes, subsizes, starts, MPI_ORDER_C, MPI_FLOAT, &subarray2d );
+    ompi_datatype_commit( &subarray2d );
+    ompi_datatype_create_subarray( 3, sizes, subsizes, starts, MPI_ORDER_C, MPI_DOUBLE, &subarray3d );
+    ompi_datatype_commit( &subarray3d );
+    /* Two elements of different types are not a strided layout */
+    types[0] = MPI_INT;
+    types[1] = MPI_DOUBLE;
+    ompi_datatype_create_struct( 2, blocklens, disps, types, &structure );
+    ompi_datatype_commit( &structure );
+
+    for( count = 1; count <= 3; count += 2 ) {
+        errors += check_datatype( "vector", vector, count, true );
+        errors += check_datatype( "hvector", hvector, count, true );
+        errors += check_datatype( "vector of contiguous", vector3, count, true );
+        errors += check_datatype( "2D subarray", subarray2d, count, true );
+        errors += check_datatype( "3D subarray", subarray3d, count, true );
+        errors += check_datatype( "struct", structure, count, false );
+    }
+
+    ompi_datatype_destroy( &vector );
+    ompi_datatype_destroy( &hvector );
+    ompi_datatype_destroy( &triple );
+    ompi_datatype_destroy( &vector3 );
+    ompi_datatype_destroy( &subarray2d );
+    ompi_datatype_destroy( &subarray3d );
+    ompi_datatype_destroy( &structure );
+
+    ompi_datatype_finalize();
+    opal_finalize_util ();
+
+    printf( "Found %d errors\n", errors );
+    return (0 == errors ? 0 : -1);
+}
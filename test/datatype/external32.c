@@ -12,12 +12,17 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
 
 #include "ompi_config.h"
 #include "ompi/datatype/ompi_datatype.h"
 #include "opal/runtime/opal.h"
 #include "opal/datatype/opal_convertor.h"
 #include "opal/datatype/opal_datatype_internal.h"
+#include "opal/util/arch.h"
+#include "opal/mca/base/mca_base_framework.h"
+#include "opal/mca/memcpy/base/base.h"
 #include <arpa/inet.h>
 
 static int verbose = 0;
@@ -143,11 +148,128 @@ static int pack_unpack_datatype( void* send_data, ompi_datatype_t *datatype, int
     return (error == MPI_SUCCESS ? 0 : -1);
 }
 
+/*
+ * Pack and unpack large arrays of a predefined type, check that every
+ * element of the external32 representation has its bytes reversed
+ * (the tests run on little endian machines) and report the bandwidth
+ * of the conversions.
+ */
+static int check_large_contiguous( ompi_datatype_t* datatype, size_t count )
+{
+    MPI_Aint position, buffer_size;
+    unsigned char *send_data, *recv_data, *packed;
+    double pack_time, unpack_time;
+    struct timeval start, end;
+    size_t size, i, j;
+    int error = 0;
+
+    ompi_datatype_type_size( datatype, &size );
+    ompi_datatype_pack_external_size( "external32", (int)count, datatype, &buffer_size );
+    send_data = (unsigned char*)malloc(size * count);
+    recv_data = (unsigned char*)malloc(size * count);
+    packed = (unsigned char*)malloc(buffer_size);
+    for( i = 0; i < size * count; i++ ) {
+        send_data[i] = (unsigned char)(i % 253);
+    }
+
+    position = 0;
+    gettimeofday( &start, NULL );
+    ompi_datatype_pack_external( "external32", send_data, (int)count, datatype,
+                                 packed, buffer_size, &position );
+    gettimeofday( &end, NULL );
+    pack_time = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_usec - start.tv_usec);
+
+    for( i = 0; (i < count) && (0 == error); i++ ) {
+        for( j = 0; j < size; j++ ) {
+            if( packed[i * size + j] != send_data[i * size + size - 1 - j] ) {
+                printf("Error at element %zu byte %zu of the packed %s\n", i, j, datatype->name);
+                error = -1;
+                break;
+            }
+        }
+    }
+
+    position = 0;
+    memset( recv_data, 0, size * count );
+    gettimeofday( &start, NULL );
+    ompi_datatype_unpack_external( "external32", packed, buffer_size, &position,
+                                   recv_data, (int)count, datatype );
+    gettimeofday( &end, NULL );
+    unpack_time = (end.tv_sec - start.tv_sec) * 1e6 + (end.tv_usec - start.tv_usec);
+    if( 0 != memcmp(send_data, recv_data, size * count) ) {
+        printf("Error during external32 pack/unpack of %zu %s\n", count, datatype->name);
+        error = -1;
+    }
+
+    printf("%-16s %zu elements: pack %8.2f MB/s unpack %8.2f MB/s\n", datatype->name, count,
+           (size * count) / (pack_time > 0 ? pack_time : 1),
+           (size * count) / (unpack_time > 0 ? unpack_time : 1));
+    free(send_data); free(recv_data); free(packed);
+    return error;
+}
+
+/*
+ * Check opal_memcpy_swap against a byte by byte reversal for all the
+ * element sizes, counts covering the vector loops and their tails of
+ * all the flavors, and unaligned buffers. The bytes around the
+ * destination must be left untouched.
+ */
+static int check_swap( const char* flavor )
+{
+    static const size_t sizes[] = { 2, 4, 8, 12, 16 };
+    unsigned char src[16 * 80 + 8], dst[16 * 80 + 8 + 16];
+    size_t s, count, i, j, soff, doff, size;
+
+    for( i = 0; i < sizeof(src); i++ ) {
+        src[i] = (unsigned char)(i * 7 + 1);
+    }
+    for( s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++ ) {
+        size = sizes[s];
+        for( count = 0; count <= 80; count++ ) {
+            for( soff = 0; soff < 4; soff++ ) {
+                for( doff = 0; doff < 4; doff++ ) {
+                    memset( dst, 0xa5, sizeof(dst) );
+                    opal_memcpy_swap( dst + 8 + doff, src + soff, size, count );
+                    for( i = 0; i < count; i++ ) {
+                        for( j = 0; j < size; j++ ) {
+                            if( dst[8 + doff + i * size + j] != src[soff + i * size + size - 1 - j] ) {
+                                printf("Error: %s swap of %zu elements of %zu bytes (offsets %zu/%zu): "
+                                       "byte %zu of element %zu\n", flavor, count, size, soff, doff, j, i);
+                                return -1;
+                            }
+                        }
+                    }
+                    for( i = 0; i < sizeof(dst); i++ ) {
+                        if( (i < 8 + doff || i >= 8 + doff + count * size) && 0xa5 != dst[i] ) {
+                            printf("Error: %s swap of %zu elements of %zu bytes (offsets %zu/%zu): "
+                                   "wrote outside of the destination\n", flavor, count, size, soff, doff);
+                            return -1;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("opal_memcpy_swap (%s): OK\n", flavor);
+    return 0;
+}
+
 int main(int argc, char *argv[])
 {
     opal_init_util(&argc, &argv);
     ompi_datatype_init();
 
+    /* opal_init_util does not open the memcpy framework: check the
+     * default byte swaps, then the ones selected for this processor
+     * which are used by all the conversions below */
+    if( 0 != check_swap( "default" ) ) {
+        exit(-1);
+    }
+    mca_base_framework_open( &opal_memcpy_base_framework, 0 );
+    if( 0 != check_swap( "selected" ) ) {
+        exit(-1);
+    }
+
     /* Simple contiguous data: MPI_INT32_T */
     {
         int32_t send_data[2] = {1234, 5678};
@@ -222,6 +344,28 @@ int main(int argc, char *argv[])
         }
     }
 
+    /* Large contiguous data of all the swapped sizes */
+    printf("\n\nLarge contiguous data\n\n");
+    if( !(opal_local_arch & OPAL_ARCH_ISBIGENDIAN) ) {
+        if( (0 != check_large_contiguous( &ompi_mpi_int16_t.dt, 1 << 20 )) ||
+            (0 != check_large_contiguous( &ompi_mpi_int32_t.dt, 1 << 19 )) ||
+            (0 != check_large_contiguous( &ompi_mpi_int64_t.dt, 1 << 18 )) ||
+            (0 != check_large_contiguous( &ompi_mpi_double.dt, 1 << 18 )) ||
+            (0 != check_large_contiguous( &ompi_mpi_int16_t.dt, 1001 )) ) {
+            exit(-1);
+        }
+    }
+
+    /* The x86 component uses its AVX2 swaps instead of the SSSE3 ones
+     * when both are supported: check the latter too */
+    mca_base_framework_close( &opal_memcpy_base_framework );
+    setenv( OPAL_MCA_PREFIX "memcpy_x86_use_avx2", "0", 1 );
+    mca_base_framework_open( &opal_memcpy_base_framework, 0 );
+    if( 0 != check_swap( "without AVX2" ) ) {
+        exit(-1);
+    }
+    mca_base_framework_close( &opal_memcpy_base_framework );
+
     ompi_datatype_finalize();
 
     return 0;
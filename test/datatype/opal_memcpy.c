@@ -0,0 +1,272 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Check the copy functions of the memcpy framework (opal_memcpy,
+ * opal_memcpy_shared, opal_memcpy_tov and opal_memcpy_fromv) against
+ * memcpy, with the functions in place before the framework is opened
+ * and with the ones selected by its component. With memcpy/x86 the
+ * non-temporal copy is also checked directly at lengths and alignments
+ * covering its head, vector loop and tail, and its bandwidth is
+ * compared to the one of memcpy around memcpy_x86_stream_limit.
+ */
+
+#include "opal_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
+#include "opal/runtime/opal.h"
+#include "opal/mca/base/mca_base_framework.h"
+#include "opal/mca/memcpy/base/base.h"
+
+#define GUARD      64
+#define MAX_LENGTH (1024 * 1024 + 257)
+#define MAX_IOV    40
+
+static const size_t offsets[] = { 0, 1, 3, 7, 8, 15, 16, 31, 33 };
+#define NUM_OFFSETS (sizeof(offsets) / sizeof(offsets[0]))
+
+static unsigned char *src_buffer, *dst_buffer;
+
+static int check_buffer( const char *what, const char *flavor, size_t length,
+                         size_t soff, size_t doff )
+{
+    size_t i;
+
+    if( 0 != memcmp( dst_buffer + GUARD + doff, src_buffer + soff, length ) ) {
+        printf("Error: %s (%s) of %zu bytes (offsets %zu/%zu): wrong data\n",
+               what, flavor, length, soff, doff);
+        return -1;
+    }
+    for( i = 0; i < GUARD + doff; i++ ) {
+        if( 0xa5 != dst_buffer[i] ) goto overflow;
+    }
+    for( i = GUARD + doff + length; i < GUARD + doff + length + GUARD; i++ ) {
+        if( 0xa5 != dst_buffer[i] ) goto overflow;
+    }
+    return 0;
+  overflow:
+    printf("Error: %s (%s) of %zu bytes (offsets %zu/%zu): wrote outside of the destination\n",
+           what, flavor, length, soff, doff);
+    return -1;
+}
+
+static void reset_destination( size_t length )
+{
+    memset( dst_buffer, 0xa5, length + 2 * GUARD + 64 );
+}
+
+/* All the lengths up to a few vectors, then a few larger odd ones */
+static size_t next_length( size_t length )
+{
+    if( length < 300 ) return length + 1;
+    if( MAX_LENGTH == length ) return MAX_LENGTH + 1;
+    length = length * 4 + 4099;
+    return (length < MAX_LENGTH) ? length : MAX_LENGTH;
+}
+
+static int check_contiguous( const char *flavor )
+{
+    size_t length, s, d;
+
+    for( length = 0; length <= MAX_LENGTH; length = next_length(length) ) {
+        for( s = 0; s < NUM_OFFSETS; s++ ) {
+            for( d = 0; d < NUM_OFFSETS; d++ ) {
+                reset_destination( length + offsets[d] );
+                opal_memcpy( dst_buffer + GUARD + offsets[d], src_buffer + offsets[s], length );
+                if( 0 != check_buffer( "opal_memcpy", flavor, length, offsets[s], offsets[d] ) ) {
+                    return -1;
+                }
+                reset_destination( length + offsets[d] );
+                opal_memcpy_shared( dst_buffer + GUARD + offsets[d], src_buffer + offsets[s], length );
+                if( 0 != check_buffer( "opal_memcpy_shared", flavor, length, offsets[s], offsets[d] ) ) {
+                    return -1;
+                }
+#ifdef OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+                /* The non-temporal copy is only used from stream_limit
+                 * on, call it directly for the shorter lengths */
+                reset_destination( length + offsets[d] );
+                opal_memcpy_x86_stream( dst_buffer + GUARD + offsets[d], src_buffer + offsets[s], length );
+                if( 0 != check_buffer( "opal_memcpy_x86_stream", flavor, length, offsets[s], offsets[d] ) ) {
+                    return -1;
+                }
+#endif  /* OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H */
+            }
+        }
+    }
+    printf("opal_memcpy (%s): OK\n", flavor);
+    return 0;
+}
+
+/*
+ * Scatter the source to, or gather it from, iovec entries of lengths on
+ * both sides of OPAL_MEMCPY_X86_SMALL_LIMIT, separated by one guard byte
+ * and starting at the destination offset.
+ */
+static int check_iovec( const char *flavor )
+{
+    struct iovec iov[MAX_IOV];
+    size_t s, d, i, length, pos;
+    int count;
+
+    for( count = 0; count <= MAX_IOV; count++ ) {
+        for( s = 0; s < NUM_OFFSETS; s++ ) {
+            for( d = 0; d < NUM_OFFSETS; d++ ) {
+                length = 0;
+                pos = GUARD + offsets[d];
+                for( i = 0; i < (size_t)count; i++ ) {
+                    iov[i].iov_len = (i * 37 + offsets[s] * 5 + offsets[d]) % 151;
+                    iov[i].iov_base = dst_buffer + pos;
+                    length += iov[i].iov_len;
+                    pos += iov[i].iov_len + 1;
+                }
+
+                /* to the iovec, the entries are compared in place */
+                memset( dst_buffer, 0xa5, pos + GUARD );
+                opal_memcpy_tov( iov, src_buffer + offsets[s], count );
+                pos = GUARD + offsets[d];
+                length = 0;
+                for( i = 0; i < (size_t)count; i++ ) {
+                    if( 0 != memcmp( iov[i].iov_base, src_buffer + offsets[s] + length, iov[i].iov_len ) ||
+                        0xa5 != dst_buffer[pos + iov[i].iov_len] || 0xa5 != dst_buffer[pos - 1] ) {
+                        printf("Error: opal_memcpy_tov (%s) of %d entries (offsets %zu/%zu): entry %zu\n",
+                               flavor, count, offsets[s], offsets[d], i);
+                        return -1;
+                    }
+                    length += iov[i].iov_len;
+                    pos += iov[i].iov_len + 1;
+                }
+
+                /* from the iovec, back to a contiguous buffer after the entries */
+                memset( dst_buffer + pos + GUARD, 0xa5, length + GUARD );
+                opal_memcpy_fromv( dst_buffer + pos + GUARD, iov, count );
+                if( 0 != memcmp( dst_buffer + pos + GUARD, src_buffer + offsets[s], length ) ||
+                    0xa5 != dst_buffer[pos + GUARD + length] ) {
+                    printf("Error: opal_memcpy_fromv (%s) of %d entries (offsets %zu/%zu)\n",
+                           flavor, count, offsets[s], offsets[d]);
+                    return -1;
+                }
+            }
+        }
+    }
+    printf("opal_memcpy_tov/fromv (%s): OK\n", flavor);
+    return 0;
+}
+
+#ifdef OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+static double elapsed( struct timeval *start )
+{
+    struct timeval end;
+
+    gettimeofday( &end, NULL );
+    return (end.tv_sec - start->tv_sec) * 1000000.0 + (end.tv_usec - start->tv_usec);
+}
+
+/*
+ * Bandwidth of memcpy and of the non-temporal copy, repeating each copy
+ * on the same buffers as a protocol reusing its fragments does. The
+ * cutoff is the first length from which the non-temporal copy stays the
+ * fastest, to compare with memcpy_x86_stream_limit.
+ */
+static void sweep_stream_limit( void )
+{
+    size_t length, max_length = 64 * 1024 * 1024, cutoff = 0, reps, r;
+    unsigned char *src, *dst;
+    struct timeval start;
+    double t_memcpy, t_stream;
+
+    src = (unsigned char*)malloc( max_length );
+    dst = (unsigned char*)malloc( max_length );
+    if( NULL == src || NULL == dst ) {
+        printf("opal_memcpy_x86_stream sweep: not enough memory, skipped\n");
+        free(src); free(dst);
+        return;
+    }
+    memset( src, 1, max_length );
+    memset( dst, 0, max_length );
+
+    printf("%12s %14s %14s\n", "length", "memcpy MB/s", "stream MB/s");
+    for( length = 4096; length <= max_length; length *= 2 ) {
+        reps = (128 * 1024 * 1024) / length;
+        memcpy( dst, src, length );
+        gettimeofday( &start, NULL );
+        for( r = 0; r < reps; r++ ) {
+            memcpy( dst, src, length );
+        }
+        t_memcpy = elapsed( &start );
+        opal_memcpy_x86_stream( dst, src, length );
+        gettimeofday( &start, NULL );
+        for( r = 0; r < reps; r++ ) {
+            opal_memcpy_x86_stream( dst, src, length );
+        }
+        t_stream = elapsed( &start );
+        printf("%12zu %14.1f %14.1f\n", length,
+               (double)(length * reps) / (t_memcpy > 0 ? t_memcpy : 1),
+               (double)(length * reps) / (t_stream > 0 ? t_stream : 1));
+        if( t_stream < t_memcpy ) {
+            if( 0 == cutoff ) cutoff = length;
+        } else {
+            cutoff = 0;
+        }
+    }
+    if( 0 != cutoff ) {
+        printf("non-temporal copies are faster from %zu bytes (memcpy_x86_stream_limit %zu)\n",
+               cutoff, opal_memcpy_x86_stream_limit);
+    } else {
+        printf("non-temporal copies are not faster up to %zu bytes (memcpy_x86_stream_limit %zu)\n",
+               max_length, opal_memcpy_x86_stream_limit);
+    }
+    free(src); free(dst);
+}
+#endif  /* OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H */
+
+static int check_all( const char *flavor )
+{
+    if( 0 != check_contiguous( flavor ) ) return -1;
+    return check_iovec( flavor );
+}
+
+int main( int argc, char* argv[] )
+{
+    int rc = 0;
+    size_t i;
+
+    opal_init_util( &argc, &argv );
+
+    src_buffer = (unsigned char*)malloc( MAX_LENGTH + 64 );
+    dst_buffer = (unsigned char*)malloc( MAX_LENGTH + 64 + 2 * GUARD + 64 );
+    for( i = 0; i < MAX_LENGTH + 64; i++ ) {
+        src_buffer[i] = (unsigned char)(i * 7 + i / 251 + 1);
+    }
+
+    /* opal_init_util does not open the memcpy framework: check the
+     * functions in place until it is, then the ones of the component */
+    rc |= check_all( "default" );
+    mca_base_framework_open( &opal_memcpy_base_framework, 0 );
+    rc |= check_all( "selected" );
+#ifdef OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H
+    if( 0 == rc ) {
+        sweep_stream_limit();
+    }
+#endif  /* OPAL_MCA_MEMCPY_X86_MEMCPY_X86_H */
+    mca_base_framework_close( &opal_memcpy_base_framework );
+
+    free(src_buffer);
+    free(dst_buffer);
+    opal_finalize_util();
+    return (0 == rc) ? 0 : 1;
+}
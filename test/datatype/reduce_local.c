@@ -19,6 +19,7 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <unistd.h>
+#include <complex.h>
 
 #include "mpi.h"
 #include "ompi/communicator/communicator.h"
@@ -41,10 +42,12 @@ static op_name_t array_of_ops [] = {
     { "bor", "MPI_BOR", MPI_BOR },
     { "lxor", "MPI_LXOR", MPI_LXOR },
     { "bxor", "MPI_BXOR", MPI_BXOR },
+    { "maxloc", "MPI_MAXLOC", MPI_MAXLOC },
+    { "minloc", "MPI_MINLOC", MPI_MINLOC },
     { "replace", "MPI_REPLACE", MPI_REPLACE },
     { NULL, "MPI_OP_NULL", MPI_OP_NULL }
 };
-static int do_ops[12] = { -1, };  /* index of the ops to do. Size +1 larger than the array_of_ops */
+static int do_ops[14] = { -1, };  /* index of the ops to do. Size +1 larger than the array_of_ops */
 static int verbose = 0;
 static int total_errors = 0;
 
@@ -58,6 +61,15 @@ static int total_errors = 0;
        __typeof__ (b) _b = (b); \
      _a < _b ? _a : _b; })
 
+#define land(a,b) ((a) && (b))
+#define lor(a,b) ((a) || (b))
+#define lxor(a,b) (((a) ? 1 : 0) ^ ((b) ? 1 : 0))
+
+/* The (value, index) pairs of MPI_MINLOC and MPI_MAXLOC */
+typedef struct { int v; int k; } two_int_t;
+typedef struct { float v; int k; } float_int_t;
+typedef struct { double v; int k; } double_int_t;
+
 static void print_status(char* op, char* type, int type_size,
                          int count, double duration,
                          int correct )
@@ -159,6 +171,84 @@ do { \
     goto check_and_continue; \
 } while (0)
 
+/* OPNAME is the comparison selecting the input pair (> for maxloc, < for
+ * minloc), equal values keep the lowest index */
+#define MPI_OP_LOC_TEST(OPNAME, MPIOP, MPITYPE, TYPE, INBUF, INOUT_BUF, CHECK_BUF, COUNT) \
+do { \
+    const TYPE *_p1 = ((TYPE*)(INBUF)), *_p3 = ((TYPE*)(CHECK_BUF)); \
+    TYPE *_p2 = ((TYPE*)(INOUT_BUF)); \
+    skip_op_type = 0; \
+    for(int _k = 0; _k < min((COUNT), 4); +_k++ ) { \
+        memcpy(_p2, _p3, sizeof(TYPE) * (COUNT)); \
+        tstart = MPI_Wtime(); \
+        MPI_Reduce_local(_p1+_k, _p2+_k, (COUNT)-_k, (MPITYPE), (MPIOP)); \
+        tend = MPI_Wtime(); \
+        if( check ) { \
+            for( i = 0; i < (COUNT)-_k; i++ ) { \
+                const TYPE *_in = _p1+_k+i, *_io = _p3+_k+i, *_res = _p2+_k+i; \
+                if( (_in->v OPNAME _io->v) ? ((_res->v == _in->v) && (_res->k == _in->k)) : \
+                    (_in->v == _io->v) ? ((_res->v == _io->v) && (_res->k == min(_in->k, _io->k))) : \
+                    ((_res->v == _io->v) && (_res->k == _io->k)) ) \
+                    continue; \
+                printf("First error at alignment %d position %d ((%g, %d) %s (%g, %d) != (%g, %d))\n", \
+                       _k, i, (double)_in->v, _in->k, (#OPNAME), (double)_io->v, _io->k, \
+                       (double)_res->v, _res->k); \
+                correctness = 0; \
+                break; \
+            } \
+        } \
+    } \
+    goto check_and_continue; \
+} while (0)
+
+#define MPI_OP_COMPLEX_TEST(OPNAME, MPIOP, MPITYPE, TYPE, INBUF, INOUT_BUF, CHECK_BUF, COUNT) \
+do { \
+    const TYPE *_p1 = ((TYPE*)(INBUF)), *_p3 = ((TYPE*)(CHECK_BUF)); \
+    TYPE *_p2 = ((TYPE*)(INOUT_BUF)); \
+    skip_op_type = 0; \
+    for(int _k = 0; _k < min((COUNT), 4); +_k++ ) { \
+        memcpy(_p2, _p3, sizeof(TYPE) * (COUNT)); \
+        tstart = MPI_Wtime(); \
+        MPI_Reduce_local(_p1+_k, _p2+_k, (COUNT)-_k, (MPITYPE), (MPIOP)); \
+        tend = MPI_Wtime(); \
+        if( check ) { \
+            for( i = 0; i < (COUNT)-_k; i++ ) { \
+                if(((_p2+_k)[i]) == (((_p1+_k)[i]) OPNAME ((_p3+_k)[i]))) \
+                    continue; \
+                printf("First error at alignment %d position %d ((%g, %g) %s (%g, %g) != (%g, %g))\n", \
+                       _k, i, (double)creal((_p1+_k)[i]), (double)cimag((_p1+_k)[i]), (#OPNAME), \
+                       (double)creal((_p3+_k)[i]), (double)cimag((_p3+_k)[i]), \
+                       (double)creal((_p2+_k)[i]), (double)cimag((_p2+_k)[i])); \
+                correctness = 0; \
+                break; \
+            } \
+        } \
+    } \
+    goto check_and_continue; \
+} while (0)
+
+/* Small integer parts, the products are exact */
+#define COMPLEX_INIT(TYPE, INBUF, INOUT_BUF, CHECK_BUF, COUNT) \
+do { \
+    TYPE *_p1 = ((TYPE*)(INBUF)), *_p2 = ((TYPE*)(INOUT_BUF)), *_p3 = ((TYPE*)(CHECK_BUF)); \
+    for( i = 0; i < (COUNT); i++ ) { \
+        _p1[i] = (TYPE)((i % 7) - 3) + (TYPE)(i % 3) * I; \
+        _p2[i] = _p3[i] = (TYPE)(i % 5) - (TYPE)((i % 4) - 1) * I; \
+    } \
+} while (0)
+
+/* Pairs with many equal values, to exercise the choice of the index */
+#define LOC_INIT(TYPE, INBUF, INOUT_BUF, CHECK_BUF, COUNT) \
+do { \
+    TYPE *_p1 = ((TYPE*)(INBUF)), *_p2 = ((TYPE*)(INOUT_BUF)), *_p3 = ((TYPE*)(CHECK_BUF)); \
+    for( i = 0; i < (COUNT); i++ ) { \
+        _p1[i].v = i % 7; \
+        _p1[i].k = i % 3; \
+        _p2[i].v = _p3[i].v = i % 5; \
+        _p2[i].k = _p3[i].k = i % 4; \
+    } \
+} while (0)
+
 int main(int argc, char **argv)
 {
     static void *in_buf = NULL, *inout_buf = NULL, *inout_check_buf = NULL;
@@ -166,7 +256,7 @@ int main(int argc, char **argv)
     int repeats = 1, i, c;
     double tstart, tend;
     bool check = true;
-    char type[5] = "uifd", *op = "sum", *mpi_type;
+    char type[6] = "uifdc", *op = "sum", *mpi_type;
     int lower = 1, upper = 1000000, skip_op_type;
     MPI_Op mpi_op;
 
@@ -198,12 +288,13 @@ int main(int argc, char **argv)
         case 't':
             for( i = 0; i < (int)strlen(optarg); i++ ) {
                 if( ! (('i' == optarg[i]) || ('u' == optarg[i]) ||
-                       ('f' == optarg[i]) || ('d' == optarg[i])) ) {
-                    fprintf(stderr, "type must be i (signed int), u (unsigned int), f (float) or d (double)\n");
+                       ('f' == optarg[i]) || ('d' == optarg[i]) ||
+                       ('c' == optarg[i])) ) {
+                    fprintf(stderr, "type must be i (signed int), u (unsigned int), f (float), d (double) or c (complex)\n");
                     exit(-1);
                 }
             }
-            strncpy(type, optarg, 4);
+            strncpy(type, optarg, 5);
             break;
         case 'o':
             build_do_ops( optarg, do_ops);
@@ -221,9 +312,12 @@ int main(int argc, char **argv)
                     " -l <number> : lower number of elements\n"
                     " -u <number> : upper number of elements\n"
                     " -s <type_size> : 8, 16, 32 or 64 bits elements\n"
-                    " -t [i,u,f,d] : type of the elements to apply the operations on\n"
+                    " -t [i,u,f,d,c] : type of the elements to apply the operations on\n"
+                    "                  (c is float complex, double complex with -s 64)\n"
                     " -o <op> : comma separated list of operations to execute among\n"
-                    "           sum, min, max, prod, bor, bxor, band\n"
+                    "           sum, min, max, prod, bor, bxor, band, land, lor, lxor,\n"
+                    "           maxloc and minloc (i with -s 32, f and d only),\n"
+                    "           sum and prod only for c\n"
                     " -v: increase the verbosity level\n"
                     " -h: this help message\n", argv[0]);
             exit(0);
@@ -233,9 +327,9 @@ int main(int argc, char **argv)
     if( !do_ops_built ) {  /* not yet done, take the default */
             build_do_ops( "all", do_ops);
     }
-    in_buf          = malloc(upper * sizeof(double));
-    inout_buf       = malloc(upper * sizeof(double));
-    inout_check_buf = malloc(upper * sizeof(double));
+    in_buf          = malloc(upper * 2 * sizeof(double));  /* room for double_int */
+    inout_buf       = malloc(upper * 2 * sizeof(double));  /* room for double_int */
+    inout_check_buf = malloc(upper * 2 * sizeof(double));  /* room for double_int */
 
     ompi_mpi_init(argc, argv, MPI_THREAD_SERIALIZED, &provided, false);
 
@@ -297,6 +391,21 @@ int main(int argc, char **argv)
                                                in_int8, inout_int8, inout_int8_for_check,
                                                count, PRId8);
                         }
+                        if( 0 == strcmp(op, "land") ) {
+                            MPI_OP_MINMAX_TEST(land, mpi_op,  MPI_INT8_T, int8_t,
+                                               in_int8, inout_int8, inout_int8_for_check,
+                                               count, PRId8);
+                        }
+                        if( 0 == strcmp(op, "lor") ) {
+                            MPI_OP_MINMAX_TEST(lor, mpi_op,  MPI_INT8_T, int8_t,
+                                               in_int8, inout_int8, inout_int8_for_check,
+                                               count, PRId8);
+                        }
+                        if( 0 == strcmp(op, "lxor") ) {
+                            MPI_OP_MINMAX_TEST(lxor, mpi_op,  MPI_INT8_T, int8_t,
+                                               in_int8, inout_int8, inout_int8_for_check,
+                                               count, PRId8);
+                        }
                     }
                     if( 16 == type_size ) {
                         int16_t *in_int16 = (int16_t*)in_buf,
@@ -343,6 +452,21 @@ int main(int argc, char **argv)
                                                in_int16, inout_int16, inout_int16_for_check,
                                                count, PRId16);
                         }
+                        if( 0 == strcmp(op, "land") ) {
+                            MPI_OP_MINMAX_TEST(land, mpi_op,  MPI_INT16_T, int16_t,
+                                               in_int16, inout_int16, inout_int16_for_check,
+                                               count, PRId16);
+                        }
+                        if( 0 == strcmp(op, "lor") ) {
+                            MPI_OP_MINMAX_TEST(lor, mpi_op,  MPI_INT16_T, int16_t,
+                                               in_int16, inout_int16, inout_int16_for_check,
+                                               count, PRId16);
+                        }
+                        if( 0 == strcmp(op, "lxor") ) {
+                            MPI_OP_MINMAX_TEST(lxor, mpi_op,  MPI_INT16_T, int16_t,
+                                               in_int16, inout_int16, inout_int16_for_check,
+                                               count, PRId16);
+                        }
                     }
                     if( 32 == type_size ) {
                         int32_t *in_int32 = (int32_t*)in_buf,
@@ -389,6 +513,33 @@ int main(int argc, char **argv)
                                                in_int32, inout_int32, inout_int32_for_check,
                                                count, PRId32);
                         }
+                        if( 0 == strcmp(op, "land") ) {
+                            MPI_OP_MINMAX_TEST(land, mpi_op,  MPI_INT32_T, int32_t,
+                                               in_int32, inout_int32, inout_int32_for_check,
+                                               count, PRId32);
+                        }
+                        if( 0 == strcmp(op, "lor") ) {
+                            MPI_OP_MINMAX_TEST(lor, mpi_op,  MPI_INT32_T, int32_t,
+                                               in_int32, inout_int32, inout_int32_for_check,
+                                               count, PRId32);
+                        }
+                        if( 0 == strcmp(op, "lxor") ) {
+                            MPI_OP_MINMAX_TEST(lxor, mpi_op,  MPI_INT32_T, int32_t,
+                                               in_int32, inout_int32, inout_int32_for_check,
+                                               count, PRId32);
+                        }
+                        if( 0 == strcmp(op, "maxloc") ) {
+                            LOC_INIT(two_int_t, in_buf, inout_buf, inout_check_buf, count);
+                            mpi_type = "MPI_2INT";
+                            MPI_OP_LOC_TEST(>, mpi_op, MPI_2INT, two_int_t,
+                                            in_buf, inout_buf, inout_check_buf, count);
+                        }
+                        if( 0 == strcmp(op, "minloc") ) {
+                            LOC_INIT(two_int_t, in_buf, inout_buf, inout_check_buf, count);
+                            mpi_type = "MPI_2INT";
+                            MPI_OP_LOC_TEST(<, mpi_op, MPI_2INT, two_int_t,
+                                            in_buf, inout_buf, inout_check_buf, count);
+                        }
                     }
                     if( 64 == type_size ) {
                         int64_t *in_int64 = (int64_t*)in_buf,
@@ -435,6 +586,21 @@ int main(int argc, char **argv)
                                                in_int64, inout_int64, inout_int64_for_check,
                                                count, PRId64);
                         }
+                        if( 0 == strcmp(op, "land") ) {
+                            MPI_OP_MINMAX_TEST(land, mpi_op,  MPI_INT64_T, int64_t,
+                                               in_int64, inout_int64, inout_int64_for_check,
+                                               count, PRId64);
+                        }
+                        if( 0 == strcmp(op, "lor") ) {
+                            MPI_OP_MINMAX_TEST(lor, mpi_op,  MPI_INT64_T, int64_t,
+                                               in_int64, inout_int64, inout_int64_for_check,
+                                               count, PRId64);
+                        }
+                        if( 0 == strcmp(op, "lxor") ) {
+                            MPI_OP_MINMAX_TEST(lxor, mpi_op,  MPI_INT64_T, int64_t,
+                                               in_int64, inout_int64, inout_int64_for_check,
+                                               count, PRId64);
+                        }
                     }
                 }
 
@@ -655,6 +821,18 @@ int main(int argc, char **argv)
                                            in_float, inout_float, inout_float_for_check,
                                            count, "f");
                     }
+                    if( 0 == strcmp(op, "maxloc") ) {
+                        LOC_INIT(float_int_t, in_buf, inout_buf, inout_check_buf, count);
+                        mpi_type = "MPI_FLOAT_INT";
+                        MPI_OP_LOC_TEST(>, mpi_op, MPI_FLOAT_INT, float_int_t,
+                                        in_buf, inout_buf, inout_check_buf, count);
+                    }
+                    if( 0 == strcmp(op, "minloc") ) {
+                        LOC_INIT(float_int_t, in_buf, inout_buf, inout_check_buf, count);
+                        mpi_type = "MPI_FLOAT_INT";
+                        MPI_OP_LOC_TEST(<, mpi_op, MPI_FLOAT_INT, float_int_t,
+                                        in_buf, inout_buf, inout_check_buf, count);
+                    }
                 }
 
                 if( 'd' == type[type_idx] ) {
@@ -687,6 +865,44 @@ int main(int argc, char **argv)
                                            in_double, inout_double, inout_double_for_check,
                                            count, "f");
                     }
+                    if( 0 == strcmp(op, "maxloc") ) {
+                        LOC_INIT(double_int_t, in_buf, inout_buf, inout_check_buf, count);
+                        mpi_type = "MPI_DOUBLE_INT";
+                        MPI_OP_LOC_TEST(>, mpi_op, MPI_DOUBLE_INT, double_int_t,
+                                        in_buf, inout_buf, inout_check_buf, count);
+                    }
+                    if( 0 == strcmp(op, "minloc") ) {
+                        LOC_INIT(double_int_t, in_buf, inout_buf, inout_check_buf, count);
+                        mpi_type = "MPI_DOUBLE_INT";
+                        MPI_OP_LOC_TEST(<, mpi_op, MPI_DOUBLE_INT, double_int_t,
+                                        in_buf, inout_buf, inout_check_buf, count);
+                    }
+                }
+
+                if( 'c' == type[type_idx] ) {
+                    if( 64 == type_size ) {
+                        COMPLEX_INIT(double _Complex, in_buf, inout_buf, inout_check_buf, count);
+                        mpi_type = "MPI_C_DOUBLE_COMPLEX";
+                        if( 0 == strcmp(op, "sum") ) {
+                            MPI_OP_COMPLEX_TEST( +, mpi_op, MPI_C_DOUBLE_COMPLEX, double _Complex,
+                                                 in_buf, inout_buf, inout_check_buf, count);
+                        }
+                        if( 0 == strcmp(op, "prod") ) {
+                            MPI_OP_COMPLEX_TEST( *, mpi_op, MPI_C_DOUBLE_COMPLEX, double _Complex,
+                                                 in_buf, inout_buf, inout_check_buf, count);
+                        }
+                    } else {
+                        COMPLEX_INIT(float _Complex, in_buf, inout_buf, inout_check_buf, count);
+                        mpi_type = "MPI_C_FLOAT_COMPLEX";
+                        if( 0 == strcmp(op, "sum") ) {
+                            MPI_OP_COMPLEX_TEST( +, mpi_op, MPI_C_FLOAT_COMPLEX, float _Complex,
+                                                 in_buf, inout_buf, inout_check_buf, count);
+                        }
+                        if( 0 == strcmp(op, "prod") ) {
+                            MPI_OP_COMPLEX_TEST( *, mpi_op, MPI_C_FLOAT_COMPLEX, float _Complex,
+                                                 in_buf, inout_buf, inout_check_buf, count);
+                        }
+                    }
                 }
         check_and_continue:
                 if( !skip_op_type )
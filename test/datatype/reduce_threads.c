@@ -0,0 +1,202 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Compare the bandwidth of MPI_Reduce_local done by the calling
+ * thread alone and split across the helper threads of the op
+ * framework (op_base_reduce_threads), for growing buffers.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "mpi.h"
+#include "ompi/runtime/mpiruntime.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/op/base/base.h"
+
+static double get_time(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/* Seconds per MPI_Reduce_local of count doubles, best of repeats */
+static double time_reduce(double *in, double *inout, int count, MPI_Op op, int repeats)
+{
+    double start, best = -1.0;
+    int i;
+
+    for (i = 0; i < repeats; ++i) {
+        start = get_time();
+        MPI_Reduce_local(in, inout, count, MPI_DOUBLE, op);
+        start = get_time() - start;
+        if (best < 0.0 || start < best) {
+            best = start;
+        }
+    }
+    return best;
+}
+
+/*
+ * Check a MINLOC reduction of count MPI_DOUBLE_INT pairs, whose extent
+ * is larger than their size, against the serial one
+ */
+static int check_minloc(int count)
+{
+    struct { double value; int index; } *in, *inout, *check;
+    size_t threshold = ompi_op_reduce_thread_threshold;
+    int i, errors = 0;
+
+    in = malloc(count * sizeof(*in));
+    inout = calloc(count, sizeof(*inout));
+    check = calloc(count, sizeof(*check));
+    if (NULL == in || NULL == inout || NULL == check) {
+        fprintf(stderr, "Cannot allocate %zu bytes
+", 3 * count * sizeof(*in));
+        exit(-1);
+    }
+    for (i = 0; i < count; ++i) {
+        in[i].value = (double)(i % 1021);
+        in[i].index = i;
+        inout[i].value = check[i].value = (double)(i % 997);
+        inout[i].index = check[i].index = count - i;
+    }
+
+    ompi_op_reduce_thread_threshold = SIZE_MAX;
+    MPI_Reduce_local(in, check, count, MPI_DOUBLE_INT, MPI_MINLOC);
+    ompi_op_reduce_thread_threshold = 0;
+    MPI_Reduce_local(in, inout, count, MPI_DOUBLE_INT, MPI_MINLOC);
+    ompi_op_reduce_thread_threshold = threshold;
+
+    for (i = 0; i < count; ++i) {
+        if (inout[i].value != check[i].value || inout[i].index != check[i].index) {
+            fprintf(stderr, "MINLOC of MPI_DOUBLE_INT differs at %d\n", i);
+            ++errors;
+            break;
+        }
+    }
+
+    free(in);
+    free(inout);
+    free(check);
+    return errors;
+}
+
+static void print_help(char *name)
+{
+    printf("%s [-t threads] [-l lower] [-u upper] [-r repeats] [-o max|sum]\n"
+           "  -t: number of helper threads (default op_base_reduce_threads, or 4)\n"
+           "  -l: smallest buffer in bytes (default 1MB)\n"
+           "  -u: largest buffer in bytes (default 256MB)\n"
+           "  -r: number of repetitions per size (default 5)\n"
+           "  -o: operation (default sum)\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    size_t lower = 1024 * 1024, upper = 256 * 1024 * 1024, len, i;
+    int threads = 0, repeats = 5, c, count, errors = 0;
+    double *in, *inout, *check, serial, threaded;
+    MPI_Op op = MPI_SUM;
+
+    while (-1 != (c = getopt(argc, argv, "t:l:u:r:o:h"))) {
+        switch (c) {
+        case 't': threads = atoi(optarg); break;
+        case 'l': lower = strtoull(optarg, NULL, 10); break;
+        case 'u': upper = strtoull(optarg, NULL, 10); break;
+        case 'r': repeats = atoi(optarg); break;
+        case 'o':
+            if (0 == strcmp(optarg, "max")) {
+                op = MPI_MAX;
+            } else if (0 != strcmp(optarg, "sum")) {
+                print_help(argv[0]);
+                exit(-1);
+            }
+            break;
+        case 'h':
+            print_help(argv[0]);
+            exit(0);
+        default:
+            print_help(argv[0]);
+            exit(-1);
+        }
+    }
+    if (repeats < 1 || lower < sizeof(double) || upper < lower) {
+        print_help(argv[0]);
+        exit(-1);
+    }
+
+    ompi_mpi_init(argc, argv, MPI_THREAD_SERIALIZED, &c, false);
+
+    /* The MCA parameter wins over the default of the benchmark */
+    if (0 == threads) {
+        threads = (0 < ompi_op_base_reduce_threads) ? ompi_op_base_reduce_threads : 4;
+    }
+
+    in = (double*)malloc(upper);
+    inout = (double*)malloc(upper);
+    check = (double*)malloc(upper);
+    if (NULL == in || NULL == inout || NULL == check) {
+        fprintf(stderr, "Cannot allocate %zu bytes\n", 3 * upper);
+        ompi_mpi_finalize();
+        exit(-1);
+    }
+    for (i = 0; i < upper / sizeof(double); ++i) {
+        in[i] = (double)(i % 1021);
+        inout[i] = (double)(i % 997);
+    }
+
+    printf("# %d helper threads, blocks of %zu bytes\n", threads,
+           ompi_op_base_reduce_thread_block_size);
+    printf("# %12s %12s %12s %8s\n", "bytes", "serial GB/s", "threads GB/s", "speedup");
+    for (len = lower; len <= upper; len *= 2) {
+        count = (int)(len / sizeof(double));
+
+        ompi_op_reduce_thread_threshold = SIZE_MAX;
+        serial = time_reduce(in, inout, count, op, repeats);
+        /* Reference result of a single reduction */
+        for (i = 0; i < (size_t)count; ++i) {
+            check[i] = (double)(i % 997);
+        }
+        MPI_Reduce_local(in, check, count, MPI_DOUBLE, op);
+
+        ompi_op_base_reduce_threads = threads;
+        ompi_op_reduce_thread_threshold = 0;
+        threaded = time_reduce(in, inout, count, op, repeats);
+        for (i = 0; i < (size_t)count; ++i) {
+            inout[i] = (double)(i % 997);
+        }
+        MPI_Reduce_local(in, inout, count, MPI_DOUBLE, op);
+        c = memcmp(inout, check, count * sizeof(double));
+        errors += (0 != c);
+
+        /* Two sources and one target per element */
+        printf("  %12zu %12.2f %12.2f %8.2f%s\n", len,
+               3.0 * len / serial / 1e9, 3.0 * len / threaded / 1e9,
+               serial / threaded, (0 == c) ? "" : " [fail]");
+    }
+
+    /* The pair types are cut by their extent, not their size */
+    errors += check_minloc((int)(upper / 16));
+
+    free(in);
+    free(inout);
+    free(check);
+    ompi_mpi_finalize();
+
+    return (0 == errors) ? 0 : -1;
+}
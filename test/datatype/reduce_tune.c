@@ -0,0 +1,255 @@
+/* -*- Mode: C; c-basic-offset:4 ; indent-tabs-mode:nil -*- */
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Time the reduction kernels of the op components (see
+ * ompi_op_base_kernel_query) for every operation, datatype and length
+ * on the local processor, and write the selection table used by the
+ * op base (op_base_select_table MCA parameter).
+ *
+ * For each (op, datatype) the long kernel is the fastest one for the
+ * longest buffers.  If it is slower (beyond the tolerance) than
+ * another kernel for the shorter buffers, the table gets a short size
+ * class, up to the shortest length from which the long kernel stays
+ * within the tolerance, with the kernel doing best on these lengths.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include "mpi.h"
+#include "ompi/runtime/mpiruntime.h"
+#include "ompi/datatype/ompi_datatype.h"
+#include "ompi/op/op.h"
+#include "ompi/mca/op/base/base.h"
+
+#define MAX_KERNELS 16
+#define MAX_LENGTHS 32
+
+static MPI_Op ops[] = { MPI_MAX, MPI_MIN, MPI_SUM, MPI_PROD, MPI_LAND, MPI_BAND,
+                        MPI_LOR, MPI_BOR, MPI_LXOR, MPI_BXOR };
+static const char *op_names[] = { "max", "min", "sum", "prod", "land", "band",
+                                  "lor", "bor", "lxor", "bxor" };
+#define NUM_OPS (int)(sizeof(ops) / sizeof(ops[0]))
+
+static int verbose = 0;
+
+static double get_time(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+/* Seconds per call of the kernel on len bytes, best of 5 averages */
+static double time_kernel(ompi_op_base_module_t *module, int type,
+                          MPI_Datatype dtype, void *in, void *inout, size_t len)
+{
+    int count = (int)(len / dtype->super.size), i, j, reps;
+    double t, best = -1.0;
+
+    /* About 16MB of data per sample, at least 4 calls */
+    reps = (int)((16 * 1024 * 1024) / len);
+    reps = (reps < 4) ? 4 : reps;
+
+    for (j = 0; j < 5; ++j) {
+        t = get_time();
+        for (i = 0; i < reps; ++i) {
+            module->opm_fns[type](in, inout, &count, &dtype, module);
+        }
+        t = (get_time() - t) / reps;
+        if (best < 0.0 || t < best) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+static void print_help(char *name)
+{
+    printf("%s [-k kernels] [-o ops] [-l lower] [-u upper] [-t tolerance] [-f file] [-v]\n"
+           "  -k: comma separated list of kernels (default base,avx:avx,avx:avx2,avx:avx512)\n"
+           "  -o: comma separated list of operations (default all the arithmetic and logical ones)\n"
+           "  -l: shortest buffer in bytes (default 64)\n"
+           "  -u: longest buffer in bytes (default 1MB)\n"
+           "  -t: tolerance in percent before preferring another kernel (default 5)\n"
+           "  -f: selection table to write (default ompi-op-select.table)\n"
+           "  -v: print the timings\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    MPI_Datatype types[] = { MPI_INT8_T, MPI_UINT8_T, MPI_INT16_T, MPI_UINT16_T,
+                             MPI_INT32_T, MPI_UINT32_T, MPI_INT64_T, MPI_UINT64_T,
+                             MPI_FLOAT, MPI_DOUBLE, MPI_C_FLOAT_COMPLEX,
+                             MPI_C_DOUBLE_COMPLEX };
+    int num_types = (int)(sizeof(types) / sizeof(types[0]));
+    char *kernel_list = strdup("base,avx:avx,avx:avx2,avx:avx512"), *op_list = NULL;
+    char *kernels[MAX_KERNELS], *tok, *file = "ompi-op-select.table";
+    ompi_op_base_module_t *modules[MAX_KERNELS];
+    double times[MAX_KERNELS][MAX_LENGTHS], tolerance = 5.0, best, score, best_score;
+    size_t lower = 64, upper = 1024 * 1024, lengths[MAX_LENGTHS], len;
+    int num_kernels = 0, num_lengths = 0, i, k, l, o, c, type, long_k, short_k, first;
+    void *in, *inout;
+    FILE *fptr;
+
+    while (-1 != (c = getopt(argc, argv, "k:o:l:u:t:f:vh"))) {
+        switch (c) {
+        case 'k': free(kernel_list); kernel_list = strdup(optarg); break;
+        case 'o': op_list = optarg; break;
+        case 'l': lower = strtoull(optarg, NULL, 10); break;
+        case 'u': upper = strtoull(optarg, NULL, 10); break;
+        case 't': tolerance = atof(optarg); break;
+        case 'f': file = optarg; break;
+        case 'v': verbose++; break;
+        case 'h':
+            print_help(argv[0]);
+            exit(0);
+        default:
+            print_help(argv[0]);
+            exit(-1);
+        }
+    }
+    for (len = lower; 0 < len && len <= upper && num_lengths < MAX_LENGTHS; len *= 2) {
+        lengths[num_lengths++] = len;
+    }
+    for (tok = strtok(kernel_list, ","); NULL != tok && num_kernels < MAX_KERNELS;
+         tok = strtok(NULL, ",")) {
+        kernels[num_kernels++] = tok;
+    }
+    if (0 == num_lengths || 0 == num_kernels) {
+        print_help(argv[0]);
+        exit(-1);
+    }
+
+    ompi_mpi_init(argc, argv, MPI_THREAD_SERIALIZED, &c, false);
+
+    in = calloc(1, upper);
+    inout = calloc(1, upper);
+    if (NULL == in || NULL == inout || NULL == (fptr = fopen(file, "w"))) {
+        fprintf(stderr, "Cannot allocate the buffers or open %s\n", file);
+        ompi_mpi_finalize();
+        exit(-1);
+    }
+    fprintf(fptr, "# Reduction kernels selection table (op_base_select_table)\n"
+                  "# op datatype short_limit short_kernel long_kernel\n");
+
+    for (o = 0; o < NUM_OPS; ++o) {
+        if (NULL != op_list && NULL == strstr(op_list, op_names[o])) {
+            continue;
+        }
+        for (k = 0; k < num_kernels; ++k) {
+            if (OMPI_SUCCESS != ompi_op_base_kernel_query(ops[o], kernels[k], &modules[k])) {
+                modules[k] = NULL;
+            }
+        }
+
+        for (i = 0; i < num_types; ++i) {
+            type = ompi_op_ddt_map[types[i]->id];
+            if (-1 == type || NULL == ops[o]->o_func.intrinsic.fns[type]) {
+                continue;
+            }
+
+            for (l = 0; l < num_lengths; ++l) {
+                for (k = 0; k < num_kernels; ++k) {
+                    times[k][l] = -1.0;
+                    if (NULL != modules[k] && NULL != modules[k]->opm_fns[type] &&
+                        lengths[l] >= types[i]->super.size) {
+                        times[k][l] = time_kernel(modules[k], type, types[i], in, inout, lengths[l]);
+                    }
+                }
+            }
+
+            /* The long kernel is the fastest on the longest buffers */
+            for (long_k = -1, k = 0; k < num_kernels; ++k) {
+                if (0.0 <= times[k][num_lengths - 1] &&
+                    (-1 == long_k || times[k][num_lengths - 1] < times[long_k][num_lengths - 1])) {
+                    long_k = k;
+                }
+            }
+            if (-1 == long_k) {
+                continue;
+            }
+
+            /* Shortest length from which it stays within the tolerance */
+            for (first = num_lengths - 1; first > 0; --first) {
+                for (best = times[long_k][first - 1], k = 0; k < num_kernels; ++k) {
+                    if (0.0 <= times[k][first - 1] && times[k][first - 1] < best) {
+                        best = times[k][first - 1];
+                    }
+                }
+                if (times[long_k][first - 1] < 0.0 ||
+                    times[long_k][first - 1] > best * (1.0 + tolerance / 100.0)) {
+                    break;
+                }
+            }
+
+            /* Kernel doing best below that length, relative to the
+               fastest kernel of each length */
+            for (short_k = -1, best_score = 0.0, k = 0; 0 < first && k < num_kernels; ++k) {
+                for (score = 0.0, l = 0; l < first; ++l) {
+                    if (times[k][l] < 0.0) {
+                        break;
+                    }
+                    for (best = times[k][l], c = 0; c < num_kernels; ++c) {
+                        if (0.0 <= times[c][l] && times[c][l] < best) {
+                            best = times[c][l];
+                        }
+                    }
+                    score += times[k][l] / best;
+                }
+                if (l == first && (-1 == short_k || score < best_score)) {
+                    short_k = k;
+                    best_score = score;
+                }
+            }
+
+            if (verbose) {
+                printf("%s %s\n", op_names[o], ompi_op_base_type_names[type]);
+                for (l = 0; l < num_lengths; ++l) {
+                    printf("  %10zu", lengths[l]);
+                    for (k = 0; k < num_kernels; ++k) {
+                        if (0.0 <= times[k][l]) {
+                            printf("  %s %8.2f GB/s", kernels[k], lengths[l] / times[k][l] / 1e9);
+                        }
+                    }
+                    printf("\n");
+                }
+            }
+            if (-1 != short_k && short_k != long_k) {
+                fprintf(fptr, "%s %s %zu %s %s\n", op_names[o], ompi_op_base_type_names[type],
+                        lengths[first], kernels[short_k], kernels[long_k]);
+            } else {
+                fprintf(fptr, "%s %s 0 - %s\n", op_names[o], ompi_op_base_type_names[type],
+                        kernels[long_k]);
+            }
+        }
+
+        for (k = 0; k < num_kernels; ++k) {
+            if (NULL != modules[k]) {
+                OBJ_RELEASE(modules[k]);
+            }
+        }
+    }
+
+    fclose(fptr);
+    printf("Selection table written to %s\n", file);
+
+    free(in);
+    free(inout);
+    free(kernel_list);
+    ompi_mpi_finalize();
+
+    return 0;
+}
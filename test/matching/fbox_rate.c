@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Latency and message rate of small messages with many local peers.
+ *
+ * All the ranks first exchange enough messages with rank 0 to set up the
+ * btl/sm fast boxes in both directions, then:
+ *
+ *  - latency: rank 0 and the last rank ping-pong while all the other ranks
+ *    wait, so that rank 0 has fast boxes from every peer to poll but only
+ *    one of them receives data.
+ *  - rate: every other rank sends a window of messages to rank 0, which
+ *    acknowledges each window once it received it from all the peers.
+ *
+ * Run it on a single node with many processes, once with each polling
+ * mode of the receiver, e.g.:
+ *
+ *   mpirun -np 128 --mca pml ob1 --mca btl self,sm --mca btl_sm_fbox_doorbell 1 ./fbox_rate
+ *   mpirun -np 128 --mca pml ob1 --mca btl self,sm --mca btl_sm_fbox_doorbell 0 ./fbox_rate
+ *
+ * -n, -w and -s change the number of iterations, the window of the rate
+ * test and the largest message size.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define TAG_WARMUP 1
+#define TAG_PING   2
+#define TAG_RATE   3
+#define TAG_ACK    4
+
+static int rank, size;
+
+static void print_doorbell(void)
+{
+    int index, count, value;
+    MPI_T_cvar_handle handle;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_index("btl_sm_fbox_doorbell", &index)) {
+        printf("btl_sm_fbox_doorbell: not available\n");
+        return;
+    }
+    MPI_T_cvar_handle_alloc(index, NULL, &handle, &count);
+    MPI_T_cvar_read(handle, &value);
+    MPI_T_cvar_handle_free(&handle);
+    printf("btl_sm_fbox_doorbell: %d\n", value);
+}
+
+/* More than btl_sm_fbox_threshold sends to and from every peer */
+static void warmup(char *buffer)
+{
+    for (int i = 0 ; i < 64 ; ++i) {
+        if (0 == rank) {
+            for (int peer = 1 ; peer < size ; ++peer) {
+                MPI_Send(buffer, 1, MPI_CHAR, peer, TAG_WARMUP, MPI_COMM_WORLD);
+                MPI_Recv(buffer, 1, MPI_CHAR, peer, TAG_WARMUP, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            }
+        } else {
+            MPI_Recv(buffer, 1, MPI_CHAR, 0, TAG_WARMUP, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(buffer, 1, MPI_CHAR, 0, TAG_WARMUP, MPI_COMM_WORLD);
+        }
+    }
+}
+
+static double bench_latency(char *buffer, int msg_size, int iterations)
+{
+    int peer = size - 1;
+    double start;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    if (0 == rank) {
+        for (int i = 0 ; i < iterations ; ++i) {
+            MPI_Send(buffer, msg_size, MPI_CHAR, peer, TAG_PING, MPI_COMM_WORLD);
+            MPI_Recv(buffer, msg_size, MPI_CHAR, peer, TAG_PING, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    } else if (peer == rank) {
+        for (int i = 0 ; i < iterations ; ++i) {
+            MPI_Recv(buffer, msg_size, MPI_CHAR, 0, TAG_PING, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            MPI_Send(buffer, msg_size, MPI_CHAR, 0, TAG_PING, MPI_COMM_WORLD);
+        }
+    }
+
+    return (MPI_Wtime() - start) * 1e6 / (2.0 * iterations);
+}
+
+static double bench_rate(char *buffer, int msg_size, int window, int iterations, MPI_Request *requests)
+{
+    int nrequests = (0 == rank) ? (size - 1) * window : window;
+    double start;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = MPI_Wtime();
+    for (int i = 0 ; i < iterations ; ++i) {
+        if (0 == rank) {
+            for (int peer = 1 ; peer < size ; ++peer) {
+                for (int j = 0 ; j < window ; ++j) {
+                    MPI_Irecv(buffer + (size_t) j * msg_size, msg_size, MPI_CHAR, peer, TAG_RATE,
+                              MPI_COMM_WORLD, requests + (peer - 1) * window + j);
+                }
+            }
+            MPI_Waitall(nrequests, requests, MPI_STATUSES_IGNORE);
+            for (int peer = 1 ; peer < size ; ++peer) {
+                MPI_Send(NULL, 0, MPI_CHAR, peer, TAG_ACK, MPI_COMM_WORLD);
+            }
+        } else {
+            for (int j = 0 ; j < window ; ++j) {
+                MPI_Isend(buffer + (size_t) j * msg_size, msg_size, MPI_CHAR, 0, TAG_RATE,
+                          MPI_COMM_WORLD, requests + j);
+            }
+            MPI_Waitall(nrequests, requests, MPI_STATUSES_IGNORE);
+            MPI_Recv(NULL, 0, MPI_CHAR, 0, TAG_ACK, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    }
+
+    return (double) (size - 1) * window * iterations / (MPI_Wtime() - start);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = 10000, window = 64, max_size = 1024, opt, provided;
+    MPI_Request *requests;
+    char *buffer;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    while (-1 != (opt = getopt(argc, argv, "n:w:s:"))) {
+        if ('n' == opt) {
+            iterations = atoi(optarg);
+        } else if ('w' == opt) {
+            window = atoi(optarg);
+        } else if ('s' == opt) {
+            max_size = atoi(optarg);
+        }
+    }
+
+    if (size < 2) {
+        fprintf(stderr, "ERROR: This test should be run with at least two MPI processes.\n");
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    buffer = calloc((size_t) window * max_size + 1, 1);
+    requests = calloc((size_t) (size - 1) * window, sizeof(MPI_Request));
+
+    if (0 == rank) {
+        MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+        print_doorbell();
+        MPI_T_finalize();
+        printf("%d processes, %d iterations, window %d\n", size, iterations, window);
+        printf("%10s %16s %16s\n", "size", "latency (us)", "rate (msg/s)");
+    }
+
+    warmup(buffer);
+
+    for (int msg_size = 1 ; msg_size <= max_size ; msg_size *= 4) {
+        double latency = bench_latency(buffer, msg_size, iterations);
+        double rate = bench_rate(buffer, msg_size, window, iterations / 10 > 0 ? iterations / 10 : 1, requests);
+        if (0 == rank) {
+            printf("%10d %16.2f %16.0f\n", msg_size, latency, rate);
+        }
+    }
+
+    free(buffer);
+    free(requests);
+
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
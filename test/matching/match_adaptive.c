@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Migration of the matching queues with pml_ob1_matching_adaptive.
+ *
+ * Rank 0 receives from all the other ranks and checks through the
+ * pml_ob1_match_engine and pml_ob1_match_engine_migrations pvars that its
+ * communicator:
+ *
+ *  - deep: moves to the adaptive engine when 'depth' receives per peer are
+ *    posted before the messages arrive.
+ *  - shallow: moves back to the per-peer queues when the messages are then
+ *    exchanged in ping-pong while 'pending' receives per peer stay posted.
+ *    With enough peers the total number of pending receives is above
+ *    pml_ob1_matching_adaptive_low while the depth seen by each peer is
+ *    not, e.g.:
+ *
+ *   mpirun -np 4 --mca pml ob1 --mca pml_ob1_matching_adaptive 1 ./match_adaptive
+ *
+ * The defaults fit the default adaptation window (1024 matches) and
+ * thresholds (64 and 8), -d, -n and -p change the depth of the deep phase,
+ * the number of messages per peer of the shallow phase and the number of
+ * pending receives per peer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define TAG_SHALLOW 0x7ff0
+#define TAG_PENDING 0x7ff1
+
+static int rank, size;
+static MPI_T_pvar_session session;
+static MPI_T_pvar_handle engine_handle, migrations_handle;
+
+static int pvars_bind(MPI_Comm comm)
+{
+    int engine_index, migrations_index, count;
+
+    if (MPI_SUCCESS != MPI_T_pvar_get_index("pml_ob1_match_engine", MPI_T_PVAR_CLASS_STATE, &engine_index) ||
+        MPI_SUCCESS != MPI_T_pvar_get_index("pml_ob1_match_engine_migrations", MPI_T_PVAR_CLASS_COUNTER,
+                                            &migrations_index)) {
+        fprintf(stderr, "ERROR: the pml_ob1 matching pvars are not available (is pml ob1 in use?)\n");
+        return -1;
+    }
+
+    MPI_T_pvar_session_create(&session);
+    MPI_T_pvar_handle_alloc(session, engine_index, &comm, &engine_handle, &count);
+    MPI_T_pvar_handle_alloc(session, migrations_index, &comm, &migrations_handle, &count);
+
+    return 0;
+}
+
+static void pvars_read(int *engine, unsigned long long *migrations)
+{
+    MPI_T_pvar_read(session, engine_handle, engine);
+    MPI_T_pvar_read(session, migrations_handle, migrations);
+}
+
+static void phase_deep(MPI_Comm comm, int depth, int *buffers, MPI_Request *requests)
+{
+    if (0 == rank) {
+        for (int peer = 1 ; peer < size ; ++peer) {
+            for (int i = 0 ; i < depth ; ++i) {
+                MPI_Irecv(buffers + i, 1, MPI_INT, peer, i, comm, requests + (peer - 1) * depth + i);
+            }
+        }
+        MPI_Barrier(comm);
+        MPI_Waitall((size - 1) * depth, requests, MPI_STATUSES_IGNORE);
+    } else {
+        MPI_Barrier(comm);
+        for (int i = depth - 1 ; i >= 0 ; --i) {
+            MPI_Send(buffers + i, 1, MPI_INT, 0, i, comm);
+        }
+    }
+}
+
+static void phase_shallow(MPI_Comm comm, int nmsgs, int pending, int *buffers, MPI_Request *requests)
+{
+    int value = 0;
+
+    if (0 == rank) {
+        for (int peer = 1 ; peer < size ; ++peer) {
+            for (int i = 0 ; i < pending ; ++i) {
+                MPI_Irecv(buffers + i, 1, MPI_INT, peer, TAG_PENDING, comm, requests + (peer - 1) * pending + i);
+            }
+        }
+        MPI_Barrier(comm);
+        for (int i = 0 ; i < nmsgs ; ++i) {
+            for (int peer = 1 ; peer < size ; ++peer) {
+                MPI_Recv(&value, 1, MPI_INT, peer, TAG_SHALLOW, comm, MPI_STATUS_IGNORE);
+                MPI_Send(&value, 1, MPI_INT, peer, TAG_SHALLOW, comm);
+            }
+        }
+        MPI_Waitall((size - 1) * pending, requests, MPI_STATUSES_IGNORE);
+    } else {
+        MPI_Barrier(comm);
+        for (int i = 0 ; i < nmsgs ; ++i) {
+            MPI_Send(&value, 1, MPI_INT, 0, TAG_SHALLOW, comm);
+            MPI_Recv(&value, 1, MPI_INT, 0, TAG_SHALLOW, comm, MPI_STATUS_IGNORE);
+        }
+        for (int i = 0 ; i < pending ; ++i) {
+            MPI_Send(buffers + i, 1, MPI_INT, 0, TAG_PENDING, comm);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int depth = 2048, nmsgs = 4096, pending = 4, opt, provided, errors = 0;
+    int engine_initial, engine;
+    unsigned long long migrations_initial, migrations;
+    MPI_Request *requests;
+    MPI_Comm comm;
+    int *buffers;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    while (-1 != (opt = getopt(argc, argv, "d:n:p:"))) {
+        if ('d' == opt) {
+            depth = atoi(optarg);
+        } else if ('n' == opt) {
+            nmsgs = atoi(optarg);
+        } else if ('p' == opt) {
+            pending = atoi(optarg);
+        }
+    }
+
+    if (size < 2) {
+        fprintf(stderr, "ERROR: This test should be run with at least two MPI processes.\n");
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    MPI_T_init_thread(MPI_THREAD_SINGLE, &provided);
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+    if (0 == rank && 0 != pvars_bind(comm)) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    buffers = calloc(depth > pending ? depth : pending, sizeof(int));
+    requests = calloc((size_t) (size - 1) * (depth > pending ? depth : pending), sizeof(MPI_Request));
+
+    if (0 == rank) {
+        pvars_read(&engine_initial, &migrations_initial);
+    }
+
+    phase_deep(comm, depth, buffers, requests);
+    if (0 == rank) {
+        pvars_read(&engine, &migrations);
+        if (engine == engine_initial || migrations != migrations_initial + 1) {
+            fprintf(stderr, "deep: engine %d migrations %llu, expected a move from engine %d\n",
+                    engine, migrations - migrations_initial, engine_initial);
+            ++errors;
+        }
+    }
+
+    phase_shallow(comm, nmsgs, pending, buffers, requests);
+    if (0 == rank) {
+        pvars_read(&engine, &migrations);
+        if (engine != engine_initial || migrations != migrations_initial + 2) {
+            fprintf(stderr, "shallow: engine %d migrations %llu, expected a move back to engine %d\n",
+                    engine, migrations - migrations_initial, engine_initial);
+            ++errors;
+        }
+        printf("match_adaptive: %s (%d errors)\n", errors ? "FAILED" : "OK", errors);
+
+        MPI_T_pvar_handle_free(session, &engine_handle);
+        MPI_T_pvar_handle_free(session, &migrations_handle);
+        MPI_T_pvar_session_free(&session);
+    }
+
+    free(buffers);
+    free(requests);
+    MPI_Comm_free(&comm);
+    MPI_T_finalize();
+
+    MPI_Finalize();
+    return (0 == rank && errors) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
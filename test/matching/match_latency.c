@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Match latency versus queue depth.
+ *
+ * Rank 1 sends 'depth' small messages with distinct tags to rank 0, which
+ * matches them in the reverse order so that every match has to go through
+ * the whole queue with a list based matching engine:
+ *
+ *  - posted: rank 0 pre-posts all the receives before the messages are
+ *    sent, messages are matched against the posted receive queue.
+ *  - unexpected: all the messages are received before rank 0 posts the
+ *    receives, receives are matched against the unexpected queue.
+ *  - wild: same as posted with one MPI_ANY_SOURCE receive on a tag that is
+ *    never used posted first, to measure the cost of wildcard receives.
+ *
+ * Every test is run on a duplicate of MPI_COMM_WORLD created with the
+ * ompi_pml_ob1_matching_engine info key set to each of the engines given on
+ * the command line (default: none hash), e.g.:
+ *
+ *   mpirun -np 2 --mca pml ob1 ./match_latency -d 8192 none linkedlist hash
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define MAX_DEPTH_DEFAULT 4096
+#define NB_ITER           10
+
+static int rank;
+static int *buffers;
+static MPI_Request *requests;
+
+static void bench_posted(MPI_Comm comm, int depth, int wild)
+{
+    int dummy;
+    MPI_Request wild_request;
+
+    if (0 == rank) {
+        if (wild) {
+            MPI_Irecv(&dummy, 1, MPI_INT, MPI_ANY_SOURCE, depth + 1, comm, &wild_request);
+        }
+        for (int i = 0 ; i < depth ; ++i) {
+            MPI_Irecv(buffers + i, 1, MPI_INT, 1, i, comm, requests + i);
+        }
+        MPI_Barrier(comm);
+        MPI_Waitall(depth, requests, MPI_STATUSES_IGNORE);
+        if (wild) {
+            MPI_Cancel(&wild_request);
+            MPI_Wait(&wild_request, MPI_STATUS_IGNORE);
+        }
+    } else {
+        MPI_Barrier(comm);
+        for (int i = depth - 1 ; i >= 0 ; --i) {
+            MPI_Send(buffers + i, 1, MPI_INT, 0, i, comm);
+        }
+    }
+}
+
+static void bench_unexpected(MPI_Comm comm, int depth)
+{
+    if (0 == rank) {
+        /* messages from one source are not overtaking each other, once the
+         * last one is here all the others are in the unexpected queue */
+        MPI_Probe(1, depth, comm, MPI_STATUS_IGNORE);
+        for (int i = depth - 1 ; i >= 0 ; --i) {
+            MPI_Irecv(buffers + i, 1, MPI_INT, 1, i, comm, requests + i);
+        }
+        MPI_Waitall(depth, requests, MPI_STATUSES_IGNORE);
+        MPI_Recv(buffers, 1, MPI_INT, 1, depth, comm, MPI_STATUS_IGNORE);
+    } else {
+        for (int i = 0 ; i <= depth ; ++i) {
+            MPI_Send(buffers + i, 1, MPI_INT, 0, i, comm);
+        }
+    }
+}
+
+static double run(MPI_Comm comm, int test, int depth)
+{
+    double start, elapsed = 0.0;
+
+    for (int iter = 0 ; iter <= NB_ITER ; ++iter) {
+        MPI_Barrier(comm);
+        start = MPI_Wtime();
+        switch (test) {
+        case 0:
+            bench_posted(comm, depth, 0);
+            break;
+        case 1:
+            bench_unexpected(comm, depth);
+            break;
+        default:
+            bench_posted(comm, depth, 1);
+        }
+        /* first iteration is a warmup */
+        if (iter > 0) {
+            elapsed += MPI_Wtime() - start;
+        }
+    }
+
+    return elapsed * 1e6 / (NB_ITER * (double) depth);
+}
+
+int main(int argc, char *argv[])
+{
+    static const char *test_names[] = {"posted", "unexpected", "wild"};
+    static char *default_engines[] = {"none", "hash"};
+    char **engines = default_engines;
+    int nengines = 2, size, max_depth = MAX_DEPTH_DEFAULT, opt;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    while (-1 != (opt = getopt(argc, argv, "d:"))) {
+        if ('d' == opt) {
+            max_depth = atoi(optarg);
+        }
+    }
+    if (optind < argc) {
+        engines = argv + optind;
+        nengines = argc - optind;
+    }
+
+    if (2 != size) {
+        if (0 == rank) {
+            fprintf(stderr, "ERROR: This test should be run with two MPI processes.\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    buffers = calloc(max_depth + 1, sizeof(int));
+    requests = calloc(max_depth, sizeof(MPI_Request));
+
+    if (0 == rank) {
+        printf("# match latency in usec per message\n");
+        printf("%-12s %-12s %10s %12s\n", "engine", "test", "depth", "latency");
+    }
+
+    for (int e = 0 ; e < nengines ; ++e) {
+        char value[MPI_MAX_INFO_VAL + 1];
+        MPI_Comm comm;
+        MPI_Info info;
+        int flag;
+
+        MPI_Info_create(&info);
+        MPI_Info_set(info, "ompi_pml_ob1_matching_engine", engines[e]);
+        MPI_Comm_dup_with_info(MPI_COMM_WORLD, info, &comm);
+        MPI_Info_free(&info);
+
+        /* report the engine that is actually used */
+        MPI_Comm_get_info(comm, &info);
+        MPI_Info_get(info, "ompi_pml_ob1_matching_engine", MPI_MAX_INFO_VAL, value, &flag);
+        MPI_Info_free(&info);
+        if (!flag) {
+            strcpy(value, "n/a");
+        }
+
+        for (int test = 0 ; test < 3 ; ++test) {
+            for (int depth = 1 ; depth <= max_depth ; depth *= 2) {
+                double latency = run(comm, test, depth);
+                if (0 == rank) {
+                    printf("%-12s %-12s %10d %12.3f\n", value, test_names[test], depth, latency);
+                }
+            }
+        }
+
+        MPI_Comm_free(&comm);
+    }
+
+    free(buffers);
+    free(requests);
+
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}
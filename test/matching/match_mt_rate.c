@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018      Los Alamos National Security, LLC. All rights
+ *                         reserved.
+ * $COPYRIGHT$
+ *
+ * Additional copyrights may follow
+ *
+ * $HEADER$
+ */
+
+/*
+ * Multithreaded message rate.
+ *
+ * Every process runs 1, 2, 4, ... threads (up to the number of processes
+ * minus one or the -t argument). Thread t of rank r exchanges windows of
+ * small messages with ranks (r + t + 1) % size and (r - t - 1) % size using
+ * tag t, so that every thread works on a distinct peer. This measures the
+ * contention on the matching logic of the communicator, e.g.:
+ *
+ *   mpirun -np 8 --mca pml ob1 --mca pml_ob1_matching_per_peer_locks 1 ./match_mt_rate
+ *   mpirun -np 8 --mca pml ob1 --mca pml_ob1_matching_per_peer_locks 0 ./match_mt_rate
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "mpi.h"
+
+#define WINDOW   64
+#define NB_ITER  1000
+
+static int rank, size;
+static int nb_iter = NB_ITER;
+
+typedef struct {
+    int id;
+    MPI_Comm comm;
+} thread_arg_t;
+
+static void *thread_main(void *arg)
+{
+    thread_arg_t *targ = (thread_arg_t *) arg;
+    int dst = (rank + targ->id + 1) % size;
+    int src = (rank - targ->id - 1 + size) % size;
+    MPI_Request requests[2 * WINDOW];
+    char sbuf[WINDOW], rbuf[WINDOW];
+
+    for (int iter = 0 ; iter < nb_iter ; ++iter) {
+        for (int i = 0 ; i < WINDOW ; ++i) {
+            MPI_Irecv(rbuf + i, 1, MPI_CHAR, src, targ->id, targ->comm, requests + i);
+        }
+        for (int i = 0 ; i < WINDOW ; ++i) {
+            MPI_Isend(sbuf + i, 1, MPI_CHAR, dst, targ->id, targ->comm, requests + WINDOW + i);
+        }
+        MPI_Waitall(2 * WINDOW, requests, MPI_STATUSES_IGNORE);
+    }
+
+    return NULL;
+}
+
+static double run(MPI_Comm comm, int nthreads)
+{
+    pthread_t threads[nthreads];
+    thread_arg_t args[nthreads];
+    double start, elapsed, max_elapsed;
+
+    MPI_Barrier(comm);
+    start = MPI_Wtime();
+
+    for (int t = 0 ; t < nthreads ; ++t) {
+        args[t].id = t;
+        args[t].comm = comm;
+        pthread_create(threads + t, NULL, thread_main, args + t);
+    }
+    for (int t = 0 ; t < nthreads ; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+
+    elapsed = MPI_Wtime() - start;
+    MPI_Reduce(&elapsed, &max_elapsed, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    /* messages received per second by the whole job */
+    return (double) size * nthreads * nb_iter * WINDOW / max_elapsed;
+}
+
+int main(int argc, char *argv[])
+{
+    int provided, max_threads, opt;
+    MPI_Comm comm;
+
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    max_threads = size - 1;
+    while (-1 != (opt = getopt(argc, argv, "t:i:"))) {
+        if ('t' == opt) {
+            max_threads = atoi(optarg);
+        } else if ('i' == opt) {
+            nb_iter = atoi(optarg);
+        }
+    }
+
+    if (MPI_THREAD_MULTIPLE != provided || size < 2 || max_threads < 1 || max_threads >= size) {
+        if (0 == rank) {
+            fprintf(stderr, "ERROR: This test requires MPI_THREAD_MULTIPLE, at least two MPI "
+                    "processes and at most one thread less than the number of processes.\n");
+        }
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+
+    if (0 == rank) {
+        printf("# message rate in messages per second\n");
+        printf("%10s %16s\n", "threads", "rate");
+    }
+
+    /* warmup */
+    (void) run(comm, 1);
+
+    for (int nthreads = 1 ; nthreads <= max_threads ; nthreads *= 2) {
+        double rate = run(comm, nthreads);
+        if (0 == rank) {
+            printf("%10d %16.0f\n", nthreads, rate);
+        }
+    }
+
+    MPI_Comm_free(&comm);
+
+    MPI_Finalize();
+    return EXIT_SUCCESS;
+}